@@ -0,0 +1,70 @@
+-- Streaming of large in-progress transactions. A toplevel transaction is
+-- streamed in blocks of max_changes_in_memory (4096 by default) changes once it
+-- has that many, as long as it has no subtransactions and no catalog changes.
+SET synchronous_commit = on;
+
+CREATE TABLE stream_test(a int, b text);
+
+-- the decoded lines, a streamed block or transaction per row with the number
+-- of changes that follow its first line and the values of b among them
+CREATE FUNCTION stream_blocks(OUT line text, OUT changes bigint, OUT vals text)
+RETURNS SETOF record AS $$
+    SELECT min(CASE WHEN data NOT LIKE 'table %' THEN regexp_replace(data, 'CSN \d+', 'CSN N') END),
+           count(*) - 1,
+           string_agg(DISTINCT substring(data from 'b\[text\]:''(\w+)'''), ',')
+    FROM (SELECT data, sum(CASE WHEN data LIKE 'table %' THEN 0 ELSE 1 END) OVER (ROWS UNBOUNDED PRECEDING) AS grp
+          FROM pg_logical_slot_get_changes('regression_slot', NULL, NULL,
+               'include-xids', '0', 'skip-empty-xacts', '1', 'stream-changes', '1')) s
+    GROUP BY grp ORDER BY grp;
+$$ LANGUAGE sql;
+
+SELECT 'init' FROM pg_create_logical_replication_slot('regression_slot', 'test_decoding');
+
+-- two full blocks while decoding, the rest when the commit is decoded
+INSERT INTO stream_test SELECT g, 'top' FROM generate_series(1, 10000) g;
+SELECT * FROM stream_blocks();
+SELECT slot_name, spill_txns, spill_count, stream_txns, stream_count, stream_bytes > 0 AS stream_bytes
+FROM pg_stat_replication_slots WHERE slot_name = 'regression_slot';
+
+-- a subtransaction stops the streaming, the rolled back one is never sent and
+-- the changes of the committed one are sent with the rest of the transaction
+BEGIN;
+INSERT INTO stream_test SELECT g, 'top' FROM generate_series(1, 5000) g;
+SAVEPOINT s1;
+INSERT INTO stream_test SELECT g, 'undone' FROM generate_series(1, 100) g;
+ROLLBACK TO SAVEPOINT s1;
+INSERT INTO stream_test SELECT g, 'sub' FROM generate_series(1, 10) g;
+COMMIT;
+SELECT * FROM stream_blocks();
+SELECT slot_name, spill_txns, spill_count, stream_txns, stream_count, stream_bytes > 0 AS stream_bytes
+FROM pg_stat_replication_slots WHERE slot_name = 'regression_slot';
+
+-- the consumer is told to drop what it got of a transaction that aborts
+BEGIN;
+INSERT INTO stream_test SELECT g, 'gone' FROM generate_series(1, 5000) g;
+ROLLBACK;
+SELECT * FROM stream_blocks();
+SELECT slot_name, spill_txns, spill_count, stream_txns, stream_count, stream_bytes > 0 AS stream_bytes
+FROM pg_stat_replication_slots WHERE slot_name = 'regression_slot';
+
+-- a transaction whose changes are in a subtransaction is spilled to disk and
+-- decoded at its commit
+BEGIN;
+SAVEPOINT s1;
+INSERT INTO stream_test SELECT g, 'spill' FROM generate_series(1, 5000) g;
+RELEASE SAVEPOINT s1;
+COMMIT;
+SELECT * FROM stream_blocks();
+SELECT slot_name, spill_txns, spill_count, stream_txns, stream_count, stream_bytes > 0 AS stream_bytes
+FROM pg_stat_replication_slots WHERE slot_name = 'regression_slot';
+
+-- without the option, large transactions are spilled as before
+INSERT INTO stream_test SELECT g, 'big' FROM generate_series(1, 5000) g;
+SELECT count(*) FROM pg_logical_slot_get_changes('regression_slot', NULL, NULL,
+    'include-xids', '0', 'skip-empty-xacts', '1') WHERE data LIKE 'table %';
+SELECT slot_name, spill_txns, spill_count, stream_txns, stream_count, stream_bytes > 0 AS stream_bytes
+FROM pg_stat_replication_slots WHERE slot_name = 'regression_slot';
+
+SELECT pg_drop_replication_slot('regression_slot');
+DROP FUNCTION stream_blocks();
+DROP TABLE stream_test;
@@ -37,6 +37,8 @@
 #include "gs_tar_const.h"
 #include "bin/elog.h"
 #include "lib/string.h"
+#include "replication/walprotocol.h"
+#include "lz4.h"
 
 #include "fetchmot.h"
 
@@ -62,6 +64,9 @@ int compresslevel = 0;
 bool includewal = true;
 bool streamwal = true;
 bool fastcheckpoint = false;
+static int transfercompress = BASEBACKUP_COMPRESS_OFF;
+static int paralleljobs = 1;
+static char* incremental = NULL;
 
 extern char** tblspaceDirectory;
 extern int tblspaceCount;
@@ -84,6 +89,23 @@ static pid_t bgchild = -1;
 /* End position for xlog streaming, empty string if unknown yet */
 static XLogRecPtr xlogendptr;
 
+/* Incremental member of a tar stream being applied to the previous copy of a segment */
+typedef struct IncrementalFileState {
+    bool active;
+    uint64 consumed; /* bytes of the member received so far */
+    BaseBackupIncrementalHeader hdr;
+    BlockNumber* blocks;
+} IncrementalFileState;
+
+static IncrementalFileState incfile = {false, 0, {0, 0, 0}, NULL};
+
+/* Paths received by an incremental backup, the others are removed at the end */
+static char** receivedpaths = NULL;
+static int nreceivedpaths = 0;
+static int maxreceivedpaths = 0;
+static char** receivedroots = NULL;
+static int nreceivedroots = 0;
+
 #ifndef WIN32
 static int has_xlogendptr = 0;
 #else
@@ -108,6 +130,9 @@ static int GsTar(int argc, char** argv);
 static int GsBaseBackup(int argc, char** argv);
 
 static const char* get_tablespace_mapping(const char* dir);
+static int BackupGetCopyData(PGconn* conn, char** buffer);
+static void BackupFreeCopyData(char* buffer);
+static void RemoveUnreceivedFiles(void);
 
 /*
  * Split argument into old_dir and new_dir and append to tablespace mapping
@@ -204,9 +229,12 @@ static void usage(void)
              "                         include required WAL files with specified method\n"));
     printf(_("  -z, --gzip             compress tar output\n"));
     printf(_("  -Z, --compress=0-9     compress tar output with given compression level\n"));
+    printf(_("      --incremental=LSN  only fetch the blocks changed since LSN, applying them to the\n"
+             "                         previous backup in the target directory (plain format)\n"));
     printf(_("\nGeneral options:\n"));
     printf(_("  -c, --checkpoint=fast|spread\n"
              "                         set fast or spread checkpointing\n"));
+    printf(_("  -j, --jobs=NUM         use this many threads to read the data files on the server\n"));
     printf(_("  -l, --label=LABEL      set backup label\n"));
     printf(_("  -P, --progress         show progress information\n"));
     printf(_("  -v, --verbose          output verbose messages\n"));
@@ -217,6 +245,8 @@ static void usage(void)
     printf(_("  -p, --port=PORT        database server port number\n"));
     printf(_("  -s, --status-interval=INTERVAL\n"
              "                         time between status packets sent to server (in seconds)\n"));
+    printf(_("      --transfer-compress=lz4|none\n"
+             "                         compress the data sent by the server\n"));
     printf(_("  -U, --username=NAME    connect as specified database user\n"));
     printf(_("  -w, --no-password      never prompt for password\n"));
     printf(_("  -W, --password         force password prompt (should happen automatically)\n"));
@@ -582,6 +612,245 @@ static void progress_report(int tablespacenum, const char* filename)
  *
  * No attempt to inspect or validate the contents of the file is done.
  */
+/*
+ * Get the next CopyData message of a tar stream like PQgetCopyData, with
+ * the data decompressed if --transfer-compress asked the server to
+ * compress it. The data is released by BackupFreeCopyData.
+ */
+static int BackupGetCopyData(PGconn* conn, char** buffer)
+{
+    static char* rawbuf = NULL;
+    static uint32 rawbufsize = 0;
+    BaseBackupDataHeader hdr;
+    char* copybuf = NULL;
+    errno_t errorno = EOK;
+    int r;
+
+    r = PQgetCopyData(conn, &copybuf, 0);
+    if (r < 0 || transfercompress == BASEBACKUP_COMPRESS_OFF) {
+        *buffer = copybuf;
+        return r;
+    }
+
+    if ((size_t)r < sizeof(hdr)) {
+        fprintf(stderr, _("%s: invalid compressed COPY data size: %d\n"), progname, r);
+        disconnect_and_exit(1);
+    }
+    errorno = memcpy_s(&hdr, sizeof(hdr), copybuf, sizeof(hdr));
+    securec_check_c(errorno, "\0", "\0");
+    if (hdr.raw_len == 0 || hdr.raw_len > INT_MAX || hdr.data_len > hdr.raw_len ||
+        hdr.data_len != (uint32)r - sizeof(hdr)) {
+        fprintf(stderr, _("%s: invalid compressed COPY data header\n"), progname);
+        disconnect_and_exit(1);
+    }
+
+    if (hdr.raw_len > rawbufsize) {
+        char* newbuf = (char*)realloc(rawbuf, hdr.raw_len);
+        if (newbuf == NULL) {
+            fprintf(stderr, _("%s: out of memory\n"), progname);
+            disconnect_and_exit(1);
+        }
+        rawbuf = newbuf;
+        rawbufsize = hdr.raw_len;
+    }
+
+    if (hdr.data_len == hdr.raw_len) {
+        errorno = memcpy_s(rawbuf, rawbufsize, copybuf + sizeof(hdr), hdr.data_len);
+        securec_check_c(errorno, "\0", "\0");
+    } else if (LZ4_decompress_safe(copybuf + sizeof(hdr), rawbuf, (int)hdr.data_len, (int)hdr.raw_len) !=
+               (int)hdr.raw_len) {
+        fprintf(stderr, _("%s: could not decompress COPY data\n"), progname);
+        disconnect_and_exit(1);
+    }
+    PQfreemem(copybuf);
+
+    *buffer = rawbuf;
+    return (int)hdr.raw_len;
+}
+
+static void BackupFreeCopyData(char* buffer)
+{
+    /* decompressed data lives in the buffer of BackupGetCopyData */
+    if (transfercompress == BASEBACKUP_COMPRESS_OFF)
+        PQfreemem(buffer);
+}
+
+static void RecordReceivedPath(const char* path)
+{
+    if (incremental == NULL)
+        return;
+
+    if (nreceivedpaths == maxreceivedpaths) {
+        int newmax = (maxreceivedpaths == 0) ? 1024 : maxreceivedpaths * 2;
+        char** newpaths = (char**)realloc(receivedpaths, newmax * sizeof(char*));
+        if (newpaths == NULL) {
+            fprintf(stderr, _("%s: out of memory\n"), progname);
+            disconnect_and_exit(1);
+        }
+        receivedpaths = newpaths;
+        maxreceivedpaths = newmax;
+    }
+    receivedpaths[nreceivedpaths++] = xstrdup(path);
+}
+
+static int ComparePaths(const void* a, const void* b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+static bool IsReceivedPath(const char* path)
+{
+    const char* key = path;
+
+    return bsearch(&key, receivedpaths, nreceivedpaths, sizeof(char*), ComparePaths) != NULL;
+}
+
+/* Remove what is below dir and was not received, dir itself is kept */
+static void RemoveUnreceivedFilesIn(const char* dir, bool toplevel)
+{
+    DIR* dirdesc = NULL;
+    struct dirent* de = NULL;
+    char path[MAXPGPATH];
+    struct stat st;
+    errno_t errorno = EOK;
+
+    dirdesc = opendir(dir);
+    if (dirdesc == NULL) {
+        if (errno == ENOENT)
+            return;
+        fprintf(stderr, _("%s: could not open directory \"%s\": %s\n"), progname, dir, strerror(errno));
+        disconnect_and_exit(1);
+    }
+
+    while ((de = readdir(dirdesc)) != NULL) {
+        if (strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0)
+            continue;
+
+        errorno = snprintf_s(path, sizeof(path), sizeof(path) - 1, "%s/%s", dir, de->d_name);
+        securec_check_ss_c(errorno, "", "");
+        canonicalize_path(path);
+        if (lstat(path, &st) != 0) {
+            fprintf(stderr, _("%s: could not stat file \"%s\": %s\n"), progname, path, strerror(errno));
+            disconnect_and_exit(1);
+        }
+
+        bool received = IsReceivedPath(path);
+        /* a tablespace directory may be shared with other nodes, keep what is not ours */
+        if (toplevel && !received)
+            continue;
+
+        if (S_ISDIR(st.st_mode)) {
+            RemoveUnreceivedFilesIn(path, false);
+            if (!received && rmdir(path) != 0) {
+                fprintf(stderr, _("%s: could not remove directory \"%s\": %s\n"), progname, path, strerror(errno));
+                disconnect_and_exit(1);
+            }
+        } else if (!received) {
+            if (unlink(path) != 0) {
+                fprintf(stderr, _("%s: could not remove file \"%s\": %s\n"), progname, path, strerror(errno));
+                disconnect_and_exit(1);
+            }
+            if (verbose)
+                fprintf(stderr, _("%s: removed file \"%s\" of the previous backup\n"), progname, path);
+        }
+    }
+    (void)closedir(dirdesc);
+}
+
+/*
+ * Remove the relation files of the previous backup which the incremental
+ * backup did not send, i.e. of relations dropped or rewritten since then.
+ */
+static void RemoveUnreceivedFiles(void)
+{
+    char path[MAXPGPATH];
+    errno_t errorno = EOK;
+
+    qsort(receivedpaths, nreceivedpaths, sizeof(char*), ComparePaths);
+
+    errorno = snprintf_s(path, sizeof(path), sizeof(path) - 1, "%s/base", basedir);
+    securec_check_ss_c(errorno, "", "");
+    RemoveUnreceivedFilesIn(path, false);
+    errorno = snprintf_s(path, sizeof(path), sizeof(path) - 1, "%s/global", basedir);
+    securec_check_ss_c(errorno, "", "");
+    RemoveUnreceivedFilesIn(path, false);
+    for (int i = 0; i < nreceivedroots; i++)
+        RemoveUnreceivedFilesIn(receivedroots[i], true);
+
+    for (int i = 0; i < nreceivedpaths; i++)
+        free(receivedpaths[i]);
+    GS_FREE(receivedpaths);
+    nreceivedpaths = maxreceivedpaths = 0;
+    for (int i = 0; i < nreceivedroots; i++)
+        free(receivedroots[i]);
+    GS_FREE(receivedroots);
+    nreceivedroots = 0;
+}
+
+/*
+ * Write data of an incremental member to the segment: the header, the
+ * numbers of the blocks, then the blocks.
+ */
+static void ApplyIncrementalData(FILE* file, const char* filename, const char* data, size_t len)
+{
+    errno_t errorno = EOK;
+
+    while (len > 0) {
+        size_t n;
+
+        if (incfile.consumed < sizeof(incfile.hdr)) {
+            n = Min(len, sizeof(incfile.hdr) - (size_t)incfile.consumed);
+            errorno = memcpy_s((char*)&incfile.hdr + incfile.consumed, sizeof(incfile.hdr) - incfile.consumed, data, n);
+            securec_check_c(errorno, "\0", "\0");
+            if (incfile.consumed + n == sizeof(incfile.hdr)) {
+                if (incfile.hdr.magic != BASEBACKUP_INCREMENTAL_MAGIC || incfile.hdr.nblocks > RELSEG_SIZE) {
+                    fprintf(stderr, _("%s: invalid incremental data of file \"%s\"\n"), progname, filename);
+                    disconnect_and_exit(1);
+                }
+                incfile.blocks = (BlockNumber*)xmalloc0((int)(Max(incfile.hdr.nblocks, 1) * sizeof(BlockNumber)));
+            }
+        } else if (incfile.consumed < sizeof(incfile.hdr) + incfile.hdr.nblocks * sizeof(BlockNumber)) {
+            size_t done = (size_t)incfile.consumed - sizeof(incfile.hdr);
+            size_t arraysize = incfile.hdr.nblocks * sizeof(BlockNumber);
+
+            n = Min(len, arraysize - done);
+            errorno = memcpy_s((char*)incfile.blocks + done, arraysize - done, data, n);
+            securec_check_c(errorno, "\0", "\0");
+        } else {
+            uint64 off = incfile.consumed - sizeof(incfile.hdr) - incfile.hdr.nblocks * sizeof(BlockNumber);
+            uint64 idx = off / BLCKSZ;
+
+            if (idx >= incfile.hdr.nblocks) {
+                fprintf(stderr, _("%s: invalid incremental data of file \"%s\"\n"), progname, filename);
+                disconnect_and_exit(1);
+            }
+            n = Min(len, (size_t)(BLCKSZ - off % BLCKSZ));
+            if (fseeko(file, (off_t)incfile.blocks[idx] * BLCKSZ + (off_t)(off % BLCKSZ), SEEK_SET) != 0 ||
+                fwrite(data, n, 1, file) != 1) {
+                fprintf(stderr, _("%s: could not write to file \"%s\": %s\n"), progname, filename, strerror(errno));
+                disconnect_and_exit(1);
+            }
+        }
+        incfile.consumed += n;
+        data += n;
+        len -= n;
+    }
+}
+
+/* Close a file received, finishing the segment an incremental member was applied to */
+static void CloseReceivedFile(FILE* file, const char* filename)
+{
+    if (incfile.active) {
+        if (fflush(file) != 0 || ftruncate(fileno(file), (off_t)incfile.hdr.file_size) != 0) {
+            fprintf(stderr, _("%s: could not truncate file \"%s\": %s\n"), progname, filename, strerror(errno));
+            disconnect_and_exit(1);
+        }
+        GS_FREE(incfile.blocks);
+        incfile.active = false;
+    }
+    fclose(file);
+}
+
 static void ReceiveTarFile(PGconn* conn, PGresult* res, int rownum)
 {
 #define MAX_REALPATH_LEN 4096
@@ -708,11 +977,11 @@ static void ReceiveTarFile(PGconn* conn, PGresult* res, int rownum)
 
     while (true) {
         if (copybuf != NULL) {
-            PQfreemem(copybuf);
+            BackupFreeCopyData(copybuf);
             copybuf = NULL;
         }
 
-        int r = PQgetCopyData(conn, &copybuf, 0);
+        int r = BackupGetCopyData(conn, &copybuf);
         if (r == -1) {
 #ifdef HAVE_LIBZ
             if (ztarfile != NULL) {
@@ -767,7 +1036,7 @@ static void ReceiveTarFile(PGconn* conn, PGresult* res, int rownum)
     } /* while (1) */
 
     if (copybuf != NULL) {
-        PQfreemem(copybuf);
+        BackupFreeCopyData(copybuf);
         copybuf = NULL;
     }
 
@@ -875,6 +1144,16 @@ static void ReceiveAndUnpackTarFile(PGconn* conn, PGresult* res, int rownum)
             securec_check_c(errorno, "\0", "\0");
         }
         current_path[MAXPGPATH - 1] = '\0';
+
+        if (incremental != NULL) {
+            receivedroots = (char**)realloc(receivedroots, (nreceivedroots + 1) * sizeof(char*));
+            if (receivedroots == NULL) {
+                fprintf(stderr, _("%s: out of memory\n"), progname);
+                disconnect_and_exit(1);
+            }
+            receivedroots[nreceivedroots] = xstrdup(current_path);
+            canonicalize_path(receivedroots[nreceivedroots++]);
+        }
     }
 
     /*
@@ -885,17 +1164,17 @@ static void ReceiveAndUnpackTarFile(PGconn* conn, PGresult* res, int rownum)
         int r;
 
         if (copybuf != NULL) {
-            PQfreemem(copybuf);
+            BackupFreeCopyData(copybuf);
             copybuf = NULL;
         }
 
-        r = PQgetCopyData(conn, &copybuf, 0);
+        r = BackupGetCopyData(conn, &copybuf);
         if (r == -1) {
             /*
              * End of chunk
              */
             if (file != NULL) {
-                fclose(file);
+                CloseReceivedFile(file, filename);
                 file = NULL;
             }
 
@@ -955,13 +1234,17 @@ static void ReceiveAndUnpackTarFile(PGconn* conn, PGresult* res, int rownum)
                      * Directory
                      */
                     filename[strlen(filename) - 1] = '\0'; /* Remove trailing slash */
+                    canonicalize_path(filename);
+                    RecordReceivedPath(filename);
                     if (mkdir(filename, S_IRWXU) != 0) {
                         /*
                          * When streaming WAL, pg_xlog will have been created
                          * by the wal receiver process. So just ignore creation
-                         * failures on related directories.
+                         * failures on related directories. An incremental
+                         * backup finds the directories of the previous one.
                          */
-                        if (!((pg_str_endswith(filename, "/pg_xlog") || pg_str_endswith(filename, "/archive_status")) &&
+                        if (!((pg_str_endswith(filename, "/pg_xlog") || pg_str_endswith(filename, "/archive_status") ||
+                                  incremental != NULL) &&
                                 errno == EEXIST)) {
                             fprintf(stderr,
                                 _("%s: could not create directory \"%s\": %s\n"),
@@ -985,6 +1268,8 @@ static void ReceiveAndUnpackTarFile(PGconn* conn, PGresult* res, int rownum)
                      */
                     filename[strlen(filename) - 1] = '\0'; /* Remove trailing slash */
                     mapped_tblspc_path = get_tablespace_mapping(&copybuf[TAR_FILE_TYPE + 1]);
+                    if (incremental != NULL)
+                        (void)unlink(filename);
                     if (symlink(mapped_tblspc_path, filename) != 0) {
                         if (IsXlogDir(filename)) {
                             fprintf(stderr,
@@ -1015,6 +1300,8 @@ static void ReceiveAndUnpackTarFile(PGconn* conn, PGresult* res, int rownum)
                         &copybuf[TAR_FILE_TYPE + 1]);
                     securec_check_ss_c(errorno, "\0", "\0");
 
+                    if (incremental != NULL)
+                        (void)unlink(filename);
                     if (symlink(absolut_path, filename) != 0) {
                         if (!IsXlogDir(filename)) {
                             pg_log(PG_WARNING,
@@ -1034,9 +1321,21 @@ static void ReceiveAndUnpackTarFile(PGconn* conn, PGresult* res, int rownum)
 
             canonicalize_path(filename);
             /*
-             * regular file
+             * regular file, or the changed blocks of a relation segment
+             * to apply to its copy in the previous backup
              */
-            file = fopen(filename, "wb");
+            if (incremental != NULL && pg_str_endswith(filename, BASEBACKUP_INCREMENTAL_SUFFIX)) {
+                filename[strlen(filename) - strlen(BASEBACKUP_INCREMENTAL_SUFFIX)] = '\0';
+                file = fopen(filename, "r+b");
+                /* a segment added to the relation since the previous backup */
+                if (file == NULL && errno == ENOENT)
+                    file = fopen(filename, "w+b");
+                incfile.active = (file != NULL);
+                incfile.consumed = 0;
+            } else {
+                file = fopen(filename, "wb");
+            }
+            RecordReceivedPath(filename);
             if (NULL == file) {
                 fprintf(stderr, _("%s: could not create file \"%s\": %s\n"), progname, filename, strerror(errno));
                 disconnect_and_exit(1);
@@ -1055,7 +1354,7 @@ static void ReceiveAndUnpackTarFile(PGconn* conn, PGresult* res, int rownum)
                 /*
                  * Done with this file, next one will be a new tar header
                  */
-                fclose(file);
+                CloseReceivedFile(file, filename);
                 file = NULL;
                 continue;
             }
@@ -1068,13 +1367,15 @@ static void ReceiveAndUnpackTarFile(PGconn* conn, PGresult* res, int rownum)
                  * Received the padding block for this file, ignore it and
                  * close the file, then move on to the next tar header.
                  */
-                fclose(file);
+                CloseReceivedFile(file, filename);
                 file = NULL;
                 totaldone += (uint64)r;
                 continue;
             }
 
-            if (fwrite(copybuf, r, 1, file) != 1) {
+            if (incfile.active) {
+                ApplyIncrementalData(file, filename, copybuf, (size_t)r);
+            } else if (fwrite(copybuf, r, 1, file) != 1) {
                 fprintf(stderr, _("%s: could not write to file \"%s\": %s\n"), progname, filename, strerror(errno));
                 fclose(file);
                 file = NULL;
@@ -1091,7 +1392,7 @@ static void ReceiveAndUnpackTarFile(PGconn* conn, PGresult* res, int rownum)
                  * expected. Close the file and move on to the next tar
                  * header.
                  */
-                fclose(file);
+                CloseReceivedFile(file, filename);
                 file = NULL;
                 continue;
             }
@@ -1106,7 +1407,7 @@ static void ReceiveAndUnpackTarFile(PGconn* conn, PGresult* res, int rownum)
     }
 
     if (copybuf != NULL) {
-        PQfreemem(copybuf);
+        BackupFreeCopyData(copybuf);
         copybuf = NULL;
     }
 }
@@ -1122,6 +1423,7 @@ static void BaseBackup(void)
     int i = 0;
     char xlogstart[64];
     char xlogend[64];
+    char options[MAXPGPATH] = {0};
     errno_t rc = EOK;
     char* get_value = NULL;
 
@@ -1162,10 +1464,25 @@ static void BaseBackup(void)
      * Start the actual backup
      */
     PQescapeStringConn(conn, escaped_label, label, sizeof(escaped_label), &i);
+    /* only ask for what the defaults don't give, so that older servers still accept the command */
+    if (paralleljobs > 1) {
+        rc = snprintf_s(options, sizeof(options), sizeof(options) - 1, "PARALLEL %d ", paralleljobs);
+        securec_check_ss_c(rc, "", "");
+    }
+    if (transfercompress == BASEBACKUP_COMPRESS_LZ4) {
+        rc = strcat_s(options, sizeof(options), "COMPRESSION 'lz4' ");
+        securec_check_c(rc, "", "");
+    }
+    if (incremental != NULL) {
+        size_t len = strlen(options);
+        rc = snprintf_s(options + len, sizeof(options) - len, sizeof(options) - len - 1, "INCREMENTAL '%s'",
+            incremental);
+        securec_check_ss_c(rc, "", "");
+    }
     rc = snprintf_s(current_path, sizeof(current_path), sizeof(current_path) - 1,
-        "BASE_BACKUP LABEL '%s' %s %s %s %s %s", escaped_label, showprogress ? "PROGRESS" : "",
+        "BASE_BACKUP LABEL '%s' %s %s %s %s %s %s", escaped_label, showprogress ? "PROGRESS" : "",
         includewal && !streamwal ? "WAL" : "", fastcheckpoint ? "FAST" : "", includewal ? "NOWAIT" : "",
-        format == 't' ? "TABLESPACE_MAP" : "");
+        format == 't' ? "TABLESPACE_MAP" : "", options);
     securec_check_ss_c(rc, "", "");
 
     if (PQsendQuery(conn, current_path) == 0) {
@@ -1271,9 +1588,16 @@ static void BaseBackup(void)
             securec_check_ss_c(rc, "\0", "\0");
 
             const char* mappingSpacePath = get_tablespace_mapping(nodetablespacepath);
-            verify_dir_is_empty_or_create((char*)mappingSpacePath);
-            /* Save the tablespace directory here so we can remove it when errors happen. */
-            save_tablespace_dir(mappingSpacePath);
+            /* an incremental backup is applied to the tablespaces of the previous one */
+            if (incremental == NULL) {
+                verify_dir_is_empty_or_create((char*)mappingSpacePath);
+                /* Save the tablespace directory here so we can remove it when errors happen. */
+                save_tablespace_dir(mappingSpacePath);
+            } else if (pg_mkdir_p((char*)mappingSpacePath, S_IRWXU) == -1) {
+                fprintf(stderr, _("%s: could not create directory \"%s\": %s\n"), progname, mappingSpacePath,
+                    strerror(errno));
+                disconnect_and_exit(1);
+            }
         }
     }
 
@@ -1313,6 +1637,9 @@ static void BaseBackup(void)
             ReceiveAndUnpackTarFile(conn, res, i);
     } /* Loop over all tablespaces */
 
+    if (incremental != NULL)
+        RemoveUnreceivedFiles();
+
     if (showprogress) {
         progress_report(PQntuples(res), NULL);
         fprintf(stderr, "\n"); /* Need to move to next line */
@@ -1893,9 +2220,13 @@ static int GsBaseBackup(int argc, char** argv)
         {"status-interval", required_argument, NULL, 's'},
         {"verbose", no_argument, NULL, 'v'},
         {"progress", no_argument, NULL, 'P'},
+        {"jobs", required_argument, NULL, 'j'},
+        {"transfer-compress", required_argument, NULL, 1},
+        {"incremental", required_argument, NULL, 2},
         {NULL, 0, NULL, 0}};
     int c;
     int option_index;
+    uint32 hi, lo;
     progname = "gs_basebackup";
     set_pglocale_pgservice(argv[0], PG_TEXTDOMAIN("gs_basebackup"));
 
@@ -1909,7 +2240,7 @@ static int GsBaseBackup(int argc, char** argv)
         }
     }
 
-    while ((c = getopt_long(argc, argv, "D:l:c:h:p:U:s:X:F:T:Z:wWvPxz", long_options, &option_index)) != -1) {
+    while ((c = getopt_long(argc, argv, "D:l:c:h:p:U:s:X:F:T:Z:j:wWvPxz", long_options, &option_index)) != -1) {
         switch (c) {
             case 'D': {
                 GS_FREE(basedir);
@@ -2024,6 +2355,36 @@ static int GsBaseBackup(int argc, char** argv)
             case 'P':
                 showprogress = true;
                 break;
+            case 'j':
+                paralleljobs = atoi(optarg);
+                if (paralleljobs < 1 || paralleljobs > 64) {
+                    fprintf(stderr, _("%s: invalid number of parallel jobs \"%s\", must be between 1 and 64\n"),
+                        progname, optarg);
+                    exit(1);
+                }
+                break;
+            case 1:
+                if (pg_strcasecmp(optarg, "lz4") == 0)
+                    transfercompress = BASEBACKUP_COMPRESS_LZ4;
+                else if (pg_strcasecmp(optarg, "none") == 0)
+                    transfercompress = BASEBACKUP_COMPRESS_OFF;
+                else {
+                    fprintf(stderr,
+                        _("%s: invalid transfer-compress argument \"%s\", must be \"lz4\" or \"none\"\n"),
+                        progname,
+                        optarg);
+                    exit(1);
+                }
+                break;
+            case 2:
+                check_env_value_c(optarg);
+                if (sscanf_s(optarg, "%X/%X", &hi, &lo) != 2 || (hi == 0 && lo == 0)) {
+                    fprintf(stderr, _("%s: invalid incremental location \"%s\"\n"), progname, optarg);
+                    exit(1);
+                }
+                GS_FREE(incremental);
+                incremental = xstrdup(optarg);
+                break;
             default:
 
                 /*
@@ -2068,6 +2429,12 @@ static int GsBaseBackup(int argc, char** argv)
         exit(1);
     }
 
+    if (format != 'p' && incremental != NULL) {
+        fprintf(stderr, _("%s: incremental backups can only be taken in plain mode\n"), progname);
+        fprintf(stderr, _("Try \"%s --help\" for more information.\n"), progname);
+        exit(1);
+    }
+
 #ifndef HAVE_LIBZ
     if (compresslevel != 0) {
         fprintf(stderr, _("%s: this build does not support compression\n"), progname);
@@ -2078,9 +2445,22 @@ static int GsBaseBackup(int argc, char** argv)
     /*
      * Verify that the target directory exists, or create it. For plaintext
      * backups, always require the directory. For tar backups, require it
-     * unless we are writing to stdout.
+     * unless we are writing to stdout. An incremental backup requires the
+     * previous backup in it instead, whose WAL is of no use any more.
      */
-    if (format == 'p' || strcmp(basedir, "-") != 0)
+    if (incremental != NULL) {
+        char path[MAXPGPATH];
+        struct stat st;
+        errno_t rc = snprintf_s(path, sizeof(path), sizeof(path) - 1, "%s/global/pg_control", basedir);
+        securec_check_ss_c(rc, "", "");
+        if (stat(path, &st) != 0) {
+            fprintf(stderr, _("%s: directory \"%s\" does not hold the previous backup\n"), progname, basedir);
+            exit(1);
+        }
+        rc = snprintf_s(path, sizeof(path), sizeof(path) - 1, "%s/pg_xlog", basedir);
+        securec_check_ss_c(rc, "", "");
+        (void)rmtree(path, false, true);
+    } else if (format == 'p' || strcmp(basedir, "-") != 0)
         verify_dir_is_empty_or_create(basedir);
 
     BaseBackup();
@@ -2099,4 +2479,5 @@ static void free_basebackup()
     GS_FREE(dbhost);
     GS_FREE(dbport);
     GS_FREE(dbuser);
+    GS_FREE(incremental);
 }
@@ -41,10 +41,15 @@
  *	libz's gzopen() APIs. It allows you to use the same functions for
  *	compressed and uncompressed streams. cfopen_read() first tries to open
  *	the file with given name, and if it fails, it tries to open the same
- *	file with the .gz suffix. cfopen_write() opens a file for writing, an
- *	extra argument specifies if the file should be compressed, and adds the
- *	.gz suffix to the filename if so. This allows you to easily handle both
- *	compressed and uncompressed files.
+ *	file with the .gz suffix, then with the .lz4 suffix. cfopen_write() opens
+ *	a file for writing, an extra argument specifies if the file should be
+ *	compressed, and adds the .gz suffix to the filename if so, or the .lz4
+ *	suffix if the compression is DUMP_COMPRESSION_LZ4. This allows you to easily
+ *	handle both compressed and uncompressed files.
+ *
+ *	LZ4 compressed files are written in blocks of our own (see LZ4File below)
+ *	rather than in the LZ4 frame format, so they can only be read back by
+ *	this API.
  *
  * IDENTIFICATION
  *	   src/bin/pg_dump/compress_io.c
@@ -55,6 +60,8 @@
 #include "compress_io.h"
 #include "dumpmem.h"
 
+#include "lz4.h"
+
 #ifdef GAUSS_SFT_TEST
 #include "gauss_sft.h"
 #endif
@@ -105,6 +112,9 @@ static void ParseCompressionOption(int compression, CompressionAlgorithm* alg, i
         *alg = COMPR_ALG_LIBZ;
     } else if (compression == 0) {
         *alg = COMPR_ALG_NONE;
+    } else if (compression == DUMP_COMPRESSION_LZ4) {
+        exit_horribly(modulename, "LZ4 compression is only supported by the directory archive format\n");
+        *alg = COMPR_ALG_NONE; /* keep compiler quiet */
     } else {
         exit_horribly(modulename, "invalid compression code: %d\n", compression);
         *alg = COMPR_ALG_NONE; /* keep compiler quiet */
@@ -397,20 +407,42 @@ static size_t WriteDataToArchiveNone(ArchiveHandle* AH, CompressorState* cs, con
  * ----------------------
  */
 
+/*
+ * An LZ4 compressed file is a sequence of blocks holding up to LZ4_BLOCK_SIZE
+ * bytes of data each. A block starts with the length of its data and the
+ * length of its payload, both as 4-byte little-endian integers. The payload
+ * is the data compressed by LZ4 when it is shorter than the data, and the
+ * data itself otherwise. Blocks are compressed independently, so readers
+ * and writers never need more than one block in memory.
+ */
+#define LZ4_BLOCK_SIZE (64 * 1024)
+#define LZ4_BLOCK_HEADER_SIZE 8
+
+typedef struct LZ4File {
+    FILE* fp;
+    bool writing;
+    bool eof;      /* there are no more blocks to read */
+    char* buf;     /* data of the current block */
+    size_t buflen; /* length of the data in buf */
+    size_t bufpos; /* next byte of buf to return, when reading */
+    char* cbuf;    /* payload of the current block */
+    int cbufsize;
+} LZ4File;
+
 /*
  * cfp represents an open stream, wrapping the underlying FILE or gzFile
- * pointer. This is opaque to the callers.
+ * pointer, or the LZ4File. This is opaque to the callers.
  */
 struct cfp {
     FILE* uncompressedfp;
 #ifdef HAVE_LIBZ
     gzFile compressedfp;
 #endif
+    LZ4File* lz4fp;
 };
 
-#ifdef HAVE_LIBZ
 static int hasSuffix(const char* filename, const char* suffix);
-#endif
+static cfp* cfopen_suffix(const char* path, const char* suffix, const char* mode, int compression);
 
 /* free() without changing errno; useful in several places below */
 static void free_keep_errno(void* p)
@@ -422,13 +454,211 @@ static void free_keep_errno(void* p)
     errno = save_errno;
 }
 
+/*
+ * Routines for LZ4 compressed files.
+ */
+
+static void LZ4PutUInt32(unsigned char* p, uint32 val)
+{
+    p[0] = (unsigned char)(val & 0xFF);
+    p[1] = (unsigned char)((val >> 8) & 0xFF);
+    p[2] = (unsigned char)((val >> 16) & 0xFF);
+    p[3] = (unsigned char)((val >> 24) & 0xFF);
+}
+
+static uint32 LZ4GetUInt32(const unsigned char* p)
+{
+    return (uint32)p[0] | ((uint32)p[1] << 8) | ((uint32)p[2] << 16) | ((uint32)p[3] << 24);
+}
+
+static LZ4File* LZ4FileOpen(const char* path, const char* mode)
+{
+    LZ4File* lfp = NULL;
+    FILE* file = fopen(path, mode);
+
+    if (file == NULL)
+        return NULL;
+
+    lfp = (LZ4File*)pg_calloc(1, sizeof(LZ4File));
+    lfp->fp = file;
+    lfp->writing = (mode[0] == 'w' || mode[0] == 'a');
+    lfp->buf = (char*)pg_malloc(LZ4_BLOCK_SIZE);
+    lfp->cbufsize = LZ4_compressBound(LZ4_BLOCK_SIZE);
+    lfp->cbuf = (char*)pg_malloc(lfp->cbufsize);
+    return lfp;
+}
+
+/*
+ * Write out the data buffered in lfp as a block. Returns false on failure,
+ * with an error code in errno.
+ */
+static bool LZ4FileFlush(LZ4File* lfp)
+{
+    unsigned char header[LZ4_BLOCK_HEADER_SIZE];
+    const char* payload = lfp->cbuf;
+    int len;
+
+    if (lfp->buflen == 0)
+        return true;
+
+    len = LZ4_compress_default(lfp->buf, lfp->cbuf, (int)lfp->buflen, lfp->cbufsize);
+    if (len <= 0 || (size_t)len >= lfp->buflen) {
+        /* not compressible, store the data as is */
+        payload = lfp->buf;
+        len = (int)lfp->buflen;
+    }
+
+    LZ4PutUInt32(header, (uint32)lfp->buflen);
+    LZ4PutUInt32(header + 4, (uint32)len);
+    if (fwrite(header, 1, sizeof(header), lfp->fp) != sizeof(header) ||
+        fwrite(payload, 1, len, lfp->fp) != (size_t)len)
+        return false;
+
+    lfp->buflen = 0;
+    return true;
+}
+
+/*
+ * Read the next block into lfp. Returns false at end of file.
+ */
+static bool LZ4FileFill(LZ4File* lfp)
+{
+    unsigned char header[LZ4_BLOCK_HEADER_SIZE];
+    size_t rawlen;
+    size_t len;
+    size_t cnt;
+
+    lfp->buflen = 0;
+    lfp->bufpos = 0;
+    if (lfp->eof)
+        return false;
+
+    cnt = fread(header, 1, sizeof(header), lfp->fp);
+    if (cnt == 0 && !ferror(lfp->fp)) {
+        lfp->eof = true;
+        return false;
+    }
+    if (cnt != sizeof(header))
+        exit_horribly(modulename, "could not read from LZ4 compressed file: %s\n",
+            ferror(lfp->fp) ? strerror(errno) : "unexpected end of file");
+
+    rawlen = LZ4GetUInt32(header);
+    len = LZ4GetUInt32(header + 4);
+    if (rawlen == 0 || rawlen > LZ4_BLOCK_SIZE || len > rawlen)
+        exit_horribly(modulename, "invalid block in LZ4 compressed file\n");
+
+    if (len == rawlen) {
+        if (fread(lfp->buf, 1, len, lfp->fp) != len)
+            exit_horribly(modulename, "could not read from LZ4 compressed file: unexpected end of file\n");
+    } else {
+        if (fread(lfp->cbuf, 1, len, lfp->fp) != len)
+            exit_horribly(modulename, "could not read from LZ4 compressed file: unexpected end of file\n");
+        if (LZ4_decompress_safe(lfp->cbuf, lfp->buf, (int)len, LZ4_BLOCK_SIZE) != (int)rawlen)
+            exit_horribly(modulename, "could not uncompress data: invalid block in LZ4 compressed file\n");
+    }
+    lfp->buflen = rawlen;
+    return true;
+}
+
+static size_t LZ4FileRead(LZ4File* lfp, void* ptr, size_t size)
+{
+    size_t done = 0;
+
+    while (done < size) {
+        size_t cnt;
+        errno_t rc;
+
+        if (lfp->bufpos == lfp->buflen && !LZ4FileFill(lfp))
+            break;
+
+        cnt = Min(size - done, lfp->buflen - lfp->bufpos);
+        rc = memcpy_s((char*)ptr + done, size - done, lfp->buf + lfp->bufpos, cnt);
+        securec_check_c(rc, "\0", "\0");
+        lfp->bufpos += cnt;
+        done += cnt;
+    }
+    return done;
+}
+
+static size_t LZ4FileWrite(LZ4File* lfp, const void* ptr, size_t size)
+{
+    size_t done = 0;
+
+    while (done < size) {
+        size_t cnt = Min(size - done, LZ4_BLOCK_SIZE - lfp->buflen);
+        errno_t rc = memcpy_s(lfp->buf + lfp->buflen, LZ4_BLOCK_SIZE - lfp->buflen, (const char*)ptr + done, cnt);
+        securec_check_c(rc, "\0", "\0");
+
+        lfp->buflen += cnt;
+        done += cnt;
+        if (lfp->buflen == LZ4_BLOCK_SIZE && !LZ4FileFlush(lfp))
+            return done - cnt;
+    }
+    return done;
+}
+
+static int LZ4FileGetc(LZ4File* lfp)
+{
+    if (lfp->bufpos == lfp->buflen && !LZ4FileFill(lfp))
+        return EOF;
+    return (unsigned char)lfp->buf[lfp->bufpos++];
+}
+
+static char* LZ4FileGets(LZ4File* lfp, char* buf, int len)
+{
+    int i = 0;
+    int c;
+
+    while (i < len - 1 && (c = LZ4FileGetc(lfp)) != EOF) {
+        buf[i++] = (char)c;
+        if (c == '\n')
+            break;
+    }
+    if (i == 0)
+        return NULL;
+    buf[i] = '\0';
+    return buf;
+}
+
+static int LZ4FileClose(LZ4File* lfp)
+{
+    int result = 0;
+
+    if (lfp->writing && !LZ4FileFlush(lfp))
+        result = EOF;
+    if (fclose(lfp->fp) != 0)
+        result = EOF;
+    free_keep_errno(lfp->buf);
+    free_keep_errno(lfp->cbuf);
+    free_keep_errno(lfp);
+    return result;
+}
+
+/*
+ * Open 'path' with 'suffix' appended.
+ */
+static cfp* cfopen_suffix(const char* path, const char* suffix, const char* mode, int compression)
+{
+    int fnamelen = strlen(path) + strlen(suffix) + 1;
+    char* fname = (char*)pg_malloc(fnamelen);
+    cfp* fp = NULL;
+    int nRet = 0;
+
+    nRet = snprintf_s(fname, fnamelen, fnamelen - 1, "%s%s", path, suffix);
+    securec_check_ss_c(nRet, fname, "\0");
+    fp = cfopen(fname, mode, compression);
+    free_keep_errno(fname);
+    fname = NULL;
+    return fp;
+}
+
 /*
  * Open a file for reading. 'path' is the file to open, and 'mode' should
  * be either "r" or "rb".
  *
  * If the file at 'path' does not exist, we append the ".gz" suffix (if 'path'
- * doesn't already have it) and try again. So if you pass "foo" as 'path',
- * this will open either "foo" or "foo.gz".
+ * doesn't already have it) and try again, then the ".lz4" suffix. So if you
+ * pass "foo" as 'path', this will open either "foo", "foo.gz" or "foo.lz4".
  *
  * On failure, return NULL with an error code in errno.
  */
@@ -441,21 +671,16 @@ cfp* cfopen_read(const char* path, const char* mode)
         fp = cfopen(path, mode, 1);
     else
 #endif
-    {
+    if (hasSuffix(path, ".lz4"))
+        fp = cfopen(path, mode, DUMP_COMPRESSION_LZ4);
+    else {
         fp = cfopen(path, mode, 0);
 #ifdef HAVE_LIBZ
-        if (fp == NULL) {
-            int fnamelen = strlen(path) + 4;
-            char* fname = (char*)pg_malloc(fnamelen);
-            int nRet = 0;
-
-            nRet = snprintf_s(fname, fnamelen, fnamelen - 1, "%s%s", path, ".gz");
-            securec_check_ss_c(nRet, fname, "\0");
-            fp = cfopen(fname, mode, 1);
-            free_keep_errno(fname);
-            fname = NULL;
-        }
+        if (fp == NULL)
+            fp = cfopen_suffix(path, ".gz", mode, 1);
 #endif
+        if (fp == NULL)
+            fp = cfopen_suffix(path, ".lz4", mode, DUMP_COMPRESSION_LZ4);
     }
     return fp;
 }
@@ -465,9 +690,11 @@ cfp* cfopen_read(const char* path, const char* mode)
  * be a filemode as accepted by fopen() and gzopen() that indicates writing
  * ("w", "wb", "a", or "ab").
  *
- * If 'compression' is non-zero, a gzip compressed stream is opened, and
- * 'compression' indicates the compression level used. The ".gz" suffix
- * is automatically added to 'path' in that case.
+ * If 'compression' is DUMP_COMPRESSION_LZ4, an LZ4 compressed stream is opened
+ * and the ".lz4" suffix is added to 'path'. Otherwise, if 'compression' is
+ * non-zero, a gzip compressed stream is opened, and 'compression' indicates
+ * the compression level used. The ".gz" suffix is automatically added to
+ * 'path' in that case.
  *
  * On failure, return NULL with an error code in errno.
  */
@@ -477,17 +704,11 @@ cfp* cfopen_write(const char* path, const char* mode, int compression)
 
     if (compression == 0)
         fp = cfopen(path, mode, 0);
+    else if (compression == DUMP_COMPRESSION_LZ4)
+        fp = cfopen_suffix(path, ".lz4", mode, DUMP_COMPRESSION_LZ4);
     else {
 #ifdef HAVE_LIBZ
-        int fnamelen = strlen(path) + 4;
-        char* fname = (char*)pg_malloc(fnamelen);
-        int nRet = 0;
-
-        nRet = snprintf_s(fname, fnamelen, fnamelen - 1, "%s%s", path, ".gz");
-        securec_check_ss_c(nRet, fname, "\0");
-        fp = cfopen(fname, mode, compression);
-        free_keep_errno(fname);
-        fname = NULL;
+        fp = cfopen_suffix(path, ".gz", mode, compression);
 #else
         fp = NULL; /* keep compiler quiet */
         exit_horribly(modulename, "not built with zlib support\n");
@@ -497,16 +718,23 @@ cfp* cfopen_write(const char* path, const char* mode, int compression)
 }
 
 /*
- * Opens file 'path' in 'mode'. If 'compression' is non-zero, the file
- * is opened with libz gzopen(), otherwise with plain fopen().
+ * Opens file 'path' in 'mode'. If 'compression' is DUMP_COMPRESSION_LZ4, the file
+ * is opened as an LZ4File, else if it is non-zero, the file is opened with
+ * libz gzopen(), otherwise with plain fopen().
  *
  * On failure, return NULL with an error code in errno.
  */
 cfp* cfopen(const char* path, const char* mode, int compression)
 {
-    cfp* fp = (cfp*)pg_malloc(sizeof(cfp));
+    cfp* fp = (cfp*)pg_calloc(1, sizeof(cfp));
 
-    if (compression != 0) {
+    if (compression == DUMP_COMPRESSION_LZ4) {
+        fp->lz4fp = LZ4FileOpen(path, mode);
+        if (fp->lz4fp == NULL) {
+            free_keep_errno(fp);
+            fp = NULL;
+        }
+    } else if (compression != 0) {
 #ifdef HAVE_LIBZ
         char mode_compression[32] = {0};
         int nRet = 0;
@@ -539,7 +767,7 @@ cfp* cfopen(const char* path, const char* mode, int compression)
     }
 
     /* update file permission */
-    if (chmod(path, FILE_PERMISSION) == -1) {
+    if (fp != NULL && chmod(path, FILE_PERMISSION) == -1) {
         exit_horribly(modulename, "changing permissions for file \"%s\" failed with: %s\n", path, strerror(errno));
     }
 
@@ -549,6 +777,9 @@ cfp* cfopen(const char* path, const char* mode, int compression)
 int cfread(void* ptr, int size, cfp* fp)
 {
     size_t read_len;
+
+    if (fp->lz4fp != NULL)
+        return (int)LZ4FileRead(fp->lz4fp, ptr, size);
 #ifdef HAVE_LIBZ
     if (fp->compressedfp != NULL)
         return gzread(fp->compressedfp, ptr, size);
@@ -560,6 +791,8 @@ int cfread(void* ptr, int size, cfp* fp)
 
 int cfwrite(const void* ptr, int size, cfp* fp)
 {
+    if (fp->lz4fp != NULL)
+        return (int)LZ4FileWrite(fp->lz4fp, ptr, size);
 #ifdef HAVE_LIBZ
     if (fp->compressedfp != NULL)
         return gzwrite(fp->compressedfp, ptr, size);
@@ -570,6 +803,8 @@ int cfwrite(const void* ptr, int size, cfp* fp)
 
 int cfgetc(cfp* fp)
 {
+    if (fp->lz4fp != NULL)
+        return LZ4FileGetc(fp->lz4fp);
 #ifdef HAVE_LIBZ
     if (fp->compressedfp != NULL)
         return gzgetc(fp->compressedfp);
@@ -580,6 +815,8 @@ int cfgetc(cfp* fp)
 
 char* cfgets(cfp* fp, char* buf, int len)
 {
+    if (fp->lz4fp != NULL)
+        return LZ4FileGets(fp->lz4fp, buf, len);
 #ifdef HAVE_LIBZ
     if (fp->compressedfp != NULL)
         return gzgets(fp->compressedfp, buf, len);
@@ -596,6 +833,10 @@ int cfclose(cfp* fp)
         errno = EBADF;
         return EOF;
     }
+    if (fp->lz4fp != NULL) {
+        result = LZ4FileClose(fp->lz4fp);
+        fp->lz4fp = NULL;
+    } else
 #ifdef HAVE_LIBZ
     if (fp->compressedfp != NULL) {
         result = gzclose(fp->compressedfp);
@@ -613,6 +854,8 @@ int cfclose(cfp* fp)
 
 int cfeof(cfp* fp)
 {
+    if (fp->lz4fp != NULL)
+        return fp->lz4fp->eof && fp->lz4fp->bufpos == fp->lz4fp->buflen;
 #ifdef HAVE_LIBZ
     if (fp->compressedfp != NULL)
         return gzeof(fp->compressedfp);
@@ -621,7 +864,6 @@ int cfeof(cfp* fp)
         return feof(fp->uncompressedfp);
 }
 
-#ifdef HAVE_LIBZ
 static int hasSuffix(const char* filename, const char* suffix)
 {
     int filenamelen = strlen(filename);
@@ -632,4 +874,3 @@ static int hasSuffix(const char* filename, const char* suffix)
 
     return memcmp(&filename[filenamelen - suffixlen], suffix, suffixlen) == 0;
 }
-#endif
@@ -88,11 +88,19 @@ struct Archive {
 
     /* get hash bucket info. */
     bool getHashbucketInfo;
+
+    int numWorkers; /* number of parallel processes dumping data */
     /* The rest is private */
 };
 
 typedef int (*DataDumperPtr)(Archive* AH, void* userArg);
 
+/*
+ * Called in a parallel dump worker once it has connected, before it dumps
+ * the data of the TOC entry dumpId.
+ */
+typedef void (*SetupWorkerPtr)(Archive* AH, DumpId dumpId);
+
 typedef struct _restoreOptions {
     int createDB;           /* Issue commands to create the database */
     int noOwner;            /* Don't try to match original object owner */
@@ -162,9 +170,10 @@ extern PGconn* get_dumplog_conn(
 extern PGconn* GetConnection(Archive* AHX);
 
 /* Called to add a TOC entry */
-extern void ArchiveEntry(Archive* AHX, CatalogId catalogId, DumpId dumpId, const char* tag, const char* nmspace,
-    const char* tablespace, const char* owner, bool withOids, const char* desc, teSection section, const char* defn,
-    const char* dropStmt, const char* copyStmt, const DumpId* deps, int nDeps, DataDumperPtr dumpFn, void* dumpArg);
+extern struct _tocEntry* ArchiveEntry(Archive* AHX, CatalogId catalogId, DumpId dumpId, const char* tag,
+    const char* nmspace, const char* tablespace, const char* owner, bool withOids, const char* desc, teSection section,
+    const char* defn, const char* dropStmt, const char* copyStmt, const DumpId* deps, int nDeps, DataDumperPtr dumpFn,
+    void* dumpArg);
 
 /* Called to write *data* to the archive */
 extern size_t WriteData(Archive* AH, const void* data, size_t dLen);
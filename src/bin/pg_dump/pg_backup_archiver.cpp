@@ -183,6 +183,12 @@ static void inhibit_data_for_failed_table(ArchiveHandle* AH, TocEntry* te);
 static ArchiveHandle* CloneArchive(ArchiveHandle* AH);
 static void DeCloneArchive(ArchiveHandle* AH);
 
+static void WriteDataChunksForTocEntry(ArchiveHandle* AH, TocEntry* te);
+static void write_data_chunks_parallel(ArchiveHandle* AH);
+static int data_length_compare(const void* p1, const void* p2);
+static thandle spawn_dump(RestoreArgs* args);
+static parallel_restore_result parallel_dump(RestoreArgs* args);
+
 static void setProcessIdentifier(ParallelStateEntry* pse, ArchiveHandle* AH);
 static void unsetProcessIdentifier(ParallelStateEntry* pse);
 static ParallelStateEntry* GetMyPSEntry(ParallelState* pstate);
@@ -847,7 +853,7 @@ size_t WriteData(Archive* AHX, const void* data, size_t dLen)
  * repository for all metadata. But the name has stuck.
  */
 /* Public */
-void ArchiveEntry(Archive* AHX, CatalogId catalogId, DumpId dumpId, const char* tag, const char* nmspace,
+TocEntry* ArchiveEntry(Archive* AHX, CatalogId catalogId, DumpId dumpId, const char* tag, const char* nmspace,
     const char* tablespace, const char* owner, bool withOids, const char* desc, teSection section, const char* defn,
     const char* dropStmt, const char* copyStmt, const DumpId* deps, int nDeps, DataDumperPtr dumpFn, void* dumpArg)
 {
@@ -899,6 +905,8 @@ void ArchiveEntry(Archive* AHX, CatalogId catalogId, DumpId dumpId, const char*
     if (AH->ArchiveEntryptr != NULL) {
         (*AH->ArchiveEntryptr)(AH, newToc);
     }
+
+    return newToc;
 }
 
 /* Public */
@@ -2107,40 +2115,55 @@ static ArchiveHandle* _allocAH(const char* FileSpec, const ArchiveFormat fmt, co
     return AH;
 }
 
+/*
+ * Dump the data of all the TOC entries having some. With several workers,
+ * which only the directory format supports, this is done in parallel.
+ */
 void WriteDataChunks(ArchiveHandle* AH)
 {
     TocEntry* te = NULL;
-    StartDataPtr startPtr = NULL;
-    EndDataPtr endPtr = NULL;
+
+    if (AH->publicArc.numWorkers > 1) {
+        write_data_chunks_parallel(AH);
+        return;
+    }
 
     for (te = AH->toc->next; te != AH->toc; te = te->next) {
         if (te->dataDumper != NULL && (te->reqs & REQ_DATA) != 0) {
-            AH->currToc = te;
+            WriteDataChunksForTocEntry(AH, te);
+        }
+    }
+}
 
-            if (strcmp(te->desc, "BLOBS") == 0) {
-                startPtr = AH->StartBlobsptr;
-                endPtr = AH->EndBlobsptr;
-            } else {
-                startPtr = AH->StartDataptr;
-                endPtr = AH->EndDataptr;
-            }
+static void WriteDataChunksForTocEntry(ArchiveHandle* AH, TocEntry* te)
+{
+    StartDataPtr startPtr = NULL;
+    EndDataPtr endPtr = NULL;
 
-            if (startPtr != NULL) {
-                (*startPtr)(AH, te);
-            }
+    AH->currToc = te;
 
-            /*
-             * The user-provided DataDumper routine needs to call
-             * AH->WriteData
-             */
-            (void)(*te->dataDumper)((Archive*)AH, te->dataDumperArg);
+    if (strcmp(te->desc, "BLOBS") == 0) {
+        startPtr = AH->StartBlobsptr;
+        endPtr = AH->EndBlobsptr;
+    } else {
+        startPtr = AH->StartDataptr;
+        endPtr = AH->EndDataptr;
+    }
 
-            if (endPtr != NULL) {
-                (*endPtr)(AH, te);
-            }
-            AH->currToc = NULL;
-        }
+    if (startPtr != NULL) {
+        (*startPtr)(AH, te);
     }
+
+    /*
+     * The user-provided DataDumper routine needs to call
+     * AH->WriteData
+     */
+    (void)(*te->dataDumper)((Archive*)AH, te->dataDumperArg);
+
+    if (endPtr != NULL) {
+        (*endPtr)(AH, te);
+    }
+    AH->currToc = NULL;
 }
 
 void WriteToc(ArchiveHandle* AH)
@@ -4229,6 +4252,180 @@ static void inhibit_data_for_failed_table(ArchiveHandle* AH, TocEntry* te)
     }
 }
 
+/*
+ * Main engine for parallel dump.
+ *
+ * Each data item is dumped by a worker child of its own (a thread on
+ * Windows) with its own connection to the database, which SetupWorkerptr
+ * makes see the snapshot of the parent's transaction. At most numWorkers
+ * children run at once. Items are handed out largest first, so that no big
+ * table is left to be dumped alone at the end while the other workers are
+ * idle. The parent's connection stays idle in its transaction meanwhile,
+ * keeping the snapshot and the table locks.
+ */
+static void write_data_chunks_parallel(ArchiveHandle* AH)
+{
+    int n_slots = AH->publicArc.numWorkers;
+    ParallelSlot* slots = NULL;
+    ParallelState* pstate = NULL;
+    TocEntry** items = NULL;
+    TocEntry* te = NULL;
+    int n_items = 0;
+    int next_item = 0;
+    int next_slot = 0;
+    int work_status = 0;
+    uint32 work_status_temp = 0;
+    int i = 0;
+
+    items = (TocEntry**)pg_malloc((AH->tocCount + 1) * sizeof(TocEntry*));
+    for (te = AH->toc->next; te != AH->toc; te = te->next) {
+        if (te->dataDumper != NULL && (te->reqs & REQ_DATA) != 0)
+            items[n_items++] = te;
+    }
+    qsort(items, n_items, sizeof(TocEntry*), data_length_compare);
+
+    slots = (ParallelSlot*)pg_calloc(n_slots, sizeof(ParallelSlot));
+    pstate = (ParallelState*)pg_malloc(sizeof(ParallelState));
+    pstate->pse = (ParallelStateEntry*)pg_calloc(n_slots, sizeof(ParallelStateEntry));
+    pstate->numWorkers = n_slots;
+    for (i = 0; i < pstate->numWorkers; i++)
+        unsetProcessIdentifier(&(pstate->pse[i]));
+
+    /* let the exit handler of a worker close the worker's own connection */
+    shutdown_info.pstate = pstate;
+
+    ahlog(AH, 1, "entering main parallel dump loop\n");
+
+    while (next_item < n_items || work_in_progress(slots, n_slots)) {
+        if (next_item < n_items && (next_slot = get_next_slot(slots, n_slots)) != NO_SLOT) {
+            /* There is work still to do and a worker slot available */
+            RestoreArgs* args = (RestoreArgs*)pg_malloc(sizeof(RestoreArgs));
+
+            te = items[next_item++];
+            ahlog(AH, 1, "launching item %d %s %s\n", te->dumpId, te->desc, te->tag);
+
+            /* the worker clones the archive itself, to connect on its own */
+            args->AH = AH;
+            args->te = te;
+            args->pse = &pstate->pse[next_slot];
+
+            slots[next_slot].child_id = spawn_dump(args);
+            slots[next_slot].args = args;
+            continue;
+        }
+
+        /* All slots are busy or there's nothing left to launch; wait for one */
+        thandle ret_child = reap_child(slots, n_slots, &work_status);
+
+        work_status_temp = (uint32)work_status;
+        if (!WIFEXITED(work_status_temp))
+            exit_horribly(modulename, "worker process crashed: status %d\n", work_status);
+        if (WEXITSTATUS(work_status_temp) != 0)
+            exit_horribly(modulename, "worker process failed: exit code %d\n", (int)WEXITSTATUS(work_status_temp));
+
+        te = NULL;
+        for (i = 0; i < n_slots; i++) {
+            if (slots[i].child_id == ret_child) {
+                te = slots[i].args->te;
+                free(slots[i].args);
+                slots[i].args = NULL;
+                slots[i].child_id = 0;
+                break;
+            }
+        }
+        if (te == NULL)
+            exit_horribly(modulename, "could not find slot of finished worker\n");
+
+        ahlog(AH, 1, "finished item %d %s %s\n", te->dumpId, te->desc, te->tag);
+    }
+
+    ahlog(AH, 1, "finished main parallel dump loop\n");
+
+    /* the exit handler falls back to closing AH->connection again */
+    shutdown_info.pstate = NULL;
+
+    free(pstate->pse);
+    pstate->pse = NULL;
+    free(pstate);
+    pstate = NULL;
+    free(slots);
+    slots = NULL;
+    free(items);
+    items = NULL;
+}
+
+/*
+ * qsort comparator putting the largest data first, then by dump ID.
+ */
+static int data_length_compare(const void* p1, const void* p2)
+{
+    const TocEntry* te1 = *(const TocEntry* const*)p1;
+    const TocEntry* te2 = *(const TocEntry* const*)p2;
+
+    if (te1->dataLength != te2->dataLength)
+        return (te1->dataLength > te2->dataLength) ? -1 : 1;
+    return (te1->dumpId < te2->dumpId) ? -1 : ((te1->dumpId > te2->dumpId) ? 1 : 0);
+}
+
+/*
+ * create a worker child to dump the data of an item in parallel
+ */
+static thandle spawn_dump(RestoreArgs* args)
+{
+    /* Ensure stdio state is quiesced before forking */
+    (void)fflush(NULL);
+
+#ifndef WIN32
+    thandle child = fork();
+    if (child == 0) {
+        /* in child process */
+        parallel_dump(args);
+    } else if (child < 0) {
+        /* fork failed */
+        exit_horribly(modulename, "could not create worker process: %s\n", strerror(errno));
+    }
+#else
+    thandle child = (HANDLE)_beginthreadex(NULL, 0, (unsigned int(__stdcall*)(void*))parallel_dump, args, 0, NULL);
+    if (child == 0)
+        exit_horribly(modulename, "could not create worker thread: %s\n", strerror(errno));
+#endif
+
+    return child;
+}
+
+/*
+ * Body of a parallel dump worker child.
+ */
+static parallel_restore_result parallel_dump(RestoreArgs* args)
+{
+    TocEntry* te = args->te;
+    ArchiveHandle* AH = NULL;
+
+    /*
+     * The clone connects to the database with the parameters of the parent's
+     * connection. On Unix the child also has a copy of the parent's
+     * connection, which it must leave alone.
+     */
+    AH = CloneArchive(args->AH);
+    setProcessIdentifier(args->pse, AH);
+
+    if (AH->SetupWorkerptr != NULL)
+        (AH->SetupWorkerptr)((Archive*)AH, te->dumpId);
+
+    WriteDataChunksForTocEntry(AH, te);
+
+    /* And clean up */
+    DisconnectDatabase((Archive*)AH);
+    unsetProcessIdentifier(args->pse);
+    DeCloneArchive(AH);
+
+#ifndef WIN32
+    exit(0);
+#else
+    return 0;
+#endif
+}
+
 /*
  * Clone and de-clone routines used in parallel restoration.
  *
@@ -71,6 +71,13 @@ typedef struct _z_stream {
 typedef z_stream* z_streamp;
 #endif
 
+/*
+ * Compression code of a directory format archive whose data files are
+ * compressed with LZ4 rather than gzip (see compress_io.cpp). It lies
+ * outside of the zlib levels, which are the other valid codes.
+ */
+#define DUMP_COMPRESSION_LZ4 100
+
 /* Current archive version number (the format we can output) */
 #define K_VERS_MAJOR 1
 #define K_VERS_MINOR 12
@@ -234,6 +241,9 @@ typedef struct _archiveHandle {
 
     CustomOutPtr CustomOutptr; /* Alternative script output routine */
 
+    SetupWorkerPtr SetupWorkerptr; /* Set up the connection of a parallel
+                                    * dump worker */
+
     /* Stuff for direct DB connection */
     char* archdbname; /* DB name *read* from archive */
     enum trivalue promptPassword;
@@ -265,7 +275,8 @@ typedef struct _archiveHandle {
     int compression;           /* Compression requested on open Possible
                                 * values for compression: -1
                                 * Z_DEFAULT_COMPRESSION 0	COMPRESSION_NONE
-                                * 1-9 levels for gzip compression */
+                                * 1-9 levels for gzip compression
+                                * DUMP_COMPRESSION_LZ4 (directory format only) */
     ArchiveMode mode;          /* File mode - r or w */
     void* formatData;          /* Header data specific to file format */
 
@@ -312,6 +323,8 @@ typedef struct _tocEntry {
 
     DataDumperPtr dataDumper; /* Routine to dump data for object */
     void* dataDumperArg;      /* Arg for above routine */
+    double dataLength;        /* estimated size of the data, in any unit; the
+                               * largest data is dumped first in parallel */
     void* formatData;         /* TOC Entry data specific to file format */
 
     /* working state while dumping/restoring */
@@ -7,9 +7,14 @@
  *	Large objects (BLOBs) are stored in separate files named "blob_<uid>.dat",
  *	and there's a plain-text TOC file for them called "blobs.toc". If
  *	compression is used, each data file is individually compressed and the
- *	".gz" suffix is added to the filenames. The TOC files are never
- *	compressed by pg_dump, however they are accepted with the .gz suffix too,
- *	in case the user has manually compressed them with 'gzip'.
+ *	".gz" suffix (".lz4" with LZ4 compression) is added to the filenames.
+ *	The TOC files are never compressed by pg_dump, however they are accepted
+ *	with the .gz suffix too, in case the user has manually compressed them
+ *	with 'gzip'.
+ *
+ *	As every data file is written on its own, the data of a dump can be
+ *	written by parallel workers, each with its own clone of the archive
+ *	(see WriteDataChunks).
  *
  *	NOTE: This format is identical to the files written in the tar file in
  *	the 'tar' format, except that we don't write the restore.sql file ,
@@ -81,6 +86,9 @@ static void _EndBlob(ArchiveHandle* AH, TocEntry* te, Oid oid);
 static void _EndBlobs(ArchiveHandle* AH, TocEntry* te);
 static void _LoadBlobs(ArchiveHandle* AH, RestoreOptions* ropt);
 
+static void _Clone(ArchiveHandle* AH);
+static void _DeClone(ArchiveHandle* AH);
+
 static char* prependDirectory(ArchiveHandle* AH, const char* relativeFilename);
 
 /*
@@ -118,8 +126,8 @@ void InitArchiveFmt_Directory(ArchiveHandle* AH)
     AH->EndBlobptr = _EndBlob;
     AH->EndBlobsptr = _EndBlobs;
 
-    AH->Cloneptr = NULL;
-    AH->DeCloneptr = NULL;
+    AH->Cloneptr = _Clone;
+    AH->DeCloneptr = _DeClone;
 
     /* Set up our private context */
     ctx = (lclContext*)pg_calloc(1, sizeof(lclContext));
@@ -206,19 +214,25 @@ static void _ArchiveEntry(ArchiveHandle* AH, TocEntry* te)
 static void _WriteExtraToc(ArchiveHandle* AH, TocEntry* te)
 {
     lclTocEntry* tctx = (lclTocEntry*)te->formatData;
-#ifdef HAVE_LIBZ
     char* fname = NULL;
     size_t flen = 0;
     int nRet = 0;
-#endif
 
     /*
      * A dumpable object has set tctx->filename, any other object has not.
      * (see _ArchiveEntry).
      */
     if ((tctx->filename) != NULL) {
+        if (AH->compression == DUMP_COMPRESSION_LZ4) {
+            flen = strlen(tctx->filename) + strlen(".lz4") + 1;
+            fname = (char*)pg_malloc(flen);
+            nRet = sprintf_s(fname, flen, "%s.lz4", tctx->filename);
+            securec_check_ss_c(nRet, fname, "\0");
+            WriteStr(AH, fname);
+            free(fname);
+            fname = NULL;
+        } else
 #ifdef HAVE_LIBZ
-
         if (AH->compression != 0) {
             flen = strlen(tctx->filename) + strlen(".gz") + 1;
             fname = (char*)pg_malloc(flen);
@@ -605,6 +619,32 @@ static void _EndBlobs(ArchiveHandle* AH, TocEntry* te)
     ctx->blobsTocFH = NULL;
 }
 
+/*
+ * Clone format-specific fields during parallel dump.
+ *
+ * A clone writes its own data files, so it only needs private file handles.
+ */
+static void _Clone(ArchiveHandle* AH)
+{
+    lclContext* ctx = (lclContext*)AH->formatData;
+
+    AH->formatData = (lclContext*)pg_malloc(sizeof(lclContext));
+    errno_t rc = memcpy_s(AH->formatData, sizeof(lclContext), ctx, sizeof(lclContext));
+    securec_check_c(rc, "\0", "\0");
+    ctx = (lclContext*)AH->formatData;
+
+    ctx->dataFH = NULL;
+    ctx->blobsTocFH = NULL;
+}
+
+static void _DeClone(ArchiveHandle* AH)
+{
+    lclContext* ctx = (lclContext*)AH->formatData;
+
+    free(ctx);
+    AH->formatData = NULL;
+}
+
 static char* prependDirectory(ArchiveHandle* AH, const char* relativeFilename)
 {
     lclContext* ctx = (lclContext*)AH->formatData;
@@ -167,6 +167,7 @@ bool g_verbose; /* User wants verbose narration of our
 
 /* various user-settable parameters */
 static int compressLevel = -1;
+static int numWorkers = 1;
 static bool outputBlobs = false;
 static int outputClean = 0;
 static int outputCreateDB = 0;
@@ -210,6 +211,12 @@ extern const char* encrypt_salt;
 /* subquery used to convert user ID (eg, datdba) to user name */
 static const char* username_subquery;
 
+/* schema selected by selectSourceSchema, NULL if none yet */
+static char* curSchemaName = NULL;
+
+/* snapshot exported for the parallel dump workers */
+static char* syncSnapshotId = NULL;
+
 /* obsolete as of 7.3: */
 static Oid g_last_builtin_oid; /* value of the last builtin oid */
 
@@ -290,6 +297,7 @@ static TablespaceInfo* g_tablespaces = nullptr;
 
 void help(const char* progname);
 static void setup_connection(Archive* AH);
+static void setupDumpWorker(Archive* AH, DumpId dumpId);
 static void dumpsyslog(Archive* fout);
 static void getopt_dump(int argc, char** argv, struct option options[], int* result);
 static void validatedumpoptions(void);
@@ -367,6 +375,7 @@ static void addBoundaryDependencies(DumpableObject** dobjs, int numObjs, Dumpabl
 
 static void getDomainConstraints(Archive* fout, TypeInfo* tyinfo);
 static void getTableData(TableInfo* tblinfo, int numTables);
+static void getTableDataSizes(Archive* fout);
 static void makeTableDataInfo(TableInfo* tbinfo, bool oids);
 static void buildMatViewRefreshDependencies(Archive* fout);
 static void getTableDataFKConstraints(void);
@@ -511,6 +520,7 @@ int main(int argc, char** argv)
         {"no-acl", no_argument, NULL, 'x'},
         {"compress", required_argument, NULL, 'Z'},
         {"encoding", required_argument, NULL, 'E'},
+        {"jobs", required_argument, NULL, 'j'},
         {"help", no_argument, NULL, '?'},
         {"version", no_argument, NULL, 'V'},
 
@@ -619,6 +629,17 @@ int main(int argc, char** argv)
     if (archiveFormat == archNull)
         plainText = 1;
 
+    /* Only the directory format can be written in parallel, or with LZ4 */
+    if (numWorkers > 1 && archiveFormat != archDirectory)
+        exit_horribly(NULL, "parallel backup only supported by the directory format\n");
+    if (compressLevel == DUMP_COMPRESSION_LZ4 && archiveFormat != archDirectory)
+        exit_horribly(NULL, "LZ4 compression only supported by the directory format\n");
+#ifdef ENABLE_MULTIPLE_NODES
+    /* the data is dumped after the transaction is ended, see below */
+    if (numWorkers > 1)
+        exit_horribly(NULL, "parallel backup is not supported in distributed mode\n");
+#endif
+
     /* Custom and directory formats are compressed by default, others not */
     if (compressLevel == -1) {
         if (archiveFormat == archCustom || archiveFormat == archDirectory)
@@ -665,6 +686,10 @@ int main(int argc, char** argv)
 
     /* Let the archiver know how noisy to be */
     fout->verbose = g_verbose;
+
+    /* and how many workers may dump the data, and how they get started */
+    fout->numWorkers = numWorkers;
+    ((ArchiveHandle*)fout)->SetupWorkerptr = setupDumpWorker;
     /* Database Security: Data importing/dumping support AES128. */
     check_encrypt_parameters(fout, encrypt_mode, encrypt_key);
 
@@ -792,6 +817,13 @@ int main(int argc, char** argv)
     } else
         ExecuteSqlStatement(fout, "SET TRANSACTION ISOLATION LEVEL SERIALIZABLE");
 
+    /* The parallel dump workers share the snapshot of this transaction */
+    if (numWorkers > 1) {
+        PGresult* res = ExecuteSqlQueryForSingleRow(fout, "SELECT pg_catalog.pg_export_snapshot()");
+        syncSnapshotId = gs_strdup(PQgetvalue(res, 0, 0));
+        PQclear(res);
+    }
+
     /* Select the appropriate subquery to convert user IDs to names */
     if (fout->remoteVersion >= 80100)
         username_subquery = "SELECT rolname FROM pg_catalog.pg_roles WHERE oid =";
@@ -852,6 +884,8 @@ int main(int argc, char** argv)
 
     if (!schemaOnly) {
         getTableData(tblinfo, numTables);
+        if (numWorkers > 1)
+            getTableDataSizes(fout);
         buildMatViewRefreshDependencies(fout);
         if (dataOnly)
             getTableDataFKConstraints();
@@ -988,6 +1022,16 @@ int main(int argc, char** argv)
         ExecuteSqlStatement(fout, "COMMIT");
 #endif
 
+    /*
+     * The passwords are still needed here, to connect the parallel dump
+     * workers.
+     */
+    CloseArchive(fout);
+
+#ifndef ENABLE_MULTIPLE_NODES
+        /* After the object is exported, the transaction is ended */
+        ExecuteSqlStatement(fout, "COMMIT");
+#endif
 
     /* Clear password related memory to avoid leaks when core. */
     if (((ArchiveHandle*)fout)->savedPassword != NULL) {
@@ -1012,12 +1056,7 @@ int main(int argc, char** argv)
 
     free((void*)format);
     format = NULL;
-    CloseArchive(fout);
-    
-#ifndef ENABLE_MULTIPLE_NODES
-        /* After the object is exported, the transaction is ended */
-        ExecuteSqlStatement(fout, "COMMIT");
-#endif
+    GS_FREE(syncSnapshotId);
 
     /*free the memory allocated for gs_restore options */
     free(ropt);
@@ -1179,7 +1218,7 @@ void getopt_dump(int argc, char** argv, struct option options[], int* result)
     char* listFilePath = NULL;
     char* listFileName = NULL;
 
-    while ((c = getopt_long(argc, argv, "abcCE:f:F:h:n:N:oOp:RsS:t:T:U:vwW:xZ:", options, result)) != -1) {
+    while ((c = getopt_long(argc, argv, "abcCE:f:F:h:j:n:N:oOp:RsS:t:T:U:vwW:xZ:", options, result)) != -1) {
         switch (c) {
             case 'a': /* Dump data only */
                 dataOnly = true;
@@ -1287,10 +1326,27 @@ void getopt_dump(int argc, char** argv, struct option options[], int* result)
                 aclsSkip = true;
                 break;
 
+            case 'j': /* number of dump jobs */
+                numWorkers = atoi(optarg);
+                if (numWorkers <= 0
+#ifdef WIN32
+                    || numWorkers > MAXIMUM_WAIT_OBJECTS
+#endif
+                ) {
+                    write_stderr(_("%s: invalid number of parallel jobs\n"), progname);
+                    write_stderr(_("Try \"%s --help\" for more information.\n"), progname);
+                    exit_nicely(1);
+                }
+                break;
+
             case 'Z': /* Compression Level */
+                if (pg_strcasecmp(optarg, "lz4") == 0) {
+                    compressLevel = DUMP_COMPRESSION_LZ4;
+                    break;
+                }
                 compressLevel = atoi(optarg);
                 if (compressLevel > 9 || compressLevel < 0) {
-                    write_stderr(_("%s: options -Z/--compress should be set between 0 and 9\n"), progname);
+                    write_stderr(_("%s: options -Z/--compress should be set between 0 and 9, or to lz4\n"), progname);
                     write_stderr(_("Try \"%s --help\" for more information.\n"), progname);
                     exit_nicely(1);
                 }
@@ -1546,7 +1602,10 @@ void help(const char* pchProgname)
              "                                              plain text (default))\n"));
     printf(_("  -v, --verbose                               verbose mode\n"));
     printf(_("  -V, --version                               output version information, then exit\n"));
-    printf(_("  -Z, --compress=0-9                          compression level for compressed formats\n"));
+    printf(_("  -j, --jobs=NUM                              use this many parallel jobs to dump the data of\n"
+             "                                              the directory format\n"));
+    printf(_("  -Z, --compress=0-9|lz4                      compression level for compressed formats, or LZ4\n"
+             "                                              compression of the directory format\n"));
     printf(_("  --lock-wait-timeout=TIMEOUT                 fail after waiting TIMEOUT for a table lock\n"));
     printf(_("  -?, --help                                  show this help, then exit\n"));
 
@@ -1754,6 +1813,63 @@ static void setup_connection(Archive* AH)
         ExecuteSqlStatement(AH, "SET quote_all_identifiers = true");
 }
 
+/*
+ * Set up the connection of a parallel dump worker the way the parent's one
+ * is, with a transaction seeing the snapshot exported by the parent.
+ */
+static void setupDumpWorker(Archive* AH, DumpId dumpId)
+{
+    DumpableObject* dobj = findObjectByDumpId(dumpId);
+    PQExpBuffer query = createPQExpBuffer();
+
+    /* the new connection has no schema selected yet */
+    GS_FREE(curSchemaName);
+
+    setup_connection(AH);
+    ExecuteSqlStatement(AH, "set resource_track_level='none'");
+
+    /* a DEFERRABLE transaction cannot import a snapshot, nor does it need to */
+    ExecuteSqlStatement(AH, "START TRANSACTION");
+    if (serializable_deferrable)
+        ExecuteSqlStatement(AH, "SET TRANSACTION ISOLATION LEVEL SERIALIZABLE, READ ONLY");
+    else
+        ExecuteSqlStatement(AH, "SET TRANSACTION ISOLATION LEVEL REPEATABLE READ");
+
+    appendPQExpBuffer(query, "SET TRANSACTION SNAPSHOT ");
+    appendStringLiteralConn(query, syncSnapshotId, GetConnection(AH));
+    ExecuteSqlStatement(AH, query->data);
+
+    /*
+     * The parent holds an ACCESS SHARE lock on the table. Should someone be
+     * queued for an exclusive lock on it by now, our own request would wait
+     * behind that one, which waits for the parent, which waits for us. The
+     * server cannot see such a deadlock, so don't wait at all.
+     */
+    if (dobj != NULL && dobj->objType == DO_TABLE_DATA) {
+        TableInfo* tbinfo = ((TableDataInfo*)dobj)->tdtable;
+
+        if (tbinfo->relkind == RELKIND_RELATION && !binary_upgrade && !non_Lock_Table) {
+            PGresult* res = NULL;
+
+            resetPQExpBuffer(query);
+            appendPQExpBuffer(query,
+                "LOCK TABLE %s IN ACCESS SHARE MODE NOWAIT",
+                fmtQualifiedId(AH, tbinfo->dobj.nmspace->dobj.name, tbinfo->dobj.name));
+            res = PQexec(GetConnection(AH), query->data);
+            if (PQresultStatus(res) != PGRES_COMMAND_OK)
+                exit_horribly(NULL,
+                    "could not obtain lock on table \"%s\" in a parallel worker: %s"
+                    "This usually means that someone requested an ACCESS EXCLUSIVE lock on the table "
+                    "after gs_dump got its ACCESS SHARE lock.\n",
+                    tbinfo->dobj.name,
+                    PQerrorMessage(GetConnection(AH)));
+            PQclear(res);
+        }
+    }
+
+    destroyPQExpBuffer(query);
+}
+
 static ArchiveFormat parseArchiveFormat(ArchiveMode* mode)
 {
     ArchiveFormat archiveFormat = archUnknown;
@@ -2452,6 +2568,7 @@ static void dumpTableData(Archive* fout, TableDataInfo* tdinfo)
     PQExpBuffer copyBuf = createPQExpBuffer();
     DataDumperPtr dumpFn = NULL;
     char* copyStmt = NULL;
+    TocEntry* te = NULL;
 
     if (!dump_inserts) {
         /* Dump/restore using COPY */
@@ -2474,7 +2591,7 @@ static void dumpTableData(Archive* fout, TableDataInfo* tdinfo)
      * dependency on its table as "special" and pass it to ArchiveEntry now.
      * See comments for BuildArchiveDependencies.
      */
-    ArchiveEntry(fout,
+    te = ArchiveEntry(fout,
         tdinfo->dobj.catId,
         tdinfo->dobj.dumpId,
         tbinfo->dobj.name,
@@ -2492,6 +2609,9 @@ static void dumpTableData(Archive* fout, TableDataInfo* tdinfo)
         dumpFn,
         tdinfo);
 
+    /* parallel dump starts with the largest tables */
+    te->dataLength = tbinfo->relpages;
+
     destroyPQExpBuffer(copyBuf);
 }
 
@@ -2545,6 +2665,39 @@ static void getTableData(TableInfo* tblinfo, int numTables)
     }
 }
 
+/*
+ * getTableDataSizes -
+ *	  get the size of the tables, so that parallel dump can start with the
+ *	  largest ones and not end waiting for one of those
+ */
+static void getTableDataSizes(Archive* fout)
+{
+    PQExpBuffer query = createPQExpBuffer();
+    PGresult* res = NULL;
+    int ntups;
+    int i;
+
+    selectSourceSchema(fout, "pg_catalog");
+
+    appendPQExpBuffer(query,
+        "SELECT c.oid, c.relpages FROM pg_catalog.pg_class c "
+        "WHERE c.relkind IN ('%c', '%c')",
+        RELKIND_RELATION,
+        RELKIND_MATVIEW);
+    res = ExecuteSqlQuery(fout, query->data, PGRES_TUPLES_OK);
+
+    ntups = PQntuples(res);
+    for (i = 0; i < ntups; i++) {
+        TableInfo* tbinfo = findTableByOid(atooid(PQgetvalue(res, i, 0)));
+
+        if (tbinfo != NULL)
+            tbinfo->relpages = atof(PQgetvalue(res, i, 1));
+    }
+
+    PQclear(res);
+    destroyPQExpBuffer(query);
+}
+
 /*
  * Make a dumpable object for the data of this specific table
  *
@@ -19409,7 +19562,6 @@ static void findDumpableDependencies(
  */
 static void selectSourceSchema(Archive* fout, const char* schemaName)
 {
-    static char* curSchemaName = NULL;
     PQExpBuffer query;
 
     /* Not relevant if fetching from pre-7.3 DB */
@@ -207,6 +207,7 @@ typedef struct _tableInfo {
     char* reltablespace;      /* relation tablespace */
     char* reloptions;         /* options specified by WITH (...) */
     Oid   relbucket;          /* relation bucket OID */	    
+    double relpages;          /* pg_class.relpages, fetched for parallel dump only */
     char* toast_reloptions;   /* WITH options for the TOAST table */
     bool hasindex;            /* does it have any indexes? */
     bool hasrules;            /* does it have any rules? */
@@ -2522,12 +2522,13 @@ void index_build(Relation heapRelation, Partition heapPartition, Relation indexR
      * Determine worker process details for parallel CREATE INDEX.
      * Don't support parallel in next cases:
      * 1. system relation(toast, pg_catalog, etc..., cause it's easy lead to dead lock for sys table)
-     * 2. Non-btree index
+     * 2. Index access method other than btree, hash and gin
      * 3. Foreign table(Now only MOT can create index, other foreign tables can't)
      * Note that planner considers parallel safety for us.
      */
     if (parallel && IsNormalProcessingMode() && !IsSystemRelation(heapRelation) &&
-        indexRelation->rd_rel->relam == BTREE_AM_OID && !RelationIsForeignTable(heapRelation)) {
+        (indexRelation->rd_rel->relam == BTREE_AM_OID || indexRelation->rd_rel->relam == HASH_AM_OID ||
+        indexRelation->rd_rel->relam == GIN_AM_OID) && !RelationIsForeignTable(heapRelation)) {
         indexInfo->ii_ParallelWorkers =
             plan_create_index_workers(RelationGetRelid(heapRelation), RelationGetRelid(indexRelation));
     }
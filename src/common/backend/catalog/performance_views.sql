@@ -4162,6 +4162,12 @@ CREATE OR REPLACE VIEW DBE_PERF.global_double_write_status AS
            total_pages, low_threshold_pages, high_threshold_pages
     FROM pg_catalog.local_double_write_stat();
 
+CREATE OR REPLACE VIEW DBE_PERF.global_double_write_file_status AS
+    SELECT node_name, file_id, curr_dwn, curr_start_page, file_trunc_num, file_reset_num,
+           total_writes, low_threshold_writes, high_threshold_writes,
+           total_pages, low_threshold_pages, high_threshold_pages
+    FROM pg_catalog.local_double_write_file_stat();
+
 CREATE VIEW DBE_PERF.global_get_bgwriter_status AS
         SELECT node_name,bgwr_actual_flush_total_num,bgwr_last_flush_num,candidate_slots,get_buffer_from_list,get_buf_clock_sweep
         FROM pg_catalog.remote_bgwriter_stat()
@@ -4184,6 +4190,10 @@ CREATE OR REPLACE VIEW DBE_PERF.global_redo_status AS
            apply_counter, apply_total_dur,
            speed, local_max_ptr, primary_flush_ptr, worker_info
     FROM pg_catalog.local_redo_stat();
+
+CREATE OR REPLACE VIEW DBE_PERF.global_redo_prefetch_status AS
+    SELECT node_name, prefetch_distance, prefetch_issued, buffer_hits, recent_hits, skip_init, throttled
+    FROM pg_catalog.local_redo_prefetch_stat();
   
 CREATE OR REPLACE VIEW DBE_PERF.global_rto_status AS
 SELECT node_name, rto_info
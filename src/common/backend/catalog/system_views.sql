@@ -1403,6 +1403,23 @@ CREATE VIEW gs_session_time AS SELECT * FROM pv_session_time();
 CREATE VIEW gs_session_memory AS SELECT * FROM pv_session_memory();
 CREATE VIEW gs_total_memory_detail AS SELECT * FROM pv_total_memory_detail();
 CREATE VIEW gs_redo_stat AS SELECT * FROM pg_stat_get_redo_stat();
+CREATE VIEW gs_cu_cache_stat AS SELECT * FROM pg_stat_get_cu_cache_stat();
+CREATE VIEW gs_cstore_delta_stat AS
+    SELECT
+            S.relid,
+            N.nspname AS schemaname,
+            C.relname,
+            P.relname AS partname,
+            S.delta_relid,
+            S.live_tuples,
+            S.dead_tuples,
+            S.delta_bytes,
+            S.last_merge,
+            S.merge_lag
+    FROM pg_stat_get_cstore_delta_stat() S
+            JOIN pg_class C ON (C.oid = S.relid)
+            LEFT JOIN pg_namespace N ON (N.oid = C.relnamespace)
+            LEFT JOIN pg_partition P ON (P.oid = S.partid);
 CREATE VIEW gs_session_stat AS SELECT * FROM pv_session_stat();
 CREATE VIEW gs_file_stat AS SELECT * FROM pg_stat_get_file_stat();
 
@@ -1517,7 +1534,13 @@ CREATE VIEW pg_stat_replication AS
             W.receiver_flush_location,
             W.receiver_replay_location,
             W.sync_priority,
-            W.sync_state
+            W.sync_state,
+            W.compression,
+            W.sent_raw_bytes,
+            W.sent_compressed_bytes,
+            W.compress_time,
+            W.buffer_read_bytes,
+            W.file_read_bytes
     FROM pg_stat_get_activity(NULL) AS S, pg_authid U,
             pg_stat_get_wal_senders() AS W
     WHERE S.usesysid = U.oid AND
@@ -1538,6 +1561,21 @@ CREATE VIEW pg_replication_slots AS
     FROM pg_get_replication_slots() AS L
             LEFT JOIN pg_database D ON (L.datoid = D.oid);
 
+CREATE VIEW pg_stat_replication_slots AS
+    SELECT
+            S.slot_name,
+            S.spill_txns,
+            S.spill_count,
+            S.spill_bytes,
+            S.stream_txns,
+            S.stream_count,
+            S.stream_bytes,
+            S.total_txns,
+            S.total_bytes,
+            S.decoded_records,
+            S.decoded_bytes
+    FROM pg_stat_get_replication_slots() AS S;
+
 
 CREATE VIEW pg_stat_database AS
     SELECT
@@ -2485,6 +2523,17 @@ CREATE VIEW pg_node_env AS
 			S.datapath,
 			S.log_directory
     FROM pg_stat_get_env() AS S;
+
+CREATE VIEW pg_stat_lwlock_tranches AS
+    SELECT
+            S.tranche,
+            S.queue_mode,
+            S.spin_acquired,
+            S.spin_failed,
+            S.blocked,
+            S.wait_time_hist,
+            S.hold_time_hist
+    FROM pg_stat_get_lwlock_tranches() AS S;
 	
 /*
  * PGXC system view to look for libcomm stat
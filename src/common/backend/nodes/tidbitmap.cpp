@@ -28,6 +28,16 @@
  * into a bitmap, and it can also happen internally when we AND a lossy
  * and a non-lossy page.
  *
+ * The pages are kept in a radix tree per partition, keyed by the chunk
+ * number of the page (block number DIV PAGES_PER_CHUNK), one byte per
+ * level.  The leaves hold the lossy bits of their chunk, and a compact
+ * container for each exact page: a sorted array of offsets, a list of
+ * offset runs, or a plain bitmap, whichever is enough.  Since the tree is
+ * ordered, iteration needs no sort, and set operations work a chunk at a
+ * time instead of looking up every page.  All of the tree lives in its own
+ * memory context, which is a child of the shared context when the bitmap
+ * is built for a parallel bitmap heap scan.
+ *
  *
  * Copyright (c) 2003-2012, PostgreSQL Global Development Group
  *
@@ -44,7 +54,7 @@
 #include "access/htup.h"
 #include "nodes/bitmapset.h"
 #include "nodes/tidbitmap.h"
-#include "utils/hsearch.h"
+#include "utils/memutils.h"
 #include "storage/lwlock.h"
 
 /*
@@ -56,19 +66,10 @@
 #define MAX_TUPLES_PER_PAGE MaxHeapTuplesPerPage
 
 /*
- * When we have to switch over to lossy storage, we use a data structure
- * with one bit per page, where all pages having the same number DIV
- * PAGES_PER_CHUNK are aggregated into one chunk.  When a chunk is present
- * and has the bit set for a given page, there must not be a per-page entry
- * for that page in the page table.
- *
- * We actually store both exact pages and lossy chunks in the same hash
- * table, using identical data structures.	(This is because dynahash.c's
- * memory management doesn't allow space to be transferred easily from one
- * hashtable to another.)  Therefore it's best if PAGES_PER_CHUNK is the
- * same as MAX_TUPLES_PER_PAGE, or at least not too different.	But we
- * also want PAGES_PER_CHUNK to be a power of 2 to avoid expensive integer
- * remainder operations.  So, define it like this:
+ * Each leaf of the radix tree covers PAGES_PER_CHUNK consecutive pages,
+ * which is also the granularity at which pages are made lossy when we run
+ * out of memory.  We want PAGES_PER_CHUNK to be a power of 2 to avoid
+ * expensive integer remainder operations.  So, define it like this:
  */
 #define PAGES_PER_CHUNK (BLCKSZ / 32)
 
@@ -76,94 +77,157 @@
 
 #define WORDNUM(x) ((x) / BITS_PER_BITMAPWORD)
 #define BITNUM(x) ((x) % BITS_PER_BITMAPWORD)
+#define BIT_IS_SET(words, x) (((words)[WORDNUM(x)] & ((bitmapword)1 << (unsigned int)BITNUM(x))) != 0)
 
 /* number of active words for an exact page: */
 #define WORDS_PER_PAGE ((MAX_TUPLES_PER_PAGE - 1) / BITS_PER_BITMAPWORD + 1)
-/* number of active words for a lossy chunk: */
+/* number of active words for a chunk: */
 #define WORDS_PER_CHUNK ((PAGES_PER_CHUNK - 1) / BITS_PER_BITMAPWORD + 1)
-/* compare two entry node. For regular table, partitionOid is set to Invalid */
-#define IS_ENTRY_NODE_MATCH(tarNode, matchNode) \
-    (tarNode.blockNo == matchNode.blockNo && tarNode.partitionOid == matchNode.partitionOid)
-
-#define IS_CHUNK_BEFORE_PAGE(chunkNode, pageNode)             \
-    (chunkNode.partitionOid < pageNode.partitionOid           \
-            ? true                                            \
-            : (chunkNode.partitionOid > pageNode.partitionOid \
-                      ? false                                 \
-                      : (chunkNode.blockNo < pageNode.blockNo ? true : false)))
+
 /*
- * Used as key of hash table for PagetableEntry.
+ * The inner nodes of the radix tree.  A node starts with room for 16
+ * children, kept sorted by key byte, and is replaced by a node indexed
+ * directly by the key byte once it needs more.  Level 0 nodes point to
+ * leaves, and the root of each partition is at level TBM_LEVELS - 1.
  */
-typedef struct PagetableEntryNode_s {
-    BlockNumber blockNo;    /* page number (hashtable key) */
-    Oid partitionOid;       /* used for GLOBAL partition index to indicate partition table */
-} PagetableEntryNode;
+#define TBM_FANOUT_BITS 8
+#define TBM_FANOUT (1 << TBM_FANOUT_BITS)
+#define TBM_LEVELS 3
+#define TBM_NODE16_MAX 16
+
+#define TBM_CHUNKNO(blockNo) ((blockNo) / PAGES_PER_CHUNK)
+#define TBM_KEY_BYTE(chunkNo, level) ((uint8)((chunkNo) >> (TBM_FANOUT_BITS * (unsigned int)(level))))
+
+typedef enum {
+    TBM_NODE_16,  /* up to 16 children, with sorted keys */
+    TBM_NODE_256  /* children indexed by key byte */
+} TBMNodeKind;
+
+typedef struct TBMNode {
+    uint8 kind;   /* see TBMNodeKind */
+    uint8 level;  /* 0 if the children are leaves */
+    uint16 count; /* number of children */
+} TBMNode;
+
+typedef struct TBMNode16 {
+    TBMNode hdr;
+    uint8 keys[TBM_NODE16_MAX];
+    void* children[TBM_NODE16_MAX];
+} TBMNode16;
+
+typedef struct TBMNode256 {
+    TBMNode hdr;
+    void* children[TBM_FANOUT];
+} TBMNode256;
+
 /*
- * The hashtable entries are represented by this data structure.  For
- * an exact page, blockno is the page number and bit k of the bitmap
- * represents tuple offset k+1.  For a lossy chunk, blockno is the first
- * page in the chunk (this must be a multiple of PAGES_PER_CHUNK) and
- * bit k represents page blockno+k.  Note that it is not possible to
- * have exact storage for the first page of a chunk if we are using
- * lossy storage for any page in the chunk's range, since the same
- * hashtable entry has to serve both purposes.
- *
- * recheck is used only on exact pages --- it indicates that although
- * only the stated tuples need be checked, the full index qual condition
- * must be checked for each (ie, these are candidate matches).
+ * The tuples of an exact page are kept in the smallest of these containers
+ * that can hold them.  Arrays and runs are used for pages with few matches
+ * or with matches clustered together, which is the common case for index
+ * scans, and take about half the space of a bitmap.  A container is
+ * allocated with only the room its kind needs.
  */
-typedef struct PagetableEntry {
-    PagetableEntryNode entryNode;
-    bool ischunk;        /* T = lossy storage, F = exact */
-    bool recheck;        /* should the tuples be rechecked? */
-    bitmapword words[Max(WORDS_PER_PAGE, WORDS_PER_CHUNK)];
-} PagetableEntry;
+typedef enum {
+    TBM_ARRAY,  /* sorted offsets */
+    TBM_RUN,    /* sorted runs of consecutive offsets */
+    TBM_BITMAP  /* bit k represents tuple offset k+1 */
+} TBMContainerKind;
+
+#define TBM_ARRAY_MAX 10
+#define TBM_RUN_MAX 5
+
+typedef struct TBMRun {
+    uint16 first;  /* first offset of the run */
+    uint16 length; /* number of offsets in the run */
+} TBMRun;
+
+typedef struct TBMContainer {
+    uint8 kind;    /* see TBMContainerKind */
+    bool recheck;  /* should the tuples be rechecked? */
+    uint16 count;  /* number of offsets or runs */
+    union {
+        OffsetNumber offsets[TBM_ARRAY_MAX];
+        TBMRun runs[TBM_RUN_MAX];
+        bitmapword words[WORDS_PER_PAGE];
+    } u;
+} TBMContainer;
+
+#define TBM_SMALL_CONTAINER_SIZE \
+    MAXALIGN(offsetof(TBMContainer, u) + Max(sizeof(OffsetNumber) * TBM_ARRAY_MAX, sizeof(TBMRun) * TBM_RUN_MAX))
+#define TBM_BITMAP_CONTAINER_SIZE MAXALIGN(offsetof(TBMContainer, u) + sizeof(bitmapword) * WORDS_PER_PAGE)
+#define TBM_CONTAINER_CLASS(kind) ((kind) == TBM_BITMAP ? 1 : 0)
+#define TBM_CONTAINER_SIZE(kind) ((kind) == TBM_BITMAP ? TBM_BITMAP_CONTAINER_SIZE : TBM_SMALL_CONTAINER_SIZE)
+
+/* containers are carved out of slabs, which grow from 1kB up to 8kB */
+#define TBM_SLAB_MIN_SIZE ((Size)1024)
+#define TBM_SLAB_MAX_SIZE ((Size)8192)
 
 /*
- * dynahash.c is optimized for relatively large, long-lived hash tables.
- * This is not ideal for TIDBitMap, particularly when we are using a bitmap
- * scan on the inside of a nestloop join: a bitmap may well live only long
- * enough to accumulate one entry in such cases.  We therefore avoid creating
- * an actual hashtable until we need two pagetable entries.  When just one
- * pagetable entry is needed, we store it in a fixed field of TIDBitMap.
- * (NOTE: we don't get rid of the hashtable if the bitmap later shrinks down
- * to zero or one page again.  So, status can be TBM_HASH even when nentries
- * is zero or one.)
+ * A leaf covers the PAGES_PER_CHUNK pages starting at firstBlock.  A page is
+ * either lossy, exact, or not in the bitmap at all.  The containers of the
+ * exact pages are kept in page order, so the container of page p is at the
+ * number of exact pages before p.
  */
-typedef enum {
-    TBM_EMPTY,    /* no hashtable, nentries == 0 */
-    TBM_ONE_PAGE, /* entry1 contains the single entry */
-    TBM_HASH      /* pagetable is valid, entry1 is not */
-} TBMStatus;
+typedef struct TBMLeaf {
+    Oid partitionOid;                  /* used for GLOBAL partition index to indicate partition table */
+    BlockNumber firstBlock;            /* first page of the chunk */
+    bitmapword lossy[WORDS_PER_CHUNK]; /* pages stored lossily */
+    bitmapword exact[WORDS_PER_CHUNK]; /* pages having a container */
+    uint16 npages;                     /* number of exact pages */
+    uint16 maxpages;                   /* allocated length of pages */
+    TBMContainer** pages;              /* containers of the exact pages */
+} TBMLeaf;
+
+/* The radix tree of one partition.  For regular table, partitionOid is set to Invalid */
+typedef struct TBMRoot {
+    Oid partitionOid;
+    TBMNode* node;
+} TBMRoot;
 
 /*
  * Current iterating state of the TBM.
  */
 typedef enum {
-    TBM_NOT_ITERATING,      /* not yet converted to page and chunk array */
-    TBM_ITERATING_PRIVATE,  /* converted to local page and chunk array */
-    TBM_ITERATING_SHARED    /* converted to shared page and chunk array */
+    TBM_NOT_ITERATING,      /* not yet converted to the leaf array */
+    TBM_ITERATING_PRIVATE,  /* converted to the leaf array, iterated locally */
+    TBM_ITERATING_SHARED    /* converted to the leaf array, iterated jointly */
 } TBMIteratingState;
 
 /*
- * Here is the representation for a whole TIDBitMap:
+ * The memory of a bitmap iterated by several processes is released by the
+ * last of its shared iterators.
+ */
+typedef struct TBMSharedArea {
+    MemoryContext treecxt;      /* context holding the tree and this struct */
+    pg_atomic_uint32 refcount;  /* shared iterators still using the tree */
+} TBMSharedArea;
+
+/*
+ * Here is the representation for a whole TIDBitmap:
  */
 struct TIDBitmap {
-    NodeTag type;          /* to make it a valid Node */
-    MemoryContext mcxt;    /* memory context containing me */
-    TBMStatus status;      /* see codes above */
-    HTAB* pagetable;       /* hash table of PagetableEntry's */
-    int nentries;          /* number of entries in pagetable */
-    int maxentries;        /* limit on same to meet maxbytes */
-    int npages;            /* number of exact entries in pagetable */
-    int nchunks;           /* number of lossy entries in pagetable */
-    TBMIteratingState iterating;    /* tbm_begin_iterate called? */
-    bool isGlobalPart;     /* represent global partition index tbm */
-    bool isShared;         /* is shared pagetable? */
-    PagetableEntry entry1; /* used when status == TBM_ONE_PAGE */
+    NodeTag type;                 /* to make it a valid Node */
+    MemoryContext mcxt;           /* memory context containing me */
+    MemoryContext treecxt;        /* memory context of the tree, or NULL */
+    TBMRoot* roots;               /* one tree per partition, sorted by OID */
+    int nroots;                   /* number of roots */
+    int maxroots;                 /* allocated length of roots */
+    int nleaves;                  /* number of leaves in the trees */
+    long npages;                  /* number of exact pages */
+    long nlossy;                  /* number of lossy pages */
+    Size memused;                 /* bytes used by the trees */
+    Size maxbytes;                /* limit on same */
+    TBMLeaf* lastleaf;            /* leaf found by the last lookup, or NULL */
+    char* slab;                   /* free space of the current container slab */
+    Size slabfree;                /* bytes left in it */
+    Size slabsize;                /* size of the next slab */
+    TBMContainer* freelist[2];    /* free small and bitmap containers */
+    TBMIteratingState iterating;  /* tbm_begin_iterate called? */
+    bool isGlobalPart;            /* represent global partition index tbm */
+    bool isShared;                /* is the tree in a shared context? */
     /* these are valid when iterating is true: */
-    PagetableEntry** spages;  /* sorted exact-page list, or NULL */
-    PagetableEntry** schunks; /* sorted lossy-chunk list, or NULL */
+    TBMLeaf** sleaves;            /* leaves in iteration order, or NULL */
+    TBMSharedArea* sharedarea;    /* set up by tbm_prepare_shared_iterate */
 };
 
 /*
@@ -174,9 +238,8 @@ struct TIDBitmap {
  */
 struct TBMIterator {
     TIDBitmap* tbm;          /* TIDBitmap we're iterating over */
-    int spageptr;            /* next spages index */
-    int schunkptr;           /* next schunks index */
-    int schunkbit;           /* next bit to check in current schunk */
+    int leafptr;             /* next sleaves index */
+    int pageptr;             /* next page to check in the current leaf */
     TBMIterateResult output; /* MUST BE LAST (because variable-size) */
 };
 
@@ -185,22 +248,12 @@ struct TBMIterator {
  * can jointly iterate.
  */
 struct TBMSharedIteratorState {
-    int nentries;          /* number of entries in pagetable */
-    int maxentries;        /* limit on same to meet maxbytes */
-    int npages;            /* number of exact entries in pagetable */
-    int nchunks;           /* number of lossy entries in pagetable */
-    TBMStatus status;      /* see codes above */
-    PagetableEntry entry1; /* used when status == TBM_ONE_PAGE */
-    HTAB* pagetable;       /* hash table of PagetableEntry's */
-    PagetableEntry** spages;    /* sorted exact-page list, or NULL */
-    PagetableEntry** schunks;   /* sorted lossy-chunk list, or NULL */
-    pg_atomic_uint32 pagetableRefcount; /* ref count for pagetable */
-    pg_atomic_uint32 pagesRefcount;     /* ref count for spages */
-    pg_atomic_uint32 chunksRefcount;    /* ref count for schunks */
+    TBMSharedArea* area;   /* memory of the iterated tree */
+    TBMLeaf** sleaves;     /* leaves in iteration order, or NULL */
+    int nleaves;           /* number of leaves */
     LWLock lock;           /* lock to protect below members */
-    int spageptr;          /* next spages index */
-    int schunkptr;         /* next schunks index */
-    int schunkbit;         /* next bit to check in current schunk */
+    int leafptr;           /* next sleaves index */
+    int pageptr;           /* next page to check in the current leaf */
 };
 
 /*
@@ -213,15 +266,19 @@ struct TBMSharedIterator {
 };
 
 /* Local function prototypes */
-static void tbm_union_page(TIDBitmap *a, const PagetableEntry *bpage);
-static bool tbm_intersect_page(TIDBitmap* a, PagetableEntry* apage, const TIDBitmap* b);
-static const PagetableEntry* tbm_find_pageentry(const TIDBitmap* tbm, PagetableEntryNode pageNode);
-static PagetableEntry* tbm_get_pageentry(TIDBitmap* tbm, PagetableEntryNode pageNode);
-static bool tbm_page_is_lossy(const TIDBitmap* tbm, PagetableEntryNode pageNode);
-static void tbm_mark_page_lossy(TIDBitmap* tbm, PagetableEntryNode pageNode);
+static TBMContainer* tbm_container_alloc(TIDBitmap* tbm, TBMContainerKind kind);
+static void tbm_container_free(TIDBitmap* tbm, TBMContainer* c);
+static TBMContainer* tbm_container_from_words(TIDBitmap* tbm, const bitmapword* words, bool recheck);
+static const TBMRoot* tbm_find_root(const TIDBitmap* tbm, Oid partitionOid);
+static const TBMLeaf* tbm_find_leaf(const TIDBitmap* tbm, Oid partitionOid, BlockNumber blockNo);
+static TBMLeaf* tbm_get_leaf(TIDBitmap* tbm, Oid partitionOid, BlockNumber blockNo);
+static void tbm_free_leaf(TIDBitmap* tbm, TBMLeaf* leaf);
+static void tbm_free_node(TIDBitmap* tbm, TBMNode* node);
+static void tbm_union_leaf(TIDBitmap* a, const TBMLeaf* bleaf);
+static bool tbm_intersect_node(TIDBitmap* a, TBMNode* node, const TIDBitmap* b);
+static bool tbm_intersect_leaf(TIDBitmap* a, TBMLeaf* aleaf, const TIDBitmap* b);
 static void tbm_lossify(TIDBitmap* tbm);
-static int tbm_comparator(const void* left, const void* right);
-static void tbm_sort_pages(TIDBitmap* tbm);
+static void tbm_collect_leaves(TIDBitmap* tbm);
 
 /*
  * tbm_create - create an initially-empty bitmap
@@ -235,7 +292,10 @@ static void tbm_sort_pages(TIDBitmap* tbm);
 TIDBitmap* tbm_create(long maxbytes, MemoryContext dsa)
 {
     TIDBitmap* tbm = NULL;
-    long nbuckets;
+
+    /* the key bytes of the tree must cover every chunk number */
+    StaticAssertStmt(((uint64)PAGES_PER_CHUNK << (TBM_FANOUT_BITS * TBM_LEVELS)) >= ((uint64)1 << 32),
+        "radix tree of TIDBitmap is too shallow");
 
     /* Create the TIDBitmap struct and zero all its fields */
     tbm = makeNode(TIDBitmap);
@@ -247,60 +307,26 @@ TIDBitmap* tbm_create(long maxbytes, MemoryContext dsa)
         tbm->mcxt = dsa;
         tbm->isShared = true;
     }
-    tbm->status = TBM_EMPTY;
     tbm->isGlobalPart = false;
-    /*
-     * Estimate number of hashtable entries we can have within maxbytes. This
-     * estimates the hash overhead at MAXALIGN(sizeof(HASHELEMENT)) plus a
-     * pointer per hash entry, which is crude but good enough for our purpose.
-     * Also count an extra Pointer per entry for the arrays created during
-     * iteration readout.
-     */
-    nbuckets = maxbytes /
-               (MAXALIGN(sizeof(HASHELEMENT)) + MAXALIGN(sizeof(PagetableEntry)) + sizeof(Pointer) + sizeof(Pointer));
-    nbuckets = Min(nbuckets, INT_MAX - 1); /* safety limit */
-    nbuckets = Max(nbuckets, 16);          /* sanity limit */
-    tbm->maxentries = (int)nbuckets;
+    tbm->maxbytes = (Size)Max(maxbytes, 0L);
+    tbm->slabsize = TBM_SLAB_MIN_SIZE;
 
     return tbm;
 }
 
 /*
- * Actually create the hashtable.  Since this is a moderately expensive
- * proposition, we don't do it until we have to.
+ * Actually create the memory context of the tree.  Since this is a moderately
+ * expensive proposition, we don't do it until we have to.
  */
-static void tbm_create_pagetable(TIDBitmap* tbm)
+static void tbm_create_tree(TIDBitmap* tbm)
 {
-    HASHCTL hash_ctl;
-    int rc = 0;
+    Assert(tbm->treecxt == NULL);
 
-    Assert(tbm->status != TBM_HASH);
-    Assert(tbm->pagetable == NULL);
-
-    /* Create the hashtable proper */
-    rc = memset_s(&hash_ctl, sizeof(hash_ctl), 0, sizeof(hash_ctl));
-    securec_check(rc, "", "");
-    hash_ctl.keysize = sizeof(PagetableEntryNode);
-    hash_ctl.entrysize = sizeof(PagetableEntry);
-    hash_ctl.hash = tag_hash;
-    hash_ctl.hcxt = tbm->mcxt;
-    tbm->pagetable = hash_create("TIDBitmap",
-        128, /* start small and extend */
-        &hash_ctl,
-        HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
-
-    /* If entry1 is valid, push it into the hashtable */
-    if (tbm->status == TBM_ONE_PAGE) {
-        PagetableEntry* page = NULL;
-        bool found = false;
-
-        page = (PagetableEntry*)hash_search(tbm->pagetable, (void*)&tbm->entry1.entryNode, HASH_ENTER, &found);
-        Assert(!found);
-        errno_t rc = memcpy_s(page, sizeof(PagetableEntry), &tbm->entry1, sizeof(PagetableEntry));
-        securec_check(rc, "\0", "\0");
-    }
-
-    tbm->status = TBM_HASH;
+    tbm->treecxt = AllocSetContextCreate(tbm->mcxt,
+        "TIDBitmap",
+        ALLOCSET_SMALL_MINSIZE,
+        ALLOCSET_SMALL_INITSIZE,
+        ALLOCSET_DEFAULT_MAXSIZE);
 }
 
 /*
@@ -309,13 +335,11 @@ static void tbm_create_pagetable(TIDBitmap* tbm)
 void tbm_free(TIDBitmap* tbm)
 {
     /*
-     * Don't call hash_destroy when it's shared, cause the memcxt for hash table is already deleted
-     * when calling dsm_detach. Same for spages and schunks, cause they are alloc by the same memcxt.
+     * Don't delete the tree when it's shared, cause it is released by the
+     * last shared iterator, or along with the shared context.
      */
-    if (!tbm->isShared) {
-        hash_destroy(tbm->pagetable);
-        pfree_ext(tbm->spages);
-        pfree_ext(tbm->schunks);
+    if (!tbm->isShared && tbm->treecxt != NULL) {
+        MemoryContextDelete(tbm->treecxt);
     }
     pfree_ext(tbm);
 }
@@ -323,22 +347,413 @@ void tbm_free(TIDBitmap* tbm)
 /*
  * tbm_free_shared_area - free shared state
  *
- * Free shared iterator state, Also free shared pagetable and iterator arrays
- * memory if they are not referred by any of the shared iterator i.e recount
- * is becomes 0.
+ * Free shared iterator state, Also free the tree if it is not referred by
+ * any other shared iterator i.e refcount becomes 0.
  */
 void tbm_free_shared_area(TBMSharedIteratorState *istate)
 {
-    if (pg_atomic_sub_fetch_u32(&istate->pagetableRefcount, 1) == 0) {
-        hash_destroy(istate->pagetable);
+    if (pg_atomic_sub_fetch_u32(&istate->area->refcount, 1) == 0) {
+        MemoryContextDelete(istate->area->treecxt);
     }
-    if (pg_atomic_sub_fetch_u32(&istate->pagesRefcount, 1) == 0) {
-        pfree_ext(istate->spages);
+    pfree_ext(istate);
+}
+
+/*
+ * tbm_container_alloc - get an empty container of the given kind
+ */
+static TBMContainer* tbm_container_alloc(TIDBitmap* tbm, TBMContainerKind kind)
+{
+    int sizeclass = TBM_CONTAINER_CLASS(kind);
+    Size size = TBM_CONTAINER_SIZE(kind);
+    TBMContainer* c = tbm->freelist[sizeclass];
+
+    if (c != NULL) {
+        tbm->freelist[sizeclass] = *(TBMContainer**)c;
+    } else {
+        if (tbm->slabfree < size) {
+            tbm->slab = (char*)MemoryContextAlloc(tbm->treecxt, tbm->slabsize);
+            tbm->slabfree = tbm->slabsize;
+            tbm->slabsize = Min(tbm->slabsize * 2, TBM_SLAB_MAX_SIZE);
+        }
+        c = (TBMContainer*)tbm->slab;
+        tbm->slab += size;
+        tbm->slabfree -= size;
     }
-    if (pg_atomic_sub_fetch_u32(&istate->chunksRefcount, 1) == 0) {
-        pfree_ext(istate->schunks);
+    tbm->memused += size;
+
+    c->kind = (uint8)kind;
+    c->recheck = false;
+    c->count = 0;
+    return c;
+}
+
+static void tbm_container_free(TIDBitmap* tbm, TBMContainer* c)
+{
+    int sizeclass = TBM_CONTAINER_CLASS(c->kind);
+
+    tbm->memused -= TBM_CONTAINER_SIZE(c->kind);
+    *(TBMContainer**)c = tbm->freelist[sizeclass];
+    tbm->freelist[sizeclass] = c;
+}
+
+/*
+ * tbm_container_words - expand a container into a bitmap of its page
+ */
+static void tbm_container_words(const TBMContainer* c, bitmapword* words)
+{
+    errno_t rc;
+
+    if (c->kind == TBM_BITMAP) {
+        rc = memcpy_s(words, sizeof(bitmapword) * WORDS_PER_PAGE, c->u.words, sizeof(bitmapword) * WORDS_PER_PAGE);
+        securec_check(rc, "", "");
+        return;
+    }
+
+    rc = memset_s(words, sizeof(bitmapword) * WORDS_PER_PAGE, 0, sizeof(bitmapword) * WORDS_PER_PAGE);
+    securec_check(rc, "", "");
+    if (c->kind == TBM_ARRAY) {
+        for (int i = 0; i < c->count; i++) {
+            int off = c->u.offsets[i] - 1;
+
+            words[WORDNUM(off)] |= ((bitmapword)1 << (unsigned int)BITNUM(off));
+        }
+    } else {
+        for (int i = 0; i < c->count; i++) {
+            int off = c->u.runs[i].first - 1;
+
+            for (int end = off + c->u.runs[i].length; off < end; off++) {
+                words[WORDNUM(off)] |= ((bitmapword)1 << (unsigned int)BITNUM(off));
+            }
+        }
     }
-    pfree_ext(istate);
+}
+
+/*
+ * tbm_extract_words - extract the tuple offsets from a page bitmap
+ */
+static inline int tbm_extract_words(const bitmapword* words, OffsetNumber* offsets)
+{
+    int ntuples = 0;
+
+    for (int wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++) {
+        bitmapword w = words[wordnum];
+
+        while (w != 0) {
+            int bitnum = __builtin_ctz(w);
+
+            offsets[ntuples++] = (OffsetNumber)(wordnum * BITS_PER_BITMAPWORD + bitnum + 1);
+            w &= w - 1;
+        }
+    }
+
+    return ntuples;
+}
+
+/*
+ * tbm_container_from_words - build the smallest container for a page bitmap
+ *
+ * Returns NULL if the bitmap is empty.
+ */
+static TBMContainer* tbm_container_from_words(TIDBitmap* tbm, const bitmapword* words, bool recheck)
+{
+    TBMContainer* c = NULL;
+    bitmapword carry = 0;
+    int ntuples = 0;
+    int nruns = 0;
+
+    for (int wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++) {
+        bitmapword w = words[wordnum];
+
+        ntuples += __builtin_popcount(w);
+        /* a run starts at each set bit whose lower neighbour is clear */
+        nruns += __builtin_popcount(w & ~((w << 1) | carry));
+        carry = w >> (BITS_PER_BITMAPWORD - 1);
+    }
+
+    if (ntuples == 0) {
+        return NULL;
+    }
+
+    if (ntuples <= TBM_ARRAY_MAX) {
+        c = tbm_container_alloc(tbm, TBM_ARRAY);
+        c->count = (uint16)tbm_extract_words(words, c->u.offsets);
+    } else if (nruns <= TBM_RUN_MAX) {
+        OffsetNumber offsets[MAX_TUPLES_PER_PAGE];
+
+        (void)tbm_extract_words(words, offsets);
+        c = tbm_container_alloc(tbm, TBM_RUN);
+        for (int i = 0; i < ntuples; i++) {
+            if (c->count > 0 && offsets[i] == c->u.runs[c->count - 1].first + c->u.runs[c->count - 1].length) {
+                c->u.runs[c->count - 1].length++;
+            } else {
+                c->u.runs[c->count].first = offsets[i];
+                c->u.runs[c->count].length = 1;
+                c->count++;
+            }
+        }
+        Assert(c->count == nruns);
+    } else {
+        errno_t rc;
+
+        c = tbm_container_alloc(tbm, TBM_BITMAP);
+        rc = memcpy_s(c->u.words, sizeof(bitmapword) * WORDS_PER_PAGE, words, sizeof(bitmapword) * WORDS_PER_PAGE);
+        securec_check(rc, "", "");
+    }
+    c->recheck = recheck;
+
+    return c;
+}
+
+/*
+ * tbm_container_add - add a tuple offset to a container
+ *
+ * Returns the container holding the page now, which is a new one if the
+ * offset did not fit in the old one.
+ */
+static TBMContainer* tbm_container_add(TIDBitmap* tbm, TBMContainer* c, OffsetNumber off)
+{
+    bitmapword words[WORDS_PER_PAGE];
+    TBMContainer* newc = NULL;
+    int i;
+    errno_t rc;
+
+    switch (c->kind) {
+        case TBM_BITMAP:
+            c->u.words[WORDNUM(off - 1)] |= ((bitmapword)1 << (unsigned int)BITNUM(off - 1));
+            return c;
+        case TBM_ARRAY:
+            for (i = 0; i < c->count && c->u.offsets[i] < off; i++) {
+                /* find the insert position */
+            }
+            if (i < c->count && c->u.offsets[i] == off) {
+                return c;
+            }
+            if (c->count < TBM_ARRAY_MAX) {
+                if (i < c->count) {
+                    rc = memmove_s(&c->u.offsets[i + 1], sizeof(OffsetNumber) * (TBM_ARRAY_MAX - i - 1),
+                        &c->u.offsets[i], sizeof(OffsetNumber) * (c->count - i));
+                    securec_check(rc, "", "");
+                }
+                c->u.offsets[i] = off;
+                c->count++;
+                return c;
+            }
+            break;
+        default: {
+            TBMRun* runs = c->u.runs;
+
+            Assert(c->kind == TBM_RUN);
+            for (i = 0; i < c->count; i++) {
+                if (off + 1 < runs[i].first) {
+                    break;
+                }
+                if (off + 1 == runs[i].first) {
+                    /* the runs before are at least two offsets away */
+                    runs[i].first--;
+                    runs[i].length++;
+                    return c;
+                }
+                if (off < runs[i].first + runs[i].length) {
+                    return c;
+                }
+                if (off == runs[i].first + runs[i].length) {
+                    runs[i].length++;
+                    /* merge with the next run if they touch now */
+                    if (i + 1 < c->count && runs[i + 1].first == off + 1) {
+                        runs[i].length += runs[i + 1].length;
+                        c->count--;
+                        if (i + 1 < c->count) {
+                            rc = memmove_s(&runs[i + 1], sizeof(TBMRun) * (TBM_RUN_MAX - i - 1),
+                                &runs[i + 2], sizeof(TBMRun) * (c->count - i - 1));
+                            securec_check(rc, "", "");
+                        }
+                    }
+                    return c;
+                }
+            }
+            if (c->count < TBM_RUN_MAX) {
+                if (i < c->count) {
+                    rc = memmove_s(&runs[i + 1], sizeof(TBMRun) * (TBM_RUN_MAX - i - 1),
+                        &runs[i], sizeof(TBMRun) * (c->count - i));
+                    securec_check(rc, "", "");
+                }
+                runs[i].first = off;
+                runs[i].length = 1;
+                c->count++;
+                return c;
+            }
+            break;
+        }
+    }
+
+    /* The container is full, rebuild the page in a bigger one */
+    tbm_container_words(c, words);
+    words[WORDNUM(off - 1)] |= ((bitmapword)1 << (unsigned int)BITNUM(off - 1));
+    newc = tbm_container_from_words(tbm, words, c->recheck);
+    tbm_container_free(tbm, c);
+
+    return newc;
+}
+
+/*
+ * tbm_container_copy - copy a container of another bitmap into tbm
+ */
+static TBMContainer* tbm_container_copy(TIDBitmap* tbm, const TBMContainer* c)
+{
+    TBMContainer* newc = tbm_container_alloc(tbm, (TBMContainerKind)c->kind);
+    Size size = TBM_CONTAINER_SIZE(c->kind);
+    errno_t rc = memcpy_s(newc, size, c, size);
+    securec_check(rc, "", "");
+
+    return newc;
+}
+
+/*
+ * tbm_container_extract - extract the tuple offsets from a container
+ */
+static int tbm_container_extract(const TBMContainer* c, OffsetNumber* offsets)
+{
+    int ntuples = 0;
+
+    switch (c->kind) {
+        case TBM_ARRAY:
+            for (ntuples = 0; ntuples < c->count; ntuples++) {
+                offsets[ntuples] = c->u.offsets[ntuples];
+            }
+            break;
+        case TBM_RUN:
+            for (int i = 0; i < c->count; i++) {
+                for (int j = 0; j < c->u.runs[i].length; j++) {
+                    offsets[ntuples++] = (OffsetNumber)(c->u.runs[i].first + j);
+                }
+            }
+            break;
+        default:
+            Assert(c->kind == TBM_BITMAP);
+            ntuples = tbm_extract_words(c->u.words, offsets);
+            break;
+    }
+
+    return ntuples;
+}
+
+/*
+ * tbm_leaf_rank - number of exact pages before page p of a leaf, which is
+ * also the position of the container of page p
+ */
+static inline int tbm_leaf_rank(const TBMLeaf* leaf, int p)
+{
+    int rank = 0;
+
+    for (int wordnum = 0; wordnum < WORDNUM(p); wordnum++) {
+        rank += __builtin_popcount(leaf->exact[wordnum]);
+    }
+    rank += __builtin_popcount(leaf->exact[WORDNUM(p)] & (((bitmapword)1 << (unsigned int)BITNUM(p)) - 1));
+
+    return rank;
+}
+
+/*
+ * tbm_leaf_next_page - first page at or after p which is in the leaf
+ *
+ * Returns PAGES_PER_CHUNK if there is none.
+ */
+static inline int tbm_leaf_next_page(const TBMLeaf* leaf, int p)
+{
+    while (p < PAGES_PER_CHUNK) {
+        int wordnum = WORDNUM(p);
+        bitmapword w = (leaf->lossy[wordnum] | leaf->exact[wordnum]) >> (unsigned int)BITNUM(p);
+
+        if (w != 0) {
+            return p + __builtin_ctz(w);
+        }
+        p = (wordnum + 1) * BITS_PER_BITMAPWORD;
+    }
+
+    return PAGES_PER_CHUNK;
+}
+
+/*
+ * tbm_leaf_insert_page - store the container of a new exact page
+ */
+static void tbm_leaf_insert_page(TIDBitmap* tbm, TBMLeaf* leaf, int p, TBMContainer* c)
+{
+    int rank = tbm_leaf_rank(leaf, p);
+
+    Assert(!BIT_IS_SET(leaf->exact, p) && !BIT_IS_SET(leaf->lossy, p));
+
+    if (leaf->npages == leaf->maxpages) {
+        int newmax = (leaf->maxpages == 0) ? 4 : Min(leaf->maxpages * 2, PAGES_PER_CHUNK);
+
+        if (leaf->pages == NULL) {
+            leaf->pages = (TBMContainer**)MemoryContextAlloc(tbm->treecxt, newmax * sizeof(TBMContainer*));
+        } else {
+            leaf->pages = (TBMContainer**)repalloc(leaf->pages, newmax * sizeof(TBMContainer*));
+        }
+        tbm->memused += (newmax - leaf->maxpages) * sizeof(TBMContainer*);
+        leaf->maxpages = (uint16)newmax;
+    }
+    if (rank < leaf->npages) {
+        errno_t rc = memmove_s(&leaf->pages[rank + 1], (leaf->maxpages - rank - 1) * sizeof(TBMContainer*),
+            &leaf->pages[rank], (leaf->npages - rank) * sizeof(TBMContainer*));
+        securec_check(rc, "", "");
+    }
+    leaf->pages[rank] = c;
+    leaf->npages++;
+    leaf->exact[WORDNUM(p)] |= ((bitmapword)1 << (unsigned int)BITNUM(p));
+    tbm->npages++;
+}
+
+/*
+ * tbm_leaf_remove_page - forget an exact page of a leaf
+ */
+static void tbm_leaf_remove_page(TIDBitmap* tbm, TBMLeaf* leaf, int p)
+{
+    int rank = tbm_leaf_rank(leaf, p);
+
+    Assert(BIT_IS_SET(leaf->exact, p));
+
+    tbm_container_free(tbm, leaf->pages[rank]);
+    leaf->npages--;
+    if (rank < leaf->npages) {
+        errno_t rc = memmove_s(&leaf->pages[rank], (leaf->maxpages - rank) * sizeof(TBMContainer*),
+            &leaf->pages[rank + 1], (leaf->npages - rank) * sizeof(TBMContainer*));
+        securec_check(rc, "", "");
+    }
+    leaf->exact[WORDNUM(p)] &= ~((bitmapword)1 << (unsigned int)BITNUM(p));
+    tbm->npages--;
+}
+
+/*
+ * tbm_leaf_mark_lossy - mark a page of a leaf as lossily stored
+ */
+static void tbm_leaf_mark_lossy(TIDBitmap* tbm, TBMLeaf* leaf, int p)
+{
+    if (BIT_IS_SET(leaf->lossy, p)) {
+        return;
+    }
+    if (BIT_IS_SET(leaf->exact, p)) {
+        tbm_leaf_remove_page(tbm, leaf, p);
+    }
+    leaf->lossy[WORDNUM(p)] |= ((bitmapword)1 << (unsigned int)BITNUM(p));
+    tbm->nlossy++;
+}
+
+/*
+ * tbm_leaf_lossify - make all the exact pages of a leaf lossy
+ */
+static void tbm_leaf_lossify(TIDBitmap* tbm, TBMLeaf* leaf)
+{
+    for (int i = 0; i < leaf->npages; i++) {
+        tbm_container_free(tbm, leaf->pages[i]);
+    }
+    for (int wordnum = 0; wordnum < WORDS_PER_CHUNK; wordnum++) {
+        leaf->lossy[wordnum] |= leaf->exact[wordnum];
+        leaf->exact[wordnum] = 0;
+    }
+    tbm->npages -= leaf->npages;
+    tbm->nlossy += leaf->npages;
+    leaf->npages = 0;
 }
 
 /*
@@ -355,9 +770,9 @@ void tbm_add_tuples(TIDBitmap* tbm, const ItemPointer tids, int ntids, bool rech
     for (i = 0; i < ntids; i++) {
         BlockNumber blk = ItemPointerGetBlockNumber(tids + i);
         OffsetNumber off = ItemPointerGetOffsetNumber(tids + i);
-        PagetableEntry* page = NULL;
-        PagetableEntryNode pageNode = {blk, partitionOid};
-        int wordnum, bitnum;
+        TBMLeaf* leaf = NULL;
+        TBMContainer* c = NULL;
+        int p;
 
         /* safety check to ensure we don't overrun bit array bounds */
         if (off < 1 || off > MAX_TUPLES_PER_PAGE) {
@@ -367,24 +782,27 @@ void tbm_add_tuples(TIDBitmap* tbm, const ItemPointer tids, int ntids, bool rech
                     errmsg("tuple offset out of range: %u", off)));
         }
 
-        if (tbm_page_is_lossy(tbm, pageNode)) {
+        leaf = tbm_get_leaf(tbm, partitionOid, blk);
+        p = (int)(blk % PAGES_PER_CHUNK);
+
+        if (BIT_IS_SET(leaf->lossy, p)) {
             continue; /* whole page is already marked */
         }
 
-        page = tbm_get_pageentry(tbm, pageNode);
+        if (BIT_IS_SET(leaf->exact, p)) {
+            int rank = tbm_leaf_rank(leaf, p);
 
-        if (page->ischunk) {
-            /* The page is a lossy chunk header, set bit for itself */
-            wordnum = bitnum = 0;
+            c = tbm_container_add(tbm, leaf->pages[rank], off);
+            leaf->pages[rank] = c;
         } else {
-            /* Page is exact, so set bit for individual tuple */
-            wordnum = WORDNUM(off - 1);
-            bitnum = BITNUM(off - 1);
+            c = tbm_container_alloc(tbm, TBM_ARRAY);
+            c->u.offsets[0] = off;
+            c->count = 1;
+            tbm_leaf_insert_page(tbm, leaf, p, c);
         }
-        page->words[wordnum] |= ((bitmapword)1 << (unsigned int)bitnum);
-        page->recheck |= recheck;
+        c->recheck |= recheck;
 
-        if (tbm->nentries > tbm->maxentries) {
+        if (tbm->memused > tbm->maxbytes) {
             tbm_lossify(tbm);
         }
     }
@@ -398,15 +816,56 @@ void tbm_add_tuples(TIDBitmap* tbm, const ItemPointer tids, int ntids, bool rech
  */
 void tbm_add_page(TIDBitmap* tbm, BlockNumber pageno, Oid partitionOid)
 {
-    PagetableEntryNode pnode = {pageno, partitionOid};
+    TBMLeaf* leaf = NULL;
+
+    Assert(tbm->iterating == TBM_NOT_ITERATING);
     /* Enter the page in the bitmap, or mark it lossy if already present */
-    tbm_mark_page_lossy(tbm, pnode);
+    leaf = tbm_get_leaf(tbm, partitionOid, pageno);
+    tbm_leaf_mark_lossy(tbm, leaf, (int)(pageno % PAGES_PER_CHUNK));
     /* If we went over the memory limit, lossify some more pages */
-    if (tbm->nentries > tbm->maxentries) {
+    if (tbm->memused > tbm->maxbytes) {
         tbm_lossify(tbm);
     }
 }
 
+/*
+ * Walk the leaves below a node in key order, until the walker returns true.
+ * Returns true if the walk was stopped.
+ */
+typedef bool (*TBMLeafWalker)(TBMLeaf* leaf, void* arg);
+
+static bool tbm_walk_node(TBMNode* node, TBMLeafWalker walker, void* arg)
+{
+    void** children = NULL;
+    int nchildren;
+
+    if (node->kind == TBM_NODE_16) {
+        children = ((TBMNode16*)node)->children;
+        nchildren = node->count;
+    } else {
+        children = ((TBMNode256*)node)->children;
+        nchildren = TBM_FANOUT;
+    }
+
+    for (int i = 0; i < nchildren; i++) {
+        if (children[i] == NULL) {
+            continue;
+        }
+        if (node->level == 0 ? walker((TBMLeaf*)children[i], arg) :
+            tbm_walk_node((TBMNode*)children[i], walker, arg)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool tbm_union_walker(TBMLeaf* leaf, void* arg)
+{
+    tbm_union_leaf((TIDBitmap*)arg, leaf);
+    return false;
+}
+
 /*
  * tbm_union - set union
  *
@@ -415,68 +874,62 @@ void tbm_add_page(TIDBitmap* tbm, BlockNumber pageno, Oid partitionOid)
 void tbm_union(TIDBitmap* a, const TIDBitmap* b)
 {
     Assert(a->iterating == TBM_NOT_ITERATING);
-    /* Nothing to do if b is empty */
-    if (b->nentries == 0) {
-        return;
+    /* Scan through the leaves of b, merge into a */
+    for (int i = 0; i < b->nroots; i++) {
+        (void)tbm_walk_node(b->roots[i].node, tbm_union_walker, a);
     }
-    /* Scan through chunks and pages in b, merge into a */
-    if (b->status == TBM_ONE_PAGE) {
-        tbm_union_page(a, &b->entry1);
-    } else {
-        HASH_SEQ_STATUS status;
-        PagetableEntry* bpage = NULL;
+}
+
+/* Process one leaf of b during a union op */
+static void tbm_union_leaf(TIDBitmap* a, const TBMLeaf* bleaf)
+{
+    TBMLeaf* aleaf = tbm_get_leaf(a, bleaf->partitionOid, bleaf->firstBlock);
+    int rank = 0;
+
+    /* Mark the lossy pages of b lossy in a */
+    for (int wordnum = 0; wordnum < WORDS_PER_CHUNK; wordnum++) {
+        bitmapword w = bleaf->lossy[wordnum] & ~aleaf->lossy[wordnum];
 
-        Assert(b->status == TBM_HASH);
-        hash_seq_init(&status, b->pagetable);
-        while ((bpage = (PagetableEntry*)hash_seq_search(&status)) != NULL) {
-            tbm_union_page(a, bpage);
+        while (w != 0) {
+            tbm_leaf_mark_lossy(a, aleaf, wordnum * BITS_PER_BITMAPWORD + __builtin_ctz(w));
+            w &= w - 1;
         }
     }
-}
 
-/* Process one page of b during a union op */
-static void tbm_union_page(TIDBitmap* a, const PagetableEntry* bpage)
-{
-    PagetableEntry* apage = NULL;
-    int wordnum;
-
-    if (bpage->ischunk) {
-        /* Scan b's chunk, mark each indicated page lossy in a */
-        for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++) {
-            bitmapword w = bpage->words[wordnum];
-
-            if (w != 0) {
-                BlockNumber pg;
-
-                pg = bpage->entryNode.blockNo + (wordnum * BITS_PER_BITMAPWORD);
-                while (w != 0) {
-                    if (w & 1) {
-                        PagetableEntryNode unionNode = {pg, bpage->entryNode.partitionOid};
-                        tbm_mark_page_lossy(a, unionNode);
-                    }
-                    pg++;
-                    w >>= 1;
-                }
+    /* Merge the exact pages of b, unless they are lossy in a */
+    for (int wordnum = 0; wordnum < WORDS_PER_CHUNK; wordnum++) {
+        bitmapword w = bleaf->exact[wordnum];
+
+        while (w != 0) {
+            int p = wordnum * BITS_PER_BITMAPWORD + __builtin_ctz(w);
+            const TBMContainer* bc = bleaf->pages[rank++];
+
+            w &= w - 1;
+            if (BIT_IS_SET(aleaf->lossy, p)) {
+                /* page is already lossy in a, nothing to do */
+                continue;
             }
-        }
-    } else if (tbm_page_is_lossy(a, bpage->entryNode)) {
-        /* page is already lossy in a, nothing to do */
-        return;
-    } else {
-        apage = tbm_get_pageentry(a, bpage->entryNode);
-        if (apage->ischunk) {
-            /* The page is a lossy chunk header, set bit for itself */
-            apage->words[0] |= ((bitmapword)1 << 0);
-        } else {
-            /* Both pages are exact, merge at the bit level */
-            for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++) {
-                apage->words[wordnum] |= bpage->words[wordnum];
+            if (BIT_IS_SET(aleaf->exact, p)) {
+                /* Both pages are exact, merge at the bit level */
+                int arank = tbm_leaf_rank(aleaf, p);
+                TBMContainer* ac = aleaf->pages[arank];
+                bitmapword awords[WORDS_PER_PAGE];
+                bitmapword bwords[WORDS_PER_PAGE];
+
+                tbm_container_words(ac, awords);
+                tbm_container_words(bc, bwords);
+                for (int j = 0; j < WORDS_PER_PAGE; j++) {
+                    awords[j] |= bwords[j];
+                }
+                aleaf->pages[arank] = tbm_container_from_words(a, awords, ac->recheck || bc->recheck);
+                tbm_container_free(a, ac);
+            } else {
+                tbm_leaf_insert_page(a, aleaf, p, tbm_container_copy(a, bc));
             }
-            apage->recheck = apage->recheck || bpage->recheck;
         }
     }
 
-    if (a->nentries > a->maxentries) {
+    if (a->memused > a->maxbytes) {
         tbm_lossify(a);
     }
 }
@@ -488,115 +941,146 @@ static void tbm_union_page(TIDBitmap* a, const PagetableEntry* bpage)
  */
 void tbm_intersect(TIDBitmap* a, const TIDBitmap* b)
 {
+    int nroots = 0;
+
     Assert(a->iterating == TBM_NOT_ITERATING);
-    /* Nothing to do if a is empty */
-    if (a->nentries == 0) {
-        return;
+    /* Scan through the trees of a, try to match to b, dropping the emptied ones */
+    for (int i = 0; i < a->nroots; i++) {
+        TBMRoot root = a->roots[i];
+
+        if (tbm_find_root(b, root.partitionOid) == NULL || tbm_intersect_node(a, root.node, b)) {
+            tbm_free_node(a, root.node);
+        } else {
+            a->roots[nroots++] = root;
+        }
     }
-    /* Scan through chunks and pages in a, try to match to b */
-    if (a->status == TBM_ONE_PAGE) {
-        if (tbm_intersect_page(a, &a->entry1, b)) {
-            /* Page is now empty, remove it from a */
-            Assert(!a->entry1.ischunk);
-            a->npages--;
-            a->nentries--;
-            Assert(a->nentries == 0);
-            a->status = TBM_EMPTY;
+    a->nroots = nroots;
+    a->lastleaf = NULL;
+}
+
+/*
+ * Process the children of a node of a during an intersection op
+ *
+ * Returns TRUE if the node is now empty and should be deleted from a
+ */
+static bool tbm_intersect_node(TIDBitmap* a, TBMNode* node, const TIDBitmap* b)
+{
+    if (node->kind == TBM_NODE_16) {
+        TBMNode16* n16 = (TBMNode16*)node;
+        int count = 0;
+
+        for (int i = 0; i < node->count; i++) {
+            void* child = n16->children[i];
+            bool empty = (node->level == 0) ? tbm_intersect_leaf(a, (TBMLeaf*)child, b) :
+                tbm_intersect_node(a, (TBMNode*)child, b);
+
+            if (empty) {
+                if (node->level == 0) {
+                    tbm_free_leaf(a, (TBMLeaf*)child);
+                } else {
+                    tbm_free_node(a, (TBMNode*)child);
+                }
+            } else {
+                n16->keys[count] = n16->keys[i];
+                n16->children[count] = child;
+                count++;
+            }
         }
+        node->count = (uint16)count;
     } else {
-        HASH_SEQ_STATUS status;
-        PagetableEntry* apage = NULL;
-
-        Assert(a->status == TBM_HASH);
-        hash_seq_init(&status, a->pagetable);
-        while ((apage = (PagetableEntry*)hash_seq_search(&status)) != NULL) {
-            if (tbm_intersect_page(a, apage, b)) {
-                /* Page or chunk is now empty, remove it from a */
-                if (apage->ischunk) {
-                    a->nchunks--;
+        TBMNode256* n256 = (TBMNode256*)node;
+
+        for (int i = 0; i < TBM_FANOUT; i++) {
+            void* child = n256->children[i];
+
+            if (child == NULL) {
+                continue;
+            }
+            if (node->level == 0 ? tbm_intersect_leaf(a, (TBMLeaf*)child, b) :
+                tbm_intersect_node(a, (TBMNode*)child, b)) {
+                if (node->level == 0) {
+                    tbm_free_leaf(a, (TBMLeaf*)child);
                 } else {
-                    a->npages--;
+                    tbm_free_node(a, (TBMNode*)child);
                 }
-                a->nentries--;
-                if (hash_search(a->pagetable, (void*)&apage->entryNode, HASH_REMOVE, NULL) == NULL) {
-                    ereport(ERROR,
-                        (errcode(ERRCODE_DATA_CORRUPTED), errmodule(MOD_EXECUTOR), errmsg("hash table corrupted")));
-               }
+                n256->children[i] = NULL;
+                node->count--;
             }
         }
     }
+
+    return node->count == 0;
 }
 
 /*
- * Process one page of a during an intersection op
+ * Process one leaf of a during an intersection op
  *
- * Returns TRUE if apage is now empty and should be deleted from a
+ * Returns TRUE if aleaf is now empty and should be deleted from a
  */
-static bool tbm_intersect_page(TIDBitmap* a, PagetableEntry* apage, const TIDBitmap* b)
+static bool tbm_intersect_leaf(TIDBitmap* a, TBMLeaf* aleaf, const TIDBitmap* b)
 {
-    const PagetableEntry* bpage = NULL;
-    int wordnum;
-
-    if (apage->ischunk) {
-        /* Scan each bit in chunk, try to clear */
-        bool candelete = true;
-
-        for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++) {
-            bitmapword w = apage->words[wordnum];
-
-            if (w != 0) {
-                bitmapword neww = w;
-                BlockNumber pg;
-                int bitnum;
-
-                pg = apage->entryNode.blockNo + (wordnum * BITS_PER_BITMAPWORD);
-                bitnum = 0;
-                while (w != 0) {
-                    if (w & 1) {
-                        PagetableEntryNode pNode = {pg, apage->entryNode.partitionOid};
-                        if (!tbm_page_is_lossy(b, pNode) && tbm_find_pageentry(b, pNode) == NULL) {
-                            /* Page is not in b at all, lose lossy bit */
-                            neww &= ~((bitmapword)1 << (unsigned int)bitnum);
-                        }
-                    }
-                    pg++;
-                    bitnum++;
-                    w >>= 1;
+    const TBMLeaf* bleaf = tbm_find_leaf(b, aleaf->partitionOid, aleaf->firstBlock);
+    bool candelete = true;
+
+    /* If there is no matching b leaf, we can just delete the a leaf */
+    if (bleaf == NULL) {
+        return true;
+    }
+
+    for (int wordnum = 0; wordnum < WORDS_PER_CHUNK; wordnum++) {
+        /* Keep the lossy pages of a which are in b at all */
+        bitmapword lossy = aleaf->lossy[wordnum] & (bleaf->lossy[wordnum] | bleaf->exact[wordnum]);
+        bitmapword w = aleaf->exact[wordnum];
+
+        a->nlossy -= __builtin_popcount(aleaf->lossy[wordnum]) - __builtin_popcount(lossy);
+        aleaf->lossy[wordnum] = lossy;
+
+        while (w != 0) {
+            int p = wordnum * BITS_PER_BITMAPWORD + __builtin_ctz(w);
+
+            w &= w - 1;
+            if (BIT_IS_SET(bleaf->lossy, p)) {
+                /*
+                 * Some of the tuples in 'a' might not satisfy the quals for 'b', but
+                 * because the page 'b' is lossy, we don't know which ones. Therefore
+                 * we mark 'a' as requiring rechecks, to indicate that at most those
+                 * tuples set in 'a' are matches.
+                 */
+                aleaf->pages[tbm_leaf_rank(aleaf, p)]->recheck = true;
+            } else if (BIT_IS_SET(bleaf->exact, p)) {
+                /* Both pages are exact, merge at the bit level */
+                int arank = tbm_leaf_rank(aleaf, p);
+                TBMContainer* ac = aleaf->pages[arank];
+                const TBMContainer* bc = bleaf->pages[tbm_leaf_rank(bleaf, p)];
+                bitmapword awords[WORDS_PER_PAGE];
+                bitmapword bwords[WORDS_PER_PAGE];
+                TBMContainer* newc = NULL;
+
+                tbm_container_words(ac, awords);
+                tbm_container_words(bc, bwords);
+                for (int j = 0; j < WORDS_PER_PAGE; j++) {
+                    awords[j] &= bwords[j];
                 }
-                apage->words[wordnum] = neww;
-                if (neww != 0) {
-                    candelete = false;
+                newc = tbm_container_from_words(a, awords, ac->recheck || bc->recheck);
+                if (newc == NULL) {
+                    /* Page is now empty, remove it from a */
+                    tbm_leaf_remove_page(a, aleaf, p);
+                } else {
+                    aleaf->pages[arank] = newc;
+                    tbm_container_free(a, ac);
                 }
+            } else {
+                /* Page is not in b at all, remove it from a */
+                tbm_leaf_remove_page(a, aleaf, p);
             }
         }
-        return candelete;
-    } else if (tbm_page_is_lossy(b, apage->entryNode)) {
-        /*
-         * Some of the tuples in 'a' might not satisfy the quals for 'b', but
-         * because the page 'b' is lossy, we don't know which ones. Therefore
-         * we mark 'a' as requiring rechecks, to indicate that at most those
-         * tuples set in 'a' are matches.
-         */
-        apage->recheck = true;
-        return false;
-    } else {
-        bool candelete = true;
-
-        bpage = tbm_find_pageentry(b, apage->entryNode);
-        if (bpage != NULL) {
-            /* Both pages are exact, merge at the bit level */
-            Assert(!bpage->ischunk);
-            for (wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++) {
-                apage->words[wordnum] &= bpage->words[wordnum];
-                if (apage->words[wordnum] != 0) {
-                    candelete = false;
-                }
-            }
-            apage->recheck = apage->recheck || bpage->recheck;
+
+        if (aleaf->lossy[wordnum] != 0 || aleaf->exact[wordnum] != 0) {
+            candelete = false;
         }
-        /* If there is no matching b page, we can just delete the a page */
-        return candelete;
     }
+
+    return candelete;
 }
 
 /*
@@ -604,40 +1088,34 @@ static bool tbm_intersect_page(TIDBitmap* a, PagetableEntry* apage, const TIDBit
  */
 bool tbm_is_empty(const TIDBitmap* tbm)
 {
-    return (tbm->nentries == 0);
+    return (tbm->npages == 0 && tbm->nlossy == 0);
 }
 
-static void tbm_sort_pages(TIDBitmap* tbm)
+static bool tbm_collect_walker(TBMLeaf* leaf, void* arg)
 {
-    HASH_SEQ_STATUS status;
-    PagetableEntry* page = NULL;
-    int npages;
-    int nchunks;
+    TIDBitmap* tbm = (TIDBitmap*)arg;
 
-    if (tbm->spages == NULL && tbm->npages > 0) {
-        tbm->spages = (PagetableEntry**)MemoryContextAlloc(tbm->mcxt, tbm->npages * sizeof(PagetableEntry*));
-    }
-    if ((tbm->schunks == NULL) && tbm->nchunks > 0) {
-        tbm->schunks = (PagetableEntry**)MemoryContextAlloc(tbm->mcxt, tbm->nchunks * sizeof(PagetableEntry*));
-    }
+    tbm->sleaves[tbm->nleaves++] = leaf;
+    return false;
+}
 
-    hash_seq_init(&status, tbm->pagetable);
-    npages = nchunks = 0;
-    while ((page = (PagetableEntry*)hash_seq_search(&status)) != NULL) {
-        if (page->ischunk) {
-            tbm->schunks[nchunks++] = page;
-        } else {
-            tbm->spages[npages++] = page;
-        }
-    }
-    Assert(npages == tbm->npages);
-    Assert(nchunks == tbm->nchunks);
-    if (npages > 1) {
-        qsort(tbm->spages, npages, sizeof(PagetableEntry*), tbm_comparator);
+/*
+ * tbm_collect_leaves - list the leaves of the trees in iteration order
+ */
+static void tbm_collect_leaves(TIDBitmap* tbm)
+{
+    int nleaves = tbm->nleaves;
+
+    if (nleaves == 0) {
+        return;
     }
-    if (nchunks > 1) {
-        qsort(tbm->schunks, nchunks, sizeof(PagetableEntry*), tbm_comparator);
+
+    tbm->sleaves = (TBMLeaf**)MemoryContextAlloc(tbm->treecxt, nleaves * sizeof(TBMLeaf*));
+    tbm->nleaves = 0;
+    for (int i = 0; i < tbm->nroots; i++) {
+        (void)tbm_walk_node(tbm->roots[i].node, tbm_collect_walker, tbm);
     }
+    Assert(tbm->nleaves == nleaves);
 }
 
 /*
@@ -668,18 +1146,16 @@ TBMIterator* tbm_begin_iterate(TIDBitmap* tbm)
     /*
      * Initialize iteration pointers.
      */
-    iterator->spageptr = 0;
-    iterator->schunkptr = 0;
-    iterator->schunkbit = 0;
+    iterator->leafptr = 0;
+    iterator->pageptr = 0;
 
     /*
-     * If we have a hashtable, create and fill the sorted page lists, unless
-     * we already did that for a previous iterator.  Note that the lists are
-     * attached to the bitmap not the iterator, so they can be used by more
-     * than one iterator.
+     * Create the list of leaves, unless we already did that for a previous
+     * iterator.  Note that the list is attached to the bitmap not the
+     * iterator, so it can be used by more than one iterator.
      */
-    if (tbm->status == TBM_HASH && tbm->iterating == TBM_NOT_ITERATING) {
-        tbm_sort_pages(tbm);
+    if (tbm->iterating == TBM_NOT_ITERATING) {
+        tbm_collect_leaves(tbm);
     }
 
     tbm->iterating = TBM_ITERATING_PRIVATE;
@@ -693,8 +1169,8 @@ TBMIterator* tbm_begin_iterate(TIDBitmap* tbm)
  * The necessary shared state will be allocated from the DSA passed to
  * tbm_create, so that multiple processes can attach to it and iterate jointly.
  *
- * This will convert the pagetable hash into page and chunk array of the index
- * into pagetable array.
+ * The tree itself is left alone, and released along with the last shared
+ * iterator state.
  */
 TBMSharedIteratorState* tbm_prepare_shared_iterate(TIDBitmap *tbm)
 {
@@ -708,49 +1184,38 @@ TBMSharedIteratorState* tbm_prepare_shared_iterate(TIDBitmap *tbm)
         sizeof(TBMSharedIteratorState));
 
     /*
-     * If we have a hashtable, create and fill the sorted page lists, unless
-     * we already did that for a previous iterator.  Note that the lists are
-     * attached to the bitmap not the iterator, so they can be used by more
-     * than one iterator.
+     * Create the list of leaves and the area shared by the iterators, unless
+     * we already did that for a previous iterator.
      */
     if (tbm->iterating == TBM_NOT_ITERATING) {
-        if (tbm->status == TBM_HASH) {
-            tbm_sort_pages(tbm);
+        if (tbm->treecxt == NULL) {
+            tbm_create_tree(tbm);
         }
-        pg_atomic_init_u32(&istate->pagetableRefcount, 0);
-        pg_atomic_init_u32(&istate->pagesRefcount, 0);
-        pg_atomic_init_u32(&istate->chunksRefcount, 0);
+        tbm_collect_leaves(tbm);
+        tbm->sharedarea = (TBMSharedArea*)MemoryContextAlloc(tbm->treecxt, sizeof(TBMSharedArea));
+        tbm->sharedarea->treecxt = tbm->treecxt;
+        pg_atomic_init_u32(&tbm->sharedarea->refcount, 0);
     }
 
     /*
      * Store the TBM members in the shared state so that we can share them
      * across multiple processes.
      */
-    istate->nentries = tbm->nentries;
-    istate->maxentries = tbm->maxentries;
-    istate->npages = tbm->npages;
-    istate->nchunks = tbm->nchunks;
-    istate->pagetable = tbm->pagetable;
-    istate->spages = tbm->spages;
-    istate->schunks = tbm->schunks;
-    istate->status = tbm->status;
-    int rc = memcpy_s(&istate->entry1, sizeof(PagetableEntry), &tbm->entry1, sizeof(PagetableEntry));
-    securec_check(rc, "", "");
+    istate->area = tbm->sharedarea;
+    istate->sleaves = tbm->sleaves;
+    istate->nleaves = tbm->nleaves;
     /*
-     * For every shared iterator, referring to pagetable and iterator array,
-     * increase the refcount by 1 so that while freeing the shared iterator we
-     * don't free pagetable and iterator array until its refcount becomes 0.
+     * For every shared iterator referring to the tree, increase the refcount
+     * by 1 so that while freeing the shared iterator we don't free the tree
+     * until its refcount becomes 0.
      */
-    (void)pg_atomic_add_fetch_u32(&istate->pagetableRefcount, 1);
-    (void)pg_atomic_add_fetch_u32(&istate->pagesRefcount, 1);
-    (void)pg_atomic_add_fetch_u32(&istate->chunksRefcount, 1);
+    (void)pg_atomic_add_fetch_u32(&istate->area->refcount, 1);
     /* Initialize the iterator lock */
     LWLockInitialize(&istate->lock, LWTRANCHE_TBM);
 
     /* Initialize the shared iterator state */
-    istate->schunkbit = 0;
-    istate->schunkptr = 0;
-    istate->spageptr = 0;
+    istate->leafptr = 0;
+    istate->pageptr = 0;
 
     tbm->iterating = TBM_ITERATING_SHARED;
 
@@ -758,54 +1223,43 @@ TBMSharedIteratorState* tbm_prepare_shared_iterate(TIDBitmap *tbm)
 }
 
 /*
- * tbm_extract_page_tuple - extract the tuple offsets from a page
+ * tbm_next_page - report the next page of a leaf list
  *
- * The extracted offsets are stored into TBMIterateResult.
+ * leafptr and pageptr are advanced past the reported page.  Returns false
+ * if there are no more pages.
  */
-static inline int tbm_extract_page_tuple(const PagetableEntry *page, TBMIterateResult *output)
+static bool tbm_next_page(TBMLeaf* const* sleaves, int nleaves, int* leafptr, int* pageptr,
+    TBMIterateResult* output)
 {
-    int ntuples = 0;
-
-    for (int wordnum = 0; wordnum < WORDS_PER_PAGE; wordnum++) {
-        bitmapword w = page->words[wordnum];
-
-        if (w != 0) {
-            int off = wordnum * BITS_PER_BITMAPWORD + 1;
-
-            while (w != 0) {
-                if (w & 1) {
-                    output->offsets[ntuples++] = (OffsetNumber)off;
-                }
-                off++;
-                w >>= 1;
+    while (*leafptr < nleaves) {
+        const TBMLeaf* leaf = sleaves[*leafptr];
+        int p = tbm_leaf_next_page(leaf, *pageptr);
+
+        if (p < PAGES_PER_CHUNK) {
+            output->blockno = leaf->firstBlock + p;
+            output->partitionOid = leaf->partitionOid;
+            if (BIT_IS_SET(leaf->lossy, p)) {
+                /* Return a lossy page indicator */
+                output->ntuples = -1;
+                output->recheck = true;
+            } else {
+                const TBMContainer* c = leaf->pages[tbm_leaf_rank(leaf, p)];
+
+                /* extract individual offset numbers */
+                output->ntuples = tbm_container_extract(c, output->offsets);
+                output->recheck = c->recheck;
             }
+            *pageptr = p + 1;
+            return true;
         }
+        /* advance to next leaf */
+        (*leafptr)++;
+        *pageptr = 0;
     }
 
-    return ntuples;
-}
-
-/*
- * 	tbm_advance_schunkbit - Advance the schunkbit
- */
-static inline void tbm_advance_schunkbit(const PagetableEntry *chunk, int *schunkbitp)
-{
-    int schunkbit = *schunkbitp;
-
-    while (schunkbit < PAGES_PER_CHUNK) {
-        int wordnum = WORDNUM(schunkbit);
-        int bitnum = BITNUM(schunkbit);
-
-        if ((chunk->words[wordnum] & ((bitmapword)1 << (unsigned int)bitnum)) != 0) {
-            break;
-        }
-        schunkbit++;
-    }
-
-    *schunkbitp = schunkbit;
+    return false;
 }
 
-
 /*
  * tbm_iterate - scan through next page of a TIDBitmap
  *
@@ -825,63 +1279,7 @@ TBMIterateResult* tbm_iterate(TBMIterator* iterator)
 
     Assert(tbm->iterating == TBM_ITERATING_PRIVATE);
 
-    /*
-     * If lossy chunk pages remain, make sure we've advanced schunkptr/
-     * schunkbit to the next set bit.
-     */
-    while (iterator->schunkptr < tbm->nchunks) {
-        PagetableEntry* chunk = tbm->schunks[iterator->schunkptr];
-        int schunkbit = iterator->schunkbit;
-
-        tbm_advance_schunkbit(chunk, &schunkbit);
-        if (schunkbit < PAGES_PER_CHUNK) {
-            iterator->schunkbit = schunkbit;
-            break;
-        }
-        /* advance to next chunk */
-        iterator->schunkptr++;
-        iterator->schunkbit = 0;
-    }
-
-    /*
-     * If both chunk and per-page data remain, must output the numerically
-     * earlier page.
-     */
-    if (iterator->schunkptr < tbm->nchunks) {
-        PagetableEntry* chunk = tbm->schunks[iterator->schunkptr];
-        PagetableEntryNode pnode;
-        pnode.blockNo = chunk->entryNode.blockNo + iterator->schunkbit;
-        pnode.partitionOid = chunk->entryNode.partitionOid;
-        if (iterator->spageptr >= tbm->npages ||
-            IS_CHUNK_BEFORE_PAGE(pnode, tbm->spages[iterator->spageptr]->entryNode)) {
-            /* Return a lossy page indicator from the chunk */
-            output->blockno = pnode.blockNo;
-            output->partitionOid = pnode.partitionOid;
-            output->ntuples = -1;
-            output->recheck = true;
-            iterator->schunkbit++;
-            return output;
-        }
-    }
-
-    if (iterator->spageptr < tbm->npages) {
-        PagetableEntry* page = NULL;
-        int ntuples;
-
-        /* In ONE_PAGE state, we don't allocate an spages[] array */
-        if (tbm->status == TBM_ONE_PAGE) {
-            page = &tbm->entry1;
-        } else {
-            page = tbm->spages[iterator->spageptr];
-        }
-
-        /* scan bitmap to extract individual offset numbers */
-        ntuples = tbm_extract_page_tuple(page, output);
-        output->blockno = page->entryNode.blockNo;
-        output->partitionOid = page->entryNode.partitionOid;
-        output->ntuples = ntuples;
-        output->recheck = page->recheck;
-        iterator->spageptr++;
+    if (tbm_next_page(tbm->sleaves, tbm->nleaves, &iterator->leafptr, &iterator->pageptr, output)) {
         return output;
     }
 
@@ -900,78 +1298,15 @@ TBMIterateResult *tbm_shared_iterate(TBMSharedIterator *iterator)
 {
     TBMIterateResult *output = &iterator->output;
     TBMSharedIteratorState *istate = iterator->state;
+    bool found = false;
 
     /* Acquire the LWLock before accessing the shared members */
     (void)LWLockAcquire(&istate->lock, LW_EXCLUSIVE);
-
-    /*
-     * If lossy chunk pages remain, make sure we've advanced schunkptr/
-     * schunkbit to the next set bit.
-     */
-    while (istate->schunkptr < istate->nchunks) {
-        PagetableEntry *chunk = istate->schunks[istate->schunkptr];
-        int schunkbit = istate->schunkbit;
-
-        tbm_advance_schunkbit(chunk, &schunkbit);
-        if (schunkbit < PAGES_PER_CHUNK) {
-            istate->schunkbit = schunkbit;
-            break;
-        }
-        /* advance to next chunk */
-        istate->schunkptr++;
-        istate->schunkbit = 0;
-    }
-
-    /*
-     * If both chunk and per-page data remain, must output the numerically
-     * earlier page.
-     */
-    if (istate->schunkptr < istate->nchunks) {
-        PagetableEntry *chunk = istate->schunks[istate->schunkptr];
-        PagetableEntryNode pnode;
-        pnode.blockNo = chunk->entryNode.blockNo + istate->schunkbit;
-        pnode.partitionOid = chunk->entryNode.partitionOid;
-
-        if (istate->spageptr >= istate->npages ||
-            IS_CHUNK_BEFORE_PAGE(pnode, istate->spages[istate->spageptr]->entryNode)) {
-            /* Return a lossy page indicator from the chunk */
-            output->blockno = pnode.blockNo;
-            output->partitionOid = pnode.partitionOid;
-            output->ntuples = -1;
-            output->recheck = true;
-            istate->schunkbit++;
-
-            LWLockRelease(&istate->lock);
-            return output;
-        }
-    }
-
-    if (istate->spageptr < istate->npages) {
-        PagetableEntry *page = NULL;
-
-        /* In ONE_PAGE state, we don't allocate an spages[] array */
-        if (istate->status == TBM_ONE_PAGE) {
-            page = &istate->entry1;
-        } else {
-            page = istate->spages[istate->spageptr];
-        }
-
-        /* scan bitmap to extract individual offset numbers */
-        int ntuples = tbm_extract_page_tuple(page, output);
-        output->blockno = page->entryNode.blockNo;
-        output->partitionOid = page->entryNode.partitionOid;
-        output->ntuples = ntuples;
-        output->recheck = page->recheck;
-        istate->spageptr++;
-
-        LWLockRelease(&istate->lock);
-        return output;
-    }
-
+    found = tbm_next_page(istate->sleaves, istate->nleaves, &istate->leafptr, &istate->pageptr, output);
     LWLockRelease(&istate->lock);
 
-    /* Nothing more in the bitmap */
-    return NULL;
+    /* NULL if nothing more in the bitmap */
+    return found ? output : NULL;
 }
 
 /*
@@ -998,179 +1333,277 @@ void tbm_end_shared_iterate(TBMSharedIterator *iterator)
 }
 
 /*
- * tbm_find_pageentry - find a PagetableEntry for the pageno
+ * tbm_node_find_child - find the child slot of a key byte in an inner node
  *
- * Returns NULL if there is no non-lossy entry for the pageno.
+ * Returns NULL if the node has no such child.
  */
-static const PagetableEntry* tbm_find_pageentry(const TIDBitmap* tbm, PagetableEntryNode pageNode)
+static void** tbm_node_find_child(TBMNode* node, uint8 key)
 {
-    const PagetableEntry* page = NULL;
+    if (node->kind == TBM_NODE_16) {
+        TBMNode16* n16 = (TBMNode16*)node;
 
-    if (tbm->nentries == 0) { /* in case pagetable doesn't exist */
+        for (int i = 0; i < node->count && n16->keys[i] <= key; i++) {
+            if (n16->keys[i] == key) {
+                return &n16->children[i];
+            }
+        }
         return NULL;
     }
-    
-    if (tbm->status == TBM_ONE_PAGE) {
-        page = &tbm->entry1;
-        if (!IS_ENTRY_NODE_MATCH(page->entryNode, pageNode)) {
-            return NULL;
+
+    TBMNode256* n256 = (TBMNode256*)node;
+    return (n256->children[key] != NULL) ? &n256->children[key] : NULL;
+}
+
+static TBMNode* tbm_node_create(TIDBitmap* tbm, TBMNodeKind kind, int level)
+{
+    Size size = (kind == TBM_NODE_16) ? sizeof(TBMNode16) : sizeof(TBMNode256);
+    TBMNode* node = (TBMNode*)MemoryContextAllocZero(tbm->treecxt, size);
+
+    node->kind = (uint8)kind;
+    node->level = (uint8)level;
+    tbm->memused += size;
+    return node;
+}
+
+/*
+ * tbm_node_add_child - add the child of a key byte to the node at *nodep
+ *
+ * The node is replaced by a bigger one if it is full.  Returns the slot of
+ * the new child.
+ */
+static void** tbm_node_add_child(TIDBitmap* tbm, TBMNode** nodep, uint8 key, void* child)
+{
+    TBMNode* node = *nodep;
+
+    if (node->kind == TBM_NODE_16 && node->count == TBM_NODE16_MAX) {
+        TBMNode16* n16 = (TBMNode16*)node;
+        TBMNode256* n256 = (TBMNode256*)tbm_node_create(tbm, TBM_NODE_256, node->level);
+
+        for (int i = 0; i < node->count; i++) {
+            n256->children[n16->keys[i]] = n16->children[i];
         }
-        Assert(!page->ischunk);
-        return page;
+        n256->hdr.count = node->count;
+        tbm->memused -= sizeof(TBMNode16);
+        pfree(node);
+        *nodep = node = &n256->hdr;
     }
 
-    page = (PagetableEntry*)hash_search(tbm->pagetable, (void*)&pageNode, HASH_FIND, NULL);
-    if (page == NULL) {
-        return NULL;
+    node->count++;
+    if (node->kind == TBM_NODE_256) {
+        TBMNode256* n256 = (TBMNode256*)node;
+
+        n256->children[key] = child;
+        return &n256->children[key];
     }
-    if (page->ischunk) {
-        return NULL; /* don't want a lossy chunk header */
+
+    TBMNode16* n16 = (TBMNode16*)node;
+    int i;
+
+    for (i = node->count - 1; i > 0 && n16->keys[i - 1] > key; i--) {
+        n16->keys[i] = n16->keys[i - 1];
+        n16->children[i] = n16->children[i - 1];
     }
-    return page;
+    n16->keys[i] = key;
+    n16->children[i] = child;
+    return &n16->children[i];
 }
 
 /*
- * tbm_get_pageentry - find or create a PagetableEntry for the pageno
- *
- * If new, the entry is marked as an exact (non-chunk) entry.
+ * tbm_find_root - find the tree of a partition
  *
- * This may cause the table to exceed the desired memory size.	It is
- * up to the caller to call tbm_lossify() at the next safe point if so.
+ * Returns NULL if the bitmap has no pages of the partition.
  */
-static PagetableEntry* tbm_get_pageentry(TIDBitmap* tbm, PagetableEntryNode pageNode)
+static const TBMRoot* tbm_find_root(const TIDBitmap* tbm, Oid partitionOid)
 {
-    PagetableEntry* page = NULL;
-    bool found = false;
-    int rc  = 0;
+    int low = 0;
+    int high = tbm->nroots - 1;
 
-    if (tbm->status == TBM_EMPTY) {
-        /* Use the fixed slot */
-        page = &tbm->entry1;
-        found = false;
-        tbm->status = TBM_ONE_PAGE;
-    } else {
-        if (tbm->status == TBM_ONE_PAGE) {
-            page = &tbm->entry1;
-            if (IS_ENTRY_NODE_MATCH(page->entryNode, pageNode)) {
-                return page;
-            }
-            /* Time to switch from one page to a hashtable */
-            tbm_create_pagetable(tbm);
+    while (low <= high) {
+        int mid = (low + high) / 2;
+
+        if (tbm->roots[mid].partitionOid == partitionOid) {
+            return &tbm->roots[mid];
+        } else if (tbm->roots[mid].partitionOid < partitionOid) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * tbm_get_root - find or create the tree of a partition
+ */
+static TBMRoot* tbm_get_root(TIDBitmap* tbm, Oid partitionOid)
+{
+    int pos;
+
+    for (pos = tbm->nroots; pos > 0 && tbm->roots[pos - 1].partitionOid >= partitionOid; pos--) {
+        if (tbm->roots[pos - 1].partitionOid == partitionOid) {
+            return &tbm->roots[pos - 1];
         }
+    }
 
-        /* Look up or create an entry */
-        page = (PagetableEntry*)hash_search(tbm->pagetable, (void*)&pageNode, HASH_ENTER, &found);
+    if (tbm->treecxt == NULL) {
+        tbm_create_tree(tbm);
     }
+    if (tbm->nroots == tbm->maxroots) {
+        int newmax = (tbm->maxroots == 0) ? 1 : tbm->maxroots * 2;
 
-    /* Initialize it if not present before */
-    if (!found) {
-        rc = memset_s(page, sizeof(PagetableEntry), 0, sizeof(PagetableEntry));
+        if (tbm->roots == NULL) {
+            tbm->roots = (TBMRoot*)MemoryContextAlloc(tbm->treecxt, newmax * sizeof(TBMRoot));
+        } else {
+            tbm->roots = (TBMRoot*)repalloc(tbm->roots, newmax * sizeof(TBMRoot));
+        }
+        tbm->memused += (newmax - tbm->maxroots) * sizeof(TBMRoot);
+        tbm->maxroots = newmax;
+    }
+    if (pos < tbm->nroots) {
+        errno_t rc = memmove_s(&tbm->roots[pos + 1], (tbm->maxroots - pos - 1) * sizeof(TBMRoot),
+            &tbm->roots[pos], (tbm->nroots - pos) * sizeof(TBMRoot));
         securec_check(rc, "", "");
-        page->entryNode.blockNo = pageNode.blockNo;
-        page->entryNode.partitionOid = pageNode.partitionOid;
-        /* must count it too */
-        tbm->nentries++;
-        tbm->npages++;
     }
+    tbm->roots[pos].partitionOid = partitionOid;
+    tbm->roots[pos].node = tbm_node_create(tbm, TBM_NODE_16, TBM_LEVELS - 1);
+    tbm->nroots++;
 
-    return page;
+    return &tbm->roots[pos];
 }
 
 /*
- * tbm_page_is_lossy - is the page marked as lossily stored?
+ * tbm_find_leaf - find the leaf holding a page
+ *
+ * Returns NULL if there is no leaf for the chunk of the page.
  */
-static bool tbm_page_is_lossy(const TIDBitmap* tbm, PagetableEntryNode pageNode)
+static const TBMLeaf* tbm_find_leaf(const TIDBitmap* tbm, Oid partitionOid, BlockNumber blockNo)
 {
-    PagetableEntry* page = NULL;
-    BlockNumber chunkPageNo;
-    int bitno;
+    BlockNumber chunkNo = TBM_CHUNKNO(blockNo);
+    const TBMRoot* root = tbm_find_root(tbm, partitionOid);
+    void* child = NULL;
 
-    /* we can skip the lookup if there are no lossy chunks */
-    if (tbm->nchunks == 0) {
-        return false;
+    if (root == NULL) {
+        return NULL;
     }
-    Assert(tbm->status == TBM_HASH);
 
-    bitno = pageNode.blockNo % PAGES_PER_CHUNK;
-    chunkPageNo = pageNode.blockNo - bitno;
-    PagetableEntryNode chunkNode = {chunkPageNo, pageNode.partitionOid};
-    page = (PagetableEntry*)hash_search(tbm->pagetable, (void*)&chunkNode, HASH_FIND, NULL);
-    if (page != NULL && page->ischunk) {
-        int wordnum = WORDNUM(bitno);
-        int bitnum = BITNUM(bitno);
+    child = root->node;
+    for (int level = TBM_LEVELS - 1; level >= 0; level--) {
+        void** slot = tbm_node_find_child((TBMNode*)child, TBM_KEY_BYTE(chunkNo, level));
 
-        if ((page->words[wordnum] & ((bitmapword)1 << (unsigned int)bitnum)) != 0) {
-            return true;
+        if (slot == NULL) {
+            return NULL;
         }
+        child = *slot;
     }
-    return false;
+
+    return (const TBMLeaf*)child;
 }
 
 /*
- * tbm_mark_page_lossy - mark the page number as lossily stored
+ * tbm_get_leaf - find or create the leaf holding a page
  *
- * This may cause the table to exceed the desired memory size.	It is
+ * This may cause the tree to exceed the desired memory size.  It is
  * up to the caller to call tbm_lossify() at the next safe point if so.
  */
-static void tbm_mark_page_lossy(TIDBitmap* tbm, PagetableEntryNode pageNode)
+static TBMLeaf* tbm_get_leaf(TIDBitmap* tbm, Oid partitionOid, BlockNumber blockNo)
 {
-    PagetableEntry* page = NULL;
-    bool found = false;
-    BlockNumber chunkPageNo;
-    int bitno;
-    int wordnum;
-    int bitnum;
-    int rc  = 0;
-
-    /* We force the bitmap into hashtable mode whenever it's lossy */
-    if (tbm->status != TBM_HASH) {
-        tbm_create_pagetable(tbm);
+    BlockNumber chunkNo = TBM_CHUNKNO(blockNo);
+    TBMLeaf* leaf = tbm->lastleaf;
+    void** slot = NULL;
+
+    /* consecutive lookups usually hit the same leaf */
+    if (leaf != NULL && leaf->partitionOid == partitionOid && TBM_CHUNKNO(leaf->firstBlock) == chunkNo) {
+        return leaf;
     }
 
-    bitno = pageNode.blockNo % PAGES_PER_CHUNK;
-    chunkPageNo = pageNode.blockNo - bitno;
-    PagetableEntryNode chunkNode = {chunkPageNo, pageNode.partitionOid};
-    /*
-     * Remove any extant non-lossy entry for the page.	If the page is its own
-     * chunk header, however, we skip this and handle the case below.
-     */
-    if (bitno != 0) {
-        if (hash_search(tbm->pagetable, (void*)&pageNode, HASH_REMOVE, NULL) != NULL) {
-            /* It was present, so adjust counts */
-            tbm->nentries--;
-            tbm->npages--; /* assume it must have been non-lossy */
+    slot = (void**)&tbm_get_root(tbm, partitionOid)->node;
+    for (int level = TBM_LEVELS - 1; level >= 0; level--) {
+        uint8 key = TBM_KEY_BYTE(chunkNo, level);
+        void** child = tbm_node_find_child((TBMNode*)*slot, key);
+
+        if (child == NULL) {
+            void* newchild = NULL;
+
+            if (level > 0) {
+                newchild = tbm_node_create(tbm, TBM_NODE_16, level - 1);
+            } else {
+                leaf = (TBMLeaf*)MemoryContextAllocZero(tbm->treecxt, sizeof(TBMLeaf));
+                leaf->partitionOid = partitionOid;
+                leaf->firstBlock = chunkNo * PAGES_PER_CHUNK;
+                tbm->memused += sizeof(TBMLeaf);
+                tbm->nleaves++;
+                newchild = leaf;
+            }
+            child = tbm_node_add_child(tbm, (TBMNode**)slot, key, newchild);
         }
+        slot = child;
     }
 
-    /* Look up or create entry for chunk-header page */
-    page = (PagetableEntry*)hash_search(tbm->pagetable, (void*)&chunkNode, HASH_ENTER, &found);
+    tbm->lastleaf = (TBMLeaf*)*slot;
+    return tbm->lastleaf;
+}
 
-    /* Initialize it if not present before */
-    if (!found) {
-        rc = memset_s(page, sizeof(PagetableEntry), 0, sizeof(PagetableEntry));
-        securec_check(rc, "", "");
-        page->entryNode = chunkNode;
-        page->ischunk = true;
-        /* must count it too */
-        tbm->nentries++;
-        tbm->nchunks++;
-    } else if (!page->ischunk) {
-        /* chunk header page was formerly non-lossy, make it lossy */
-        rc = memset_s(page, sizeof(PagetableEntry), 0, sizeof(PagetableEntry));
-        securec_check(rc, "", "");
-        page->entryNode = chunkNode;
-        page->ischunk = true;
-        /* we assume it had some tuple bit(s) set, so mark it lossy */
-        page->words[0] = ((bitmapword)1 << 0);
-        /* adjust counts */
-        tbm->nchunks++;
-        tbm->npages--;
+/*
+ * tbm_free_leaf - free a leaf which is no longer in the tree
+ */
+static void tbm_free_leaf(TIDBitmap* tbm, TBMLeaf* leaf)
+{
+    for (int i = 0; i < leaf->npages; i++) {
+        tbm_container_free(tbm, leaf->pages[i]);
+    }
+    for (int wordnum = 0; wordnum < WORDS_PER_CHUNK; wordnum++) {
+        tbm->nlossy -= __builtin_popcount(leaf->lossy[wordnum]);
+    }
+    tbm->npages -= leaf->npages;
+    tbm->memused -= sizeof(TBMLeaf) + leaf->maxpages * sizeof(TBMContainer*);
+    tbm->nleaves--;
+    if (tbm->lastleaf == leaf) {
+        tbm->lastleaf = NULL;
+    }
+    pfree_ext(leaf->pages);
+    pfree(leaf);
+}
+
+/*
+ * tbm_free_node - free a node which is no longer in the tree, and all below
+ */
+static void tbm_free_node(TIDBitmap* tbm, TBMNode* node)
+{
+    void** children = NULL;
+    int nchildren;
+
+    if (node->kind == TBM_NODE_16) {
+        children = ((TBMNode16*)node)->children;
+        nchildren = node->count;
+        tbm->memused -= sizeof(TBMNode16);
+    } else {
+        children = ((TBMNode256*)node)->children;
+        nchildren = TBM_FANOUT;
+        tbm->memused -= sizeof(TBMNode256);
+    }
+
+    for (int i = 0; i < nchildren; i++) {
+        if (children[i] == NULL) {
+            continue;
+        }
+        if (node->level == 0) {
+            tbm_free_leaf(tbm, (TBMLeaf*)children[i]);
+        } else {
+            tbm_free_node(tbm, (TBMNode*)children[i]);
+        }
     }
+    pfree(node);
+}
 
-    /* Now set the original target page's bit */
-    wordnum = WORDNUM(bitno);
-    bitnum = BITNUM(bitno);
-    page->words[wordnum] |= ((bitmapword)1 << bitnum);
+static bool tbm_lossify_walker(TBMLeaf* leaf, void* arg)
+{
+    TIDBitmap* tbm = (TIDBitmap*)arg;
+
+    if (leaf->npages > 0) {
+        tbm_leaf_lossify(tbm, leaf);
+    }
+    return tbm->memused <= tbm->maxbytes / 2;
 }
 
 /*
@@ -1178,93 +1611,45 @@ static void tbm_mark_page_lossy(TIDBitmap* tbm, PagetableEntryNode pageNode)
  */
 static void tbm_lossify(TIDBitmap* tbm)
 {
-    HASH_SEQ_STATUS status;
-    PagetableEntry* page = NULL;
-
     /*
-     * XXX Really stupid implementation: this just lossifies pages in
-     * essentially random order.  We should be paying some attention to the
-     * number of bits set in each page, instead.
+     * XXX Really stupid implementation: this just lossifies whole leaves in
+     * block order.  We should be paying some attention to the number of
+     * exact pages in each leaf, instead.
      *
-     * Since we are called as soon as nentries exceeds maxentries, we should
-     * push nentries down to significantly less than maxentries, or else we'll
-     * just end up doing this again very soon.	We shoot for maxentries/2.
+     * Since we are called as soon as memused exceeds maxbytes, we should
+     * push memused down to significantly less than maxbytes, or else we'll
+     * just end up doing this again very soon.	We shoot for maxbytes/2.
+     * The freed containers are kept for reuse by the bitmap, which is why
+     * memused only counts the containers in use.
      */
     Assert(tbm->iterating == TBM_NOT_ITERATING);
-    Assert(tbm->status == TBM_HASH);
 
-    hash_seq_init(&status, tbm->pagetable);
-    while ((page = (PagetableEntry*)hash_seq_search(&status)) != NULL) {
-        if (page->ischunk) {
-            continue; /* already a chunk header */
-        }
-        /*
-         * If the page would become a chunk header, we won't save anything by
-         * converting it to lossy, so skip it.
-         */
-        if ((page->entryNode.blockNo % PAGES_PER_CHUNK) == 0) {
-            continue;
-        }
-        
-        /* This does the dirty work ... */
-        tbm_mark_page_lossy(tbm, page->entryNode);
-
-        if (tbm->nentries <= tbm->maxentries / 2) {
-            /* we have done enough */
-            hash_seq_term(&status);
+    for (int i = 0; i < tbm->nroots; i++) {
+        if (tbm_walk_node(tbm->roots[i].node, tbm_lossify_walker, tbm)) {
             break;
         }
-
-        /*
-         * Note: tbm_mark_page_lossy may have inserted a lossy chunk into the
-         * hashtable.  We can continue the same seq_search scan since we do
-         * not care whether we visit lossy chunks or not.
-         */
     }
 
     /*
      * With a big bitmap and small work_mem, it's possible that we cannot get
-     * under maxentries.  Again, if that happens, we'd end up uselessly
+     * under maxbytes.  Again, if that happens, we'd end up uselessly
      * calling tbm_lossify over and over.  To prevent this from becoming a
-     * performance sink, force maxentries up to at least double the current
-     * number of entries.  (In essence, we're admitting inability to fit
-     * within work_mem when we do this.)  Note that this test will not fire if
-     * we broke out of the loop early; and if we didn't, the current number of
-     * entries is simply not reducible any further.
+     * performance sink, force maxbytes up to at least double the current
+     * memory use.  (In essence, we're admitting inability to fit within
+     * work_mem when we do this.)  Note that this test will not fire if we
+     * broke out of the loop early; and if we didn't, the current memory use
+     * is simply not reducible any further.
      */
-    if (tbm->nentries > tbm->maxentries / 2) {
-        tbm->maxentries = Min(tbm->nentries, (INT_MAX - 1) / 2) * 2;
+    if (tbm->memused > tbm->maxbytes / 2) {
+        tbm->maxbytes = tbm->memused * 2;
     }
 }
 
-/*
- * qsort comparator to handle PagetableEntry pointers.
- */
-static int tbm_comparator(const void* left, const void* right)
-{
-    PagetableEntryNode l = (*((PagetableEntry* const*)left))->entryNode;
-    PagetableEntryNode r = (*((PagetableEntry* const*)right))->entryNode;
-
-    if (l.partitionOid < r.partitionOid) {
-        return -1;
-    } else if (l.partitionOid > r.partitionOid) {
-        return 1;
-    } else if (l.blockNo < r.blockNo) {
-        return -1;
-    } else if (l.blockNo > r.blockNo) {
-        return 1;
-    }
-    return 0;
-}
-
 /*
  * 	tbm_attach_shared_iterate
  *
  * 	Allocate a backend-private iterator and attach the shared iterator state
  * 	to it so that multiple processed can iterate jointly.
- *
- * 	We also converts the DSA pointers to local pointers and store them into
- * 	our private iterator.
  */
 TBMSharedIterator *tbm_attach_shared_iterate(TBMSharedIteratorState *istate)
 {
@@ -33,24 +33,29 @@
 #include "pgstat.h"
 #include "utils/acl.h"
 #include "utils/builtins.h"
+#include "utils/globalcatcache.h"
 #include "utils/globalplancache.h"
+#include "utils/fmgroids.h"
 #include "utils/inet.h"
 #include "utils/timestamp.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/memprot.h"
+#include "utils/tqual.h"
 #include "utils/typcache.h"
 #include "utils/syscache.h"
 #include "pgxc/pgxc.h"
 #include "pgxc/nodemgr.h"
 #include "postmaster/autovacuum.h"
 #include "postmaster/postmaster.h"
+#include "storage/lmgr.h"
 #include "storage/lwlock.h"
 #include "postgres.h"
 #include "knl/knl_variable.h"
 #include "storage/proc.h"
 #include "storage/procarray.h"
 #include "storage/buf_internals.h"
+#include "storage/cucache_mgr.h"
 #include "workload/cpwlm.h"
 #include "workload/workload.h"
 #include "pgxc/pgxcnode.h"
@@ -76,6 +81,7 @@ extern Datum pg_stat_get_tuples_updated(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_tuples_changed(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_tuples_deleted(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_tuples_hot_updated(PG_FUNCTION_ARGS);
+extern Datum pg_stat_get_hot_chain_histogram(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_live_tuples(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_dead_tuples(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_blocks_fetched(PG_FUNCTION_ARGS);
@@ -120,6 +126,7 @@ extern Datum pgxc_stat_get_status(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_sql_count(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_thread(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_env(PG_FUNCTION_ARGS);
+extern Datum pg_stat_get_lwlock_tranches(PG_FUNCTION_ARGS);
 extern Datum pg_backend_pid(PG_FUNCTION_ARGS);
 extern Datum pg_current_userid(PG_FUNCTION_ARGS);
 extern Datum pg_current_sessionid(PG_FUNCTION_ARGS);
@@ -174,6 +181,7 @@ extern Datum pg_stat_get_bgwriter_stat_reset_time(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_buf_written_backend(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_buf_fsync_backend(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_buf_alloc(PG_FUNCTION_ARGS);
+extern Datum pg_stat_get_fast_path_overflow(PG_FUNCTION_ARGS);
 
 extern Datum pg_stat_get_xact_numscans(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_xact_tuples_returned(PG_FUNCTION_ARGS);
@@ -205,6 +213,8 @@ extern Datum pv_instance_time(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_file_stat(PG_FUNCTION_ARGS);
 extern Datum get_local_rel_iostat(PG_FUNCTION_ARGS);
 extern Datum pg_stat_get_redo_stat(PG_FUNCTION_ARGS);
+extern Datum pg_stat_get_cu_cache_stat(PG_FUNCTION_ARGS);
+extern Datum pg_stat_get_cstore_delta_stat(PG_FUNCTION_ARGS);
 extern Datum pv_session_stat(PG_FUNCTION_ARGS);
 extern Datum pv_session_memory(PG_FUNCTION_ARGS);
 
@@ -735,6 +745,36 @@ Datum pg_stat_get_tuples_hot_updated(PG_FUNCTION_ARGS)
     PG_RETURN_INT64(result);
 }
 
+/* HOT chains walked in the relation, by length in power-of-two buckets */
+Datum pg_stat_get_hot_chain_histogram(PG_FUNCTION_ARGS)
+{
+    Oid rel_id = PG_GETARG_OID(0);
+    int64 counts[PGSTAT_HOT_CHAIN_BUCKETS] = {0};
+    Datum elems[PGSTAT_HOT_CHAIN_BUCKETS];
+    List* stat_list = NIL;
+    ListCell* stat_cell = NULL;
+    PgStat_StatTabKey tab_key;
+    PgStat_StatTabEntry* tab_entry = NULL;
+
+    pg_stat_get_stat_list(&stat_list, &tab_key.statFlag, rel_id);
+    foreach (stat_cell, stat_list) {
+        tab_key.tableid = lfirst_oid(stat_cell);
+        tab_entry = pgstat_fetch_stat_tabentry(&tab_key);
+        if (PointerIsValid(tab_entry)) {
+            for (int i = 0; i < PGSTAT_HOT_CHAIN_BUCKETS; i++)
+                counts[i] += (int64)(tab_entry->hot_chain_len[i]);
+        }
+    }
+    if (PointerIsValid(stat_list)) {
+        list_free(stat_list);
+    }
+
+    for (int i = 0; i < PGSTAT_HOT_CHAIN_BUCKETS; i++)
+        elems[i] = Int64GetDatum(counts[i]);
+    PG_RETURN_ARRAYTYPE_P(
+        construct_array(elems, PGSTAT_HOT_CHAIN_BUCKETS, INT8OID, sizeof(int64), FLOAT8PASSBYVAL, 'd'));
+}
+
 Datum pg_stat_get_tuples_changed(PG_FUNCTION_ARGS)
 {
     Oid rel_id = PG_GETARG_OID(0);
@@ -2854,6 +2894,80 @@ Datum pg_stat_get_env(PG_FUNCTION_ARGS)
     }
 }
 
+static Datum lwlock_time_histogram(pg_atomic_uint64* hist)
+{
+    Datum elems[LWLOCK_TIME_BUCKETS];
+
+    for (int i = 0; i < LWLOCK_TIME_BUCKETS; i++)
+        elems[i] = Int64GetDatum((int64)pg_atomic_read_u64(&hist[i]));
+    return PointerGetDatum(
+        construct_array(elems, LWLOCK_TIME_BUCKETS, INT8OID, sizeof(int64), FLOAT8PASSBYVAL, 'd'));
+}
+
+/* spin, sleep and timing counters of each LWLock tranche */
+Datum pg_stat_get_lwlock_tranches(PG_FUNCTION_ARGS)
+{
+    FuncCallContext* func_ctx = NULL;
+    int* next_slot = NULL;
+    LWLockTrancheStats* stats = NULL;
+    const char* name = NULL;
+
+    if (SRF_IS_FIRSTCALL()) {
+        MemoryContext old_context;
+        TupleDesc tupdesc;
+
+        func_ctx = SRF_FIRSTCALL_INIT();
+
+        old_context = MemoryContextSwitchTo(func_ctx->multi_call_memory_ctx);
+
+        tupdesc = CreateTemplateTupleDesc(7, false);
+        TupleDescInitEntry(tupdesc, (AttrNumber)1, "tranche", TEXTOID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber)2, "queue_mode", BOOLOID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber)3, "spin_acquired", INT8OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber)4, "spin_failed", INT8OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber)5, "blocked", INT8OID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber)6, "wait_time_hist", INT8ARRAYOID, -1, 0);
+        TupleDescInitEntry(tupdesc, (AttrNumber)7, "hold_time_hist", INT8ARRAYOID, -1, 0);
+
+        func_ctx->tuple_desc = BlessTupleDesc(tupdesc);
+        func_ctx->user_fctx = palloc0(sizeof(int));
+
+        MemoryContextSwitchTo(old_context);
+    }
+
+    /* stuff done on every call of the function */
+    func_ctx = SRF_PERCALL_SETUP();
+    next_slot = (int*)func_ctx->user_fctx;
+
+    /* skip tranche IDs nobody registered */
+    while (*next_slot < NUM_LWLOCK_STATS_SLOTS) {
+        stats = GetLWLockTrancheStats((*next_slot)++, &name);
+        if (stats != NULL) {
+            break;
+        }
+    }
+
+    if (stats != NULL) {
+        Datum values[7];
+        bool nulls[7] = {false};
+        HeapTuple tuple = NULL;
+
+        values[0] = CStringGetTextDatum(name);
+        values[1] = BoolGetDatum(stats->queueMode);
+        values[2] = Int64GetDatum((int64)pg_atomic_read_u64(&stats->spinAcquired));
+        values[3] = Int64GetDatum((int64)pg_atomic_read_u64(&stats->spinFailed));
+        values[4] = Int64GetDatum((int64)pg_atomic_read_u64(&stats->blocked));
+        values[5] = lwlock_time_histogram(stats->waitTime);
+        values[6] = lwlock_time_histogram(stats->holdTime);
+
+        tuple = heap_form_tuple(func_ctx->tuple_desc, values, nulls);
+        SRF_RETURN_NEXT(func_ctx, HeapTupleGetDatum(tuple));
+    } else {
+        /* nothing left */
+        SRF_RETURN_DONE(func_ctx);
+    }
+}
+
 Datum pg_backend_pid(PG_FUNCTION_ARGS)
 {
     PG_RETURN_INT64(t_thrd.proc_cxt.MyProcPid);
@@ -6153,6 +6267,12 @@ Datum pg_stat_get_buf_alloc(PG_FUNCTION_ARGS)
     PG_RETURN_INT64(pgstat_fetch_global()->buf_alloc);
 }
 
+/* relation locks that fell back to the main lock table because their fast-path group was full */
+Datum pg_stat_get_fast_path_overflow(PG_FUNCTION_ARGS)
+{
+    PG_RETURN_INT64((int64)GetFastPathLockOverflowCount());
+}
+
 Datum pg_stat_get_xact_numscans(PG_FUNCTION_ARGS)
 {
     Oid rel_id = PG_GETARG_OID(0);
@@ -7492,6 +7612,269 @@ Datum pv_instance_time(PG_FUNCTION_ARGS)
     }
 }
 
+#define CU_CACHE_STAT_COL_NUM 8
+
+/*
+ * @Description: statistics of CU cache, one row for each tier
+ */
+Datum pg_stat_get_cu_cache_stat(PG_FUNCTION_ARGS)
+{
+    FuncCallContext* func_ctx = NULL;
+    CUCacheTierInfo* tier_info = NULL;
+
+    if (SRF_IS_FIRSTCALL()) {
+        TupleDesc tup_desc;
+        MemoryContext old_context;
+
+        func_ctx = SRF_FIRSTCALL_INIT();
+        old_context = MemoryContextSwitchTo(func_ctx->multi_call_memory_ctx);
+
+        /* this had better match gs_cu_cache_stat view in system_views.sql */
+        tup_desc = CreateTemplateTupleDesc(CU_CACHE_STAT_COL_NUM, false);
+        TupleDescInitEntry(tup_desc, (AttrNumber)1, "tier", TEXTOID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)2, "max_bytes", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)3, "used_bytes", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)4, "hits", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)5, "misses", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)6, "hit_ratio", FLOAT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)7, "evictions", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)8, "probation_admissions", INT8OID, -1, 0);
+
+        func_ctx->tuple_desc = BlessTupleDesc(tup_desc);
+        tier_info = (CUCacheTierInfo*)palloc0(sizeof(CUCacheTierInfo) * CU_CACHE_TIER_NUM);
+        CUCache->GetTierInfo(tier_info);
+        func_ctx->user_fctx = tier_info;
+        func_ctx->max_calls = CU_CACHE_TIER_NUM;
+
+        (void)MemoryContextSwitchTo(old_context);
+    }
+
+    func_ctx = SRF_PERCALL_SETUP();
+    if (func_ctx->call_cntr < func_ctx->max_calls) {
+        Datum values[CU_CACHE_STAT_COL_NUM];
+        bool nulls[CU_CACHE_STAT_COL_NUM] = {false};
+        HeapTuple tuple = NULL;
+        int i = 0;
+
+        tier_info = ((CUCacheTierInfo*)func_ctx->user_fctx) + func_ctx->call_cntr;
+        uint64 accesses = tier_info->hits + tier_info->misses;
+
+        values[i++] = CStringGetTextDatum(tier_info->tierName);
+        values[i++] = Int64GetDatum(tier_info->maxBytes);
+        values[i++] = Int64GetDatum(tier_info->usedBytes);
+        values[i++] = Int64GetDatum((int64)tier_info->hits);
+        values[i++] = Int64GetDatum((int64)tier_info->misses);
+        values[i++] = Float8GetDatum((accesses == 0) ? 0.0 : ((double)tier_info->hits / accesses));
+        values[i++] = Int64GetDatum((int64)tier_info->evictions);
+        values[i++] = Int64GetDatum((int64)tier_info->probations);
+
+        tuple = heap_form_tuple(func_ctx->tuple_desc, values, nulls);
+        SRF_RETURN_NEXT(func_ctx, HeapTupleGetDatum(tuple));
+    } else {
+        SRF_RETURN_DONE(func_ctx);
+    }
+}
+
+#define CSTORE_DELTA_STAT_COL_NUM 8
+
+/* one column table or partition with its delta table */
+typedef struct CStoreDeltaStatItem {
+    Oid relid;
+    Oid partid;
+    Oid deltaid;
+} CStoreDeltaStatItem;
+
+/*
+ * @Description: collect the column tables and partitions of current database
+ *     which own a delta table.
+ * @OUT nitems: number of returned items
+ * @Return: array of items
+ */
+static CStoreDeltaStatItem* collect_cstore_delta_items(int* nitems)
+{
+    Relation classRel;
+    Relation partRel;
+    HeapScanDesc scan;
+    HeapTuple tuple;
+    ScanKeyData key[1];
+    List* cstoreParents = NIL;
+    int maxItems = 64;
+    int n = 0;
+    CStoreDeltaStatItem* items = (CStoreDeltaStatItem*)palloc(sizeof(CStoreDeltaStatItem) * maxItems);
+
+    classRel = heap_open(RelationRelationId, AccessShareLock);
+    ScanKeyInit(&key[0], Anum_pg_class_relkind, BTEqualStrategyNumber, F_CHAREQ, CharGetDatum(RELKIND_RELATION));
+    scan = heap_beginscan(classRel, SnapshotNow, 1, key);
+    while ((tuple = heap_getnext(scan, ForwardScanDirection)) != NULL) {
+        Form_pg_class classForm = (Form_pg_class)GETSTRUCT(tuple);
+
+        if (classForm->relnamespace == CSTORE_NAMESPACE || !rel_is_CU_format(tuple, RelationGetDescr(classRel)))
+            continue;
+
+        if (classForm->parttype != PARTTYPE_NON_PARTITIONED_RELATION) {
+            cstoreParents = lappend_oid(cstoreParents, HeapTupleGetOid(tuple));
+            continue;
+        }
+        if (!OidIsValid(classForm->reldeltarelid))
+            continue;
+
+        if (n == maxItems) {
+            maxItems *= 2;
+            items = (CStoreDeltaStatItem*)repalloc(items, sizeof(CStoreDeltaStatItem) * maxItems);
+        }
+        items[n].relid = HeapTupleGetOid(tuple);
+        items[n].partid = InvalidOid;
+        items[n].deltaid = classForm->reldeltarelid;
+        n++;
+    }
+    heap_endscan(scan);
+    heap_close(classRel, AccessShareLock);
+
+    if (cstoreParents != NIL) {
+        partRel = heap_open(PartitionRelationId, AccessShareLock);
+        ScanKeyInit(&key[0],
+            Anum_pg_partition_parttype,
+            BTEqualStrategyNumber,
+            F_CHAREQ,
+            CharGetDatum(PART_OBJ_TYPE_TABLE_PARTITION));
+        scan = heap_beginscan(partRel, SnapshotNow, 1, key);
+        while ((tuple = heap_getnext(scan, ForwardScanDirection)) != NULL) {
+            Form_pg_partition partForm = (Form_pg_partition)GETSTRUCT(tuple);
+
+            if (!OidIsValid(partForm->reldeltarelid) || !list_member_oid(cstoreParents, partForm->parentid))
+                continue;
+
+            if (n == maxItems) {
+                maxItems *= 2;
+                items = (CStoreDeltaStatItem*)repalloc(items, sizeof(CStoreDeltaStatItem) * maxItems);
+            }
+            items[n].relid = partForm->parentid;
+            items[n].partid = HeapTupleGetOid(tuple);
+            items[n].deltaid = partForm->reldeltarelid;
+            n++;
+        }
+        heap_endscan(scan);
+        heap_close(partRel, AccessShareLock);
+        list_free(cstoreParents);
+    }
+
+    *nitems = n;
+    return items;
+}
+
+/*
+ * @Description: delta table statistics of column tables in current database,
+ *     one row for each table or partition. last_merge is the last (auto)vacuum
+ *     that merged the delta table, and merge_lag is the time since then if
+ *     there are rows waiting in the delta table.
+ */
+Datum pg_stat_get_cstore_delta_stat(PG_FUNCTION_ARGS)
+{
+    FuncCallContext* func_ctx = NULL;
+    CStoreDeltaStatItem* items = NULL;
+
+    if (SRF_IS_FIRSTCALL()) {
+        TupleDesc tup_desc;
+        MemoryContext old_context;
+        int nitems = 0;
+
+        func_ctx = SRF_FIRSTCALL_INIT();
+        old_context = MemoryContextSwitchTo(func_ctx->multi_call_memory_ctx);
+
+        /* this had better match gs_cstore_delta_stat view in system_views.sql */
+        tup_desc = CreateTemplateTupleDesc(CSTORE_DELTA_STAT_COL_NUM, false);
+        TupleDescInitEntry(tup_desc, (AttrNumber)1, "relid", OIDOID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)2, "partid", OIDOID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)3, "delta_relid", OIDOID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)4, "live_tuples", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)5, "dead_tuples", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)6, "delta_bytes", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)7, "last_merge", TIMESTAMPTZOID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)8, "merge_lag", INTERVALOID, -1, 0);
+
+        func_ctx->tuple_desc = BlessTupleDesc(tup_desc);
+        func_ctx->user_fctx = collect_cstore_delta_items(&nitems);
+        func_ctx->max_calls = nitems;
+
+        (void)MemoryContextSwitchTo(old_context);
+    }
+
+    func_ctx = SRF_PERCALL_SETUP();
+    if (func_ctx->call_cntr < func_ctx->max_calls) {
+        Datum values[CSTORE_DELTA_STAT_COL_NUM];
+        bool nulls[CSTORE_DELTA_STAT_COL_NUM] = {false};
+        HeapTuple tuple = NULL;
+        PgStat_StatTabKey tab_key;
+        PgStat_StatTabEntry* delta_entry = NULL;
+        PgStat_StatTabEntry* tab_entry = NULL;
+        int64 live_tuples = 0;
+        TimestampTz last_merge = 0;
+        int i = 0;
+
+        items = ((CStoreDeltaStatItem*)func_ctx->user_fctx) + func_ctx->call_cntr;
+
+        tab_key.statFlag = InvalidOid;
+        tab_key.tableid = items->deltaid;
+        delta_entry = pgstat_fetch_stat_tabentry(&tab_key);
+
+        tab_key.statFlag = OidIsValid(items->partid) ? items->relid : InvalidOid;
+        tab_key.tableid = OidIsValid(items->partid) ? items->partid : items->relid;
+        tab_entry = pgstat_fetch_stat_tabentry(&tab_key);
+        if (tab_entry != NULL) {
+            last_merge = Max(tab_entry->vacuum_timestamp, tab_entry->autovac_vacuum_timestamp);
+        }
+
+        values[i++] = ObjectIdGetDatum(items->relid);
+        nulls[i] = !OidIsValid(items->partid);
+        values[i++] = ObjectIdGetDatum(items->partid);
+        values[i++] = ObjectIdGetDatum(items->deltaid);
+        if (delta_entry != NULL) {
+            live_tuples = (int64)delta_entry->n_live_tuples;
+            values[i++] = Int64GetDatum(live_tuples);
+            values[i++] = Int64GetDatum((int64)delta_entry->n_dead_tuples);
+        } else {
+            values[i++] = Int64GetDatum(0);
+            values[i++] = Int64GetDatum(0);
+        }
+
+        /* never wait for a delta merge holding the delta table exclusively */
+        if (ConditionalLockRelationOid(items->deltaid, AccessShareLock)) {
+            Relation delta_rel = try_relation_open(items->deltaid, NoLock);
+            if (delta_rel != NULL) {
+                values[i] = Int64GetDatum((int64)RelationGetNumberOfBlocks(delta_rel) * BLCKSZ);
+                relation_close(delta_rel, NoLock);
+            } else {
+                nulls[i] = true;
+            }
+            UnlockRelationOid(items->deltaid, AccessShareLock);
+        } else {
+            nulls[i] = true;
+        }
+        i++;
+
+        if (last_merge != 0) {
+            values[i++] = TimestampTzGetDatum(last_merge);
+        } else {
+            nulls[i++] = true;
+        }
+
+        if (live_tuples <= 0) {
+            Interval* zero = (Interval*)palloc0(sizeof(Interval));
+            values[i++] = IntervalPGetDatum(zero);
+        } else if (last_merge != 0) {
+            values[i++] = DirectFunctionCall2(
+                timestamp_mi, TimestampTzGetDatum(GetCurrentTimestamp()), TimestampTzGetDatum(last_merge));
+        } else {
+            nulls[i++] = true;
+        }
+
+        tuple = heap_form_tuple(func_ctx->tuple_desc, values, nulls);
+        SRF_RETURN_NEXT(func_ctx, HeapTupleGetDatum(tuple));
+    } else {
+        SRF_RETURN_DONE(func_ctx);
+    }
+}
+
 Datum pg_stat_get_redo_stat(PG_FUNCTION_ARGS)
 {
     FuncCallContext* func_ctx = NULL;
@@ -12146,6 +12529,47 @@ Datum local_double_write_stat(PG_FUNCTION_ARGS)
     PG_RETURN_DATUM(HeapTupleGetDatum(tuple));
 }
 
+/*
+ * @Description: statistics of each double write file, one row per file in use
+ */
+Datum local_double_write_file_stat(PG_FUNCTION_ARGS)
+{
+    FuncCallContext* func_ctx = NULL;
+
+    if (SRF_IS_FIRSTCALL()) {
+        TupleDesc tup_desc = NULL;
+        MemoryContext old_context;
+
+        func_ctx = SRF_FIRSTCALL_INIT();
+        old_context = MemoryContextSwitchTo(func_ctx->multi_call_memory_ctx);
+
+        tup_desc = CreateTemplateTupleDesc(DW_FILE_VIEW_COL_NUM, false);
+        for (int i = 0; i < DW_FILE_VIEW_COL_NUM; i++) {
+            TupleDescInitEntry(tup_desc, (AttrNumber)(i + 1), g_dw_file_view_col_arr[i].name,
+                g_dw_file_view_col_arr[i].data_type, -1, 0);
+        }
+
+        func_ctx->tuple_desc = BlessTupleDesc(tup_desc);
+        func_ctx->max_calls = g_instance.attr.attr_storage.dw_file_num;
+        (void)MemoryContextSwitchTo(old_context);
+    }
+
+    func_ctx = SRF_PERCALL_SETUP();
+    if (func_ctx->call_cntr < func_ctx->max_calls) {
+        Datum values[DW_FILE_VIEW_COL_NUM];
+        bool nulls[DW_FILE_VIEW_COL_NUM] = {false};
+        HeapTuple tuple = NULL;
+
+        for (int i = 0; i < DW_FILE_VIEW_COL_NUM; i++) {
+            values[i] = g_dw_file_view_col_arr[i].get_data((int)func_ctx->call_cntr);
+        }
+        tuple = heap_form_tuple(func_ctx->tuple_desc, values, nulls);
+        SRF_RETURN_NEXT(func_ctx, HeapTupleGetDatum(tuple));
+    }
+
+    SRF_RETURN_DONE(func_ctx);
+}
+
 Datum remote_double_write_stat(PG_FUNCTION_ARGS)
 {
     FuncCallContext* func_ctx = NULL;
@@ -12228,6 +12652,27 @@ Datum local_redo_stat(PG_FUNCTION_ARGS)
     PG_RETURN_DATUM(HeapTupleGetDatum(tuple));
 }
 
+Datum local_redo_prefetch_stat(PG_FUNCTION_ARGS)
+{
+    TupleDesc tup_desc = NULL;
+    HeapTuple tuple = NULL;
+    Datum values[REDO_PREFETCH_VIEW_COL_SIZE];
+    bool nulls[REDO_PREFETCH_VIEW_COL_SIZE] = {false};
+    uint32 i;
+
+    tup_desc = CreateTemplateTupleDesc(REDO_PREFETCH_VIEW_COL_SIZE, false);
+    for (i = 0; i < REDO_PREFETCH_VIEW_COL_SIZE; i++) {
+        TupleDescInitEntry(tup_desc, (AttrNumber)(i + 1), g_redoPrefetchViewArr[i].name,
+            g_redoPrefetchViewArr[i].data_type, -1, 0);
+        values[i] = g_redoPrefetchViewArr[i].get_data();
+        nulls[i] = false;
+    }
+
+    tup_desc = BlessTupleDesc(tup_desc);
+    tuple = heap_form_tuple(tup_desc, values, nulls);
+    PG_RETURN_DATUM(HeapTupleGetDatum(tuple));
+}
+
 Datum remote_redo_stat(PG_FUNCTION_ARGS)
 {
     FuncCallContext* func_ctx = NULL;
@@ -12541,6 +12986,92 @@ Datum gs_globalplancache_prepare_status(PG_FUNCTION_ARGS)
     }
 }
 
+/*
+ * Entries, memory and hit rate of the global catcache, one row per cache ID
+ * used since the start of the instance.
+ */
+Datum gs_globalcatcache_status(PG_FUNCTION_ARGS)
+{
+    FuncCallContext *func_ctx = NULL;
+    MemoryContext old_context;
+
+    /* stuff done only on the first call of the function */
+    if (SRF_IS_FIRSTCALL()) {
+        TupleDesc tup_desc;
+
+        /* create a function context for cross-call persistence */
+        func_ctx = SRF_FIRSTCALL_INIT();
+
+        /*
+         * switch to memory context appropriate for multiple function
+         * calls
+         */
+        old_context = MemoryContextSwitchTo(func_ctx->multi_call_memory_ctx);
+
+#define GCC_TUPLES_ATTR_NUM 9
+
+        tup_desc = CreateTemplateTupleDesc(GCC_TUPLES_ATTR_NUM, false);
+
+        TupleDescInitEntry(tup_desc, (AttrNumber) 1, "nodename", TEXTOID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber) 2, "cache_id", INT4OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber) 3, "catalog", TEXTOID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber) 4, "entries", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber) 5, "memory_bytes", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber) 6, "searches", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber) 7, "hits", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber) 8, "loads", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber) 9, "invalidations", INT8OID, -1, 0);
+
+        /* complete descriptor of the tupledesc */
+        func_ctx->tuple_desc = BlessTupleDesc(tup_desc);
+
+        /* total number of tuples to be returned, none if the global catcache is off */
+        func_ctx->user_fctx = (void *)GlobalCatCacheGetStatus(&(func_ctx->max_calls));
+
+        (void)MemoryContextSwitchTo(old_context);
+    }
+
+    /* stuff done on every call of the function */
+    func_ctx = SRF_PERCALL_SETUP();
+    GlobalCatCacheStatus *entry = (GlobalCatCacheStatus *)func_ctx->user_fctx;
+
+    if (func_ctx->call_cntr < func_ctx->max_calls) {
+        /* do when there is more left to send */
+        Datum values[GCC_TUPLES_ATTR_NUM];
+        bool nulls[GCC_TUPLES_ATTR_NUM];
+        HeapTuple tuple;
+        char *catalog = NULL;
+
+        errno_t rc = memset_s(values, sizeof(values), 0, sizeof(values));
+        securec_check(rc, "\0", "\0");
+        rc = memset_s(nulls, sizeof(nulls), 0, sizeof(nulls));
+        securec_check(rc, "\0", "\0");
+
+        entry += func_ctx->call_cntr;
+
+        values[0] = CStringGetTextDatum(g_instance.attr.attr_common.PGXCNodeName);
+        values[1] = Int32GetDatum(entry->cache_id);
+        catalog = get_rel_name(entry->reloid);
+        if (catalog != NULL) {
+            values[2] = CStringGetTextDatum(catalog);
+        } else {
+            nulls[2] = true;
+        }
+        values[3] = Int64GetDatum((int64)entry->ntup);
+        values[4] = Int64GetDatum((int64)entry->bytes);
+        values[5] = Int64GetDatum((int64)entry->searches);
+        values[6] = Int64GetDatum((int64)entry->hits);
+        values[7] = Int64GetDatum((int64)entry->loads);
+        values[8] = Int64GetDatum((int64)entry->invals);
+
+        tuple = heap_form_tuple(func_ctx->tuple_desc, values, nulls);
+        SRF_RETURN_NEXT(func_ctx, HeapTupleGetDatum(tuple));
+    } else {
+        /* do when there is no more left */
+        SRF_RETURN_DONE(func_ctx);
+    }
+}
+
 Datum local_rto_stat(PG_FUNCTION_ARGS)
 {
     TupleDesc tup_desc = NULL;
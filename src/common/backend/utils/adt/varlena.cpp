@@ -4849,6 +4849,43 @@ Datum pg_column_size(PG_FUNCTION_ARGS)
     PG_RETURN_INT32(result);
 }
 
+/*
+ * Return the compression method of a datum, NULL if it is not compressed
+ *
+ * Works on any data type
+ */
+Datum pg_column_compression(PG_FUNCTION_ARGS)
+{
+    int typlen;
+    const char* result = NULL;
+
+    /* On first call, get the input type's typlen, and save at *fn_extra */
+    if (fcinfo->flinfo->fn_extra == NULL) {
+        /* Lookup the datatype of the supplied argument */
+        Oid argtypeid = get_fn_expr_argtype(fcinfo->flinfo, 0);
+
+        typlen = get_typlen(argtypeid);
+        if (typlen == 0) {  /* should not happen */
+            ereport(
+                ERROR, (errcode(ERRCODE_CACHE_LOOKUP_FAILED), errmsg("cache lookup failed for type %u", argtypeid)));
+        }
+        fcinfo->flinfo->fn_extra = MemoryContextAlloc(fcinfo->flinfo->fn_mcxt, sizeof(int));
+        *((int*)fcinfo->flinfo->fn_extra) = typlen;
+    } else {
+        typlen = *((int*)fcinfo->flinfo->fn_extra);
+    }
+
+    /* only a varlena can be compressed */
+    if (typlen == -1) {
+        result = GetCompressionMethodName(toast_get_compression_id((struct varlena*)PG_GETARG_POINTER(0)));
+    }
+    if (result == NULL) {
+        PG_RETURN_NULL();
+    }
+
+    PG_RETURN_TEXT_P(cstring_to_text(result));
+}
+
 /*
  * @Description: This function is used to calculate the size of a datum
  *
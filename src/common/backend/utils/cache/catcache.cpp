@@ -31,9 +31,7 @@
 #include "parser/parse_relation.h"
 #include "parser/parse_type.h"
 #include "pgstat.h"
-#ifdef CATCACHE_STATS
 #include "storage/ipc.h" /* for on_proc_exit */
-#endif
 #include "storage/lmgr.h"
 #include "utils/acl.h"
 #include "utils/datum.h"
@@ -42,6 +40,7 @@
 #include "utils/extended_statistics.h"
 #include "utils/fmgroids.h"
 #include "utils/fmgrtab.h"
+#include "utils/globalcatcache.h"
 #include "utils/hashutils.h"
 #include "utils/inval.h"
 #include "utils/lsyscache.h"
@@ -50,6 +49,7 @@
 #include "utils/rel_gs.h"
 #include "utils/relcache.h"
 #include "utils/resowner.h"
+#include "utils/snapmgr.h"
 #include "utils/syscache.h"
 #include "utils/tqual.h"
 
@@ -101,6 +101,12 @@ static void cat_cache_remove_clist(CatCache* cache, CatCList* cl);
 static void catalog_cache_initialize_cache(CatCache* cache);
 static CatCTup* catalog_cache_create_entry(CatCache* cache, HeapTuple ntp, Datum* arguments, uint32 hashValue,
     Index hashIndex, bool negative, bool isnailed = false);
+static CatCTup* catalog_cache_create_global_entry(
+    CatCache* cache, GlobalCatCTup* gct, uint32 hashValue, Index hashIndex);
+static CatCTup* catalog_cache_publish_entry(
+    CatCache* cache, HeapTuple ntp, Oid dbId, uint64 generation, uint32 hashValue, Index hashIndex);
+static void catalog_cache_link_entry(CatCache* cache, CatCTup* ct, uint32 hashValue, Index hashIndex, bool negative,
+    bool isnailed);
 static void cat_cache_free_keys(TupleDesc tupdesc, int nkeys, const int* attnos, Datum* keys);
 static void cat_cache_copy_keys(TupleDesc tupdesc, int nkeys, const int* attnos, Datum* srckeys, Datum* dstkeys);
 
@@ -515,6 +521,9 @@ static void cat_cache_remove_ctup(CatCache* cache, CatCTup* ct)
     if (ct->negative) {
         cat_cache_free_keys(cache->cc_tupdesc, cache->cc_nkeys, cache->cc_keyno, ct->keys);
     }
+    if (ct->global != NULL) {
+        GlobalCatCacheRelease(ct->global);
+    }
     pfree_ext(ct);
 
     --cache->cc_ntup;
@@ -823,6 +832,70 @@ void CatalogCacheFlushCatalog(Oid cat_id)
     CACHE1_elog(DEBUG2, "end of CatalogCacheFlushCatalog call");
 }
 
+/*
+ *		ReleaseGlobalCatCacheRefs
+ *
+ *	Drop the references the session catcaches hold on global catcache
+ *	entries, before the session memory goes away. The session entries must
+ *	not be used any more.
+ */
+void ReleaseGlobalCatCacheRefs(void)
+{
+    CatCache* cache = NULL;
+
+    if (u_sess->cache_cxt.cache_header == NULL) {
+        return;
+    }
+
+    for (cache = u_sess->cache_cxt.cache_header->ch_caches; cache; cache = cache->cc_next) {
+        for (int i = 0; i < cache->cc_nbuckets; i++) {
+            for (Dlelem* elt = DLGetHead(&cache->cc_bucket[i]); elt; elt = DLGetSucc(elt)) {
+                CatCTup* ct = (CatCTup*)DLE_VAL(elt);
+
+                if (ct->global != NULL) {
+                    GlobalCatCacheRelease(ct->global);
+                    ct->global = NULL;
+                    ct->dead = true;
+                }
+            }
+        }
+    }
+}
+
+static void cat_cache_release_global_refs(int code, Datum arg)
+{
+    ReleaseGlobalCatCacheRefs();
+}
+
+/*
+ * Whether a catcache miss may be served from, and published to, the global
+ * catcache. The global entries stand for committed catalog contents, so
+ * neither historic snapshots nor a transaction which changed the catalogs
+ * of the cache (its own changes are not in the global entries yet, or the
+ * global entries may not see them) can use it.
+ */
+static bool catalog_cache_use_global(const CatCache* cache)
+{
+    static THR_LOCAL bool exit_callback_registered = false;
+
+    if (!ENABLE_GLOBAL_CATCACHE || IsBootstrapProcessingMode() || u_sess->attr.attr_common.IsInplaceUpgrade ||
+        HistoricSnapshotActive()) {
+        return false;
+    }
+    if (!cache->cc_relisshared && !OidIsValid(u_sess->proc_cxt.MyDatabaseId)) {
+        return false;
+    }
+    if (TransactionHasCatcacheInvalidations()) {
+        return false;
+    }
+
+    if (!exit_callback_registered) {
+        on_proc_exit(cat_cache_release_global_refs, 0);
+        exit_callback_registered = true;
+    }
+    return true;
+}
+
 /*
  *		InitCatCache
  *
@@ -1463,6 +1536,29 @@ static HeapTuple search_cat_cache_miss(
      * This case is rare enough that it's not worth expending extra cycles to
      * detect.
      */
+    bool use_global = false;
+    Oid db_id = InvalidOid;
+    uint64 generation = 0;
+
+    if (ct == NULL && catalog_cache_use_global(cache)) {
+        GlobalCatCTup* gct = NULL;
+
+        db_id = cache->cc_relisshared ? InvalidOid : u_sess->proc_cxt.MyDatabaseId;
+        /* must be read before the catalog is scanned, see GlobalCatCacheInsert() */
+        generation = GlobalCatCacheGeneration(cache->id);
+
+        ResourceOwnerEnlargeCatCacheRefs(t_thrd.utils_cxt.CurrentResourceOwner);
+        gct = GlobalCatCacheSearch(cache, db_id, hash_value, arguments);
+        if (gct != NULL) {
+            ct = catalog_cache_create_global_entry(cache, gct, hash_value, hash_index);
+            /* immediately set the refcount to 1 */
+            ct->refcount++;
+            ResourceOwnerRememberCatCacheRef(t_thrd.utils_cxt.CurrentResourceOwner, &ct->tuple);
+        } else {
+            use_global = true;
+        }
+    }
+
     if (ct == NULL) {
         relation = heap_open(cache->cc_reloid, AccessShareLock);
 
@@ -1472,7 +1568,12 @@ static HeapTuple search_cat_cache_miss(
             relation, cache->cc_indexoid, index_scan_ok(cache, cur_skey), SnapshotNow, nkeys, cur_skey);
 
         while (HeapTupleIsValid(ntp = systable_getnext(scandesc))) {
-            ct = catalog_cache_create_entry(cache, ntp, arguments, hash_value, hash_index, false);
+            if (use_global) {
+                ct = catalog_cache_publish_entry(cache, ntp, db_id, generation, hash_value, hash_index);
+            }
+            if (ct == NULL) {
+                ct = catalog_cache_create_entry(cache, ntp, arguments, hash_value, hash_index, false);
+            }
             /* immediately set the refcount to 1 */
             ResourceOwnerEnlargeCatCacheRefs(t_thrd.utils_cxt.CurrentResourceOwner);
             ct->refcount++;
@@ -2497,10 +2598,72 @@ static CatCTup* catalog_cache_create_entry(
         MemoryContextSwitchTo(oldcxt);
     }
 
-    /*
-     * Finish initializing the CatCTup header, and add it to the cache's
-     * linked list and counts.
-     */
+    ct->global = NULL;
+    catalog_cache_link_entry(cache, ct, hashValue, hashIndex, negative, isnailed);
+
+    return ct;
+}
+
+/*
+ * catalog_cache_create_global_entry
+ *		Create a new CatCTup entry using the tuple of a global catcache
+ *		entry, taking over the caller's reference on it. The new entry
+ *		initially has refcount 0.
+ */
+static CatCTup* catalog_cache_create_global_entry(
+    CatCache* cache, GlobalCatCTup* gct, uint32 hashValue, Index hashIndex)
+{
+    CatCTup* ct = (CatCTup*)MemoryContextAlloc(u_sess->cache_mem_cxt, sizeof(CatCTup));
+    errno_t rc;
+
+    /* the tuple header is ours, the tuple data stays in the global entry */
+    ct->tuple = gct->tuple;
+    rc = memcpy_s(ct->keys, sizeof(ct->keys), gct->keys, sizeof(gct->keys));
+    securec_check(rc, "", "");
+    ct->global = gct;
+    catalog_cache_link_entry(cache, ct, hashValue, hashIndex, false, false);
+
+    return ct;
+}
+
+/*
+ * catalog_cache_publish_entry
+ *		Publish a tuple just read from the catalog in the global catcache,
+ *		and create a CatCTup entry using it. Returns NULL if the catalog was
+ *		changed since the generation was read; the caller then makes a
+ *		session-private copy of the tuple.
+ */
+static CatCTup* catalog_cache_publish_entry(
+    CatCache* cache, HeapTuple ntp, Oid dbId, uint64 generation, uint32 hashValue, Index hashIndex)
+{
+    GlobalCatCTup* gct = NULL;
+    HeapTuple dtp;
+
+    /* global entries never refer to toast tuples, see catalog_cache_create_entry() */
+    if (HeapTupleHasExternal(ntp)) {
+        dtp = toast_flatten_tuple(ntp, cache->cc_tupdesc);
+    } else {
+        dtp = ntp;
+    }
+
+    gct = GlobalCatCacheInsert(cache, dbId, hashValue, dtp, generation);
+
+    if (dtp != ntp) {
+        heap_freetuple_ext(dtp);
+    }
+    if (gct == NULL) {
+        return NULL;
+    }
+    return catalog_cache_create_global_entry(cache, gct, hashValue, hashIndex);
+}
+
+/*
+ * Finish initializing the CatCTup header, and add it to the cache's linked
+ * list and counts.
+ */
+static void catalog_cache_link_entry(CatCache* cache, CatCTup* ct, uint32 hashValue, Index hashIndex, bool negative,
+    bool isnailed)
+{
     ct->ct_magic = CT_MAGIC;
     ct->my_cache = cache;
     DLInitElem(&ct->cache_elem, (void*)ct);
@@ -2515,8 +2678,6 @@ static CatCTup* catalog_cache_create_entry(
 
     cache->cc_ntup++;
     u_sess->cache_cxt.cache_header->ch_ntup++;
-
-    return ct;
 }
 
 /*
@@ -0,0 +1,352 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * globalcatcache.cpp
+ *        instance-wide cache of catalog tuples shared by the session catcaches
+ *
+ * Every session keeps its own catcache, so with many sessions each catalog
+ * tuple is read from the catalogs and copied once per session. With
+ * enable_global_catcache on, a session catcache miss first looks up the
+ * global catcache, and a tuple read from the catalogs is published there.
+ * The session catcache entries then point to the tuple of the global entry
+ * instead of holding a copy of their own.
+ *
+ * Global entries are immutable and reference counted. They are removed by
+ * the invalidation messages of the transactions changing the catalogs, sent
+ * through SendSharedInvalidMessages() once the changes are visible. A
+ * session which read a tuple before the invalidation of its cache ID may
+ * not publish it, since the tuple may be stale already; the generation
+ * counter of each cache ID tells that.
+ *
+ * IDENTIFICATION
+ *        src/common/backend/utils/cache/globalcatcache.cpp
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+#include "knl/knl_variable.h"
+
+#include "access/heapam.h"
+#include "storage/lwlock.h"
+#include "utils/globalcatcache.h"
+#include "utils/memutils.h"
+#include "utils/syscache.h"
+
+#define GlobalCatCacheBucket(cacheId, dbId, hashValue) \
+    (((hashValue) ^ ((uint32)(cacheId) * 0x9E3779B1U) ^ ((uint32)(dbId) * 0x85EBCA6BU)) & \
+        (GLOBAL_CATCACHE_NBUCKETS - 1))
+#define GlobalCatCachePartitionLock(bucket) \
+    GetMainLWLockByIndex(FirstGlobalCatCacheLock + (int)((bucket) % NUM_GLOBAL_CATCACHE_PARTITIONS))
+
+static inline bool GlobalCatCacheKeysEqual(const CatCache* cache, const Datum* keys1, const Datum* keys2)
+{
+    for (int i = 0; i < cache->cc_nkeys; i++) {
+        if (!(cache->cc_fastequal[i])(keys1[i], keys2[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Create the global catcache, called by the postmaster when it creates the
+ * shared memory. Entries left by the sessions of a previous incarnation are
+ * dropped, they may have missed invalidations when the backends crashed.
+ */
+void GlobalCatCacheInit(void)
+{
+    GlobalCatCache* gcc = g_instance.cache_cxt.global_catcache;
+
+    if (gcc != NULL) {
+        g_instance.cache_cxt.global_catcache = NULL;
+        MemoryContextDelete(gcc->context);
+    }
+    if (!g_instance.attr.attr_common.enable_global_catcache) {
+        return;
+    }
+
+    MemoryContext context = AllocSetContextCreate(g_instance.cache_cxt.global_cache_mem,
+        "GlobalCatCacheMemory",
+        ALLOCSET_DEFAULT_MINSIZE,
+        ALLOCSET_DEFAULT_INITSIZE,
+        ALLOCSET_DEFAULT_MAXSIZE,
+        SHARED_CONTEXT);
+
+    gcc = (GlobalCatCache*)MemoryContextAllocZero(context, sizeof(GlobalCatCache));
+    gcc->context = context;
+    gcc->buckets = (GlobalCatCTup**)MemoryContextAllocZero(context, sizeof(GlobalCatCTup*) * GLOBAL_CATCACHE_NBUCKETS);
+    gcc->ncaches = SysCacheSize;
+    gcc->stats = (GlobalCatCacheStats*)MemoryContextAllocZero(context, sizeof(GlobalCatCacheStats) * SysCacheSize);
+    for (int i = 0; i < SysCacheSize; i++) {
+        gcc->stats[i].reloid = SysCacheGetRelid(i);
+    }
+    g_instance.cache_cxt.global_catcache = gcc;
+}
+
+/*
+ * The generation of a cache ID, to be read before the catalogs are scanned
+ * for a tuple which is going to be published by GlobalCatCacheInsert().
+ */
+uint64 GlobalCatCacheGeneration(int cacheId)
+{
+    return pg_atomic_read_u64(&g_instance.cache_cxt.global_catcache->stats[cacheId].generation);
+}
+
+/*
+ * Look up the tuple matching the given keys. A found entry is returned with
+ * a reference for the caller, to be dropped with GlobalCatCacheRelease().
+ */
+GlobalCatCTup* GlobalCatCacheSearch(CatCache* cache, Oid dbId, uint32 hashValue, const Datum* arguments)
+{
+    GlobalCatCache* gcc = g_instance.cache_cxt.global_catcache;
+    GlobalCatCacheStats* stats = &gcc->stats[cache->id];
+    uint32 bucket = GlobalCatCacheBucket(cache->id, dbId, hashValue);
+    LWLock* partition_lock = GlobalCatCachePartitionLock(bucket);
+    GlobalCatCTup* gct = NULL;
+
+    (void)pg_atomic_fetch_add_u64(&stats->searches, 1);
+
+    (void)LWLockAcquire(partition_lock, LW_SHARED);
+    for (gct = gcc->buckets[bucket]; gct != NULL; gct = gct->next) {
+        if (gct->cache_id == cache->id && gct->db_id == dbId && gct->hash_value == hashValue &&
+            GlobalCatCacheKeysEqual(cache, gct->keys, arguments)) {
+            (void)pg_atomic_fetch_add_u32(&gct->refcount, 1);
+            break;
+        }
+    }
+    LWLockRelease(partition_lock);
+
+    if (gct != NULL) {
+        (void)pg_atomic_fetch_add_u64(&stats->hits, 1);
+    }
+    return gct;
+}
+
+/*
+ * Publish a tuple read from the catalogs while the generation of its cache
+ * ID was the given one. The entry, or an equal one published meanwhile by
+ * another session, is returned with a reference for the caller. NULL is
+ * returned if the cache ID was invalidated since, the tuple may be stale.
+ */
+GlobalCatCTup* GlobalCatCacheInsert(CatCache* cache, Oid dbId, uint32 hashValue, HeapTuple tuple, uint64 generation)
+{
+    GlobalCatCache* gcc = g_instance.cache_cxt.global_catcache;
+    GlobalCatCacheStats* stats = &gcc->stats[cache->id];
+    uint32 bucket = GlobalCatCacheBucket(cache->id, dbId, hashValue);
+    LWLock* partition_lock = GlobalCatCachePartitionLock(bucket);
+    Size size = MAXALIGN(sizeof(GlobalCatCTup)) + tuple->t_len;
+    GlobalCatCTup* gct = (GlobalCatCTup*)MemoryContextAlloc(gcc->context, size);
+    GlobalCatCTup* other = NULL;
+    errno_t rc;
+
+    gct->next = NULL;
+    gct->cache_id = cache->id;
+    gct->db_id = dbId;
+    gct->hash_value = hashValue;
+    gct->refcount = 2; /* one for the bucket, one for the caller */
+    gct->size = size;
+    gct->tuple = *tuple;
+    gct->tuple.t_data = (HeapTupleHeader)((char*)gct + MAXALIGN(sizeof(GlobalCatCTup)));
+    rc = memcpy_s((char*)gct->tuple.t_data, tuple->t_len, (const char*)tuple->t_data, tuple->t_len);
+    securec_check(rc, "", "");
+
+    /* by-reference keys point into the tuple, like those of session catcache entries */
+    for (int i = 0; i < cache->cc_nkeys; i++) {
+        bool isnull = false;
+
+        gct->keys[i] = heap_getattr(&gct->tuple, cache->cc_keyno[i], cache->cc_tupdesc, &isnull);
+        Assert(!isnull);
+    }
+
+    (void)LWLockAcquire(partition_lock, LW_EXCLUSIVE);
+    if (pg_atomic_read_u64(&stats->generation) != generation) {
+        LWLockRelease(partition_lock);
+        pfree(gct);
+        return NULL;
+    }
+    for (other = gcc->buckets[bucket]; other != NULL; other = other->next) {
+        if (other->cache_id == cache->id && other->db_id == dbId && other->hash_value == hashValue &&
+            GlobalCatCacheKeysEqual(cache, other->keys, gct->keys)) {
+            (void)pg_atomic_fetch_add_u32(&other->refcount, 1);
+            break;
+        }
+    }
+    if (other == NULL) {
+        gct->next = gcc->buckets[bucket];
+        gcc->buckets[bucket] = gct;
+    }
+    LWLockRelease(partition_lock);
+
+    if (other != NULL) {
+        pfree(gct);
+        return other;
+    }
+    (void)pg_atomic_fetch_add_u64(&stats->ntup, 1);
+    (void)pg_atomic_fetch_add_u64(&stats->bytes, size);
+    (void)pg_atomic_fetch_add_u64(&stats->loads, 1);
+    return gct;
+}
+
+/*
+ * Drop a reference to an entry, freeing it with the last one.
+ */
+void GlobalCatCacheRelease(GlobalCatCTup* gct)
+{
+    if (pg_atomic_sub_fetch_u32(&gct->refcount, 1) == 0) {
+        GlobalCatCacheStats* stats = &g_instance.cache_cxt.global_catcache->stats[gct->cache_id];
+
+        (void)pg_atomic_fetch_sub_u64(&stats->bytes, (int64)gct->size);
+        pfree(gct);
+    }
+}
+
+/*
+ * Unlink an entry from its bucket, whose partition lock is held exclusively,
+ * and drop the reference of the bucket.
+ */
+static void GlobalCatCacheRemove(GlobalCatCTup** link)
+{
+    GlobalCatCTup* gct = *link;
+    GlobalCatCacheStats* stats = &g_instance.cache_cxt.global_catcache->stats[gct->cache_id];
+
+    *link = gct->next;
+    (void)pg_atomic_fetch_sub_u64(&stats->ntup, 1);
+    (void)pg_atomic_fetch_add_u64(&stats->invals, 1);
+    GlobalCatCacheRelease(gct);
+}
+
+static void GlobalCatCacheInvalidateTuple(int cacheId, Oid dbId, uint32 hashValue)
+{
+    GlobalCatCache* gcc = g_instance.cache_cxt.global_catcache;
+    uint32 bucket = GlobalCatCacheBucket(cacheId, dbId, hashValue);
+    LWLock* partition_lock = GlobalCatCachePartitionLock(bucket);
+
+    /* stop the sessions which read the old version from publishing it */
+    (void)pg_atomic_fetch_add_u64(&gcc->stats[cacheId].generation, 1);
+
+    (void)LWLockAcquire(partition_lock, LW_EXCLUSIVE);
+    GlobalCatCTup** link = &gcc->buckets[bucket];
+    while (*link != NULL) {
+        GlobalCatCTup* gct = *link;
+
+        if (gct->cache_id == cacheId && gct->db_id == dbId && gct->hash_value == hashValue) {
+            GlobalCatCacheRemove(link);
+        } else {
+            link = &gct->next;
+        }
+    }
+    LWLockRelease(partition_lock);
+}
+
+/*
+ * Remove the entries of a database, or of the caches on a catalog of it if
+ * catId is valid.
+ */
+static void GlobalCatCacheInvalidateAll(Oid dbId, Oid catId)
+{
+    GlobalCatCache* gcc = g_instance.cache_cxt.global_catcache;
+
+    for (int i = 0; i < gcc->ncaches; i++) {
+        if (!OidIsValid(catId) || gcc->stats[i].reloid == catId) {
+            (void)pg_atomic_fetch_add_u64(&gcc->stats[i].generation, 1);
+        }
+    }
+
+    for (int partition = 0; partition < NUM_GLOBAL_CATCACHE_PARTITIONS; partition++) {
+        LWLock* partition_lock = GetMainLWLockByIndex(FirstGlobalCatCacheLock + partition);
+
+        (void)LWLockAcquire(partition_lock, LW_EXCLUSIVE);
+        for (uint32 bucket = partition; bucket < GLOBAL_CATCACHE_NBUCKETS; bucket += NUM_GLOBAL_CATCACHE_PARTITIONS) {
+            GlobalCatCTup** link = &gcc->buckets[bucket];
+
+            while (*link != NULL) {
+                GlobalCatCTup* gct = *link;
+
+                if (gct->db_id == dbId && (!OidIsValid(catId) || gcc->stats[gct->cache_id].reloid == catId)) {
+                    GlobalCatCacheRemove(link);
+                } else {
+                    link = &gct->next;
+                }
+            }
+        }
+        LWLockRelease(partition_lock);
+    }
+}
+
+/*
+ * Apply invalidation messages sent to the other sessions. Called by
+ * SendSharedInvalidMessages(), so the catalog changes they stand for are
+ * visible already.
+ */
+void GlobalCatCacheInvalidate(const SharedInvalidationMessage* msgs, int n)
+{
+    for (int i = 0; i < n; i++) {
+        const SharedInvalidationMessage* msg = &msgs[i];
+
+        if (msg->id >= 0) {
+            GlobalCatCacheInvalidateTuple(msg->cc.id, msg->cc.dbId, msg->cc.hashValue);
+        } else if (msg->id == SHAREDINVALCATALOG_ID) {
+            GlobalCatCacheInvalidateAll(msg->cat.dbId, msg->cat.catId);
+        }
+    }
+}
+
+/*
+ * Forget the tuples of a dropped database, its OID may be used again by a
+ * database created later.
+ */
+void GlobalCatCacheDropDatabase(Oid dbId)
+{
+    Assert(OidIsValid(dbId));
+
+    GlobalCatCacheInvalidateAll(dbId, InvalidOid);
+}
+
+/*
+ * Counters of the cache IDs used so far, for catcache_status().
+ */
+GlobalCatCacheStatus* GlobalCatCacheGetStatus(uint32* num)
+{
+    GlobalCatCache* gcc = g_instance.cache_cxt.global_catcache;
+    GlobalCatCacheStatus* status = NULL;
+    uint32 count = 0;
+
+    *num = 0;
+    if (gcc == NULL) {
+        return NULL;
+    }
+
+    status = (GlobalCatCacheStatus*)palloc0(sizeof(GlobalCatCacheStatus) * gcc->ncaches);
+    for (int i = 0; i < gcc->ncaches; i++) {
+        GlobalCatCacheStats* stats = &gcc->stats[i];
+        GlobalCatCacheStatus* entry = &status[count];
+
+        entry->searches = pg_atomic_read_u64(&stats->searches);
+        entry->ntup = pg_atomic_read_u64(&stats->ntup);
+        if (entry->searches == 0 && entry->ntup == 0) {
+            continue;
+        }
+        entry->cache_id = i;
+        entry->reloid = stats->reloid;
+        entry->bytes = pg_atomic_read_u64(&stats->bytes);
+        entry->hits = pg_atomic_read_u64(&stats->hits);
+        entry->loads = pg_atomic_read_u64(&stats->loads);
+        entry->invals = pg_atomic_read_u64(&stats->invals);
+        count++;
+    }
+    *num = count;
+    return status;
+}
@@ -938,6 +938,23 @@ void CommandEndInvalidationMessages(void)
         &u_sess->inval_cxt.transInvalInfo->CurrentCmdInvalidMsgs);
 }
 
+/*
+ * TransactionHasCatcacheInvalidations
+ *		Has the current transaction changed catalog tuples so far?
+ *
+ * Such a transaction sees its own changes in the catalogs, which the other
+ * sessions don't see yet, so it must not go through the global catcache.
+ */
+bool TransactionHasCatcacheInvalidations(void)
+{
+    for (TransInvalidationInfo* info = u_sess->inval_cxt.transInvalInfo; info != NULL; info = info->parent) {
+        if (info->CurrentCmdInvalidMsgs.cclist != NULL || info->PriorCmdInvalidMsgs.cclist != NULL) {
+            return true;
+        }
+    }
+    return false;
+}
+
 /*
  * CacheInvalidateHeapTuple
  *		Register the given tuple for invalidation at end of command
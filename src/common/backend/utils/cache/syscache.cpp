@@ -632,6 +632,16 @@ void InitCatalogCache(void)
     u_sess->syscache_cxt.CacheInitialized = true;
 }
 
+/*
+ * SysCacheGetRelid - OID of the catalog the given cache is on
+ */
+Oid SysCacheGetRelid(int cacheId)
+{
+    Assert(cacheId >= 0 && cacheId < SysCacheSize);
+
+    return cacheinfo[cacheId].reloid;
+}
+
 /*
  * InitCatalogCachePhase2 - finish initializing the caches
  *
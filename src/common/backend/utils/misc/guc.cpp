@@ -109,6 +109,7 @@
 #include "replication/slot.h"
 #include "replication/syncrep.h"
 #include "replication/walreceiver.h"
+#include "replication/walprotocol.h"
 #include "replication/walsender.h"
 #include "storage/bufmgr.h"
 #include "storage/cucache_mgr.h"
@@ -255,6 +256,7 @@ const char* sync_guc_variable_namelist[] = {"work_mem",
     "log_duration",
     "log_error_verbosity",
     "log_lock_waits",
+    "log_cstore_load_timing",
     "log_statement",
     "log_temp_files",
     "track_activities",
@@ -355,6 +357,7 @@ const char* sync_guc_variable_namelist[] = {"work_mem",
     "prefetch_quantity",
     "backwrite_quantity",
     "cstore_prefetch_quantity",
+    "cstore_compress_workers",
     "enable_fast_allocate",
     "enable_adio_debug",
     "enable_adio_function",
@@ -415,6 +418,7 @@ static bool call_string_check_hook(
 static bool call_enum_check_hook(struct config_enum* conf, int* newval, void** extra, GucSource source, int elevel);
 static bool check_log_destination(char** newval, void** extra, GucSource source);
 static void assign_log_destination(const char* newval, void* extra);
+static bool check_lwlock_queue_tranches(char** newval, void** extra, GucSource source);
 
 void free_memory_context_list(memory_context_list* head_node);
 memory_context_list* split_string_into_list(const char* source);
@@ -946,6 +950,9 @@ static const struct config_enum_entry remote_read_options[] = {{"off", REMOTE_RE
     {"authentication", REMOTE_READ_AUTH, false},
     {NULL, 0, false}};
 
+static const struct config_enum_entry wal_stream_compression_options[] = {
+    {"off", WAL_STREAM_COMPRESS_OFF, false}, {"lz4", WAL_STREAM_COMPRESS_LZ4, false}, {NULL, 0, false}};
+
 static const struct config_enum_entry resource_track_log_options[] = {
     {"summary", SUMMARY, false}, {"detail", DETAIL, false}, {NULL, 0, false}};
 
@@ -1349,6 +1356,20 @@ static void init_configure_names_bool()
             NULL,
             NULL
         },
+        {
+            {
+                "enable_cu_cache_admission",
+                PGC_USERSET,
+                QUERY_TUNING,
+                gettext_noop("Admits CUs read only once into CStore cache on probation."),
+                NULL
+            },
+            &u_sess->attr.attr_storage.enable_cu_cache_admission,
+            true,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "enable_incremental_catchup",
@@ -2608,6 +2629,20 @@ static void init_configure_names_bool()
             NULL,
             NULL
         },
+        {
+            {
+                "track_lwlock_timing",
+                PGC_SUSET,
+                STATS_COLLECTOR,
+                gettext_noop("Collects wait and hold time histograms for lightweight locks."),
+                NULL
+            },
+            &u_sess->attr.attr_common.track_lwlock_timing,
+            false,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "update_process_title",
@@ -2781,6 +2816,20 @@ static void init_configure_names_bool()
             NULL,
             NULL
         },
+        {
+            {
+                "log_cstore_load_timing",
+                PGC_SUSET,
+                LOGGING_WHAT,
+                gettext_noop("Logs the time spent in each stage of column store loads."),
+                NULL
+            },
+            &u_sess->attr.attr_storage.log_cstore_load_timing,
+            false,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "log_hostname",
@@ -3867,6 +3916,20 @@ static void init_configure_names_bool()
             NULL,
             NULL
         },
+        {
+            {
+                "enable_global_catcache",
+                PGC_POSTMASTER,
+                CLIENT_CONN,
+                gettext_noop("Share the catalog tuples cached by the sessions across the instance."),
+                NULL
+            },
+            &g_instance.attr.attr_common.enable_global_catcache,
+            false,
+            NULL,
+            NULL,
+            NULL
+        },
         /* Database Security: Support database audit */
         /* add guc option about audit */
         {
@@ -4174,6 +4237,20 @@ static void init_configure_names_bool()
             NULL,
             NULL
         },
+        {
+            {
+                "enable_io_uring",
+                PGC_SIGHUP,
+                RESOURCES_ASYNCHRONOUS,
+                gettext_noop("Submits batches of file I/O through io_uring."),
+                gettext_noop("Falls back to synchronous reads and writes when the kernel does not support io_uring.")
+            },
+            &u_sess->attr.attr_storage.enable_io_uring,
+            false,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "td_compatible_truncation",
@@ -4347,6 +4424,21 @@ static void init_configure_names_bool()
             NULL,
             NULL
         },
+        {
+            {
+                "wal_flush_wait_queue",
+                PGC_SIGHUP,
+                WAL_SETTINGS,
+                gettext_noop("Lets the WAL writer flush the commit records of synchronous commits."),
+                gettext_noop("Committing backends wait in a queue and are woken up by the WAL writer "
+                    "once their commit record is flushed.")
+            },
+            &u_sess->attr.attr_storage.wal_flush_wait_queue,
+            false,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "enable_cbm_tracking",
@@ -5377,6 +5469,22 @@ static void init_configure_names_int()
             NULL,
             NULL
         },
+        {
+            {
+                "cstore_compressed_cache_ratio",
+                PGC_POSTMASTER,
+                RESOURCES_MEM,
+                gettext_noop("Sets the percentage of CStore data buffers used to cache compressed CUs."),
+                NULL
+            },
+            &g_instance.attr.attr_storage.cstore_compressed_cache_ratio,
+            0,
+            0,
+            90,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "max_loaded_cudesc",
@@ -6360,6 +6468,38 @@ static void init_configure_names_int()
             NULL,
             NULL
         },
+        {
+            {
+                "fast_path_lock_groups",
+                PGC_POSTMASTER,
+                LOCK_MANAGEMENT,
+                gettext_noop("Sets the number of fast-path relation lock groups per backend."),
+                gettext_noop("Each group holds 16 weak relation locks outside the shared lock table.")
+            },
+            &g_instance.attr.attr_storage.fast_path_lock_groups,
+            4,
+            1,
+            FP_LOCK_GROUPS_MAX,
+            NULL,
+            NULL,
+            NULL
+        },
+        {
+            {
+                "lwlock_spin_limit",
+                PGC_SIGHUP,
+                LOCK_MANAGEMENT,
+                gettext_noop("Sets the most times a contended lightweight lock is polled before sleeping."),
+                gettext_noop("Each lock adapts its own budget up to this limit. 0 turns spinning off.")
+            },
+            &u_sess->attr.attr_storage.lwlock_spin_limit,
+            100,
+            0,
+            PG_UINT16_MAX,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "max_pred_locks_per_transaction",
@@ -6684,6 +6824,24 @@ static void init_configure_names_int()
             NULL,
             NULL
         },
+        {
+            {
+                "wal_flush_group_delay",
+                PGC_SIGHUP,
+                WAL_SETTINGS,
+                gettext_noop("Sets the max delay in microseconds the WAL writer waits for more commits "
+                    "to share a flush."),
+                gettext_noop("The WAL writer waits only while the commit rate makes another commit "
+                    "likely within this delay. Used with wal_flush_wait_queue. Zero disables the delay.")
+            },
+            &u_sess->attr.attr_storage.wal_flush_group_delay,
+            0,
+            0,
+            100000,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "partition_lock_upgrade_timeout",
@@ -7183,6 +7341,41 @@ static void init_configure_names_int()
             NULL,
             NULL
         },
+        {
+            {
+                "autovacuum_deltamerge_threshold",
+                PGC_SIGHUP,
+                AUTOVACUUM,
+                gettext_noop("Minimum number of rows in the delta table of a column table prior to automatic "
+                             "delta merge."),
+                gettext_noop("0 turns off merging triggered by the delta size.")
+            },
+            &u_sess->attr.attr_storage.autovacuum_deltamerge_thresh,
+            60000,
+            0,
+            INT_MAX,
+            NULL,
+            NULL,
+            NULL
+        },
+        {
+            {
+                "autovacuum_deltamerge_max_lag",
+                PGC_SIGHUP,
+                AUTOVACUUM,
+                gettext_noop("Time since the last merge after which a non-empty delta table is merged "
+                             "automatically, even if it can not fill a CU."),
+                gettext_noop("0 turns off merging triggered by the merge lag."),
+                GUC_UNIT_S
+            },
+            &u_sess->attr.attr_storage.autovacuum_deltamerge_max_lag,
+            0,
+            0,
+            INT_MAX / 1000,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             /* see max_connections */
             {
@@ -8738,6 +8931,22 @@ static void init_configure_names_int()
             NULL,
             NULL
         },
+        {
+            {
+                "cstore_compress_workers",
+                PGC_USERSET,
+                RESOURCES_ASYNCHRONOUS,
+                gettext_noop("Sets the maximum number of parallel workers compressing CUs during cstore bulk load."),
+                gettext_noop("0 means CUs are compressed by the loading backend itself.")
+            },
+            &u_sess->attr.attr_storage.cstore_compress_workers,
+            0,
+            0,
+            MAX_PARALLEL_WORKER_LIMIT,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "fast_extend_file_size",
@@ -8772,6 +8981,22 @@ static void init_configure_names_int()
             NULL,
             NULL
         },
+        {
+            {
+                "hot_chain_prune_threshold",
+                PGC_USERSET,
+                CLIENT_CONN_STATEMENT,
+                gettext_noop("Sets the HOT chain length from which a scan has the heap page pruned."),
+                gettext_noop("0 turns this off, leaving pages to be pruned when they fill up.")
+            },
+            &u_sess->attr.attr_storage.hot_chain_prune_threshold,
+            8,
+            0,
+            MaxHeapTuplesPerPage,
+            NULL,
+            NULL,
+            NULL
+        },
 #ifdef ENABLE_MULTIPLE_NODES
         {
             {
@@ -9153,6 +9378,23 @@ static void init_configure_names_int()
             NULL,
             NULL
         },
+        {
+            {
+                "pagewriter_flush_after",
+                PGC_SIGHUP,
+                WAL_CHECKPOINTS,
+                gettext_noop("Number of pages after which the writes of the pagewriter are flushed to disk."),
+                NULL,
+                GUC_UNIT_BLOCKS
+            },
+            &u_sess->attr.attr_storage.pagewriter_flush_after,
+            DEFAULT_CHECKPOINT_FLUSH_AFTER,
+            0,
+            WRITEBACK_MAX_PENDING_FLUSHES,
+            NULL,
+            NULL,
+            NULL
+        },
 #ifdef ENABLE_MULTIPLE_NODES
         {
             {
@@ -9222,6 +9464,24 @@ static void init_configure_names_int()
             NULL,
             NULL
         },
+        {
+            {
+                "dw_file_num",
+                PGC_POSTMASTER,
+                WAL_CHECKPOINTS,
+                gettext_noop("Sets the number of double write files."),
+                gettext_noop("Page writer and background writer threads are spread over the files, "
+                             "each file has its own flush lock."),
+                0
+            },
+            &g_instance.attr.attr_storage.dw_file_num,
+            1,
+            1,
+            DW_MAX_FILE_NUM,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "datanode_heartbeat_interval",
@@ -9305,6 +9565,22 @@ static void init_configure_names_int()
             NULL,
             NULL
         },
+        {
+            {
+                "recovery_prefetch_distance",
+                PGC_SIGHUP,
+                RESOURCES_RECOVERY,
+                gettext_noop("Sets the max number of data blocks prefetched ahead of parallel redo workers."),
+                gettext_noop("Zero disables prefetching during recovery.")
+            },
+            &u_sess->attr.attr_storage.recovery_prefetch_distance,
+            256,
+            0,
+            8192,
+            NULL,
+            NULL,
+            NULL
+        },
         {
             {
                 "max_keep_log_seg",
@@ -11226,6 +11502,22 @@ static void init_configure_names_string()
             NULL,
             NULL
         },
+        {
+            {
+                "lwlock_queue_tranches",
+                PGC_POSTMASTER,
+                LOCK_MANAGEMENT,
+                gettext_noop("Lists the lightweight lock tranches acquired in queue order."),
+                gettext_noop("New lockers of these tranches line up behind sleeping waiters "
+                    "instead of spinning or cutting in."),
+                GUC_LIST_INPUT | GUC_LIST_QUOTE
+            },
+            &g_instance.attr.attr_storage.lwlock_queue_tranches,
+            "",
+            check_lwlock_queue_tranches,
+            NULL,
+            NULL
+        },
         /* Get the ReplConnInfo1 from postgresql.conf and assign to ReplConnArray1. */
         {
             {
@@ -12114,6 +12406,21 @@ static void init_configure_names_enum()
             NULL,
             NULL
         },
+        {
+            {
+                "wal_stream_compression",
+                PGC_SIGHUP,
+                REPLICATION_STANDBY,
+                gettext_noop("Sets the compression asked by walreceiver for the WAL stream."),
+                gettext_noop("Takes effect when walreceiver connects to the sender next time.")
+            },
+            &u_sess->attr.attr_storage.wal_stream_compression,
+            WAL_STREAM_COMPRESS_OFF,
+            wal_stream_compression_options,
+            NULL,
+            NULL,
+            NULL
+        },
         /* End-of-list marker */
         {
             {
@@ -19059,6 +19366,25 @@ static void assign_history_memory(int newval, void* extra)
  * check_hook, assign_hook and show_hook subroutines
  */
 
+static bool check_lwlock_queue_tranches(char** newval, void** extra, GucSource source)
+{
+    char* rawstring = NULL;
+    List* elemlist = NIL;
+
+    /* Names are matched against the registered tranches in CreateLWLocks */
+    rawstring = pstrdup(*newval);
+    if (!SplitIdentifierString(rawstring, ',', &elemlist)) {
+        GUC_check_errdetail("List syntax is invalid.");
+        pfree(rawstring);
+        list_free(elemlist);
+        return false;
+    }
+
+    pfree(rawstring);
+    list_free(elemlist);
+    return true;
+}
+
 static bool check_log_destination(char** newval, void** extra, GucSource source)
 {
     char* rawstring = NULL;
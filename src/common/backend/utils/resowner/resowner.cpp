@@ -100,6 +100,10 @@ typedef struct ResourceOwnerData {
     CacheSlotId_t* metaCacheSlots; /* dynamically allocated array */
     int maxMetaCacheSlots;         /* currently allocated array size */
 
+    int nCompressedCacheSlots;           /* number of owned compressed CU cache block pins */
+    CacheSlotId_t* compressedCacheSlots; /* dynamically allocated array */
+    int maxCompressedCacheSlots;         /* currently allocated array size */
+
     // We have built-in support for remembering pthread_mutex
     //
     int nPthreadMutex;
@@ -259,6 +263,12 @@ static void ResourceOwnerReleaseInternal(
                 PrintMetaCacheBlockLeakWarning(owner->metaCacheSlots[owner->nMetaCacheSlots - 1]);
             ReleaseMetaBlock(owner->metaCacheSlots[owner->nMetaCacheSlots - 1]);
         }
+        while (owner->nCompressedCacheSlots > 0) {
+            if (isCommit)
+                CUCache->PrintCompressedCacheSlotLeakWarning(
+                    owner->compressedCacheSlots[owner->nCompressedCacheSlots - 1]);
+            CUCache->UnPinCompressedBlock(owner->compressedCacheSlots[owner->nCompressedCacheSlots - 1]);
+        }
 
         while (owner->nfakerelrefs > 0) {
             dlist_node *tail_node = dlist_tail_node(&(owner->fakerelrefs_list));
@@ -412,6 +422,7 @@ void ResourceOwnerDelete(ResourceOwner owner)
     Assert(owner->nfiles == 0);
     Assert(owner->nDataCacheSlots == 0);
     Assert(owner->nMetaCacheSlots == 0);
+    Assert(owner->nCompressedCacheSlots == 0);
     Assert(owner->nPthreadMutex == 0);
 
     /*
@@ -458,6 +469,8 @@ void ResourceOwnerDelete(ResourceOwner owner)
         pfree(owner->dataCacheSlots);
     if (owner->metaCacheSlots)
         pfree(owner->metaCacheSlots);
+    if (owner->compressedCacheSlots)
+        pfree(owner->compressedCacheSlots);
     if (owner->pThdMutexs)
         pfree(owner->pThdMutexs);
     if (owner->partmaprefs)
@@ -645,6 +658,29 @@ void ResourceOwnerEnlargeMetaCacheSlot(ResourceOwner owner)
     }
 }
 
+/*
+ * same as ResourceOwnerEnlargeCacheSlot()
+ */
+void ResourceOwnerEnlargeCompressedCacheSlot(ResourceOwner owner)
+{
+    int newmax;
+
+    if (owner == NULL || owner->nCompressedCacheSlots < owner->maxCompressedCacheSlots)
+        return; /* nothing to do */
+
+    if (owner->compressedCacheSlots == NULL) {
+        newmax = 16;
+        owner->compressedCacheSlots =
+            (CacheSlotId_t*)MemoryContextAlloc(t_thrd.top_mem_cxt, newmax * sizeof(CacheSlotId_t));
+        owner->maxCompressedCacheSlots = newmax;
+    } else {
+        newmax = owner->maxCompressedCacheSlots * 2;
+        owner->compressedCacheSlots =
+            (CacheSlotId_t*)repalloc(owner->compressedCacheSlots, newmax * sizeof(CacheSlotId_t));
+        owner->maxCompressedCacheSlots = newmax;
+    }
+}
+
 /*
  * Remember that a buffer pin is owned by a ResourceOwner
  *
@@ -692,6 +728,18 @@ void ResourceOwnerRememberMetaCacheSlot(ResourceOwner owner, CacheSlotId_t sloti
     }
 }
 
+/*
+ * same as ResourceOwnerRememberDataCacheSlot()
+ */
+void ResourceOwnerRememberCompressedCacheSlot(ResourceOwner owner, CacheSlotId_t slotid)
+{
+    if (owner != NULL) {
+        Assert(owner->nCompressedCacheSlots < owner->maxCompressedCacheSlots);
+        owner->compressedCacheSlots[owner->nCompressedCacheSlots] = slotid;
+        owner->nCompressedCacheSlots++;
+    }
+}
+
 /*
  * Forget that a data cache block pin is owned by a ResourceOwner
  *
@@ -757,6 +805,32 @@ void ResourceOwnerForgetMetaCacheSlot(ResourceOwner owner, CacheSlotId_t slotid)
     }
 }
 
+/*
+ * same as ResourceOwnerForgetDataCacheSlot()
+ */
+void ResourceOwnerForgetCompressedCacheSlot(ResourceOwner owner, CacheSlotId_t slotid)
+{
+    if (owner != NULL) {
+        CacheSlotId_t* compressedCacheSlots = owner->compressedCacheSlots;
+        int nb1 = owner->nCompressedCacheSlots - 1;
+        int i;
+
+        for (i = nb1; i >= 0; i--) {
+            if (compressedCacheSlots[i] == slotid) {
+                while (i < nb1) {
+                    compressedCacheSlots[i] = compressedCacheSlots[i + 1];
+                    i++;
+                }
+                owner->nCompressedCacheSlots = nb1;
+                return;
+            }
+        }
+        ereport(ERROR,
+            (errcode(ERRCODE_WARNING_PRIVILEGE_NOT_GRANTED),
+                errmsg("compressed cache block %d is not owned by resource owner %s", slotid, owner->name)));
+    }
+}
+
 /*
  * Forget that a buffer pin is owned by a ResourceOwner
  *
@@ -108,6 +108,7 @@
 
 #include <limits.h>
 
+#include "access/gin_private.h"
 #include "access/nbtree.h"
 #include "catalog/index.h"
 #include "commands/tablespace.h"
@@ -416,6 +417,9 @@ struct Tuplesortstate {
     /* These are specific to the index_hash subcase: */
     uint32 hash_mask; /* mask for sortable part of hash code */
 
+    /* These are specific to the index_gin subcase: */
+    GinState* ginstate; /* GIN state of the index being built */
+
     /*
      * These variables are specific to the Datum case; they are set by
      * tuplesort_begin_datum and used only by the DatumTuple routines.
@@ -644,11 +648,14 @@ static void writetup_cluster(Tuplesortstate* state, int tapenum, SortTuple* stup
 static void readtup_cluster(Tuplesortstate* state, SortTuple* stup, int tapenum, unsigned int len);
 static int comparetup_index_btree(const SortTuple* a, const SortTuple* b, Tuplesortstate* state);
 static int comparetup_index_hash(const SortTuple* a, const SortTuple* b, Tuplesortstate* state);
+static int comparetup_index_gin(const SortTuple* a, const SortTuple* b, Tuplesortstate* state);
 static void copytup_index(Tuplesortstate* state, SortTuple* stup, void* tup);
 static void writetup_index(Tuplesortstate* state, int tapenum, SortTuple* stup);
 static void readtup_index(Tuplesortstate* state, SortTuple* stup, int tapenum, unsigned int len);
+static void readtup_index_gin(Tuplesortstate* state, SortTuple* stup, int tapenum, unsigned int len);
 static void reversedirection_index_btree(Tuplesortstate* state);
 static void reversedirection_index_hash(Tuplesortstate* state);
+static void reversedirection_index_gin(Tuplesortstate* state);
 static int comparetup_datum(const SortTuple* a, const SortTuple* b, Tuplesortstate* state);
 static void copytup_datum(Tuplesortstate* state, SortTuple* stup, void* tup);
 static void writetup_datum(Tuplesortstate* state, int tapenum, SortTuple* stup);
@@ -1047,6 +1054,48 @@ Tuplesortstate* tuplesort_begin_index_hash(
     return state;
 }
 
+/*
+ * Sort the entry tuples of a GIN index build by attribute number and key.
+ * The tuples are formed by GinFormTuple and carry a posting list.
+ */
+Tuplesortstate* tuplesort_begin_index_gin(
+    Relation indexRel, GinState* ginstate, int workMem, SortCoordinate coordinate, bool randomAccess, int maxMem)
+{
+    Tuplesortstate* state = tuplesort_begin_common(workMem, coordinate, randomAccess);
+    MemoryContext oldcontext;
+
+    oldcontext = MemoryContextSwitchTo(state->sortcontext);
+
+#ifdef TRACE_SORT
+    if (u_sess->attr.attr_common.trace_sort) {
+        elog(LOG,
+            "begin index sort: gin, workMem = %d, randomAccess = %c, maxMem = %d",
+            workMem,
+            randomAccess ? 't' : 'f',
+            maxMem);
+    }
+#endif
+
+    state->nKeys = IndexRelationGetNumberOfKeyAttributes(indexRel);
+
+    state->comparetup = comparetup_index_gin;
+    state->copytup = copytup_index;
+    state->writetup = writetup_index;
+    state->readtup = readtup_index_gin;
+#ifdef PGXC
+    state->getlen = getlen;
+#endif
+    state->reversedirection = reversedirection_index_gin;
+
+    state->indexRel = indexRel;
+    state->ginstate = ginstate;
+    state->maxMem = maxMem * 1024L;
+
+    (void)MemoryContextSwitchTo(oldcontext);
+
+    return state;
+}
+
 Tuplesortstate* tuplesort_begin_datum(Oid datumType, Oid sortOperator, Oid sortCollation, bool nullsFirstFlag,
     int workMem, SortCoordinate coordinate, bool randomAccess)
 {
@@ -1465,6 +1514,31 @@ void tuplesort_putindextuplevalues(
     (void)MemoryContextSwitchTo(oldcontext);
 }
 
+/*
+ * Accept one GIN entry tuple while collecting input data for sort.
+ *
+ * The tuple is copied, so the caller may free it afterwards.
+ */
+void tuplesort_putgintuple(Tuplesortstate* state, IndexTuple tuple)
+{
+    MemoryContext oldcontext = MemoryContextSwitchTo(state->sortcontext);
+    SortTuple stup;
+    Size tuplen = IndexTupleSize(tuple);
+    errno_t rc;
+
+    stup.tupindex = 0;
+    stup.tuple = palloc(tuplen);
+    rc = memcpy_s(stup.tuple, tuplen, tuple, tuplen);
+    securec_check(rc, "\0", "\0");
+    USEMEM(state, GetMemoryChunkSpace(stup.tuple));
+    /* the keys are compared by comparetup_index_gin, no first-column value */
+    stup.datum1 = (Datum)0;
+    stup.isnull1 = true;
+    puttuple_common(state, &stup);
+
+    (void)MemoryContextSwitchTo(oldcontext);
+}
+
 /*
  * Accept one Datum while collecting input data for sort.
  *
@@ -3867,6 +3941,33 @@ static int comparetup_index_hash(const SortTuple* a, const SortTuple* b, Tupleso
     return 0;
 }
 
+static int comparetup_index_gin(const SortTuple* a, const SortTuple* b, Tuplesortstate* state)
+{
+    IndexTuple tuple1 = (IndexTuple)a->tuple;
+    IndexTuple tuple2 = (IndexTuple)b->tuple;
+    GinNullCategory category1;
+    GinNullCategory category2;
+    Datum key1;
+    Datum key2;
+    int compare;
+
+    key1 = gintuple_get_key(state->ginstate, tuple1, &category1);
+    key2 = gintuple_get_key(state->ginstate, tuple2, &category2);
+    compare = ginCompareAttEntries(state->ginstate,
+        gintuple_get_attrnum(state->ginstate, tuple1), key1, category1,
+        gintuple_get_attrnum(state->ginstate, tuple2), key2, category2);
+    if (compare != 0) {
+        return compare;
+    }
+
+    /*
+     * If the keys are equal, we sort on the first item of the posting lists,
+     * so that the lists of a key mostly come out in TID order.
+     */
+    return ginCompareItemPointers(&((GinPostingList*)GinGetPosting(tuple1))->first,
+        &((GinPostingList*)GinGetPosting(tuple2))->first);
+}
+
 static void copytup_index(Tuplesortstate* state, SortTuple* stup, void* tup)
 {
     IndexTuple tuple = (IndexTuple)tup;
@@ -3923,6 +4024,23 @@ static void readtup_index(Tuplesortstate* state, SortTuple* stup, int tapenum, u
     stup->datum1 = index_getattr(tuple, 1, RelationGetDescr(state->indexRel), &stup->isnull1);
 }
 
+static void readtup_index_gin(Tuplesortstate* state, SortTuple* stup, int tapenum, unsigned int len)
+{
+    unsigned int tuplen = len - sizeof(unsigned int);
+    IndexTuple tuple = (IndexTuple)palloc(tuplen);
+
+    USEMEM(state, GetMemoryChunkSpace(tuple));
+    LogicalTapeReadExact(state->tapeset, tapenum, tuple, tuplen);
+    if (state->randomAccess) {
+        /* need trailing length word? */
+        LogicalTapeReadExact(state->tapeset, tapenum, &tuplen, sizeof(tuplen));
+    }
+    stup->tuple = (void*)tuple;
+    /* no first-column value, see tuplesort_putgintuple */
+    stup->datum1 = (Datum)0;
+    stup->isnull1 = true;
+}
+
 static void reversedirection_index_btree(Tuplesortstate* state)
 {
     ScanKey scanKey = state->indexScanKey;
@@ -3941,6 +4059,14 @@ static void reversedirection_index_hash(Tuplesortstate* state)
             (errcode(ERRCODE_FEATURE_NOT_SUPPORTED), errmsg("reversedirection_index_hash is not implemented"))));
 }
 
+static void reversedirection_index_gin(Tuplesortstate* state)
+{
+    /* We don't support reversing direction in a gin index sort */
+    ereport(ERROR,
+        (errmodule(MOD_EXECUTOR),
+            (errcode(ERRCODE_FEATURE_NOT_SUPPORTED), errmsg("reversedirection_index_gin is not implemented"))));
+}
+
 /*
  * Routines specialized for DatumTuple case
  */
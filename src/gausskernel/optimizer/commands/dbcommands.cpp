@@ -60,6 +60,7 @@
 #include "utils/acl.h"
 #include "utils/builtins.h"
 #include "utils/fmgroids.h"
+#include "utils/globalcatcache.h"
 #include "utils/inval.h"
 #include "utils/memutils.h"
 #include "utils/pg_locale.h"
@@ -952,6 +953,14 @@ void dropdb(const char* dbname, bool missing_ok)
      */
     pgstat_drop_database(db_id);
 
+    /*
+     * And the global catcache, its tuples would be returned to a database
+     * created later with the same OID.
+     */
+    if (ENABLE_GLOBAL_CATCACHE) {
+        GlobalCatCacheDropDatabase(db_id);
+    }
+
     /*
      * Tell checkpointer to forget any pending fsync and unlink requests for
      * files in the database; else the fsyncs will fail at next checkpoint, or
@@ -2134,6 +2143,11 @@ void xlog_db_drop(Oid dbId, Oid tbSpcId)
     /* Drop pages for this database that are in the shared buffer cache */
     DropDatabaseBuffers(dbId);
 
+    /* Forget its tuples in the global catcache */
+    if (ENABLE_GLOBAL_CATCACHE) {
+        GlobalCatCacheDropDatabase(dbId);
+    }
+
     /* Also, clean out any fsync requests that might be pending in md.c */
     ForgetDatabaseFsyncRequests(dbId);
 
@@ -162,6 +162,8 @@ static void show_merge_append_keys(MergeAppendState* mstate, List* ancestors, Ex
 static void show_merge_sort_keys(PlanState* state, List* ancestors, ExplainState* es);
 static void show_sort_info(SortState* sortstate, ExplainState* es);
 static void show_hash_info(HashState* hashstate, ExplainState* es);
+static void show_tidbitmap_info(const BitmapHeapScanState* planstate, ExplainState* es);
+static void show_rough_check_info(const PlanState* planstate, ExplainState* es);
 static void show_vechash_info(VecHashJoinState* hashstate, ExplainState* es);
 static void show_instrumentation_count(const char* qlabel, int which, const PlanState* planstate, ExplainState* es);
 static void show_removed_rows(int which, const PlanState* planstate, int idx, int smpIdx, int* removeRows);
@@ -2375,6 +2377,8 @@ static void ExplainNode(
             show_scan_qual(plan->qual, "Filter", planstate, ancestors, es);
             if (plan->qual)
                 show_instrumentation_count("Rows Removed by Filter", 1, planstate, es);
+            if (es->analyze && IsA(planstate, BitmapHeapScanState))
+                show_tidbitmap_info((BitmapHeapScanState*)planstate, es);
             show_llvm_info(planstate, es);
             break;
         case T_SeqScan:
@@ -2390,6 +2394,8 @@ static void ExplainNode(
             show_scan_qual(plan->qual, "Filter", planstate, ancestors, es);
             if (plan->qual)
                 show_instrumentation_count("Rows Removed by Filter", 1, planstate, es);
+            if (es->analyze && IsA(plan, CStoreScan))
+                show_rough_check_info(planstate, es);
             show_llvm_info(planstate, es);
             break;
         case T_Gather: {
@@ -4424,6 +4430,49 @@ static void show_hashAgg_info(AggState* hashaggstate, ExplainState* es)
         }
     }
 }
+/*
+ * If it's EXPLAIN ANALYZE, show the exact/lossy pages for a BitmapHeapScan node
+ */
+static void show_tidbitmap_info(const BitmapHeapScanState* planstate, ExplainState* es)
+{
+    if (t_thrd.explain_cxt.explain_perf_mode != EXPLAIN_NORMAL)
+        return;
+
+    if (es->format != EXPLAIN_FORMAT_TEXT) {
+        ExplainPropertyLong("Exact Heap Blocks", planstate->exact_pages, es);
+        ExplainPropertyLong("Lossy Heap Blocks", planstate->lossy_pages, es);
+    } else if (planstate->exact_pages > 0 || planstate->lossy_pages > 0) {
+        appendStringInfoSpaces(es->str, es->indent * 2);
+        appendStringInfoString(es->str, "Heap Blocks:");
+        if (planstate->exact_pages > 0)
+            appendStringInfo(es->str, " exact=%ld", planstate->exact_pages);
+        if (planstate->lossy_pages > 0)
+            appendStringInfo(es->str, " lossy=%ld", planstate->lossy_pages);
+        appendStringInfoChar(es->str, '\n');
+    }
+}
+
+/*
+ * Show how many CUs of a column store scan were skipped by the rough check,
+ * from the min/max values or the bloom filters in their CU descriptors.
+ */
+static void show_rough_check_info(const PlanState* planstate, ExplainState* es)
+{
+    const Instrumentation* instr = planstate->instrument;
+
+    if (t_thrd.explain_cxt.explain_perf_mode != EXPLAIN_NORMAL || instr == NULL || !instr->needRCInfo)
+        return;
+
+    if (es->format != EXPLAIN_FORMAT_TEXT) {
+        ExplainPropertyLong("RoughCheck CUNone", instr->rcInfo.m_CUNone, es);
+        ExplainPropertyLong("RoughCheck CUSome", instr->rcInfo.m_CUSome, es);
+    } else if (instr->rcInfo.m_CUNone > 0) {
+        appendStringInfoSpaces(es->str, es->indent * 2);
+        appendStringInfo(
+            es->str, "RoughCheck CU: CUNone: %lu, CUSome: %lu\n", instr->rcInfo.m_CUNone, instr->rcInfo.m_CUSome);
+    }
+}
+
 /*
  * Show information on hash buckets/batches.
  */
@@ -8502,6 +8502,22 @@ static void ATExecSetOptions(Relation rel, const char* colName, Node* options, b
     Assert(IsA(options, List));
     ForbidToSetOptionsForAttribute((List*)options);
 
+    /* only a column that can be TOASTed has a compression method */
+    if (!isReset && attrtuple->attstorage == 'p') {
+        ListCell* cell = NULL;
+
+        foreach (cell, (List*)options) {
+            DefElem* def = (DefElem*)lfirst(cell);
+
+            if (pg_strcasecmp(def->defname, "compression") == 0) {
+                ereport(ERROR,
+                    (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                        errmsg("column data type %s does not support compression",
+                            format_type_be(attrtuple->atttypid))));
+            }
+        }
+    }
+
     /* Generate new proposed attoptions (text array) */
     datum = SysCacheGetAttr(ATTNAME, tuple, Anum_pg_attribute_attoptions, &isnull);
     newOptions = transformRelOptions(isnull ? (Datum)0 : datum, (List*)options, NULL, NULL, false, isReset);
@@ -4,24 +4,24 @@
  *	  Concurrent ("lazy") vacuuming.
  *
  *
- * The major space usage for LAZY VACUUM is storage for the array of dead
+ * The major space usage for LAZY VACUUM is storage for the set of dead
  * tuple TIDs, with the next biggest need being storage for per-disk-page
  * free space info.  We want to ensure we can vacuum even the very largest
  * relations with finite memory space usage.  To do that, we set upper bounds
  * on the number of tuples and pages we will keep track of at once.
  *
  * We are willing to use at most maintenance_work_mem memory space to keep
- * track of dead tuples.  We initially allocate an array of TIDs of that size,
- * with an upper limit that depends on table size (this limit ensures we don't
- * allocate a huge area uselessly for vacuuming small tables).	If the array
- * threatens to overflow, we suspend the heap scan phase and perform a pass of
- * index cleanup and page compaction, then resume the heap scan with an empty
- * TID array.
+ * track of dead tuples.  They are kept in a TidStore, which stores the dead
+ * offsets of a page as a bitmap or a short array and grows as needed.  If the
+ * store threatens to overflow, we suspend the heap scan phase and perform a
+ * pass of index cleanup and page compaction, then resume the heap scan with
+ * an empty store.  The indexes of a pass may be vacuumed by parallel workers,
+ * one index at a time each.
  *
  * If we're processing a table with no indexes, we can just vacuum each page
  * as we go; there's no need to save up multiple tuples to minimize the number
  * of index scans performed.  So we don't use maintenance_work_mem memory for
- * the TID array, just enough to hold as many heap tuples as fit on one page.
+ * the TID store, the dead tuples of the current page are enough.
  *
  *
  * Portions Copyright (c) 2020 Huawei Technologies Co.,Ltd.
@@ -43,6 +43,8 @@
 #include "access/cstore_insert.h"
 #include "access/genam.h"
 #include "access/heapam.h"
+#include "access/parallel.h"
+#include "access/tidstore.h"
 #include "access/transam.h"
 #include "access/visibilitymap.h"
 #include "access/xlog.h"
@@ -60,6 +62,7 @@
 #include "storage/bufmgr.h"
 #include "storage/freespace.h"
 #include "storage/lmgr.h"
+#include "storage/spin.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/pg_rusage.h"
@@ -75,13 +78,6 @@
 #include "pgxc/pgxc.h"
 #endif
 
-/*
- * Guesstimation of number of dead tuples per page.  This is used to
- * provide an upper limit to memory allocated when vacuuming small
- * tables.
- */
-#define LAZY_ALLOC_TUPLES MaxHeapTuplesPerPage
-
 /*
  * Before we consider skipping a page that's marked as clean in
  * visibility map, we must've seen at least this many clean pages.
@@ -102,11 +98,13 @@ typedef struct LVRelStats {
     BlockNumber pages_removed;
     double tuples_deleted;
     BlockNumber nonempty_pages; /* actually, last nonempty page + 1 */
-    /* List of TIDs of tuples we intend to delete */
-    /* NB: this list is ordered by TID address */
-    int num_dead_tuples;     /* current # of entries */
-    int max_dead_tuples;     /* # slots allocated in array */
-    ItemPointer dead_tuples; /* array of ItemPointerData */
+    /* Set of TIDs of tuples we intend to delete, NULL without indexes */
+    TidStore* dead_tuples;
+    int num_dead_tuples; /* current # of dead tuples, including the page ones */
+    /* dead tuples of the last page, not in dead_tuples yet */
+    BlockNumber page_dead_blkno;
+    int num_page_dead;
+    OffsetNumber page_dead[MaxOffsetNumber];
     int num_index_scans;
     TransactionId latestRemovedXid;
     bool lock_waiter_detected;
@@ -144,13 +142,185 @@ static void lazy_scan_rel(Relation onerel, LVRelStats* vacrelstats, VacuumStmt*
 static void lazy_vacuum_heap(Relation onerel, LVRelStats* vacrelstats);
 static bool lazy_check_needs_freeze(Buffer buf);
 static void lazy_vacuum_index(Relation indrel, IndexBulkDeleteResult** stats, LVRelStats* vacrelstats);
+static void lazy_vacuum_indexes(Relation onerel, Relation* Irel, IndexBulkDeleteResult** indstats, int nindexes,
+    LVRelStats* vacrelstats, bool cleanup);
 static IndexBulkDeleteResult* lazy_cleanup_index(
     Relation indrel, IndexBulkDeleteResult* stats, LVRelStats* vacrelstats);
-static int lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer, int tupindex, LVRelStats* vacrelstats);
-static void lazy_space_alloc(LVRelStats* vacrelstats, BlockNumber relblocks);
+static void lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer, const OffsetNumber* offsets,
+    int noffsets, LVRelStats* vacrelstats);
+static void lazy_space_alloc(LVRelStats* vacrelstats);
 static void lazy_record_dead_tuple(LVRelStats* vacrelstats, ItemPointer itemptr);
+static bool lazy_dead_tuples_full(LVRelStats* vacrelstats);
 static bool lazy_tid_reaped(ItemPointer itemptr, void* state, Oid partOid = InvalidOid);
-static int vac_cmp_itemptr(const void* left, const void* right);
+static void lazy_merge_cstore_delta(Relation onerel, Relation deltaRel, VacuumStmt* vacstmt);
+
+/*
+ * @Description: delete one row of delta table before it is moved into CU
+ * @IN deltaRel: delta table
+ * @IN deltaTup: row of delta table
+ * @IN wait: wait for the transaction modifying the row
+ * @Return: false if the row is changed or locked by another transaction
+ */
+static bool lazy_delete_delta_tuple(Relation deltaRel, HeapTuple deltaTup, bool wait)
+{
+    ItemPointerData updateCtid;
+    TransactionId updateXmax;
+
+    HTSU_Result result = heap_delete(deltaRel,
+        &deltaTup->t_self,
+        &updateCtid,
+        &updateXmax,
+        GetCurrentCommandId(true),
+        InvalidSnapshot,
+        wait);
+    return result == HeapTupleMayBeUpdated;
+}
+
+/*
+ * @Description: move the rows of delta table into CUs of column table.
+ *     VACUUM DELTAMERGE waits for the rows being modified by other transactions,
+ *     autovacuum skips them and leaves them for the next merge. With
+ *     VACOPT_DELTA_FULLCU (autovacuum) only the rows filling whole CUs are
+ *     moved: no row is deleted before the rows of the whole CU are at hand,
+ *     so each run does not leave a small CU behind. Only when rows skipped
+ *     there leave the last CU short, the rows already deleted for it are
+ *     written as a smaller CU, they are never put back into delta table.
+ *     Delta pages are charged to the vacuum cost balance by the buffer
+ *     manager, and CU writes are charged here, so the merge is throttled
+ *     like any other vacuum.
+ * @IN onerel: column table or one partition of it
+ * @IN deltaRel: delta table of onerel, locked in RowExclusiveLock
+ * @IN vacstmt: vacuum statement
+ */
+static void lazy_merge_cstore_delta(Relation onerel, Relation deltaRel, VacuumStmt* vacstmt)
+{
+    HeapScanDesc deltaScanDesc = NULL;
+    HeapTuple deltaTup = NULL;
+    int maxBatchRows = RelationGetMaxBatchRows(onerel);
+    bool wait = !IsAutoVacuumWorkerProcess();
+    bool fullCU = (vacstmt->options & VACOPT_DELTA_FULLCU) != 0;
+    uint64 rowsMoved = 0;
+    uint64 rowsSkipped = 0;
+    int mergeLevel = (vacstmt->options & VACOPT_VERBOSE) ? VERBOSEMESSAGE : DEBUG2;
+
+    /*
+     * Rows of the CU being filled in full CU mode, the first nDeleted of them
+     * are deleted from delta table and appended to batchRow already, the
+     * others are candidates not touched yet.
+     */
+    HeapTuple* cuTups = NULL;
+    int nCuTups = 0;
+    int nDeleted = 0;
+
+    /* initialize the delta insert */
+    deltaScanDesc = heap_beginscan(deltaRel, GetActiveSnapshot(), 0, NULL);
+
+    InsertArg args;
+    ResultRelInfo *resultRelInfo = NULL;
+    if (onerel->rd_rel->relhasindex) {
+        resultRelInfo = makeNode(ResultRelInfo);
+        if (vacstmt->onepartrel != NULL) {
+            InitResultRelInfo(resultRelInfo, vacstmt->onepartrel, 1, 0);
+        } else {
+            InitResultRelInfo(resultRelInfo, onerel, 1, 0);
+        }
+
+        ExecOpenIndices(resultRelInfo, false);
+    }
+    CStoreInsert::InitInsertArg(onerel, resultRelInfo, true, args);
+    CStoreInsert cstoreInsert(onerel, args, false, NULL, NULL);
+    TupleDesc tupDesc = onerel->rd_att;
+    Datum* val = (Datum*)palloc(sizeof(Datum) * tupDesc->natts);
+    bool* null = (bool*)palloc(sizeof(bool) * tupDesc->natts);
+    bulkload_rows batchRow(tupDesc, maxBatchRows, true);
+    if (fullCU) {
+        cuTups = (HeapTuple*)palloc(sizeof(HeapTuple) * maxBatchRows);
+    }
+
+    while ((deltaTup = heap_getnext(deltaScanDesc, ForwardScanDirection)) != NULL) {
+        vacuum_delay_point();
+
+        if (!fullCU) {
+            if (!lazy_delete_delta_tuple(deltaRel, deltaTup, wait)) {
+                rowsSkipped++;
+                continue;
+            }
+
+            heap_deform_tuple(deltaTup, tupDesc, val, null);
+            /* ignore returned value because only one tuple is appended into */
+            (void)batchRow.append_one_tuple(val, null, tupDesc);
+            rowsMoved++;
+        } else {
+            cuTups[nCuTups++] = heap_copytuple(deltaTup);
+            if (nCuTups < maxBatchRows) {
+                continue;
+            }
+
+            /* enough rows for the CU, the ones given up are replaced by the next rows */
+            for (int i = nDeleted; i < nCuTups; i++) {
+                if (!lazy_delete_delta_tuple(deltaRel, cuTups[i], wait)) {
+                    heap_freetuple(cuTups[i]);
+                    rowsSkipped++;
+                    continue;
+                }
+
+                heap_deform_tuple(cuTups[i], tupDesc, val, null);
+                (void)batchRow.append_one_tuple(val, null, tupDesc);
+                cuTups[nDeleted++] = cuTups[i];
+                rowsMoved++;
+            }
+            nCuTups = nDeleted;
+        }
+
+        if (batchRow.full_rownum()) {
+            if (t_thrd.vacuum_cxt.VacuumCostActive) {
+                t_thrd.vacuum_cxt.VacuumCostBalance +=
+                    u_sess->attr.attr_storage.VacuumCostPageDirty * (int)(batchRow.total_memory_size() / BLCKSZ);
+            }
+
+            /*  insert into main table */
+            cstoreInsert.BatchInsert(&batchRow, 0);
+            batchRow.reset(true);
+
+            for (int i = 0; i < nCuTups; i++) {
+                heap_freetuple(cuTups[i]);
+            }
+            nCuTups = 0;
+            nDeleted = 0;
+        }
+    }
+
+    if (fullCU) {
+        /*
+         * The candidates of a CU which can not be filled stay in delta table. The
+         * rows already deleted for it are in batchRow and make the last CU below.
+         */
+        for (int i = 0; i < nCuTups; i++) {
+            heap_freetuple(cuTups[i]);
+        }
+        pfree(cuTups);
+    }
+    cstoreInsert.SetEndFlag();
+    cstoreInsert.BatchInsert(&batchRow, 0);
+    heap_endscan(deltaScanDesc);
+
+    ereport(mergeLevel,
+        (errmsg("\"%s\": moved %lu rows from delta table, %lu rows in use by other transactions are left",
+            RelationGetRelationName(onerel),
+            rowsMoved,
+            rowsSkipped)));
+
+    /* clean cstore insert */
+    pfree(val);
+    pfree(null);
+    CStoreInsert::DeInitInsertArg(args);
+    batchRow.Destroy();
+    cstoreInsert.Destroy();
+    if (resultRelInfo != NULL) {
+        ExecCloseIndices(resultRelInfo);
+        pfree(resultRelInfo);
+    }
+}
 
 /*
  *	lazy_vacuum_rel() -- perform LAZY VACUUM for one heap relation
@@ -213,58 +383,7 @@ void lazy_vacuum_rel(Relation onerel, VacuumStmt* vacstmt, BufferAccessStrategy
         Relation deltaRel = heap_open(onerel->rd_rel->reldeltarelid, RowExclusiveLock);
 
         if (RelationIsCUFormat(onerel)) {
-            /* initialize the delta insert */
-            HeapScanDesc deltaScanDesc = heap_beginscan(deltaRel, GetActiveSnapshot(), 0, NULL);
-
-            InsertArg args;
-            HeapTuple deltaTup = NULL;
-            ResultRelInfo *resultRelInfo = NULL;
-            if (onerel->rd_rel->relhasindex) {
-                resultRelInfo = makeNode(ResultRelInfo);
-                if (vacstmt->onepartrel != NULL) {
-                    InitResultRelInfo(resultRelInfo, vacstmt->onepartrel, 1, 0);
-                } else {
-                    InitResultRelInfo(resultRelInfo, onerel, 1, 0);
-                }
-
-                ExecOpenIndices(resultRelInfo, false);
-            }
-            CStoreInsert::InitInsertArg(onerel, resultRelInfo, true, args);
-            CStoreInsert cstoreInsert(onerel, args, false, NULL, NULL);
-            TupleDesc tupDesc = onerel->rd_att;
-            Datum* val = (Datum*)palloc(sizeof(Datum) * tupDesc->natts);
-            bool* null = (bool*)palloc(sizeof(bool) * tupDesc->natts);
-            bulkload_rows batchRow(tupDesc, RelationGetMaxBatchRows(onerel), true);
-
-            while ((deltaTup = heap_getnext(deltaScanDesc, ForwardScanDirection)) != NULL) {
-                heap_deform_tuple(deltaTup, tupDesc, val, null);
-
-                /* ignore returned value because only one tuple is appended into */
-                (void)batchRow.append_one_tuple(val, null, tupDesc);
-
-                if (batchRow.full_rownum()) {
-                    /*  insert into main table */
-                    cstoreInsert.BatchInsert(&batchRow, 0);
-                    batchRow.reset(true);
-                }
-
-                /* delete the current tuple from delta table */
-                simple_heap_delete(deltaRel, &deltaTup->t_self);
-            }
-            cstoreInsert.SetEndFlag();
-            cstoreInsert.BatchInsert(&batchRow, 0);
-            heap_endscan(deltaScanDesc);
-
-            /* clean cstore insert */
-            pfree(val);
-            pfree(null);
-            CStoreInsert::DeInitInsertArg(args);
-            batchRow.Destroy();
-            cstoreInsert.Destroy();
-            if (resultRelInfo != NULL) {
-                ExecCloseIndices(resultRelInfo);
-                pfree(resultRelInfo);
-            }
+            lazy_merge_cstore_delta(onerel, deltaRel, vacstmt);
         }
 
         /* clean part info before vacuum delta and desc table */
@@ -811,7 +930,6 @@ static IndexBulkDeleteResult** lazy_scan_heap(
     BlockNumber empty_pages, vacuumed_pages;
     double num_tuples, tups_vacuumed, nkeep, nunused;
     IndexBulkDeleteResult** indstats;
-    int i;
     PGRUsage ru0;
     Buffer vmbuffer = InvalidBuffer;
     BlockNumber next_not_all_visible_block;
@@ -836,7 +954,7 @@ static IndexBulkDeleteResult** lazy_scan_heap(
     vacrelstats->nonempty_pages = 0;
     vacrelstats->latestRemovedXid = InvalidTransactionId;
 
-    lazy_space_alloc(vacrelstats, nblocks);
+    lazy_space_alloc(vacrelstats);
 
     /*
      * We want to skip pages that don't require vacuuming according to the
@@ -954,8 +1072,7 @@ static IndexBulkDeleteResult** lazy_scan_heap(
          * If we are close to overrunning the available space for dead-tuple
          * TIDs, pause and do a cycle of vacuuming before we tackle this page.
          */
-        if ((vacrelstats->max_dead_tuples - vacrelstats->num_dead_tuples) < MaxHeapTuplesPerPage &&
-            vacrelstats->num_dead_tuples > 0) {
+        if (vacrelstats->num_dead_tuples > 0 && lazy_dead_tuples_full(vacrelstats)) {
             /*
              * Before beginning index vacuuming, we release any pin we may
              * hold on the visibility map page.  This isn't necessary for
@@ -971,8 +1088,7 @@ static IndexBulkDeleteResult** lazy_scan_heap(
             vacuum_log_cleanup_info(onerel, vacrelstats);
 
             /* Remove index entries */
-            for (i = 0; i < nindexes; i++)
-                lazy_vacuum_index(Irel[i], &indstats[i], vacrelstats);
+            lazy_vacuum_indexes(onerel, Irel, indstats, nindexes, vacrelstats, false);
             /* Remove tuples from heap */
             lazy_vacuum_heap(onerel, vacrelstats);
 
@@ -981,6 +1097,7 @@ static IndexBulkDeleteResult** lazy_scan_heap(
              * not to reset latestRemovedXid since we want that value to be
              * valid.
              */
+            TidStoreReset(vacrelstats->dead_tuples);
             vacrelstats->num_dead_tuples = 0;
             vacrelstats->num_index_scans++;
         }
@@ -1314,7 +1431,8 @@ static IndexBulkDeleteResult** lazy_scan_heap(
          */
         if (nindexes == 0 && vacrelstats->num_dead_tuples > 0) {
             /* Remove tuples from heap */
-            lazy_vacuum_page(onerel, blkno, buf, 0, vacrelstats);
+            Assert(vacrelstats->page_dead_blkno == blkno);
+            lazy_vacuum_page(onerel, blkno, buf, vacrelstats->page_dead, vacrelstats->num_page_dead, vacrelstats);
             has_dead_tuples = false;
 
             /*
@@ -1322,6 +1440,7 @@ static IndexBulkDeleteResult** lazy_scan_heap(
              * not to reset latestRemovedXid since we want that value to be
              * valid.
              */
+            vacrelstats->num_page_dead = 0;
             vacrelstats->num_dead_tuples = 0;
             vacuumed_pages++;
         }
@@ -1420,24 +1539,24 @@ static IndexBulkDeleteResult** lazy_scan_heap(
     /* If any tuples need to be deleted, perform final vacuum cycle */
     /* XXX put a threshold on min number of tuples here? */
     if (vacrelstats->num_dead_tuples > 0) {
+        (void)lazy_dead_tuples_full(vacrelstats);
+
         /* Log cleanup info before we touch indexes */
         vacuum_log_cleanup_info(onerel, vacrelstats);
 
         /* Remove index entries */
-        for (i = 0; i < nindexes; i++)
-            lazy_vacuum_index(Irel[i], &indstats[i], vacrelstats);
+        lazy_vacuum_indexes(onerel, Irel, indstats, nindexes, vacrelstats, false);
         /* Remove tuples from heap */
         lazy_vacuum_heap(onerel, vacrelstats);
         vacrelstats->num_index_scans++;
     }
 
     /* Do post-vacuum cleanup and statistics update for each index */
-    for (i = 0; i < nindexes; i++) {
-        /* IO collector and IO scheduler for vacuum */
-        if (ENABLE_WORKLOAD_CONTROL)
-            IOSchedulerAndUpdate(IO_TYPE_WRITE, 1, IO_TYPE_ROW);
+    lazy_vacuum_indexes(onerel, Irel, indstats, nindexes, vacrelstats, true);
 
-        indstats[i] = lazy_cleanup_index(Irel[i], indstats[i], vacrelstats);
+    if (vacrelstats->dead_tuples != NULL) {
+        TidStoreDestroy(vacrelstats->dead_tuples);
+        vacrelstats->dead_tuples = NULL;
     }
 
     /* record vacuumed tuple for reporting to PgStatCollector */
@@ -1483,32 +1602,35 @@ static IndexBulkDeleteResult** lazy_scan_heap(
  */
 static void lazy_vacuum_heap(Relation onerel, LVRelStats* vacrelstats)
 {
-    int tupindex;
+    TidStoreIter* iter = NULL;
+    TidStoreIterResult* result = NULL;
+    int ntuples;
     int npages;
     PGRUsage ru0;
 
     gstrace_entry(GS_TRC_ID_lazy_vacuum_heap);
 
+    Assert(vacrelstats->dead_tuples != NULL);
     pg_rusage_init(&ru0);
+    ntuples = 0;
     npages = 0;
 
-    tupindex = 0;
-    while (tupindex < vacrelstats->num_dead_tuples) {
-        BlockNumber tblk;
+    iter = TidStoreBeginIterate(vacrelstats->dead_tuples);
+    while ((result = TidStoreIterateNext(iter)) != NULL) {
+        BlockNumber tblk = result->blkno;
         Buffer buf;
         Page page;
         Size freespace;
 
         vacuum_delay_point();
 
-        tblk = ItemPointerGetBlockNumber(&vacrelstats->dead_tuples[tupindex]);
         buf = ReadBufferExtended(onerel, MAIN_FORKNUM, tblk, RBM_NORMAL, vac_strategy);
         if (!ConditionalLockBufferForCleanup(buf)) {
             ReleaseBuffer(buf);
-            ++tupindex;
             continue;
         }
-        tupindex = lazy_vacuum_page(onerel, tblk, buf, tupindex, vacrelstats);
+        lazy_vacuum_page(onerel, tblk, buf, result->offsets, result->num_offsets, vacrelstats);
+        ntuples += result->num_offsets;
 
         /* Now that we've compacted the page, record its available space */
         page = BufferGetPage(buf);
@@ -1518,9 +1640,10 @@ static void lazy_vacuum_heap(Relation onerel, LVRelStats* vacrelstats)
         RecordPageWithFreeSpace(onerel, tblk, freespace);
         npages++;
     }
+    TidStoreEndIterate(iter);
 
     ereport(elevel,
-        (errmsg("\"%s\": removed %d row versions in %d pages", RelationGetRelationName(onerel), tupindex, npages),
+        (errmsg("\"%s\": removed %d row versions in %d pages", RelationGetRelationName(onerel), ntuples, npages),
             errdetail("%s.", pg_rusage_show(&ru0))));
     gstrace_exit(GS_TRC_ID_lazy_vacuum_heap);
 }
@@ -1531,11 +1654,10 @@ static void lazy_vacuum_heap(Relation onerel, LVRelStats* vacrelstats)
  *
  * Caller must hold pin and buffer cleanup lock on the buffer.
  *
- * tupindex is the index in vacrelstats->dead_tuples of the first dead
- * tuple for this page.  We assume the rest follow sequentially.
- * The return value is the first tupindex after the tuples of this page.
+ * offsets[] holds the offsets of the noffsets dead tuples of this page.
  */
-static int lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer, int tupindex, LVRelStats* vacrelstats)
+static void lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer, const OffsetNumber* offsets,
+    int noffsets, LVRelStats* vacrelstats)
 {
     Page page = BufferGetPage(buffer);
     OffsetNumber unused[MaxOffsetNumber];
@@ -1543,16 +1665,10 @@ static int lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer, i
 
     START_CRIT_SECTION();
 
-    for (; tupindex < vacrelstats->num_dead_tuples; tupindex++) {
-        BlockNumber tblk;
-        OffsetNumber toff;
-        ItemId itemid;
+    for (int i = 0; i < noffsets; i++) {
+        OffsetNumber toff = offsets[i];
+        ItemId itemid = PageGetItemId(page, toff);
 
-        tblk = ItemPointerGetBlockNumber(&vacrelstats->dead_tuples[tupindex]);
-        if (tblk != blkno)
-            break; /* past end of tuples for this block */
-        toff = ItemPointerGetOffsetNumber(&vacrelstats->dead_tuples[tupindex]);
-        itemid = PageGetItemId(page, toff);
         ItemIdSetUnused(itemid);
         unused[uncnt++] = toff;
     }
@@ -1570,8 +1686,6 @@ static int lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer, i
     }
 
     END_CRIT_SECTION();
-
-    return tupindex;
 }
 
 /*
@@ -1678,93 +1792,342 @@ static IndexBulkDeleteResult* lazy_cleanup_index(Relation indrel, IndexBulkDelet
     return stats;
 }
 
+/*
+ * Shared state of a parallel index vacuum pass. Each index is a task, the
+ * leader and the workers take the tasks in order until none is left.
+ */
+typedef struct LVParallelShared {
+    /* immutable state */
+    LVRelStats* vacrelstats;
+    IndexBulkDeleteResult** indstats;
+    IndexBulkDeleteResult** slots; /* result space of the indexes whose indstats is NULL */
+    Oid* indexoids;
+    int* tasks; /* indexes left to the workers, the largest first */
+    int ntasks;
+    bool cleanup;
+    int elevel;
+    bool costActive;
+    int costDelay;
+    int costLimit;
+
+    /* mutex protects the following task counter */
+    slock_t mutex;
+    int nextTask;
+} LVParallelShared;
+
+typedef struct LVIndexTask {
+    int index;
+    BlockNumber nblocks;
+} LVIndexTask;
+
+static int lazy_cmp_index_task(const void* left, const void* right)
+{
+    BlockNumber lblocks = ((const LVIndexTask*)left)->nblocks;
+    BlockNumber rblocks = ((const LVIndexTask*)right)->nblocks;
+
+    if (lblocks > rblocks)
+        return -1;
+    if (lblocks < rblocks)
+        return 1;
+    return 0;
+}
+
+/*
+ * lazy_vacuum_one_index - bulk delete or clean up one index, reporting the index
+ * being vacuumed in pg_thread_wait_status
+ */
+static void lazy_vacuum_one_index(
+    Relation indrel, IndexBulkDeleteResult** stats, LVRelStats* vacrelstats, bool cleanup)
+{
+    (void)pgstat_report_waitstatus_relname(STATE_VACUUM, get_nsp_relname(RelationGetRelid(indrel)));
+
+    if (cleanup) {
+        /* IO collector and IO scheduler for vacuum */
+        if (ENABLE_WORKLOAD_CONTROL)
+            IOSchedulerAndUpdate(IO_TYPE_WRITE, 1, IO_TYPE_ROW);
+
+        *stats = lazy_cleanup_index(indrel, *stats, vacrelstats);
+    } else {
+        lazy_vacuum_index(indrel, stats, vacrelstats);
+    }
+}
+
+/*
+ * lazy_parallel_vacuum_run_tasks - vacuum the indexes of the shared task list
+ *		until it is empty. It's run by both the leader and the parallel workers.
+ */
+static void lazy_parallel_vacuum_run_tasks(LVParallelShared* shared)
+{
+    for (;;) {
+        SpinLockAcquire(&shared->mutex);
+        int taskIdx = shared->nextTask;
+        if (taskIdx < shared->ntasks) {
+            shared->nextTask++;
+        }
+        SpinLockRelease(&shared->mutex);
+        if (taskIdx >= shared->ntasks) {
+            break;
+        }
+
+        int idx = shared->tasks[taskIdx];
+        IndexBulkDeleteResult* stats = shared->indstats[idx];
+        Relation indrel = index_open(shared->indexoids[idx], RowExclusiveLock);
+
+        /*
+         * The index AM pallocs the result in our memory context when it's
+         * given none, copy it to the space of the leader.
+         */
+        lazy_vacuum_one_index(indrel, &stats, shared->vacrelstats, shared->cleanup);
+        if (stats == NULL) {
+            shared->indstats[idx] = NULL;
+        } else if (stats != shared->indstats[idx]) {
+            *shared->slots[idx] = *stats;
+            shared->indstats[idx] = shared->slots[idx];
+        }
+
+        index_close(indrel, RowExclusiveLock);
+    }
+}
+
+/*
+ * lazy_vacuum_indexes() -- bulk delete or clean up all the indexes of the relation.
+ *
+ *		One index is vacuumed by one participant, so the indexes are vacuumed
+ *		by max_parallel_maintenance_workers workers besides the leader when
+ *		there are several of them. The leader vacuums the indexes the workers
+ *		can't open by OID and those smaller than min_parallel_index_scan_size.
+ */
+static void lazy_vacuum_indexes(Relation onerel, Relation* Irel, IndexBulkDeleteResult** indstats, int nindexes,
+    LVRelStats* vacrelstats, bool cleanup)
+{
+    LVIndexTask* tasks = NULL;
+    int ntasks = 0;
+    int nworkers = 0;
+    char* heapRelname = NULL;
+
+    if (nindexes == 0)
+        return;
+
+    if (!IS_PGSTATE_TRACK_UNDEFINE)
+        heapRelname = pstrdup((char*)t_thrd.shemem_ptr_cxt.MyBEEntry->st_relname);
+
+    if (nindexes > 1 && u_sess->attr.attr_sql.max_parallel_maintenance_workers > 0 && !IsInParallelMode() &&
+        ActiveSnapshotSet() && !IsAutoVacuumWorkerProcess() && !RelationUsesLocalBuffers(onerel) &&
+        !RELATION_IS_GLOBAL_TEMP(onerel)) {
+        tasks = (LVIndexTask*)palloc(sizeof(LVIndexTask) * nindexes);
+        for (int i = 0; i < nindexes; i++) {
+            BlockNumber nblocks;
+
+            if (RelationIsPartition(Irel[i]) || RelationIsBucket(Irel[i]))
+                continue;
+            nblocks = RelationGetNumberOfBlocks(Irel[i]);
+            if (nblocks < (BlockNumber)u_sess->attr.attr_sql.min_parallel_index_scan_size)
+                continue;
+
+            tasks[ntasks].index = i;
+            tasks[ntasks].nblocks = nblocks;
+            ntasks++;
+        }
+        /* the leader takes one index itself */
+        nworkers = Min(u_sess->attr.attr_sql.max_parallel_maintenance_workers, ntasks - 1);
+    }
+
+    ParallelContext* pcxt = NULL;
+    LVParallelShared* shared = NULL;
+
+    if (nworkers > 0) {
+        EnterParallelMode();
+        pcxt = CreateParallelContext("postgres", "lazy_parallel_vacuum_main", nworkers);
+        InitializeParallelDSM(pcxt, GetActiveSnapshot());
+
+        /* If no worker was available, vacuum all the indexes by ourselves */
+        if (pcxt->nworkers == 0) {
+            DestroyParallelContext(pcxt);
+            ExitParallelMode();
+            pcxt = NULL;
+        } else {
+            knl_u_parallel_context* cxt = (knl_u_parallel_context*)pcxt->seg;
+            MemoryContext oldCnxt = MemoryContextSwitchTo(cxt->memCtx);
+            shared = (LVParallelShared*)palloc0(sizeof(LVParallelShared));
+            (void)MemoryContextSwitchTo(oldCnxt);
+            cxt->pwCtx->vacuumInfo.shared = shared;
+        }
+    }
+
+    if (shared == NULL) {
+        /* vacuum the indexes one by one */
+        for (int i = 0; i < nindexes; i++)
+            lazy_vacuum_one_index(Irel[i], &indstats[i], vacrelstats, cleanup);
+    } else {
+        bool* inQueue = (bool*)palloc0(sizeof(bool) * nindexes);
+
+        qsort(tasks, ntasks, sizeof(LVIndexTask), lazy_cmp_index_task);
+
+        shared->vacrelstats = vacrelstats;
+        shared->indstats = indstats;
+        shared->slots = (IndexBulkDeleteResult**)palloc0(sizeof(IndexBulkDeleteResult*) * nindexes);
+        shared->indexoids = (Oid*)palloc(sizeof(Oid) * nindexes);
+        shared->tasks = (int*)palloc(sizeof(int) * ntasks);
+        for (int i = 0; i < nindexes; i++) {
+            shared->indexoids[i] = RelationGetRelid(Irel[i]);
+            if (indstats[i] == NULL)
+                shared->slots[i] = (IndexBulkDeleteResult*)palloc0(sizeof(IndexBulkDeleteResult));
+        }
+        for (int i = 0; i < ntasks; i++) {
+            shared->tasks[i] = tasks[i].index;
+            inQueue[tasks[i].index] = true;
+        }
+        shared->ntasks = ntasks;
+        shared->cleanup = cleanup;
+        shared->elevel = elevel;
+        shared->costActive = t_thrd.vacuum_cxt.VacuumCostActive;
+        shared->costDelay = u_sess->attr.attr_storage.VacuumCostDelay;
+        shared->costLimit = u_sess->attr.attr_storage.VacuumCostLimit;
+        SpinLockInit(&shared->mutex);
+        shared->nextTask = 0;
+
+        LaunchParallelWorkers(pcxt);
+
+        /* Vacuum the indexes left to the leader, then join the workers */
+        for (int i = 0; i < nindexes; i++) {
+            if (!inQueue[i])
+                lazy_vacuum_one_index(Irel[i], &indstats[i], vacrelstats, cleanup);
+        }
+        lazy_parallel_vacuum_run_tasks(shared);
+
+        WaitForParallelWorkersToFinish(pcxt);
+
+        for (int i = 0; i < nindexes; i++) {
+            if (shared->slots[i] != NULL && indstats[i] != shared->slots[i])
+                pfree(shared->slots[i]);
+        }
+        pfree(shared->slots);
+        pfree(shared->indexoids);
+        pfree(shared->tasks);
+        pfree(inQueue);
+
+        /* shared lives in the memory of the parallel context */
+        DestroyParallelContext(pcxt);
+        ExitParallelMode();
+    }
+
+    if (tasks != NULL)
+        pfree(tasks);
+
+    /* report the heap being vacuumed again */
+    if (heapRelname != NULL)
+        (void)pgstat_report_waitstatus_relname(STATE_VACUUM, heapRelname);
+}
+
+/*
+ * Perform work within a launched parallel index vacuum worker.
+ */
+void lazy_parallel_vacuum_main(void* seg)
+{
+    knl_u_parallel_context* cxt = (knl_u_parallel_context*)seg;
+    LVParallelShared* shared = cxt->pwCtx->vacuumInfo.shared;
+
+    /* vacuum like the leader, each participant sleeps for its own cost */
+    elevel = shared->elevel;
+    vac_strategy = GetAccessStrategy(BAS_VACUUM);
+    t_thrd.vacuum_cxt.VacuumCostActive = shared->costActive;
+    t_thrd.vacuum_cxt.VacuumCostBalance = 0;
+    u_sess->attr.attr_storage.VacuumCostDelay = shared->costDelay;
+    u_sess->attr.attr_storage.VacuumCostLimit = shared->costLimit;
+
+    lazy_parallel_vacuum_run_tasks(shared);
+
+    FreeAccessStrategy(vac_strategy);
+    vac_strategy = NULL;
+}
+
 /*
  * lazy_space_alloc - space allocation decisions for lazy vacuum
  *
  * See the comments at the head of this file for rationale.
  */
-static void lazy_space_alloc(LVRelStats* vacrelstats, BlockNumber relblocks)
+static void lazy_space_alloc(LVRelStats* vacrelstats)
 {
-    unsigned long maxtuples;
-
-    if (vacrelstats->hasindex) {
-        maxtuples = (u_sess->attr.attr_memory.maintenance_work_mem * 1024L) / sizeof(ItemPointerData);
-        maxtuples = Min(maxtuples, INT_MAX);
-        maxtuples = Min(maxtuples, (int)(MaxAllocSize / sizeof(ItemPointerData)));
-        /* curious coding here to ensure the multiplication can't overflow */
-        if ((BlockNumber)(maxtuples / LAZY_ALLOC_TUPLES) > relblocks)
-            maxtuples = relblocks * LAZY_ALLOC_TUPLES;
-        /* stay sane if small maintenance_work_mem */
-        maxtuples = Max(maxtuples, MaxHeapTuplesPerPage);
-    } else {
-        maxtuples = MaxHeapTuplesPerPage;
+    if (vacrelstats->dead_tuples != NULL) {
+        TidStoreDestroy(vacrelstats->dead_tuples);
+        vacrelstats->dead_tuples = NULL;
     }
 
+    /* without indexes each page is vacuumed right away, from page_dead[] */
+    if (vacrelstats->hasindex)
+        vacrelstats->dead_tuples = TidStoreCreate((Size)u_sess->attr.attr_memory.maintenance_work_mem * 1024L);
+
     vacrelstats->num_dead_tuples = 0;
-    vacrelstats->max_dead_tuples = (int)maxtuples;
-    vacrelstats->dead_tuples = (ItemPointer)palloc(maxtuples * sizeof(ItemPointerData));
+    vacrelstats->page_dead_blkno = InvalidBlockNumber;
+    vacrelstats->num_page_dead = 0;
+}
+
+/*
+ * lazy_flush_page_dead_tuples - move the dead tuples of the last page into the TID store
+ */
+static void lazy_flush_page_dead_tuples(LVRelStats* vacrelstats)
+{
+    if (vacrelstats->num_page_dead == 0)
+        return;
+
+    if (vacrelstats->dead_tuples != NULL) {
+        TidStoreSetBlockOffsets(
+            vacrelstats->dead_tuples, vacrelstats->page_dead_blkno, vacrelstats->page_dead, vacrelstats->num_page_dead);
+    }
+    vacrelstats->num_page_dead = 0;
 }
 
 /*
  * lazy_record_dead_tuple - remember one deletable tuple
+ *
+ * lazy_scan_heap visits the tuples of a page in offset order and never comes
+ * back to a page, so the tuples are collected per page and handed to the TID
+ * store as a whole when the next page starts.
  */
 static void lazy_record_dead_tuple(LVRelStats* vacrelstats, ItemPointer itemptr)
 {
-    /*
-     * The array shouldn't overflow under normal behavior, but perhaps it
-     * could if we are given a really small maintenance_work_mem. In that
-     * case, just forget the last few tuples (we'll get 'em next time).
-     */
-    if (vacrelstats->num_dead_tuples < vacrelstats->max_dead_tuples) {
-        vacrelstats->dead_tuples[vacrelstats->num_dead_tuples] = *itemptr;
-        vacrelstats->num_dead_tuples++;
+    BlockNumber blkno = ItemPointerGetBlockNumber(itemptr);
+
+    if (blkno != vacrelstats->page_dead_blkno) {
+        lazy_flush_page_dead_tuples(vacrelstats);
+        vacrelstats->page_dead_blkno = blkno;
     }
+
+    Assert(vacrelstats->num_page_dead < MaxOffsetNumber);
+    vacrelstats->page_dead[vacrelstats->num_page_dead++] = ItemPointerGetOffsetNumber(itemptr);
+    vacrelstats->num_dead_tuples++;
+}
+
+/*
+ * lazy_dead_tuples_full - is it time to vacuum the indexes and the heap?
+ *
+ * Also flushes the dead tuples of the last page, so that the TID store is
+ * complete when this returns true.
+ */
+static bool lazy_dead_tuples_full(LVRelStats* vacrelstats)
+{
+    lazy_flush_page_dead_tuples(vacrelstats);
+
+    return vacrelstats->dead_tuples != NULL && TidStoreIsFull(vacrelstats->dead_tuples);
 }
 
 /*
  * lazy_tid_reaped() -- is a particular tid deletable?
  *      This has the right signature to be an IndexBulkDeleteCallback.
- *      Assumes dead_tuples array is in sorted order.
+ *      It's called by the parallel index vacuum workers too, the TID store
+ *      isn't changed while the indexes are vacuumed.
  *      inputparam partOid is valid only when index is global partition index
  */
 static bool lazy_tid_reaped(ItemPointer itemptr, void* state, Oid partOid)
 {
     LVRelStats* vacrelstats = (LVRelStats*)state;
-    ItemPointer res;
 
     // global partition index tuple need to check the tuple's partOid is same to current partition
     if (partOid != InvalidOid && vacrelstats->currVacuumPartOid != partOid) {
         return false;
     }
-    res = (ItemPointer)bsearch((void*)itemptr,
-        (void*)vacrelstats->dead_tuples,
-        vacrelstats->num_dead_tuples,
-        sizeof(ItemPointerData),
-        vac_cmp_itemptr);
-
-    return (res != NULL);
-}
 
-/*
- * Comparator routines for use with qsort() and bsearch().
- */
-static int vac_cmp_itemptr(const void* left, const void* right)
-{
-    BlockNumber lblk, rblk;
-    OffsetNumber loff, roff;
-    lblk = ItemPointerGetBlockNumber((ItemPointer)left);
-    rblk = ItemPointerGetBlockNumber((ItemPointer)right);
-    if (lblk < rblk)
-        return -1;
-    if (lblk > rblk)
-        return 1;
-    loff = ItemPointerGetOffsetNumber((ItemPointer)left);
-    roff = ItemPointerGetOffsetNumber((ItemPointer)right);
-    if (loff < roff)
-        return -1;
-    if (loff > roff)
-        return 1;
-    return 0;
+    return TidStoreIsMember(vacrelstats->dead_tuples, itemptr);
 }
 
 void elogVacuumInfo(Relation rel, HeapTuple tuple, char* funcName, TransactionId oldestxmin)
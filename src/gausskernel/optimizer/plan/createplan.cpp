@@ -1940,7 +1940,7 @@ static List* fix_cstore_scan_qual(PlannerInfo* root, List* qpqual)
     foreach (lc, qpqual) {
         Expr* clause = (Expr*)copyObject(lfirst(lc));
 
-        if (!filter_cstore_clause(root, clause))
+        if (!filter_cstore_clause(root, clause) && !filter_cstore_inlist_clause(clause))
             continue;
 
         fixed_quals = lappend(fixed_quals, clause);
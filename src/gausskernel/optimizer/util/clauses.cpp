@@ -5222,6 +5222,34 @@ bool filter_cstore_clause(PlannerInfo* root, Expr* clause)
     return plain_op;
 }
 
+/*
+ * Support "var = ANY (const array)" pushing down to cstore scan, i.e. IN list,
+ * which is used by rough check of CU min/max and bloom filter.
+ */
+bool filter_cstore_inlist_clause(Expr* clause)
+{
+    if (!IsA(clause, ScalarArrayOpExpr))
+        return false;
+
+    ScalarArrayOpExpr* saop = (ScalarArrayOpExpr*)clause;
+    if (!saop->useOr || list_length(saop->args) != 2)
+        return false;
+
+    Node* leftop = (Node*)linitial(saop->args);
+    Node* rightop = (Node*)lsecond(saop->args);
+    if (!is_var_node(leftop) || !IsA(rightop, Const) || ((Const*)rightop)->constisnull)
+        return false;
+
+    char* oprname = get_opname(saop->opno);
+    bool is_equal = (oprname != NULL && strncmp(oprname, "=", NAMEDATALEN) == 0);
+    pfree_ext(oprname);
+    if (!is_equal)
+        return false;
+
+    set_sa_opfuncid(saop);
+    return true;
+}
+
 bool is_var_node(Node* node)
 {
     bool is_var = false;
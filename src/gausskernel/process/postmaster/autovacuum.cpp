@@ -74,6 +74,7 @@
 #endif
 
 #include "access/hash.h"
+#include "access/gin_private.h"
 #include "access/gtm.h"
 #include "access/heapam.h"
 #include "access/reloptions.h"
@@ -127,6 +128,9 @@
 /* the minimum allowed time between two awakenings of the launcher */
 #define MIN_AUTOVAC_SLEEPTIME 100.0 /* milliseconds */
 
+/* the size of the activity string reported to pgstat */
+#define MAX_AUTOVAC_ACTIV_LEN (NAMEDATALEN * 2 + 56)
+
 /* struct to keep tuples stat that fetchs from DataNode */
 typedef struct avw_info {
     PgStat_StatTabKey tabkey;
@@ -192,6 +196,7 @@ typedef struct autovac_table {
     char* at_nspname;
     char* at_datname;
     bool at_is_toast;
+    bool at_delta_fullcu; /* delta merge only moves the rows filling whole CUs */
 } autovac_table;
 
 /* partitioned table's autovac state */
@@ -201,6 +206,7 @@ typedef struct at_partitioned_table {
     bool at_dovacuum;    /* partitioned table will do vacuum */
     bool at_doanalyze;   /* partitioned table will do analyze */
     bool at_needfreeze;  /* partitioned table need freeze old tuple to recycle clog */
+    bool at_iscstore;    /* partitioned table is a column table, each partition has a delta table */
 } at_partitioned_table;
 
 /* -------------
@@ -249,6 +255,29 @@ typedef enum {
     AutoVacNumSignals  /* must be last */
 } AutoVacuumSignal;
 
+/*
+ * Autovacuum workitem array, stored in AutoVacuumShmem->av_workItems.  This
+ * list is mostly protected by AutovacuumLock, except that if an item is
+ * marked 'active' other processes must not modify the work-identifying
+ * members.
+ */
+typedef struct AutoVacuumWorkItem {
+    AutoVacuumWorkItemType avw_type;
+    bool avw_used;   /* below data is valid */
+    bool avw_active; /* being processed */
+    Oid avw_database;
+    Oid avw_relation;
+    BlockNumber avw_blockNumber;
+} AutoVacuumWorkItem;
+
+#define NUM_WORKITEMS 256
+
+/*
+ * Requests to prune single heap pages can come in large numbers, so they may
+ * take only part of the array, leaving room for GIN pending list cleanups.
+ */
+#define MAX_HOT_PRUNE_WORKITEMS (NUM_WORKITEMS / 2)
+
 /* -------------
  * The main autovacuum shmem struct.  On shared memory we store this main
  * struct and the array of WorkerInfo structs.	This struct keeps:
@@ -259,6 +288,7 @@ typedef enum {
  * av_runningWorkers the WorkerInfo non-free queue
  * av_startingWorker pointer to WorkerInfo currently being started (cleared by
  *					the worker itself as soon as it's up and running)
+ * av_workItems		work item array
  *
  * This struct is protected by AutovacuumLock, except for av_signal and parts
  * of the worker list (see above).
@@ -270,6 +300,7 @@ typedef struct AutoVacuumShmemStruct {
     WorkerInfo av_freeWorkers;
     SHM_QUEUE av_runningWorkers;
     WorkerInfo av_startingWorker;
+    AutoVacuumWorkItem av_workItems[NUM_WORKITEMS];
 } AutoVacuumShmemStruct;
 
 NON_EXEC_STATIC void AutoVacWorkerMain();
@@ -284,6 +315,7 @@ static int db_comparator(const void* a, const void* b);
 static void autovac_balance_cost(void);
 
 static void do_autovacuum(void);
+static void perform_work_item(AutoVacuumWorkItem* workitem);
 static void FreeWorkerInfo(int code, Datum arg);
 
 /* add parameter toast_table_map by data partition. */
@@ -310,6 +342,8 @@ static void partition_needs_vacanalyze(Oid partid, AutoVacOpts* relopts, Form_pg
     bool* doanalyze, bool* need_freeze);
 static autovac_table* partition_recheck_autovac(
     vacuum_object* vacObj, HTAB* table_relopt_map, HTAB* partitioned_tables_map, TupleDesc pg_class_desc);
+static bool cstore_delta_needs_merge(Oid deltaid, Oid relid, Oid parentid, const AutoVacOpts* relopts,
+    PgStat_StatDBEntry* shared, PgStat_StatDBEntry* dbentry, bool* fullcu_only);
 extern void DoVacuumMppTable(VacuumStmt* stmt, const char* queryString, bool isTopLevel, bool sentToRemote);
 /*
  * Called when the AutoVacuum is ending.
@@ -2202,6 +2236,14 @@ static void do_autovacuum(void)
             doanalyze = false;
         }
 
+        /* column table: merge the delta table into CUs once it is large or old enough */
+        if (!dovacuum && local_autovacuum && !isPartitionedRelation(classForm) &&
+            OidIsValid(classForm->reldeltarelid) && rel_is_CU_format(tuple, pg_class_desc)) {
+            bool fullcu_only = false;
+            dovacuum = cstore_delta_needs_merge(
+                classForm->reldeltarelid, relid, InvalidOid, relopts, shared, dbentry, &fullcu_only);
+        }
+
         /* relations that need work are added to table_oids */
         if (dovacuum || doanalyze) {
             vacObj = (vacuum_object*)palloc(sizeof(vacuum_object));
@@ -2232,6 +2274,7 @@ static void do_autovacuum(void)
                 ap_entry->at_doanalyze = doanalyze;
                 ap_entry->at_dovacuum = dovacuum;
                 ap_entry->at_needfreeze = need_freeze;
+                ap_entry->at_iscstore = rel_is_CU_format(tuple, pg_class_desc);
             }
         }
 
@@ -2347,6 +2390,13 @@ static void do_autovacuum(void)
             dovacuum = need_freeze;
         }
 
+        /* partition of column table: merge its own delta table */
+        if (!dovacuum && local_autovacuum && ap_entry->at_iscstore && OidIsValid(partForm->reldeltarelid)) {
+            bool fullcu_only = false;
+            dovacuum = cstore_delta_needs_merge(
+                partForm->reldeltarelid, partOid, partForm->parentid, relopts, shared, dbentry, &fullcu_only);
+        }
+
         /* Partition that need work are added to table_oids */
         if (dovacuum) {
             vacObj = (vacuum_object*)palloc(sizeof(vacuum_object));
@@ -2780,6 +2830,34 @@ static void do_autovacuum(void)
         /* reset t_thrd.vacuum_cxt.vac_context in case that invalid t_thrd.vacuum_cxt.vac_context would be used */
         t_thrd.vacuum_cxt.vac_context = NULL;
     }
+    /*
+     * Perform additional work items, as requested by backends.
+     */
+    LWLockAcquire(AutovacuumLock, LW_EXCLUSIVE);
+    for (int itemno = 0; itemno < NUM_WORKITEMS; itemno++) {
+        AutoVacuumWorkItem* workitem = &t_thrd.autovacuum_cxt.AutoVacuumShmem->av_workItems[itemno];
+
+        if (!workitem->avw_used || workitem->avw_active)
+            continue;
+        if (workitem->avw_database != u_sess->proc_cxt.MyDatabaseId)
+            continue;
+
+        /* claim this one, and release lock while performing it */
+        workitem->avw_active = true;
+        LWLockRelease(AutovacuumLock);
+
+        perform_work_item(workitem);
+
+        CHECK_FOR_INTERRUPTS();
+
+        LWLockAcquire(AutovacuumLock, LW_EXCLUSIVE);
+
+        /* and mark it done */
+        workitem->avw_active = false;
+        workitem->avw_used = false;
+    }
+    LWLockRelease(AutovacuumLock);
+
     /*
      * We leak table_toast_map here (among other things), but since we're
      * going away soon, it's not a problem.
@@ -2797,6 +2875,101 @@ static void do_autovacuum(void)
     CommitTransactionCommand();
 }
 
+/*
+ * Execute a previously registered work item.
+ */
+static void perform_work_item(AutoVacuumWorkItem* workitem)
+{
+    char* cur_datname = NULL;
+    char* cur_nspname = NULL;
+    char* cur_relname = NULL;
+
+    /*
+     * Note we do not store table info in MyWorkerInfo, since this is not
+     * vacuuming proper.
+     */
+
+    /*
+     * Save the relation name for a possible error message, to avoid a catalog
+     * lookup in case of an error.  If any of these return NULL, then the
+     * relation has been dropped since last we checked; skip it.
+     */
+    MemoryContextResetAndDeleteChildren(t_thrd.mem_cxt.portal_mem_cxt);
+    (void)MemoryContextSwitchTo(t_thrd.mem_cxt.portal_mem_cxt);
+
+    cur_relname = get_rel_name(workitem->avw_relation);
+    cur_nspname = get_namespace_name(get_rel_namespace(workitem->avw_relation));
+    cur_datname = get_database_name(u_sess->proc_cxt.MyDatabaseId);
+    if (cur_relname == NULL || cur_nspname == NULL || cur_datname == NULL)
+        return;
+
+    PG_TRY();
+    {
+        char activity[MAX_AUTOVAC_ACTIV_LEN];
+        int rc = 0;
+
+        /* Let pgstat know what we're doing */
+        rc = snprintf_s(activity, MAX_AUTOVAC_ACTIV_LEN, MAX_AUTOVAC_ACTIV_LEN - 1, "autovacuum: %s %s.%s",
+            workitem->avw_type == AVW_GINCleanPendingList ? "GIN pending list cleanup" : "HOT chain pruning",
+            cur_nspname, cur_relname);
+        securec_check_ss(rc, "\0", "\0");
+        SetCurrentStatementStartTimestamp();
+        pgstat_report_activity(STATE_RUNNING, activity);
+
+        /* Use a fresh transaction for each work item */
+        if (ActiveSnapshotSet())
+            PopActiveSnapshot();
+        CommitTransactionCommand();
+
+        StartTransactionCommand();
+        PushActiveSnapshot(GetTransactionSnapshot());
+
+        (void)MemoryContextSwitchTo(t_thrd.mem_cxt.portal_mem_cxt);
+
+        switch (workitem->avw_type) {
+            case AVW_GINCleanPendingList:
+                ginAutovacuumInsertCleanup(workitem->avw_relation);
+                break;
+            case AVW_HeapPruneHotChains:
+                heap_page_prune_requested(workitem->avw_relation, workitem->avw_blockNumber);
+                break;
+            default:
+                ereport(WARNING, (errmsg("unrecognized work item found: type %d", (int)workitem->avw_type)));
+                break;
+        }
+
+        /*
+         * Clear a possible query-cancel signal, to avoid a late reaction to
+         * an automatically-sent signal because of vacuuming the current table
+         * (we're done with it, so it would make no sense to cancel at this
+         * point.)
+         */
+        t_thrd.int_cxt.QueryCancelPending = false;
+    }
+    PG_CATCH();
+    {
+        /*
+         * Abort the transaction, start a new one, and proceed with the next
+         * work item.
+         */
+        HOLD_INTERRUPTS();
+        errcontext("processing work entry for relation \"%s.%s.%s\"", cur_datname, cur_nspname, cur_relname);
+        EmitErrorReport();
+
+        /* this resets the PGXACT flags too */
+        AbortCurrentTransaction();
+        FlushErrorState();
+        MemoryContextResetAndDeleteChildren(t_thrd.mem_cxt.msg_mem_cxt);
+
+        /* restart our transaction for the following operations */
+        StartTransactionCommand();
+        RESUME_INTERRUPTS();
+    }
+    PG_END_TRY();
+
+    MemoryContextResetAndDeleteChildren(t_thrd.mem_cxt.portal_mem_cxt);
+}
+
 /*
  * extract_autovac_opts
  *
@@ -2895,6 +3068,7 @@ static autovac_table* calculate_vacuum_cost_and_freezeages(const AutoVacOpts* av
     tab->at_vacuum_cost_limit = vac_cost_limit;
     tab->at_vacuum_cost_delay = vac_cost_delay;
     tab->at_needfreeze = need_freeze;
+    tab->at_delta_fullcu = false;
     tab->at_relname = NULL;
     tab->at_nspname = NULL;
     tab->at_datname = NULL;
@@ -2985,13 +3159,23 @@ static autovac_table* table_recheck_autovac(
     if (classForm->relkind == RELKIND_TOASTVALUE)
         doanalyze = false;
 
+    /* a delta merge moves whole CUs only, unless the merge lag is exceeded */
+    bool domerge = false;
+    bool fullcu_only = false;
+    if (!dovacuum && !dovacuum_toast && classForm->parttype == PARTTYPE_NON_PARTITIONED_RELATION &&
+        OidIsValid(classForm->reldeltarelid) && rel_is_CU_format(classTup, pg_class_desc)) {
+        domerge = cstore_delta_needs_merge(
+            classForm->reldeltarelid, relid, InvalidOid, avopts, shared, dbentry, &fullcu_only);
+    }
+
     /* OK, it needs something done */
-    if (doanalyze || dovacuum || dovacuum_toast) {
+    if (doanalyze || dovacuum || dovacuum_toast || domerge) {
         tab = calculate_vacuum_cost_and_freezeages(avopts, doanalyze, need_freeze);
         if (tab != NULL) {
             tab->at_relid = relid;
             tab->at_sharedrel = classForm->relisshared;
-            tab->at_dovacuum = dovacuum || dovacuum_toast;
+            tab->at_dovacuum = dovacuum || dovacuum_toast || domerge;
+            tab->at_delta_fullcu = domerge && fullcu_only;
         }
     }
 
@@ -3224,6 +3408,8 @@ static void fill_in_vac_stmt(VacuumStmt& vacstmt, const autovac_table& tab, Rang
         vacstmt.options = (unsigned int)vacstmt.options | VACOPT_VACUUM;
     if (tab.at_doanalyze)
         vacstmt.options = (unsigned int)vacstmt.options | VACOPT_ANALYZE;
+    if (tab.at_delta_fullcu)
+        vacstmt.options = (unsigned int)vacstmt.options | VACOPT_DELTA_FULLCU;
     vacstmt.options |= VACOPT_AUTOVAC;
     vacstmt.flags = tab.at_flags;
     vacstmt.rely_oid = InvalidOid; /* we just simple set it invalid, maybe change */
@@ -3330,7 +3516,6 @@ static void autovacuum_local_vac_analyze(autovac_table* tab, BufferAccessStrateg
  */
 static void autovac_report_activity(autovac_table* tab)
 {
-#define MAX_AUTOVAC_ACTIV_LEN (NAMEDATALEN * 2 + 56)
     char activity[MAX_AUTOVAC_ACTIV_LEN];
     int len;
     int rc = 0;
@@ -3378,6 +3563,80 @@ bool AutoVacuumingActive(void)
     return true;
 }
 
+/*
+ * Request one work item to the next autovacuum run processing our database.
+ * Return false if the request can't be recorded, because the work item
+ * array is full, or holds MAX_HOT_PRUNE_WORKITEMS page prune requests already.
+ *
+ * A request identical to one that is already waiting is not recorded again.
+ */
+bool AutoVacuumRequestWork(AutoVacuumWorkItemType type, Oid relationId, BlockNumber blkno)
+{
+    AutoVacuumWorkItem* workItems = t_thrd.autovacuum_cxt.AutoVacuumShmem->av_workItems;
+    bool result = false;
+    int freeItem = -1;
+    int nsameType = 0;
+    int i;
+
+    /*
+     * Backends keep asking for as long as the work is pending, so look for a
+     * waiting duplicate under a shared lock first.
+     */
+    LWLockAcquire(AutovacuumLock, LW_SHARED);
+    for (i = 0; i < NUM_WORKITEMS; i++) {
+        if (workItems[i].avw_used && !workItems[i].avw_active && workItems[i].avw_type == type &&
+            workItems[i].avw_database == u_sess->proc_cxt.MyDatabaseId && workItems[i].avw_relation == relationId &&
+            workItems[i].avw_blockNumber == blkno) {
+            result = true;
+            break;
+        }
+    }
+    LWLockRelease(AutovacuumLock);
+    if (result)
+        return true;
+
+    LWLockAcquire(AutovacuumLock, LW_EXCLUSIVE);
+
+    /*
+     * Locate an unused work item, counting the ones of the same type.
+     */
+    for (i = 0; i < NUM_WORKITEMS; i++) {
+        AutoVacuumWorkItem* workitem = &workItems[i];
+
+        if (workitem->avw_used) {
+            if (workitem->avw_type != type)
+                continue;
+            if (!workitem->avw_active && workitem->avw_database == u_sess->proc_cxt.MyDatabaseId &&
+                workitem->avw_relation == relationId && workitem->avw_blockNumber == blkno) {
+                result = true;
+                break;
+            }
+            nsameType++;
+            continue;
+        }
+
+        if (freeItem < 0)
+            freeItem = i;
+    }
+
+    /* and fill it with the given data */
+    if (!result && freeItem >= 0 && (type != AVW_HeapPruneHotChains || nsameType < MAX_HOT_PRUNE_WORKITEMS)) {
+        AutoVacuumWorkItem* workitem = &workItems[freeItem];
+
+        workitem->avw_type = type;
+        workitem->avw_used = true;
+        workitem->avw_active = false;
+        workitem->avw_database = u_sess->proc_cxt.MyDatabaseId;
+        workitem->avw_relation = relationId;
+        workitem->avw_blockNumber = blkno;
+        result = true;
+    }
+
+    LWLockRelease(AutovacuumLock);
+
+    return result;
+}
+
 /*
  * autovac_init
  *		This is called at postmaster initialization.
@@ -3447,6 +3706,9 @@ void AutoVacuumShmemInit(void)
         t_thrd.autovacuum_cxt.AutoVacuumShmem->av_freeWorkers = NULL;
         SHMQueueInit(&t_thrd.autovacuum_cxt.AutoVacuumShmem->av_runningWorkers);
         t_thrd.autovacuum_cxt.AutoVacuumShmem->av_startingWorker = NULL;
+        errno_t rc = memset_s(t_thrd.autovacuum_cxt.AutoVacuumShmem->av_workItems,
+            sizeof(AutoVacuumWorkItem) * NUM_WORKITEMS, 0, sizeof(AutoVacuumWorkItem) * NUM_WORKITEMS);
+        securec_check(rc, "\0", "\0");
 
         worker = (WorkerInfo)((char*)t_thrd.autovacuum_cxt.AutoVacuumShmem + MAXALIGN(sizeof(AutoVacuumShmemStruct)));
 
@@ -3693,13 +3955,24 @@ static autovac_table* partition_recheck_autovac(
     partition_needs_vacanalyze(
         partid, avopts, partForm, partTuple, ap_entry, tabentry, true, &dovacuum, &doanalyze, &need_freeze);
     Assert(false == doanalyze);
+
+    /* a delta merge moves whole CUs only, unless the merge lag is exceeded */
+    bool domerge = false;
+    bool fullcu_only = false;
+    if (!dovacuum && !dovacuum_toast && ap_entry != NULL && ap_entry->at_iscstore &&
+        OidIsValid(partForm->reldeltarelid)) {
+        domerge = cstore_delta_needs_merge(
+            partForm->reldeltarelid, partid, relid, avopts, shared, dbentry, &fullcu_only);
+    }
+
     /* OK, it needs something done */
-    if (dovacuum || dovacuum_toast) {
+    if (dovacuum || dovacuum_toast || domerge) {
         tab = calculate_vacuum_cost_and_freezeages(avopts, doanalyze, need_freeze);
         if (tab != NULL) {
             tab->at_relid = partid;
             tab->at_sharedrel = false;
-            tab->at_dovacuum = dovacuum || dovacuum_toast;
+            tab->at_dovacuum = dovacuum || dovacuum_toast || domerge;
+            tab->at_delta_fullcu = domerge && fullcu_only;
         }
     }
 
@@ -3707,6 +3980,71 @@ static autovac_table* partition_recheck_autovac(
 
     return tab;
 }
+
+/*
+ * cstore_delta_needs_merge
+ *
+ * Check whether the delta table of a column table, or of one partition of it,
+ * should be merged into CUs by autovacuum.  It is merged once it holds at
+ * least autovacuum_deltamerge_threshold rows, in which case only the rows
+ * filling whole CUs are moved (*fullcu_only is set).  Besides, a non-empty
+ * delta table is merged completely if the last merge of its owner is older
+ * than autovacuum_deltamerge_max_lag, so that a slowly growing delta table
+ * does not stay unmerged forever.
+ *
+ * relid and parentid identify the owner as in pgstat: a table with an invalid
+ * parentid, or a partition and its partitioned table.
+ */
+static bool cstore_delta_needs_merge(Oid deltaid, Oid relid, Oid parentid, const AutoVacOpts* relopts,
+    PgStat_StatDBEntry* shared, PgStat_StatDBEntry* dbentry, bool* fullcu_only)
+{
+    PgStat_StatTabEntry* deltaentry = NULL;
+    PgStat_StatTabEntry* tabentry = NULL;
+    int threshold = u_sess->attr.attr_storage.autovacuum_deltamerge_thresh;
+    int max_lag = u_sess->attr.attr_storage.autovacuum_deltamerge_max_lag;
+
+    *fullcu_only = false;
+
+    /* User disabled it in pg_class.reloptions? */
+    if (!u_sess->attr.attr_storage.autovacuum_start_daemon || (relopts != NULL && !relopts->enabled))
+        return false;
+
+    deltaentry = get_pgstat_tabentry_relid(deltaid, false, InvalidOid, shared, dbentry);
+    if (deltaentry == NULL || deltaentry->n_live_tuples <= 0)
+        return false;
+
+    if (threshold > 0 && deltaentry->n_live_tuples >= threshold) {
+        AUTOVAC_LOG(DEBUG2,
+            "delta merge of %u/%u: delta rows %ld, threshold %d",
+            parentid,
+            relid,
+            deltaentry->n_live_tuples,
+            threshold);
+        *fullcu_only = true;
+        return true;
+    }
+
+    if (max_lag > 0) {
+        TimestampTz last_merge = 0;
+
+        tabentry = get_pgstat_tabentry_relid(relid, false, parentid, shared, dbentry);
+        if (tabentry != NULL)
+            last_merge = Max(tabentry->vacuum_timestamp, tabentry->autovac_vacuum_timestamp);
+
+        if (TimestampDifferenceExceeds(last_merge, GetCurrentTimestamp(), max_lag * 1000)) {
+            AUTOVAC_LOG(DEBUG2,
+                "delta merge of %u/%u: delta rows %ld, last merge at %s",
+                parentid,
+                relid,
+                deltaentry->n_live_tuples,
+                (last_merge == 0) ? "never" : timestamptz_to_str(last_merge));
+            return true;
+        }
+    }
+
+    return false;
+}
+
 bool enable_page_prune(void)
 {
     if (u_sess->attr.attr_storage.autovacuum_start_daemon && g_instance.attr.attr_storage.autovacuum_max_workers > 0)
@@ -703,6 +703,9 @@ void incre_ckpt_bgwriter_cxt_init()
         g_instance.bgwriter_cxt.bgwriter_procs[i].thrd_dw_cxt.dw_buf = (char*)TYPEALIGN(BLCKSZ, unaligned_buf);
         g_instance.bgwriter_cxt.bgwriter_procs[i].thrd_dw_cxt.dw_page_idx = -1;
         g_instance.bgwriter_cxt.bgwriter_procs[i].thrd_dw_cxt.contain_hashbucket = false;
+        /* spread bgwriters over the double write files not taken by the page writer first */
+        g_instance.bgwriter_cxt.bgwriter_procs[i].thrd_dw_cxt.dw_file_id =
+            (i + 1) % g_instance.attr.attr_storage.dw_file_num;
         g_instance.bgwriter_cxt.bgwriter_procs[i].dirty_list_size = dirty_list_size;
         g_instance.bgwriter_cxt.bgwriter_procs[i].dirty_buf_list =
             (CkptSortItem *)palloc0(dirty_list_size * sizeof(CkptSortItem));
@@ -230,6 +230,8 @@ void incre_ckpt_pagewriter_cxt_init()
 	g_instance.ckpt_cxt_ctl->page_writer_procs.thrd_dw_cxt.dw_buf = (char*)TYPEALIGN(BLCKSZ, unaligned_buf);
 	g_instance.ckpt_cxt_ctl->page_writer_procs.thrd_dw_cxt.dw_page_idx = -1;
 	g_instance.ckpt_cxt_ctl->page_writer_procs.thrd_dw_cxt.contain_hashbucket = false;
+    /* the page writer always writes the first double write file */
+    g_instance.ckpt_cxt_ctl->page_writer_procs.thrd_dw_cxt.dw_file_id = 0;
 
     (void)MemoryContextSwitchTo(oldcontext);
 }
@@ -571,7 +573,7 @@ static void ckpt_pagewriter_main_thread_flush_dirty_page()
     XLogRecPtr CurrBytePos;
     uint64 dirty_queue_head;
 
-    WritebackContextInit(&wb_context, &t_thrd.pagewriter_cxt.page_writer_after);
+    WritebackContextInit(&wb_context, &u_sess->attr.attr_storage.pagewriter_flush_after);
     ResourceOwnerEnlargeBuffers(t_thrd.utils_cxt.CurrentResourceOwner);
 
     /*
@@ -607,7 +609,7 @@ static void ckpt_pagewriter_main_thread_flush_dirty_page()
     /* page_writer thread flush dirty page */
     Assert(thread_id == 0); /* main thread id is 0 */
     Assert(g_instance.ckpt_cxt_ctl->page_writer_procs.writer_proc[thread_id].need_flush);
-    ckpt_flush_dirty_page(thread_id, wb_context);
+    ckpt_flush_dirty_page(thread_id, &wb_context);
 
     actual_flushed = ckpt_move_queue_head_after_flush();
     /* We flushed some buffers, so update the statistics */
@@ -804,7 +806,7 @@ static void ckpt_pagewriter_sub_thread_loop()
     int thread_id = t_thrd.pagewriter_cxt.pagewriter_id;
     WritebackContext wb_context;
 
-    WritebackContextInit(&wb_context, &t_thrd.pagewriter_cxt.page_writer_after);
+    WritebackContextInit(&wb_context, &u_sess->attr.attr_storage.pagewriter_flush_after);
 
     if (t_thrd.pagewriter_cxt.got_SIGHUP) {
         t_thrd.pagewriter_cxt.got_SIGHUP = false;
@@ -837,7 +839,7 @@ static void ckpt_pagewriter_sub_thread_loop()
 
     if (g_instance.ckpt_cxt_ctl->page_writer_procs.writer_proc[thread_id].need_flush) {
         ResourceOwnerEnlargeBuffers(t_thrd.utils_cxt.CurrentResourceOwner);
-        ckpt_flush_dirty_page(thread_id, wb_context);
+        ckpt_flush_dirty_page(thread_id, &wb_context);
     }
 
     return;
@@ -5347,6 +5347,8 @@ static PgStat_StatTabEntry* pgstat_get_tab_entry(
         result->cu_mem_hit = 0;
         result->cu_hdd_sync = 0;
         result->cu_hdd_asyn = 0;
+        errno_t rc = memset_s(result->hot_chain_len, sizeof(result->hot_chain_len), 0, sizeof(result->hot_chain_len));
+        securec_check(rc, "", "");
         result->vacuum_timestamp = 0;
         result->vacuum_count = 0;
         result->autovac_vacuum_timestamp = 0;
@@ -6169,6 +6171,8 @@ static void pgstat_recv_tabstat(PgStat_MsgTabstat* msg)
             tabentry->cu_mem_hit = tabmsg->t_counts.t_cu_mem_hit;
             tabentry->cu_hdd_sync = tabmsg->t_counts.t_cu_hdd_sync;
             tabentry->cu_hdd_asyn = tabmsg->t_counts.t_cu_hdd_asyn;
+            for (int j = 0; j < PGSTAT_HOT_CHAIN_BUCKETS; j++)
+                tabentry->hot_chain_len[j] = tabmsg->t_counts.t_hot_chain_len[j];
 
             tabentry->vacuum_timestamp = 0;
             tabentry->vacuum_count = 0;
@@ -6199,6 +6203,8 @@ static void pgstat_recv_tabstat(PgStat_MsgTabstat* msg)
             tabentry->cu_mem_hit += tabmsg->t_counts.t_cu_mem_hit;
             tabentry->cu_hdd_sync += tabmsg->t_counts.t_cu_hdd_sync;
             tabentry->cu_hdd_asyn += tabmsg->t_counts.t_cu_hdd_asyn;
+            for (int j = 0; j < PGSTAT_HOT_CHAIN_BUCKETS; j++)
+                tabentry->hot_chain_len[j] += tabmsg->t_counts.t_hot_chain_len[j];
         }
 
         /* Clamp n_live_tuples in case of negative delta_live_tuples */
@@ -6249,6 +6255,8 @@ static void pgstat_recv_tabstat(PgStat_MsgTabstat* msg)
             tabentry->cu_mem_hit = tabmsg->t_counts.t_cu_mem_hit;
             tabentry->cu_hdd_sync = tabmsg->t_counts.t_cu_hdd_sync;
             tabentry->cu_hdd_asyn = tabmsg->t_counts.t_cu_hdd_asyn;
+            for (int j = 0; j < PGSTAT_HOT_CHAIN_BUCKETS; j++)
+                tabentry->hot_chain_len[j] = tabmsg->t_counts.t_hot_chain_len[j];
 
             tabentry->vacuum_timestamp = 0;
             tabentry->vacuum_count = 0;
@@ -6279,6 +6287,8 @@ static void pgstat_recv_tabstat(PgStat_MsgTabstat* msg)
             tabentry->cu_mem_hit += tabmsg->t_counts.t_cu_mem_hit;
             tabentry->cu_hdd_sync += tabmsg->t_counts.t_cu_hdd_sync;
             tabentry->cu_hdd_asyn += tabmsg->t_counts.t_cu_hdd_asyn;
+            for (int j = 0; j < PGSTAT_HOT_CHAIN_BUCKETS; j++)
+                tabentry->hot_chain_len[j] += tabmsg->t_counts.t_hot_chain_len[j];
         }
     }
 }
@@ -20,6 +20,15 @@
  * got a yen to create xlog segments further in advance, that'd be better done
  * in bgwriter than in walwriter.
  *
+ * With wal_flush_wait_queue on, synchronous commits are flushed by the
+ * walwriter as well: committing backends queue up for the flush of their
+ * commit record, and the walwriter releases them after each flush (see
+ * XLogWaitFlush). wal_flush_group_delay lets it wait a little for more
+ * commits to share an fsync, when the commit rate makes that worthwhile.
+ *
+ * With enable_io_uring on, the walwriter registers the WAL buffers with its
+ * io_uring, so that the kernel doesn't have to map them for every write.
+ *
  * The walwriter is started by the postmaster as soon as the startup subprocess
  * finishes.  It remains alive until the postmaster commands it to terminate.
  * Normal termination is by SIGTERM, which instructs the walwriter to exit(0).
@@ -71,6 +80,9 @@
 #define LOOPS_UNTIL_HIBERNATE 50
 #define HIBERNATE_FACTOR 25
 
+/* weight of a new sample in the average interval between queued commits */
+#define FLUSH_WAIT_INTERVAL_WEIGHT 8
+
 typedef struct WALCallbackItem {
     struct WALCallbackItem* next;
     WALCallback callback;
@@ -83,6 +95,8 @@ static void WalSigHupHandler(SIGNAL_ARGS);
 static void WalShutdownHandler(SIGNAL_ARGS);
 static void walwriter_sigusr1_handler(SIGNAL_ARGS);
 
+static void WalWriterGroupDelay(void);
+
 /*
  * Main entry point for walwriter process
  *
@@ -287,6 +301,11 @@ void WalWriterMain(void)
             ProcessConfigFile(PGC_SIGHUP);
         }
 
+        /* Let XLogWrite write the WAL buffers through io_uring as fixed buffers */
+        if (u_sess->attr.attr_storage.enable_io_uring) {
+            XLogRegisterBuffersForIO();
+        }
+
         if (t_thrd.walwriter_cxt.shutdown_requested) {
             /* Normal exit from the walwriter is here */
             proc_exit(0); /* done */
@@ -295,6 +314,9 @@ void WalWriterMain(void)
         /* execute callbacks (i.e. write data from MOT) */
         CallWALCallback();
 
+        /* Let more commits join the ones waiting for the flush, if worthwhile */
+        WalWriterGroupDelay();
+
         /*
          * Do what we're here for; then, if XLogBackgroundFlush() found useful
          * work to do, reset hibernation counter.
@@ -305,6 +327,9 @@ void WalWriterMain(void)
             left_till_hibernate--;
         }
 
+        /* Wake up the committers whose commit record is now on disk */
+        (void)XLogReleaseFlushWaiters();
+
         /*
          * Sleep until we are signaled or WalWriterDelay has elapsed.  If we
          * haven't done anything useful for quite some time, lengthen the
@@ -329,6 +354,44 @@ void WalWriterMain(void)
     }
 }
 
+/*
+ * Adaptive group flush delay.
+ *
+ * Keep a moving average of the interval between two commits queued for the
+ * flush. When commits are waiting and the next one is expected within
+ * wal_flush_group_delay, sleep for that interval before flushing, so that it
+ * shares the fsync. At low commit rates the flush is not delayed at all.
+ */
+static void WalWriterGroupDelay(void)
+{
+    knl_t_walwriter_context* cxt = &t_thrd.walwriter_cxt;
+    int maxDelay = u_sess->attr.attr_storage.wal_flush_group_delay;
+    uint64 arrivals = XLogFlushWaitArrivals();
+
+    if (arrivals != cxt->flush_wait_arrivals) {
+        TimestampTz now = GetCurrentTimestamp();
+
+        if (cxt->flush_wait_time != 0) {
+            double sample = (double)(now - cxt->flush_wait_time) / (double)(arrivals - cxt->flush_wait_arrivals);
+
+            if (cxt->flush_wait_interval == 0) {
+                cxt->flush_wait_interval = sample;
+            } else {
+                cxt->flush_wait_interval += (sample - cxt->flush_wait_interval) / FLUSH_WAIT_INTERVAL_WEIGHT;
+            }
+        }
+        cxt->flush_wait_arrivals = arrivals;
+        cxt->flush_wait_time = now;
+    }
+
+    if (maxDelay <= 0 || !u_sess->attr.attr_storage.enableFsync || cxt->flush_wait_interval <= 0 ||
+        cxt->flush_wait_interval > maxDelay || !XLogFlushWaitPending()) {
+        return;
+    }
+
+    pg_usleep((long)cxt->flush_wait_interval);
+}
+
 /* --------------------------------
  *		signal handler routines
  * --------------------------------
@@ -200,6 +200,7 @@ static void knl_g_cache_init(knl_g_cache_context* cache_cxt)
                                                         SHARED_CONTEXT,
                                                         DEFAULT_MEMORY_CONTEXT_MAX_SIZE,
                                                         false);
+    cache_cxt->global_catcache = NULL;
 }
 
 static void knl_g_comm_init(knl_g_comm_context* comm_cxt)
@@ -323,7 +324,10 @@ static void knl_g_heartbeat_init(knl_g_heartbeat_context* hb_cxt)
 static void knl_g_dw_init(knl_g_dw_context *dw_cxt)
 {
     Assert(dw_cxt != NULL);
-    dw_cxt->flush_lock = NULL;
+    for (int i = 0; i < DW_MAX_FILE_NUM; i++) {
+        dw_cxt[i].file_id = i;
+        dw_cxt[i].flush_lock = NULL;
+    }
 }
 
 static void knl_g_numa_init(knl_g_numa_context* numa_cxt)
@@ -385,7 +389,7 @@ void knl_instance_init()
     g_instance.ckpt_cxt_ctl = &g_instance.ckpt_cxt;
     g_instance.ckpt_cxt_ctl = (knl_g_ckpt_context*)TYPEALIGN(SIZE_OF_TWO_UINT64, g_instance.ckpt_cxt_ctl);
     knl_g_heartbeat_init(&g_instance.heartbeat_cxt);
-    knl_g_dw_init(&g_instance.dw_cxt);
+    knl_g_dw_init(g_instance.dw_cxt);
     knl_g_xlog_init(&g_instance.xlog_cxt);
     knl_g_numa_init(&g_instance.numa_cxt);
     knl_g_bgworker_init(&g_instance.bgworker_cxt);
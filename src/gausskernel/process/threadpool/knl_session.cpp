@@ -112,6 +112,8 @@ static void knl_u_executor_init(knl_u_executor_context* exec_cxt)
 static void knl_u_index_init(knl_u_index_context* index_cxt)
 {
     index_cxt->counter = 1;
+    index_cxt->gin_cleanup_nrequests = 0;
+    index_cxt->gin_cleanup_next = 0;
 }
 
 static void knl_u_instrument_init(knl_u_instrument_context* instr_cxt)
@@ -668,6 +668,11 @@ static void knl_t_basebackup_init(knl_t_basebackup_context* basebackup_cxt)
     int rc = memset_s(basebackup_cxt->g_xlog_location, MAXPGPATH, 0, MAXPGPATH);
     securec_check(rc, "\0", "\0");
     basebackup_cxt->buf_block = NULL;
+    basebackup_cxt->compression = 0;
+    basebackup_cxt->compress_buf = NULL;
+    basebackup_cxt->reader_pool = NULL;
+    basebackup_cxt->changed_blocks = NULL;
+    basebackup_cxt->tablespace_oid = InvalidOid;
 }
 
 static void knl_t_datarcvwriter_init(knl_t_datarcvwriter_context* datarcvwriter_cxt)
@@ -949,6 +954,9 @@ static void knl_t_walwriter_init(knl_t_walwriter_context* walwriter_cxt)
 {
     walwriter_cxt->got_SIGHUP = false;
     walwriter_cxt->shutdown_requested = false;
+    walwriter_cxt->flush_wait_arrivals = 0;
+    walwriter_cxt->flush_wait_time = 0;
+    walwriter_cxt->flush_wait_interval = 0;
 }
 
 static void knl_t_poolcleaner_init(knl_t_poolcleaner_context* poolcleaner_cxt)
@@ -1013,7 +1021,6 @@ static void knl_t_pagewriter_init(knl_t_pagewriter_context* pagewriter_cxt)
 {
     pagewriter_cxt->got_SIGHUP = false;
     pagewriter_cxt->shutdown_requested = false;
-    pagewriter_cxt->page_writer_after = WRITEBACK_MAX_PENDING_FLUSHES;
     pagewriter_cxt->pagewriter_id = -1;
 }
 
@@ -1119,6 +1126,8 @@ static void knl_t_walreceiver_init(knl_t_walreceiver_context* walreceiver_cxt)
     walreceiver_cxt->AmWalReceiverForFailover = false;
     walreceiver_cxt->AmWalReceiverForStandby = false;
     walreceiver_cxt->control_file_writed = 0;
+    walreceiver_cxt->decompress_buf = NULL;
+    walreceiver_cxt->decompress_buf_size = 0;
 }
 
 static void knl_t_storage_init(knl_t_storage_context* storage_cxt)
@@ -1190,7 +1199,9 @@ static void knl_t_storage_init(knl_t_storage_context* storage_cxt)
     storage_cxt->conflicting_lock_mode_name = NULL;
     storage_cxt->conflicting_lock_thread_id = 0;
     storage_cxt->conflicting_lock_by_holdlock = true;
-    storage_cxt->FastPathLocalUseCount = 0;
+    rc = memset_s(storage_cxt->FastPathLocalUseCounts, sizeof(storage_cxt->FastPathLocalUseCounts), 0,
+        sizeof(storage_cxt->FastPathLocalUseCounts));
+    securec_check(rc, "\0", "\0");
     storage_cxt->FastPathStrongRelationLocks = NULL;
     storage_cxt->LockMethodLockHash = NULL;
     storage_cxt->LockMethodProcLockHash = NULL;
@@ -1269,6 +1280,8 @@ static void knl_t_walsender_init(knl_t_walsender_context* walsender_cxt)
     walsender_cxt->sentPtr = 0;
     walsender_cxt->catchup_threshold = 0;
     walsender_cxt->output_xlog_msg_prefix_len = 0;
+    walsender_cxt->wal_stream_compression = 0;
+    walsender_cxt->output_compressed_message = NULL;
     walsender_cxt->output_data_msg_cur_len = 0;
     walsender_cxt->output_data_msg_start_xlog = InvalidXLogRecPtr;
     walsender_cxt->output_data_msg_end_xlog = InvalidXLogRecPtr;
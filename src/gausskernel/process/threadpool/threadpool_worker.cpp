@@ -762,6 +762,8 @@ static void free_session(knl_session_context* session)
         (void)MemoryContextSwitchTo(t_thrd.mem_cxt.msg_mem_cxt);
     }
 
+    /* the catcache entries of the session may refer to global catcache entries */
+    ReleaseGlobalCatCacheRefs();
     MemoryContextDelete(session->top_mem_cxt);
     pfree_ext(session);
     use_fake_session();
@@ -390,6 +390,12 @@ static TupleTableSlot* BitmapHeapTblNext(BitmapHeapScanState* node)
                 continue;
             }
 
+            if (tbmres->ntuples >= 0) {
+                node->exact_pages++;
+            } else {
+                node->lossy_pages++;
+            }
+
             /*
              * Fetch the current heap page and identify candidate tuples.
              */
@@ -801,6 +807,8 @@ BitmapHeapScanState* ExecInitBitmapHeapScan(BitmapHeapScan* node, EState* estate
     scanstate->prefetch_iterator = NULL;
     scanstate->prefetch_pages = 0;
     scanstate->prefetch_target = 0;
+    scanstate->exact_pages = 0;
+    scanstate->lossy_pages = 0;
     scanstate->ss.isPartTbl = node->scan.isPartTbl;
     scanstate->ss.currentSlot = 0;
     scanstate->ss.partScanDirection = node->scan.partScanDirection;
@@ -47,6 +47,7 @@
 #include "access/cstore_am.h"
 #include "optimizer/clauses.h"
 #include "nodes/params.h"
+#include "utils/array.h"
 #include "utils/lsyscache.h"
 #include "utils/datum.h"
 #include "utils/rel.h"
@@ -73,6 +74,8 @@ extern bool CodeGenThreadObjectReady();
 extern bool CodeGenPassThreshold(double rows, int dn_num, int dop);
 
 static CStoreStrategyNumber get_cstore_scan_strategy_num(Oid opno);
+static void exec_cstore_build_inlist_scan_key(
+    CStoreScanKey scan_key, ScalarArrayOpExpr* saop, List* accessed_varnos);
 static Datum get_param_extern_const_value(Oid left_type, Expr* expr, PlanState* ps, uint16* flag);
 static void exec_init_next_part4cstore_scan(CStoreScanState* node);
 static void exec_cstore_build_scan_keys(CStoreScanState* scan_stat, List* quals, CStoreScanKey* scan_keys, int* num_scan_keys,
@@ -1006,6 +1009,8 @@ static void exec_cstore_build_scan_keys(CStoreScanState* scan_stat, List* quals,
                 opfunc_id,
                 scan_val,
                 left_type);
+        } else if (IsA(clause, ScalarArrayOpExpr)) {
+            exec_cstore_build_inlist_scan_key(this_scan_key, (ScalarArrayOpExpr*)clause, accessed_varnos);
         } else {
             pfree_ext(tmp_scan_keys);
             tmp_scan_keys = NULL;
@@ -1021,6 +1026,66 @@ static void exec_cstore_build_scan_keys(CStoreScanState* scan_stat, List* quals,
     *runtime_keys_num = runtime_keys;
 }
 
+/*
+ * Build the cstore scan key for "var = ANY (const array)", which has been
+ * checked by filter_cstore_inlist_clause(). The not-null array values are
+ * converted the same way as the argument of "var = const".
+ */
+static void exec_cstore_build_inlist_scan_key(
+    CStoreScanKey scan_key, ScalarArrayOpExpr* saop, List* accessed_varnos)
+{
+    Expr* leftop = (Expr*)linitial(saop->args);
+    Const* rightop = (Const*)lsecond(saop->args);
+    ListCell* lcell = NULL;
+    AttrNumber count_no = 0;
+
+    if (IsA(leftop, RelabelType))
+        leftop = ((RelabelType*)leftop)->arg;
+    Assert(IsA(leftop, Var) && IsA(rightop, Const) && !rightop->constisnull);
+
+    /* The attribute numbers of column in cstore scan is a sequence.begin with 0. */
+    AttrNumber varattno = ((Var*)leftop)->varattno;
+    foreach (lcell, accessed_varnos) {
+        if ((int)varattno == lfirst_int(lcell)) {
+            varattno = count_no;
+            break;
+        }
+        count_no++;
+    }
+    Oid left_type = ((Var*)leftop)->vartype;
+
+    ArrayType* arr = DatumGetArrayTypeP(rightop->constvalue);
+    Oid elem_type = ARR_ELEMTYPE(arr);
+    int16 elem_len;
+    bool elem_byval = false;
+    char elem_align;
+    Datum* elem_values = NULL;
+    bool* elem_nulls = NULL;
+    int num_elems = 0;
+
+    get_typlenbyvalalign(elem_type, &elem_len, &elem_byval, &elem_align);
+    deconstruct_array(arr, elem_type, elem_len, elem_byval, elem_align, &elem_values, &elem_nulls, &num_elems);
+
+    CStoreScanKeyInit(scan_key,
+        0,
+        varattno,
+        CStoreEqualStrategyNumber,
+        saop->inputcollid,
+        saop->opfuncid,
+        (Datum)0,
+        left_type);
+
+    /* NULL never equals to anything, so just skip it. */
+    int num_values = 0;
+    for (int i = 0; i < num_elems; i++) {
+        if (!elem_nulls[i])
+            elem_values[num_values++] = convert_scan_key_int64_if_need(left_type, elem_type, elem_values[i]);
+    }
+    scan_key->cs_nelems = num_values;
+    scan_key->cs_elems = elem_values;
+    pfree_ext(elem_nulls);
+}
+
 /* No metadata for the operator strategy. The followings are temporary codes.
  */
 static CStoreStrategyNumber get_cstore_scan_strategy_num(Oid opno)
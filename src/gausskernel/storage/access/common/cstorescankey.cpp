@@ -38,4 +38,6 @@ void CStoreScanKeyInit(CStoreScanKey entry, uint16 flags, AttrNumber attributeNu
     entry->cs_argument = argument;
     fmgr_info(procedure, &entry->cs_func);
     entry->cs_left_type = left_type;
+    entry->cs_nelems = 0;
+    entry->cs_elems = NULL;
 }
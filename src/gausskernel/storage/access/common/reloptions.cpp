@@ -21,6 +21,7 @@
 #include "access/nbtree.h"
 #include "access/reloptions.h"
 #include "access/spgist.h"
+#include "access/tuptoaster.h"
 #include "catalog/pg_ts_parser.h"
 #include "catalog/pg_type.h"
 #include "commands/defrem.h"
@@ -57,6 +58,7 @@
 /* value check functions for reloptions */
 static void ValidateStrOptOrientation(const char* val);
 static void ValidateStrOptCompression(const char* val);
+static void ValidateStrOptToastCompression(const char* val);
 static void  ValidateStrOptTTL(const char *val);
 static void  ValidateStrOptPeriod(const char *val);
 static void ValidateStrOptVersion(const char* val);
@@ -72,6 +74,7 @@ static relopt_bool boolRelOpts[] = {
         "Declare a table as an additional catalog table, e.g. for the purpose of logical replication",
         RELOPT_KIND_HEAP}, false},
     {{"fastupdate", "Enables \"fast update\" feature for this GIN index", RELOPT_KIND_GIN}, true},
+    {{"deduplicate_items", "Enables \"deduplicate items\" feature for this btree index", RELOPT_KIND_BTREE}, false},
     {{"security_barrier", "View acts as a row security barrier", RELOPT_KIND_VIEW}, false},
     {{"enable_rowsecurity", "Enable row level security or not", RELOPT_KIND_HEAP}, false},
     {{"force_rowsecurity", "Row security forced for owners or not", RELOPT_KIND_HEAP}, false},
@@ -87,6 +90,8 @@ static relopt_bool boolRelOpts[] = {
     {{"ignore_enable_hadoop_env", "ignore enable_hadoop_env option", RELOPT_KIND_HEAP}, false},
     {{"hashbucket", "Enables hashbucket in this relation", RELOPT_KIND_HEAP}, false},
     {{"on_commit_delete_rows", "global temp table on commit options", RELOPT_KIND_HEAP}, true},
+    {{"bloom_filter", "Builds a bloom filter for each CU of this column in column store", RELOPT_KIND_ATTRIBUTE},
+        false},
     /* list terminator */
     {{NULL}}};
 
@@ -307,6 +312,13 @@ static relopt_string string_rel_opts[] = {
         ValidateStrOptCompression,
         COMPRESSION_LOW,
     },
+    {
+        {"compression", "Compression method for TOASTed values of this column", RELOPT_KIND_ATTRIBUTE},
+        0,
+        true,
+        ValidateStrOptToastCompression,
+        NULL,
+    },
     {
         {"filesystem", "which filesystem applied", RELOPT_KIND_TABLESPACE},
         7,
@@ -1514,7 +1526,8 @@ bytea* default_reloptions(Datum reloptions, bool validate, relopt_kind kind)
         {"hashbucket", RELOPT_TYPE_BOOL, offsetof(StdRdOptions, hashbucket)},
         {"on_commit_delete_rows", RELOPT_TYPE_BOOL, offsetof(StdRdOptions, on_commit_delete_rows)},
         {"wait_clean_gpi", RELOPT_TYPE_STRING, offsetof(StdRdOptions, wait_clean_gpi)},
-        {"parallel_workers", RELOPT_TYPE_INT, offsetof(StdRdOptions, parallel_workers)}};
+        {"parallel_workers", RELOPT_TYPE_INT, offsetof(StdRdOptions, parallel_workers)},
+        {"deduplicate_items", RELOPT_TYPE_BOOL, offsetof(StdRdOptions, deduplicate_items)}};
 
     options = parseRelOptions(reloptions, validate, kind, &numoptions);
 
@@ -1621,7 +1634,9 @@ bytea* attribute_reloptions(Datum reloptions, bool validate)
     AttributeOpts* aopts = NULL;
     int numoptions;
     static const relopt_parse_elt tab[] = {{"n_distinct", RELOPT_TYPE_REAL, offsetof(AttributeOpts, n_distinct)},
-        {"n_distinct_inherited", RELOPT_TYPE_REAL, offsetof(AttributeOpts, n_distinct_inherited)}};
+        {"n_distinct_inherited", RELOPT_TYPE_REAL, offsetof(AttributeOpts, n_distinct_inherited)},
+        {"bloom_filter", RELOPT_TYPE_BOOL, offsetof(AttributeOpts, bloom_filter)},
+        {"compression", RELOPT_TYPE_STRING, offsetof(AttributeOpts, compression)}};
 
     options = parseRelOptions(reloptions, validate, RELOPT_KIND_ATTRIBUTE, &numoptions);
 
@@ -1812,6 +1827,19 @@ static void ValidateStrOptCompression(const char* val)
                           "\"lz4\" for dfs table.")));
 }
 
+/*
+ * Check the TOAST compression method of a column.
+ */
+static void ValidateStrOptToastCompression(const char* val)
+{
+    if (CompressionNameToId(val) == TOAST_INVALID_COMPRESSION_ID) {
+        ereport(ERROR,
+            (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                errmsg("invalid compression method \"%s\"", val),
+                errdetail("Valid compression methods are \"pglz\" and \"lz4\".")));
+    }
+}
+
 /*
  * Brief        : Check the filesystem option for tablespace.
  * Input        : val, the filesystem option value.
@@ -1922,6 +1950,23 @@ void heaprel_set_compressing_modes(Relation rel, int16* modes_ptr)
     opt[IDX_COMPRESSLEVEL_IN_MODES] = (int8)relation_get_compresslevel(rel);
 }
 
+/*
+ * @Description: combine COMPRESSION and COMPRESSLEVEL into compressing-modes
+ *    without any relation, for example compressing sample data.
+ * @IN compression: COMPRESSION value
+ * @IN compresslevel: COMPRESSLEVEL value
+ * @Return: compressing-modes value
+ * @See also:
+ */
+int16 heaprel_make_compressing_modes(int8 compression, int8 compresslevel)
+{
+    int16 modes = 0;
+    int8* opt = (int8*)&modes;
+    opt[IDX_COMPRESSION_IN_MODES] = compression;
+    opt[IDX_COMPRESSLEVEL_IN_MODES] = compresslevel;
+    return modes;
+}
+
 /*
  * @Description: get COMPRESSION value
  * @IN modes: compressing-modes value
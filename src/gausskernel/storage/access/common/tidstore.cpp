@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * -------------------------------------------------------------------------
+ *
+ * tidstore.cpp
+ *	  compact set of heap TIDs, filled in block order
+ *
+ * The TIDs of a block are kept either as a sorted array of 16-bit offsets or
+ * as a bitmap of its offsets, whichever is smaller, so that a page full of
+ * dead tuples costs a few bytes per TID instead of a whole ItemPointerData.
+ *
+ * Blocks are found through a radix tree with fixed levels: the high bits of
+ * the block number select a segment of chunk headers, the middle bits a
+ * chunk of 64 blocks, whose bitmap of non-empty blocks and the position of
+ * its first block give the block entry with a population count. Since the
+ * blocks must be added in increasing order, the entries of a chunk are
+ * adjacent, and a membership test costs the same whatever the number of
+ * TIDs in the store.
+ *
+ * Entries and offset words live in fixed-size slabs, so the memory used never
+ * exceeds the budget by more than one slab of each kind.
+ *
+ * IDENTIFICATION
+ *	  src/gausskernel/storage/access/common/tidstore.cpp
+ *
+ * -------------------------------------------------------------------------
+ */
+#include "postgres.h"
+#include "knl/knl_variable.h"
+
+#include "access/tidstore.h"
+#include "utils/memutils.h"
+
+#define TIDSTORE_CHUNK_SHIFT 6
+#define TIDSTORE_SEGMENT_SHIFT 16
+#define TIDSTORE_BLOCKS_PER_CHUNK (1U << TIDSTORE_CHUNK_SHIFT)
+#define TIDSTORE_CHUNKS_PER_SEGMENT (1U << (TIDSTORE_SEGMENT_SHIFT - TIDSTORE_CHUNK_SHIFT))
+
+#define TIDSTORE_SLAB_SIZE ((Size)65536)
+#define TIDSTORE_WORDS_PER_SLAB ((uint32)(TIDSTORE_SLAB_SIZE / sizeof(uint16)))
+#define TIDSTORE_ENTRIES_PER_SLAB ((uint32)(TIDSTORE_SLAB_SIZE / sizeof(TidStoreEntry)))
+
+#define TIDSTORE_BITS_PER_WORD 16
+#define TIDSTORE_BITMAP 0x8000 /* TidStoreEntry.count is a number of bitmap words */
+
+typedef struct TidStoreChunk {
+    uint64 blocks; /* bit i is set if block i of the chunk has TIDs */
+    uint32 first;  /* entry of the first block of the chunk having TIDs */
+} TidStoreChunk;
+
+typedef struct TidStoreEntry {
+    uint32 data;  /* position of the offsets or of the bitmap in the words */
+    uint16 count; /* number of offsets, or of bitmap words with TIDSTORE_BITMAP */
+} TidStoreEntry;
+
+#define TIDSTORE_SEGMENT_SIZE (sizeof(TidStoreChunk) * TIDSTORE_CHUNKS_PER_SEGMENT)
+
+struct TidStore {
+    MemoryContext context; /* holds everything but the TidStore itself */
+    Size max_bytes;
+    Size mem_used;
+    int64 num_tids;
+    BlockNumber last_blkno;
+
+    TidStoreChunk** segments; /* indexed by block number >> TIDSTORE_SEGMENT_SHIFT */
+    uint32 num_segments;
+
+    TidStoreEntry** entry_slabs;
+    uint32 num_entry_slabs;
+    uint32 num_entries;
+
+    uint16** word_slabs;
+    uint32 num_word_slabs;
+    uint32 num_words; /* position of the next free word */
+};
+
+struct TidStoreIter {
+    const TidStore* ts;
+    uint32 segment;     /* next chunk to look at */
+    uint32 chunk;
+    BlockNumber base;   /* first block of the current chunk */
+    uint64 blocks;      /* blocks of the current chunk not returned yet */
+    uint32 next_entry;
+    TidStoreIterResult result;
+};
+
+#define TidStoreGetEntry(ts, n) (&(ts)->entry_slabs[(n) / TIDSTORE_ENTRIES_PER_SLAB][(n) % TIDSTORE_ENTRIES_PER_SLAB])
+#define TidStoreGetWords(ts, n) (&(ts)->word_slabs[(n) / TIDSTORE_WORDS_PER_SLAB][(n) % TIDSTORE_WORDS_PER_SLAB])
+
+/*
+ * Create an empty store, using at most about maxBytes of memory. It's
+ * allocated in the current memory context.
+ */
+TidStore* TidStoreCreate(Size maxBytes)
+{
+    TidStore* ts = (TidStore*)palloc0(sizeof(TidStore));
+
+    ts->context = AllocSetContextCreate(CurrentMemoryContext,
+        "TidStore",
+        ALLOCSET_DEFAULT_MINSIZE,
+        ALLOCSET_DEFAULT_INITSIZE,
+        ALLOCSET_DEFAULT_MAXSIZE);
+    /* entries and words are addressed with 32 bits */
+    ts->max_bytes = Min(maxBytes, (Size)PG_UINT32_MAX);
+    ts->last_blkno = InvalidBlockNumber;
+    return ts;
+}
+
+void TidStoreDestroy(TidStore* ts)
+{
+    MemoryContextDelete(ts->context);
+    pfree(ts);
+}
+
+/*
+ * Forget all the TIDs, keeping the memory budget.
+ */
+void TidStoreReset(TidStore* ts)
+{
+    MemoryContextReset(ts->context);
+    ts->mem_used = 0;
+    ts->num_tids = 0;
+    ts->last_blkno = InvalidBlockNumber;
+    ts->segments = NULL;
+    ts->num_segments = 0;
+    ts->entry_slabs = NULL;
+    ts->num_entry_slabs = 0;
+    ts->num_entries = 0;
+    ts->word_slabs = NULL;
+    ts->num_word_slabs = 0;
+    ts->num_words = 0;
+}
+
+/* append a pointer to an array growing by powers of 2 */
+static void** tidstore_append_slab(TidStore* ts, void** slabs, uint32 nslabs, void* slab)
+{
+    if (nslabs == 0) {
+        slabs = (void**)MemoryContextAlloc(ts->context, sizeof(void*));
+        ts->mem_used += sizeof(void*);
+    } else if ((nslabs & (nslabs - 1)) == 0) {
+        slabs = (void**)repalloc(slabs, sizeof(void*) * nslabs * 2);
+        ts->mem_used += sizeof(void*) * nslabs;
+    }
+    slabs[nslabs] = slab;
+    return slabs;
+}
+
+static TidStoreChunk* tidstore_get_chunk(TidStore* ts, BlockNumber blkno)
+{
+    uint32 segment = blkno >> TIDSTORE_SEGMENT_SHIFT;
+
+    if (segment >= ts->num_segments) {
+        uint32 nsegments = segment + 1;
+
+        if (ts->segments == NULL) {
+            ts->segments = (TidStoreChunk**)MemoryContextAllocZero(ts->context, sizeof(TidStoreChunk*) * nsegments);
+        } else {
+            ts->segments = (TidStoreChunk**)repalloc(ts->segments, sizeof(TidStoreChunk*) * nsegments);
+            errno_t rc = memset_s(ts->segments + ts->num_segments,
+                sizeof(TidStoreChunk*) * (nsegments - ts->num_segments),
+                0,
+                sizeof(TidStoreChunk*) * (nsegments - ts->num_segments));
+            securec_check(rc, "", "");
+        }
+        ts->mem_used += sizeof(TidStoreChunk*) * (nsegments - ts->num_segments);
+        ts->num_segments = nsegments;
+    }
+    if (ts->segments[segment] == NULL) {
+        ts->segments[segment] = (TidStoreChunk*)MemoryContextAllocZero(ts->context, TIDSTORE_SEGMENT_SIZE);
+        ts->mem_used += TIDSTORE_SEGMENT_SIZE;
+    }
+
+    return &ts->segments[segment][(blkno >> TIDSTORE_CHUNK_SHIFT) & (TIDSTORE_CHUNKS_PER_SEGMENT - 1)];
+}
+
+/*
+ * Add the TIDs of a block. Blocks must be added in increasing order, and the
+ * offsets of a block must be sorted.
+ */
+void TidStoreSetBlockOffsets(TidStore* ts, BlockNumber blkno, const OffsetNumber* offsets, int numOffsets)
+{
+    TidStoreChunk* chunk = NULL;
+    TidStoreEntry* entry = NULL;
+    uint16* words = NULL;
+    uint32 nwords;
+    bool bitmap = false;
+
+    Assert(numOffsets > 0 && numOffsets <= MaxOffsetNumber);
+    Assert(ts->num_entries == 0 || blkno > ts->last_blkno);
+#ifdef USE_ASSERT_CHECKING
+    for (int i = 1; i < numOffsets; i++) {
+        Assert(offsets[i] > offsets[i - 1]);
+    }
+#endif
+
+    /* use a bitmap if it's smaller than the array of offsets */
+    nwords = offsets[numOffsets - 1] / TIDSTORE_BITS_PER_WORD + 1;
+    if (nwords < (uint32)numOffsets) {
+        bitmap = true;
+    } else {
+        nwords = (uint32)numOffsets;
+    }
+
+    /* the words of a block don't span slabs */
+    if (ts->num_words + nwords > ts->num_word_slabs * TIDSTORE_WORDS_PER_SLAB) {
+        uint16* slab = (uint16*)MemoryContextAlloc(ts->context, TIDSTORE_SLAB_SIZE);
+
+        ts->word_slabs = (uint16**)tidstore_append_slab(ts, (void**)ts->word_slabs, ts->num_word_slabs, slab);
+        ts->mem_used += TIDSTORE_SLAB_SIZE;
+        ts->num_words = ts->num_word_slabs * TIDSTORE_WORDS_PER_SLAB;
+        ts->num_word_slabs++;
+    }
+    if (ts->num_entries == ts->num_entry_slabs * TIDSTORE_ENTRIES_PER_SLAB) {
+        TidStoreEntry* slab = (TidStoreEntry*)MemoryContextAlloc(ts->context, TIDSTORE_SLAB_SIZE);
+
+        ts->entry_slabs = (TidStoreEntry**)tidstore_append_slab(ts, (void**)ts->entry_slabs, ts->num_entry_slabs, slab);
+        ts->mem_used += TIDSTORE_SLAB_SIZE;
+        ts->num_entry_slabs++;
+    }
+
+    chunk = tidstore_get_chunk(ts, blkno);
+    if (chunk->blocks == 0) {
+        chunk->first = ts->num_entries;
+    }
+    chunk->blocks |= UINT64CONST(1) << (blkno & (TIDSTORE_BLOCKS_PER_CHUNK - 1));
+
+    entry = TidStoreGetEntry(ts, ts->num_entries);
+    entry->data = ts->num_words;
+    entry->count = (uint16)nwords;
+    words = TidStoreGetWords(ts, ts->num_words);
+    if (bitmap) {
+        entry->count |= TIDSTORE_BITMAP;
+        errno_t rc = memset_s(words, sizeof(uint16) * nwords, 0, sizeof(uint16) * nwords);
+        securec_check(rc, "", "");
+        for (int i = 0; i < numOffsets; i++) {
+            words[offsets[i] / TIDSTORE_BITS_PER_WORD] |= (uint16)(1U << (offsets[i] % TIDSTORE_BITS_PER_WORD));
+        }
+    } else {
+        for (int i = 0; i < numOffsets; i++) {
+            words[i] = offsets[i];
+        }
+    }
+
+    ts->num_entries++;
+    ts->num_words += nwords;
+    ts->num_tids += numOffsets;
+    ts->last_blkno = blkno;
+}
+
+/*
+ * Is the TID in the store? Safe to call from several threads at the same
+ * time, as long as nobody adds TIDs meanwhile.
+ */
+bool TidStoreIsMember(const TidStore* ts, ItemPointer tid)
+{
+    BlockNumber blkno = ItemPointerGetBlockNumber(tid);
+    OffsetNumber offset = ItemPointerGetOffsetNumber(tid);
+    uint32 segment = blkno >> TIDSTORE_SEGMENT_SHIFT;
+    const TidStoreChunk* chunk = NULL;
+    const TidStoreEntry* entry = NULL;
+    const uint16* words = NULL;
+    uint64 bit;
+    uint32 count;
+
+    if (segment >= ts->num_segments || ts->segments[segment] == NULL) {
+        return false;
+    }
+    chunk = &ts->segments[segment][(blkno >> TIDSTORE_CHUNK_SHIFT) & (TIDSTORE_CHUNKS_PER_SEGMENT - 1)];
+    bit = UINT64CONST(1) << (blkno & (TIDSTORE_BLOCKS_PER_CHUNK - 1));
+    if ((chunk->blocks & bit) == 0) {
+        return false;
+    }
+
+    entry = TidStoreGetEntry(ts, chunk->first + (uint32)__builtin_popcountll(chunk->blocks & (bit - 1)));
+    words = TidStoreGetWords(ts, entry->data);
+    count = entry->count & ~TIDSTORE_BITMAP;
+    if (entry->count & TIDSTORE_BITMAP) {
+        if ((uint32)(offset / TIDSTORE_BITS_PER_WORD) >= count) {
+            return false;
+        }
+        return (words[offset / TIDSTORE_BITS_PER_WORD] & (1U << (offset % TIDSTORE_BITS_PER_WORD))) != 0;
+    }
+
+    /* binary search of the sorted offsets */
+    int low = 0;
+    int high = (int)count - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+
+        if (words[mid] == offset) {
+            return true;
+        } else if (words[mid] < offset) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return false;
+}
+
+/*
+ * Would adding the TIDs of one more heap page exceed the memory budget?
+ */
+bool TidStoreIsFull(const TidStore* ts)
+{
+    /* at worst a new slab of each kind, a new segment and larger slab arrays */
+    Size reserve = TIDSTORE_SLAB_SIZE * 2 + TIDSTORE_SEGMENT_SIZE +
+                   sizeof(void*) * (ts->num_entry_slabs + ts->num_word_slabs + 2);
+
+    return ts->mem_used + reserve > ts->max_bytes;
+}
+
+int64 TidStoreNumTids(const TidStore* ts)
+{
+    return ts->num_tids;
+}
+
+Size TidStoreMemoryUsage(const TidStore* ts)
+{
+    return ts->mem_used;
+}
+
+/*
+ * Return the blocks of the store in increasing order, with their offsets.
+ * The store must not change during the iteration.
+ */
+TidStoreIter* TidStoreBeginIterate(const TidStore* ts)
+{
+    TidStoreIter* iter = (TidStoreIter*)palloc0(sizeof(TidStoreIter));
+
+    iter->ts = ts;
+    return iter;
+}
+
+TidStoreIterResult* TidStoreIterateNext(TidStoreIter* iter)
+{
+    const TidStore* ts = iter->ts;
+    const TidStoreEntry* entry = NULL;
+    const uint16* words = NULL;
+    TidStoreIterResult* result = &iter->result;
+    uint32 count;
+    int bit;
+
+    while (iter->blocks == 0) {
+        if (iter->segment >= ts->num_segments) {
+            return NULL;
+        }
+        if (ts->segments[iter->segment] == NULL) {
+            iter->segment++;
+            iter->chunk = 0;
+            continue;
+        }
+
+        iter->base = (iter->segment << TIDSTORE_SEGMENT_SHIFT) | (iter->chunk << TIDSTORE_CHUNK_SHIFT);
+        iter->blocks = ts->segments[iter->segment][iter->chunk].blocks;
+        if (++iter->chunk == TIDSTORE_CHUNKS_PER_SEGMENT) {
+            iter->segment++;
+            iter->chunk = 0;
+        }
+    }
+
+    bit = __builtin_ctzll(iter->blocks);
+    iter->blocks &= iter->blocks - 1;
+    result->blkno = iter->base + (BlockNumber)bit;
+
+    entry = TidStoreGetEntry(ts, iter->next_entry);
+    iter->next_entry++;
+    words = TidStoreGetWords(ts, entry->data);
+    count = entry->count & ~TIDSTORE_BITMAP;
+    result->num_offsets = 0;
+    if (entry->count & TIDSTORE_BITMAP) {
+        for (uint32 i = 0; i < count; i++) {
+            uint32 word = words[i];
+
+            while (word != 0) {
+                int b = __builtin_ctz(word);
+
+                word &= word - 1;
+                result->offsets[result->num_offsets++] = (OffsetNumber)(i * TIDSTORE_BITS_PER_WORD + b);
+            }
+        }
+    } else {
+        for (uint32 i = 0; i < count; i++) {
+            result->offsets[result->num_offsets++] = words[i];
+        }
+    }
+
+    return result;
+}
+
+void TidStoreEndIterate(TidStoreIter* iter)
+{
+    pfree(iter);
+}
@@ -41,6 +41,54 @@ typedef struct KeyArray {
     int32 maxvalues;             /* allocated size of arrays */
 } KeyArray;
 
+/*
+ * Ask autovacuum to clean up the pending list of the index, whose head page
+ * is head.
+ *
+ * Returns false if that is not possible, and the caller should clean up
+ * the list itself.  Autovacuum only knows about whole indexes of shared
+ * buffer relations, and has a bounded number of requests.
+ *
+ * Every insert into an overlong list gets here, so the session remembers
+ * what it asked for, and doesn't ask again, taking AutovacuumLock, until
+ * the head of the list moves, meaning a cleanup has got to it.
+ */
+static bool ginRequestPendingListCleanup(Relation index, BlockNumber head)
+{
+    knl_u_index_context* cxt = &u_sess->index_cxt;
+    Oid indexOid = RelationGetRelid(index);
+    int i;
+
+    if (!AutoVacuumingActive() || RelationUsesLocalBuffers(index) || RelationIsPartition(index) ||
+        RelationIsBucket(index))
+        return false;
+
+    for (i = 0; i < cxt->gin_cleanup_nrequests; i++) {
+        if (cxt->gin_cleanup_requests[i].indexOid == indexOid)
+            break;
+    }
+
+    if (i < cxt->gin_cleanup_nrequests) {
+        if (cxt->gin_cleanup_requests[i].head == head)
+            return true;
+    } else if (cxt->gin_cleanup_nrequests < GIN_CLEANUP_REQUEST_MEMO_SIZE) {
+        i = cxt->gin_cleanup_nrequests++;
+    } else {
+        i = cxt->gin_cleanup_next;
+        cxt->gin_cleanup_next = (cxt->gin_cleanup_next + 1) % GIN_CLEANUP_REQUEST_MEMO_SIZE;
+    }
+
+    if (!AutoVacuumRequestWork(AVW_GINCleanPendingList, indexOid, InvalidBlockNumber)) {
+        /* forget it, so that the next insert asks again */
+        cxt->gin_cleanup_requests[i].indexOid = InvalidOid;
+        return false;
+    }
+
+    cxt->gin_cleanup_requests[i].indexOid = indexOid;
+    cxt->gin_cleanup_requests[i].head = head;
+    return true;
+}
+
 /*
  * Build a pending-list page from the given array of tuples, and write it out.
  *
@@ -217,7 +265,10 @@ void ginHeapTupleFastInsert(GinState* ginstate, GinTupleCollector* collector)
     ginxlogUpdateMeta data;
     bool separateList = false;
     bool needCleanup = false;
+    bool forceCleanup = false;
+    BlockNumber pendingHead = InvalidBlockNumber;
     int cleanupSize;
+    uint64 pendingSize;
     bool needWal = false;
     errno_t ret = EOK;
 
@@ -402,17 +453,26 @@ void ginHeapTupleFastInsert(GinState* ginstate, GinTupleCollector* collector)
      * while pending list is still small enough to fit into
      * gin_pending_list_limit.
      *
+     * The cleanup is handed to autovacuum where possible, so that no user
+     * statement has to absorb it.  Only if the list keeps growing past
+     * GIN_PENDING_LIST_BACKPRESSURE_FACTOR times the limit in the meantime,
+     * the inserting backends clean it up themselves.
+     *
      * ginInsertCleanup() should not be called inside our CRIT_SECTION.
      */
     cleanupSize = GinGetPendingListCleanupSize(index);
-    if ((uint64_t)(metadata->nPendingPages * GIN_PAGE_FREESIZE) > (uint64_t)(cleanupSize * 1024L))
+    pendingSize = (uint64)metadata->nPendingPages * GIN_PAGE_FREESIZE;
+    if (pendingSize > (uint64)cleanupSize * 1024L) {
         needCleanup = true;
+        forceCleanup = pendingSize > (uint64)cleanupSize * 1024L * GIN_PENDING_LIST_BACKPRESSURE_FACTOR;
+        pendingHead = metadata->head;
+    }
 
     UnlockReleaseBuffer(metabuffer);
 
     END_CRIT_SECTION();
 
-    if (needCleanup)
+    if (needCleanup && (forceCleanup || !ginRequestPendingListCleanup(index, pendingHead)))
         ginInsertCleanup(ginstate, false, true, NULL);
 }
 
@@ -887,6 +947,33 @@ void ginInsertCleanup(GinState* ginstate, bool full_clean, bool fill_fsm, IndexB
     MemoryContextDelete(opCtx);
 }
 
+/*
+ * Clean the insert pending list on behalf of autovacuum, as requested by
+ * ginRequestPendingListCleanup.  Unlike gin_clean_pending_list, this stops
+ * at the tail the list had on entry, so that steady insertion can't keep
+ * the worker here forever.
+ */
+void ginAutovacuumInsertCleanup(Oid indexoid)
+{
+    Relation indexRel = index_open(indexoid, AccessShareLock);
+    IndexBulkDeleteResult stats;
+    GinState ginstate;
+
+    /* The OID may have been reused by now */
+    if (indexRel->rd_rel->relkind != RELKIND_INDEX ||
+        (indexRel->rd_rel->relam != GIN_AM_OID && indexRel->rd_rel->relam != CGIN_AM_OID)) {
+        index_close(indexRel, AccessShareLock);
+        return;
+    }
+
+    errno_t rc = memset_s(&stats, sizeof(stats), 0, sizeof(stats));
+    securec_check(rc, "", "");
+    initGinState(&ginstate, indexRel);
+    ginInsertCleanup(&ginstate, false, true, &stats);
+
+    index_close(indexRel, AccessShareLock);
+}
+
 /*
  * SQL-callable function to clean the insert pending list
  */
@@ -16,6 +16,8 @@
 #include "knl/knl_variable.h"
 
 #include "access/gin_private.h"
+#include "access/parallel.h"
+#include "access/relscan.h"
 #include "access/xloginsert.h"
 #include "access/cbtree.h"
 #include "access/cstore_am.h"
@@ -23,16 +25,69 @@
 #include "access/sysattr.h"
 #include "catalog/index.h"
 #include "miscadmin.h"
+#include "pgstat.h"
 #include "storage/bufmgr.h"
 #include "storage/indexfsm.h"
 #include "storage/smgr.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
 #include "utils/rel_gs.h"
+#include "utils/snapmgr.h"
 #include "utils/tqual.h"
+#include "utils/tuplesort.h"
 #include "executor/executor.h"
 #include "optimizer/var.h"
 
+#define GIN_SCAN_WAIT_TIME 1 /* seconds, timeout for waiting end of heap scan */
+
+/*
+ * Status for GIN index builds performed in parallel, shared by the leader
+ * and the workers.  See BTShared in nbtsort.cpp.
+ */
+typedef struct GinShared {
+    /* These fields are not modified during the build */
+    Oid heaprelid;
+    Oid indexrelid;
+    bool isconcurrent;
+    int scantuplesortstates;
+
+    /* workersdonecv is signaled whenever a participant finishes its scan */
+    pthread_cond_t workersdonecv;
+    pthread_mutex_t mtx; /* mtx protects workersdonecv */
+
+    /* mutex protects all fields before heapdesc */
+    slock_t mutex;
+
+    /* Mutable state reported back to leader at end of the parallel scan */
+    int nparticipantsdone;
+    double reltuples;
+    double indtuples;
+    bool brokenhotchain;
+
+    /*
+     * This variable-sized field must come last.
+     *
+     * See _gin_parallel_estimate_shared().
+     */
+    ParallelHeapScanDescData heapdesc;
+} GinShared;
+
+/*
+ * Status for leader in parallel GIN index build.
+ */
+typedef struct GinLeader {
+    /* parallel context itself */
+    ParallelContext *pcxt;
+
+    /* number of workers launched, plus the leader itself */
+    int nparticipanttuplesorts;
+
+    /* convenience pointers to shared state, and the snapshot of the scan */
+    GinShared *ginshared;
+    SharedSort *sharedsort;
+    Snapshot snapshot;
+} GinLeader;
+
 typedef struct {
     GinState ginstate;
     double indtuples;
@@ -40,8 +95,19 @@ typedef struct {
     MemoryContext tmpCtx;
     MemoryContext funcCtx;
     BuildAccumulator accum;
+    uint64 accumMaxMem;       /* dump the accumulator once it uses this much */
+    Tuplesortstate* sortstate; /* partial sort of a parallel participant, or NULL */
+    GinLeader* ginleader;     /* set in the leader of a parallel build */
 } GinBuildState;
 
+static void _gin_begin_parallel(GinBuildState* buildstate, Relation heap, Relation index, bool isconcurrent,
+    int request, void* meminfo);
+static void _gin_end_parallel(GinLeader* ginleader);
+static Size _gin_parallel_estimate_shared(Snapshot snapshot);
+static double _gin_parallel_merge(GinBuildState* buildstate, bool* brokenhotchain, void* meminfo);
+static void _gin_parallel_scan_and_sort(GinBuildState* buildstate, Relation heap, Relation index,
+    GinShared* ginshared, SharedSort* sharedsort, void* meminfo, int nWorkers);
+
 /*
  * Adds array of item pointers to tuple's posting list, or
  * creates posting tree and tuple pointing to tree in case
@@ -242,10 +308,42 @@ static void ginHeapTupleBulkInsert(
     MemoryContextReset(buildstate->funcCtx);
 }
 
+/*
+ * Put the TIDs of a key into the partial sort of a parallel participant.
+ *
+ * The TIDs are split into as many tuples as needed for each of them to
+ * fit GinMaxItemSize, like a posting list on an entry page.
+ */
+static void ginSpoolEntry(GinBuildState* buildstate, OffsetNumber attnum, Datum key, GinNullCategory category,
+    ItemPointerData* items, uint32 nitems)
+{
+    IndexTuple itup;
+    int maxsize;
+
+    /* Find the room left for the posting list, failing if the key is too big */
+    itup = GinFormTuple(&buildstate->ginstate, attnum, key, category, NULL, 0, 0, true);
+    maxsize = Max((int)(GinMaxItemSize - GinGetPostingOffset(itup)), (int)(offsetof(GinPostingList, bytes) + 2));
+    pfree(itup);
+
+    while (nitems > 0) {
+        int nwritten = 0;
+        GinPostingList* list = ginCompressPostingList(items, nitems, maxsize, &nwritten, false);
+
+        itup = GinFormTuple(&buildstate->ginstate, attnum, key, category, (char*)list, SizeOfGinPostingList(list),
+            nwritten, true);
+        tuplesort_putgintuple(buildstate->sortstate, itup);
+        pfree(itup);
+        pfree(list);
+
+        items += nwritten;
+        nitems -= nwritten;
+    }
+}
+
 static void dumpToIndex(GinBuildState* buildstate)
 {
     /* If we've maxed out our available memory, dump everything to the index */
-    if (buildstate->accum.allocatedMemory >= (uint)u_sess->attr.attr_memory.maintenance_work_mem * 1024UL) {
+    if (buildstate->accum.allocatedMemory >= buildstate->accumMaxMem) {
         ItemPointerData* list = NULL;
         Datum key;
         GinNullCategory category;
@@ -256,7 +354,12 @@ static void dumpToIndex(GinBuildState* buildstate)
         while ((list = ginGetBAEntry(&buildstate->accum, &attnum, &key, &category, &nlist)) != NULL) {
             /* there could be many entries, so be willing to abort here */
             CHECK_FOR_INTERRUPTS();
-            ginEntryInsert(&buildstate->ginstate, attnum, key, category, list, nlist, &buildstate->buildStats);
+            /* a parallel participant leaves the index to the leader */
+            if (buildstate->sortstate != NULL) {
+                ginSpoolEntry(buildstate, attnum, key, category, list, nlist);
+            } else {
+                ginEntryInsert(&buildstate->ginstate, attnum, key, category, list, nlist, &buildstate->buildStats);
+            }
         }
 
         MemoryContextReset(buildstate->tmpCtx);
@@ -299,21 +402,57 @@ static void cginBuildCallback(Relation index, ItemPointer tid, Datum* values, co
     MemoryContextSwitchTo(oldCtx);
 }
 
+/*
+ * Initialize the working state of a build, without touching the index
+ */
+static void initBuildState(Relation index, GinBuildState* buildstate)
+{
+    errno_t ret = EOK;
+
+    initGinState(&buildstate->ginstate, index);
+    buildstate->indtuples = 0;
+    ret = memset_s(&buildstate->buildStats, sizeof(GinStatsData), 0, sizeof(GinStatsData));
+    securec_check(ret, "", "");
+
+    /*
+     * create a temporary memory context that is used to hold data not yet
+     * dumped out to the index
+     */
+    buildstate->tmpCtx = AllocSetContextCreate(CurrentMemoryContext,
+        "Gin build temporary context",
+        ALLOCSET_DEFAULT_MINSIZE,
+        ALLOCSET_DEFAULT_INITSIZE,
+        ALLOCSET_DEFAULT_MAXSIZE);
+
+    /*
+     * create a temporary memory context that is used for calling
+     * ginExtractEntries(), and can be reset after each tuple
+     */
+    buildstate->funcCtx = AllocSetContextCreate(CurrentMemoryContext,
+        "Gin build temporary context for user-defined function",
+        ALLOCSET_DEFAULT_MINSIZE,
+        ALLOCSET_DEFAULT_INITSIZE,
+        ALLOCSET_DEFAULT_MAXSIZE);
+
+    buildstate->accum.ginstate = &buildstate->ginstate;
+    buildstate->accumMaxMem = (uint64)(uint)u_sess->attr.attr_memory.maintenance_work_mem * 1024UL;
+    buildstate->sortstate = NULL;
+    buildstate->ginleader = NULL;
+
+    ginInitBA(&buildstate->accum);
+}
+
 static void buildInitialize(Relation index, GinBuildState* buildstate)
 {
     Buffer RootBuffer;
     Buffer MetaBuffer;
-    errno_t ret = EOK;
 
     if (RelationGetNumberOfBlocks(index) != 0)
         ereport(ERROR,
             (errcode(ERRCODE_INDEX_CORRUPTED),
                 errmsg("index \"%s\" already contains data", RelationGetRelationName(index))));
 
-    initGinState(&buildstate->ginstate, index);
-    buildstate->indtuples = 0;
-    ret = memset_s(&buildstate->buildStats, sizeof(GinStatsData), 0, sizeof(GinStatsData));
-    securec_check(ret, "", "");
+    initBuildState(index, buildstate);
 
     /* initialize the meta page */
     MetaBuffer = GinNewBuffer(index);
@@ -350,30 +489,6 @@ static void buildInitialize(Relation index, GinBuildState* buildstate)
 
     /* count the root as first entry page */
     buildstate->buildStats.nEntryPages++;
-
-    /*
-     * create a temporary memory context that is used to hold data not yet
-     * dumped out to the index
-     */
-    buildstate->tmpCtx = AllocSetContextCreate(CurrentMemoryContext,
-        "Gin build temporary context",
-        ALLOCSET_DEFAULT_MINSIZE,
-        ALLOCSET_DEFAULT_INITSIZE,
-        ALLOCSET_DEFAULT_MAXSIZE);
-
-    /*
-     * create a temporary memory context that is used for calling
-     * ginExtractEntries(), and can be reset after each tuple
-     */
-    buildstate->funcCtx = AllocSetContextCreate(CurrentMemoryContext,
-        "Gin build temporary context for user-defined function",
-        ALLOCSET_DEFAULT_MINSIZE,
-        ALLOCSET_DEFAULT_INITSIZE,
-        ALLOCSET_DEFAULT_MAXSIZE);
-
-    buildstate->accum.ginstate = &buildstate->ginstate;
-
-    ginInitBA(&buildstate->accum);
 }
 
 Datum ginbuild(PG_FUNCTION_ARGS)
@@ -397,21 +512,32 @@ Datum ginbuild(PG_FUNCTION_ARGS)
 
     buildInitialize(index, &buildstate);
 
-    /*
-     * Do the heap scan.  We disallow sync scan here because dataPlaceToPage
-     * prefers to receive tuples in TID order.
-     */
-    reltuples = IndexBuildHeapScan(heap, index, indexInfo, false, ginBuildCallback, (void*)&buildstate, NULL);
+    /* Attempt to launch parallel worker scan when required */
+    if (indexInfo->ii_ParallelWorkers > 0) {
+        _gin_begin_parallel(&buildstate, heap, index, indexInfo->ii_Concurrent, indexInfo->ii_ParallelWorkers,
+            &indexInfo->ii_desc);
+    }
 
-    /* dump remaining entries to the index */
-    oldCtx = MemoryContextSwitchTo(buildstate.tmpCtx);
-    ginBeginBAScan(&buildstate.accum);
-    while ((list = ginGetBAEntry(&buildstate.accum, &attnum, &key, &category, &nlist)) != NULL) {
-        /* there could be many entries, so be willing to abort here */
-        CHECK_FOR_INTERRUPTS();
-        ginEntryInsert(&buildstate.ginstate, attnum, key, category, list, nlist, &buildstate.buildStats);
+    if (buildstate.ginleader != NULL) {
+        /* the heap has been scanned by the participants, merge their entries */
+        reltuples = _gin_parallel_merge(&buildstate, &indexInfo->ii_BrokenHotChain, &indexInfo->ii_desc);
+    } else {
+        /*
+         * Do the heap scan.  We disallow sync scan here because dataPlaceToPage
+         * prefers to receive tuples in TID order.
+         */
+        reltuples = IndexBuildHeapScan(heap, index, indexInfo, false, ginBuildCallback, (void*)&buildstate, NULL);
+
+        /* dump remaining entries to the index */
+        oldCtx = MemoryContextSwitchTo(buildstate.tmpCtx);
+        ginBeginBAScan(&buildstate.accum);
+        while ((list = ginGetBAEntry(&buildstate.accum, &attnum, &key, &category, &nlist)) != NULL) {
+            /* there could be many entries, so be willing to abort here */
+            CHECK_FOR_INTERRUPTS();
+            ginEntryInsert(&buildstate.ginstate, attnum, key, category, list, nlist, &buildstate.buildStats);
+        }
+        MemoryContextSwitchTo(oldCtx);
     }
-    MemoryContextSwitchTo(oldCtx);
 
     MemoryContextDelete(buildstate.funcCtx);
     MemoryContextDelete(buildstate.tmpCtx);
@@ -653,3 +779,399 @@ Datum ginmerge(PG_FUNCTION_ARGS)
 
     PG_RETURN_POINTER(result);
 }
+
+/*
+ * Create parallel context, and launch workers for leader.
+ *
+ * Sets buildstate's GinLeader, which caller must use to shut down parallel
+ * mode.  If not even a single worker process can be launched, this is never
+ * set, and caller should proceed with a serial index build.
+ */
+static void _gin_begin_parallel(GinBuildState* buildstate, Relation heap, Relation index, bool isconcurrent,
+    int request, void* meminfo)
+{
+    Snapshot snapshot = NULL;
+    Size pscanLen = offsetof(ParallelHeapScanDescData, phs_snapshot_data);
+
+    /*
+     * Enter parallel mode, and create context for parallel build of gin
+     * index.  The leader always participates as a worker.
+     */
+    EnterParallelMode();
+    Assert(request > 0);
+    ParallelContext *pcxt = CreateParallelContext("postgres", "_gin_parallel_build_main", request);
+    int scantuplesortstates = request + 1;
+
+    /*
+     * Prepare for scan of the base relation, see _bt_begin_parallel for the
+     * choice of snapshot.
+     */
+    if (!isconcurrent) {
+        snapshot = SnapshotAny;
+    } else {
+        snapshot = RegisterSnapshot(GetTransactionSnapshot());
+        pscanLen += EstimateSnapshotSpace(snapshot);
+    }
+
+    Size estginshared = _gin_parallel_estimate_shared(snapshot);
+    Size estsort = tuplesort_estimate_shared(scantuplesortstates);
+
+    InitializeParallelDSM(pcxt, snapshot);
+
+    /* If no worker was available, back out (do serial build) */
+    if (pcxt->nworkers == 0) {
+        if (IsMVCCSnapshot(snapshot)) {
+            UnregisterSnapshot(snapshot);
+        }
+        DestroyParallelContext(pcxt);
+        ExitParallelMode();
+        return;
+    }
+
+    knl_u_parallel_context *cxt = (knl_u_parallel_context *)pcxt->seg;
+    MemoryContext oldcontext = MemoryContextSwitchTo(cxt->memCtx);
+
+    /* Store shared build state, for which we reserved space */
+    GinShared *ginshared = (GinShared *)palloc(estginshared);
+    ginshared->heaprelid = RelationGetRelid(heap);
+    ginshared->indexrelid = RelationGetRelid(index);
+    ginshared->isconcurrent = isconcurrent;
+    ginshared->scantuplesortstates = scantuplesortstates;
+    (void)pthread_cond_init(&ginshared->workersdonecv, NULL);
+    (void)pthread_mutex_init(&ginshared->mtx, NULL);
+    SpinLockInit(&ginshared->mutex);
+    ginshared->nparticipantsdone = 0;
+    ginshared->reltuples = 0.0;
+    ginshared->indtuples = 0.0;
+    ginshared->brokenhotchain = false;
+    heap_parallelscan_initialize(&ginshared->heapdesc, pscanLen, heap, snapshot);
+
+    SharedSort *sharedsort = (SharedSort *)palloc(estsort);
+    tuplesort_initialize_shared(sharedsort, scantuplesortstates, pcxt->seg);
+
+    /* Launch workers, saving status for leader/caller */
+    LaunchParallelWorkers(pcxt);
+    GinLeader *ginleader = (GinLeader *)palloc0(sizeof(GinLeader));
+    ginleader->pcxt = pcxt;
+    ginleader->nparticipanttuplesorts = pcxt->nworkers_launched + 1;
+    ginleader->ginshared = ginshared;
+    ginleader->sharedsort = sharedsort;
+    ginleader->snapshot = snapshot;
+
+    UtilityDesc *sharedMemInfo = (UtilityDesc *)palloc(sizeof(UtilityDesc));
+    int rc = memcpy_s(sharedMemInfo, sizeof(UtilityDesc), meminfo, sizeof(UtilityDesc));
+    securec_check(rc, "", "");
+
+    cxt->pwCtx->ginInfo.ginShared = ginshared;
+    cxt->pwCtx->ginInfo.sharedSort = sharedsort;
+    cxt->pwCtx->ginInfo.meminfo = sharedMemInfo;
+    Size querylen = strlen(t_thrd.postgres_cxt.debug_query_string);
+    cxt->pwCtx->ginInfo.queryText = (char *)palloc(querylen + 1);
+    rc = memcpy_s(cxt->pwCtx->ginInfo.queryText, querylen + 1, t_thrd.postgres_cxt.debug_query_string, querylen + 1);
+    securec_check(rc, "", "");
+
+    (void)MemoryContextSwitchTo(oldcontext);
+
+    /* If no workers were successfully launched, back out (do serial build) */
+    if (pcxt->nworkers_launched == 0) {
+        _gin_end_parallel(ginleader);
+        return;
+    }
+
+    t_thrd.subrole = BACKGROUND_LEADER;
+
+    /* Save leader state now that it's clear build will be parallel */
+    buildstate->ginleader = ginleader;
+
+    /* Join heap scan ourselves, with a working state of our own */
+    GinBuildState leaderworker;
+    initBuildState(index, &leaderworker);
+    _gin_parallel_scan_and_sort(&leaderworker, heap, index, ginshared, sharedsort, meminfo,
+        ginleader->nparticipanttuplesorts);
+    MemoryContextDelete(leaderworker.funcCtx);
+    MemoryContextDelete(leaderworker.tmpCtx);
+
+    /*
+     * Caller needs to wait for all launched workers when we return.  Make
+     * sure that the failure-to-start case will not hang forever.
+     */
+    WaitForParallelWorkersToAttach(pcxt);
+}
+
+/*
+ * Shut down workers, destroy parallel context, and end parallel mode.
+ */
+static void _gin_end_parallel(GinLeader* ginleader)
+{
+    WaitForParallelWorkersToFinish(ginleader->pcxt);
+    if (IsMVCCSnapshot(ginleader->snapshot)) {
+        UnregisterSnapshot(ginleader->snapshot);
+    }
+    DestroyParallelContext(ginleader->pcxt);
+    ExitParallelMode();
+}
+
+/*
+ * Returns size of shared memory required to store state for a parallel
+ * gin index build based on the snapshot its parallel scan will use.
+ */
+static Size _gin_parallel_estimate_shared(Snapshot snapshot)
+{
+    if (!IsMVCCSnapshot(snapshot)) {
+        Assert(snapshot == SnapshotAny);
+        return sizeof(GinShared);
+    }
+
+    return add_size(offsetof(GinShared, heapdesc) + offsetof(ParallelHeapScanDescData, phs_snapshot_data),
+        EstimateSnapshotSpace(snapshot));
+}
+
+static int qsortCompareItemPointers(const void* a, const void* b)
+{
+    return ginCompareItemPointers((ItemPointer)a, (ItemPointer)b);
+}
+
+/*
+ * Insert the TIDs collected for a key by _gin_parallel_merge
+ */
+static void ginFlushMergedEntry(GinBuildState* buildstate, IndexTuple keytup, ItemPointerData* items, uint32 nitems,
+    bool sorted)
+{
+    OffsetNumber attnum = gintuple_get_attrnum(&buildstate->ginstate, keytup);
+    GinNullCategory category;
+    Datum key = gintuple_get_key(&buildstate->ginstate, keytup, &category);
+
+    /* the lists of different participants may interleave */
+    if (!sorted) {
+        qsort(items, nitems, sizeof(ItemPointerData), qsortCompareItemPointers);
+    }
+    ginEntryInsert(&buildstate->ginstate, attnum, key, category, items, nitems, &buildstate->buildStats);
+}
+
+/*
+ * Within leader, wait for end of heap scan, then merge the sorted runs of
+ * all participants into the index.
+ *
+ * The tuples come out ordered by key, and for each key by their first TID,
+ * so the TIDs of a key are collected and inserted at once, unless there are
+ * more of them than fit in the sort memory.
+ *
+ * Returns the total number of heap tuples scanned.
+ */
+static double _gin_parallel_merge(GinBuildState* buildstate, bool* brokenhotchain, void* meminfo)
+{
+    GinLeader *ginleader = buildstate->ginleader;
+    GinShared *ginshared = ginleader->ginshared;
+    UtilityDesc *desc = (UtilityDesc *)meminfo;
+    int sortmem = (desc->query_mem[0] > 0) ? desc->query_mem[0] : u_sess->attr.attr_memory.maintenance_work_mem;
+    double reltuples;
+    WLMContextLock ginLock(&ginshared->mtx);
+
+    for (;;) {
+        SpinLockAcquire(&ginshared->mutex);
+        if (ginshared->nparticipantsdone == ginleader->nparticipanttuplesorts) {
+            buildstate->indtuples = ginshared->indtuples;
+            if (ginshared->brokenhotchain) {
+                *brokenhotchain = true;
+            }
+            reltuples = ginshared->reltuples;
+            SpinLockRelease(&ginshared->mutex);
+            break;
+        }
+        SpinLockRelease(&ginshared->mutex);
+
+        /* time out in case a worker exits on error, and take its message */
+        ginLock.Lock();
+        ginLock.ConditionTimedWait(&ginshared->workersdonecv, GIN_SCAN_WAIT_TIME);
+        ginLock.UnLock();
+        CHECK_FOR_INTERRUPTS();
+    }
+
+    /* Take over the runs of the participants, and merge them */
+    SortCoordinate coordinate = (SortCoordinate)palloc0(sizeof(SortCoordinateData));
+    coordinate->isWorker = false;
+    coordinate->nParticipants = ginleader->nparticipanttuplesorts;
+    coordinate->sharedsort = ginleader->sharedsort;
+    Tuplesortstate *sortstate = tuplesort_begin_index_gin(buildstate->ginstate.index, &buildstate->ginstate, sortmem,
+        coordinate, false, desc->query_mem[1]);
+    tuplesort_performsort(sortstate);
+
+    uint32 maxitems = (uint32)Min((uint64)sortmem * 1024L, (uint64)MaxAllocSize) / sizeof(ItemPointerData);
+    uint32 nalloc = 1024;
+    ItemPointerData *items = (ItemPointerData *)palloc(nalloc * sizeof(ItemPointerData));
+    uint32 nitems = 0;
+    bool sorted = true;
+    IndexTuple keytup = NULL;
+    IndexTuple itup;
+    bool should_free = false;
+
+    while ((itup = tuplesort_getindextuple(sortstate, true, &should_free)) != NULL) {
+        OffsetNumber attnum = gintuple_get_attrnum(&buildstate->ginstate, itup);
+        GinNullCategory category;
+        Datum key = gintuple_get_key(&buildstate->ginstate, itup, &category);
+        int nlist;
+        ItemPointer list;
+
+        /* there could be many entries, so be willing to abort here */
+        CHECK_FOR_INTERRUPTS();
+
+        if (keytup != NULL) {
+            GinNullCategory curcategory;
+            Datum curkey = gintuple_get_key(&buildstate->ginstate, keytup, &curcategory);
+
+            if (nitems >= maxitems || ginCompareAttEntries(&buildstate->ginstate,
+                gintuple_get_attrnum(&buildstate->ginstate, keytup), curkey, curcategory,
+                attnum, key, category) != 0) {
+                ginFlushMergedEntry(buildstate, keytup, items, nitems, sorted);
+                pfree(keytup);
+                keytup = NULL;
+                nitems = 0;
+                sorted = true;
+            }
+        }
+        if (keytup == NULL) {
+            keytup = CopyIndexTuple(itup);
+        }
+
+        list = ginReadTuple(&buildstate->ginstate, attnum, itup, &nlist);
+        if (nitems + (uint32)nlist > nalloc) {
+            while (nitems + (uint32)nlist > nalloc) {
+                nalloc *= 2;
+            }
+            items = (ItemPointerData *)repalloc(items, nalloc * sizeof(ItemPointerData));
+        }
+        if (nitems > 0 && nlist > 0 && ginCompareItemPointers(&items[nitems - 1], &list[0]) >= 0) {
+            sorted = false;
+        }
+        errno_t rc = memcpy_s(&items[nitems], (nalloc - nitems) * sizeof(ItemPointerData), list,
+            nlist * sizeof(ItemPointerData));
+        securec_check(rc, "", "");
+        nitems += (uint32)nlist;
+        pfree(list);
+
+        if (should_free) {
+            pfree(itup);
+        }
+    }
+    if (keytup != NULL) {
+        ginFlushMergedEntry(buildstate, keytup, items, nitems, sorted);
+        pfree(keytup);
+    }
+    pfree(items);
+
+    tuplesort_end(sortstate);
+    _gin_end_parallel(ginleader);
+    buildstate->ginleader = NULL;
+
+    return reltuples;
+}
+
+/*
+ * Perform work within a launched parallel process.
+ */
+void _gin_parallel_build_main(void* seg)
+{
+    LOCKMODE heapLockmode;
+    LOCKMODE indexLockmode;
+    GinBuildState buildstate;
+    knl_u_parallel_context *cxt = (knl_u_parallel_context *)seg;
+
+    /* Set debug_query_string for individual workers first */
+    t_thrd.postgres_cxt.debug_query_string = cxt->pwCtx->ginInfo.queryText;
+
+    /* Report the query string from leader */
+    pgstat_report_activity(STATE_RUNNING, t_thrd.postgres_cxt.debug_query_string);
+
+    GinShared *ginshared = cxt->pwCtx->ginInfo.ginShared;
+
+    /* Open relations using lock modes known to be obtained by index.c */
+    if (!ginshared->isconcurrent) {
+        heapLockmode = ShareLock;
+        indexLockmode = AccessExclusiveLock;
+    } else {
+        heapLockmode = ShareUpdateExclusiveLock;
+        indexLockmode = RowExclusiveLock;
+    }
+
+    Relation heapRel = heap_open(ginshared->heaprelid, heapLockmode);
+    Relation indexRel = index_open(ginshared->indexrelid, indexLockmode);
+
+    initBuildState(indexRel, &buildstate);
+    _gin_parallel_scan_and_sort(&buildstate, heapRel, indexRel, ginshared, cxt->pwCtx->ginInfo.sharedSort,
+        cxt->pwCtx->ginInfo.meminfo, ginshared->scantuplesortstates);
+    MemoryContextDelete(buildstate.funcCtx);
+    MemoryContextDelete(buildstate.tmpCtx);
+
+    index_close(indexRel, indexLockmode);
+    heap_close(heapRel, heapLockmode);
+}
+
+/*
+ * Perform a worker's portion of a parallel build.
+ *
+ * The entries are accumulated with ginbulk as in a serial build, but each
+ * time the accumulator fills up, its entries go into the partial sort of the
+ * participant instead of the index.  Each participant receives an even share
+ * of the sort memory, half of which is used by the accumulator.  When this
+ * returns, the participant is done, and need only release resources.
+ */
+static void _gin_parallel_scan_and_sort(GinBuildState* buildstate, Relation heap, Relation index,
+    GinShared* ginshared, SharedSort* sharedsort, void* meminfo, int nWorkers)
+{
+    UtilityDesc *desc = (UtilityDesc *)meminfo;
+    int sortmem = (desc->query_mem[0] > 0) ? desc->query_mem[0] : u_sess->attr.attr_memory.maintenance_work_mem;
+    ItemPointerData* list = NULL;
+    Datum key;
+    GinNullCategory category;
+    uint32 nlist;
+    OffsetNumber attnum;
+
+    /* Initialize local tuplesort coordination state */
+    SortCoordinate coordinate = (SortCoordinate)palloc0(sizeof(SortCoordinateData));
+    coordinate->isWorker = true;
+    coordinate->nParticipants = -1;
+    coordinate->sharedsort = sharedsort;
+
+    /* Begin "partial" tuplesort */
+    buildstate->sortstate = tuplesort_begin_index_gin(index, &buildstate->ginstate, sortmem / nWorkers / 2,
+        coordinate, false, desc->query_mem[1] / nWorkers / 2);
+    buildstate->accumMaxMem = (uint64)(uint)(sortmem / nWorkers / 2) * 1024UL;
+
+    /* Join parallel scan */
+    IndexInfo *indexInfo = BuildIndexInfo(index);
+    indexInfo->ii_Concurrent = ginshared->isconcurrent;
+    HeapScanDesc scan = heap_beginscan_parallel(heap, &ginshared->heapdesc);
+    double reltuples = IndexBuildHeapScan(heap, index, indexInfo, true, ginBuildCallback, (void *)buildstate, scan);
+
+    /* dump remaining entries to the sort */
+    MemoryContext oldCtx = MemoryContextSwitchTo(buildstate->tmpCtx);
+    ginBeginBAScan(&buildstate->accum);
+    while ((list = ginGetBAEntry(&buildstate->accum, &attnum, &key, &category, &nlist)) != NULL) {
+        CHECK_FOR_INTERRUPTS();
+        ginSpoolEntry(buildstate, attnum, key, category, list, nlist);
+    }
+    (void)MemoryContextSwitchTo(oldCtx);
+
+    /* Execute this worker's part of the sort */
+    tuplesort_performsort(buildstate->sortstate);
+
+    /* Done.  Record ambuild statistics */
+    SpinLockAcquire(&ginshared->mutex);
+    ginshared->nparticipantsdone++;
+    ginshared->reltuples += reltuples;
+    ginshared->indtuples += buildstate->indtuples;
+    if (indexInfo->ii_BrokenHotChain) {
+        ginshared->brokenhotchain = true;
+    }
+    SpinLockRelease(&ginshared->mutex);
+
+    /* Notify leader */
+    WLMContextLock ginLock(&ginshared->mtx);
+    ginLock.Lock();
+    ginLock.ConditionWakeUp(&ginshared->workersdonecv);
+    ginLock.UnLock();
+
+    /* We can end tuplesort immediately */
+    tuplesort_end(buildstate->sortstate);
+    buildstate->sortstate = NULL;
+}
@@ -78,17 +78,23 @@ Datum hashbuild(PG_FUNCTION_ARGS)
      *
      * NOTE: this test will need adjustment if a bucket is ever different from
      * one page.
+     *
+     * A parallel build always sorts, since the workers can only hand their
+     * tuples over to the leader through the sort.
      */
-    if (num_buckets >= (uint32)g_instance.attr.attr_storage.NBuffers)
-        buildstate.spool = _h_spoolinit(index, num_buckets, &indexInfo->ii_desc);
+    if (num_buckets >= (uint32)g_instance.attr.attr_storage.NBuffers || indexInfo->ii_ParallelWorkers > 0)
+        buildstate.spool = _h_spoolinit(heap, index, num_buckets, indexInfo);
     else
         buildstate.spool = NULL;
 
     /* prepare to build the index */
     buildstate.indtuples = 0;
 
-    /* do the heap scan */
-    reltuples = IndexBuildHeapScan(heap, index, indexInfo, true, hashbuildCallback, (void*)&buildstate, NULL);
+    /* do the heap scan, unless the parallel workers are already doing it */
+    if (buildstate.spool != NULL && _h_spool_is_parallel(buildstate.spool))
+        reltuples = _h_parallel_heapscan(buildstate.spool, &buildstate.indtuples, &indexInfo->ii_BrokenHotChain);
+    else
+        reltuples = IndexBuildHeapScan(heap, index, indexInfo, true, hashbuildCallback, (void*)&buildstate, NULL);
 
     if (buildstate.spool != NULL) {
         /* sort the tuples and insert them into the index */
@@ -13,6 +13,11 @@
  * hash code value.  That's no big problem though, since we'll still have
  * plenty of locality of access.
  *
+ * When parallel workers are requested for the build, the heap is scanned
+ * by the workers and the leader together, each of them feeding a partial
+ * tuplesort, and the leader merges the sorted runs while inserting the
+ * tuples into the index.  This is the same scheme as nbtsort.cpp uses.
+ *
  *
  * Portions Copyright (c) 2020 Huawei Technologies Co.,Ltd.
  * Portions Copyright (c) 1996-2012, PostgreSQL Global Development Group
@@ -27,29 +32,107 @@
 #include "knl/knl_variable.h"
 
 #include "access/hash.h"
+#include "access/parallel.h"
+#include "access/relscan.h"
+#include "access/xact.h"
+#include "catalog/index.h"
 #include "miscadmin.h"
 #include "nodes/execnodes.h"
+#include "pgstat.h"
+#include "utils/snapmgr.h"
+#include "utils/tqual.h"
 #include "utils/tuplesort.h"
 
+#define HASH_SCAN_WAIT_TIME 1 /* seconds, timeout for waiting end of heap scan */
+
+/*
+ * Status for hash index builds performed in parallel, shared by the leader
+ * and the workers.  See BTShared in nbtsort.cpp.
+ */
+typedef struct HashShared {
+    /* These fields are not modified during the build */
+    Oid heaprelid;
+    Oid indexrelid;
+    bool isconcurrent;
+    uint32 hash_mask;
+    int scantuplesortstates;
+
+    /* workersdonecv is signaled whenever a participant finishes its scan */
+    pthread_cond_t workersdonecv;
+    pthread_mutex_t mtx; /* mtx protects workersdonecv */
+
+    /* mutex protects all fields before heapdesc */
+    slock_t mutex;
+
+    /* Mutable state reported back to leader at end of the parallel scan */
+    int nparticipantsdone;
+    double reltuples;
+    double indtuples;
+    bool brokenhotchain;
+
+    /*
+     * This variable-sized field must come last.
+     *
+     * See _h_parallel_estimate_shared().
+     */
+    ParallelHeapScanDescData heapdesc;
+} HashShared;
+
+/*
+ * Status for leader in parallel hash index build.
+ */
+typedef struct HashLeader {
+    /* parallel context itself */
+    ParallelContext *pcxt;
+
+    /* number of workers launched, plus the leader itself */
+    int nparticipanttuplesorts;
+
+    /* convenience pointers to shared state, and the snapshot of the scan */
+    HashShared *hashshared;
+    SharedSort *sharedsort;
+    Snapshot snapshot;
+} HashLeader;
+
 /*
  * Status record for spooling/sorting phase.
  */
 struct HSpool {
     Tuplesortstate* sortstate; /* state data for tuplesort.c */
+    Relation heap;
     Relation index;
+    HashLeader* hashleader; /* NULL unless the heap is scanned in parallel */
 };
 
+/* Working state of a participant in a parallel build */
+typedef struct HashSpoolState {
+    HSpool* spool;
+    double indtuples; /* # tuples accepted into index */
+} HashSpoolState;
+
+static void _h_begin_parallel(HSpool* hspool, bool isconcurrent, int request, uint32 hash_mask, void* meminfo);
+static void _h_end_parallel(HashLeader* hashleader);
+static Size _h_parallel_estimate_shared(Snapshot snapshot);
+static void _h_parallel_scan_and_sort(HSpool* hspool, HashShared* hashshared, SharedSort* sharedsort,
+    void* meminfo, int nWorkers);
+
 /*
  * create and initialize a spool structure
+ *
+ * If parallel workers are requested, they are launched and start spooling
+ * the heap right away; the caller must then collect the results with
+ * _h_parallel_heapscan() instead of scanning the heap itself.
  */
-HSpool* _h_spoolinit(Relation index, uint32 num_buckets, void* meminfo)
+HSpool* _h_spoolinit(Relation heap, Relation index, uint32 num_buckets, IndexInfo* indexInfo)
 {
     HSpool* hspool = (HSpool*)palloc0(sizeof(HSpool));
     uint32 hash_mask;
-    UtilityDesc* desc = (UtilityDesc*)meminfo;
+    UtilityDesc* desc = &indexInfo->ii_desc;
     int work_mem = (desc->query_mem[0] > 0) ? desc->query_mem[0] : u_sess->attr.attr_memory.maintenance_work_mem;
     int max_mem = (desc->query_mem[1] > 0) ? desc->query_mem[1] : 0;
+    SortCoordinate coordinate = NULL;
 
+    hspool->heap = heap;
     hspool->index = index;
 
     /*
@@ -63,12 +146,28 @@ HSpool* _h_spoolinit(Relation index, uint32 num_buckets, void* meminfo)
      */
     hash_mask = (((uint32)1) << _hash_log2(num_buckets)) - 1;
 
+    /* Attempt to launch parallel worker scan when required */
+    if (indexInfo->ii_ParallelWorkers > 0) {
+        _h_begin_parallel(hspool, indexInfo->ii_Concurrent, indexInfo->ii_ParallelWorkers, hash_mask, desc);
+    }
+
+    /*
+     * If parallel build requested and at least one worker process was
+     * successfully launched, set up coordination state
+     */
+    if (hspool->hashleader != NULL) {
+        coordinate = (SortCoordinate)palloc0(sizeof(SortCoordinateData));
+        coordinate->isWorker = false;
+        coordinate->nParticipants = hspool->hashleader->nparticipanttuplesorts;
+        coordinate->sharedsort = hspool->hashleader->sharedsort;
+    }
+
     /*
      * We size the sort area as maintenance_work_mem rather than work_mem to
      * speed index creation.  This should be OK since a single backend can't
      * run multiple index creations in parallel.
      */
-    hspool->sortstate = tuplesort_begin_index_hash(index, hash_mask, work_mem, NULL, false, max_mem);
+    hspool->sortstate = tuplesort_begin_index_hash(index, hash_mask, work_mem, coordinate, false, max_mem);
 
     return hspool;
 }
@@ -79,6 +178,9 @@ HSpool* _h_spoolinit(Relation index, uint32 num_buckets, void* meminfo)
 void _h_spooldestroy(HSpool* hspool)
 {
     tuplesort_end(hspool->sortstate);
+    if (hspool->hashleader != NULL) {
+        _h_end_parallel(hspool->hashleader);
+    }
     pfree(hspool);
 }
 
@@ -90,6 +192,14 @@ void _h_spool(HSpool* hspool, ItemPointer self, Datum* values, const bool* isnul
     tuplesort_putindextuplevalues(hspool->sortstate, hspool->index, self, values, isnull);
 }
 
+/*
+ * is the heap being spooled by parallel workers?
+ */
+bool _h_spool_is_parallel(const HSpool* hspool)
+{
+    return hspool->hashleader != NULL;
+}
+
 /*
  * given a spool loaded by successive calls to _h_spool,
  * create an entire index.
@@ -107,3 +217,297 @@ void _h_indexbuild(HSpool* hspool)
             pfree(itup);
     }
 }
+
+/*
+ * Per-tuple callback from IndexBuildHeapScan in a parallel build
+ */
+static void _h_build_callback(
+    Relation index, HeapTuple htup, Datum* values, const bool* isnull, bool tupleIsAlive, void* state)
+{
+    HashSpoolState* spoolstate = (HashSpoolState*)state;
+
+    /* Hash indexes don't index nulls, see notes in hashinsert */
+    if (isnull[0]) {
+        return;
+    }
+
+    _h_spool(spoolstate->spool, &htup->t_self, values, isnull);
+    spoolstate->indtuples += 1;
+}
+
+/*
+ * Create parallel context, and launch workers for leader.
+ *
+ * Sets hspool's HashLeader, which _h_spooldestroy() uses to shut down
+ * parallel mode.  If not even a single worker process can be launched, this
+ * is never set, and caller should proceed with a serial heap scan.
+ */
+static void _h_begin_parallel(HSpool* hspool, bool isconcurrent, int request, uint32 hash_mask, void* meminfo)
+{
+    Snapshot snapshot = NULL;
+    Size pscanLen = offsetof(ParallelHeapScanDescData, phs_snapshot_data);
+
+    /*
+     * Enter parallel mode, and create context for parallel build of hash
+     * index.  The leader always participates as a worker.
+     */
+    EnterParallelMode();
+    Assert(request > 0);
+    ParallelContext *pcxt = CreateParallelContext("postgres", "_h_parallel_build_main", request);
+    int scantuplesortstates = request + 1;
+
+    /*
+     * Prepare for scan of the base relation, see _bt_begin_parallel for the
+     * choice of snapshot.
+     */
+    if (!isconcurrent) {
+        snapshot = SnapshotAny;
+    } else {
+        snapshot = RegisterSnapshot(GetTransactionSnapshot());
+        pscanLen += EstimateSnapshotSpace(snapshot);
+    }
+
+    Size esthashshared = _h_parallel_estimate_shared(snapshot);
+    Size estsort = tuplesort_estimate_shared(scantuplesortstates);
+
+    InitializeParallelDSM(pcxt, snapshot);
+
+    /* If no worker was available, back out (do serial build) */
+    if (pcxt->nworkers == 0) {
+        if (IsMVCCSnapshot(snapshot)) {
+            UnregisterSnapshot(snapshot);
+        }
+        DestroyParallelContext(pcxt);
+        ExitParallelMode();
+        return;
+    }
+
+    knl_u_parallel_context *cxt = (knl_u_parallel_context *)pcxt->seg;
+    MemoryContext oldcontext = MemoryContextSwitchTo(cxt->memCtx);
+
+    /* Store shared build state, for which we reserved space */
+    HashShared *hashshared = (HashShared *)palloc(esthashshared);
+    hashshared->heaprelid = RelationGetRelid(hspool->heap);
+    hashshared->indexrelid = RelationGetRelid(hspool->index);
+    hashshared->isconcurrent = isconcurrent;
+    hashshared->hash_mask = hash_mask;
+    hashshared->scantuplesortstates = scantuplesortstates;
+    (void)pthread_cond_init(&hashshared->workersdonecv, NULL);
+    (void)pthread_mutex_init(&hashshared->mtx, NULL);
+    SpinLockInit(&hashshared->mutex);
+    hashshared->nparticipantsdone = 0;
+    hashshared->reltuples = 0.0;
+    hashshared->indtuples = 0.0;
+    hashshared->brokenhotchain = false;
+    heap_parallelscan_initialize(&hashshared->heapdesc, pscanLen, hspool->heap, snapshot);
+
+    SharedSort *sharedsort = (SharedSort *)palloc(estsort);
+    tuplesort_initialize_shared(sharedsort, scantuplesortstates, pcxt->seg);
+
+    /* Launch workers, saving status for leader/caller */
+    LaunchParallelWorkers(pcxt);
+    HashLeader *hashleader = (HashLeader *)palloc0(sizeof(HashLeader));
+    hashleader->pcxt = pcxt;
+    hashleader->nparticipanttuplesorts = pcxt->nworkers_launched + 1;
+    hashleader->hashshared = hashshared;
+    hashleader->sharedsort = sharedsort;
+    hashleader->snapshot = snapshot;
+
+    UtilityDesc *sharedMemInfo = (UtilityDesc *)palloc(sizeof(UtilityDesc));
+    int rc = memcpy_s(sharedMemInfo, sizeof(UtilityDesc), meminfo, sizeof(UtilityDesc));
+    securec_check(rc, "", "");
+
+    cxt->pwCtx->hashInfo.hashShared = hashshared;
+    cxt->pwCtx->hashInfo.sharedSort = sharedsort;
+    cxt->pwCtx->hashInfo.meminfo = sharedMemInfo;
+    Size querylen = strlen(t_thrd.postgres_cxt.debug_query_string);
+    cxt->pwCtx->hashInfo.queryText = (char *)palloc(querylen + 1);
+    rc = memcpy_s(cxt->pwCtx->hashInfo.queryText, querylen + 1, t_thrd.postgres_cxt.debug_query_string, querylen + 1);
+    securec_check(rc, "", "");
+
+    (void)MemoryContextSwitchTo(oldcontext);
+
+    /* If no workers were successfully launched, back out (do serial build) */
+    if (pcxt->nworkers_launched == 0) {
+        _h_end_parallel(hashleader);
+        return;
+    }
+
+    t_thrd.subrole = BACKGROUND_LEADER;
+
+    /* Save leader state now that it's clear build will be parallel */
+    hspool->hashleader = hashleader;
+
+    /* Join heap scan ourselves */
+    HSpool *leaderworker = (HSpool *)palloc0(sizeof(HSpool));
+    leaderworker->heap = hspool->heap;
+    leaderworker->index = hspool->index;
+    _h_parallel_scan_and_sort(leaderworker, hashshared, sharedsort, meminfo, hashleader->nparticipanttuplesorts);
+
+    /*
+     * Caller needs to wait for all launched workers when we return.  Make
+     * sure that the failure-to-start case will not hang forever.
+     */
+    WaitForParallelWorkersToAttach(pcxt);
+}
+
+/*
+ * Shut down workers, destroy parallel context, and end parallel mode.
+ */
+static void _h_end_parallel(HashLeader* hashleader)
+{
+    WaitForParallelWorkersToFinish(hashleader->pcxt);
+    if (IsMVCCSnapshot(hashleader->snapshot)) {
+        UnregisterSnapshot(hashleader->snapshot);
+    }
+    DestroyParallelContext(hashleader->pcxt);
+    ExitParallelMode();
+}
+
+/*
+ * Returns size of shared memory required to store state for a parallel
+ * hash index build based on the snapshot its parallel scan will use.
+ */
+static Size _h_parallel_estimate_shared(Snapshot snapshot)
+{
+    if (!IsMVCCSnapshot(snapshot)) {
+        Assert(snapshot == SnapshotAny);
+        return sizeof(HashShared);
+    }
+
+    return add_size(offsetof(HashShared, heapdesc) + offsetof(ParallelHeapScanDescData, phs_snapshot_data),
+        EstimateSnapshotSpace(snapshot));
+}
+
+/*
+ * Within leader, wait for end of heap scan.
+ *
+ * Returns the total number of heap tuples scanned, and sets the number of
+ * tuples spooled and whether some participant saw a broken HOT chain.
+ */
+double _h_parallel_heapscan(HSpool* hspool, double* indtuples, bool* brokenhotchain)
+{
+    HashShared *hashshared = hspool->hashleader->hashshared;
+    int nparticipanttuplesorts = hspool->hashleader->nparticipanttuplesorts;
+    double reltuples;
+    WLMContextLock hashLock(&hashshared->mtx);
+
+    for (;;) {
+        SpinLockAcquire(&hashshared->mutex);
+        if (hashshared->nparticipantsdone == nparticipanttuplesorts) {
+            *indtuples = hashshared->indtuples;
+            if (hashshared->brokenhotchain) {
+                *brokenhotchain = true;
+            }
+            reltuples = hashshared->reltuples;
+            SpinLockRelease(&hashshared->mutex);
+            break;
+        }
+        SpinLockRelease(&hashshared->mutex);
+
+        /* time out in case a worker exits on error, and take its message */
+        hashLock.Lock();
+        hashLock.ConditionTimedWait(&hashshared->workersdonecv, HASH_SCAN_WAIT_TIME);
+        hashLock.UnLock();
+        CHECK_FOR_INTERRUPTS();
+    }
+
+    return reltuples;
+}
+
+/*
+ * Perform work within a launched parallel process.
+ */
+void _h_parallel_build_main(void* seg)
+{
+    LOCKMODE heapLockmode;
+    LOCKMODE indexLockmode;
+    knl_u_parallel_context *cxt = (knl_u_parallel_context *)seg;
+
+    /* Set debug_query_string for individual workers first */
+    t_thrd.postgres_cxt.debug_query_string = cxt->pwCtx->hashInfo.queryText;
+
+    /* Report the query string from leader */
+    pgstat_report_activity(STATE_RUNNING, t_thrd.postgres_cxt.debug_query_string);
+
+    HashShared *hashshared = cxt->pwCtx->hashInfo.hashShared;
+
+    /* Open relations using lock modes known to be obtained by index.c */
+    if (!hashshared->isconcurrent) {
+        heapLockmode = ShareLock;
+        indexLockmode = AccessExclusiveLock;
+    } else {
+        heapLockmode = ShareUpdateExclusiveLock;
+        indexLockmode = RowExclusiveLock;
+    }
+
+    Relation heapRel = heap_open(hashshared->heaprelid, heapLockmode);
+    Relation indexRel = index_open(hashshared->indexrelid, indexLockmode);
+
+    /* Initialize worker's own spool */
+    HSpool *hspool = (HSpool *)palloc0(sizeof(HSpool));
+    hspool->heap = heapRel;
+    hspool->index = indexRel;
+
+    _h_parallel_scan_and_sort(hspool, hashshared, cxt->pwCtx->hashInfo.sharedSort, cxt->pwCtx->hashInfo.meminfo,
+        hashshared->scantuplesortstates);
+
+    index_close(indexRel, indexLockmode);
+    heap_close(heapRel, heapLockmode);
+}
+
+/*
+ * Perform a worker's portion of a parallel sort.
+ *
+ * Each participant receives an even share of the sort memory.  When this
+ * returns, the participant is done, and need only release resources.
+ */
+static void _h_parallel_scan_and_sort(HSpool* hspool, HashShared* hashshared, SharedSort* sharedsort,
+    void* meminfo, int nWorkers)
+{
+    HashSpoolState spoolstate;
+    UtilityDesc *desc = (UtilityDesc *)meminfo;
+    int sortmem = (desc->query_mem[0] > 0) ? desc->query_mem[0] : u_sess->attr.attr_memory.maintenance_work_mem;
+
+    /* Initialize local tuplesort coordination state */
+    SortCoordinate coordinate = (SortCoordinate)palloc0(sizeof(SortCoordinateData));
+    coordinate->isWorker = true;
+    coordinate->nParticipants = -1;
+    coordinate->sharedsort = sharedsort;
+
+    /* Begin "partial" tuplesort */
+    hspool->sortstate = tuplesort_begin_index_hash(hspool->index, hashshared->hash_mask, sortmem / nWorkers,
+        coordinate, false, desc->query_mem[1] / nWorkers);
+
+    spoolstate.spool = hspool;
+    spoolstate.indtuples = 0;
+
+    /* Join parallel scan */
+    IndexInfo *indexInfo = BuildIndexInfo(hspool->index);
+    indexInfo->ii_Concurrent = hashshared->isconcurrent;
+    HeapScanDesc scan = heap_beginscan_parallel(hspool->heap, &hashshared->heapdesc);
+    double reltuples = IndexBuildHeapScan(hspool->heap, hspool->index, indexInfo, true, _h_build_callback,
+        (void *)&spoolstate, scan);
+
+    /* Execute this worker's part of the sort */
+    tuplesort_performsort(hspool->sortstate);
+
+    /* Done.  Record ambuild statistics */
+    SpinLockAcquire(&hashshared->mutex);
+    hashshared->nparticipantsdone++;
+    hashshared->reltuples += reltuples;
+    hashshared->indtuples += spoolstate.indtuples;
+    if (indexInfo->ii_BrokenHotChain) {
+        hashshared->brokenhotchain = true;
+    }
+    SpinLockRelease(&hashshared->mutex);
+
+    /* Notify leader */
+    WLMContextLock hashLock(&hashshared->mtx);
+    hashLock.Lock();
+    hashLock.ConditionWakeUp(&hashshared->workersdonecv);
+    hashLock.UnLock();
+
+    /* We can end tuplesort immediately */
+    tuplesort_end(hspool->sortstate);
+}
@@ -2243,6 +2243,20 @@ bool heap_fetch(
     return false;
 }
 
+/*
+ * Count a HOT chain of chain_len members walked by heap_hot_search_buffer,
+ * and have its page pruned if the chain is long.
+ */
+static inline void heap_hot_search_count_chain(Relation relation, Buffer buffer, int chain_len)
+{
+    pgstat_count_hot_chain(relation, chain_len);
+
+    if (u_sess->attr.attr_storage.hot_chain_prune_threshold > 0 &&
+        chain_len >= u_sess->attr.attr_storage.hot_chain_prune_threshold) {
+        heap_page_note_hot_chain(relation, buffer);
+    }
+}
+
 /*
  *	heap_hot_search_buffer	- search HOT chain for tuple satisfying snapshot
  *
@@ -2263,6 +2277,8 @@ bool heap_fetch(
  * Unlike heap_fetch, the caller must already have pin and (at least) share
  * lock on the buffer; it is still pinned/locked at exit.  Also unlike
  * heap_fetch, we do not report any pgstats count; caller may do so if wanted.
+ * We do count the length of the chain walked on a first call, though, and
+ * note the page for pruning if the chain was long.
  */
 bool heap_hot_search_buffer(ItemPointer tid, Relation relation, Buffer buffer, Snapshot snapshot, HeapTuple heap_tuple,
     HeapTupleHeaderData* uncompress_tup, bool* all_dead, bool first_call)
@@ -2273,6 +2289,7 @@ bool heap_hot_search_buffer(ItemPointer tid, Relation relation, Buffer buffer, S
     bool at_chain_start = false;
     bool valid = false;
     bool skip = false;
+    int chain_len = 0;
 
     gstrace_entry(GS_TRC_ID_heap_hot_search_buffer);
     /* If this is not the first call, previous call returned a (live!) tuple */
@@ -2337,6 +2354,7 @@ bool heap_hot_search_buffer(ItemPointer tid, Relation relation, Buffer buffer, S
         if (TransactionIdIsValid(prev_xmax) && !TransactionIdEquals(prev_xmax, HeapTupleGetRawXmin(heap_tuple))) {
             break;
         }
+        chain_len++;
 
         /*
          * When first_call is true (and thus, skip is initially false) we'll
@@ -2392,6 +2410,9 @@ bool heap_hot_search_buffer(ItemPointer tid, Relation relation, Buffer buffer, S
                                           relation->rd_att,
                                           (const char*)BufferGetPage(buffer));
                 }
+                if (first_call) {
+                    heap_hot_search_count_chain(relation, buffer, chain_len);
+                }
                 gstrace_exit(GS_TRC_ID_heap_hot_search_buffer);
                 return true;
             }
@@ -2421,6 +2442,9 @@ bool heap_hot_search_buffer(ItemPointer tid, Relation relation, Buffer buffer, S
         }
     }
 
+    if (first_call && chain_len > 0) {
+        heap_hot_search_count_chain(relation, buffer, chain_len);
+    }
     gstrace_exit(GS_TRC_ID_heap_hot_search_buffer);
     return false;
 }
@@ -21,6 +21,7 @@
 #include "access/xlog.h"
 #include "miscadmin.h"
 #include "pgstat.h"
+#include "postmaster/autovacuum.h"
 #include "storage/bufmgr.h"
 #include "utils/rel.h"
 #include "utils/rel_gs.h"
@@ -46,7 +47,41 @@ typedef struct {
     bool marked[MaxHeapTuplesPerPage + 1];
 } PruneState;
 
+/*
+ * Small per-backend memos of heap pages with long HOT chains; when one is
+ * full, its entries are replaced in turn.
+ *
+ * hot_chain_prune_memo holds the pages on which this backend recently walked
+ * a HOT chain of at least hot_chain_prune_threshold members.  The next
+ * heap_page_prune_opt call for such a page prunes it even if the page still
+ * has plenty of free space.  Each entry is good for a single attempt, which
+ * never waits for the cleanup lock, so this keeps the foreground work bounded.
+ *
+ * hot_chain_request_memo holds the pages for which such an attempt failed and
+ * autovacuum was asked to prune them, so that a hot page doesn't make us ask
+ * again, and take AutovacuumLock, on every visit.
+ */
+#define HOT_CHAIN_PAGE_MEMO_SIZE 8
+
+typedef struct HotChainPage {
+    RelFileNode node;
+    BlockNumber blkno;
+} HotChainPage;
+
+typedef struct HotChainPageMemo {
+    HotChainPage pages[HOT_CHAIN_PAGE_MEMO_SIZE];
+    int npages;
+    int next;
+} HotChainPageMemo;
+
+static THR_LOCAL HotChainPageMemo hot_chain_prune_memo;
+static THR_LOCAL HotChainPageMemo hot_chain_request_memo;
+
 /* Local functions */
+static bool heap_page_prune_allowed(void);
+static int hot_chain_page_lookup(const HotChainPageMemo* memo, const RelFileNode* node, BlockNumber blkno);
+static void hot_chain_page_remember(HotChainPageMemo* memo, const RelFileNode* node, BlockNumber blkno);
+static void hot_chain_page_request_prune(Relation relation, BlockNumber blkno);
 static int heap_prune_chain(
     Relation relation, Buffer buffer, OffsetNumber rootoffnum, TransactionId oldest_xmin, PruneState* prstate);
 static void heap_prune_record_prunable(PruneState* prstate, TransactionId xid);
@@ -74,31 +109,15 @@ void heap_page_prune_opt(Relation relation, Buffer buffer)
     Page page = BufferGetPage(buffer);
     Size minfree;
     TransactionId oldest_xmin;
-    /*
-     * We can't write WAL in recovery mode, so there's no point trying to
-     * clean the page. The master will likely issue a cleaning WAL record soon
-     * anyway, so this is no particular loss.
-     */
-    if (RecoveryInProgress())
+    bool longchain = false;
+
+    if (!heap_page_prune_allowed())
         return;
 
     oldest_xmin = u_sess->utils_cxt.RecentGlobalXmin;
 
     Assert(TransactionIdIsValid(oldest_xmin));
 
-    /*
-     * Should not prune page when use local snapshot, InitPostgres e.g.
-     * If use local snapshot RecentXmin might not consider xid cn send later,
-     * wrong xid status might be judged in TransactionIdIsInProgress,
-     * and wrong tuple infomask might be set in HeapTupleSatisfiesVacuum.
-     * So if useLocalSnapshot is ture in postmaster env, we don't prune page.
-     * Keep prune page can be done in single mode (standlone --single), so just in PostmasterEnvironment.
-     */
-    if ((t_thrd.xact_cxt.useLocalSnapshot && IsPostmasterEnvironment) ||
-        g_instance.attr.attr_storage.IsRoachStandbyCluster || u_sess->attr.attr_common.upgrade_mode == 1 ||
-        InplaceUpgradePrecommit)
-        return;
-
     /*
      * Let's see if we really need pruning.
      *
@@ -108,6 +127,19 @@ void heap_page_prune_opt(Relation relation, Buffer buffer)
     if (!PageIsPrunable(page, oldest_xmin))
         return;
 
+    /*
+     * A page on which we recently walked a long HOT chain is pruned now,
+     * rather than left until it fills up; see heap_page_note_hot_chain.
+     */
+    if (hot_chain_prune_memo.npages > 0) {
+        int i = hot_chain_page_lookup(&hot_chain_prune_memo, &relation->rd_node, BufferGetBlockNumber(buffer));
+
+        if (i >= 0) {
+            hot_chain_prune_memo.pages[i] = hot_chain_prune_memo.pages[--hot_chain_prune_memo.npages];
+            longchain = true;
+        }
+    }
+
     /*
      * We prune when a previous UPDATE failed to find enough space on the page
      * for a new tuple version, or when free space falls below the relation's
@@ -122,10 +154,13 @@ void heap_page_prune_opt(Relation relation, Buffer buffer)
      */
     minfree = RelationGetTargetPageFreeSpace(relation, HEAP_DEFAULT_FILLFACTOR);
     minfree = Max(minfree, BLCKSZ / 10);
-    if (PageIsFull(page) || PageGetHeapFreeSpace(page) < minfree) {
-        /* OK, try to get exclusive buffer lock */
-        if (!ConditionalLockBufferForCleanup(buffer))
+    if (longchain || PageIsFull(page) || PageGetHeapFreeSpace(page) < minfree) {
+        /* OK, try to get exclusive buffer lock, or leave long chains to autovacuum */
+        if (!ConditionalLockBufferForCleanup(buffer)) {
+            if (longchain)
+                hot_chain_page_request_prune(relation, BufferGetBlockNumber(buffer));
             return;
+        }
 
         /*
          * Now that we have buffer lock, get accurate information about the
@@ -133,7 +168,7 @@ void heap_page_prune_opt(Relation relation, Buffer buffer)
          * prune. (We needn't recheck PageIsPrunable, since no one else could
          * have pruned while we hold pin.)
          */
-        if (PageIsFull(page) || PageGetHeapFreeSpace(page) < minfree) {
+        if (longchain || PageIsFull(page) || PageGetHeapFreeSpace(page) < minfree) {
             TransactionId ignore = InvalidTransactionId; /* return value not needed */
 
             /* OK to prune */
@@ -145,6 +180,132 @@ void heap_page_prune_opt(Relation relation, Buffer buffer)
     }
 }
 
+/*
+ * Check whether this backend may prune heap pages at all.
+ */
+static bool heap_page_prune_allowed(void)
+{
+    /*
+     * We can't write WAL in recovery mode, so there's no point trying to
+     * clean the page. The master will likely issue a cleaning WAL record soon
+     * anyway, so this is no particular loss.
+     */
+    if (RecoveryInProgress())
+        return false;
+
+    /*
+     * Should not prune page when use local snapshot, InitPostgres e.g.
+     * If use local snapshot RecentXmin might not consider xid cn send later,
+     * wrong xid status might be judged in TransactionIdIsInProgress,
+     * and wrong tuple infomask might be set in HeapTupleSatisfiesVacuum.
+     * So if useLocalSnapshot is ture in postmaster env, we don't prune page.
+     * Keep prune page can be done in single mode (standlone --single), so just in PostmasterEnvironment.
+     */
+    if ((t_thrd.xact_cxt.useLocalSnapshot && IsPostmasterEnvironment) ||
+        g_instance.attr.attr_storage.IsRoachStandbyCluster || u_sess->attr.attr_common.upgrade_mode == 1 ||
+        InplaceUpgradePrecommit)
+        return false;
+
+    return true;
+}
+
+static int hot_chain_page_lookup(const HotChainPageMemo* memo, const RelFileNode* node, BlockNumber blkno)
+{
+    for (int i = 0; i < memo->npages; i++) {
+        if (memo->pages[i].blkno == blkno && RelFileNodeEquals(memo->pages[i].node, *node))
+            return i;
+    }
+    return -1;
+}
+
+static void hot_chain_page_remember(HotChainPageMemo* memo, const RelFileNode* node, BlockNumber blkno)
+{
+    if (memo->npages < HOT_CHAIN_PAGE_MEMO_SIZE)
+        memo->next = memo->npages++;
+    else
+        memo->next = (memo->next + 1) % HOT_CHAIN_PAGE_MEMO_SIZE;
+    memo->pages[memo->next].node = *node;
+    memo->pages[memo->next].blkno = blkno;
+}
+
+/*
+ * Note that a scan walked a HOT chain of at least hot_chain_prune_threshold
+ * members on the page in buffer.
+ *
+ * The scan holds a lock on the buffer and may hold on to the tuple it found,
+ * so the page can't be pruned right away.  Instead we remember it, so that
+ * heap_page_prune_opt prunes it the next time this backend gets to it.
+ */
+void heap_page_note_hot_chain(Relation relation, Buffer buffer)
+{
+    BlockNumber blkno = BufferGetBlockNumber(buffer);
+
+    if (!heap_page_prune_allowed())
+        return;
+
+    if (hot_chain_page_lookup(&hot_chain_prune_memo, &relation->rd_node, blkno) >= 0)
+        return;
+
+    hot_chain_page_remember(&hot_chain_prune_memo, &relation->rd_node, blkno);
+}
+
+/*
+ * heap_page_prune_opt could not prune a page with long HOT chains because
+ * others hold pins on it, which is likely for the hot pages this is about.
+ * Ask autovacuum to prune it, once per page as long as we remember asking.
+ */
+static void hot_chain_page_request_prune(Relation relation, BlockNumber blkno)
+{
+    /* Autovacuum only knows about plain relations in shared buffers */
+    if (!AutoVacuumingActive() || RelationUsesLocalBuffers(relation) || RelationIsPartition(relation) ||
+        RelationIsBucket(relation))
+        return;
+
+    if (hot_chain_page_lookup(&hot_chain_request_memo, &relation->rd_node, blkno) >= 0)
+        return;
+
+    if (AutoVacuumRequestWork(AVW_HeapPruneHotChains, RelationGetRelid(relation), blkno))
+        hot_chain_page_remember(&hot_chain_request_memo, &relation->rd_node, blkno);
+}
+
+/*
+ * Prune a heap page as asked for by hot_chain_page_request_prune, on behalf of
+ * autovacuum.  The page is skipped if somebody else holds a pin on it; other
+ * backends, or this one once the page has left its memo, will ask again.
+ */
+void heap_page_prune_requested(Oid relid, BlockNumber blkno)
+{
+    Relation relation;
+    Buffer buffer;
+
+    if (!heap_page_prune_allowed())
+        return;
+
+    relation = try_relation_open(relid, AccessShareLock);
+    if (relation == NULL)
+        return;
+
+    if ((relation->rd_rel->relkind == RELKIND_RELATION || relation->rd_rel->relkind == RELKIND_MATVIEW ||
+        relation->rd_rel->relkind == RELKIND_TOASTVALUE) && RelationIsRowFormat(relation) &&
+        blkno < RelationGetNumberOfBlocks(relation)) {
+        buffer = ReadBufferExtended(relation, MAIN_FORKNUM, blkno, RBM_NORMAL, NULL);
+
+        if (ConditionalLockBufferForCleanup(buffer)) {
+            TransactionId oldest_xmin = u_sess->utils_cxt.RecentGlobalXmin;
+
+            if (PageIsPrunable(BufferGetPage(buffer), oldest_xmin)) {
+                TransactionId ignore = InvalidTransactionId; /* return value not needed */
+
+                (void)heap_page_prune(relation, buffer, oldest_xmin, true, &ignore, true);
+            }
+            LockBuffer(buffer, BUFFER_LOCK_UNLOCK);
+        }
+        ReleaseBuffer(buffer);
+    }
+
+    relation_close(relation, AccessShareLock);
+}
+
 /*
  * Prune and repair fragmentation in the specified page.
  *
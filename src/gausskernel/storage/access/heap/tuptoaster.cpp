@@ -35,6 +35,8 @@
 #include "access/tuptoaster.h"
 #include "access/xact.h"
 #include "catalog/catalog.h"
+#include "lz4.h"
+#include "utils/attoptcache.h"
 #include "utils/fmgroids.h"
 #include "utils/pg_lzcompress.h"
 #include "utils/rel.h"
@@ -50,6 +52,12 @@ static Datum toast_save_datum(Relation rel, Datum value, struct varlena* oldexte
 static bool toastid_valueid_exists(Oid toastrelid, Oid valueid, int2 bucketid);
 static struct varlena* toast_fetch_datum(struct varlena* attr);
 static struct varlena* toast_fetch_datum_slice(struct varlena* attr, int32 sliceoffset, int32 length);
+static struct varlena* toast_decompress_datum(struct varlena* attr);
+static struct varlena* toast_decompress_datum_slice(struct varlena* attr, int32 slicelength);
+static ToastCompressionId toast_get_attr_compression(Relation rel, int attnum);
+
+/* size of the header of an in-line compressed datum, raw size included */
+#define TOAST_COMPRESS_HDRSZ ((int32)offsetof(varattrib_4b, va_compressed.va_data))
 
 /* ----------
  * heap_tuple_fetch_attr -
@@ -121,11 +129,9 @@ struct varlena* heap_tuple_untoast_attr(struct varlena* attr)
         attr = toast_fetch_datum(attr);
         /* If it's compressed, decompress it */
         if (VARATT_IS_COMPRESSED(attr)) {
-            PGLZ_Header* tmp = (PGLZ_Header*)attr;
+            struct varlena* tmp = attr;
 
-            attr = (struct varlena*)palloc(PGLZ_RAW_SIZE(tmp) + VARHDRSZ);
-            SET_VARSIZE(attr, PGLZ_RAW_SIZE(tmp) + VARHDRSZ);
-            pglz_decompress(tmp, VARDATA(attr));
+            attr = toast_decompress_datum(tmp);
             pfree(tmp);
         }
     } else if (VARATT_IS_EXTERNAL_INDIRECT(attr)) {
@@ -141,11 +147,7 @@ struct varlena* heap_tuple_untoast_attr(struct varlena* attr)
         /*
          * This is a compressed value inside of the main tuple
          */
-        PGLZ_Header* tmp = (PGLZ_Header*)attr;
-
-        attr = (struct varlena*)palloc(PGLZ_RAW_SIZE(tmp) + VARHDRSZ);
-        SET_VARSIZE(attr, PGLZ_RAW_SIZE(tmp) + VARHDRSZ);
-        pglz_decompress(tmp, VARDATA(attr));
+        attr = toast_decompress_datum(attr);
     } else if (VARATT_IS_SHORT(attr)) {
         /*
          * This is a short-header varlena --- convert to 4-byte header format
@@ -203,14 +205,15 @@ struct varlena* heap_tuple_untoast_attr_slice(struct varlena* attr, int32 slice_
         preslice = attr;
 
     if (VARATT_IS_COMPRESSED(preslice)) {
-        PGLZ_Header* tmp = (PGLZ_Header*)preslice;
-        Size size = PGLZ_RAW_SIZE(tmp) + VARHDRSZ;
+        struct varlena* tmp = preslice;
 
-        preslice = (struct varlena*)palloc(size);
-        SET_VARSIZE(preslice, size);
-        pglz_decompress(tmp, VARDATA(preslice));
+        /* only the bytes up to the end of the slice need decompressing */
+        if (slice_length >= 0 && slice_offset <= PG_INT32_MAX - slice_length)
+            preslice = toast_decompress_datum_slice(tmp, slice_offset + slice_length);
+        else
+            preslice = toast_decompress_datum(tmp);
 
-        if (tmp != (PGLZ_Header*)attr)
+        if (tmp != attr)
             pfree(tmp);
     }
 
@@ -304,7 +307,7 @@ Size toast_datum_size(Datum value)
         struct varatt_external toast_pointer;
 
         VARATT_EXTERNAL_GET_POINTER(toast_pointer, attr);
-        result = toast_pointer.va_extsize;
+        result = VARATT_EXTERNAL_GET_EXTSIZE(toast_pointer);
     } else if (VARATT_IS_EXTERNAL_INDIRECT(attr)) {
         struct varatt_indirect toast_pointer;
 
@@ -638,7 +641,7 @@ HeapTuple toast_insert_or_update(Relation rel, HeapTuple newtup, HeapTuple oldtu
         i = biggest_attno;
         if (att[i]->attstorage == 'x') {
             old_value = toast_values[i];
-            new_value = toast_compress_datum(old_value);
+            new_value = toast_compress_datum(old_value, toast_get_attr_compression(rel, i + 1));
             if (DatumGetPointer(new_value) != NULL) {
                 /* successful compression */
                 if (toast_free[i]) {
@@ -772,7 +775,7 @@ HeapTuple toast_insert_or_update(Relation rel, HeapTuple newtup, HeapTuple oldtu
          */
         i = biggest_attno;
         old_value = toast_values[i];
-        new_value = toast_compress_datum(old_value);
+        new_value = toast_compress_datum(old_value, toast_get_attr_compression(rel, i + 1));
         if (DatumGetPointer(new_value) != NULL) {
             /* successful compression */
             if (toast_free[i]) {
@@ -1162,7 +1165,8 @@ Datum toast_flatten_tuple_attribute(Datum value, Oid typeId, int32 typeMod)
 /* ----------
  * toast_compress_datum -
  *
- *	Create a compressed version of a varlena datum
+ *	Create a compressed version of a varlena datum, using compression
+ *	method cmid
  *
  *	If we fail (ie, compressed result is actually bigger than original)
  *	then return NULL.  We must not use compressed data if it'd expand
@@ -1172,10 +1176,11 @@ Datum toast_flatten_tuple_attribute(Datum value, Oid typeId, int32 typeMod)
  *	copying them.  But we can't handle external or compressed datums.
  * ----------
  */
-Datum toast_compress_datum(Datum value)
+Datum toast_compress_datum(Datum value, ToastCompressionId cmid)
 {
     struct varlena* tmp = NULL;
     int32 valsize = VARSIZE_ANY_EXHDR(DatumGetPointer(value));
+    bool compressed = false;
 
     Assert(!VARATT_IS_EXTERNAL(DatumGetPointer(value)));
     Assert(!VARATT_IS_COMPRESSED(DatumGetPointer(value)));
@@ -1187,9 +1192,27 @@ Datum toast_compress_datum(Datum value)
     if (valsize < PGLZ_strategy_default->min_input_size || valsize > PGLZ_strategy_default->max_input_size)
         return PointerGetDatum(NULL);
 
-    tmp = (struct varlena*)palloc(PGLZ_MAX_OUTPUT(valsize));
+    if (cmid == TOAST_LZ4_COMPRESSION_ID) {
+        int32 maxsize = LZ4_compressBound(valsize);
+        int32 len;
+
+        tmp = (struct varlena*)palloc(maxsize + TOAST_COMPRESS_HDRSZ);
+        len = LZ4_compress_default(VARDATA_ANY(DatumGetPointer(value)), VARDATA_4B_C(tmp), valsize, maxsize);
+        if (len <= 0) {
+            ereport(ERROR, (errcode(ERRCODE_DATA_EXCEPTION), errmsg_internal("lz4 compression failed")));
+        }
+        SET_VARSIZE_COMPRESSED(tmp, len + TOAST_COMPRESS_HDRSZ);
+        ((varattrib_4b*)tmp)->va_compressed.va_rawsize = (uint32)valsize | ((uint32)cmid << VARLENA_RAWSIZE_BITS);
+        compressed = true;
+    } else {
+        Assert(cmid == TOAST_PGLZ_COMPRESSION_ID);
+        tmp = (struct varlena*)palloc(PGLZ_MAX_OUTPUT(valsize));
+        compressed = pglz_compress(VARDATA_ANY(DatumGetPointer(value)), valsize, (PGLZ_Header*)tmp,
+            PGLZ_strategy_default);
+    }
+
     /*
-     * We recheck the actual size even if pglz_compress() reports success,
+     * We recheck the actual size even if the compressor reports success,
      * because it might be satisfied with having saved as little as one byte
      * in the compressed data --- which could turn into a net loss once you
      * consider header and alignment padding.  Worst case, the compressed
@@ -1198,8 +1221,7 @@ Datum toast_compress_datum(Datum value)
      * only one header byte and no padding if the value is short enough.  So
      * we insist on a savings of more than 2 bytes to ensure we have a gain.
      */
-    if (pglz_compress(VARDATA_ANY(DatumGetPointer(value)), valsize, (PGLZ_Header*)tmp, PGLZ_strategy_default) &&
-        VARSIZE(tmp) < (uint32)(valsize - 2)) {
+    if (compressed && VARSIZE(tmp) < (uint32)(valsize - 2)) {
         /* successful compression */
         return PointerGetDatum(tmp);
     } else {
@@ -1209,6 +1231,145 @@ Datum toast_compress_datum(Datum value)
     }
 }
 
+/* ----------
+ * toast_decompress_datum -
+ *
+ *	Decompress an in-line compressed datum with the method recorded in
+ *	its header
+ * ----------
+ */
+static struct varlena* toast_decompress_datum(struct varlena* attr)
+{
+    int32 rawsize = VARRAWSIZE_4B_C(attr);
+    struct varlena* result = NULL;
+
+    Assert(VARATT_IS_COMPRESSED(attr));
+
+    result = (struct varlena*)palloc(rawsize + VARHDRSZ);
+    SET_VARSIZE(result, rawsize + VARHDRSZ);
+
+    switch (VARCOMPRESS_METHOD_4B_C(attr)) {
+        case TOAST_PGLZ_COMPRESSION_ID:
+            pglz_decompress((PGLZ_Header*)attr, VARDATA(result));
+            break;
+        case TOAST_LZ4_COMPRESSION_ID:
+            if (LZ4_decompress_safe(VARDATA_4B_C(attr), VARDATA(result), VARSIZE(attr) - TOAST_COMPRESS_HDRSZ,
+                rawsize) != rawsize) {
+                ereport(ERROR, (errcode(ERRCODE_DATA_CORRUPTED), errmsg_internal("compressed lz4 data is corrupt")));
+            }
+            break;
+        default:
+            ereport(ERROR,
+                (errcode(ERRCODE_DATA_CORRUPTED),
+                    errmsg_internal("invalid compression method id %u", VARCOMPRESS_METHOD_4B_C(attr))));
+            break;
+    }
+
+    return result;
+}
+
+/* ----------
+ * toast_decompress_datum_slice -
+ *
+ *	Decompress the leading slicelength bytes of an in-line compressed
+ *	datum.  Only lz4 can stop early; pglz decompresses everything.
+ * ----------
+ */
+static struct varlena* toast_decompress_datum_slice(struct varlena* attr, int32 slicelength)
+{
+    int32 rawsize = VARRAWSIZE_4B_C(attr);
+    struct varlena* result = NULL;
+    int32 len;
+
+    if (VARCOMPRESS_METHOD_4B_C(attr) != TOAST_LZ4_COMPRESSION_ID || slicelength >= rawsize)
+        return toast_decompress_datum(attr);
+
+    result = (struct varlena*)palloc(slicelength + VARHDRSZ);
+    len = LZ4_decompress_safe_partial(VARDATA_4B_C(attr), VARDATA(result), VARSIZE(attr) - TOAST_COMPRESS_HDRSZ,
+        slicelength, slicelength);
+    if (len < 0) {
+        ereport(ERROR, (errcode(ERRCODE_DATA_CORRUPTED), errmsg_internal("compressed lz4 data is corrupt")));
+    }
+    SET_VARSIZE(result, len + VARHDRSZ);
+
+    return result;
+}
+
+/* ----------
+ * toast_get_compression_id -
+ *
+ *	Return the compression method of a varlena datum, looking through
+ *	TOAST pointers without fetching the value
+ * ----------
+ */
+ToastCompressionId toast_get_compression_id(struct varlena* attr)
+{
+    if (VARATT_IS_EXTERNAL_ONDISK_B(attr)) {
+        struct varatt_external toast_pointer;
+
+        VARATT_EXTERNAL_GET_POINTER(toast_pointer, attr);
+        if (VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer))
+            return (ToastCompressionId)VARATT_EXTERNAL_GET_COMPRESS_METHOD(toast_pointer);
+    } else if (VARATT_IS_EXTERNAL_INDIRECT(attr)) {
+        struct varatt_indirect redirect;
+
+        VARATT_EXTERNAL_GET_POINTER(redirect, attr);
+        return toast_get_compression_id(redirect.pointer);
+    } else if (VARATT_IS_COMPRESSED(attr)) {
+        return (ToastCompressionId)VARCOMPRESS_METHOD_4B_C(attr);
+    }
+
+    return TOAST_INVALID_COMPRESSION_ID;
+}
+
+/*
+ * Map a compression method name to its id, TOAST_INVALID_COMPRESSION_ID if
+ * there is no such method.
+ */
+ToastCompressionId CompressionNameToId(const char* name)
+{
+    if (pg_strcasecmp(name, "pglz") == 0)
+        return TOAST_PGLZ_COMPRESSION_ID;
+    if (pg_strcasecmp(name, "lz4") == 0)
+        return TOAST_LZ4_COMPRESSION_ID;
+    return TOAST_INVALID_COMPRESSION_ID;
+}
+
+const char* GetCompressionMethodName(ToastCompressionId cmid)
+{
+    switch (cmid) {
+        case TOAST_PGLZ_COMPRESSION_ID:
+            return "pglz";
+        case TOAST_LZ4_COMPRESSION_ID:
+            return "lz4";
+        default:
+            return NULL;
+    }
+}
+
+/*
+ * Return the compression method set by ALTER TABLE ... SET COMPRESSION for
+ * an attribute of rel, pglz if there is none.
+ */
+static ToastCompressionId toast_get_attr_compression(Relation rel, int attnum)
+{
+    AttributeOpts* aopts = NULL;
+    ToastCompressionId cmid = TOAST_PGLZ_COMPRESSION_ID;
+
+    /* catalog columns cannot carry the option, and may be toasted during bootstrap */
+    if (IsSystemRelation(rel))
+        return cmid;
+
+    /* attribute options are kept by the parent relation of a partition */
+    aopts = get_attribute_options(OidIsValid(rel->parentId) ? rel->parentId : RelationGetRelid(rel), attnum);
+    if (aopts != NULL) {
+        if (aopts->compression != 0)
+            cmid = CompressionNameToId((const char*)aopts + aopts->compression);
+        pfree(aopts);
+    }
+    return cmid;
+}
+
 /* ----------
  * toast_save_datum -
  *
@@ -1278,7 +1439,7 @@ static Datum toast_save_datum(Relation rel, Datum value, struct varlena* oldexte
         data_todo = VARSIZE(dval) - VARHDRSZ;
         /* rawsize in a compressed datum is just the size of the payload */
         toast_pointer.va_rawsize = VARRAWSIZE_4B_C(dval) + VARHDRSZ;
-        toast_pointer.va_extsize = data_todo;
+        VARATT_EXTERNAL_SET_SIZE_AND_COMPRESS_METHOD(toast_pointer, data_todo, VARCOMPRESS_METHOD_4B_C(dval));
         /* Assert that the numbers look like it's compressed */
         Assert(VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer));
     } else {
@@ -1596,7 +1757,7 @@ static struct varlena* toast_fetch_datum(struct varlena* attr)
     /* Must copy to access aligned fields */
     VARATT_EXTERNAL_GET_POINTER_B(toast_pointer, attr, bucketid);
 
-    ressize = toast_pointer.va_extsize;
+    ressize = VARATT_EXTERNAL_GET_EXTSIZE(toast_pointer);
     numchunks = ((ressize - 1) / TOAST_MAX_CHUNK_SIZE) + 1;
 
     result = (struct varlena*)palloc(ressize + VARHDRSZ);
@@ -1785,7 +1946,7 @@ static struct varlena* toast_fetch_datum_slice(struct varlena* attr, int32 slice
      */
     Assert(!VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer));
 
-    attrsize = toast_pointer.va_extsize;
+    attrsize = VARATT_EXTERNAL_GET_EXTSIZE(toast_pointer);
     totalchunks = ((attrsize - 1) / TOAST_MAX_CHUNK_SIZE) + 1;
 
     if (sliceoffset >= attrsize) {
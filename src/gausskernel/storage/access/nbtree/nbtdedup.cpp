@@ -0,0 +1,361 @@
+/* -------------------------------------------------------------------------
+ *
+ * nbtdedup.cpp
+ *    Deduplicate items in Lehman and Yao btrees for Postgres.
+ *
+ * Leaf tuples whose keys are binary equal can be merged into a single
+ * posting list tuple that stores the key once, followed by the sorted heap
+ * TIDs of all the merged tuples.  This is only done for indexes with the
+ * deduplicate_items reloption, and only when the alternative is a page
+ * split, so that the cost is paid by the pages that would otherwise grow.
+ *
+ * Portions Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ * Portions Copyright (c) 1996-2012, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/gausskernel/storage/access/nbtree/nbtdedup.cpp
+ *
+ * -------------------------------------------------------------------------
+ */
+#include "postgres.h"
+#include "knl/knl_variable.h"
+
+#include "access/nbtree.h"
+#include "access/xloginsert.h"
+#include "miscadmin.h"
+#include "utils/rel.h"
+#include "utils/rel_gs.h"
+
+static Size _bt_keysize(IndexTuple itup);
+
+/*
+ * _bt_dedup_enabled() -- may posting list tuples be created in this index?
+ *
+ * Unique indexes have nothing to gain and their uniqueness checks look at
+ * each heap TID separately.  INCLUDE indexes may store different non-key
+ * values for equal keys, and global partitioned indexes resolve a partition
+ * OID per tuple, so they are left alone as well.
+ */
+bool _bt_dedup_enabled(Relation rel)
+{
+    return RelationGetDeduplicateItems(rel) && !rel->rd_index->indisunique &&
+           IndexRelationGetNumberOfKeyAttributes(rel) == IndexRelationGetNumberOfAttributes(rel) &&
+           !RelationIsGlobalIndex(rel);
+}
+
+/* size of the key part of a leaf tuple, including the tuple header */
+static Size _bt_keysize(IndexTuple itup)
+{
+    return BTreeTupleIsPosting(itup) ? BTreeTupleGetPostingOffset(itup) : IndexTupleSize(itup);
+}
+
+/*
+ * _bt_keys_image_equal() -- do two leaf tuples carry the same key image?
+ *
+ * Equal images imply equal keys for any opclass, and merging them loses
+ * nothing an index-only scan could return (unlike, say, numeric 1.0 and
+ * 1.00, which are equal but have different images and stay separate).
+ * index_form_tuple() zeroes alignment padding, so comparing bytes is enough.
+ */
+bool _bt_keys_image_equal(IndexTuple itup1, IndexTuple itup2)
+{
+    Size keysize = _bt_keysize(itup1);
+
+    if (keysize != _bt_keysize(itup2))
+        return false;
+    if ((itup1->t_info & INDEX_NULL_MASK) != (itup2->t_info & INDEX_NULL_MASK))
+        return false;
+
+    return memcmp((char*)itup1 + sizeof(IndexTupleData), (char*)itup2 + sizeof(IndexTupleData),
+        keysize - sizeof(IndexTupleData)) == 0;
+}
+
+/* qsort comparator for heap TIDs */
+int _bt_tid_cmp(const void* a, const void* b)
+{
+    return ItemPointerCompare((ItemPointer)a, (ItemPointer)b);
+}
+
+/*
+ * _bt_form_posting() -- build a leaf tuple with the key of base and htids
+ *
+ * htids must be sorted.  With a single TID the result is a plain tuple, so
+ * this also serves to strip the posting list off a tuple.  The result is
+ * palloc'd.
+ */
+IndexTuple _bt_form_posting(IndexTuple base, const ItemPointerData* htids, int nhtids)
+{
+    Size keysize = _bt_keysize(base);
+    Size newsize;
+    IndexTuple itup;
+    errno_t rc;
+
+    Assert(keysize == MAXALIGN(keysize));
+    Assert(nhtids > 0);
+
+    if (nhtids > 1)
+        newsize = MAXALIGN(keysize + nhtids * sizeof(ItemPointerData));
+    else
+        newsize = keysize;
+    Assert(newsize <= INDEX_SIZE_MASK);
+
+    itup = (IndexTuple)palloc0(newsize);
+    rc = memcpy_s(itup, newsize, base, keysize);
+    securec_check(rc, "", "");
+    itup->t_info &= ~INDEX_SIZE_MASK;
+    itup->t_info |= newsize;
+
+    if (nhtids > 1) {
+        BTreeTupleSetPosting(itup, nhtids, keysize);
+        rc = memcpy_s(BTreeTupleGetPosting(itup), nhtids * sizeof(ItemPointerData), htids,
+            nhtids * sizeof(ItemPointerData));
+        securec_check(rc, "", "");
+    } else {
+        itup->t_info &= ~INDEX_ALT_TID_MASK;
+        ItemPointerCopy(htids, &itup->t_tid);
+    }
+
+    return itup;
+}
+
+/*
+ * _bt_strip_posting() -- palloc'd copy of a leaf tuple without its posting
+ * list, used where only the key matters (high keys, index-only scans).
+ */
+IndexTuple _bt_strip_posting(IndexTuple itup)
+{
+    if (!BTreeTupleIsPosting(itup))
+        return CopyIndexTuple(itup);
+
+    return _bt_form_posting(itup, BTreeTupleGetPosting(itup), 1);
+}
+
+/*
+ * _bt_update_posting() -- apply the TID deletions VACUUM decided on
+ *
+ * Replaces vacposting->itup with a palloc'd tuple holding the heap TIDs that
+ * were not deleted.  deletetids must be in increasing order.
+ */
+void _bt_update_posting(BTVacuumPosting vacposting)
+{
+    IndexTuple origtuple = vacposting->itup;
+    int nhtids = BTreeTupleGetNPosting(origtuple);
+    ItemPointerData* htids = (ItemPointerData*)palloc(nhtids * sizeof(ItemPointerData));
+    int nremaining = 0;
+    int d = 0;
+
+    Assert(vacposting->ndeletedtids > 0 && vacposting->ndeletedtids < nhtids);
+
+    for (int i = 0; i < nhtids; i++) {
+        if (d < vacposting->ndeletedtids && vacposting->deletetids[d] == i) {
+            d++;
+            continue;
+        }
+        htids[nremaining++] = *BTreeTupleGetPostingN(origtuple, i);
+    }
+    Assert(d == vacposting->ndeletedtids);
+
+    vacposting->itup = _bt_form_posting(origtuple, htids, nremaining);
+    pfree(htids);
+}
+
+/*
+ * _bt_dedup_build_page() -- build the deduplicated image of a leaf page
+ *
+ * Each interval merges nitems consecutive items starting at baseoff into one
+ * posting list tuple; all other items are copied unchanged.  This is shared
+ * by _bt_dedup_one_page() and WAL replay, so it must depend on nothing but
+ * the page and the intervals.  Returns a temp page for PageRestoreTempPage().
+ */
+Page _bt_dedup_build_page(Page page, const BTDedupInterval* intervals, int nintervals)
+{
+    BTPageOpaqueInternal opaque = (BTPageOpaqueInternal)PageGetSpecialPointer(page);
+    OffsetNumber minoff = P_FIRSTDATAKEY(opaque);
+    OffsetNumber maxoff = PageGetMaxOffsetNumber(page);
+    OffsetNumber newoff = P_HIKEY;
+    ItemPointerData* htids = (ItemPointerData*)palloc(MaxTIDsPerBTreePage * sizeof(ItemPointerData));
+    Page newpage = PageGetTempPageCopySpecial(page, false);
+    int curinterval = 0;
+
+    if (!P_RIGHTMOST(opaque)) {
+        ItemId hitemid = PageGetItemId(page, P_HIKEY);
+
+        if (PageAddItem(newpage, PageGetItem(page, hitemid), ItemIdGetLength(hitemid), newoff, false, false) ==
+            InvalidOffsetNumber)
+            ereport(ERROR, (errcode(ERRCODE_INDEX_CORRUPTED), errmsg("failed to add high key during deduplication")));
+        newoff = OffsetNumberNext(newoff);
+    }
+
+    for (OffsetNumber offnum = minoff; offnum <= maxoff; offnum = OffsetNumberNext(offnum)) {
+        ItemId itemid = PageGetItemId(page, offnum);
+        IndexTuple itup = (IndexTuple)PageGetItem(page, itemid);
+
+        if (curinterval < nintervals && intervals[curinterval].baseoff == offnum) {
+            const BTDedupInterval* interval = &intervals[curinterval++];
+            IndexTuple posting;
+            int nhtids = 0;
+
+            for (int i = 0; i < interval->nitems; i++) {
+                IndexTuple cur = (IndexTuple)PageGetItem(page, PageGetItemId(page, offnum + i));
+
+                if (BTreeTupleIsPosting(cur)) {
+                    int n = BTreeTupleGetNPosting(cur);
+                    errno_t rc = memcpy_s(&htids[nhtids], (MaxTIDsPerBTreePage - nhtids) * sizeof(ItemPointerData),
+                        BTreeTupleGetPosting(cur), n * sizeof(ItemPointerData));
+                    securec_check(rc, "", "");
+                    nhtids += n;
+                } else {
+                    htids[nhtids++] = cur->t_tid;
+                }
+            }
+            qsort(htids, nhtids, sizeof(ItemPointerData), _bt_tid_cmp);
+
+            posting = _bt_form_posting(itup, htids, nhtids);
+            if (PageAddItem(newpage, (Item)posting, IndexTupleSize(posting), newoff, false, false) ==
+                InvalidOffsetNumber)
+                ereport(ERROR,
+                    (errcode(ERRCODE_INDEX_CORRUPTED),
+                        errmsg("failed to add posting list tuple during deduplication")));
+            pfree(posting);
+
+            offnum += interval->nitems - 1;
+        } else {
+            if (PageAddItem(newpage, (Item)itup, ItemIdGetLength(itemid), newoff, false, false) ==
+                InvalidOffsetNumber)
+                ereport(ERROR, (errcode(ERRCODE_INDEX_CORRUPTED), errmsg("failed to add item during deduplication")));
+            if (ItemIdIsDead(itemid))
+                ItemIdMarkDead(PageGetItemId(newpage, newoff));
+        }
+        newoff = OffsetNumberNext(newoff);
+    }
+    Assert(curinterval == nintervals);
+
+    pfree(htids);
+    return newpage;
+}
+
+/*
+ * _bt_dedup_one_page() -- try to make room for a new item on a leaf page
+ *
+ * Called with a write lock on buf when the new item of size newitemsz does not
+ * fit, after any LP_DEAD items were already removed.  Merges each run of
+ * image-equal live items into a posting list tuple, as long as the posting
+ * list tuple stays within BTMaxItemSize.  Returns true if the page was
+ * changed; the caller must recheck the free space, and any offset it computed
+ * before is stale.
+ */
+bool _bt_dedup_one_page(Relation rel, Buffer buf, Size newitemsz)
+{
+    Page page = BufferGetPage(buf);
+    BTPageOpaqueInternal opaque = (BTPageOpaqueInternal)PageGetSpecialPointer(page);
+    OffsetNumber minoff = P_FIRSTDATAKEY(opaque);
+    OffsetNumber maxoff = PageGetMaxOffsetNumber(page);
+    Size maxpostingsz = BTMaxItemSize(page);
+    BTDedupInterval* intervals = NULL;
+    int nintervals = 0;
+    IndexTuple base = NULL;
+    OffsetNumber baseoff = InvalidOffsetNumber;
+    int nitems = 0;
+    int nhtids = 0;
+    Size spacesaving = 0;
+    Page newpage;
+
+    Assert(P_ISLEAF(opaque));
+
+    /* pages of the old format are left to be split, see _bt_page_localupgrade */
+    if (PageIs4BXidVersion(page) || minoff >= maxoff)
+        return false;
+
+    intervals = (BTDedupInterval*)palloc(sizeof(BTDedupInterval) * (maxoff / 2 + 1));
+
+    for (OffsetNumber offnum = minoff; offnum <= maxoff + 1; offnum = OffsetNumberNext(offnum)) {
+        ItemId itemid = NULL;
+        IndexTuple itup = NULL;
+        int ntids = 0;
+
+        if (offnum <= maxoff) {
+            itemid = PageGetItemId(page, offnum);
+            itup = (IndexTuple)PageGetItem(page, itemid);
+            ntids = BTreeTupleIsPosting(itup) ? BTreeTupleGetNPosting(itup) : 1;
+
+            if (base != NULL && !ItemIdIsDead(itemid) && _bt_keys_image_equal(base, itup) &&
+                MAXALIGN(_bt_keysize(base) + (nhtids + ntids) * sizeof(ItemPointerData)) <= maxpostingsz) {
+                nitems++;
+                nhtids += ntids;
+                continue;
+            }
+        }
+
+        /* the current run ends here, remember it if anything gets merged */
+        if (nitems > 1) {
+            Size mergedsz = 0;
+
+            for (int i = 0; i < nitems; i++)
+                mergedsz += ItemIdGetLength(PageGetItemId(page, baseoff + i)) + sizeof(ItemIdData);
+            spacesaving += mergedsz - (MAXALIGN(_bt_keysize(base) + nhtids * sizeof(ItemPointerData)) +
+                                          sizeof(ItemIdData));
+            intervals[nintervals].baseoff = baseoff;
+            intervals[nintervals].nitems = (uint16)nitems;
+            nintervals++;
+        }
+
+        if (itup == NULL || ItemIdIsDead(itemid)) {
+            base = NULL;
+            nitems = 0;
+        } else {
+            base = itup;
+            baseoff = offnum;
+            nitems = 1;
+            nhtids = ntids;
+        }
+    }
+
+    if (nintervals == 0) {
+        pfree(intervals);
+        return false;
+    }
+
+    ereport(DEBUG2,
+        (errmsg("deduplicating %d runs of block %u of index \"%s\" to make room for %lu bytes, saving %lu bytes",
+            nintervals,
+            BufferGetBlockNumber(buf),
+            RelationGetRelationName(rel),
+            (unsigned long)newitemsz,
+            (unsigned long)spacesaving)));
+
+    newpage = _bt_dedup_build_page(page, intervals, nintervals);
+
+    /* No ereport(ERROR) until changes are logged */
+    START_CRIT_SECTION();
+
+    PageRestoreTempPage(newpage, page);
+    MarkBufferDirty(buf);
+
+    if (RelationNeedsWAL(rel)) {
+        XLogRecPtr recptr;
+        xl_btree_dedup xlrec_dedup;
+
+        xlrec_dedup.nintervals = (uint16)nintervals;
+
+        XLogBeginInsert();
+        XLogRegisterBuffer(0, buf, REGBUF_STANDARD);
+        XLogRegisterData((char*)&xlrec_dedup, SizeOfBtreeDedup);
+
+        /*
+         * The intervals are not in the buffer, but pretend that they are.
+         * When XLogInsert stores the whole buffer, they need not be stored.
+         */
+        XLogRegisterBufData(0, (char*)intervals, nintervals * sizeof(BTDedupInterval));
+
+        recptr = XLogInsert(RM_BTREE_ID, XLOG_BTREE_DEDUP);
+
+        PageSetLSN(page, recptr);
+    }
+
+    END_CRIT_SECTION();
+
+    pfree(intervals);
+    return true;
+}
@@ -626,6 +626,15 @@ static void _bt_findinsertloc(Relation rel, Buffer* bufptr, OffsetNumber* offset
         vacuumed = false;
     }
 
+    /*
+     * Still no room: before we split the leaf page, try to free space by
+     * merging its runs of equal keys into posting list tuples.
+     */
+    if (PageGetFreeSpace(page) < itemsz && P_ISLEAF(lpageop) && _bt_dedup_enabled(rel)) {
+        if (_bt_dedup_one_page(rel, buf, itemsz))
+            vacuumed = true;
+    }
+
     /*
      * Now we are on the right page, so find the insert position. If we moved
      * right at all, we know we should insert at the start of the page. If we
@@ -991,12 +1000,16 @@ static Buffer _bt_split(Relation rel, Buffer buf, Buffer cbuf, OffsetNumber firs
      * We must truncate included attributes of the "high key" item, before
      * insert it onto the leaf page.  It's the only point in insertion
      * process, where we perform truncation.  All other functions work with
-     * this high key and do not change it.
+     * this high key and do not change it.  Likewise, a posting list is of no
+     * use in a high key, so only the key of a posting list tuple is kept.
      */
     if (indnatts != indnkeyatts && isleaf) {
         lefthikey = _bt_nonkey_truncate(rel, item);
         itemsz = IndexTupleSize(lefthikey);
         itemsz = MAXALIGN(itemsz);
+    } else if (isleaf && BTreeTupleIsPosting(item)) {
+        lefthikey = _bt_strip_posting(item);
+        itemsz = MAXALIGN(IndexTupleSize(lefthikey));
     } else {
         lefthikey = item;
     }
@@ -672,16 +672,59 @@ bool _bt_page_recyclable(Page page)
  * for the last block in the index, whether or not it contained any items
  * to be removed. This allows us to scan right up to end of index to
  * ensure correct locking.
+ *
+ * updatable lists the posting list tuples that lose only some of their heap
+ * TIDs; they are replaced in place before the deletions are applied, and
+ * their itup fields point to the new, palloc'd tuples on return.
  */
-void _bt_delitems_vacuum(const Relation rel, Buffer buf, OffsetNumber* itemnos, int nitems, BlockNumber lastBlockVacuumed)
+void _bt_delitems_vacuum(const Relation rel, Buffer buf, OffsetNumber* itemnos, int nitems,
+    BTVacuumPosting* updatable, int nupdatable, BlockNumber lastBlockVacuumed)
 {
     Page page = BufferGetPage(buf);
     BTPageOpaqueInternal opaque;
+    char* updatedbuf = NULL;
+    Size updatedbuflen = 0;
+    int i;
+
+    /* Form the updated tuples and their WAL data before entering the critical section */
+    for (i = 0; i < nupdatable; i++) {
+        _bt_update_posting(updatable[i]);
+        updatedbuflen += SizeOfBtreeUpdate + updatable[i]->ndeletedtids * sizeof(uint16);
+    }
+    if (nupdatable > 0 && RelationNeedsWAL(rel)) {
+        Size offset = 0;
+
+        updatedbuf = (char*)palloc(updatedbuflen);
+        for (i = 0; i < nupdatable; i++) {
+            xl_btree_update update;
+            errno_t rc;
+
+            update.offnum = updatable[i]->updatedoffset;
+            update.ndeletedtids = updatable[i]->ndeletedtids;
+            rc = memcpy_s(updatedbuf + offset, updatedbuflen - offset, &update, SizeOfBtreeUpdate);
+            securec_check(rc, "", "");
+            offset += SizeOfBtreeUpdate;
+            rc = memcpy_s(updatedbuf + offset, updatedbuflen - offset, updatable[i]->deletetids,
+                update.ndeletedtids * sizeof(uint16));
+            securec_check(rc, "", "");
+            offset += update.ndeletedtids * sizeof(uint16);
+        }
+    }
 
     /* No ereport(ERROR) until changes are logged */
     START_CRIT_SECTION();
 
     /* Fix the page */
+    for (i = 0; i < nupdatable; i++) {
+        OffsetNumber updatedoffset = updatable[i]->updatedoffset;
+        IndexTuple itup = updatable[i]->itup;
+
+        PageIndexTupleDelete(page, updatedoffset);
+        if (PageAddItem(page, (Item)itup, MAXALIGN(IndexTupleSize(itup)), updatedoffset, false, false) ==
+            InvalidOffsetNumber)
+            ereport(PANIC,
+                (errmsg("failed to update posting list tuple in index \"%s\"", RelationGetRelationName(rel))));
+    }
     if (nitems > 0)
         PageIndexMultiDelete(page, itemnos, nitems);
 
@@ -707,12 +750,18 @@ void _bt_delitems_vacuum(const Relation rel, Buffer buf, OffsetNumber* itemnos,
     if (RelationNeedsWAL(rel)) {
         XLogRecPtr recptr;
         xl_btree_vacuum xlrec_vacuum;
+        xl_btree_vacuum_posting xlrec_posting;
 
         xlrec_vacuum.lastBlockVacuumed = lastBlockVacuumed;
 
         XLogBeginInsert();
         XLogRegisterBuffer(0, buf, REGBUF_STANDARD);
         XLogRegisterData((char*)&xlrec_vacuum, SizeOfBtreeVacuum);
+        if (nupdatable > 0) {
+            xlrec_posting.ndeleted = (uint16)nitems;
+            xlrec_posting.nupdated = (uint16)nupdatable;
+            XLogRegisterData((char*)&xlrec_posting, SizeOfBtreeVacuumPosting);
+        }
 
         /*
          * The target-offsets array is not in the buffer, but pretend that it
@@ -721,6 +770,8 @@ void _bt_delitems_vacuum(const Relation rel, Buffer buf, OffsetNumber* itemnos,
          */
         if (nitems > 0)
             XLogRegisterBufData(0, (char*)itemnos, nitems * sizeof(OffsetNumber));
+        if (nupdatable > 0)
+            XLogRegisterBufData(0, updatedbuf, updatedbuflen);
 
         recptr = XLogInsert(RM_BTREE_ID, XLOG_BTREE_VACUUM);
 
@@ -728,6 +779,9 @@ void _bt_delitems_vacuum(const Relation rel, Buffer buf, OffsetNumber* itemnos,
     }
 
     END_CRIT_SECTION();
+
+    if (updatedbuf != NULL)
+        pfree(updatedbuf);
 }
 
 /*
@@ -90,6 +90,8 @@ typedef struct BTParallelScanDescData *BTParallelScanDesc;
 static void btvacuumscan(IndexVacuumInfo* info, IndexBulkDeleteResult* stats, IndexBulkDeleteCallback callback,
     void* callback_state, BTCycleId cycleid);
 static void btvacuumpage(BTVacState* vstate, BlockNumber blkno, BlockNumber orig_blkno);
+static BTVacuumPosting btreevacuumposting(IndexBulkDeleteCallback callback, void* callback_state, IndexTuple posting,
+    OffsetNumber updatedoffset, int* nremaining);
 
 static IndexTuple btgetindextuple(IndexScanDesc scan, ScanDirection dir, BlockNumber heapTupleBlkOffset);
 
@@ -939,7 +941,7 @@ static void btvacuumscan(IndexVacuumInfo* info, IndexBulkDeleteResult* stats, In
         buf = ReadBufferExtended(rel, MAIN_FORKNUM, vstate.lastBlockLocked, RBM_NORMAL, info->strategy);
         LockBufferForCleanup(buf);
         _bt_checkpage(rel, buf);
-        _bt_delitems_vacuum(rel, buf, NULL, 0, vstate.lastBlockVacuumed);
+        _bt_delitems_vacuum(rel, buf, NULL, 0, NULL, 0, vstate.lastBlockVacuumed);
         _bt_relbuf(rel, buf);
     }
 
@@ -1023,6 +1025,10 @@ restart:
     } else if (P_ISLEAF(opaque)) {
         OffsetNumber deletable[MaxOffsetNumber];
         int ndeletable;
+        BTVacuumPosting updatable[MaxIndexTuplesPerPage];
+        int nupdatable;
+        int nhtidsdead = 0;
+        int nhtidslive = 0;
         OffsetNumber offnum, minoff, maxoff;
 
         /*
@@ -1059,6 +1065,7 @@ restart:
          * callback function.
          */
         ndeletable = 0;
+        nupdatable = 0;
         minoff = P_FIRSTDATAKEY(opaque);
         maxoff = PageGetMaxOffsetNumber(page);
         if (callback) {
@@ -1095,17 +1102,41 @@ restart:
                     partOid = DatumGetUInt32(index_getattr(itup, partitionOidAttr, tupdesc, &isnull));
                     Assert(!isnull);
                 }
-                if (callback(htup, callback_state, partOid)) {
+                if (BTreeTupleIsPosting(itup)) {
+                    /* a posting list tuple goes away only if all its heap TIDs do */
+                    int nremaining;
+                    BTVacuumPosting vacposting =
+                        btreevacuumposting(callback, callback_state, itup, offnum, &nremaining);
+
+                    if (vacposting != NULL && nremaining > 0) {
+                        updatable[nupdatable++] = vacposting;
+                    } else if (vacposting != NULL) {
+                        deletable[ndeletable++] = offnum;
+                        pfree(vacposting);
+                    }
+                    nhtidsdead += BTreeTupleGetNPosting(itup) - nremaining;
+                    nhtidslive += nremaining;
+                } else if (callback(htup, callback_state, partOid)) {
                     deletable[ndeletable++] = offnum;
+                    nhtidsdead++;
+                } else {
+                    nhtidslive++;
                 }
             }
+        } else {
+            for (offnum = minoff; offnum <= maxoff; offnum = OffsetNumberNext(offnum)) {
+                IndexTuple itup = (IndexTuple)PageGetItem(page, PageGetItemId(page, offnum));
+
+                nhtidslive += BTreeTupleIsPosting(itup) ? BTreeTupleGetNPosting(itup) : 1;
+            }
         }
 
         /*
-         * Apply any needed deletes.  We issue just one _bt_delitems_vacuum()
-         * call per page, so as to minimize WAL traffic.
+         * Apply any needed deletes and posting list updates.  We issue just
+         * one _bt_delitems_vacuum() call per page, so as to minimize WAL
+         * traffic.
          */
-        if (ndeletable > 0) {
+        if (ndeletable > 0 || nupdatable > 0) {
             /*
              * Notice that the issued XLOG_BTREE_VACUUM WAL record includes an
              * instruction to the replay code to get cleanup lock on all pages
@@ -1117,7 +1148,7 @@ restart:
              * doesn't seem worth the amount of bookkeeping it'd take to avoid
              * that.
              */
-            _bt_delitems_vacuum(rel, buf, deletable, ndeletable, vstate->lastBlockVacuumed);
+            _bt_delitems_vacuum(rel, buf, deletable, ndeletable, updatable, nupdatable, vstate->lastBlockVacuumed);
 
             /*
              * Remember highest leaf page number we've issued a
@@ -1127,9 +1158,14 @@ restart:
                 vstate->lastBlockVacuumed = blkno;
             }
 
-            stats->tuples_removed += ndeletable;
+            stats->tuples_removed += nhtidsdead;
             /* must recompute maxoff */
             maxoff = PageGetMaxOffsetNumber(page);
+
+            for (int i = 0; i < nupdatable; i++) {
+                pfree(updatable[i]->itup);
+                pfree(updatable[i]);
+            }
         } else {
             /*
              * If the page has been split during this vacuum cycle, it seems
@@ -1154,7 +1190,7 @@ restart:
         if (minoff > maxoff) {
             delete_now = (blkno == orig_blkno);
         } else {
-            stats->num_index_tuples += maxoff - minoff + 1;
+            stats->num_index_tuples += nhtidslive;
         }
     }
 
@@ -1188,6 +1224,39 @@ restart:
     }
 }
 
+/*
+ * btreevacuumposting --- ask the callback about each heap TID of a posting
+ * list tuple.
+ *
+ * Returns NULL if all of them stay, else a palloc'd BTVacuumPosting listing
+ * the ones to delete.  *nremaining is set to the number of TIDs that stay; the
+ * caller deletes the whole tuple when it is zero.
+ */
+static BTVacuumPosting btreevacuumposting(IndexBulkDeleteCallback callback, void* callback_state, IndexTuple posting,
+    OffsetNumber updatedoffset, int* nremaining)
+{
+    int nitem = BTreeTupleGetNPosting(posting);
+    BTVacuumPosting vacposting = NULL;
+    int live = 0;
+
+    for (int i = 0; i < nitem; i++) {
+        if (!callback(BTreeTupleGetPostingN(posting, i), callback_state, InvalidOid)) {
+            live++;
+            continue;
+        }
+        if (vacposting == NULL) {
+            vacposting = (BTVacuumPosting)palloc(offsetof(BTVacuumPostingData, deletetids) + nitem * sizeof(uint16));
+            vacposting->itup = posting;
+            vacposting->updatedoffset = updatedoffset;
+            vacposting->ndeletedtids = 0;
+        }
+        vacposting->deletetids[vacposting->ndeletedtids++] = (uint16)i;
+    }
+
+    *nremaining = live;
+    return vacposting;
+}
+
 /*
  *	btcanreturn() -- Check whether btree indexes support index-only scans.
  *
@@ -1338,6 +1407,10 @@ static IndexTuple btgetindextuple(IndexScanDesc scan, ScanDirection dir, BlockNu
     }
 
     /* Return the index tuple we found. */
+    /* the key of a posting list tuple is shared by all of its heap TIDs */
+    if (scan->xs_itup != NULL)
+        scan->xs_itup->t_tid = scan->xs_ctup.t_self;
+
     if (heapTupleBlkOffset != 0) {
         IndexTuple itup = scan->xs_itup;
         BlockNumber dest_blkno = ItemPointerGetBlockNumber(&(itup->t_tid));
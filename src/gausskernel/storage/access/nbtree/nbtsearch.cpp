@@ -31,6 +31,9 @@
 
 static bool _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum);
 static void _bt_saveitem(BTScanOpaque so, int itemIndex, OffsetNumber offnum, IndexTuple itup, Oid partOid);
+static int _bt_setuppostingitems(BTScanOpaque so, IndexTuple itup);
+static void _bt_savepostingitem(BTScanOpaque so, int itemIndex, OffsetNumber offnum, ItemPointer heapTid,
+    int tupleOffset, Oid partOid);
 static bool _bt_steppage(IndexScanDesc scan, ScanDirection dir);
 static bool _bt_readnextpage(IndexScanDesc scan, BlockNumber blkno, ScanDirection dir);
 static bool _bt_parallel_readpage(IndexScanDesc scan, BlockNumber blkno, ScanDirection dir);
@@ -1139,8 +1142,19 @@ static bool _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber off
                               : heapOid;
                 Assert(!isnull);
                 /* tuple passes all scan key conditions, so remember it */
-                _bt_saveitem(so, itemIndex, offnum, itup, partOid);
-                itemIndex++;
+                if (!BTreeTupleIsPosting(itup)) {
+                    _bt_saveitem(so, itemIndex, offnum, itup, partOid);
+                    itemIndex++;
+                } else {
+                    /* remember every heap TID of the posting list, in order */
+                    int tupleOffset = _bt_setuppostingitems(so, itup);
+
+                    for (int i = 0; i < BTreeTupleGetNPosting(itup); i++) {
+                        _bt_savepostingitem(so, itemIndex, offnum, BTreeTupleGetPostingN(itup, i), tupleOffset,
+                            partOid);
+                        itemIndex++;
+                    }
+                }
             }
             if (!continuescan) {
                 /* there can't be any more matches, so stop */
@@ -1151,13 +1165,13 @@ static bool _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber off
             offnum = OffsetNumberNext(offnum);
         }
 
-        Assert(itemIndex <= MaxIndexTuplesPerPage);
+        Assert(itemIndex <= MaxTIDsPerBTreePage);
         so->currPos.firstItem = 0;
         so->currPos.lastItem = itemIndex - 1;
         so->currPos.itemIndex = 0;
     } else {
         /* load items[] in descending order */
-        itemIndex = MaxIndexTuplesPerPage;
+        itemIndex = MaxTIDsPerBTreePage;
 
         offnum = Min(offnum, maxoff);
 
@@ -1170,8 +1184,19 @@ static bool _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber off
                               : heapOid;
                 Assert(!isnull);
                 /* tuple passes all scan key conditions, so remember it */
-                itemIndex--;
-                _bt_saveitem(so, itemIndex, offnum, itup, partOid);
+                if (!BTreeTupleIsPosting(itup)) {
+                    itemIndex--;
+                    _bt_saveitem(so, itemIndex, offnum, itup, partOid);
+                } else {
+                    /* items[] is filled back-to-front, so walk the posting list backwards */
+                    int tupleOffset = _bt_setuppostingitems(so, itup);
+
+                    for (int i = BTreeTupleGetNPosting(itup) - 1; i >= 0; i--) {
+                        itemIndex--;
+                        _bt_savepostingitem(so, itemIndex, offnum, BTreeTupleGetPostingN(itup, i), tupleOffset,
+                            partOid);
+                    }
+                }
             }
             if (!continuescan) {
                 /* there can't be any more matches, so stop */
@@ -1184,8 +1209,8 @@ static bool _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber off
 
         Assert(itemIndex >= 0);
         so->currPos.firstItem = itemIndex;
-        so->currPos.lastItem = MaxIndexTuplesPerPage - 1;
-        so->currPos.itemIndex = MaxIndexTuplesPerPage - 1;
+        so->currPos.lastItem = MaxTIDsPerBTreePage - 1;
+        so->currPos.itemIndex = MaxTIDsPerBTreePage - 1;
     }
 
     gstrace_exit(GS_TRC_ID__bt_readpage);
@@ -1210,6 +1235,45 @@ static void _bt_saveitem(BTScanOpaque so, int itemIndex, OffsetNumber offnum, co
     }
 }
 
+/*
+ * Set up for saving the heap TIDs of a posting list tuple.  For index-only
+ * scans the key is saved once, as a plain tuple, and shared by all the TIDs;
+ * returns its offset in the workspace.
+ */
+static int _bt_setuppostingitems(BTScanOpaque so, IndexTuple itup)
+{
+    Size keysize = BTreeTupleGetPostingOffset(itup);
+    int tupleOffset = so->currPos.nextTupleOffset;
+    IndexTuple base;
+    errno_t rc;
+
+    if (so->currTuples == NULL)
+        return 0;
+
+    base = (IndexTuple)(so->currTuples + tupleOffset);
+    rc = memcpy_s(base, keysize, itup, keysize);
+    securec_check(rc, "", "");
+    base->t_info &= ~(INDEX_SIZE_MASK | INDEX_ALT_TID_MASK);
+    base->t_info |= keysize;
+    base->t_tid = *BTreeTupleGetPosting(itup);
+    so->currPos.nextTupleOffset += MAXALIGN(keysize);
+
+    return tupleOffset;
+}
+
+/* Save one heap TID of a posting list tuple into so->currPos.items[itemIndex] */
+static void _bt_savepostingitem(BTScanOpaque so, int itemIndex, OffsetNumber offnum, ItemPointer heapTid,
+    int tupleOffset, Oid partOid)
+{
+    BTScanPosItem* currItem = &so->currPos.items[itemIndex];
+
+    currItem->heapTid = *heapTid;
+    currItem->indexOffset = offnum;
+    currItem->partitionOid = partOid;
+    if (so->currTuples)
+        currItem->tupleOffset = (LocationIndex)tupleOffset;
+}
+
 /*
  *	_bt_steppage() -- Step to next page containing valid data for scan
  *
@@ -1785,8 +1849,8 @@ bool _bt_gettuple_internal(IndexScanDesc scan, ScanDirection dir)
                  * just forget any excess entries.
                  */
                 if (so->killedItems == NULL)
-                    so->killedItems = (int*)palloc(MaxIndexTuplesPerPage * sizeof(int));
-                if (so->numKilled < MaxIndexTuplesPerPage)
+                    so->killedItems = (int*)palloc(MaxTIDsPerBTreePage * sizeof(int));
+                if (so->numKilled < MaxTIDsPerBTreePage)
                     so->killedItems[so->numKilled++] = so->currPos.itemIndex;
             }
 
@@ -213,6 +213,8 @@ static Page _bt_blnewpage(uint32 level);
 static void _bt_slideleft(Page page);
 static void _bt_sortaddtup(Page page, Size itemsize, IndexTuple itup, OffsetNumber itup_off);
 static void _bt_load(BTWriteState* wstate, BTSpool* btspool, BTSpool* btspool2);
+static void _bt_buildadd_run(BTWriteState* wstate, BTPageState* state, IndexTuple base, ItemPointerData* htids,
+    int nhtids);
 
 static void _bt_begin_parallel(BTBuildState *buildstate, bool isconcurrent, int request, void *meminfo);
 static void _bt_end_parallel(BTLeader *btleader);
@@ -915,6 +917,12 @@ void _bt_buildadd(BTWriteState* wstate, BTPageState* state, IndexTuple itup)
             /* delete "wrong" high key, insert keytup as P_HIKEY. */
             PageIndexTupleDelete(opage, P_HIKEY);
             _bt_sortaddtup(opage, IndexTupleSize(keytup), keytup, P_HIKEY);
+        } else if (P_ISLEAF(opageop) && BTreeTupleIsPosting(oitup)) {
+            /* Likewise, a high key only needs the key of a posting list tuple */
+            keytup = _bt_strip_posting(oitup);
+            PageIndexTupleDelete(opage, P_HIKEY);
+            _bt_sortaddtup(opage, IndexTupleSize(keytup), keytup, P_HIKEY);
+            pfree(keytup);
         }
         /*
          * Link the old page into its parent, using its minimum key. If we
@@ -1069,6 +1077,26 @@ void _bt_uppershutdown(BTWriteState* wstate, BTPageState* state)
     _bt_blwritepage(wstate, metapage, BTREE_METAPAGE);
 }
 
+/*
+ * Add a run of leaf tuples with the key of base and the heap TIDs htids,
+ * as a single posting list tuple if there is more than one of them.
+ */
+static void _bt_buildadd_run(BTWriteState* wstate, BTPageState* state, IndexTuple base, ItemPointerData* htids,
+    int nhtids)
+{
+    IndexTuple posting;
+
+    if (nhtids == 1) {
+        _bt_buildadd(wstate, state, base);
+        return;
+    }
+
+    qsort(htids, nhtids, sizeof(ItemPointerData), _bt_tid_cmp);
+    posting = _bt_form_posting(base, htids, nhtids);
+    _bt_buildadd(wstate, state, posting);
+    pfree(posting);
+}
+
 /*
  * Read tuples in correct sort order from tuplesort, and load them into
  * btree leaves.
@@ -1124,6 +1152,44 @@ static void _bt_load(BTWriteState* wstate, BTSpool* btspool, BTSpool* btspool2)
             }
         }
         _bt_freeskey(indexScanKey);
+    } else if (_bt_dedup_enabled(wstate->index)) {
+        /*
+         * Merge each run of equal keys into posting list tuples on the fly,
+         * so that the index starts out deduplicated.
+         */
+        IndexTuple base = NULL;
+        ItemPointerData* htids = (ItemPointerData*)palloc(MaxTIDsPerBTreePage * sizeof(ItemPointerData));
+        int nhtids = 0;
+
+        while ((itup = tuplesort_getindextuple(btspool->sortstate, true, &should_free)) != NULL) {
+            /* When we see first tuple, create first index page */
+            if (state == NULL)
+                state = _bt_pagestate(wstate, 0);
+
+            if (base != NULL && _bt_keys_image_equal(base, itup) &&
+                MAXALIGN(IndexTupleSize(base) + (nhtids + 1) * sizeof(ItemPointerData)) <=
+                    BTMaxItemSize(state->btps_page)) {
+                htids[nhtids++] = itup->t_tid;
+            } else {
+                if (base != NULL) {
+                    _bt_buildadd_run(wstate, state, base, htids, nhtids);
+                    pfree(base);
+                }
+                base = CopyIndexTuple(itup);
+                htids[0] = itup->t_tid;
+                nhtids = 1;
+            }
+
+            if (should_free) {
+                pfree(itup);
+                itup = NULL;
+            }
+        }
+        if (base != NULL) {
+            _bt_buildadd_run(wstate, state, base, htids, nhtids);
+            pfree(base);
+        }
+        pfree(htids);
     } else {
         /* merge is unnecessary */
         while ((itup = tuplesort_getindextuple(btspool->sortstate, true, &should_free)) != NULL) {
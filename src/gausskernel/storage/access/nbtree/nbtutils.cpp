@@ -38,6 +38,8 @@ static int _bt_compare_array_elements(const void* a, const void* b, void* arg);
 static bool _bt_compare_scankey_args(IndexScanDesc scan, ScanKey op, ScanKey leftarg, ScanKey rightarg, bool* result);
 static bool _bt_fix_scankey_strategy(ScanKey skey, const int16* indoption);
 static void _bt_mark_scankey_required(ScanKey skey);
+static int _bt_posting_find_tid(IndexTuple itup, ItemPointer htid);
+static bool _bt_posting_all_killed(BTScanOpaque so, IndexTuple itup, OffsetNumber offnum);
 static bool _bt_check_rowcompare(
     ScanKey skey, IndexTuple tuple, TupleDesc tupdesc, ScanDirection dir, bool* continuescan);
 
@@ -1559,6 +1561,50 @@ static bool _bt_check_rowcompare(
     return result;
 }
 
+/* does the posting list of itup contain heap TID htid? */
+static int _bt_posting_find_tid(IndexTuple itup, ItemPointer htid)
+{
+    int low = 0;
+    int high = BTreeTupleGetNPosting(itup) - 1;
+
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        int32 cmp = ItemPointerCompare(BTreeTupleGetPostingN(itup, mid), htid);
+
+        if (cmp == 0)
+            return mid;
+        if (cmp < 0)
+            low = mid + 1;
+        else
+            high = mid - 1;
+    }
+    return -1;
+}
+
+/* were all the heap TIDs of the posting list tuple at offnum killed? */
+static bool _bt_posting_all_killed(BTScanOpaque so, IndexTuple itup, OffsetNumber offnum)
+{
+    int nposting = BTreeTupleGetNPosting(itup);
+    bool* killed = (bool*)palloc0(nposting * sizeof(bool));
+    int nkilled = 0;
+
+    for (int i = 0; i < so->numKilled; i++) {
+        BTScanPosItem* kitem = &so->currPos.items[so->killedItems[i]];
+        int pos;
+
+        if (kitem->indexOffset != offnum)
+            continue;
+        pos = _bt_posting_find_tid(itup, &kitem->heapTid);
+        if (pos >= 0 && !killed[pos]) {
+            killed[pos] = true;
+            nkilled++;
+        }
+    }
+
+    pfree(killed);
+    return nkilled == nposting;
+}
+
 /*
  * _bt_killitems - set LP_DEAD state for items an indexscan caller has
  * told us were killed
@@ -1580,7 +1626,11 @@ static bool _bt_check_rowcompare(
  * the page, and so there is no need to search left from the recorded offset.
  * (This observation also guarantees that the item is still the right one
  * to delete, which might otherwise be questionable since heap TIDs can get
- * recycled.)
+ * recycled.)  Deduplication may have merged items into a posting list tuple
+ * at a lower offset since we read the page; such items are just not found.
+ *
+ * A posting list tuple is only marked LP_DEAD when every one of its heap
+ * TIDs was killed.
  */
 void _bt_killitems(IndexScanDesc scan, bool haveLock)
 {
@@ -1591,6 +1641,7 @@ void _bt_killitems(IndexScanDesc scan, bool haveLock)
     OffsetNumber maxoff;
     int i;
     bool killedsomething = false;
+    OffsetNumber lastpostingoff = InvalidOffsetNumber;
     AttrNumber partitionOidAttr;
     TupleDesc tupdesc;
     Oid heapOid = IndexScanGetPartHeapOid(scan);
@@ -1626,7 +1677,20 @@ void _bt_killitems(IndexScanDesc scan, bool haveLock)
                                   ? DatumGetUInt32(index_getattr(ituple, partitionOidAttr, tupdesc, &isNull))
                                   : heapOid;
             Assert(!isNull);
-            if (ItemPointerEquals(&ituple->t_tid, &kitem->heapTid) && currPartOid == partOid) {
+            if (BTreeTupleIsPosting(ituple)) {
+                if (_bt_posting_find_tid(ituple, &kitem->heapTid) >= 0) {
+                    /*
+                     * found the posting list tuple; it is dead only if every
+                     * one of its heap TIDs was killed
+                     */
+                    if (offnum != lastpostingoff && _bt_posting_all_killed(so, ituple, offnum)) {
+                        ItemIdMarkDead(iid);
+                        killedsomething = true;
+                    }
+                    lastpostingoff = offnum;
+                    break; /* out of inner search loop */
+                }
+            } else if (ItemPointerEquals(&ituple->t_tid, &kitem->heapTid) && currPartOid == partOid) {
                 /* found the item */
                 ItemIdMarkDead(iid);
                 killedsomething = true;
@@ -52,6 +52,10 @@ enum {
     BTREE_DELETE_ORIG_BLOCK_NUM = 0,
 };
 
+enum {
+    BTREE_DEDUP_ORIG_BLOCK_NUM = 0,
+};
+
 enum {
     BTREE_DELETE_PAGE_TARGET_BLOCK_NUM = 0,
     BTREE_DELETE_PAGE_LEFT_BLOCK_NUM,
@@ -378,13 +382,30 @@ static void btree_xlog_vacuum(XLogReaderState* record)
         Size len;
 
         ptr = XLogRecGetBlockData(record, BTREE_VACUUM_ORIG_BLOCK_NUM, &len);
-        btree_xlog_vacuum_operator_page(&redobuf, (void*)xlrec, (void*)ptr, len);
+        btree_xlog_vacuum_operator_page(&redobuf, (void*)xlrec, XLogRecGetDataLen(record), (void*)ptr, len);
         MarkBufferDirty(redobuf.buf);
     }
     if (BufferIsValid(redobuf.buf))
         UnlockReleaseBuffer(redobuf.buf);
 }
 
+static void btree_xlog_dedup(XLogReaderState* record)
+{
+    RedoBufferInfo buffer;
+
+    if (XLogReadBufferForRedo(record, BTREE_DEDUP_ORIG_BLOCK_NUM, &buffer) == BLK_NEEDS_REDO) {
+        char* ptr = NULL;
+        Size len;
+
+        ptr = XLogRecGetBlockData(record, BTREE_DEDUP_ORIG_BLOCK_NUM, &len);
+        btree_xlog_dedup_operator_page(&buffer, (void*)XLogRecGetData(record), (void*)ptr, len);
+        MarkBufferDirty(buffer.buf);
+    }
+    if (BufferIsValid(buffer.buf)) {
+        UnlockReleaseBuffer(buffer.buf);
+    }
+}
+
 static void btree_xlog_delete(XLogReaderState* record)
 {
     RedoBufferInfo buffer;
@@ -589,6 +610,9 @@ void btree_redo(XLogReaderState* record)
         case XLOG_BTREE_REUSE_PAGE:
             btree_xlog_reuse_page(record);
             break;
+        case XLOG_BTREE_DEDUP:
+            btree_xlog_dedup(record);
+            break;
         default:
             ereport(PANIC, (errmsg("btree_redo: unknown op code %hhu", info)));
     }
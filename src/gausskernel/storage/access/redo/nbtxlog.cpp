@@ -63,6 +63,10 @@ enum {
     BTREE_DELETE_ORIG_BLOCK_NUM = 0,
 };
 
+enum {
+    BTREE_DEDUP_ORIG_BLOCK_NUM = 0,
+};
+
 enum {
     BTREE_DELETE_PAGE_TARGET_BLOCK_NUM = 0,
     BTREE_DELETE_PAGE_LEFT_BLOCK_NUM,
@@ -301,12 +305,64 @@ void btree_xlog_split_operator_leftpage(RedoBufferInfo* lbuf, void* recorddata,
     PageSetLSN(lpage, lbuf->lsn);
 }
 
-void btree_xlog_vacuum_operator_page(RedoBufferInfo* redobuffer, void* recorddata, void* blkdata, Size len)
+/*
+ * Replace the posting list tuples a VACUUM record updates; see
+ * xl_btree_update.  Must run before the record's deletions are applied.
+ */
+static void btree_xlog_vacuum_update_posting(Page page, char* ptr, int nupdated)
+{
+    for (int i = 0; i < nupdated; i++) {
+        xl_btree_update update;
+        BTVacuumPosting vacposting;
+        errno_t rc;
+
+        rc = memcpy_s(&update, sizeof(xl_btree_update), ptr, SizeOfBtreeUpdate);
+        securec_check(rc, "\0", "\0");
+        ptr += SizeOfBtreeUpdate;
+
+        vacposting =
+            (BTVacuumPosting)palloc(offsetof(BTVacuumPostingData, deletetids) + update.ndeletedtids * sizeof(uint16));
+        vacposting->itup = (IndexTuple)PageGetItem(page, PageGetItemId(page, update.offnum));
+        vacposting->updatedoffset = update.offnum;
+        vacposting->ndeletedtids = update.ndeletedtids;
+        rc = memcpy_s(vacposting->deletetids, update.ndeletedtids * sizeof(uint16), ptr,
+            update.ndeletedtids * sizeof(uint16));
+        securec_check(rc, "\0", "\0");
+        ptr += update.ndeletedtids * sizeof(uint16);
+
+        _bt_update_posting(vacposting);
+        PageIndexTupleDelete(page, update.offnum);
+        if (PageAddItem(page, (Item)vacposting->itup, MAXALIGN(IndexTupleSize(vacposting->itup)), update.offnum,
+            false, false) == InvalidOffsetNumber)
+            ereport(PANIC, (errmsg("btree_xlog_vacuum: failed to update posting list tuple")));
+        pfree(vacposting->itup);
+        pfree(vacposting);
+    }
+}
+
+void btree_xlog_vacuum_operator_page(
+    RedoBufferInfo* redobuffer, void* recorddata, Size recorddatalen, void* blkdata, Size len)
 {
     Page page = redobuffer->pageinfo.page;
     char* ptr = (char*)blkdata;
     BTPageOpaqueInternal opaque;
 
+    /* posting list updates extend the record, see xl_btree_vacuum */
+    if (recorddatalen >= SizeOfBtreeVacuum + SizeOfBtreeVacuumPosting) {
+        xl_btree_vacuum_posting xlposting;
+        Size deletedlen;
+        errno_t rc;
+
+        rc = memcpy_s(&xlposting, sizeof(xl_btree_vacuum_posting), (char*)recorddata + SizeOfBtreeVacuum,
+            SizeOfBtreeVacuumPosting);
+        securec_check(rc, "\0", "\0");
+        deletedlen = xlposting.ndeleted * sizeof(OffsetNumber);
+        Assert(len > deletedlen);
+
+        btree_xlog_vacuum_update_posting(page, ptr + deletedlen, xlposting.nupdated);
+        len = deletedlen;
+    }
+
     if (len > 0) {
         OffsetNumber* unused = NULL;
         OffsetNumber* unend = NULL;
@@ -369,6 +425,23 @@ void btree_xlog_delete_operator_page(RedoBufferInfo* buffer, void* recorddata, S
     }
 }
 
+void btree_xlog_dedup_operator_page(RedoBufferInfo* buffer, void* recorddata, void* blkdata, Size len)
+{
+    xl_btree_dedup* xlrec = (xl_btree_dedup*)recorddata;
+    Page page = buffer->pageinfo.page;
+    Page newpage;
+
+    Assert(len == xlrec->nintervals * sizeof(BTDedupInterval));
+
+    newpage = _bt_dedup_build_page(page, (BTDedupInterval*)blkdata, xlrec->nintervals);
+    PageRestoreTempPage(newpage, page);
+
+    PageSetLSN(page, buffer->lsn);
+    if (module_logging_is_on(MOD_REDO)) {
+        DumpPageInfo(page, buffer->lsn);
+    }
+}
+
 void btree_xlog_delete_page_operator_parentpage(RedoBufferInfo* buffer, void* recorddata, uint8 info)
 {
     xl_btree_delete_page* xlrec = (xl_btree_delete_page*)recorddata;
@@ -621,6 +694,20 @@ static XLogRecParseState* btree_xlog_delete_parse_block(XLogReaderState* record,
     return recordstatehead;
 }
 
+static XLogRecParseState* btree_xlog_dedup_parse_block(XLogReaderState* record, uint32* blocknum)
+{
+    XLogRecParseState* recordstatehead = NULL;
+
+    *blocknum = 1;
+    XLogParseBufferAllocListFunc(record, &recordstatehead, NULL);
+    if (recordstatehead == NULL) {
+        return NULL;
+    }
+
+    XLogRecSetBlockDataState(record, BTREE_DEDUP_ORIG_BLOCK_NUM, recordstatehead);
+    return recordstatehead;
+}
+
 static XLogRecParseState* btree_xlog_delete_page_parse_block(XLogReaderState* record, uint32* blocknum)
 {
     uint8 info = XLogRecGetInfo(record) & ~XLR_INFO_MASK;
@@ -767,6 +854,9 @@ XLogRecParseState* btree_redo_parse_to_block(XLogReaderState* record, uint32* bl
         case XLOG_BTREE_REUSE_PAGE:
             recordblockstate = btree_xlog_reuse_page_parse_block(record, blocknum);
             break;
+        case XLOG_BTREE_DEDUP:
+            recordblockstate = btree_xlog_dedup_parse_block(record, blocknum);
+            break;
         default:
             ereport(PANIC, (errmsg("btree_redo_parse_to_block: unknown op code %u", info)));
     }
@@ -863,13 +953,14 @@ static void btree_xlog_vacuum_block(
     XLogRedoAction action;
     action = XLogCheckBlockDataRedoAction(datadecode, bufferinfo);
     if (action == BLK_NEEDS_REDO) {
-        char* maindata = XLogBlockDataGetMainData(datadecode, NULL);
+        Size maindatalen;
+        char* maindata = XLogBlockDataGetMainData(datadecode, &maindatalen);
         Size blkdatalen = 0;
         char* blkdata = NULL;
 
         blkdata = XLogBlockDataGetBlockData(datadecode, &blkdatalen);
 
-        btree_xlog_vacuum_operator_page(bufferinfo, (void*)maindata, (void*)blkdata, blkdatalen);
+        btree_xlog_vacuum_operator_page(bufferinfo, (void*)maindata, maindatalen, (void*)blkdata, blkdatalen);
 
         MakeRedoBufferDirty(bufferinfo);
     }
@@ -890,6 +981,25 @@ static void btree_xlog_delete_block(
     }
 }
 
+static void btree_xlog_dedup_block(
+    XLogBlockHead* blockhead, XLogBlockDataParse* blockdatarec, RedoBufferInfo* bufferinfo)
+{
+    XLogBlockDataParse* datadecode = blockdatarec;
+    XLogRedoAction action;
+    action = XLogCheckBlockDataRedoAction(datadecode, bufferinfo);
+    if (action == BLK_NEEDS_REDO) {
+        char* maindata = XLogBlockDataGetMainData(datadecode, NULL);
+        Size blkdatalen = 0;
+        char* blkdata = NULL;
+
+        blkdata = XLogBlockDataGetBlockData(datadecode, &blkdatalen);
+
+        btree_xlog_dedup_operator_page(bufferinfo, (void*)maindata, (void*)blkdata, blkdatalen);
+
+        MakeRedoBufferDirty(bufferinfo);
+    }
+}
+
 static void btree_xlog_delete_page_block(
     XLogBlockHead* blockhead, XLogBlockDataParse* blockdatarec, RedoBufferInfo* bufferinfo)
 {
@@ -982,6 +1092,9 @@ void btree_redo_data_block(XLogBlockHead* blockhead, XLogBlockDataParse* blockda
         case XLOG_BTREE_NEWROOT:
             btree_xlog_newroot_block(blockhead, blockdatarec, bufferinfo);
             break;
+        case XLOG_BTREE_DEDUP:
+            btree_xlog_dedup_block(blockhead, blockdatarec, bufferinfo);
+            break;
         default:
             ereport(PANIC, (errmsg("btree_redo_block: unknown op code %u", info)));
     }
@@ -80,6 +80,11 @@ void btree_desc(StringInfo buf, XLogReaderState* record)
             xl_btree_vacuum* xlrec = (xl_btree_vacuum*)rec;
 
             appendStringInfo(buf, "vacuum: lastBlockVacuumed %u ", xlrec->lastBlockVacuumed);
+            if (XLogRecGetDataLen(record) >= SizeOfBtreeVacuum + SizeOfBtreeVacuumPosting) {
+                xl_btree_vacuum_posting* xlposting = (xl_btree_vacuum_posting*)(rec + SizeOfBtreeVacuum);
+
+                appendStringInfo(buf, "ndeleted %u; nupdated %u", xlposting->ndeleted, xlposting->nupdated);
+            }
             break;
         }
         case XLOG_BTREE_DELETE: {
@@ -166,6 +171,12 @@ void btree_desc(StringInfo buf, XLogReaderState* record)
             }
             break;
         }
+        case XLOG_BTREE_DEDUP: {
+            xl_btree_dedup* xlrec = (xl_btree_dedup*)rec;
+
+            appendStringInfo(buf, "dedup: nintervals %u", xlrec->nintervals);
+            break;
+        }
         default:
             appendStringInfo(buf, "UNKNOWN");
             break;
@@ -46,10 +46,42 @@ Datum dw_get_node_name()
     }
 }
 
+static inline int dw_file_num()
+{
+    return g_instance.attr.attr_storage.dw_file_num;
+}
+
+static void dw_get_file_name(int file_id, char* file_name, size_t len)
+{
+    errno_t rc;
+    if (file_id == 0) {
+        rc = strcpy_s(file_name, len, DW_FILE_NAME);
+        securec_check(rc, "\0", "\0");
+    } else {
+        rc = snprintf_s(file_name, len, len - 1, "%s%d", DW_FILE_NAME_PREFIX, file_id);
+        securec_check_ss(rc, "\0", "\0");
+    }
+}
+
+static inline uint64 dw_read_stat(int file_id, size_t offset)
+{
+    return *(volatile uint64*)((char*)&g_instance.dw_cxt[file_id].stat_info + offset);
+}
+
+/* statistic of all the double write files in use */
+static Datum dw_sum_stat(size_t offset)
+{
+    uint64 sum = 0;
+    for (int i = 0; i < dw_file_num(); i++) {
+        sum += dw_read_stat(i, offset);
+    }
+    return UInt64GetDatum(sum);
+}
+
 Datum dw_get_dw_number()
 {
     if (dw_enabled()) {
-        return UInt64GetDatum((uint64)g_instance.dw_cxt.file_head->head.dwn);
+        return UInt64GetDatum((uint64)g_instance.dw_cxt[0].file_head->head.dwn);
     }
 
     return UInt64GetDatum(0);
@@ -58,7 +90,7 @@ Datum dw_get_dw_number()
 Datum dw_get_start_page()
 {
     if (dw_enabled()) {
-        return UInt64GetDatum((uint64)g_instance.dw_cxt.file_head->start);
+        return UInt64GetDatum((uint64)g_instance.dw_cxt[0].file_head->start);
     }
 
     return UInt64GetDatum(0);
@@ -66,42 +98,42 @@ Datum dw_get_start_page()
 
 Datum dw_get_file_trunc_num()
 {
-    return UInt64GetDatum(g_instance.dw_cxt.stat_info.file_trunc_num);
+    return dw_sum_stat(offsetof(dw_stat_info, file_trunc_num));
 }
 
 Datum dw_get_file_reset_num()
 {
-    return UInt64GetDatum(g_instance.dw_cxt.stat_info.file_reset_num);
+    return dw_sum_stat(offsetof(dw_stat_info, file_reset_num));
 }
 
 Datum dw_get_total_writes()
 {
-    return UInt64GetDatum(g_instance.dw_cxt.stat_info.total_writes);
+    return dw_sum_stat(offsetof(dw_stat_info, total_writes));
 }
 
 Datum dw_get_low_threshold_writes()
 {
-    return UInt64GetDatum(g_instance.dw_cxt.stat_info.low_threshold_writes);
+    return dw_sum_stat(offsetof(dw_stat_info, low_threshold_writes));
 }
 
 Datum dw_get_high_threshold_writes()
 {
-    return UInt64GetDatum(g_instance.dw_cxt.stat_info.high_threshold_writes);
+    return dw_sum_stat(offsetof(dw_stat_info, high_threshold_writes));
 }
 
 Datum dw_get_total_pages()
 {
-    return UInt64GetDatum(g_instance.dw_cxt.stat_info.total_pages);
+    return dw_sum_stat(offsetof(dw_stat_info, total_pages));
 }
 
 Datum dw_get_low_threshold_pages()
 {
-    return UInt64GetDatum(g_instance.dw_cxt.stat_info.low_threshold_pages);
+    return dw_sum_stat(offsetof(dw_stat_info, low_threshold_pages));
 }
 
 Datum dw_get_high_threshold_pages()
 {
-    return UInt64GetDatum(g_instance.dw_cxt.stat_info.high_threshold_pages);
+    return dw_sum_stat(offsetof(dw_stat_info, high_threshold_pages));
 }
 
 /* double write statistic view */
@@ -119,6 +151,92 @@ const dw_view_col_t g_dw_view_col_arr[DW_VIEW_COL_NUM] = {
     {"high_threshold_pages", INT8OID, dw_get_high_threshold_pages}
 };
 
+Datum dw_get_file_node_name(int file_id)
+{
+    return dw_get_node_name();
+}
+
+Datum dw_get_file_id(int file_id)
+{
+    return Int32GetDatum(file_id);
+}
+
+Datum dw_get_file_dw_number(int file_id)
+{
+    dw_file_head_t* file_head = g_instance.dw_cxt[file_id].file_head;
+    if (dw_enabled() && file_head != NULL) {
+        return UInt64GetDatum((uint64)file_head->head.dwn);
+    }
+
+    return UInt64GetDatum(0);
+}
+
+Datum dw_get_file_start_page(int file_id)
+{
+    dw_file_head_t* file_head = g_instance.dw_cxt[file_id].file_head;
+    if (dw_enabled() && file_head != NULL) {
+        return UInt64GetDatum((uint64)file_head->start);
+    }
+
+    return UInt64GetDatum(0);
+}
+
+Datum dw_get_file_file_trunc_num(int file_id)
+{
+    return UInt64GetDatum(g_instance.dw_cxt[file_id].stat_info.file_trunc_num);
+}
+
+Datum dw_get_file_file_reset_num(int file_id)
+{
+    return UInt64GetDatum(g_instance.dw_cxt[file_id].stat_info.file_reset_num);
+}
+
+Datum dw_get_file_total_writes(int file_id)
+{
+    return UInt64GetDatum(g_instance.dw_cxt[file_id].stat_info.total_writes);
+}
+
+Datum dw_get_file_low_threshold_writes(int file_id)
+{
+    return UInt64GetDatum(g_instance.dw_cxt[file_id].stat_info.low_threshold_writes);
+}
+
+Datum dw_get_file_high_threshold_writes(int file_id)
+{
+    return UInt64GetDatum(g_instance.dw_cxt[file_id].stat_info.high_threshold_writes);
+}
+
+Datum dw_get_file_total_pages(int file_id)
+{
+    return UInt64GetDatum(g_instance.dw_cxt[file_id].stat_info.total_pages);
+}
+
+Datum dw_get_file_low_threshold_pages(int file_id)
+{
+    return UInt64GetDatum(g_instance.dw_cxt[file_id].stat_info.low_threshold_pages);
+}
+
+Datum dw_get_file_high_threshold_pages(int file_id)
+{
+    return UInt64GetDatum(g_instance.dw_cxt[file_id].stat_info.high_threshold_pages);
+}
+
+/* per double write file statistic view, one row for each file */
+const dw_file_view_col_t g_dw_file_view_col_arr[DW_FILE_VIEW_COL_NUM] = {
+    {"node_name", TEXTOID, dw_get_file_node_name},
+    {"file_id", INT4OID, dw_get_file_id},
+    {"curr_dwn", INT8OID, dw_get_file_dw_number},
+    {"curr_start_page", INT8OID, dw_get_file_start_page},
+    {"file_trunc_num", INT8OID, dw_get_file_file_trunc_num},
+    {"file_reset_num", INT8OID, dw_get_file_file_reset_num},
+    {"total_writes", INT8OID, dw_get_file_total_writes},
+    {"low_threshold_writes", INT8OID, dw_get_file_low_threshold_writes},
+    {"high_threshold_writes", INT8OID, dw_get_file_high_threshold_writes},
+    {"total_pages", INT8OID, dw_get_file_total_pages},
+    {"low_threshold_pages", INT8OID, dw_get_file_low_threshold_pages},
+    {"high_threshold_pages", INT8OID, dw_get_file_high_threshold_pages}
+};
+
 void dw_pread_file(int fd, void* buf, int size, int64 offset)
 {
     int32 curr_size, total_size;
@@ -230,9 +348,9 @@ static bool dw_verify_pg_checksum(PageHeader page_header, BlockNumber blockNum)
     }
 }
 
-inline void dw_prepare_page(dw_batch_t* batch, uint16 page_num, uint16 page_id, uint16 dwn)
+inline void dw_prepare_page(dw_context_t* ctx, dw_batch_t* batch, uint16 page_num, uint16 page_id, uint16 dwn)
 {
-    if (g_instance.dw_cxt.contain_hashbucket == true) {
+    if (ctx->contain_hashbucket == true) {
         page_num = page_num | IS_HASH_BKT_MASK;
     }
     batch->page_num = page_num;
@@ -410,11 +528,13 @@ static void dw_recover_pages(T1* batch, T2* buf_tag, PageHeader data_page, bool
     }
 }
 
-void wait_all_dw_page_finish_flush()
+/* wait for the flushers writing the given dw file to finish flushing their data pages */
+void wait_all_dw_page_finish_flush(int file_id)
 {
     if (g_instance.bgwriter_cxt.bgwriter_procs != NULL) {
         for (int i = 0; i < g_instance.bgwriter_cxt.bgwriter_num;) {
-            if (g_instance.bgwriter_cxt.bgwriter_procs[i].thrd_dw_cxt.dw_page_idx == -1) {
+            ThrdDwCxt* thrd_dw_cxt = &g_instance.bgwriter_cxt.bgwriter_procs[i].thrd_dw_cxt;
+            if (thrd_dw_cxt->dw_file_id != file_id || thrd_dw_cxt->dw_page_idx == -1) {
                 i++;
                 continue;
             } else {
@@ -422,7 +542,8 @@ void wait_all_dw_page_finish_flush()
             }
         }
     }
-    if (g_instance.ckpt_cxt_ctl->page_writer_procs.writer_proc != NULL) {
+    if (g_instance.ckpt_cxt_ctl->page_writer_procs.writer_proc != NULL &&
+        g_instance.ckpt_cxt_ctl->page_writer_procs.thrd_dw_cxt.dw_file_id == file_id) {
         while (g_instance.ckpt_cxt_ctl->page_writer_procs.thrd_dw_cxt.dw_page_idx != -1) {
             (void)sched_yield();
         }
@@ -430,13 +551,17 @@ void wait_all_dw_page_finish_flush()
     return;
 }
 
-int get_dw_page_min_idx()
+/* the min dw page id of the given dw file whose data page is not yet flushed, 0 if none */
+int get_dw_page_min_idx(int file_id)
 {
     uint16 min_idx = 0;
     int dw_page_idx;
 
     if (g_instance.bgwriter_cxt.bgwriter_procs != NULL) {
         for (int i = 0; i < g_instance.bgwriter_cxt.bgwriter_num; i++) {
+            if (g_instance.bgwriter_cxt.bgwriter_procs[i].thrd_dw_cxt.dw_file_id != file_id) {
+                continue;
+            }
             dw_page_idx = g_instance.bgwriter_cxt.bgwriter_procs[i].thrd_dw_cxt.dw_page_idx;
             if (dw_page_idx != -1) {
                 if (min_idx == 0 || (uint16)dw_page_idx < min_idx) {
@@ -445,7 +570,8 @@ int get_dw_page_min_idx()
             }
         }
     }
-    if (g_instance.ckpt_cxt_ctl->page_writer_procs.writer_proc != NULL) {
+    if (g_instance.ckpt_cxt_ctl->page_writer_procs.writer_proc != NULL &&
+        g_instance.ckpt_cxt_ctl->page_writer_procs.thrd_dw_cxt.dw_file_id == file_id) {
         dw_page_idx = g_instance.ckpt_cxt_ctl->page_writer_procs.thrd_dw_cxt.dw_page_idx;
         if (dw_page_idx != -1) {
             if (min_idx == 0 || (uint16)dw_page_idx < min_idx) {
@@ -453,7 +579,7 @@ int get_dw_page_min_idx()
             }
         }
     }
-	
+
     return min_idx;
 }
 
@@ -492,7 +618,7 @@ static bool dw_reset_if_need(dw_context_t* ctx, uint16 pages_to_write, bool trun
         /*
          * Record min flush position for truncate because flush lock is not held during smgrsync.
          */
-        uint16 min_idx = get_dw_page_min_idx();
+        uint16 min_idx = get_dw_page_min_idx(ctx->file_id);
         if (min_idx == 0) {
             file_head->start += ctx->flush_page;
             org_start = file_head->start;
@@ -510,7 +636,7 @@ static bool dw_reset_if_need(dw_context_t* ctx, uint16 pages_to_write, bool trun
         file_head->start = DW_BATCH_FILE_START;
         ctx->last_flush_page = 0;
         ctx->flush_page = 0;
-        wait_all_dw_page_finish_flush();
+        wait_all_dw_page_finish_flush(ctx->file_id);
     }
 
     smgrsync_for_dw();
@@ -631,7 +757,7 @@ static void dw_recover_batch_head(dw_context_t* ctx, dw_batch_t* curr_head)
     errno_t rc;
     rc = memset_s(curr_head, BLCKSZ, 0, BLCKSZ);
     securec_check(rc, "\0", "\0");
-    dw_prepare_page(curr_head, 0, ctx->file_head->start, ctx->file_head->head.dwn);
+    dw_prepare_page(ctx, curr_head, 0, ctx->file_head->start, ctx->file_head->head.dwn);
     pgstat_report_waitevent(WAIT_EVENT_DW_WRITE);
     dw_pwrite_file(ctx->fd, curr_head, BLCKSZ, (curr_head->head.page_id * BLCKSZ));
     pgstat_report_waitevent(WAIT_EVENT_END);
@@ -752,24 +878,25 @@ static void dw_recover_partial_write(dw_context_t* ctx)
     MemoryContextSwitchTo(old_mem_ctx);
 }
 
-void dw_bootstrap()
+static void dw_bootstrap_file(const char* file_name)
 {
     char* unaligned_buf = NULL;
     char* file_head = NULL;
     int fd = -1;                                        /* resource fd should be initialized any way */
     int extend_buf_size = DW_FILE_EXTEND_SIZE + BLCKSZ; /* one more BLCKSZ for alignment */
 
-    if (file_exists(DW_FILE_NAME)) {
-        ereport(PANIC, (errcode_for_file_access(), errmodule(MOD_DW), "DW file already exists"));
+    if (file_exists(file_name)) {
+        ereport(PANIC,
+            (errcode_for_file_access(), errmodule(MOD_DW), errmsg("DW file \"%s\" already exists", file_name)));
     }
 
-    ereport(LOG, (errmodule(MOD_DW), errmsg("Double write bootstrap")));
+    ereport(LOG, (errmodule(MOD_DW), errmsg("Double write bootstrap, file \"%s\"", file_name)));
 
     /* Open file with O_SYNC, to make sure the data and file system control info on file after block writing. */
-    fd = open(DW_FILE_NAME, (DW_FILE_FLAG | O_CREAT), DW_FILE_PERM);
+    fd = open(file_name, (DW_FILE_FLAG | O_CREAT), DW_FILE_PERM);
     if (fd == -1) {
         ereport(PANIC,
-            (errcode_for_file_access(), errmodule(MOD_DW), errmsg("Could not create file \"%s\"", DW_FILE_NAME)));
+            (errcode_for_file_access(), errmodule(MOD_DW), errmsg("Could not create file \"%s\"", file_name)));
     }
 
     unaligned_buf = (char*)palloc0(extend_buf_size);
@@ -783,6 +910,15 @@ void dw_bootstrap()
     pfree(unaligned_buf);
 }
 
+/*
+ * Only the first dw file is created here, the others are created by dw_init on demand,
+ * since dw_file_num may be changed at any restart.
+ */
+void dw_bootstrap()
+{
+    dw_bootstrap_file(DW_FILE_NAME);
+}
+
 static void dw_init_memory(dw_context_t* ctx)
 {
     uint32 buf_size;
@@ -829,13 +965,76 @@ void dw_shmem_init()
 {
     /* LWLock Should be reset when postmaster inits shmem. */
     if (!IsUnderPostmaster) {
-        g_instance.dw_cxt.flush_lock = NULL;
+        for (int i = 0; i < DW_MAX_FILE_NUM; i++) {
+            g_instance.dw_cxt[i].flush_lock = NULL;
+        }
     }
 }
 
+/* remove the dw files left by the last startup after build, a fresh first dw file is created then */
+static void dw_remove_residual_files()
+{
+    char file_name[MAXPGPATH];
+
+    for (int i = 0; i < DW_MAX_FILE_NUM; i++) {
+        dw_get_file_name(i, file_name, MAXPGPATH);
+        if (!file_exists(file_name)) {
+            continue;
+        }
+
+        /*
+         * Probably the gaussdb was killed during the first time startup after build, resulting in a half-written
+         * DW file. So, log a warning message and remove the residual DW file.
+         */
+        ereport(WARNING,
+            (errcode_for_file_access(),
+                errmodule(MOD_DW),
+                errmsg("Residual DW file \"%s\" exists, deleting it", file_name)));
+
+        if (unlink(file_name) != 0) {
+            ereport(PANIC,
+                (errcode_for_file_access(),
+                    errmodule(MOD_DW),
+                    errmsg("Could not remove the residual DW file \"%s\"", file_name)));
+        }
+    }
+}
+
+/* open one dw file and recover the partially written pages protected by it */
+static void dw_init_file(dw_context_t* ctx, const char* file_name)
+{
+    /* double write file disk space pre-allocated, O_DSYNC for less IO */
+    ctx->fd = open(file_name, DW_FILE_FLAG, DW_FILE_PERM);
+    if (ctx->fd == -1) {
+        ereport(
+            PANIC, (errcode_for_file_access(), errmodule(MOD_DW), errmsg("Could not open file \"%s\"", file_name)));
+    }
+
+    /* LWLock has no free method, so only assign once when first init */
+    /* fail_over and switch_over will dw_exit and dw_init multiple times */
+    if (ctx->flush_lock == NULL) {
+        ctx->flush_lock = LWLockAssign(LWTRANCHE_DOUBLE_WRITE);
+    }
+
+    LWLockAcquire(ctx->flush_lock, LW_EXCLUSIVE);
+
+    ctx->flush_page = 0;
+    ctx->write_pos = 0;
+    ctx->contain_hashbucket = false;
+
+    dw_init_memory(ctx);
+
+    dw_recover_file_head(ctx);
+
+    dw_recover_partial_write(ctx);
+    LWLockRelease(ctx->flush_lock);
+}
+
 void dw_init()
 {
-    dw_context_t* ctx = &g_instance.dw_cxt;
+    dw_context_t* ctx = &g_instance.dw_cxt[0];
+    char file_name[MAXPGPATH];
+    int file_num = dw_file_num();
 
 #ifndef ENABLE_THREAD_CHECK
     if (TAS(&ctx->initialized)) {
@@ -846,24 +1045,13 @@ void dw_init()
         return;
     }
 
-    ereport(LOG, (errmodule(MOD_DW), errmsg("Double write init")));
+    ereport(LOG, (errmodule(MOD_DW), errmsg("Double write init, dw_file_num %d", file_num)));
     ctx->closed = 0;
 
     if (file_exists(DW_BUILD_FILE_NAME)) {
         ereport(LOG, (errmodule(MOD_DW), errmsg("Double write initializing after build")));
 
-        if (file_exists(DW_FILE_NAME)) {
-            /*
-             * Probably the gaussdb was killed during the first time startup after build, resulting in a half-written
-             * DW file. So, log a warning message and remove the residual DW file.
-             */
-            ereport(WARNING, (errcode_for_file_access(), errmodule(MOD_DW), "Residual DW file exists, deleting it"));
-
-            if (unlink(DW_FILE_NAME) != 0) {
-                ereport(PANIC,
-                    (errcode_for_file_access(), errmodule(MOD_DW), errmsg("Could not remove the residual DW file")));
-            }
-        }
+        dw_remove_residual_files();
 
         /* Create the DW file. */
         dw_bootstrap();
@@ -879,35 +1067,37 @@ void dw_init()
         ereport(PANIC, (errcode_for_file_access(), errmodule(MOD_DW), errmsg("DW file does not exist")));
     }
 
-    /* double write file disk space pre-allocated, O_DSYNC for less IO */
-    ctx->fd = open(DW_FILE_NAME, DW_FILE_FLAG, DW_FILE_PERM);
-    if (ctx->fd == -1) {
-        ereport(
-            PANIC, (errcode_for_file_access(), errmodule(MOD_DW), errmsg("Could not open file \"%s\"", DW_FILE_NAME)));
-    }
-
-    /* LWLock has no free method, so only assign once when first init */
-    /* fail_over and switch_over will dw_exit and dw_init multiple times */
-    if (ctx->flush_lock == NULL) {
-        ctx->flush_lock = LWLockAssign(LWTRANCHE_DOUBLE_WRITE);
-    }
-
-    LWLockAcquire(ctx->flush_lock, LW_EXCLUSIVE);
-
-    ctx->flush_page = 0;
+    /*
+     * Recover every dw file in turn. Files beyond dw_file_num are left by a former run with a larger
+     * dw_file_num, they may still protect torn pages, so recover them before removing.
+     */
+    for (int i = 0; i < DW_MAX_FILE_NUM; i++) {
+        bool in_use = (i < file_num);
 
-    dw_init_memory(ctx);
+        dw_get_file_name(i, file_name, MAXPGPATH);
+        if (!file_exists(file_name)) {
+            if (!in_use || !dw_enabled()) {
+                continue;
+            }
+            dw_bootstrap_file(file_name);
+        }
 
-    dw_recover_file_head(ctx);
+        dw_init_file(&g_instance.dw_cxt[i], file_name);
 
-    dw_recover_partial_write(ctx);
-    LWLockRelease(ctx->flush_lock);
+        if (!in_use) {
+            dw_free_resource(&g_instance.dw_cxt[i]);
+            if (unlink(file_name) != 0) {
+                ereport(PANIC, (errcode_for_file_access(), errmodule(MOD_DW),
+                    errmsg("Could not remove the unused DW file \"%s\"", file_name)));
+            }
+            ereport(LOG, (errmodule(MOD_DW), errmsg("Unused DW file \"%s\" recovered and removed", file_name)));
+        } else if (!dw_enabled()) {
+            /* After recovering partially written pages (if any), un-initialize if the double write is disabled. */
+            dw_free_resource(&g_instance.dw_cxt[i]);
+        }
+    }
 
-    /*
-     * After recovering partially written pages (if any), we will un-initialize, if the double write is disabled.
-     */
     if (!dw_enabled()) {
-        dw_free_resource(ctx);
         ctx->initialized = 0;
 
         ereport(LOG, (errmodule(MOD_DW), errmsg("Double write exit after recovering partial write")));
@@ -1001,9 +1191,9 @@ static XLogRecPtr dw_copy_page(ThrdDwCxt* thrd_dw_cxt, int buf_desc_id, bool* is
     return page_lsn;
 }
 
-inline uint16 dw_batch_add_extra(uint16 page_num)
+inline uint16 dw_batch_add_extra(const dw_context_t* dw_ctx, uint16 page_num)
 {
-    bool contain_hashbucket = g_instance.dw_cxt.contain_hashbucket;
+    bool contain_hashbucket = dw_ctx->contain_hashbucket;
     Assert(page_num <= GET_DW_DIRTY_PAGE_MAX(contain_hashbucket));
     if (page_num <= GET_DW_BATCH_DATA_PAGE_MAX(contain_hashbucket)) {
         return page_num + DW_EXTRA_FOR_ONE_BATCH;
@@ -1027,12 +1217,12 @@ static void dw_assemble_batch(dw_context_t* dw_ctx, uint16 page_id, uint16 dwn)
     }
 
     batch = (dw_batch_t*)dw_ctx->buf;
-    dw_prepare_page(batch, first_batch_pages, page_id, dwn);
+    dw_prepare_page(dw_ctx, batch, first_batch_pages, page_id, dwn);
 
     /* tail of the first batch */
     page_id = page_id + 1 + GET_REL_PGAENUM(batch->page_num);
     batch = dw_batch_tail_page(batch);
-    dw_prepare_page(batch, second_batch_pages, page_id, dwn);
+    dw_prepare_page(dw_ctx, batch, second_batch_pages, page_id, dwn);
 
     if (second_batch_pages == 0) {
         return;
@@ -1040,17 +1230,19 @@ static void dw_assemble_batch(dw_context_t* dw_ctx, uint16 page_id, uint16 dwn)
     /* also head of the second batch, if second batch not empty, prepare its tail */
     page_id = page_id + 1 + GET_REL_PGAENUM(batch->page_num);
     batch = dw_batch_tail_page(batch);
-    dw_prepare_page(batch, 0, page_id, dwn);
+    dw_prepare_page(dw_ctx, batch, 0, page_id, dwn);
 }
 
-static inline void dw_stat_flush(dw_stat_info* stat_info, uint32 page_to_write)
+static inline void dw_stat_flush(dw_context_t* dw_ctx, uint32 page_to_write)
 {
+    dw_stat_info* stat_info = &dw_ctx->stat_info;
+
     (void)pg_atomic_add_fetch_u64(&stat_info->total_writes, 1);
     (void)pg_atomic_add_fetch_u64(&stat_info->total_pages, page_to_write);
     if (page_to_write < DW_WRITE_STAT_LOWER_LIMIT) {
         (void)pg_atomic_add_fetch_u64(&stat_info->low_threshold_writes, 1);
         (void)pg_atomic_add_fetch_u64(&stat_info->low_threshold_pages, page_to_write);
-    } else if (page_to_write > GET_DW_BATCH_MAX(g_instance.dw_cxt.contain_hashbucket)) {
+    } else if (page_to_write > GET_DW_BATCH_MAX(dw_ctx->contain_hashbucket)) {
         (void)pg_atomic_add_fetch_u64(&stat_info->high_threshold_writes, 1);
         (void)pg_atomic_add_fetch_u64(&stat_info->high_threshold_pages, page_to_write);
     }
@@ -1077,7 +1269,7 @@ static void dw_flush(dw_context_t* dw_ctx, XLogRecPtr latest_lsn, ThrdDwCxt* thr
     Assert(dw_ctx->write_pos > 0);
 
     file_head = dw_ctx->file_head;
-    pages_to_write = dw_batch_add_extra(dw_ctx->write_pos);
+    pages_to_write = dw_batch_add_extra(dw_ctx, dw_ctx->write_pos);
     rc = memcpy_s(dw_ctx->buf, pages_to_write * BLCKSZ, thrd_dw_cxt->dw_buf, pages_to_write * BLCKSZ);
     securec_check(rc, "\0", "\0");
     (void)dw_reset_if_need(dw_ctx, pages_to_write, false);
@@ -1093,7 +1285,7 @@ static void dw_flush(dw_context_t* dw_ctx, XLogRecPtr latest_lsn, ThrdDwCxt* thr
     dw_pwrite_file(dw_ctx->fd, dw_ctx->buf, (pages_to_write * BLCKSZ), (offset_page * BLCKSZ));
     pgstat_report_waitevent(WAIT_EVENT_END);
 
-    dw_stat_flush(&dw_ctx->stat_info, pages_to_write);
+    dw_stat_flush(dw_ctx, pages_to_write);
 
     dw_ctx->last_flush_page = dw_ctx->flush_page;
     /* the tail of this flushed batch is the head of the next batch */
@@ -1113,7 +1305,7 @@ static void dw_flush(dw_context_t* dw_ctx, XLogRecPtr latest_lsn, ThrdDwCxt* thr
 void dw_perform(uint32 size, CkptSortItem *dirty_buf_list, ThrdDwCxt* thrd_dw_cxt)
 {
     uint16 batch_size;
-    dw_context_t* dw_ctx = &g_instance.dw_cxt;
+    dw_context_t* dw_ctx = &g_instance.dw_cxt[0];
     XLogRecPtr latest_lsn = InvalidXLogRecPtr;
     XLogRecPtr page_lsn;
 
@@ -1130,6 +1322,9 @@ void dw_perform(uint32 size, CkptSortItem *dirty_buf_list, ThrdDwCxt* thrd_dw_cx
         ereport(ERROR, (errmodule(MOD_DW), errmsg("Double write already closed")));
     }
 
+    Assert(thrd_dw_cxt->dw_file_id >= 0 && thrd_dw_cxt->dw_file_id < dw_file_num());
+    dw_ctx = &g_instance.dw_cxt[thrd_dw_cxt->dw_file_id];
+
     Assert(size > 0 && size <= GET_DW_DIRTY_PAGE_MAX(thrd_dw_cxt->contain_hashbucket));
     batch_size = (uint16)size;
     thrd_dw_cxt->write_pos = 0;
@@ -1168,19 +1363,12 @@ void dw_perform(uint32 size, CkptSortItem *dirty_buf_list, ThrdDwCxt* thrd_dw_cx
     }
 }
 
-void dw_truncate()
+static void dw_truncate_file(dw_context_t* ctx)
 {
-    dw_context_t* ctx = &g_instance.dw_cxt;
-
-    if (!dw_enabled()) {
-        /* Double write is not enabled, nothing to do. */
-        return;
-    }
-
-    gstrace_entry(GS_TRC_ID_dw_truncate);
     ereport(DW_LOG_LEVEL,
         (errmodule(MOD_DW),
-            errmsg("DW truncate start: file_head[dwn %hu, start %hu], total_pages %hu",
+            errmsg("DW truncate start: file %d, file_head[dwn %hu, start %hu], total_pages %hu",
+                ctx->file_id,
                 ctx->file_head->head.dwn,
                 ctx->file_head->start,
                 ctx->flush_page)));
@@ -1193,25 +1381,40 @@ void dw_truncate()
      * waiting for us to finish smgrsync before it can do a full recycle of dw file.
      */
     if (!LWLockConditionalAcquire(ctx->flush_lock, LW_EXCLUSIVE)) {
-        ereport(LOG, (errmodule(MOD_DW), errmsg("Can not get dw flush lock and skip dw truncate for this time")));
+        ereport(LOG, (errmodule(MOD_DW),
+            errmsg("Can not get dw flush lock of file %d and skip dw truncate for this time", ctx->file_id)));
         return;
     }
     if (dw_reset_if_need(ctx, 0, true)) {
         LWLockRelease(ctx->flush_lock);
     }
 
-    gstrace_exit(GS_TRC_ID_dw_truncate);
     ereport(LOG,
         (errmodule(MOD_DW),
-            errmsg("DW truncate end: file_head[dwn %hu, start %hu], total_pages %hu",
+            errmsg("DW truncate end: file %d, file_head[dwn %hu, start %hu], total_pages %hu",
+                ctx->file_id,
                 ctx->file_head->head.dwn,
                 ctx->file_head->start,
                 ctx->flush_page)));
 }
 
+void dw_truncate()
+{
+    if (!dw_enabled()) {
+        /* Double write is not enabled, nothing to do. */
+        return;
+    }
+
+    gstrace_entry(GS_TRC_ID_dw_truncate);
+    for (int i = 0; i < dw_file_num(); i++) {
+        dw_truncate_file(&g_instance.dw_cxt[i]);
+    }
+    gstrace_exit(GS_TRC_ID_dw_truncate);
+}
+
 void dw_exit()
 {
-    dw_context_t* ctx = &g_instance.dw_cxt;
+    dw_context_t* ctx = &g_instance.dw_cxt[0];
 
     if (!dw_enabled()) {
         /* Double write is not enabled, nothing to do. */
@@ -1235,7 +1438,9 @@ void dw_exit()
     /* Do a final truncate before free resource. */
     dw_truncate();
 
-    dw_free_resource(ctx);
+    for (int i = 0; i < dw_file_num(); i++) {
+        dw_free_resource(&g_instance.dw_cxt[i]);
+    }
 
     ctx->initialized = 0;
 }
@@ -55,6 +55,7 @@
 #include "access/extreme_rto/dispatcher.h"
 #include "access/extreme_rto/page_redo.h"
 #include "access/multi_redo_api.h"
+#include "access/redo_prefetch.h"
 
 #include "access/extreme_rto/txn_redo.h"
 #include "access/extreme_rto/spsc_blocking_queue.h"
@@ -161,7 +162,7 @@ static const RmgrDispatchData g_dispatchTable[RM_MAX_ID + 1] = {
 #endif
     { DispatchHeap2Record, RmgrRecordInfoValid, RM_HEAP2_ID, XLOG_HEAP2_FREEZE, XLOG_HEAP2_LOGICAL_NEWPAGE },
     { DispatchHeapRecord, RmgrRecordInfoValid, RM_HEAP_ID, XLOG_HEAP_INSERT, XLOG_HEAP_INPLACE },
-    { DispatchBtreeRecord, RmgrRecordInfoValid, RM_BTREE_ID, XLOG_BTREE_INSERT_LEAF, XLOG_BTREE_REUSE_PAGE },
+    { DispatchBtreeRecord, RmgrRecordInfoValid, RM_BTREE_ID, XLOG_BTREE_INSERT_LEAF, XLOG_BTREE_DEDUP },
     { DispatchHashRecord, NULL, RM_HASH_ID, 0, 0 },
     { DispatchGinRecord, RmgrRecordInfoValid, RM_GIN_ID, XLOG_GIN_CREATE_INDEX, XLOG_GIN_VACUUM_DATA_LEAF_PAGE },
     /* XLOG_GIST_PAGE_DELETE is not used and info isn't continus  */
@@ -624,6 +625,7 @@ void DispatchRedoRecordToFile(XLogReaderState* record, List* expectedTLIs, Times
 
         ResetChosedPageLineList();
         if (fatalerror != true) {
+            XLogRedoPrefetchRecord(record);
             g_dispatchTable[rmid].rm_dispatch(record, expectedTLIs, recordXTime);
         } else {
             DispatchDefaultRecord(record, expectedTLIs, recordXTime);
@@ -1596,6 +1598,7 @@ void SendRecoveryEndMarkToWorkersAndWaitForFinish(int code)
         WaitPageRedoWorkerReachLastMark(g_dispatcher->readLine.readThd);
         WaitPageRedoWorkerReachLastMark(g_dispatcher->readLine.readPageThd);
         WaitPageRedoWorkerReachLastMark(g_dispatcher->trxnLine.managerThd);
+        XLogRedoPrefetchEnd();
         LsnUpdate();
     }
 }
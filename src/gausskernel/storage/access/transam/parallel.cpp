@@ -14,6 +14,9 @@
 
 #include "postgres.h"
 
+#include "access/cstore_insert.h"
+#include "access/gin_private.h"
+#include "access/hash.h"
 #include "access/nbtree.h"
 #include "access/parallel.h"
 #include "access/xact.h"
@@ -22,6 +25,7 @@
 #include "catalog/index.h"
 #include "catalog/namespace.h"
 #include "commands/async.h"
+#include "commands/vacuum.h"
 #include "executor/execParallel.h"
 #include "libpq/libpq.h"
 #include "libpq/pqsignal.h"
@@ -69,6 +73,18 @@ static const struct {
     },
     {
         "_bt_parallel_build_main", _bt_parallel_build_main
+    },
+    {
+        "_h_parallel_build_main", _h_parallel_build_main
+    },
+    {
+        "_gin_parallel_build_main", _gin_parallel_build_main
+    },
+    {
+        "CStoreCompressWorkerMain", CStoreCompressWorkerMain
+    },
+    {
+        "lazy_parallel_vacuum_main", lazy_parallel_vacuum_main
     }
 };
 
@@ -54,6 +54,7 @@
 #include "access/parallel_recovery/dispatcher.h"
 #include "access/parallel_recovery/page_redo.h"
 #include "access/multi_redo_api.h"
+#include "access/redo_prefetch.h"
 
 #include "access/parallel_recovery/txn_redo.h"
 #include "access/parallel_recovery/spsc_blocking_queue.h"
@@ -164,7 +165,7 @@ static const RmgrDispatchData g_dispatchTable[RM_MAX_ID + 1] = {
 #endif
     {DispatchHeap2Record, RmgrRecordInfoValid, RM_HEAP2_ID, XLOG_HEAP2_FREEZE, XLOG_HEAP2_LOGICAL_NEWPAGE},
     {DispatchHeapRecord, RmgrRecordInfoValid, RM_HEAP_ID, XLOG_HEAP_INSERT, XLOG_HEAP_INPLACE},
-    {DispatchBtreeRecord, RmgrRecordInfoValid, RM_BTREE_ID, XLOG_BTREE_INSERT_LEAF, XLOG_BTREE_REUSE_PAGE},
+    {DispatchBtreeRecord, RmgrRecordInfoValid, RM_BTREE_ID, XLOG_BTREE_INSERT_LEAF, XLOG_BTREE_DEDUP},
     {DispatchHashRecord, NULL, RM_HASH_ID, 0, 0},
     {DispatchGinRecord, RmgrRecordInfoValid, RM_GIN_ID, XLOG_GIN_CREATE_INDEX, XLOG_GIN_VACUUM_DATA_LEAF_PAGE},
     /* XLOG_GIST_PAGE_DELETE is not used and info isn't continus  */
@@ -582,6 +583,7 @@ void DispatchRedoRecordToFile(XLogReaderState* record, List* expectedTLIs, Times
         ResetChosedWorkerList();
 
         if (fatalerror != true) {
+            XLogRedoPrefetchRecord(record);
             isNeedFullSync = g_dispatchTable[rmid].rm_dispatch(record, expectedTLIs, recordXTime);
         } else {
             isNeedFullSync = DispatchDefaultRecord(record, expectedTLIs, recordXTime);
@@ -1557,6 +1559,7 @@ void SendRecoveryEndMarkToWorkersAndWaitForFinish(int code)
         ApplyReadyTxnLogRecords(g_dispatcher->txnWorker, true);
         for (uint32 i = 0; i < g_dispatcher->pageWorkerCount; i++)
             WaitPageRedoWorkerReachLastMark(g_dispatcher->pageWorkers[i]);
+        XLogRedoPrefetchEnd();
         SpinLockAcquire(&(g_instance.comm_cxt.predo_cxt.rwlock));
         g_instance.comm_cxt.predo_cxt.state = REDO_DONE;
         SpinLockRelease(&(g_instance.comm_cxt.predo_cxt.rwlock));
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * redo_prefetch.cpp
+ *        data block prefetch done by the parallel redo dispatcher
+ *
+ * The page redo workers read every block referenced by a record with a
+ * synchronous ReadBuffer. The dispatcher sees each record long before the
+ * workers apply it (by the length of their queues), so it hints the kernel
+ * to read the referenced blocks (posix_fadvise through smgrprefetch) when it
+ * hands the record out. Blocks already in shared buffers, blocks which are
+ * going to be overwritten by a full page image or re-initialized, and
+ * blocks hinted a short while ago are skipped.
+ *
+ * recovery_prefetch_distance bounds the number of hints outstanding ahead
+ * of the replay position, so that we don't thrash the OS cache when the
+ * workers fall far behind.
+ *
+ * IDENTIFICATION
+ *        src/gausskernel/storage/access/transam/redo_prefetch.cpp
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+#include "knl/knl_variable.h"
+
+#include "access/hash.h"
+#include "access/redo_prefetch.h"
+#include "access/rmgr.h"
+#include "access/xact.h"
+#include "access/xlog.h"
+#include "access/xlogrecord.h"
+#include "storage/buf_internals.h"
+#include "storage/bufmgr.h"
+#include "storage/smgr.h"
+
+/* number of entries of the filter for blocks hinted a short while ago, power of 2 */
+#define REDO_PREFETCH_RECENT_SIZE 1024
+
+typedef struct RedoPrefetchState {
+    int distance;        /* size of the ring, recovery_prefetch_distance when it was built */
+    int next;            /* next slot of the ring to reuse */
+    XLogRecPtr replayed; /* cached replay position of the redo workers */
+    XLogRecPtr* ring;    /* end lsn of the records of the hinted blocks */
+    BufferTag recent[REDO_PREFETCH_RECENT_SIZE];
+} RedoPrefetchState;
+
+static THR_LOCAL RedoPrefetchState* t_redoPrefetch = NULL;
+
+static RedoPrefetchState* RedoPrefetchGetState(int distance)
+{
+    RedoPrefetchState* state = t_redoPrefetch;
+
+    if (state != NULL && state->distance == distance) {
+        return state;
+    }
+
+    /* first call, or recovery_prefetch_distance was changed by SIGHUP */
+    if (state != NULL) {
+        pfree_ext(state->ring);
+    } else {
+        state = (RedoPrefetchState*)MemoryContextAllocZero(t_thrd.top_mem_cxt, sizeof(RedoPrefetchState));
+    }
+    state->distance = distance;
+    state->next = 0;
+    state->replayed = InvalidXLogRecPtr;
+    state->ring = (XLogRecPtr*)MemoryContextAllocZero(t_thrd.top_mem_cxt, sizeof(XLogRecPtr) * distance);
+    t_redoPrefetch = state;
+    return state;
+}
+
+/*
+ * The slot to reuse holds the oldest outstanding hint. It can be reused
+ * only after the workers have replayed the record it was issued for.
+ */
+static bool RedoPrefetchHasRoom(RedoPrefetchState* state)
+{
+    XLogRecPtr oldest = state->ring[state->next];
+
+    if (XLogRecPtrIsInvalid(oldest) || oldest <= state->replayed) {
+        return true;
+    }
+    /* fetch the replay position only when the cached one is not enough */
+    state->replayed = GetXLogReplayRecPtr(NULL);
+    return oldest <= state->replayed;
+}
+
+/*
+ * Records dropping or truncating relation files. Close all the files the
+ * dispatcher opened for prefetch, otherwise the space of the unlinked
+ * files is kept until the end of recovery.
+ */
+static bool RedoPrefetchRemovesFiles(XLogReaderState* record)
+{
+    RmgrId rmid = XLogRecGetRmid(record);
+
+    if (rmid == RM_SMGR_ID || rmid == RM_DBASE_ID || rmid == RM_TBLSPC_ID) {
+        return true;
+    }
+    if (rmid == RM_XACT_ID) {
+        int nrels = 0;
+        ColFileNodeRel* xnodes = NULL;
+
+        XactGetRelFiles(record, &xnodes, &nrels);
+        return nrels > 0;
+    }
+    return false;
+}
+
+/*
+ * @Description: issue prefetch for the blocks referenced by a record which is
+ *     about to be dispatched to the page redo workers.
+ * @in record: the decoded record
+ */
+void XLogRedoPrefetchRecord(XLogReaderState* record)
+{
+#if defined(USE_PREFETCH) && defined(USE_POSIX_FADVISE)
+    int distance = u_sess->attr.attr_storage.recovery_prefetch_distance;
+    RedoPerf* perf = &g_instance.comm_cxt.predo_cxt.redoPf;
+
+    if (distance == 0) {
+        if (t_redoPrefetch != NULL) {
+            XLogRedoPrefetchEnd();
+        }
+        return;
+    }
+
+    if (RedoPrefetchRemovesFiles(record)) {
+        smgrcloseall();
+        return;
+    }
+
+    RedoPrefetchState* state = RedoPrefetchGetState(distance);
+    for (int block_id = 0; block_id <= record->max_block_id; block_id++) {
+        DecodedBkpBlock* blk = &record->blocks[block_id];
+
+        /* column store files are not read through shared buffers */
+        if (!blk->in_use || blk->forknum > MAX_FORKNUM) {
+            continue;
+        }
+        if (blk->has_image || (blk->flags & BKPBLOCK_WILL_INIT)) {
+            perf->prefetch_skip_init++;
+            continue;
+        }
+
+        BufferTag tag;
+        errno_t rc = memset_s(&tag, sizeof(BufferTag), 0, sizeof(BufferTag));
+        securec_check(rc, "\0", "\0");
+        INIT_BUFFERTAG(tag, blk->rnode, blk->forknum, blk->blkno);
+
+        uint32 slot = DatumGetUInt32(hash_any((const unsigned char*)&tag, sizeof(BufferTag))) &
+                      (REDO_PREFETCH_RECENT_SIZE - 1);
+        if (BUFFERTAGS_EQUAL(state->recent[slot], tag)) {
+            perf->prefetch_recent_hits++;
+            continue;
+        }
+        if (!RedoPrefetchHasRoom(state)) {
+            perf->prefetch_throttled++;
+            continue;
+        }
+
+        SMgrRelation reln = smgropen(blk->rnode, InvalidBackendId);
+        if (!PrefetchSharedBuffer(reln, blk->forknum, blk->blkno)) {
+            perf->prefetch_buffer_hits++;
+            continue;
+        }
+        perf->prefetch_issued++;
+        state->recent[slot] = tag;
+        state->ring[state->next] = record->EndRecPtr;
+        state->next = (state->next + 1) % state->distance;
+    }
+#endif
+}
+
+/*
+ * @Description: release the prefetch state of the dispatcher, called at the
+ *     end of parallel redo or when prefetch is turned off.
+ */
+void XLogRedoPrefetchEnd()
+{
+    if (t_redoPrefetch == NULL) {
+        return;
+    }
+    pfree_ext(t_redoPrefetch->ring);
+    pfree_ext(t_redoPrefetch);
+    smgrcloseall();
+}
@@ -258,6 +258,47 @@ const RedoStatsViewObj g_redoViewArr[REDO_VIEW_COL_SIZE] = {
     {"worker_info", TEXTOID, redo_get_worker_info}
 };
 
+Datum redo_get_prefetch_distance()
+{
+    return Int32GetDatum(u_sess->attr.attr_storage.recovery_prefetch_distance);
+}
+
+Datum redo_get_prefetch_issued()
+{
+    return UInt64GetDatum(g_instance.comm_cxt.predo_cxt.redoPf.prefetch_issued);
+}
+
+Datum redo_get_prefetch_buffer_hits()
+{
+    return UInt64GetDatum(g_instance.comm_cxt.predo_cxt.redoPf.prefetch_buffer_hits);
+}
+
+Datum redo_get_prefetch_recent_hits()
+{
+    return UInt64GetDatum(g_instance.comm_cxt.predo_cxt.redoPf.prefetch_recent_hits);
+}
+
+Datum redo_get_prefetch_skip_init()
+{
+    return UInt64GetDatum(g_instance.comm_cxt.predo_cxt.redoPf.prefetch_skip_init);
+}
+
+Datum redo_get_prefetch_throttled()
+{
+    return UInt64GetDatum(g_instance.comm_cxt.predo_cxt.redoPf.prefetch_throttled);
+}
+
+/* redo prefetch statistic view */
+const RedoStatsViewObj g_redoPrefetchViewArr[REDO_PREFETCH_VIEW_COL_SIZE] = {
+    {"node_name", TEXTOID, redo_get_node_name},
+    {"prefetch_distance", INT4OID, redo_get_prefetch_distance},
+    {"prefetch_issued", INT8OID, redo_get_prefetch_issued},
+    {"buffer_hits", INT8OID, redo_get_prefetch_buffer_hits},
+    {"recent_hits", INT8OID, redo_get_prefetch_recent_hits},
+    {"skip_init", INT8OID, redo_get_prefetch_skip_init},
+    {"throttled", INT8OID, redo_get_prefetch_throttled}
+};
+
 void print_stats_file(RedoStatsData* stats)
 {
     uint32 type;
@@ -580,9 +580,11 @@ static void MarkAsPreparingGuts(GTM_TransactionHandle handle, GlobalTransaction
         proc->subxids.xids = NULL;
     }
 
-    /* backup and restore LWLock pointers */
+    /* backup and restore LWLock pointers and fast-path lock arrays */
     LWLock* bakBackendLock = proc->backendLock;
     LWLock* bakSubxidsLock = proc->subxidsLock;
+    uint64* bakFpLockBits = proc->fpLockBits;
+    FastPathTag* bakFpRelId = proc->fpRelId;
 
     /* Initialize the PGPROC entry */
     rc = memset_s(proc, sizeof(PGPROC), 0, sizeof(PGPROC));
@@ -590,6 +592,11 @@ static void MarkAsPreparingGuts(GTM_TransactionHandle handle, GlobalTransaction
 
     proc->backendLock = bakBackendLock;
     proc->subxidsLock = bakSubxidsLock;
+    proc->fpLockBits = bakFpLockBits;
+    proc->fpRelId = bakFpRelId;
+    rc = memset_s(proc->fpLockBits, FP_LOCK_GROUPS_PER_BACKEND * sizeof(uint64), 0,
+        FP_LOCK_GROUPS_PER_BACKEND * sizeof(uint64));
+    securec_check_c(rc, "", "");
 
     proc->pgprocno = gxact->pgprocno;
     SHMQueueElemInit(&(proc->links));
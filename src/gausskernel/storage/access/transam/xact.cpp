@@ -184,6 +184,7 @@ struct TransactionStateData {
     bool prevXactReadOnly;               /* entry-time xact r/o state */
     bool startedInRecovery;              /* did we start in recovery? */
     bool didLogXid;                      /* has xid been included in WAL record? */
+    bool assigned;                       /* assigned to top-level XID in WAL? */
     int parallelModeLevel;               /* Enter/ExitParallelMode counter */
     struct TransactionStateData* parent; /* back link to parent */
 
@@ -221,6 +222,7 @@ static THR_LOCAL TransactionStateData TopTransactionStateData = {
     false,              /* entry-time xact r/o state */
     false,              /* startedInRecovery */
     false,              /* didLogXid */
+    false,              /* assigned */
     0,                  /* parallelModeLevel */
     NULL,               /* link to parent state block */
     SE_TYPE_UNSPECIFIED /* storage engine used in transaction */
@@ -691,6 +693,38 @@ void MarkCurrentTransactionIdLoggedIfAny(void)
         CurrentTransactionState->didLogXid = true;
 }
 
+/*
+ * IsSubTransactionAssignmentPending
+ *
+ * With wal_level=logical, the first WAL record of a subtransaction that has
+ * an xid carries the toplevel xid as well, so that logical decoding knows the
+ * parent of the subtransaction before it sees any of its changes.
+ */
+bool IsSubTransactionAssignmentPending(void)
+{
+    if (!XLogLogicalInfoActive())
+        return false;
+
+    if (!IsSubTransaction())
+        return false;
+
+    if (!TransactionIdIsValid(CurrentTransactionState->transactionId))
+        return false;
+
+    return !CurrentTransactionState->assigned;
+}
+
+/*
+ * MarkSubTransactionAssigned
+ *
+ * Remember that the toplevel xid was logged with the current subtransaction.
+ */
+void MarkSubTransactionAssigned(void)
+{
+    Assert(IsSubTransactionAssignmentPending());
+    CurrentTransactionState->assigned = true;
+}
+
 /*
  * @Description: set the didLogXid of the current transaction state to true.
  * @out state: the current transaction state.
@@ -834,6 +868,11 @@ static void AssignTransactionId(TransactionState s)
      *
      * This is correct even for the case where several levels above us didn't
      * have an xid assigned as we recursed up to them beforehand.
+     *
+     * Logical decoding does not have to wait for this record to learn the
+     * parent of a subtransaction: with wal_level logical the first WAL record
+     * of each subtransaction carries the toplevel xid as well (see
+     * IsSubTransactionAssignmentPending()).
      */
     if (isSubXact && XLogStandbyInfoActive()) {
         t_thrd.xact_cxt.unreportedXids[t_thrd.xact_cxt.nUnreportedXids] = s->transactionId;
@@ -1725,7 +1764,8 @@ static TransactionId RecordTransactionCommit(void)
             MinimumActiveBackends(u_sess->attr.attr_storage.CommitSiblings))
             pg_usleep(u_sess->attr.attr_storage.CommitDelay);
 
-        XLogFlush(t_thrd.xlog_cxt.XactLastRecEnd);
+        /* flushed by the walwriter if wal_flush_wait_queue is on */
+        XLogWaitFlush(t_thrd.xlog_cxt.XactLastRecEnd);
 
         /* Now we may update the CLOG, if we wrote a COMMIT record above */
         if (markXidCommitted) {
@@ -98,6 +98,7 @@
 #include "storage/reinit.h"
 #include "storage/smgr.h"
 #include "storage/spin.h"
+#include "storage/uring.h"
 #include "utils/builtins.h"
 #include "utils/elog.h"
 #include "utils/guc.h"
@@ -431,6 +432,15 @@ typedef struct XLogCtlData {
     XLogRecPtr ddlDelayStartPtr;
 
     slock_t info_lck; /* locks shared variables shown above */
+
+    /*
+     * Backends waiting for the walwriter to flush their commit record, ordered
+     * by PGPROC->flushWaitLSN. Protected by WALFlushWaitLock.
+     */
+    SHM_QUEUE flushWaitQueue;
+
+    /* number of waits queued so far, for the walwriter to follow the commit rate */
+    pg_atomic_uint64 flushWaitArrivals;
 } XLogCtlData;
 
 static void remove_xlogtemp_files(void);
@@ -2436,6 +2446,14 @@ static void AdvanceXLInsertBuffer(XLogRecPtr upto, bool opportunistic, PGPROC* p
 
         NewPage = (XLogPageHeader)(t_thrd.shemem_ptr_cxt.XLogCtl->pages + nextidx * (Size)XLOG_BLCKSZ);
 
+        /*
+         * Invalidate the slot before we modify the page, so that
+         * XLogReadFromBuffers() doesn't take the page being re-initialized
+         * for the old one it holds.
+         */
+        *((volatile XLogRecPtr*)&t_thrd.shemem_ptr_cxt.XLogCtl->xlblocks[nextidx]) = InvalidXLogRecPtr;
+        pg_write_barrier();
+
         /*
          * Be sure to re-zero the buffer so that bytes beyond what we've
          * written will look like zeroes and not valid XLOG records...
@@ -2642,17 +2660,8 @@ static void XLogWrite(const XLogwrtRqst& WriteRqst, bool flexible)
             instr_time endTime;
             PgStat_Counter elapsedTime;
 
-            /* Need to seek in the file? */
-            if (t_thrd.xlog_cxt.openLogOff != startoffset) {
-                if (lseek(t_thrd.xlog_cxt.openLogFile, (off_t)startoffset, SEEK_SET) < 0) {
-                    ereport(PANIC,
-                        (errcode_for_file_access(),
-                            errmsg("could not seek in log file %s to offset %u: %m",
-                                XLogFileNameP(t_thrd.xlog_cxt.ThisTimeLineID, t_thrd.xlog_cxt.openLogSegNo),
-                                startoffset)));
-                }
-                t_thrd.xlog_cxt.openLogOff = startoffset;
-            }
+            /* positional write, through the io_uring of the walwriter if the WAL buffers are registered */
+            t_thrd.xlog_cxt.openLogOff = startoffset;
 
             /* OK to write the page(s) */
             char* from = t_thrd.shemem_ptr_cxt.XLogCtl->pages + startidx * (Size)XLOG_BLCKSZ;
@@ -2661,7 +2670,7 @@ static void XLogWrite(const XLogwrtRqst& WriteRqst, bool flexible)
 
             pgstat_report_waitevent(WAIT_EVENT_WAL_WRITE);
             INSTR_TIME_SET_CURRENT(startTime);
-            actualBytes = write(t_thrd.xlog_cxt.openLogFile, from, nbytes);
+            actualBytes = UringPWrite(t_thrd.xlog_cxt.openLogFile, from, nbytes, (off_t)startoffset);
             INSTR_TIME_SET_CURRENT(endTime);
             INSTR_TIME_SUBTRACT(endTime, startTime);
             /* when track_activities and enable_instr_track_wait are on,
@@ -3285,6 +3294,215 @@ void XLogFlush(XLogRecPtr record, bool LogicalPage)
     gstrace_exit(GS_TRC_ID_XLogFlush);
 }
 
+/*
+ * Commit flush wait queue.
+ *
+ * With wal_flush_wait_queue on, a committing backend leaves the flush of its
+ * commit record to the walwriter. It queues its PGPROC, ordered by the LSN it
+ * needs flushed, nudges the walwriter and sleeps on its latch. After each
+ * flush the walwriter releases exactly the waiters whose LSN has become
+ * durable, so committers neither contend on WALWriteLock nor wake up to
+ * re-check the flush position. A waiter not released within
+ * wal_writer_delay flushes by itself, in case the walwriter is stuck.
+ */
+
+/*
+ * Insert t_thrd.proc into the flush wait queue, maintaining sorted invariant.
+ *
+ * Usually we will go at tail of queue, though it's possible that we arrive
+ * here out of order, so start at tail and work back to insertion point.
+ */
+static void XLogFlushWaitQueueInsert(void)
+{
+    SHM_QUEUE* queue = &t_thrd.shemem_ptr_cxt.XLogCtl->flushWaitQueue;
+    PGPROC* proc = (PGPROC*)SHMQueuePrev(queue, queue, offsetof(PGPROC, flushWaitLinks));
+
+    while (proc != NULL) {
+        if (XLByteLE(proc->flushWaitLSN, t_thrd.proc->flushWaitLSN))
+            break;
+
+        proc = (PGPROC*)SHMQueuePrev(queue, &(proc->flushWaitLinks), offsetof(PGPROC, flushWaitLinks));
+    }
+
+    if (proc != NULL)
+        SHMQueueInsertAfter(&(proc->flushWaitLinks), &(t_thrd.proc->flushWaitLinks));
+    else
+        SHMQueueInsertAfter(queue, &(t_thrd.proc->flushWaitLinks));
+}
+
+/*
+ * Ensure that all XLOG data through the given position is flushed to disk,
+ * through the walwriter if wal_flush_wait_queue is on. Used for commit
+ * records, see RecordTransactionCommit().
+ */
+void XLogWaitFlush(XLogRecPtr record)
+{
+    XLogCtlData* xlogctl = t_thrd.shemem_ptr_cxt.XLogCtl;
+    Latch* walwriterLatch = g_instance.proc_base->walwriterLatch;
+
+    if (!u_sess->attr.attr_storage.wal_flush_wait_queue || walwriterLatch == NULL || t_thrd.proc == NULL ||
+        pmState != PM_RUN || !XLogInsertAllowed()) {
+        XLogFlush(record);
+        return;
+    }
+
+    /* Quick exit if already known flushed */
+    if (XLByteLE(record, t_thrd.xlog_cxt.LogwrtResult->Flush)) {
+        return;
+    }
+
+    LWLockAcquire(WALFlushWaitLock, LW_EXCLUSIVE);
+
+    /* the walwriter releases waiters under the lock, so this check is final */
+    SpinLockAcquire(&xlogctl->info_lck);
+    *t_thrd.xlog_cxt.LogwrtResult = xlogctl->LogwrtResult;
+    SpinLockRelease(&xlogctl->info_lck);
+    if (XLByteLE(record, t_thrd.xlog_cxt.LogwrtResult->Flush)) {
+        LWLockRelease(WALFlushWaitLock);
+        return;
+    }
+
+    t_thrd.proc->flushWaitLSN = record;
+    t_thrd.proc->flushWaitDone = false;
+    XLogFlushWaitQueueInsert();
+    LWLockRelease(WALFlushWaitLock);
+
+    (void)pg_atomic_fetch_add_u64(&xlogctl->flushWaitArrivals, 1);
+    SetLatch(walwriterLatch);
+
+    for (;;) {
+        int rc;
+
+        ResetLatch(&t_thrd.proc->procLatch);
+
+        /* the walwriter sets flushWaitDone only after removing us from the queue */
+        if (t_thrd.proc->flushWaitDone) {
+            pg_read_barrier();
+            break;
+        }
+
+        rc = WaitLatch(&t_thrd.proc->procLatch,
+            WL_LATCH_SET | WL_TIMEOUT | WL_POSTMASTER_DEATH,
+            u_sess->attr.attr_storage.WalWriterDelay);
+        if (rc & (WL_TIMEOUT | WL_POSTMASTER_DEATH)) {
+            break;
+        }
+    }
+
+    if (!t_thrd.proc->flushWaitDone) {
+        /* Not released in time. Leave the queue, if still there, and flush ourselves */
+        LWLockAcquire(WALFlushWaitLock, LW_EXCLUSIVE);
+        if (!SHMQueueIsDetached(&(t_thrd.proc->flushWaitLinks))) {
+            SHMQueueDelete(&(t_thrd.proc->flushWaitLinks));
+        }
+        LWLockRelease(WALFlushWaitLock);
+
+        XLogFlush(record);
+    }
+
+    t_thrd.proc->flushWaitLSN = InvalidXLogRecPtr;
+    t_thrd.proc->flushWaitDone = false;
+}
+
+/*
+ * Are there backends waiting in the flush wait queue? The answer is only a
+ * hint, as it is given without the lock.
+ */
+bool XLogFlushWaitPending(void)
+{
+    return !SHMQueueEmpty(&t_thrd.shemem_ptr_cxt.XLogCtl->flushWaitQueue);
+}
+
+/*
+ * Number of waits queued in the flush wait queue since startup.
+ */
+uint64 XLogFlushWaitArrivals(void)
+{
+    return pg_atomic_read_u64(&t_thrd.shemem_ptr_cxt.XLogCtl->flushWaitArrivals);
+}
+
+/*
+ * Highest LSN a backend of the flush wait queue needs flushed, or
+ * InvalidXLogRecPtr if none is waiting.
+ */
+static XLogRecPtr XLogFlushWaitTarget(void)
+{
+    SHM_QUEUE* queue = &t_thrd.shemem_ptr_cxt.XLogCtl->flushWaitQueue;
+    XLogRecPtr target = InvalidXLogRecPtr;
+    PGPROC* proc = NULL;
+
+    if (!XLogFlushWaitPending()) {
+        return InvalidXLogRecPtr;
+    }
+
+    LWLockAcquire(WALFlushWaitLock, LW_SHARED);
+    proc = (PGPROC*)SHMQueuePrev(queue, queue, offsetof(PGPROC, flushWaitLinks));
+    if (proc != NULL) {
+        target = proc->flushWaitLSN;
+    }
+    LWLockRelease(WALFlushWaitLock);
+
+    return target;
+}
+
+/*
+ * Release the backends of the flush wait queue whose LSN has been flushed.
+ * Called by the walwriter after each flush. Returns the number released.
+ */
+int XLogReleaseFlushWaiters(void)
+{
+    XLogCtlData* xlogctl = t_thrd.shemem_ptr_cxt.XLogCtl;
+    SHM_QUEUE* queue = &xlogctl->flushWaitQueue;
+    XLogRecPtr flushed;
+    PGPROC* proc = NULL;
+    int numprocs = 0;
+
+    if (!XLogFlushWaitPending()) {
+        return 0;
+    }
+
+    SpinLockAcquire(&xlogctl->info_lck);
+    flushed = xlogctl->LogwrtResult.Flush;
+    SpinLockRelease(&xlogctl->info_lck);
+
+    LWLockAcquire(WALFlushWaitLock, LW_EXCLUSIVE);
+    proc = (PGPROC*)SHMQueueNext(queue, queue, offsetof(PGPROC, flushWaitLinks));
+    while (proc != NULL && XLByteLE(proc->flushWaitLSN, flushed)) {
+        PGPROC* thisproc = proc;
+
+        /* move to next proc, so we can delete thisproc from the queue */
+        proc = (PGPROC*)SHMQueueNext(queue, &(thisproc->flushWaitLinks), offsetof(PGPROC, flushWaitLinks));
+        SHMQueueDelete(&(thisproc->flushWaitLinks));
+
+        /* XLogWaitFlush() reads flushWaitDone without the lock */
+        pg_write_barrier();
+        thisproc->flushWaitDone = true;
+        SetLatch(&(thisproc->procLatch));
+        numprocs++;
+    }
+    LWLockRelease(WALFlushWaitLock);
+
+    return numprocs;
+}
+
+/*
+ * Register the WAL buffers with the io_uring of the walwriter, which makes
+ * the writes of XLogWrite done by the walwriter use them as fixed buffers.
+ * Tried once per thread, a failure is only logged.
+ */
+void XLogRegisterBuffersForIO(void)
+{
+    static THR_LOCAL bool tried = false;
+    char* pages = t_thrd.shemem_ptr_cxt.XLogCtl->pages;
+    Size len = (Size)(t_thrd.shemem_ptr_cxt.XLogCtl->XLogCacheBlck + 1) * XLOG_BLCKSZ;
+
+    if (tried) {
+        return;
+    }
+    tried = true;
+    (void)UringRegisterBuffers(&pages, &len, 1);
+}
+
 /*
  * Invoke XLogFileInit to create XLog files according to advance_xlog_file_num GUC.
  *
@@ -3398,6 +3616,16 @@ bool XLogBackgroundFlush(void)
     /* back off to last completed page boundary */
     WriteRqstPtr -= WriteRqstPtr % XLOG_BLCKSZ;
 
+    /* but the commit records in the flush wait queue are flushed entirely */
+    {
+        XLogRecPtr waitTarget = XLogFlushWaitTarget();
+
+        if (XLByteLT(WriteRqstPtr, waitTarget)) {
+            WriteRqstPtr = waitTarget;
+            flexible = false;
+        }
+    }
+
     /* if we have already flushed that far, consider async commit records */
     if (XLByteLE(WriteRqstPtr, t_thrd.xlog_cxt.LogwrtResult->Flush)) {
         /* use volatile pointer to prevent code rearrangement */
@@ -6627,6 +6855,8 @@ void XLOGShmemInit(void)
     SpinLockInit(&t_thrd.shemem_ptr_cxt.XLogCtl->Insert.insertpos_lck);
 #endif
     SpinLockInit(&t_thrd.shemem_ptr_cxt.XLogCtl->info_lck);
+    SHMQueueInit(&t_thrd.shemem_ptr_cxt.XLogCtl->flushWaitQueue);
+    pg_atomic_init_u64(&t_thrd.shemem_ptr_cxt.XLogCtl->flushWaitArrivals, 0);
     InitSharedLatch(&t_thrd.shemem_ptr_cxt.XLogCtl->recoveryWakeupLatch);
     InitSharedLatch(&t_thrd.shemem_ptr_cxt.XLogCtl->dataRecoveryLatch);
 
@@ -13711,6 +13941,56 @@ XLogRecPtr GetXLogInsertEndRecPtr(void)
     return XLogBytePosToEndRecPtr(current_bytepos);
 }
 
+/*
+ * Copy the WAL of [startptr, startptr + count) from the WAL buffers, as far
+ * as the pages are still resident. The range must have been written out
+ * already. Returns the number of bytes copied, always a prefix of the range;
+ * the caller reads the rest from the segment files.
+ */
+Size XLogReadFromBuffers(char* buf, XLogRecPtr startptr, Size count)
+{
+    XLogCtlData* xlogctl = t_thrd.shemem_ptr_cxt.XLogCtl;
+    XLogRecPtr recptr = startptr;
+    Size nbytes = count;
+    char* p = buf;
+    errno_t errorno = EOK;
+
+    /* the buffers hold no valid WAL until recovery has finished */
+    if (RecoveryInProgress()) {
+        return 0;
+    }
+
+    while (nbytes > 0) {
+        uint32 idx = XLogRecPtrToBufIdx(recptr);
+        Size offset = recptr % XLOG_BLCKSZ;
+        Size pagebytes = Min(nbytes, (Size)XLOG_BLCKSZ - offset);
+        XLogRecPtr expectedEndPtr = recptr - offset + XLOG_BLCKSZ;
+
+        /*
+         * The page can be replaced at any time, without any lock held by us.
+         * So check that the buffer holds our page both before and after the
+         * copy; AdvanceXLInsertBuffer() invalidates xlblocks before touching
+         * the page.
+         */
+        if (*((volatile XLogRecPtr*)&xlogctl->xlblocks[idx]) != expectedEndPtr) {
+            break;
+        }
+        pg_read_barrier();
+        errorno = memcpy_s(p, pagebytes, xlogctl->pages + idx * (Size)XLOG_BLCKSZ + offset, pagebytes);
+        securec_check(errorno, "\0", "\0");
+        pg_read_barrier();
+        if (*((volatile XLogRecPtr*)&xlogctl->xlblocks[idx]) != expectedEndPtr) {
+            break;
+        }
+
+        p += pagebytes;
+        recptr += pagebytes;
+        nbytes -= pagebytes;
+    }
+
+    return count - nbytes;
+}
+
 /*
  * Get latest WAL write pointer
  */
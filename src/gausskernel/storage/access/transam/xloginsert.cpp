@@ -56,8 +56,9 @@ typedef struct registered_buffer {
     char compressed_page[BLCKSZ]; /* buffer to store a compressed version of backup block image */
 } registered_buffer;
 
-#define HEADER_SCRATCH_SIZE \
-    (SizeOfXLogRecord + MaxSizeOfXLogRecordBlockHeader * (XLR_MAX_BLOCK_ID + 1) + SizeOfXLogRecordDataHeaderLong)
+#define HEADER_SCRATCH_SIZE                                                                                 \
+    (SizeOfXLogRecord + MaxSizeOfXLogRecordBlockHeader * (XLR_MAX_BLOCK_ID + 1) + SizeOfXLogRecordDataHeaderLong + \
+        sizeof(uint8) + sizeof(RepOriginId) + sizeof(uint8) + sizeof(TransactionId))
 
 static XLogRecData* XLogRecordAssemble(
     RmgrId rmid, uint8 info, XLogFPWInfo fpw_info, XLogRecPtr* fpw_lsn, bool isupgrade = false, int bucket_id = -1);
@@ -470,6 +471,11 @@ XLogRecPtr XLogInsert(RmgrId rmid, uint8 info, bool isupgrade, int bucket_id)
         EndPos = XLogInsertRecord(rdt, fpw_lsn, isupgrade);
     } while (XLByteEQ(EndPos, InvalidXLogRecPtr));
 
+    /* the toplevel xid went out with this record, don't repeat it */
+    if (!isupgrade && IsSubTransactionAssignmentPending()) {
+        MarkSubTransactionAssigned();
+    }
+
     /*
      * too much log may slow down the speed of xlog, so only write log
      * when log level belows DEBUG4
@@ -762,6 +768,20 @@ static XLogRecData* XLogRecordAssemble(
         scratch += sizeof(u_sess->attr.attr_storage.replorigin_sesssion_origin);
     }
 
+    /*
+     * followed by the toplevel xid, if this is the first record of a
+     * subtransaction since it got its xid and logical decoding needs to know
+     * its parent (see IsSubTransactionAssignmentPending())
+     */
+    if (!isupgrade && IsSubTransactionAssignmentPending()) {
+        TransactionId xid = GetTopTransactionIdIfAny();
+
+        *(scratch++) = XLR_BLOCK_ID_TOPLEVEL_XID;
+        rc = memcpy_s(scratch, sizeof(TransactionId), &xid, sizeof(TransactionId));
+        securec_check(rc, "", "");
+        scratch += sizeof(TransactionId);
+    }
+
     /* followed by main data, if any */
     if (t_thrd.xlog_cxt.mainrdata_len > 0) {
         if (t_thrd.xlog_cxt.mainrdata_len > 255) {
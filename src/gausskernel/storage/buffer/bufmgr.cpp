@@ -61,6 +61,7 @@
 #include "storage/proc.h"
 #include "storage/smgr.h"
 #include "storage/standby.h"
+#include "storage/uring.h"
 #include "utils/aiomem.h"
 #include "utils/guc.h"
 #include "utils/plog.h"
@@ -309,6 +310,95 @@ static inline int32 GetPrivateRefCount(Buffer buffer)
     return ref->refcount;
 }
 
+/*
+ * Allocate progress status for each tablespace of the num_to_scan buffers of
+ * CkptBufferIds starting at start, and build a min-heap over their write
+ * progress. This requires the to-be-flushed array to be sorted. The status
+ * array is returned in *per_ts_stat; both are freed by the caller.
+ */
+static binaryheap* ckpt_build_ts_progress_heap(int start, int num_to_scan, CkptTsStatus** per_ts_stat)
+{
+    CkptTsStatus* ts_status = NULL;
+    binaryheap* ts_heap = NULL;
+    int num_spaces = 0;
+    Oid last_tsid = InvalidOid;
+    int i;
+
+    for (i = start; i < start + num_to_scan; i++) {
+        CkptTsStatus* s = NULL;
+        Oid cur_tsid;
+
+        cur_tsid = g_instance.ckpt_cxt_ctl->CkptBufferIds[i].tsId;
+
+        /*
+         * Grow array of per-tablespace status structs, every time a new
+         * tablespace is found.
+         */
+        if (last_tsid == InvalidOid || last_tsid != cur_tsid) {
+            Size sz;
+            errno_t rc = EOK;
+
+            num_spaces++;
+
+            /*
+             * Not worth adding grow-by-power-of-2 logic here - even with a
+             * few hundred tablespaces this should be fine.
+             */
+            sz = sizeof(CkptTsStatus) * num_spaces;
+
+            if (ts_status == NULL) {
+                ts_status = (CkptTsStatus*)palloc(sz);
+            } else {
+                ts_status = (CkptTsStatus*)repalloc(ts_status, sz);
+            }
+
+            s = &ts_status[num_spaces - 1];
+            rc = memset_s(s, sizeof(*s), 0, sizeof(*s));
+            securec_check(rc, "\0", "\0");
+            s->tsId = cur_tsid;
+
+            /*
+             * The first buffer in this tablespace. As CkptBufferIds is sorted
+             * by tablespace all (s->num_to_scan) buffers in this tablespace
+             * will follow afterwards.
+             */
+            s->index = i;
+
+            /*
+             * progress_slice will be determined once we know how many buffers
+             * are in each tablespace, i.e. after this loop.
+             */
+            last_tsid = cur_tsid;
+        } else {
+            s = &ts_status[num_spaces - 1];
+        }
+
+        s->num_to_scan++;
+    }
+
+    Assert(num_spaces > 0);
+
+    /*
+     * Build a min-heap over the write-progress in the individual tablespaces,
+     * and compute how large a portion of the total progress a single
+     * processed buffer is.
+     */
+    ts_heap = binaryheap_allocate(num_spaces, ts_ckpt_progress_comparator, NULL);
+
+    for (i = 0; i < num_spaces; i++) {
+        CkptTsStatus* ts_stat = &ts_status[i];
+
+        ts_stat->progress_slice = (float8)num_to_scan / ts_stat->num_to_scan;
+
+        binaryheap_add_unordered(ts_heap, PointerGetDatum(ts_stat));
+    }
+
+    binaryheap_build(ts_heap);
+
+    *per_ts_stat = ts_status;
+    return ts_heap;
+}
+
 /*
  * Release resources used to track the reference count of a buffer which we no
  * longer have pinned and don't want to pin again immediately.
@@ -379,13 +469,41 @@ void PrefetchBuffer(Relation reln, ForkNumber forkNum, BlockNumber blockNum)
         }
     }
 
+    (void)PrefetchSharedBuffer(reln->rd_smgr, forkNum, blockNum);
+
+        /*
+         * If the block *is* in buffers, we do nothing.  This is not really
+         * ideal: the block might be just about to be evicted, which would be
+         * stupid since we know we are going to need it soon.  But the only
+         * easy answer is to bump the usage_count, which does not seem like a
+         * great solution: when the caller does ultimately touch the block,
+         * usage_count would get bumped again, resulting in too much
+         * favoritism for blocks that are involved in a prefetch sequence. A
+         * real fix would involve some additional per-buffer state, and it's
+         * not clear that there's enough of a problem to justify that.
+         */
+#endif /* USE_PREFETCH && USE_POSIX_FADVISE */
+}
+
+/*
+ * PrefetchSharedBuffer -- initiate asynchronous read of a block of a relation
+ * through shared buffers, without a Relation. It is used by the redo dispatcher
+ * to read ahead of the redo workers.
+ *
+ * Returns true if a prefetch is issued, false if the block is in shared buffers already.
+ */
+bool PrefetchSharedBuffer(SMgrRelation smgr_reln, ForkNumber fork_num, BlockNumber block_num)
+{
+#if defined(USE_PREFETCH) && defined(USE_POSIX_FADVISE)
     BufferTag new_tag;         /* identity of requested block */
     uint32 new_hash;           /* hash value for newTag */
     LWLock* new_partition_lock; /* buffer partition lock for it */
     int buf_id;
 
+    Assert(BlockNumberIsValid(block_num));
+
     /* create a tag so we can lookup the buffer */
-    INIT_BUFFERTAG(new_tag, reln->rd_smgr->smgr_rnode.node, forkNum, blockNum);
+    INIT_BUFFERTAG(new_tag, smgr_reln->smgr_rnode.node, fork_num, block_num);
 
     /* determine its hash code and partition lock ID */
     new_hash = BufTableHashCode(&new_tag);
@@ -398,21 +516,11 @@ void PrefetchBuffer(Relation reln, ForkNumber forkNum, BlockNumber blockNum)
 
     /* If not in buffers, initiate prefetch */
     if (buf_id < 0) {
-        smgrprefetch(reln->rd_smgr, forkNum, blockNum);
+        smgrprefetch(smgr_reln, fork_num, block_num);
+        return true;
     }
-
-        /*
-         * If the block *is* in buffers, we do nothing.  This is not really
-         * ideal: the block might be just about to be evicted, which would be
-         * stupid since we know we are going to need it soon.  But the only
-         * easy answer is to bump the usage_count, which does not seem like a
-         * great solution: when the caller does ultimately touch the block,
-         * usage_count would get bumped again, resulting in too much
-         * favoritism for blocks that are involved in a prefetch sequence. A
-         * real fix would involve some additional per-buffer state, and it's
-         * not clear that there's enough of a problem to justify that.
-         */
 #endif /* USE_PREFETCH && USE_POSIX_FADVISE */
+    return false;
 }
 
 /*
@@ -3032,13 +3140,10 @@ static void BufferSync(int flags)
     uint32 buf_state;
     int buf_id;
     int num_to_scan;
-    int num_spaces;
     int num_processed;
     int num_written;
     CkptTsStatus* per_ts_stat = NULL;
-    Oid last_tsid;
     binaryheap* ts_heap = NULL;
-    int i;
     uint32 mask = BM_DIRTY;
     WritebackContext wb_context;
 
@@ -3112,83 +3217,7 @@ static void BufferSync(int flags)
      * underlying system.
      */
     qsort(g_instance.ckpt_cxt_ctl->CkptBufferIds, num_to_scan, sizeof(CkptSortItem), ckpt_buforder_comparator);
-    num_spaces = 0;
-
-    /*
-     * Allocate progress status for each tablespace with buffers that need to
-     * be flushed. This requires the to-be-flushed array to be sorted.
-     */
-    last_tsid = InvalidOid;
-    for (i = 0; i < num_to_scan; i++) {
-        CkptTsStatus* s = NULL;
-        Oid cur_tsid;
-
-        cur_tsid = g_instance.ckpt_cxt_ctl->CkptBufferIds[i].tsId;
-
-        /*
-         * Grow array of per-tablespace status structs, every time a new
-         * tablespace is found.
-         */
-        if (last_tsid == InvalidOid || last_tsid != cur_tsid) {
-            Size sz;
-            errno_t rc = EOK;
-
-            num_spaces++;
-
-            /*
-             * Not worth adding grow-by-power-of-2 logic here - even with a
-             * few hundred tablespaces this should be fine.
-             */
-            sz = sizeof(CkptTsStatus) * num_spaces;
-
-            if (per_ts_stat == NULL) {
-                per_ts_stat = (CkptTsStatus*)palloc(sz);
-            } else {
-                per_ts_stat = (CkptTsStatus*)repalloc(per_ts_stat, sz);
-            }
-
-            s = &per_ts_stat[num_spaces - 1];
-            rc = memset_s(s, sizeof(*s), 0, sizeof(*s));
-            securec_check(rc, "\0", "\0");
-            s->tsId = cur_tsid;
-
-            /*
-             * The first buffer in this tablespace. As CkptBufferIds is sorted
-             * by tablespace all (s->num_to_scan) buffers in this tablespace
-             * will follow afterwards.
-             */
-            s->index = i;
-
-            /*
-             * progress_slice will be determined once we know how many buffers
-             * are in each tablespace, i.e. after this loop.
-             */
-            last_tsid = cur_tsid;
-        } else {
-            s = &per_ts_stat[num_spaces - 1];
-        }
-
-        s->num_to_scan++;
-    }
-
-    Assert(num_spaces > 0);
-
-    /*
-     * Build a min-heap over the write-progress in the individual tablespaces,
-     * and compute how large a portion of the total progress a single
-     * processed buffer is.
-     */
-    ts_heap = binaryheap_allocate(num_spaces, ts_ckpt_progress_comparator, NULL);
-
-    for (i = 0; i < num_spaces; i++) {
-        CkptTsStatus* ts_stat = &per_ts_stat[i];
-
-        ts_stat->progress_slice = (float8)num_to_scan / ts_stat->num_to_scan;
-
-        binaryheap_add_unordered(ts_heap, PointerGetDatum(ts_stat));
-    }
-
-    binaryheap_build(ts_heap);
+    ts_heap = ckpt_build_ts_progress_heap(0, num_to_scan, &per_ts_stat);
 
     /*
      * Iterate through to-be-checkpointed buffers and write the ones (still)
@@ -3609,6 +3638,50 @@ bool BgBufferSync(WritebackContext* wb_context)
     return (bufs_to_lap == 0 && recent_alloc == 0);
 }
 
+const int CONDITION_LOCK_RETRY_TIMES = 5;
+
+/*
+ * Share-lock the content of a pinned buffer which is going to be written.
+ * Returns false if the lock was not granted.
+ */
+static bool SyncOneBufferLockContent(BufferDesc* buf_desc, bool get_condition_lock)
+{
+    if (dw_enabled() && get_condition_lock) {
+        /*
+         * We must use a conditional lock acquisition here to avoid deadlock. If
+         * page_writer and double_write are enabled, only page_writer is allowed to
+         * flush the buffers. So the backends (BufferAlloc, FlushRelationBuffers,
+         * FlushDatabaseBuffers) are not allowed to flush the buffers, instead they
+         * will just wait for page_writer to flush the required buffer. In some cases
+         * (for example, btree split, heap_multi_insert), BufferAlloc will be called
+         * with holding exclusive lock on another buffer. So if we try to acquire
+         * the shared lock directly here (page_writer), it will block unconditionally
+         * and the backends will be blocked on the page_writer to flush the buffer,
+         * resulting in deadlock.
+         */
+        int retry_times = 0;
+        int i = 0;
+        Buffer queue_head_buffer = get_dirty_page_queue_head_buffer();
+        if (!BufferIsInvalid(queue_head_buffer) && (queue_head_buffer - 1 == buf_desc->buf_id)) {
+            retry_times = CONDITION_LOCK_RETRY_TIMES;
+        }
+        for (;;) {
+            if (!LWLockConditionalAcquire(buf_desc->content_lock, LW_SHARED)) {
+                i++;
+                if (i >= retry_times) {
+                    return false;
+                }
+                (void)sched_yield();
+                continue;
+            }
+            break;
+        }
+    } else {
+        (void)LWLockAcquire(buf_desc->content_lock, LW_SHARED);
+    }
+    return true;
+}
+
 /*
  * SyncOneBuffer -- process a single buffer during syncing.
  *
@@ -3625,7 +3698,6 @@ bool BgBufferSync(WritebackContext* wb_context)
  *
  * Note: caller must have done ResourceOwnerEnlargeBuffers.
  */
-const int CONDITION_LOCK_RETRY_TIMES = 5;
 uint32 SyncOneBuffer(int buf_id, bool skip_recently_used, WritebackContext* wb_context, bool get_condition_lock)
 {
     BufferDesc* buf_desc = GetBufferDescriptor(buf_id);
@@ -3663,39 +3735,9 @@ uint32 SyncOneBuffer(int buf_id, bool skip_recently_used, WritebackContext* wb_c
      */
     PinBuffer_Locked(buf_desc);
 
-    if (dw_enabled() && get_condition_lock) {
-        /*
-         * We must use a conditional lock acquisition here to avoid deadlock. If
-         * page_writer and double_write are enabled, only page_writer is allowed to
-         * flush the buffers. So the backends (BufferAlloc, FlushRelationBuffers,
-         * FlushDatabaseBuffers) are not allowed to flush the buffers, instead they
-         * will just wait for page_writer to flush the required buffer. In some cases
-         * (for example, btree split, heap_multi_insert), BufferAlloc will be called
-         * with holding exclusive lock on another buffer. So if we try to acquire
-         * the shared lock directly here (page_writer), it will block unconditionally
-         * and the backends will be blocked on the page_writer to flush the buffer,
-         * resulting in deadlock.
-         */
-        int retry_times = 0;
-        int i = 0;
-        Buffer queue_head_buffer = get_dirty_page_queue_head_buffer();
-        if (!BufferIsInvalid(queue_head_buffer) && (queue_head_buffer - 1 == buf_id)) {
-            retry_times = CONDITION_LOCK_RETRY_TIMES;
-        }
-        for (;;) {
-            if (!LWLockConditionalAcquire(buf_desc->content_lock, LW_SHARED)) {
-                i++;
-                if (i >= retry_times) {
-                    UnpinBuffer(buf_desc, true);
-                    return (result | BUF_SKIPPED);
-                }
-                (void)sched_yield();
-                continue;
-            }
-            break;
-        }
-    } else {
-        (void)LWLockAcquire(buf_desc->content_lock, LW_SHARED);
+    if (!SyncOneBufferLockContent(buf_desc, get_condition_lock)) {
+        UnpinBuffer(buf_desc, true);
+        return (result | BUF_SKIPPED);
     }
 
     FlushBuffer(buf_desc, NULL);
@@ -5940,40 +5982,265 @@ void clean_buf_need_flush_flag(BufferDesc *buf_desc)
     return;
 }
 
+/* number of dirty pages the pagewriter writes with one smgrwritebatch */
+#define PGWR_BATCH_SIZE URING_QUEUE_DEPTH
+/* longest run of adjacent blocks the pagewriter takes from one tablespace at a time */
+#define PGWR_MAX_COALESCE 16
+
+/*
+ * Dirty pages collected by a pagewriter thread. The buffers of the batch are
+ * pinned and marked I/O busy, their pages are copied into pages, in the order
+ * they are added, so that the pages of adjacent blocks added one after the
+ * other are contiguous and get written with a single write. With
+ * enable_io_uring on, pages is registered with the io_uring of the thread.
+ */
+typedef struct PgwrWriteBatch {
+    int nblocks;
+    bool registered;
+    BufferDesc* bufs[PGWR_BATCH_SIZE];
+    XLogRecPtr lsns[PGWR_BATCH_SIZE];
+    bool logical[PGWR_BATCH_SIZE];
+    SMgrWriteBlock blocks[PGWR_BATCH_SIZE];
+    char* pages;
+} PgwrWriteBatch;
+
+static THR_LOCAL PgwrWriteBatch* t_pgwr_batch = NULL;
+
+static PgwrWriteBatch* pgwr_get_write_batch()
+{
+    PgwrWriteBatch* batch = t_pgwr_batch;
+
+    if (batch == NULL) {
+        char* unaligned = (char*)MemoryContextAllocZero(t_thrd.top_mem_cxt, (Size)(PGWR_BATCH_SIZE + 1) * BLCKSZ);
+
+        batch = (PgwrWriteBatch*)MemoryContextAllocZero(t_thrd.top_mem_cxt, sizeof(PgwrWriteBatch));
+        batch->pages = (char*)TYPEALIGN(BLCKSZ, unaligned);
+        t_pgwr_batch = batch;
+    }
+    if (!batch->registered && UringEnabled()) {
+        Size len = (Size)PGWR_BATCH_SIZE * BLCKSZ;
+
+        (void)UringRegisterBuffers(&batch->pages, &len, 1);
+        batch->registered = true;
+    }
+    return batch;
+}
+
+/*
+ * Write the pages of the batch with one smgrwritebatch, then end the I/O of
+ * their buffers like FlushBuffer and SyncOneBuffer do.
+ */
+static void pgwr_write_batch(PgwrWriteBatch* batch, WritebackContext* wb_context)
+{
+    XLogRecPtr max_lsn = InvalidXLogRecPtr;
+    instr_time io_start, io_time;
+
+    if (batch->nblocks == 0) {
+        return;
+    }
+
+    /* WAL before data; a single flush covers all the pages but the logical ones, which only warn */
+    for (int i = 0; i < batch->nblocks; i++) {
+        if (!batch->logical[i] && XLByteLT(max_lsn, batch->lsns[i])) {
+            max_lsn = batch->lsns[i];
+        }
+    }
+    XLogFlush(max_lsn);
+    for (int i = 0; i < batch->nblocks; i++) {
+        if (batch->logical[i]) {
+            XLogFlush(batch->lsns[i], true);
+        }
+    }
+
+    INSTR_TIME_SET_CURRENT(io_start);
+    smgrwritebatch(batch->blocks, batch->nblocks, false);
+    INSTR_TIME_SET_CURRENT(io_time);
+    INSTR_TIME_SUBTRACT(io_time, io_start);
+    if (u_sess->attr.attr_common.track_io_timing) {
+        pgstat_count_buffer_write_time(INSTR_TIME_GET_MICROSEC(io_time));
+        INSTR_TIME_ADD(u_sess->instr_cxt.pg_buffer_usage->blk_write_time, io_time);
+    }
+    pgstatCountBlocksWriteTime4SessionLevel(INSTR_TIME_GET_MICROSEC(io_time));
+    u_sess->instr_cxt.pg_buffer_usage->shared_blks_written += batch->nblocks;
+
+    while (batch->nblocks > 0) {
+        BufferDesc* buf_desc = batch->bufs[--batch->nblocks];
+        BufferTag tag = buf_desc->tag;
+
+        AsyncTerminateBufferIO(buf_desc, true, 0);
+        UnpinBuffer(buf_desc, true);
+        ScheduleBufferTagForWriteback(wb_context, &tag);
+    }
+}
+
+/* release the buffers of the batch after an error */
+static void pgwr_abort_batch(PgwrWriteBatch* batch)
+{
+    while (batch->nblocks > 0) {
+        BufferDesc* buf_desc = batch->bufs[--batch->nblocks];
+
+        if (LWLockHeldByMe(buf_desc->content_lock)) {
+            LWLockRelease(buf_desc->content_lock);
+        }
+        AsyncAbortBufferIO(buf_desc, false);
+        UnpinBuffer(buf_desc, true);
+    }
+}
+
+/*
+ * The batch counterpart of SyncOneBuffer. Like FlushBuffer the buffer is
+ * marked I/O busy, but its page is always copied into the batch, so that
+ * the content lock can be released at once. The pin and the io_in_progress
+ * lock are kept until the batch is written.
+ * Returns false if the buffer was not dirty or could not be locked.
+ */
+static bool pgwr_batch_add_buffer(PgwrWriteBatch* batch, int buf_id, WritebackContext* wb_context)
+{
+    BufferDesc* buf_desc = GetBufferDescriptor(buf_id);
+    RedoBufferInfo bufferinfo = {0};
+    uint32 buf_state;
+
+    ResourceOwnerEnlargeBuffers(t_thrd.utils_cxt.CurrentResourceOwner);
+    buf_state = LockBufHdr(buf_desc);
+    if (!(buf_state & BM_VALID) || !(buf_state & BM_DIRTY)) {
+        UnlockBufHdr(buf_desc, buf_state);
+        return false;
+    }
+    PinBuffer_Locked(buf_desc);
+
+    /* don't wait for a content lock while holding up the buffers of the batch */
+    if (!LWLockConditionalAcquire(buf_desc->content_lock, LW_SHARED)) {
+        pgwr_write_batch(batch, wb_context);
+        if (!SyncOneBufferLockContent(buf_desc, true)) {
+            UnpinBuffer(buf_desc, true);
+            return false;
+        }
+    }
+
+    if (!StartBufferIO(buf_desc, false)) {
+        /* someone else flushed it */
+        LWLockRelease(buf_desc->content_lock);
+        UnpinBuffer(buf_desc, true);
+        return true;
+    }
+    /* the batch owns the I/O from here on, see pgwr_abort_batch */
+    t_thrd.storage_cxt.InProgressBuf = NULL;
+    int slot = batch->nblocks++;
+    batch->bufs[slot] = buf_desc;
+
+    GetFlushBufferInfo(buf_desc, &bufferinfo, &buf_state, WITH_NORMAL_CACHE);
+    batch->lsns[slot] = bufferinfo.lsn;
+    batch->logical[slot] = PageIsLogical((Block)bufferinfo.pageinfo.page);
+
+    char* page = batch->pages + (Size)slot * BLCKSZ;
+    char* bufToWrite = PageDataEncryptIfNeed((Page)bufferinfo.pageinfo.page);
+    errno_t rc = memcpy_s(page, BLCKSZ, bufToWrite, BLCKSZ);
+    securec_check(rc, "\0", "\0");
+    LWLockRelease(buf_desc->content_lock);
+
+    PageSetChecksumInplace((Page)page, bufferinfo.blockinfo.blkno);
+
+    SMgrWriteBlock* block = &batch->blocks[slot];
+    block->reln = smgropen(bufferinfo.blockinfo.rnode, InvalidBackendId, GetColumnNum(bufferinfo.blockinfo.forknum));
+    block->forknum = bufferinfo.blockinfo.forknum;
+    block->blocknum = bufferinfo.blockinfo.blkno;
+    block->buffer = page;
+    return true;
+}
+
+/* whether the buffer of item b is the block following the one of item a */
+static inline bool ckpt_items_adjacent(const CkptSortItem* a, const CkptSortItem* b)
+{
+    return a->tsId == b->tsId && a->relNode == b->relNode && a->bucketNode == b->bucketNode &&
+           a->forkNum == b->forkNum && a->blockNum + 1 == b->blockNum;
+}
+
 /**
- * @Description: pagewriter thread flush dirty pages to data file.
+ * @Description: pagewriter thread flush dirty pages to data file. The sorted
+ *               pages are staged in a batch, so that runs of adjacent blocks
+ *               are written with one write, and the batch is written with one
+ *               io_uring submission when enable_io_uring is on. The writes
+ *               are balanced between tablespaces, one run at a time, like
+ *               BufferSync does.
  * @in          number of pagewriter need flush dirty page.
  * @return      number of dirty pages actually flushed
  */
-void ckpt_flush_dirty_page(int thread_id, WritebackContext wb_context)
+void ckpt_flush_dirty_page(int thread_id, WritebackContext* wb_context)
 {
-    uint32 i;
     uint32 actual_written = 0;
-    int buf_id;
-    BufferDesc* buf_desc = NULL;
-    uint32 buf_state;
+    int start = (int)g_instance.ckpt_cxt_ctl->page_writer_procs.writer_proc[thread_id].start_loc;
+    int num_to_scan = (int)g_instance.ckpt_cxt_ctl->page_writer_procs.writer_proc[thread_id].end_loc - start + 1;
+    PgwrWriteBatch* batch = pgwr_get_write_batch();
+    CkptTsStatus* per_ts_stat = NULL;
+    binaryheap* ts_heap = NULL;
 
-    for (i = g_instance.ckpt_cxt_ctl->page_writer_procs.writer_proc[thread_id].start_loc;
-         i <= g_instance.ckpt_cxt_ctl->page_writer_procs.writer_proc[thread_id].end_loc; i++) {
-        buf_id = g_instance.ckpt_cxt_ctl->CkptBufferIds[i].buf_id;
-        if (buf_id == DW_INVALID_BUFFER_ID) {
-            continue;
-        }
+    if (num_to_scan > 0) {
+        ts_heap = ckpt_build_ts_progress_heap(start, num_to_scan, &per_ts_stat);
+    }
 
-        buf_desc = GetBufferDescriptor(buf_id);
-        buf_state = LockBufHdr(buf_desc);
-        if ((buf_state & BM_CHECKPOINT_NEEDED) && (buf_state & BM_DIRTY)) {
-            UnlockBufHdr(buf_desc, buf_state);
-            uint32 ret = SyncOneBuffer(buf_id, false, &wb_context, true);
-            if (ret & BUF_WRITTEN) {
-                actual_written++;
+    PG_TRY();
+    {
+        while (ts_heap != NULL && !binaryheap_empty(ts_heap)) {
+            CkptTsStatus* ts_stat = (CkptTsStatus*)DatumGetPointer(binaryheap_first(ts_heap));
+            int run = 0;
+
+            /* take a run of adjacent blocks, their pages end up contiguous in the batch */
+            do {
+                CkptSortItem* item = &g_instance.ckpt_cxt_ctl->CkptBufferIds[ts_stat->index];
+                int buf_id = item->buf_id;
+
+                ts_stat->progress += ts_stat->progress_slice;
+                ts_stat->num_scanned++;
+                ts_stat->index++;
+                run++;
+
+                if (buf_id == DW_INVALID_BUFFER_ID) {
+                    continue;
+                }
+
+                BufferDesc* buf_desc = GetBufferDescriptor(buf_id);
+                uint32 buf_state = LockBufHdr(buf_desc);
+                if ((buf_state & BM_CHECKPOINT_NEEDED) && (buf_state & BM_DIRTY)) {
+                    UnlockBufHdr(buf_desc, buf_state);
+                    if (pgwr_batch_add_buffer(batch, buf_id, wb_context)) {
+                        actual_written++;
+                    } else {
+                        clean_buf_need_flush_flag(buf_desc);
+                    }
+                    if (batch->nblocks == PGWR_BATCH_SIZE) {
+                        pgwr_write_batch(batch, wb_context);
+                    }
+                } else {
+                    buf_state &= (~BM_CHECKPOINT_NEEDED);
+                    UnlockBufHdr(buf_desc, buf_state);
+                }
+            } while (ts_stat->num_scanned < ts_stat->num_to_scan && run < PGWR_MAX_COALESCE &&
+                     ckpt_items_adjacent(&g_instance.ckpt_cxt_ctl->CkptBufferIds[ts_stat->index - 1],
+                         &g_instance.ckpt_cxt_ctl->CkptBufferIds[ts_stat->index]));
+
+            /* Have all the buffers from the tablespace been processed? */
+            if (ts_stat->num_scanned == ts_stat->num_to_scan) {
+                (void)binaryheap_remove_first(ts_heap);
             } else {
-                clean_buf_need_flush_flag(buf_desc);
+                /* update heap with the new progress */
+                binaryheap_replace_first(ts_heap, PointerGetDatum(ts_stat));
             }
-        } else {
-            buf_state &= (~BM_CHECKPOINT_NEEDED);
-            UnlockBufHdr(buf_desc, buf_state);
         }
+        pgwr_write_batch(batch, wb_context);
+    }
+    PG_CATCH();
+    {
+        pgwr_abort_batch(batch);
+        PG_RE_THROW();
+    }
+    PG_END_TRY();
+
+    /* ask the kernel to write back what this round has written, so dirty data doesn't pile up there */
+    IssuePendingWritebacks(wb_context);
+
+    if (ts_heap != NULL) {
+        pfree(per_ts_stat);
+        binaryheap_free(ts_heap);
     }
 
     g_instance.ckpt_cxt_ctl->page_writer_procs.writer_proc[thread_id].need_flush = false;
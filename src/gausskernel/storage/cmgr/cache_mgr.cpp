@@ -139,7 +139,7 @@ void CacheMgr::Init(int64 cache_size, uint32 each_block_size, MgrCacheType type,
         m_CacheDesc[i].m_freeNext = i + 1;
         m_CacheDesc[i].m_cache_tag.type = CACHE_TYPE_NONE;
         m_CacheDesc[i].m_flag = CACHE_BLOCK_FREE;
-        if (type == MGR_CACHE_TYPE_DATA) {
+        if (type == MGR_CACHE_TYPE_DATA || type == MGR_CACHE_TYPE_COMPRESSED_DATA) {
             trancheId = (int)LWTRANCHE_DATA_CACHE;
         } else if (type == MGR_CACHE_TYPE_INDEX) {
             trancheId = (int)LWTRANCHE_META_CACHE;
@@ -147,6 +147,7 @@ void CacheMgr::Init(int64 cache_size, uint32 each_block_size, MgrCacheType type,
         m_CacheDesc[i].m_iobusy_lock = LWLockAssign(trancheId);
         m_CacheDesc[i].m_compress_lock = LWLockAssign(trancheId);
         m_CacheDesc[i].m_refreshing = false;
+        m_CacheDesc[i].m_probation = false;
         m_CacheDesc[i].m_datablock_size = 0;
 
         SpinLockInit(&m_CacheDesc[i].m_slot_hdr_lock);
@@ -159,6 +160,15 @@ void CacheMgr::Init(int64 cache_size, uint32 each_block_size, MgrCacheType type,
     SpinLockInit(&m_freeList_lock);
     SpinLockInit(&m_memsize_lock);
 
+    /* Probation ring can hold every slot, so that pushing never fails for a live block */
+    m_probation_ring = (CacheSlotId_t *)palloc0(total_slots * sizeof(CacheSlotId_t));
+    m_probation_head = 0;
+    m_probation_count = 0;
+    SpinLockInit(&m_probation_lock);
+    m_evict_count = 0;
+    m_reserve_callback = NULL;
+    m_drop_callback = NULL;
+
     /* Clock Sweep Starting point  */
     m_csweep = 0;
     m_csweep_lock = CStoreCUCacheSweepLock;
@@ -166,6 +176,9 @@ void CacheMgr::Init(int64 cache_size, uint32 each_block_size, MgrCacheType type,
     if (type == MGR_CACHE_TYPE_INDEX) {
         m_csweep_lock = MetaCacheSweepLock;
         m_partition_lock = FirstCacheSlotMappingLock + NUM_CACHE_BUFFER_PARTITIONS / 2;
+    } else if (type == MGR_CACHE_TYPE_COMPRESSED_DATA) {
+        /* compressed CU tier shares the mapping partitions with the CU tier, tags never collide */
+        m_csweep_lock = CStoreCompressedCUCacheSweepLock;
     }
 
     HASHCTL info;
@@ -204,9 +217,27 @@ void CacheMgr::Destroy(void)
     /* free spin lock resource */
     SpinLockFree(&m_memsize_lock);
     SpinLockFree(&m_freeList_lock);
+    SpinLockFree(&m_probation_lock);
 
     pfree_ext(m_CacheSlots);
     pfree_ext(m_CacheDesc);
+    pfree_ext(m_probation_ring);
+}
+
+/*
+ * @Description: check whether the block type can be stored by this cache instance
+ * @IN type: type of block
+ * @Return: true if matched
+ * @See also:
+ */
+bool CacheMgr::CacheTypeMatched(int32 type) const
+{
+    if (m_cache_type == MGR_CACHE_TYPE_DATA) {
+        return (type == CACHE_COlUMN_DATA || type == CACHE_ORC_DATA || type == CACHE_OBS_DATA);
+    } else if (m_cache_type == MGR_CACHE_TYPE_COMPRESSED_DATA) {
+        return (type == CACHE_COLUMN_COMPRESSED_DATA);
+    }
+    return (m_cache_type == MGR_CACHE_TYPE_INDEX && type == CACHE_ORC_INDEX);
 }
 
 /*
@@ -219,9 +250,7 @@ void CacheMgr::Destroy(void)
  */
 void CacheMgr::InitCacheBlockTag(CacheTag *cacheTag, int32 type, const void *key, int32 length) const
 {
-    Assert(((m_cache_type == MGR_CACHE_TYPE_DATA) &&
-            (type == CACHE_COlUMN_DATA || type == CACHE_ORC_DATA || type == CACHE_OBS_DATA)) ||
-           ((m_cache_type == MGR_CACHE_TYPE_INDEX) && (type == CACHE_ORC_INDEX)));
+    Assert(CacheTypeMatched(type));
 
     Assert(length <= MAX_CACHE_TAG_LEN);
 
@@ -257,10 +286,7 @@ CacheSlotId_t CacheMgr::FindCacheBlock(CacheTag *cacheTag, bool first_enter_bloc
             return slotId;
         }
         slotId = result->slot_id;
-        Assert(((m_cache_type == MGR_CACHE_TYPE_DATA) && (m_CacheDesc[slotId].m_cache_tag.type == CACHE_COlUMN_DATA ||
-                                                          m_CacheDesc[slotId].m_cache_tag.type == CACHE_ORC_DATA ||
-                                                          m_CacheDesc[slotId].m_cache_tag.type == CACHE_OBS_DATA)) ||
-               ((m_cache_type == MGR_CACHE_TYPE_INDEX) && (m_CacheDesc[slotId].m_cache_tag.type == CACHE_ORC_INDEX)));
+        Assert(CacheTypeMatched(m_CacheDesc[slotId].m_cache_tag.type));
 
         LockCacheDescHeader(slotId);
         if (first_enter_block && (m_CacheDesc[slotId].m_usage_count < CACHE_BLOCK_MAX_USAGE)) {
@@ -328,6 +354,7 @@ void CacheMgr::InvalidateCacheBlock(CacheTag *cacheTag)
         blockSize = m_CacheDesc[slotId].m_datablock_size;
         m_CacheDesc[slotId].m_flag = CACHE_BLOCK_FREE;
         m_CacheDesc[slotId].m_datablock_size = 0;
+        m_CacheDesc[slotId].m_probation = false;
         UnLockCacheDescHeader(slotId);
 
         /* free this block cache and update its size  before unpin this slot id */
@@ -353,7 +380,11 @@ void CacheMgr::DeleteCacheBlock(CacheTag *cacheTag)
 
     uint32 hashCode = GetHashCode(cacheTag);
     (void)LockHashPartion(hashCode, LW_EXCLUSIVE);
-    (void)hash_search_with_hash_value(m_hash, (void *)cacheTag, hashCode, HASH_REMOVE, NULL);
+    CacheLookupEnt *result =
+        (CacheLookupEnt *)hash_search_with_hash_value(m_hash, (void *)cacheTag, hashCode, HASH_REMOVE, NULL);
+    if (result != NULL && m_drop_callback != NULL) {
+        m_drop_callback(result->slot_id, cacheTag);
+    }
     UnLockHashPartion(hashCode);
 
     return;
@@ -373,6 +404,13 @@ CacheSlotId_t CacheMgr::EvictCacheBlock(int size, int retryNum)
      * Get the m_csweep_lock, only one sweeper searches the list. */
     LockSweep();
 
+    /* blocks admitted on probation and never referenced again go first */
+    slotId = EvictProbationBlock();
+    if (slotId != CACHE_BLOCK_INVALID_IDX) {
+        UnlockSweep();
+        return slotId;
+    }
+
     /* Initialize statistics for each new sweep */
     int found = 0;
     int start = m_csweep;
@@ -421,8 +459,10 @@ CacheSlotId_t CacheMgr::EvictCacheBlock(int size, int retryNum)
                                                               m_CacheDesc[slotId].m_flag, CACHE_BLOCK_INFREE)));
 
                         m_CacheDesc[slotId].m_flag = CACHE_BLOCK_INFREE;  // !Valid
+                        m_CacheDesc[slotId].m_probation = false;
                         PinCacheBlock_Locked(slotId);                     // Released header lock
                         found++;
+                        m_evict_count++;
 
                         /* Found a slot to be reused with some buffer space,
                          * the space must be freed and reused.
@@ -466,6 +506,150 @@ CacheSlotId_t CacheMgr::EvictCacheBlock(int size, int retryNum)
     return slotId;
 }
 
+/*
+ * @Description: evict the oldest block on the probation ring which was never referenced again
+ *      since it was admitted. Blocks referenced again are promoted to the clock, blocks in use
+ *      are kept on the ring. Caller must hold the sweep lock.
+ * @Return: pinned invalid slot id, or CACHE_BLOCK_INVALID_IDX if nothing can be evicted
+ * @See also: SetCacheBlockProbation
+ */
+CacheSlotId_t CacheMgr::EvictProbationBlock()
+{
+    CacheSlotId_t slotId = CACHE_BLOCK_INVALID_IDX;
+
+    SpinLockAcquire(&m_probation_lock);
+    int candidates = m_probation_count;
+    SpinLockRelease(&m_probation_lock);
+
+    while (candidates-- > 0) {
+        slotId = PopProbationRing();
+        if (slotId == CACHE_BLOCK_INVALID_IDX) {
+            break;
+        }
+
+        LockCacheDescHeader(slotId);
+        if (!m_CacheDesc[slotId].m_probation) {
+            /* stale entry, the block was promoted, evicted or dropped already */
+            UnLockCacheDescHeader(slotId);
+            continue;
+        }
+
+        if (!(m_CacheDesc[slotId].m_flag & (CACHE_BLOCK_VALID | CACHE_BLOCK_ERROR)) ||
+            m_CacheDesc[slotId].m_usage_count > 1) {
+            /* freed, or referenced again after admission: leave it to the clock */
+            m_CacheDesc[slotId].m_probation = false;
+            UnLockCacheDescHeader(slotId);
+            continue;
+        }
+
+        if ((m_CacheDesc[slotId].m_flag & CACHE_BLOCK_IOBUSY) || m_CacheDesc[slotId].m_refcount != 0 ||
+            m_CacheDesc[slotId].m_ring_count != 0) {
+            /* still being filled or read, keep its place for the next round */
+            UnLockCacheDescHeader(slotId);
+            (void)PushProbationRing(slotId);
+            continue;
+        }
+
+        ereport(DEBUG2, (errmodule(MOD_CACHE), errmsg("evict probation cache block, solt(%d), flag(%d - %d)", slotId,
+                                                      m_CacheDesc[slotId].m_flag, CACHE_BLOCK_INFREE)));
+        m_CacheDesc[slotId].m_probation = false;
+        m_CacheDesc[slotId].m_flag = CACHE_BLOCK_INFREE;  // !Valid
+        PinCacheBlock_Locked(slotId);                     // Released header lock
+        m_evict_count++;
+        return slotId;
+    }
+
+    return CACHE_BLOCK_INVALID_IDX;
+}
+
+/*
+ * @Description: append slot to the tail of probation ring
+ * @IN slotId: cache block index
+ * @Return: false if the ring is full
+ * @See also:
+ */
+bool CacheMgr::PushProbationRing(CacheSlotId_t slotId)
+{
+    bool pushed = false;
+
+    SpinLockAcquire(&m_probation_lock);
+    if (m_probation_count < m_CacheSlotsNum) {
+        m_probation_ring[(m_probation_head + m_probation_count) % m_CacheSlotsNum] = slotId;
+        m_probation_count++;
+        pushed = true;
+    }
+    SpinLockRelease(&m_probation_lock);
+
+    return pushed;
+}
+
+/*
+ * @Description: remove slot from the head of probation ring
+ * @Return: slot id, CACHE_BLOCK_INVALID_IDX if the ring is empty
+ * @See also:
+ */
+CacheSlotId_t CacheMgr::PopProbationRing()
+{
+    CacheSlotId_t slotId = CACHE_BLOCK_INVALID_IDX;
+
+    SpinLockAcquire(&m_probation_lock);
+    if (m_probation_count > 0) {
+        slotId = m_probation_ring[m_probation_head];
+        m_probation_head = (m_probation_head + 1) % m_CacheSlotsNum;
+        m_probation_count--;
+    }
+    SpinLockRelease(&m_probation_lock);
+
+    return slotId;
+}
+
+/*
+ * @Description: admit a just reserved block on probation. Such block is evicted before
+ *      any block of the clock unless it is referenced again, so one pass scan over a
+ *      large table can not flush the hot blocks out of cache.
+ * @IN slotId: cache block index, pinned by caller
+ * @See also:
+ */
+void CacheMgr::SetCacheBlockProbation(CacheSlotId_t slotId)
+{
+    Assert(slotId >= 0 && slotId <= m_CaccheSlotMax && slotId < m_CacheSlotsNum);
+    Assert(CacheBlockIsPinned(slotId));
+
+    LockCacheDescHeader(slotId);
+    if (m_CacheDesc[slotId].m_probation) {
+        UnLockCacheDescHeader(slotId);
+        return;
+    }
+    m_CacheDesc[slotId].m_probation = true;
+    UnLockCacheDescHeader(slotId);
+
+    if (!PushProbationRing(slotId)) {
+        LockCacheDescHeader(slotId);
+        m_CacheDesc[slotId].m_probation = false;
+        UnLockCacheDescHeader(slotId);
+    }
+}
+
+/*
+ * @Description: register a function called when a block is tagged in the hash table
+ * @IN callback: reserve callback
+ * @See also:
+ */
+void CacheMgr::SetReserveCallback(CacheBlockReserveCallback callback)
+{
+    m_reserve_callback = callback;
+}
+
+/*
+ * @Description: register a function called when a block is removed from the hash table
+ * @IN callback: drop callback
+ * @See also:
+ */
+void CacheMgr::SetDropCallback(CacheBlockDropCallback callback)
+{
+    m_drop_callback = callback;
+}
+
 /*
  * @Description:  get an Invalid cache block, first try get from free list cache, if without space,
  * second evict from used cache block, if all cache block are using, return error
@@ -577,7 +761,8 @@ void CacheMgr::FreeCacheBlockMem(CacheSlotId_t slot)
         cu->FreeMem<true>();
         cu->Reset();
     } else if (m_CacheDesc[slot].m_cache_tag.type == CACHE_ORC_DATA ||
-               m_CacheDesc[slot].m_cache_tag.type == CACHE_OBS_DATA) {
+               m_CacheDesc[slot].m_cache_tag.type == CACHE_OBS_DATA ||
+               m_CacheDesc[slot].m_cache_tag.type == CACHE_COLUMN_COMPRESSED_DATA) {
         OrcDataValue *orc_data = (OrcDataValue *)(&m_CacheSlots[slot * m_slot_length]);
         if (orc_data->value != NULL) {
             CStoreMemAlloc::Pfree(orc_data->value, false);
@@ -612,7 +797,8 @@ int CacheMgr::GetCacheBlockMemSize(CacheSlotId_t slot)
             slot_size = cu->GetCompressBufSize();
         }
     } else if (m_CacheDesc[slot].m_cache_tag.type == CACHE_ORC_DATA ||
-               m_CacheDesc[slot].m_cache_tag.type == CACHE_OBS_DATA) {
+               m_CacheDesc[slot].m_cache_tag.type == CACHE_OBS_DATA ||
+               m_CacheDesc[slot].m_cache_tag.type == CACHE_COLUMN_COMPRESSED_DATA) {
         OrcDataValue *orc_data = (OrcDataValue *)(&m_CacheSlots[slot * m_slot_length]);
         slot_size = orc_data->size;
     } else {
@@ -802,10 +988,7 @@ bool CacheMgr::CacheBlockIsPinned(CacheSlotId_t slotId) const
 bool CacheMgr::PinCacheBlock(CacheSlotId_t slotId)
 {
     Assert(slotId >= 0 && slotId <= m_CaccheSlotMax && slotId < m_CacheSlotsNum);
-    Assert(((m_cache_type == MGR_CACHE_TYPE_DATA) && (m_CacheDesc[slotId].m_cache_tag.type == CACHE_COlUMN_DATA ||
-                                                      m_CacheDesc[slotId].m_cache_tag.type == CACHE_ORC_DATA ||
-                                                      m_CacheDesc[slotId].m_cache_tag.type == CACHE_OBS_DATA)) ||
-           ((m_cache_type == MGR_CACHE_TYPE_INDEX) && (m_CacheDesc[slotId].m_cache_tag.type == CACHE_ORC_INDEX)));
+    Assert(CacheTypeMatched(m_CacheDesc[slotId].m_cache_tag.type));
 
     LockCacheDescHeader(slotId);
 
@@ -825,14 +1008,43 @@ bool CacheMgr::PinCacheBlock(CacheSlotId_t slotId)
                                                   slotId, m_CacheDesc[slotId].m_cache_tag.type,
                                                   m_CacheDesc[slotId].m_flag, m_CacheDesc[slotId].m_refcount)));
 
-    if (m_cache_type == MGR_CACHE_TYPE_INDEX) {
+    RememberPinnedBlock(slotId);
+    return true;
+}
+
+/*
+ * @Description: remember the pinned block in current resource owner
+ * @IN slotId: cache block index
+ * @See also:
+ */
+void CacheMgr::RememberPinnedBlock(CacheSlotId_t slotId)
+{
+    if (m_cache_type == MGR_CACHE_TYPE_COMPRESSED_DATA) {
+        ResourceOwnerEnlargeCompressedCacheSlot(t_thrd.utils_cxt.CurrentResourceOwner);
+        ResourceOwnerRememberCompressedCacheSlot(t_thrd.utils_cxt.CurrentResourceOwner, slotId);
+    } else if (m_cache_type == MGR_CACHE_TYPE_INDEX) {
         ResourceOwnerEnlargeMetaCacheSlot(t_thrd.utils_cxt.CurrentResourceOwner);
         ResourceOwnerRememberMetaCacheSlot(t_thrd.utils_cxt.CurrentResourceOwner, slotId);
     } else {
         ResourceOwnerEnlargeDataCacheSlot(t_thrd.utils_cxt.CurrentResourceOwner);
         ResourceOwnerRememberDataCacheSlot(t_thrd.utils_cxt.CurrentResourceOwner, slotId);
     }
-    return true;
+}
+
+/*
+ * @Description: forget the pinned block in current resource owner
+ * @IN slotId: cache block index
+ * @See also: RememberPinnedBlock
+ */
+void CacheMgr::ForgetPinnedBlock(CacheSlotId_t slotId)
+{
+    if (m_cache_type == MGR_CACHE_TYPE_COMPRESSED_DATA) {
+        ResourceOwnerForgetCompressedCacheSlot(t_thrd.utils_cxt.CurrentResourceOwner, slotId);
+    } else if (m_cache_type == MGR_CACHE_TYPE_INDEX) {
+        ResourceOwnerForgetMetaCacheSlot(t_thrd.utils_cxt.CurrentResourceOwner, slotId);
+    } else {
+        ResourceOwnerForgetDataCacheSlot(t_thrd.utils_cxt.CurrentResourceOwner, slotId);
+    }
 }
 
 /*
@@ -848,13 +1060,7 @@ void CacheMgr::PinCacheBlock_Locked(CacheSlotId_t slotId)
     m_CacheDesc[slotId].m_refcount++;
     UnLockCacheDescHeader(slotId);
 
-    if (m_cache_type == MGR_CACHE_TYPE_INDEX) {
-        ResourceOwnerEnlargeMetaCacheSlot(t_thrd.utils_cxt.CurrentResourceOwner);
-        ResourceOwnerRememberMetaCacheSlot(t_thrd.utils_cxt.CurrentResourceOwner, slotId);
-    } else {
-        ResourceOwnerEnlargeDataCacheSlot(t_thrd.utils_cxt.CurrentResourceOwner);
-        ResourceOwnerRememberDataCacheSlot(t_thrd.utils_cxt.CurrentResourceOwner, slotId);
-    }
+    RememberPinnedBlock(slotId);
     ereport(DEBUG2, (errmodule(MOD_CACHE),
                      errmsg("pin locked cache block, slot(%d), refcount(%u)", slotId, m_CacheDesc[slotId].m_refcount)));
 }
@@ -867,16 +1073,9 @@ void CacheMgr::PinCacheBlock_Locked(CacheSlotId_t slotId)
 void CacheMgr::UnPinCacheBlock(CacheSlotId_t slotId)
 {
     Assert(slotId >= 0 && slotId <= m_CaccheSlotMax && slotId < m_CacheSlotsNum);
-    Assert(((m_cache_type == MGR_CACHE_TYPE_DATA) && (m_CacheDesc[slotId].m_cache_tag.type == CACHE_COlUMN_DATA ||
-                                                      m_CacheDesc[slotId].m_cache_tag.type == CACHE_ORC_DATA ||
-                                                      m_CacheDesc[slotId].m_cache_tag.type == CACHE_OBS_DATA)) ||
-           ((m_cache_type == MGR_CACHE_TYPE_INDEX) && (m_CacheDesc[slotId].m_cache_tag.type == CACHE_ORC_INDEX)));
+    Assert(CacheTypeMatched(m_CacheDesc[slotId].m_cache_tag.type));
 
-    if (m_cache_type == MGR_CACHE_TYPE_INDEX) {
-        ResourceOwnerForgetMetaCacheSlot(t_thrd.utils_cxt.CurrentResourceOwner, slotId);
-    } else {
-        ResourceOwnerForgetDataCacheSlot(t_thrd.utils_cxt.CurrentResourceOwner, slotId);
-    }
+    ForgetPinnedBlock(slotId);
 
     LockCacheDescHeader(slotId);
     Assert(m_CacheDesc[slotId].m_refcount > 0);
@@ -1207,6 +1406,11 @@ CacheSlotId_t CacheMgr::ReserveCacheBlock(CacheTag *cacheTag, int size, bool &ha
     m_CacheDesc[slot].m_datablock_size = size;
     UnLockCacheDescHeader(slot);
 
+    /* the new tag is visible once the partition lock is released, let the owner index it first */
+    if (m_reserve_callback != NULL) {
+        m_reserve_callback(slot, &m_CacheDesc[slot].m_cache_tag);
+    }
+
     /* clear the block now, and fill it in later,  */
     FreeCacheBlockMem(slot);
 
@@ -1436,10 +1640,7 @@ bool CacheMgr::WaitIO(CacheSlotId_t slotId)
 void CacheMgr::CompleteIO(CacheSlotId_t slotId)
 {
     Assert(slotId >= 0 && slotId <= m_CaccheSlotMax && slotId < m_CacheSlotsNum);
-    Assert(((m_cache_type == MGR_CACHE_TYPE_DATA) && (m_CacheDesc[slotId].m_cache_tag.type == CACHE_COlUMN_DATA ||
-                                                      m_CacheDesc[slotId].m_cache_tag.type == CACHE_ORC_DATA ||
-                                                      m_CacheDesc[slotId].m_cache_tag.type == CACHE_OBS_DATA)) ||
-           ((m_cache_type == MGR_CACHE_TYPE_INDEX) && (m_CacheDesc[slotId].m_cache_tag.type == CACHE_ORC_INDEX)));
+    Assert(CacheTypeMatched(m_CacheDesc[slotId].m_cache_tag.type));
 
     LockCacheDescHeader(slotId);
     if (!(m_CacheDesc[slotId].m_flag & CACHE_BLOCK_IOBUSY)) {
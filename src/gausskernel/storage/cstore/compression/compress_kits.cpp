@@ -161,6 +161,9 @@ static void ZlibCheckCompressedData(_in_ char* rawData, _in_ int rawDataSize, _i
 static void DictCheckCompressedData(
     _in_ char* rawData, _in_ int rawDataSize, _in_ DictHeader* dicData, _in_ DicCodeType* dicCodes, _in_ int nDicCodes);
 
+static void BitpackCheckCompressedData(
+    _in_ char* rawData, _in_ int rawDataSize, _in_ char* cmprBuf, _in_ int cmprBufSize, _in_ short eachValSize);
+
 #endif
 
 template <short datasize>
@@ -926,6 +929,398 @@ int64 DeltaCoder::Decompress(
     return ret;
 }
 
+/*************************************************************************
+ *                  Frame-Of-Reference Bit Packing                        *
+ *************************************************************************/
+#define BITPACK_ROWS (BITPACK_BLOCK_SIZE / BITPACK_LANES)
+#define BITPACK_MAX_WIDTH 32
+
+/*
+ * GCC vector extension is lowered to SSE2 on x86_64 and NEON on aarch64.
+ * aligned(1) makes the loads/stores unaligned ones, because packed words
+ * follow a 9 bytes block header.
+ */
+typedef uint32 BitpackVec __attribute__((vector_size(BITPACK_LANES * sizeof(uint32)), aligned(1)));
+typedef void (*BitpackBlockFunc)(const uint32* in, uint32* out);
+
+/*
+ * @Description: pack one block whose residuals are all less than (1 << bitWidth).
+ *    in holds BITPACK_BLOCK_SIZE residuals, and (bitWidth * BITPACK_LANES) words
+ *    are written into out.
+ */
+template <int bitWidth>
+static void BitpackPackBlock(const uint32* in, uint32* out)
+{
+    const BitpackVec* src = (const BitpackVec*)in;
+    BitpackVec* dst = (BitpackVec*)out;
+    const BitpackVec zero = {0, 0, 0, 0};
+    BitpackVec acc = zero;
+    int shift = 0;
+
+    for (int row = 0; row < BITPACK_ROWS; ++row) {
+        BitpackVec val = src[row];
+        acc |= (val << shift);
+        shift += bitWidth;
+        if (shift >= BITPACK_MAX_WIDTH) {
+            *dst++ = acc;
+            shift -= BITPACK_MAX_WIDTH;
+            /* the high part of val which doesn't fit the stored word */
+            acc = (shift > 0) ? (val >> (bitWidth - shift)) : zero;
+        }
+    }
+}
+
+/*
+ * @Description: reverse of BitpackPackBlock(), (bitWidth * BITPACK_LANES) words
+ *    are read from in, and BITPACK_BLOCK_SIZE residuals are written into out.
+ */
+template <int bitWidth>
+static void BitpackUnpackBlock(const uint32* in, uint32* out)
+{
+    const uint32 mask = (uint32)((((uint64)1) << bitWidth) - 1);
+    const BitpackVec* src = (const BitpackVec*)in;
+    BitpackVec* dst = (BitpackVec*)out;
+    BitpackVec word = *src++;
+    int shift = 0;
+
+    for (int row = 0; row < BITPACK_ROWS; ++row) {
+        BitpackVec val = (word >> shift);
+        shift += bitWidth;
+        if (shift > BITPACK_MAX_WIDTH) {
+            /* this value crosses two words */
+            word = *src++;
+            shift -= BITPACK_MAX_WIDTH;
+            val |= (word << (bitWidth - shift));
+        } else if (shift == BITPACK_MAX_WIDTH && row + 1 < BITPACK_ROWS) {
+            word = *src++;
+            shift = 0;
+        }
+        dst[row] = (val & mask);
+    }
+}
+
+#define BITPACK_BLOCK_FUNCS(_f)                                                                                   \
+    {                                                                                                            \
+        NULL, _f<1>, _f<2>, _f<3>, _f<4>, _f<5>, _f<6>, _f<7>, _f<8>, _f<9>, _f<10>, _f<11>, _f<12>, _f<13>,    \
+            _f<14>, _f<15>, _f<16>, _f<17>, _f<18>, _f<19>, _f<20>, _f<21>, _f<22>, _f<23>, _f<24>, _f<25>,       \
+            _f<26>, _f<27>, _f<28>, _f<29>, _f<30>, _f<31>, _f<32>                                               \
+    }
+
+/* bit width 0 means all residuals are 0, and nothing is packed */
+static const BitpackBlockFunc BitpackPackFuncs[BITPACK_MAX_WIDTH + 1] = BITPACK_BLOCK_FUNCS(BitpackPackBlock);
+static const BitpackBlockFunc BitpackUnpackFuncs[BITPACK_MAX_WIDTH + 1] = BITPACK_BLOCK_FUNCS(BitpackUnpackBlock);
+
+static FORCE_INLINE int BitpackGetWidth(uint64 range)
+{
+    return (range == 0) ? 0 : (int)(64 - __builtin_clzll(range));
+}
+
+template <short valSize>
+static FORCE_INLINE int64 BitpackReadValue(const char* buf, int idx)
+{
+    switch (valSize) {
+        case sizeof(int16):
+            return ((const int16*)buf)[idx];
+        case sizeof(int32):
+            return ((const int32*)buf)[idx];
+        default:
+            return ((const int64*)buf)[idx];
+    }
+}
+
+template <short valSize>
+static FORCE_INLINE void BitpackWriteValue(char* buf, int idx, uint64 val)
+{
+    switch (valSize) {
+        case sizeof(int16):
+            ((int16*)buf)[idx] = (int16)val;
+            break;
+        case sizeof(int32):
+            ((int32*)buf)[idx] = (int32)val;
+            break;
+        default:
+            ((int64*)buf)[idx] = (int64)val;
+            break;
+    }
+}
+
+/*
+ * @Description: compute the residuals of one block. for DELTA mode residual is the
+ *    difference to the previous value within the same lane, and prev is updated.
+ *    all the arithmetic wraps around 64 bits, so that it's reversible for any input.
+ */
+template <short valSize, bool isDelta>
+static FORCE_INLINE void BitpackBlockResiduals(const char* inbuf, int first, int n, uint64* prev, int64* residuals)
+{
+    for (int i = 0; i < n; ++i) {
+        uint64 val = (uint64)BitpackReadValue<valSize>(inbuf, first + i);
+        if (isDelta) {
+            residuals[i] = (int64)(val - prev[i % BITPACK_LANES]);
+            prev[i % BITPACK_LANES] = val;
+        } else {
+            residuals[i] = (int64)val;
+        }
+    }
+}
+
+/*
+ * @Description: scan all blocks and remember frame and bit width of each block.
+ * @Return: the total of bit widths, or -1 if any block range is out of 32 bits.
+ */
+template <short valSize, bool isDelta>
+static int64 BitpackScanBlocks(const char* inbuf, int nvals, int64 seed, int64* frames, uint8* widths)
+{
+    int64 residuals[BITPACK_BLOCK_SIZE];
+    uint64 prev[BITPACK_LANES] = {(uint64)seed, (uint64)seed, (uint64)seed, (uint64)seed};
+    int64 totalWidth = 0;
+
+    for (int first = 0, blk = 0; first < nvals; first += BITPACK_BLOCK_SIZE, ++blk) {
+        int n = Min(BITPACK_BLOCK_SIZE, nvals - first);
+        BitpackBlockResiduals<valSize, isDelta>(inbuf, first, n, prev, residuals);
+
+        int64 minVal = residuals[0];
+        int64 maxVal = residuals[0];
+        for (int i = 1; i < n; ++i) {
+            minVal = Min(minVal, residuals[i]);
+            maxVal = Max(maxVal, residuals[i]);
+        }
+
+        uint64 range = (uint64)maxVal - (uint64)minVal;
+        if (range > PG_UINT32_MAX) {
+            return -1;
+        }
+        frames[blk] = minVal;
+        widths[blk] = (uint8)BitpackGetWidth(range);
+        totalWidth += widths[blk];
+    }
+    return totalWidth;
+}
+
+template <short valSize>
+int BitpackCoder::CompressInner(char* inbuf, char* outbuf, int insize, int outsize)
+{
+    int nvals = insize / valSize;
+    int nblocks = (nvals + BITPACK_BLOCK_SIZE - 1) / BITPACK_BLOCK_SIZE;
+    int64 seed = BitpackReadValue<valSize>(inbuf, 0);
+    int64* frames[2];
+    uint8* widths[2];
+    int64 cmprSize[2];
+    errno_t rc = EOK;
+
+    /* [0] is for plain FOR, and [1] is for DELTA + FOR */
+    for (int k = 0; k < 2; ++k) {
+        frames[k] = (int64*)palloc(sizeof(int64) * nblocks);
+        widths[k] = (uint8*)palloc(sizeof(uint8) * nblocks);
+    }
+    int64 plainWidth = BitpackScanBlocks<valSize, false>(inbuf, nvals, seed, frames[0], widths[0]);
+    int64 deltaWidth = BitpackScanBlocks<valSize, true>(inbuf, nvals, seed, frames[1], widths[1]);
+    cmprSize[0] = (plainWidth < 0) ? PG_INT64_MAX
+                                    : (int64)(BITPACK_HEADER_SIZE + BITPACK_BLOCK_HEADER_SIZE * nblocks +
+                                               plainWidth * BITPACK_LANES * sizeof(uint32));
+    cmprSize[1] = (deltaWidth < 0) ? PG_INT64_MAX
+                                    : (int64)(BITPACK_HEADER_SIZE + sizeof(int64) + BITPACK_BLOCK_HEADER_SIZE * nblocks +
+                                               deltaWidth * BITPACK_LANES * sizeof(uint32));
+
+    /* plain FOR wins the tie, because its decoding is cheaper */
+    int k = (cmprSize[1] < cmprSize[0]) ? 1 : 0;
+    if (cmprSize[k] >= insize || cmprSize[k] > outsize) {
+        for (int i = 0; i < 2; ++i) {
+            pfree(frames[i]);
+            pfree(widths[i]);
+        }
+        return 0;
+    }
+
+    char* pos = outbuf;
+    uint8 flags = (k == 1) ? BITPACK_FLAG_DELTA : 0;
+    uint32 count = (uint32)nvals;
+    *pos++ = (char)flags;
+    rc = memcpy_s(pos, sizeof(uint32), &count, sizeof(uint32));
+    securec_check(rc, "", "");
+    pos += sizeof(uint32);
+    if (k == 1) {
+        rc = memcpy_s(pos, sizeof(int64), &seed, sizeof(int64));
+        securec_check(rc, "", "");
+        pos += sizeof(int64);
+    }
+
+    int64 residuals[BITPACK_BLOCK_SIZE];
+    uint32 packIn[BITPACK_BLOCK_SIZE];
+    uint64 prev[BITPACK_LANES] = {(uint64)seed, (uint64)seed, (uint64)seed, (uint64)seed};
+    for (int first = 0, blk = 0; first < nvals; first += BITPACK_BLOCK_SIZE, ++blk) {
+        int n = Min(BITPACK_BLOCK_SIZE, nvals - first);
+        int64 frame = frames[k][blk];
+        int width = widths[k][blk];
+
+        if (k == 1) {
+            BitpackBlockResiduals<valSize, true>(inbuf, first, n, prev, residuals);
+        } else {
+            BitpackBlockResiduals<valSize, false>(inbuf, first, n, prev, residuals);
+        }
+        for (int i = 0; i < n; ++i) {
+            packIn[i] = (uint32)((uint64)residuals[i] - (uint64)frame);
+        }
+        /* pad the last block with the frame value */
+        for (int i = n; i < BITPACK_BLOCK_SIZE; ++i) {
+            packIn[i] = 0;
+        }
+
+        rc = memcpy_s(pos, sizeof(int64), &frame, sizeof(int64));
+        securec_check(rc, "", "");
+        pos += sizeof(int64);
+        *pos++ = (char)width;
+        if (width > 0) {
+            BitpackPackFuncs[width](packIn, (uint32*)pos);
+            pos += width * BITPACK_LANES * sizeof(uint32);
+        }
+    }
+    Assert((int64)(pos - outbuf) == cmprSize[k]);
+
+    for (int i = 0; i < 2; ++i) {
+        pfree(frames[i]);
+        pfree(widths[i]);
+    }
+    return (int)(pos - outbuf);
+}
+
+template <short valSize>
+int BitpackCoder::DecompressInner(char* inbuf, char* outbuf, int insize, int outsize)
+{
+    char* pos = inbuf;
+    char* end = inbuf + insize;
+    uint32 count = 0;
+    int64 seed = 0;
+    errno_t rc = EOK;
+
+    if (insize < (int)BITPACK_HEADER_SIZE) {
+        return -1;
+    }
+    uint8 flags = (uint8)*pos++;
+    rc = memcpy_s(&count, sizeof(uint32), pos, sizeof(uint32));
+    securec_check(rc, "", "");
+    pos += sizeof(uint32);
+    if ((int64)count * valSize > outsize) {
+        return -1;
+    }
+    bool isDelta = ((flags & BITPACK_FLAG_DELTA) != 0);
+    if (isDelta) {
+        if (pos + sizeof(int64) > end) {
+            return -1;
+        }
+        rc = memcpy_s(&seed, sizeof(int64), pos, sizeof(int64));
+        securec_check(rc, "", "");
+        pos += sizeof(int64);
+    }
+
+    uint32 residuals[BITPACK_BLOCK_SIZE];
+    uint64 values[BITPACK_BLOCK_SIZE];
+    uint64 acc[BITPACK_LANES] = {(uint64)seed, (uint64)seed, (uint64)seed, (uint64)seed};
+    int nvals = (int)count;
+    for (int first = 0; first < nvals; first += BITPACK_BLOCK_SIZE) {
+        int n = Min(BITPACK_BLOCK_SIZE, nvals - first);
+        int64 frame = 0;
+
+        if (pos + BITPACK_BLOCK_HEADER_SIZE > end) {
+            return -1;
+        }
+        rc = memcpy_s(&frame, sizeof(int64), pos, sizeof(int64));
+        securec_check(rc, "", "");
+        pos += sizeof(int64);
+        int width = (uint8)*pos++;
+        int packedSize = width * BITPACK_LANES * sizeof(uint32);
+        if (width > BITPACK_MAX_WIDTH || pos + packedSize > end) {
+            return -1;
+        }
+        if (width > 0) {
+            BitpackUnpackFuncs[width]((const uint32*)pos, residuals);
+            pos += packedSize;
+        } else {
+            rc = memset_s(residuals, sizeof(residuals), 0, sizeof(residuals));
+            securec_check(rc, "", "");
+        }
+
+        if (isDelta) {
+            /* prefix sum over each lane, one vector add per row */
+            for (int row = 0; row < BITPACK_ROWS; ++row) {
+                for (int lane = 0; lane < BITPACK_LANES; ++lane) {
+                    acc[lane] += (uint64)frame + residuals[row * BITPACK_LANES + lane];
+                    values[row * BITPACK_LANES + lane] = acc[lane];
+                }
+            }
+            for (int i = 0; i < n; ++i) {
+                BitpackWriteValue<valSize>(outbuf, first + i, values[i]);
+            }
+        } else {
+            for (int i = 0; i < n; ++i) {
+                BitpackWriteValue<valSize>(outbuf, first + i, (uint64)frame + residuals[i]);
+            }
+        }
+    }
+
+    return (pos == end) ? (nvals * valSize) : -1;
+}
+
+/*
+ * @Description: compress integer data by FOR + bit packing. the better one
+ *    between plain FOR and DELTA + FOR is chosen.
+ * @IN inbuf/insize: raw integer values
+ * @OUT outbuf: compressed data
+ * @IN outsize: size of outbuf
+ * @Return: compressed size, 0 means bit packing isn't applied.
+ */
+int BitpackCoder::Compress(_in_ char* inbuf, _out_ char* outbuf, _in_ int insize, _in_ int outsize)
+{
+    int ret = 0;
+    Assert(insize > 0);
+    Assert((insize % m_eachValSize) == 0);
+
+    switch (m_eachValSize) {
+        case sizeof(int16):
+            ret = CompressInner<sizeof(int16)>(inbuf, outbuf, insize, outsize);
+            break;
+        case sizeof(int32):
+            ret = CompressInner<sizeof(int32)>(inbuf, outbuf, insize, outsize);
+            break;
+        case sizeof(int64):
+            ret = CompressInner<sizeof(int64)>(inbuf, outbuf, insize, outsize);
+            break;
+        default:
+            Assert(false);
+            break;
+    }
+
+#ifdef USE_ASSERT_CHECKING
+    if (ret > 0) {
+        BitpackCheckCompressedData(inbuf, insize, outbuf, ret, m_eachValSize);
+    }
+#endif
+    return ret;
+}
+
+/*
+ * @Description: decompress data packed by BitpackCoder::Compress()
+ * @Return: decompressed size, -1 means the input is corrupted.
+ */
+int BitpackCoder::Decompress(_in_ char* inbuf, _out_ char* outbuf, _in_ int insize, _in_ int outsize)
+{
+    int ret = -1;
+    switch (m_eachValSize) {
+        case sizeof(int16):
+            ret = DecompressInner<sizeof(int16)>(inbuf, outbuf, insize, outsize);
+            break;
+        case sizeof(int32):
+            ret = DecompressInner<sizeof(int32)>(inbuf, outbuf, insize, outsize);
+            break;
+        case sizeof(int64):
+            ret = DecompressInner<sizeof(int64)>(inbuf, outbuf, insize, outsize);
+            break;
+        default:
+            Assert(false);
+            break;
+    }
+    return ret;
+}
+
 /*************************************************************************
  *                         Dictionary Compression                         *
  *************************************************************************/
@@ -1494,6 +1889,20 @@ static void DictCheckCompressedData(
     delete dict;
 }
 
+static void BitpackCheckCompressedData(
+    _in_ char* rawData, _in_ int rawDataSize, _in_ char* cmprBuf, _in_ int cmprBufSize, _in_ short eachValSize)
+{
+    BufferHelper uncmprBuf = {NULL, 0, Unknown};
+    BufferHelperMalloc(&uncmprBuf, rawDataSize);
+
+    BitpackCoder bitpack(eachValSize);
+    int uncmprSize = bitpack.Decompress(cmprBuf, uncmprBuf.buf, cmprBufSize, rawDataSize);
+    Assert(uncmprSize == rawDataSize);
+    Assert(memcmp(uncmprBuf.buf, rawData, rawDataSize) == 0);
+
+    BufferHelperFree(&uncmprBuf);
+}
+
 #endif
 
 int64 read_data_by_size(_in_ char* inbuf, unsigned int* pos, short size)
@@ -23,16 +23,21 @@
  */
 #include "access/htup.h"
 #include "catalog/pg_type.h"
+#include "funcapi.h"
+#include "miscadmin.h"
 #include "nodes/primnodes.h"
+#include "portability/instr_time.h"
 #include "storage/cstore_compress.h"
 #include "storage/cu.h"
 #include "utils/biginteger.h"
+#include "utils/builtins.h"
 #include "utils/gs_bitmap.h"
 #include "utils/rel.h"
 #include "utils/rel_gs.h"
 
 extern int8 heaprel_get_compresslevel_from_modes(int16 modes);
 extern int8 heaprel_get_compression_from_modes(int16 modes);
+extern int16 heaprel_make_compressing_modes(int8 compression, int8 compresslevel);
 
 /// we need to do unit testing for some *static* functions,
 /// so we redefine *static* if *ENABLE_UT* is defined.
@@ -297,7 +302,7 @@ static FORCE_INLINE void swapBuf(char *&buf1, char *&buf2, int &sz1, int &sz2)
 }
 
 IntegerCoder::IntegerCoder(short valSize)
-    : m_adopt_rle(true), m_minVal(0), m_maxVal(0), m_isValid(false), m_eachValSize(valSize)
+    : m_adopt_rle(true), m_adopt_bitpack(true), m_minVal(0), m_maxVal(0), m_isValid(false), m_eachValSize(valSize)
 {}
 
 void IntegerCoder::SetMinMaxVal(int64 min, int64 max)
@@ -320,6 +325,29 @@ void IntegerCoder::InsertMinMaxVal(char* buf, int* usedSize)
     *usedSize += (m_eachValSize * 2);
 }
 
+/*
+ * @Description: try FOR + bit packing on the raw integer data
+ * @IN in: input arguments
+ * @OUT bitpackBuf: holds the packed data if it's applied to
+ * @Return: packed size, 0 means bit packing cannot be applied to.
+ */
+int IntegerCoder::TryBitpack(const CompressionArg1& in, BufferHelper* bitpackBuf)
+{
+    // too few values to fill one block, the block header eats up the benefit
+    if (!m_adopt_bitpack || !BitpackCoder::SupportValSize(m_eachValSize) ||
+        (in.sz / m_eachValSize) < BITPACK_BLOCK_SIZE) {
+        return 0;
+    }
+
+    BitpackCoder bitpack(m_eachValSize);
+    BufferHelperMalloc(bitpackBuf, in.sz);
+    int cmprSize = bitpack.Compress(in.buf, bitpackBuf->buf, in.sz, (int)bitpackBuf->bufSize);
+    if (cmprSize <= 0) {
+        BufferHelperFree(bitpackBuf);
+    }
+    return cmprSize;
+}
+
 // 0 returned means that no data has been compressed.
 // othersize value>0 returned and compressed data and its size are within out.
 template <bool adopt_rle>
@@ -401,6 +429,29 @@ int IntegerCoder::CompressInner(const CompressionArg1& in, CompressionArg2& out)
         }
     }
 
+    // Step2.5: FOR + bit packing is the alternative of DELTA and RleCoder. it's adopted
+    // when it's not bigger than their result, because unpacking a block costs only a few
+    // vector instructions while RLE decoding goes value by value.
+    BufferHelper bitpackBuf = {NULL, 0, Unknown};
+    int bitpackSize = TryBitpack(in, &bitpackBuf);
+    if (bitpackSize > 0) {
+        int currSize = currInBufSize;
+        if (out.modes & CU_DeltaCompressed) {
+            currSize += (this->m_eachValSize * 2);
+        }
+        if (bitpackSize <= currSize) {
+            rc = memcpy_s(out.buf, bitpackSize, bitpackBuf.buf, bitpackSize);
+            securec_check(rc, "", "");
+            out.sz = bitpackSize;
+            out.modes &= ~(CU_DeltaCompressed | CU_RLECompressed);
+            out.modes |= CU_BitpackCompressed;
+
+            currInBuf = out.buf;
+            currInBufSize = bitpackSize;
+        }
+        BufferHelperFree(&bitpackBuf);
+    }
+
     // Step3: try to apply LZ4 or Zlib according to CompressLevel
     // Apply different compression method for compressionLevel
     // COMPRESS_LOW:    delta compression | RleCoder
@@ -559,6 +610,24 @@ int IntegerCoder::Decompress(_in_ const CompressionArg2& in, _out_ CompressionAr
         }
     }
 
+    if ((modes & CU_BitpackCompressed) != 0) {
+        // bit packing is never combined with DELTA or RLE
+        Assert((modes & (CU_DeltaCompressed | CU_RLECompressed)) == 0);
+
+        BitpackCoder bitpack(m_eachValSize);
+        nextOutSize = bitpack.Decompress(nextInBuf, nextOutBuf, nextInSize, out.sz);
+        if (nextOutSize < 0) {
+            BufferHelperFree(&tmpBuf);
+            return -1;
+        }
+
+        if (preparedOk) {
+            swapBuf(nextInBuf, nextOutBuf, nextInSize, nextOutSize);
+        } else {
+            prepareSwapBuf(nextInBuf, nextOutBuf, nextInSize, nextOutSize, tmpBuf.buf, out.sz, preparedOk);
+        }
+    }
+
     if ((modes & CU_RLECompressed) != 0) {
         // case 1: both delta and rle methods are applied to, the value size is inValSize,
         //         which is the size of DELTA value.
@@ -2895,6 +2964,248 @@ void compression_options::set_common_flags(uint32 modes)
     m_adopt_rle = ((modes & CU_RLECompressed) != 0);
 }
 
+/*************************************************************************
+ *                 Micro Benchmark of Integer Compression                 *
+ *************************************************************************/
+#define CU_BENCH_COL_NUM 7
+#define CU_BENCH_MAX_VALUES (1024 * 1024)
+#define CU_BENCH_MAX_LOOPS 10000
+
+typedef struct CUBenchCodec {
+    const char* name;
+    int8 compression;
+    bool adoptRle;
+    bool adoptBitpack;
+    bool bitpackOnly;
+} CUBenchCodec;
+
+typedef struct CUBenchResult {
+    const char* name;
+    int64 rawBytes;
+    int64 cmprBytes;
+    bool bitpacked;
+    double compressMBps;
+    double decompressMBps;
+} CUBenchResult;
+
+static const CUBenchCodec cu_bench_codecs[] = {
+    {"delta", COMPRESS_LOW, false, false, false},
+    {"delta+rle", COMPRESS_LOW, true, false, false},
+    {"bitpack", COMPRESS_LOW, false, true, true},
+    {"auto", COMPRESS_LOW, true, true, false},
+    {"delta+rle+lz4", COMPRESS_MIDDLE, true, false, false},
+    {"delta+rle+zlib", COMPRESS_HIGH, true, false, false}
+};
+
+/*
+ * @Description: fill sample integer data of the given distribution.
+ *    a fixed xorshift seed keeps the data same between runs.
+ */
+static void CUBenchFillData(char* buf, int valSize, int nvals, const char* distribution)
+{
+    uint64 seed = UINT64CONST(88172645463325252);
+    int64 val = 0;
+
+    for (int i = 0; i < nvals; ++i) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+
+        if (strcmp(distribution, "sequence") == 0) {
+            /* ascending values with small gaps, like serial keys and timestamps */
+            val += (int64)(seed % 4);
+        } else if (strcmp(distribution, "narrow") == 0) {
+            val = (int64)(seed % 1000);
+        } else if (strcmp(distribution, "runs") == 0) {
+            val = (i % 16 == 0) ? (int64)(seed % 1000) : val;
+        } else {
+            val = (int64)seed;
+        }
+        Int64DataConvertTo(val, valSize, buf + (int64)i * valSize);
+    }
+}
+
+static double CUBenchMBps(int64 bytes, int loops, instr_time elapsed)
+{
+    double secs = INSTR_TIME_GET_DOUBLE(elapsed);
+    return (secs > 0) ? ((double)bytes * loops / secs / (1024 * 1024)) : 0;
+}
+
+static void CUBenchRunCodec(const CUBenchCodec* codec, char* rawData, int rawSize, short valSize, int loops,
+    CUBenchResult* result)
+{
+    int cmprBufSize = rawSize * 2 + 1024;
+    char* cmprBuf = (char*)palloc(cmprBufSize);
+    char* uncmprBuf = (char*)palloc(rawSize);
+    int cmprSize = 0;
+    uint16 modes = 0;
+    instr_time start;
+    instr_time elapsed;
+
+    result->name = codec->name;
+    result->rawBytes = rawSize;
+
+    INSTR_TIME_SET_CURRENT(start);
+    for (int i = 0; i < loops; ++i) {
+        if (codec->bitpackOnly) {
+            BitpackCoder bitpack(valSize);
+            cmprSize = bitpack.Compress(rawData, cmprBuf, rawSize, cmprBufSize);
+            modes = (cmprSize > 0) ? CU_BitpackCompressed : 0;
+        } else {
+            CompressionArg1 in = {0};
+            in.buf = rawData;
+            in.sz = rawSize;
+            in.mode = heaprel_make_compressing_modes(codec->compression, 0);
+            CompressionArg2 out = {0};
+            out.buf = cmprBuf;
+            out.sz = cmprBufSize;
+
+            IntegerCoder intCoder(valSize);
+            intCoder.m_adopt_rle = codec->adoptRle;
+            intCoder.m_adopt_bitpack = codec->adoptBitpack;
+            cmprSize = intCoder.Compress(in, out);
+            modes = out.modes;
+        }
+    }
+    INSTR_TIME_SET_CURRENT(elapsed);
+    INSTR_TIME_SUBTRACT(elapsed, start);
+    result->compressMBps = CUBenchMBps(rawSize, loops, elapsed);
+    result->bitpacked = (cmprSize > 0) && ((modes & CU_BitpackCompressed) != 0);
+
+    /* the codec gives up, and the raw data would be stored */
+    if (cmprSize <= 0) {
+        result->cmprBytes = rawSize;
+        result->decompressMBps = 0;
+        pfree(cmprBuf);
+        pfree(uncmprBuf);
+        return;
+    }
+    result->cmprBytes = cmprSize;
+
+    INSTR_TIME_SET_CURRENT(start);
+    for (int i = 0; i < loops; ++i) {
+        CompressionArg2 in = {cmprBuf, cmprSize, modes};
+        CompressionArg1 out = {0};
+        out.buf = uncmprBuf;
+        out.sz = rawSize;
+
+        IntegerCoder intDecoder(valSize);
+        if (intDecoder.Decompress(in, out) != rawSize) {
+            ereport(ERROR, (errcode(ERRCODE_DATA_CORRUPTED), errmsg("codec \"%s\" decompressed wrong size", codec->name)));
+        }
+    }
+    INSTR_TIME_SET_CURRENT(elapsed);
+    INSTR_TIME_SUBTRACT(elapsed, start);
+    result->decompressMBps = CUBenchMBps(rawSize, loops, elapsed);
+
+    if (memcmp(uncmprBuf, rawData, rawSize) != 0) {
+        ereport(ERROR, (errcode(ERRCODE_DATA_CORRUPTED), errmsg("codec \"%s\" decompressed wrong data", codec->name)));
+    }
+    pfree(cmprBuf);
+    pfree(uncmprBuf);
+}
+
+/*
+ * @Description: compare compression ratio and throughput of integer codecs on
+ *    generated data, one row for each codec.
+ * @IN value_size: 2, 4 or 8 bytes
+ * @IN value_count: number of values, one CU holds 60000 values at most.
+ * @IN distribution: sequence, narrow, runs or random
+ * @IN loops: times to repeat compressing and decompressing
+ */
+Datum gs_cu_compress_bench(PG_FUNCTION_ARGS)
+{
+    FuncCallContext* func_ctx = NULL;
+    CUBenchResult* results = NULL;
+
+    if (SRF_IS_FIRSTCALL()) {
+        TupleDesc tup_desc;
+        MemoryContext old_context;
+        int valSize = PG_GETARG_INT32(0);
+        int nvals = PG_GETARG_INT32(1);
+        char* distribution = text_to_cstring(PG_GETARG_TEXT_PP(2));
+        int loops = PG_GETARG_INT32(3);
+
+        if (!superuser()) {
+            ereport(ERROR,
+                (errcode(ERRCODE_INSUFFICIENT_PRIVILEGE), errmsg("must be system admin to run compression benchmark")));
+        }
+        if (!BitpackCoder::SupportValSize(valSize)) {
+            ereport(ERROR, (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("value_size must be 2, 4 or 8")));
+        }
+        if (nvals <= 0 || nvals > CU_BENCH_MAX_VALUES) {
+            ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                    errmsg("value_count must be between 1 and %d", CU_BENCH_MAX_VALUES)));
+        }
+        if (loops <= 0 || loops > CU_BENCH_MAX_LOOPS) {
+            ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE), errmsg("loops must be between 1 and %d", CU_BENCH_MAX_LOOPS)));
+        }
+        if (strcmp(distribution, "sequence") != 0 && strcmp(distribution, "narrow") != 0 &&
+            strcmp(distribution, "runs") != 0 && strcmp(distribution, "random") != 0) {
+            ereport(ERROR,
+                (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                    errmsg("distribution must be one of sequence, narrow, runs and random")));
+        }
+
+        func_ctx = SRF_FIRSTCALL_INIT();
+        old_context = MemoryContextSwitchTo(func_ctx->multi_call_memory_ctx);
+
+        tup_desc = CreateTemplateTupleDesc(CU_BENCH_COL_NUM, false);
+        TupleDescInitEntry(tup_desc, (AttrNumber)1, "codec", TEXTOID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)2, "raw_bytes", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)3, "compressed_bytes", INT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)4, "bitpacked", BOOLOID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)5, "ratio", FLOAT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)6, "compress_mbps", FLOAT8OID, -1, 0);
+        TupleDescInitEntry(tup_desc, (AttrNumber)7, "decompress_mbps", FLOAT8OID, -1, 0);
+        func_ctx->tuple_desc = BlessTupleDesc(tup_desc);
+
+        int rawSize = valSize * nvals;
+        char* rawData = (char*)palloc(rawSize);
+        CUBenchFillData(rawData, valSize, nvals, distribution);
+
+        int ncodecs = (int)lengthof(cu_bench_codecs);
+        results = (CUBenchResult*)palloc0(sizeof(CUBenchResult) * ncodecs);
+        for (int i = 0; i < ncodecs; ++i) {
+            CHECK_FOR_INTERRUPTS();
+            CUBenchRunCodec(&cu_bench_codecs[i], rawData, rawSize, (short)valSize, loops, &results[i]);
+        }
+        pfree(rawData);
+
+        func_ctx->user_fctx = results;
+        func_ctx->max_calls = ncodecs;
+        (void)MemoryContextSwitchTo(old_context);
+    }
+
+    func_ctx = SRF_PERCALL_SETUP();
+    if (func_ctx->call_cntr < func_ctx->max_calls) {
+        Datum values[CU_BENCH_COL_NUM];
+        bool nulls[CU_BENCH_COL_NUM] = {false};
+        HeapTuple tuple = NULL;
+        int i = 0;
+
+        results = ((CUBenchResult*)func_ctx->user_fctx) + func_ctx->call_cntr;
+        values[i++] = CStringGetTextDatum(results->name);
+        values[i++] = Int64GetDatum(results->rawBytes);
+        values[i++] = Int64GetDatum(results->cmprBytes);
+        values[i++] = BoolGetDatum(results->bitpacked);
+        values[i++] = Float8GetDatum((double)results->rawBytes / results->cmprBytes);
+        values[i++] = Float8GetDatum(results->compressMBps);
+        /* nothing to decompress if the codec gives up */
+        if (results->cmprBytes == results->rawBytes) {
+            nulls[i] = true;
+        }
+        values[i++] = Float8GetDatum(results->decompressMBps);
+
+        tuple = heap_form_tuple(func_ctx->tuple_desc, values, nulls);
+        SRF_RETURN_NEXT(func_ctx, HeapTupleGetDatum(tuple));
+    } else {
+        SRF_RETURN_DONE(func_ctx);
+    }
+}
+
 #ifdef ENABLE_UT
 #undef static
 #endif
@@ -55,6 +55,7 @@
 #include "vecexecutor/vecnodes.h"
 #include "vecexecutor/vecnoderowtovector.h"
 #include "access/cstore_roughcheck_func.h"
+#include "access/cstore_bloom.h"
 #include "utils/snapmgr.h"
 #include "catalog/storage.h"
 #include "miscadmin.h"
@@ -113,6 +114,8 @@ CStore::CStore()
       m_load_finish(false),
       m_scanPosInCU(NULL),
       m_RCFuncs(NULL),
+      m_RCBloomTypes(NULL),
+      m_RCBloomCols(NULL),
       m_fillVectorByTids(NULL),
       m_fillVectorLateRead(NULL),
       m_colFillFunArrary(NULL),
@@ -308,9 +311,22 @@ void CStore::InitRoughCheckEnv(CStoreScanState* state)
         Form_pg_attribute* attrs = rel->rd_att->attrs;
 
         m_RCFuncs = (RoughCheckFunc*)palloc(sizeof(RoughCheckFunc) * nkeys);
+        m_RCBloomTypes = (Oid*)palloc(sizeof(Oid) * nkeys);
         for (int i = 0; i < nkeys; i++) {
             int colIdx = m_colId[scanKey[i].cs_attno];
             m_RCFuncs[i] = GetRoughCheckFunc(attrs[colIdx]->atttypid, scanKey[i].cs_strategy, scanKey[i].cs_collation);
+
+            // only '=' and IN keys can be checked by bloom filter. don't care the
+            // "bloom_filter" option here, which may be turned off after some filters
+            // have been built, and CUs without bloom filter are just skipped.
+            m_RCBloomTypes[i] = InvalidOid;
+            if (scanKey[i].cs_strategy == CStoreEqualStrategyNumber && CUBloomSupportType(attrs[colIdx]->atttypid)) {
+                m_RCBloomTypes[i] = attrs[colIdx]->atttypid;
+                if (m_RCBloomCols == NULL) {
+                    m_RCBloomCols = (bool*)palloc0(sizeof(bool) * rel->rd_att->natts);
+                }
+                m_RCBloomCols[colIdx] = true;
+            }
         }
     }
 }
@@ -391,6 +407,8 @@ CStore::~CStore()
     m_CUDescInfo = NULL;
     m_perScanMemCnxt = NULL;
     m_RCFuncs = NULL;
+    m_RCBloomTypes = NULL;
+    m_RCBloomCols = NULL;
     m_CUDescIdx = NULL;
     m_colFillFunArrary = NULL;
     m_cuStorage = NULL;
@@ -1166,14 +1184,52 @@ bool CStore::RoughCheck(CStoreScanKey scanKey, int nkeys, int cuDescIdx)
             continue;
         if (isNullKey)
             hitCU = cudesc->CUHasNull() || cudesc->IsNullCU();
+        else if (scanKey[j].cs_elems != NULL)
+            hitCU = RoughCheckInList(scanKey + j, j, cudesc);
         else
-            hitCU = m_RCFuncs[j](cudesc, scanKey[j].cs_argument);
+            hitCU = RoughCheckValue(j, cudesc, scanKey[j].cs_argument);
         if (!hitCU)
             break;
     }
     return hitCU;
 }
 
+/*
+ * @Description: rough check one value against min/max and bloom filter of CU
+ * @Param[IN] cudesc: CU descriptor
+ * @Param[IN] keyIdx: index of scan key
+ * @Param[IN] arg: value to check
+ * @Return: true--hit, false--not hit
+ */
+FORCE_INLINE bool CStore::RoughCheckValue(int keyIdx, CUDesc* cudesc, Datum arg)
+{
+    if (!m_RCFuncs[keyIdx](cudesc, arg))
+        return false;
+
+    // the bloom filter may be loaded for another key of the same column
+    uint32 hash = 0;
+    if (cudesc->cu_bloom != NULL && OidIsValid(m_RCBloomTypes[keyIdx]) &&
+        CUBloomHashScanKey(m_RCBloomTypes[keyIdx], arg, &hash))
+        return CUBloomMayContain(cudesc->cu_bloom, hash);
+    return true;
+}
+
+/*
+ * @Description: rough check for IN list, the CU is hit if any value is hit.
+ * @Param[IN] scanKey: scan key with IN list
+ * @Param[IN] keyIdx: index of scan key
+ * @Param[IN] cudesc: CU descriptor
+ * @Return: true--hit, false--not hit
+ */
+bool CStore::RoughCheckInList(CStoreScanKey scanKey, int keyIdx, CUDesc* cudesc)
+{
+    for (int i = 0; i < scanKey->cs_nelems; i++) {
+        if (RoughCheckValue(keyIdx, cudesc, scanKey->cs_elems[i]))
+            return true;
+    }
+    return false;
+}
+
 void CStore::RoughCheckIfNeed(_in_ CStoreScanState* state)
 {
     int nkeys = state->csss_NumScanKeys;
@@ -1589,8 +1645,13 @@ HeapTuple CStore::FormCudescTuple(_in_ CUDesc* pCudesc, _in_ TupleDesc pCudescTu
     pTupVals[CUDescCUMagicAttr - 1] = UInt32GetDatum(pCudesc->magic);
     Assert(pTupVals[CUDescCUMagicAttr - 1] > 0);
 
-    // add attribute extra and set null flag.
-    pTupNulls[CUDescCUExtraAttr - 1] = true;
+    // attribute extra holds the bloom filter if there is.
+    if (pCudesc->cu_bloom != NULL) {
+        pTupVals[CUDescCUExtraAttr - 1] =
+            PointerGetDatum(cstring_to_text_with_len(pCudesc->cu_bloom, CUBloomSize(pCudesc->cu_bloom)));
+    } else {
+        pTupNulls[CUDescCUExtraAttr - 1] = true;
+    }
 
     return heap_form_tuple(pCudescTupDesc, pTupVals, pTupNulls);
 }
@@ -2254,6 +2315,12 @@ bool CStore::LoadCUDesc(
             securec_check(rc, "", "");
         }
 
+        /* Put bloom filter into cudesc->cu_bloom only if some scan key will use it */
+        cuDescArray[loadCUDescInfoPtr->curLoadNum].cu_bloom = NULL;
+        if (m_RCBloomCols != NULL && m_RCBloomCols[col] && !isnull[CUDescCUExtraAttr - 1]) {
+            cuDescArray[loadCUDescInfoPtr->curLoadNum].cu_bloom = CUBloomLoad(values[CUDescCUExtraAttr - 1]);
+        }
+
         cuDescArray[loadCUDescInfoPtr->curLoadNum].row_count = DatumGetInt32(values[CUDescRowCountAttr - 1]);
         Assert(!isnull[CUDescRowCountAttr - 1]);
 
@@ -3571,24 +3638,27 @@ RETRY_LOAD_CU:
         return cuPtr;
     }
 
-    // stat CU hdd sync read
-    pgstatCountCUHDDSyncRead4SessionLevel();
-    pgstat_count_cu_hdd_sync(m_relation);
+    // The compressed tier of CU cache may still keep the CU data, which saves the IO.
+    if (!CUCache->LoadCUFromCompressedCache(&dataSlotTag, cuPtr, cuDescPtr->cu_size)) {
+        // stat CU hdd sync read
+        pgstatCountCUHDDSyncRead4SessionLevel();
+        pgstat_count_cu_hdd_sync(m_relation);
 
-    m_cuStorage[colIdx]->LoadCU(
-        cuPtr, cuDescPtr->cu_pointer, cuDescPtr->cu_size, g_instance.attr.attr_storage.enable_adio_function, true);
+        m_cuStorage[colIdx]->LoadCU(
+            cuPtr, cuDescPtr->cu_pointer, cuDescPtr->cu_size, g_instance.attr.attr_storage.enable_adio_function, true);
 
-    ADIO_RUN()
-    {
-        ereport(DEBUG1,
-            (errmodule(MOD_ADIO),
-                errmsg("GetCUData:relation(%s), colIdx(%d), load cuid(%u), slotId(%d)",
-                    RelationGetRelationName(m_relation),
-                    colIdx,
-                    cuDescPtr->cu_id,
-                    slotId)));
+        ADIO_RUN()
+        {
+            ereport(DEBUG1,
+                (errmodule(MOD_ADIO),
+                    errmsg("GetCUData:relation(%s), colIdx(%d), load cuid(%u), slotId(%d)",
+                        RelationGetRelationName(m_relation),
+                        colIdx,
+                        cuDescPtr->cu_id,
+                        slotId)));
+        }
+        ADIO_END();
     }
-    ADIO_END();
 
     // Mark the CU as no longer io busy, and wake any waiters
     CUCache->DataBlockCompleteIO(slotId);
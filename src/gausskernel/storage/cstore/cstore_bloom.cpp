@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * cstore_bloom.cpp
+ *      per-CU bloom filters used by ColStore rough check
+ *
+ * IDENTIFICATION
+ *        src/gausskernel/storage/cstore/cstore_bloom.cpp
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+#include "postgres.h"
+#include "knl/knl_variable.h"
+
+#include <math.h>
+
+#include "access/cstore_bloom.h"
+#include "access/hash.h"
+#include "access/tuptoaster.h"
+#include "catalog/pg_type.h"
+#include "storage/cu.h"
+#include "utils/attoptcache.h"
+#include "utils/builtins.h"
+#include "utils/date.h"
+#include "utils/rel.h"
+#include "utils/rel_gs.h"
+
+#define CU_BLOOM_DATA(bloom) ((const uint8*)((bloom) + sizeof(CUBloomHeader)))
+#define CU_BLOOM_BYTES(log2bits) ((Size)1 << ((log2bits) - 3))
+
+/* the bitmap used to estimate distinct values is 2^N bits at most */
+#define CU_BLOOM_SKETCH_MAX_BITS_LOG2 20
+
+/*
+ * a filter with more than half of the bits set has a false positive
+ * rate higher than 12.5% (3 hashes), which is not worth reading per CU.
+ */
+#define CU_BLOOM_MAX_FILL_RATIO 0.5
+
+/*
+ * @Description: whether values of this type can be put into a CU bloom filter.
+ *    Only types whose equality is the same as binary equality (after the
+ *    normalization done by CUBloomHashValue) are supported, so that a negative
+ *    answer of the filter never loses a matching row.
+ * @IN typeOid: data type
+ * @Return: true if supported
+ */
+bool CUBloomSupportType(Oid typeOid)
+{
+    switch (typeOid) {
+        case CHAROID:
+        case INT2OID:
+        case INT4OID:
+        case INT8OID:
+        case OIDOID:
+        case DATEOID:
+        case TIMEOID:
+        case TIMESTAMPOID:
+        case TIMESTAMPTZOID:
+        case BPCHAROID:
+        case VARCHAROID:
+        case TEXTOID:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*
+ * @Description: whether bloom filters should be built for this column.
+ *    It's controlled by the attribute option "bloom_filter".
+ * @IN rel: column relation, or a partition of it
+ * @IN attr: column attribute
+ * @Return: true if enabled
+ */
+bool CUBloomEnabled(Relation rel, Form_pg_attribute attr)
+{
+    if (attr->attisdropped || !CUBloomSupportType(attr->atttypid)) {
+        return false;
+    }
+
+    /* attribute options are kept by the parent relation of a partition */
+    Oid relid = OidIsValid(rel->parentId) ? rel->parentId : RelationGetRelid(rel);
+    AttributeOpts* aopts = get_attribute_options(relid, attr->attnum);
+    bool enabled = false;
+
+    if (aopts != NULL) {
+        enabled = aopts->bloom_filter;
+        pfree(aopts);
+    }
+    return enabled;
+}
+
+static FORCE_INLINE uint32 CUBloomHashInt(int64 key)
+{
+    return DatumGetUInt32(hash_any((const unsigned char*)&key, sizeof(int64)));
+}
+
+static FORCE_INLINE uint32 CUBloomHashString(Oid typeOid, const char* str, int len)
+{
+    /* bpchar comparison ignores trailing spaces */
+    if (typeOid == BPCHAROID) {
+        len = bpchartruelen(str, len);
+    }
+    return DatumGetUInt32(hash_any((const unsigned char*)str, len));
+}
+
+/*
+ * @Description: hash one column value to be put into the bloom filter.
+ *    Integer-like values are widened to int64 before hashing, because the
+ *    scan keys of cstore scan are widened in the same way.
+ * @IN typeOid: data type, which must be supported by CUBloomSupportType()
+ * @IN value: not-null value
+ * @Return: hash value
+ */
+uint32 CUBloomHashValue(Oid typeOid, Datum value)
+{
+    switch (typeOid) {
+        case CHAROID:
+            return CUBloomHashInt((int64)DatumGetChar(value));
+        case INT2OID:
+            return CUBloomHashInt((int64)DatumGetInt16(value));
+        case INT4OID:
+            return CUBloomHashInt((int64)DatumGetInt32(value));
+        case OIDOID:
+            return CUBloomHashInt((int64)DatumGetObjectId(value));
+        case DATEOID:
+            return CUBloomHashInt((int64)DatumGetDateADT(value));
+        case INT8OID:
+        case TIMEOID:
+        case TIMESTAMPOID:
+        case TIMESTAMPTZOID:
+            return CUBloomHashInt(DatumGetInt64(value));
+        default: {
+            Assert(typeOid == BPCHAROID || typeOid == VARCHAROID || typeOid == TEXTOID);
+            char* p = DatumGetPointer(value);
+            return CUBloomHashString(typeOid, VARDATA_ANY(p), VARSIZE_ANY_EXHDR(p));
+        }
+    }
+}
+
+/*
+ * @Description: hash the argument of one cstore scan key.
+ *    See also convert_scan_key_int64_if_need(), which has widened the
+ *    argument of INT2/INT4/INT8 columns to int64.
+ * @IN typeOid: data type of the column
+ * @IN arg: not-null argument of scan key
+ * @OUT hash: hash value
+ * @Return: false if the argument cannot be hashed, and then the filter
+ *    must not be consulted.
+ */
+bool CUBloomHashScanKey(Oid typeOid, Datum arg, uint32* hash)
+{
+    switch (typeOid) {
+        case INT2OID:
+        case INT4OID:
+        case INT8OID:
+            *hash = CUBloomHashInt(DatumGetInt64(arg));
+            return true;
+        case BPCHAROID:
+        case VARCHAROID:
+        case TEXTOID: {
+            /* the same to RoughCheckStringCU(), don't detoast here */
+            struct varlena* p = (struct varlena*)DatumGetPointer(arg);
+            if (VARATT_IS_COMPRESSED(p) || VARATT_IS_EXTERNAL(p)) {
+                return false;
+            }
+            *hash = CUBloomHashString(typeOid, VARDATA_ANY(p), VARSIZE_ANY_EXHDR(p));
+            return true;
+        }
+        default:
+            *hash = CUBloomHashValue(typeOid, arg);
+            return true;
+    }
+}
+
+/* double hashing: the i-th probe of hash *h* */
+static FORCE_INLINE uint32 CUBloomProbe(uint32 h, int i, uint32 mask)
+{
+    uint32 h2 = ((h >> 16) | (h << 16)) | 1;
+    return (h + (uint32)i * h2) & mask;
+}
+
+/*
+ * @Description: estimate the number of distinct hash values by linear
+ *    counting over a bitmap which is big enough for all the values.
+ * @IN hashes: hash values
+ * @IN nhashes: number of hash values
+ * @Return: distinct-value estimate, at least 1
+ */
+static uint32 CUBloomEstimateDistinct(const uint32* hashes, int nhashes)
+{
+    int log2bits = CU_BLOOM_MIN_BITS_LOG2;
+    while (log2bits < CU_BLOOM_SKETCH_MAX_BITS_LOG2 && ((int64)1 << log2bits) < (int64)nhashes * 2) {
+        ++log2bits;
+    }
+
+    uint32 nbits = (uint32)1 << log2bits;
+    uint32 mask = nbits - 1;
+    uint8* sketch = (uint8*)palloc0(CU_BLOOM_BYTES(log2bits));
+    for (int i = 0; i < nhashes; ++i) {
+        uint32 pos = hashes[i] & mask;
+        sketch[pos >> 3] |= (uint8)(1 << (pos & 7));
+    }
+
+    uint32 nset = 0;
+    for (Size i = 0; i < CU_BLOOM_BYTES(log2bits); ++i) {
+        nset += NumberOfBit1Set[sketch[i]];
+    }
+    pfree(sketch);
+
+    if (nset >= nbits) {
+        return (uint32)nhashes;
+    }
+    double estimate = -(double)nbits * log((double)(nbits - nset) / nbits);
+    return (uint32)Max(1.0, Min(estimate + 0.5, (double)nhashes));
+}
+
+/*
+ * @Description: build the bloom filter of one CU.
+ *    The distinct values are estimated first, then the filter is sized
+ *    to CU_BLOOM_BITS_PER_VALUE bits per distinct value.
+ * @IN hashes: hash values of all the not-null values in the CU
+ * @IN nhashes: number of hash values
+ * @Return: serialized filter allocated in the current memory context,
+ *    or NULL if the filter would be too dense to prune anything.
+ */
+char* CUBloomBuild(const uint32* hashes, int nhashes)
+{
+    if (nhashes <= 0) {
+        return NULL;
+    }
+
+    uint32 ndistinct = CUBloomEstimateDistinct(hashes, nhashes);
+    int log2bits = CU_BLOOM_MIN_BITS_LOG2;
+    while (log2bits < CU_BLOOM_MAX_BITS_LOG2 && ((uint64)1 << log2bits) < (uint64)ndistinct * CU_BLOOM_BITS_PER_VALUE) {
+        ++log2bits;
+    }
+
+    Size nbytes = CU_BLOOM_BYTES(log2bits);
+    char* bloom = (char*)palloc0(sizeof(CUBloomHeader) + nbytes);
+    CUBloomHeader* header = (CUBloomHeader*)bloom;
+    header->version = CU_BLOOM_VERSION;
+    header->nhashes = CU_BLOOM_NUM_HASHES;
+    header->log2bits = (uint8)log2bits;
+    header->ndistinct = ndistinct;
+
+    uint8* bits = (uint8*)(bloom + sizeof(CUBloomHeader));
+    uint32 mask = ((uint32)1 << log2bits) - 1;
+    for (int i = 0; i < nhashes; ++i) {
+        for (int k = 0; k < CU_BLOOM_NUM_HASHES; ++k) {
+            uint32 pos = CUBloomProbe(hashes[i], k, mask);
+            bits[pos >> 3] |= (uint8)(1 << (pos & 7));
+        }
+    }
+
+    uint32 nset = 0;
+    for (Size i = 0; i < nbytes; ++i) {
+        nset += NumberOfBit1Set[bits[i]];
+    }
+    if (nset > (uint32)(CU_BLOOM_MAX_FILL_RATIO * (mask + 1))) {
+        pfree(bloom);
+        return NULL;
+    }
+    return bloom;
+}
+
+/* check the header of a serialized filter with *len* bytes */
+static bool CUBloomIsValid(const char* bloom, Size len)
+{
+    CUBloomHeader header;
+
+    if (len < sizeof(CUBloomHeader)) {
+        return false;
+    }
+    errno_t rc = memcpy_s(&header, sizeof(CUBloomHeader), bloom, sizeof(CUBloomHeader));
+    securec_check(rc, "\0", "\0");
+
+    return header.version == CU_BLOOM_VERSION && header.nhashes > 0 && header.log2bits >= CU_BLOOM_MIN_BITS_LOG2 &&
+           header.log2bits <= CU_BLOOM_MAX_BITS_LOG2 && len == sizeof(CUBloomHeader) + CU_BLOOM_BYTES(header.log2bits);
+}
+
+/*
+ * @Description: size of a serialized filter
+ * @IN bloom: serialized filter
+ * @Return: size in bytes, including the header
+ */
+Size CUBloomSize(const char* bloom)
+{
+    return sizeof(CUBloomHeader) + CU_BLOOM_BYTES(((const CUBloomHeader*)bloom)->log2bits);
+}
+
+/*
+ * @Description: load the filter from the "extra" field of a CUDesc tuple.
+ * @IN extra: value of the "extra" field, which may be toasted
+ * @Return: a private copy of the filter in the current memory context,
+ *    or NULL if the field doesn't hold a filter this version knows.
+ */
+char* CUBloomLoad(Datum extra)
+{
+    struct varlena* raw = (struct varlena*)DatumGetPointer(extra);
+    struct varlena* value = pg_detoast_datum_packed(raw);
+    Size len = VARSIZE_ANY_EXHDR(value);
+    char* bloom = NULL;
+
+    if (CUBloomIsValid(VARDATA_ANY(value), len)) {
+        bloom = (char*)palloc(len);
+        errno_t rc = memcpy_s(bloom, len, VARDATA_ANY(value), len);
+        securec_check(rc, "\0", "\0");
+    }
+
+    if (value != raw) {
+        pfree(value);
+    }
+    return bloom;
+}
+
+/*
+ * @Description: test a hash value against the filter
+ * @IN bloom: serialized filter
+ * @IN hash: hash value from CUBloomHashScanKey()
+ * @Return: false if the value is surely not in the CU
+ */
+bool CUBloomMayContain(const char* bloom, uint32 hash)
+{
+    const CUBloomHeader* header = (const CUBloomHeader*)bloom;
+    const uint8* bits = CU_BLOOM_DATA(bloom);
+    uint32 mask = ((uint32)1 << header->log2bits) - 1;
+
+    for (int k = 0; k < header->nhashes; ++k) {
+        uint32 pos = CUBloomProbe(hash, k, mask);
+        if ((bits[pos >> 3] & (1 << (pos & 7))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
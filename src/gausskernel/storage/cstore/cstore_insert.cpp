@@ -26,6 +26,7 @@
 #include "knl/knl_variable.h"
 #include "access/xact.h"
 #include "access/genam.h"
+#include "access/parallel.h"
 #include "access/cstore_rewrite.h"
 #include "access/reloptions.h"
 #include "catalog/catalog.h"
@@ -44,6 +45,7 @@
 #include "storage/lmgr.h"
 #include "storage/cucache_mgr.h"
 #include "access/cstore_insert.h"
+#include "access/cstore_bloom.h"
 #include "pgxc/pgxc.h"
 #include "utils/tqual.h"
 #include "utils/memutils.h"
@@ -53,6 +55,7 @@
 #include "catalog/pg_partition_fn.h"
 #include "libpq/pqformat.h"
 #include "workload/workload.h"
+#include "workload/ctxctl.h"
 #include "commands/tablespace.h"
 #include "optimizer/var.h"
 #include "catalog/index.h"
@@ -193,6 +196,15 @@ CStoreInsert::CStoreInsert(_in_ Relation relation, _in_ const InsertArg& args, _
 
     m_cuStorage = (CUStorage**)palloc(sizeof(CUStorage*) * attNo);
     m_cuCmprsOptions = (compression_options*)palloc(sizeof(compression_options) * attNo);
+    m_cuTempInfos = (cu_tmp_compress_info*)palloc0(sizeof(cu_tmp_compress_info) * attNo);
+    m_deferCompress = false;
+
+    INSTR_TIME_SET_ZERO(m_formTime);
+    INSTR_TIME_SET_ZERO(m_compressTime);
+    INSTR_TIME_SET_ZERO(m_writeTime);
+    INSTR_TIME_SET_ZERO(m_indexTime);
+    m_loadBatches = 0;
+    m_parallelBatches = 0;
 
     for (int i = 0; i < attNo; ++i) {
         if (m_relation->rd_att->attrs[i]->attisdropped) {
@@ -228,6 +240,7 @@ CStoreInsert::~CStoreInsert()
     m_fake_values = NULL;
     m_delta_relation = NULL;
     m_cuCmprsOptions = NULL;
+    m_cuTempInfos = NULL;
     m_estate = NULL;
     m_cuDescPPtr = NULL;
     m_delta_desc = NULL;
@@ -247,6 +260,7 @@ CStoreInsert::~CStoreInsert()
     m_idxKeyNum = NULL;
     m_aio_cache_write_threshold = NULL;
     m_formCUFuncArray = NULL;
+    m_cuBloomCols = NULL;
     m_econtext = NULL;
     m_aio_cu_PPtr = NULL;
     m_cstorInsertMem = NULL;
@@ -324,7 +338,12 @@ inline void CStoreInsert::SetFormCUFuncArray(Form_pg_attribute attr, int col)
 void CStoreInsert::Destroy()
 {
     /* Step 1: End of batch insert */
+    instr_time startTime, endTime;
+    INSTR_TIME_SET_CURRENT(startTime);
     EndBatchInsert();
+    INSTR_TIME_SET_CURRENT(endTime);
+    INSTR_TIME_ACCUM_DIFF(m_writeTime, endTime, startTime);
+    ReportLoadTiming();
 
     /* Step 2: Destroy all the new objects. */
     if (m_sorter) {
@@ -403,6 +422,7 @@ void CStoreInsert::Destroy()
 
     /* Step 4: Reset all the pointers */
     m_formCUFuncArray = NULL;
+    m_cuBloomCols = NULL;
     m_setMinMaxFuncs = NULL;
     m_cuStorage = NULL;
     m_cuDescPPtr = NULL;
@@ -411,6 +431,7 @@ void CStoreInsert::Destroy()
     m_idxKeyNum = NULL;
     m_idxRelation = NULL;
     m_cuCmprsOptions = NULL;
+    m_cuTempInfos = NULL;
     m_fake_values = NULL;
     m_fake_isnull = NULL;
 
@@ -488,6 +509,7 @@ void CStoreInsert::InitFuncPtr()
 
     m_setMinMaxFuncs = (FuncSetMinMax*)palloc(attNo * sizeof(FuncSetMinMax));
     m_formCUFuncArray = (FormCUFuncArray*)palloc(sizeof(FormCUFuncArray) * attNo);
+    m_cuBloomCols = (bool*)palloc(attNo * sizeof(bool));
     m_cuDescPPtr = (CUDesc**)palloc(attNo * sizeof(CUDesc*));
 
     /*
@@ -498,9 +520,11 @@ void CStoreInsert::InitFuncPtr()
         if (!attrs[col]->attisdropped) {
             m_setMinMaxFuncs[col] = GetMinMaxFunc(attrs[col]->atttypid);
             SetFormCUFuncArray(attrs[col], col);
+            m_cuBloomCols[col] = CUBloomEnabled(m_relation, attrs[col]);
             m_cuDescPPtr[col] = New(CurrentMemoryContext) CUDesc;
         } else {
             m_setMinMaxFuncs[col] = NULL;
+            m_cuBloomCols[col] = false;
             m_cuDescPPtr[col] = NULL;
             m_formCUFuncArray[col].colFormCU[FORMCU_IDX_NONE_NULL] = NULL;
             m_formCUFuncArray[col].colFormCU[FORMCU_IDX_HAVE_NULL] = NULL;
@@ -817,16 +841,26 @@ void CStoreInsert::BatchInsertCommon(bulkload_rows* batchRowPtr, int options)
 
     int attno = m_relation->rd_rel->relnatts;
     int col = 0;
+    instr_time startTime, endTime;
     Assert(attno == batchRowPtr->m_attr_num);
 
     CHECK_FOR_INTERRUPTS();
     /* step 1: form CU and CUDesc; */
+    m_deferCompress = NeedParallelCompress(batchRowPtr);
     for (col = 0; col < attno; ++col) {
         if (!m_relation->rd_att->attrs[col]->attisdropped) {
             m_cuPPtr[col] = FormCU(col, batchRowPtr, m_cuDescPPtr[col]);
-            m_cuCmprsOptions[col].m_sampling_fihished = true;
+            if (!m_deferCompress)
+                m_cuCmprsOptions[col].m_sampling_fihished = true;
         }
     }
+    if (m_deferCompress) {
+        CompressCUsInParallel(batchRowPtr);
+        m_deferCompress = false;
+        /* compression filters are sampled during compressing the first CUs */
+        for (col = 0; col < attno; ++col)
+            m_cuCmprsOptions[col].m_sampling_fihished = true;
+    }
     if (m_isUpdate)
         pgstat_count_cu_update(m_relation, batchRowPtr->m_rows_curnum);
     else
@@ -836,7 +870,10 @@ void CStoreInsert::BatchInsertCommon(bulkload_rows* batchRowPtr, int options)
      * step 2: a) Allocate CUID and CUPointer
      *		   b) Write CU and CUDesc
      */
+    INSTR_TIME_SET_CURRENT(startTime);
     SaveAll(options);
+    INSTR_TIME_SET_CURRENT(endTime);
+    INSTR_TIME_ACCUM_DIFF(m_writeTime, endTime, startTime);
 
     /* step 3: batch insert index table */
     if (m_relation->rd_att->attrs[0]->attisdropped) {
@@ -844,6 +881,10 @@ void CStoreInsert::BatchInsertCommon(bulkload_rows* batchRowPtr, int options)
         InsertIdxTableIfNeed(batchRowPtr, m_cuDescPPtr[fstColIdx]->cu_id);
     } else
         InsertIdxTableIfNeed(batchRowPtr, m_cuDescPPtr[0]->cu_id);
+    INSTR_TIME_SET_CURRENT(startTime);
+    INSTR_TIME_ACCUM_DIFF(m_indexTime, startTime, endTime);
+
+    m_loadBatches++;
 }
 
 void CStoreInsert::InsertDeltaTable(bulkload_rows* batchRowPtr, int options)
@@ -1346,6 +1387,7 @@ void CStoreInsert::SaveAll(int options, _in_ const char* delBitmap)
 
         /* step 3: Save CUDesc */
         CStore::SaveCUDesc(m_relation, cuDesc, col, options);
+        pfree_ext(cuDesc->cu_bloom);
     }
 
     /* storage space processing before copying column data. */
@@ -1431,7 +1473,9 @@ CU* CStoreInsert::FormCU(int col, bulkload_rows* batchRowPtr, CUDesc* cuDescPtr)
     Form_pg_attribute* attrs = m_relation->rd_att->attrs;
     int attlen = attrs[col]->attlen;
     CU* cuPtr = NULL;
+    instr_time startTime, endTime;
 
+    INSTR_TIME_SET_CURRENT(startTime);
     ADIO_RUN()
     {
         /* cuPtr need keep untill async write finish */
@@ -1448,33 +1492,297 @@ CU* CStoreInsert::FormCU(int col, bulkload_rows* batchRowPtr, CUDesc* cuDescPtr)
     int funIdx = batchRowPtr->m_vectors[col].m_values_nulls.m_has_null ? FORMCU_IDX_HAVE_NULL : FORMCU_IDX_NONE_NULL;
     (this->*(m_formCUFuncArray[col].colFormCU[funIdx]))(col, batchRowPtr, cuDescPtr, cuPtr);
 
+    // min/max is enough for the CU with the same value, so needn't bloom filter.
+    if (m_cuBloomCols[col] && !cuDescPtr->IsNullCU() && !cuDescPtr->IsSameValCU()) {
+        cuDescPtr->cu_bloom = FormCUBloom(col, batchRowPtr);
+    }
+
     // We should not compress in two case.
     // case1) IsNullCU
     // case2) Min is the same to max in CU. In this case, we don't
     // 		  need CUStorage
     cuDescPtr->magic = GetCurrentTransactionIdIfAny();
+    cuDescPtr->row_count = batchRowPtr->m_rows_curnum;
+    INSTR_TIME_SET_CURRENT(endTime);
+    INSTR_TIME_ACCUM_DIFF(m_formTime, endTime, startTime);
+
     if (!(cuDescPtr->IsNullCU()) && !(cuDescPtr->IsSameValCU())) {
+        // each deferred CU keeps its own temp info until it's compressed.
+        cu_tmp_compress_info* tmpinfo = m_deferCompress ? (m_cuTempInfos + col) : &m_cuTempInfo;
+
         // a little tricky to reduce the recomputation of min/max value.
         // some data type is equal to int8/int16/int32/int32. for them it
         // is not necessary to recompute the min/max value.
-        m_cuTempInfo.m_valid_minmax = !NeedToRecomputeMinMax(attrs[col]->atttypid);
-        if (m_cuTempInfo.m_valid_minmax) {
-            m_cuTempInfo.m_min_value = ConvertToInt64Data(cuDescPtr->cu_min, attlen);
-            m_cuTempInfo.m_max_value = ConvertToInt64Data(cuDescPtr->cu_max, attlen);
+        tmpinfo->m_valid_minmax = !NeedToRecomputeMinMax(attrs[col]->atttypid);
+        if (tmpinfo->m_valid_minmax) {
+            tmpinfo->m_min_value = ConvertToInt64Data(cuDescPtr->cu_min, attlen);
+            tmpinfo->m_max_value = ConvertToInt64Data(cuDescPtr->cu_max, attlen);
         }
-        m_cuTempInfo.m_options = (m_cuCmprsOptions + col);
-        cuPtr->m_tmpinfo = &m_cuTempInfo;
+        tmpinfo->m_options = (m_cuCmprsOptions + col);
+        cuPtr->m_tmpinfo = tmpinfo;
 
         // Magic number is for checking CU data
         cuPtr->SetMagic(cuDescPtr->magic);
-        cuPtr->Compress(batchRowPtr->m_rows_curnum, m_compress_modes);
-        cuDescPtr->cu_size = cuPtr->GetCUSize();
+        if (m_deferCompress) {
+            // compressed later by CompressCUsInParallel(), but the buffer
+            // must be allocated by this thread.
+            cuPtr->AllocCompressBuf();
+        } else {
+            cuPtr->Compress(batchRowPtr->m_rows_curnum, m_compress_modes);
+            cuDescPtr->cu_size = cuPtr->GetCUSize();
+            INSTR_TIME_SET_CURRENT(startTime);
+            INSTR_TIME_ACCUM_DIFF(m_compressTime, startTime, endTime);
+        }
     }
-    cuDescPtr->row_count = batchRowPtr->m_rows_curnum;
 
     return cuPtr;
 }
 
+/*
+ * Shared state of parallel CU compression. All the CUs of one batch are formed
+ * by the leader, then the leader and the workers take them one by one and compress
+ * them. CUs are written in column order by the leader after all of them are done,
+ * so the memory in use is still bounded by one batch.
+ */
+typedef struct CUCompressTask {
+    CU* cu;
+    int rowCount;
+} CUCompressTask;
+
+struct CUCompressShared {
+    /* immutable state */
+    CUCompressTask* tasks;
+    int ntasks;
+    int16 compressModes;
+    bool enableTsdb;
+
+    /* mutex protects the following task counters */
+    slock_t mutex;
+    int nextTask;
+    int ntasksDone;
+
+    /* donecv is signaled whenever a participant runs out of tasks */
+    pthread_cond_t donecv;
+    pthread_mutex_t mtx; /* mtx protects donecv */
+};
+
+#define CU_COMPRESS_WAIT_TIME 1 /* seconds, timeout for waiting all the CUs compressed */
+
+/*
+ * @Description: take CUs from the shared task list and compress them until the list
+ *    is empty. It's run by both the leader and the parallel workers.
+ * @IN shared: shared state of parallel CU compression
+ */
+static void CUCompressRunTasks(CUCompressShared* shared)
+{
+    int ndone = 0;
+    MemoryContext taskCnxt = AllocSetContextCreate(CurrentMemoryContext,
+        "CU COMPRESS TASK CNXT",
+        ALLOCSET_DEFAULT_MINSIZE,
+        ALLOCSET_DEFAULT_INITSIZE,
+        ALLOCSET_DEFAULT_MAXSIZE);
+
+    for (;;) {
+        SpinLockAcquire(&shared->mutex);
+        int taskIdx = shared->nextTask;
+        if (taskIdx < shared->ntasks) {
+            shared->nextTask++;
+        }
+        SpinLockRelease(&shared->mutex);
+        if (taskIdx >= shared->ntasks) {
+            break;
+        }
+
+        CUCompressTask* task = shared->tasks + taskIdx;
+        MemoryContext oldCnxt = MemoryContextSwitchTo(taskCnxt);
+        task->cu->CompressIntoBuf(task->rowCount, shared->compressModes);
+        (void)MemoryContextSwitchTo(oldCnxt);
+        MemoryContextReset(taskCnxt);
+        ++ndone;
+    }
+    MemoryContextDelete(taskCnxt);
+
+    SpinLockAcquire(&shared->mutex);
+    shared->ntasksDone += ndone;
+    SpinLockRelease(&shared->mutex);
+
+    /* Notify leader */
+    WLMContextLock cuLock(&shared->mtx);
+    cuLock.Lock();
+    cuLock.ConditionWakeUp(&shared->donecv);
+    cuLock.UnLock();
+}
+
+/*
+ * @Description: whether the CUs of this batch are worth compressing in parallel.
+ * @IN batchRowPtr: batch rows
+ * @Return: true if the compression of this batch should be deferred to CompressCUsInParallel()
+ */
+bool CStoreInsert::NeedParallelCompress(bulkload_rows* batchRowPtr) const
+{
+    /*
+     * Launching workers costs much more than compressing a small CU, so only full
+     * CUs are compressed in parallel. Parallel mode must not be nested, and the
+     * encryption of CU data isn't done by parallel workers.
+     */
+    if (u_sess->attr.attr_storage.cstore_compress_workers <= 0 || batchRowPtr->m_rows_curnum < m_fullCUSize ||
+        m_relation->rd_rel->relnatts < 2 || IsInParallelMode() || IsParallelWorker() || !ActiveSnapshotSet() ||
+        isEncryptedCluster())
+        return false;
+
+    return true;
+}
+
+/*
+ * @Description: compress the CUs formed by FormCU() with m_deferCompress on, with the help
+ *    of at most cstore_compress_workers parallel workers. The leader compresses CUs too, so
+ *    it works even if no worker can be launched.
+ * @IN batchRowPtr: batch rows
+ */
+void CStoreInsert::CompressCUsInParallel(bulkload_rows* batchRowPtr)
+{
+    int attno = m_relation->rd_rel->relnatts;
+    int* taskCols = (int*)palloc(sizeof(int) * attno);
+    CUCompressTask* tasks = (CUCompressTask*)palloc(sizeof(CUCompressTask) * attno);
+    int ntasks = 0;
+    instr_time startTime, endTime;
+
+    INSTR_TIME_SET_CURRENT(startTime);
+    for (int col = 0; col < attno; ++col) {
+        if (m_relation->rd_att->attrs[col]->attisdropped || m_cuDescPPtr[col]->IsNullCU() ||
+            m_cuDescPPtr[col]->IsSameValCU())
+            continue;
+
+        taskCols[ntasks] = col;
+        tasks[ntasks].cu = m_cuPPtr[col];
+        tasks[ntasks].rowCount = batchRowPtr->m_rows_curnum;
+        ++ntasks;
+    }
+
+    /* the leader takes one CU itself */
+    int nworkers = Min(u_sess->attr.attr_storage.cstore_compress_workers, ntasks - 1);
+    ParallelContext* pcxt = NULL;
+    CUCompressShared* shared = NULL;
+
+    if (nworkers > 0) {
+        EnterParallelMode();
+        pcxt = CreateParallelContext("postgres", "CStoreCompressWorkerMain", nworkers);
+        InitializeParallelDSM(pcxt, SnapshotAny);
+
+        /* If no worker was available, compress all the CUs by ourselves */
+        if (pcxt->nworkers == 0) {
+            DestroyParallelContext(pcxt);
+            ExitParallelMode();
+            pcxt = NULL;
+        } else {
+            knl_u_parallel_context* cxt = (knl_u_parallel_context*)pcxt->seg;
+            MemoryContext oldCnxt = MemoryContextSwitchTo(cxt->memCtx);
+            shared = (CUCompressShared*)palloc0(sizeof(CUCompressShared));
+            (void)MemoryContextSwitchTo(oldCnxt);
+            cxt->pwCtx->cuCompressInfo.shared = shared;
+        }
+    }
+    if (shared == NULL) {
+        shared = (CUCompressShared*)palloc0(sizeof(CUCompressShared));
+    }
+
+    shared->tasks = tasks;
+    shared->ntasks = ntasks;
+    shared->compressModes = m_compress_modes;
+    shared->enableTsdb = u_sess->attr.attr_common.enable_tsdb;
+    SpinLockInit(&shared->mutex);
+    shared->nextTask = 0;
+    shared->ntasksDone = 0;
+    (void)pthread_cond_init(&shared->donecv, NULL);
+    (void)pthread_mutex_init(&shared->mtx, NULL);
+
+    if (pcxt != NULL) {
+        LaunchParallelWorkers(pcxt);
+    }
+
+    /* Join the compression ourselves */
+    CUCompressRunTasks(shared);
+
+    WLMContextLock cuLock(&shared->mtx);
+    for (;;) {
+        SpinLockAcquire(&shared->mutex);
+        bool allDone = (shared->ntasksDone == shared->ntasks);
+        SpinLockRelease(&shared->mutex);
+        if (allDone) {
+            break;
+        }
+
+        /*
+         * Use pthread_cond_timedwait here in case of worker exit in error cases, and call
+         * CHECK_FOR_INTERRUPTS to handle the error msg from worker.
+         */
+        cuLock.Lock();
+        cuLock.ConditionTimedWait(&shared->donecv, CU_COMPRESS_WAIT_TIME);
+        cuLock.UnLock();
+        CHECK_FOR_INTERRUPTS();
+    }
+
+    if (pcxt != NULL) {
+        if (pcxt->nworkers_launched > 0) {
+            m_parallelBatches++;
+        }
+        WaitForParallelWorkersToFinish(pcxt);
+        DestroyParallelContext(pcxt);
+        ExitParallelMode();
+    }
+
+    /* all workers are gone, nobody waits on or signals donecv any more */
+    (void)pthread_cond_destroy(&shared->donecv);
+    (void)pthread_mutex_destroy(&shared->mtx);
+
+    /* the source buffer is registered in the thread-local CStoreMemAlloc table of this thread */
+    for (int i = 0; i < ntasks; ++i) {
+        int col = taskCols[i];
+        m_cuPPtr[col]->FreeSrcBuf();
+        m_cuDescPPtr[col]->cu_size = m_cuPPtr[col]->GetCUSize();
+    }
+
+    INSTR_TIME_SET_CURRENT(endTime);
+    INSTR_TIME_ACCUM_DIFF(m_compressTime, endTime, startTime);
+    pfree(taskCols);
+    pfree(tasks);
+}
+
+/*
+ * Perform work within a launched parallel CU compression worker.
+ */
+void CStoreCompressWorkerMain(void* seg)
+{
+    knl_u_parallel_context* cxt = (knl_u_parallel_context*)seg;
+    CUCompressShared* shared = cxt->pwCtx->cuCompressInfo.shared;
+
+    /* keep the same compression methods as the leader, see CU::CompressData() */
+    u_sess->attr.attr_common.enable_tsdb = shared->enableTsdb;
+
+    CUCompressRunTasks(shared);
+}
+
+/*
+ * @Description: log the elapsed time of each stage of this load if log_cstore_load_timing
+ *    is on, to tell whether it's bound by forming CUs, compressing them or writing them.
+ */
+void CStoreInsert::ReportLoadTiming()
+{
+    if (!u_sess->attr.attr_storage.log_cstore_load_timing || m_loadBatches == 0)
+        return;
+
+    ereport(LOG,
+        (errmsg("cstore load of \"%s\": %d CU batches (%d compressed in parallel), "
+                "form %.3f ms, compress %.3f ms, write %.3f ms, index %.3f ms",
+            RelationGetRelationName(m_relation),
+            m_loadBatches,
+            m_parallelBatches,
+            INSTR_TIME_GET_MILLISEC(m_formTime),
+            INSTR_TIME_GET_MILLISEC(m_compressTime),
+            INSTR_TIME_GET_MILLISEC(m_writeTime),
+            INSTR_TIME_GET_MILLISEC(m_indexTime))));
+}
+
 /*
  * @Description: encode numeric values
  * @IN batchRowPtr: batch values about numeric
@@ -1758,6 +2066,36 @@ bool CStoreInsert::TryFormNumberStringCU(
     return ret;
 }
 
+/*
+ * @Description: build the bloom filter for one column of batchrows
+ * @IN batchRowPtr: batchrows
+ * @IN col: which column to handle
+ * @Return: serialized bloom filter, or NULL if it's useless
+ * @See also: cstore_bloom.h
+ */
+char* CStoreInsert::FormCUBloom(int col, bulkload_rows* batchRowPtr)
+{
+    Oid typeOid = m_relation->rd_att->attrs[col]->atttypid;
+    int rows = batchRowPtr->m_rows_curnum;
+    uint32* hashes = (uint32*)palloc(sizeof(uint32) * rows);
+    int nhashes = 0;
+
+    bulkload_vector_iter iter;
+    iter.begin(batchRowPtr->m_vectors + col, rows);
+    for (int i = 0; i < rows; ++i) {
+        Datum value;
+        bool isnull = false;
+        iter.next(&value, &isnull);
+        if (!isnull) {
+            hashes[nhashes++] = CUBloomHashValue(typeOid, value);
+        }
+    }
+
+    char* bloom = CUBloomBuild(hashes, nhashes);
+    pfree(hashes);
+    return bloom;
+}
+
 /*
  * @Description: init CU memory for copying
  * @IN batchRowPtr: batchrows
@@ -32,6 +32,7 @@
 #include "commands/tablecmds.h"
 #include "catalog/objectaccess.h"
 #include "access/cstore_insert.h"
+#include "access/cstore_bloom.h"
 #include "catalog/dependency.h"
 #include "utils/lsyscache.h"
 #include "catalog/index.h"
@@ -219,6 +220,7 @@ CStoreRewriter::CStoreRewriter(Relation oldHeapRel, TupleDesc oldTupDesc, TupleD
       m_SDTColsInfo(NULL),
       m_SDTColsReader(NULL),
       m_SDTColsMinMaxFunc(NULL),
+      m_SDTColsBloom(NULL),
       m_SDTColsWriter(NULL),
       m_SDTColValues(NULL),
       m_SDTColIsNull(NULL),
@@ -931,6 +933,7 @@ void CStoreRewriter::SetDataTypeInitPhase1()
     m_SDTColsInfo = (CStoreRewriteColumn**)palloc(sizeof(CStoreRewriteColumn*) * m_SDTColsNum);
     m_SDTColsReader = (CUStorage**)palloc(sizeof(CUStorage*) * m_SDTColsNum);
     m_SDTColsMinMaxFunc = (FuncSetMinMax*)palloc(sizeof(FuncSetMinMax) * m_SDTColsNum);
+    m_SDTColsBloom = (bool*)palloc(sizeof(bool) * m_SDTColsNum);
     m_SDTColsWriter = (CUStorage**)palloc(sizeof(CUStorage*) * m_SDTColsNum);
 
     m_SDTColValues = (Datum*)palloc(sizeof(Datum) * RelMaxFullCuSize);
@@ -948,6 +951,9 @@ void CStoreRewriter::SetDataTypeInitPhase2(_in_ CStoreRewriteColumn* sdtColInfo,
     /* Min/Max functions for columns of changing data type. */
     m_SDTColsMinMaxFunc[idx] = GetMinMaxFunc(m_NewTupDesc->attrs[sdtColInfo->attrno - 1]->atttypid);
 
+    /* bloom filters are rebuilt for the new data type. */
+    m_SDTColsBloom[idx] = CUBloomEnabled(m_OldHeapRel, m_NewTupDesc->attrs[sdtColInfo->attrno - 1]);
+
     CFileNode cFileNode(m_OldHeapRel->rd_node, (int)sdtColInfo->attrno, MAIN_FORKNUM);
     m_SDTColsReader[idx] = New(CurrentMemoryContext) CUStorage(cFileNode);
 
@@ -1017,6 +1023,7 @@ void CStoreRewriter::SetDataTypeDestroy()
         pfree_ext(m_SDTColsInfo);
         pfree_ext(m_SDTColsReader);
         pfree_ext(m_SDTColsMinMaxFunc);
+        pfree_ext(m_SDTColsBloom);
         pfree_ext(m_SDTColsWriter);
         pfree_ext(m_SDTColValues);
         pfree_ext(m_SDTColIsNull);
@@ -1080,6 +1087,7 @@ void CStoreRewriter::SetDataType(_in_ uint32 cuId, _in_ HeapTuple* cudescTup, _i
         }
 
         InsertNewCudescTup(&newColCudesc, RelationGetDescr(m_NewCudescRel), m_NewTupDesc->attrs[attrIndex]);
+        pfree_ext(newColCudesc.cu_bloom);
 
         ResetExprContext(m_econtext);
 
@@ -1323,6 +1331,10 @@ void CStoreRewriter::SetDataTypeHandleNormalCu(
         heaprel_set_compressing_modes(m_OldHeapRel, &compressing_modes);
         CompressCuData(newCu, newColCudesc, pColNewAttr, compressing_modes);
 
+        if (m_SDTColsBloom[sdtIndex]) {
+            newColCudesc->cu_bloom = FormCuBloom(pColNewAttr->atttypid, rowsCntInCu);
+        }
+
         if (m_TblspcChanged) {
             /* get the writing offset directly */
             newColCudesc->cu_pointer = m_SDTColAppendOffset[sdtIndex];
@@ -1350,6 +1362,28 @@ void CStoreRewriter::SetDataTypeHandleNormalCu(
     DELETE_EX(newCu);
 }
 
+/*
+ * @Description: build the bloom filter from the new values of SET DATA TYPE column
+ * @IN typeOid: new data type
+ * @IN rowsCntInCu: number of rows in m_SDTColValues/m_SDTColIsNull
+ * @Return: serialized bloom filter, or NULL if it's useless
+ */
+char* CStoreRewriter::FormCuBloom(Oid typeOid, int rowsCntInCu)
+{
+    uint32* hashes = (uint32*)palloc(sizeof(uint32) * rowsCntInCu);
+    int nhashes = 0;
+
+    for (int cnt = 0; cnt < rowsCntInCu; ++cnt) {
+        if (!m_SDTColIsNull[cnt]) {
+            hashes[nhashes++] = CUBloomHashValue(typeOid, m_SDTColValues[cnt]);
+        }
+    }
+
+    char* bloom = CUBloomBuild(hashes, nhashes);
+    pfree(hashes);
+    return bloom;
+}
+
 void CStoreRewriter::InsertNewCudescTup(
     _in_ CUDesc* pCudesc, _in_ TupleDesc pCudescTupDesc, _in_ Form_pg_attribute pColNewAttr)
 {
@@ -77,6 +77,7 @@ void CUDesc::Reset()
     cu_pointer = 0;
     magic = 0;
     xmin = 0;
+    cu_bloom = NULL;
 }
 
 FORCE_INLINE
@@ -469,21 +470,45 @@ uint32 CU::GenerateCrc(uint16 info_mode) const
  */
 void CU::Compress(int valCount, int16 compress_modes)
 {
-    errno_t rc;
+    AllocCompressBuf();
+    CompressIntoBuf(valCount, compress_modes);
 
-    // Step 1: initialize allocate the size of compress_buffer
+    // free source buffer
+    FreeSrcBuf();
+}
+
+/*
+ * @Description: allocate the compress buffer of this CU.
+ *    It must run in the thread owning the CU, because the buffer is registered
+ *    into the thread-local CStoreMemAlloc table. See also CompressIntoBuf().
+ */
+void CU::AllocCompressBuf(void)
+{
     // source data size + nulls bitmap size + header size
     // We guarantee that compress data size will not exceed it
     m_compressedBufSize = ALLIGN_CUSIZE(m_srcDataSize + m_bpNullRawSize + sizeof(CU));
     m_compressedBuf = (char*)CStoreMemAlloc::Palloc(m_compressedBufSize, !m_inCUCache);
+}
 
+/*
+ * @Description: compress source data into the buffer allocated by AllocCompressBuf().
+ *    Neither the source nor the compress buffer is allocated or freed here, so it's
+ *    safe to be called by a parallel compress worker. See CStoreCompressWorkerMain().
+ * @IN compress_modes: compressing modes
+ * @IN valCount: values count
+ */
+void CU::CompressIntoBuf(int valCount, int16 compress_modes)
+{
+    errno_t rc;
+
+    Assert(m_compressedBuf != NULL);
     int16 headerLen = GetCUHeaderSize();
     char* buf = m_compressedBuf + headerLen;
 
-    // Step 2: fill Compress NULL bitmap
+    // Step 1: fill Compress NULL bitmap
     buf = CompressNullBitmapIfNeed(buf);
 
-    // Step 3: Compress data
+    // Step 2: Compress data
     bool compressed = false;
     if (COMPRESS_NO != heaprel_get_compression_from_modes(compress_modes))
         compressed = CompressData(buf, valCount, compress_modes);
@@ -503,13 +528,10 @@ void CU::Compress(int valCount, int16 compress_modes)
     // encrypt cu after compress
     CUDataEncrypt(buf);
 
-    // Step 4: Fill compress_buffer header
+    // Step 3: Fill compress_buffer header
     FillCompressBufHeader();
 
     m_cache_compressed = true;
-
-    // Step 5; free source buffer
-    FreeSrcBuf();
 }
 
 // 	  CompressBufHeader
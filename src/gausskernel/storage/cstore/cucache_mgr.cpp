@@ -21,6 +21,7 @@
  */
 #include "postgres.h"
 #include "knl/knl_variable.h"
+#include "access/hash.h"
 #include "storage/cucache_mgr.h"
 #include "utils/aiomem.h"
 #include "executor/instrument.h"
@@ -36,6 +37,44 @@ int CUCacheMode = 1;
 
 DataCacheMgr* DataCacheMgr::m_data_cache = NULL;
 
+/* compressed CU tier smaller than this is useless, it is disabled */
+#define MIN_COMPRESSED_CACHE_SLOTS 1024
+
+/* rows and max counter value of CU access sketch */
+#define CU_SKETCH_DEPTH 4
+#define CU_SKETCH_MAX_COUNT 15
+#define CU_SKETCH_MIN_WIDTH 1024
+#define CU_SKETCH_SAMPLE_FACTOR 10
+
+/* m_prev value of a slot not linked in relation slot index */
+#define REL_SLOT_UNLINKED (-2)
+
+typedef struct CURelSlotEnt {
+    RelFileNodeOld rnode;
+    CacheSlotId_t head;
+    int count;
+} CURelSlotEnt;
+
+static const char* const CUCacheTierName[CU_CACHE_TIER_NUM] = {"uncompressed", "compressed"};
+
+/*
+ * @Description: split data cache size between uncompressed and compressed CU tiers
+ *     by cstore_compressed_cache_ratio.
+ * @IN tier: CU cache tier
+ * @Return: cache size of the tier, 0 if the tier is disabled
+ * @See also:
+ */
+static int64 DataCacheTierSize(CUCacheTier tier)
+{
+    int64 cache_size = CacheMgrCalcSizeByType(MGR_CACHE_TYPE_DATA);
+    int64 compressed_size = cache_size * g_instance.attr.attr_storage.cstore_compressed_cache_ratio / 100;
+
+    if (compressed_size / BLCKSZ < MIN_COMPRESSED_CACHE_SLOTS) {
+        compressed_size = 0;
+    }
+    return (tier == CU_CACHE_TIER_COMPRESSED) ? compressed_size : (cache_size - compressed_size);
+}
+
 /*
  * @Description: DataCacheMgrNumLocks
  * Returns the number of LW locks required by the DataCacheMgr instance.
@@ -48,8 +87,237 @@ DataCacheMgr* DataCacheMgr::m_data_cache = NULL;
  */
 int DataCacheMgrNumLocks()
 {
-    int64 cache_size = CacheMgrCalcSizeByType(MGR_CACHE_TYPE_DATA);
-    return CacheMgrNumLocks(cache_size, BLCKSZ);
+    int64 cache_size = DataCacheTierSize(CU_CACHE_TIER_UNCOMPRESSED);
+    int64 compressed_size = DataCacheTierSize(CU_CACHE_TIER_COMPRESSED);
+    int num_locks = CacheMgrNumLocks(cache_size, BLCKSZ);
+
+    if (compressed_size > 0) {
+        num_locks += CacheMgrNumLocks(compressed_size, BLCKSZ);
+    }
+    return num_locks;
+}
+
+/*
+ * @Description: init CU access sketch
+ * @IN slotsNum: number of cache slots, the width of sketch is the power of 2 not less than it
+ * @See also:
+ */
+void CUAccessSketch::Init(int slotsNum)
+{
+    uint32 width = CU_SKETCH_MIN_WIDTH;
+    while (width < (uint32)slotsNum) {
+        width <<= 1;
+    }
+
+    m_counters = (uint8*)palloc0(CU_SKETCH_DEPTH * width * sizeof(uint8));
+    m_widthMask = width - 1;
+    m_sampleSize = CU_SKETCH_SAMPLE_FACTOR * width;
+    pg_atomic_init_u32(&m_additions, 0);
+}
+
+void CUAccessSketch::Destroy()
+{
+    pfree_ext(m_counters);
+}
+
+/*
+ * @Description: record one access of CU, counters are updated without lock,
+ *     losing an increment now and then is harmless for a frequency estimate.
+ * @IN tag: CU slot tag
+ * @Return: access frequency estimated before this access
+ * @See also:
+ */
+uint32 CUAccessSketch::Increment(const CUSlotTag* tag)
+{
+    uint32 hash = DatumGetUInt32(hash_any((const unsigned char*)tag, sizeof(CUSlotTag)));
+    uint32 step = ((hash >> 16) | (hash << 16)) | 1;
+    uint32 freq = CU_SKETCH_MAX_COUNT;
+
+    for (int i = 0; i < CU_SKETCH_DEPTH; i++) {
+        uint8* counter = &m_counters[Position(hash, step, i)];
+        freq = Min(freq, *counter);
+        if (*counter < CU_SKETCH_MAX_COUNT) {
+            (*counter)++;
+        }
+    }
+
+    /* age all counters once enough accesses are sampled */
+    if (pg_atomic_add_fetch_u32(&m_additions, 1) >= m_sampleSize) {
+        uint32 expected = pg_atomic_read_u32(&m_additions);
+        if (expected >= m_sampleSize && pg_atomic_compare_exchange_u32(&m_additions, &expected, 0)) {
+            Reset();
+        }
+    }
+    return freq;
+}
+
+/*
+ * @Description: estimate access frequency of CU without recording an access
+ * @IN tag: CU slot tag
+ * @Return: access frequency
+ * @See also:
+ */
+uint32 CUAccessSketch::Estimate(const CUSlotTag* tag) const
+{
+    uint32 hash = DatumGetUInt32(hash_any((const unsigned char*)tag, sizeof(CUSlotTag)));
+    uint32 step = ((hash >> 16) | (hash << 16)) | 1;
+    uint32 freq = CU_SKETCH_MAX_COUNT;
+
+    for (int i = 0; i < CU_SKETCH_DEPTH; i++) {
+        freq = Min(freq, m_counters[Position(hash, step, i)]);
+    }
+    return freq;
+}
+
+/* counter of the row for hash, rows are indexed by double hashing */
+inline uint32 CUAccessSketch::Position(uint32 hash, uint32 step, int row) const
+{
+    return row * (m_widthMask + 1) + ((hash + row * step) & m_widthMask);
+}
+
+/* halve all counters */
+void CUAccessSketch::Reset()
+{
+    uint32 total = CU_SKETCH_DEPTH * (m_widthMask + 1);
+    for (uint32 i = 0; i < total; i++) {
+        m_counters[i] >>= 1;
+    }
+}
+
+/*
+ * @Description: init relation slot index of one CU cache tier
+ * @IN name: hash table name
+ * @IN slotsNum: number of cache slots
+ * @See also:
+ */
+void CURelSlotIndex::Init(const char* name, int slotsNum)
+{
+    HASHCTL info;
+    errno_t rc = memset_s(&info, sizeof(info), 0, sizeof(info));
+    securec_check(rc, "\0", "\0");
+
+    info.keysize = sizeof(RelFileNodeOld);
+    info.entrysize = sizeof(CURelSlotEnt);
+    info.hash = tag_hash;
+    m_hash = HeapMemInitHash(name, slotsNum, slotsNum, &info, HASH_ELEM | HASH_FUNCTION);
+
+    m_next = (CacheSlotId_t*)palloc(slotsNum * sizeof(CacheSlotId_t));
+    m_prev = (CacheSlotId_t*)palloc(slotsNum * sizeof(CacheSlotId_t));
+    m_owner = (RelFileNodeOld*)palloc0(slotsNum * sizeof(RelFileNodeOld));
+    for (int i = 0; i < slotsNum; i++) {
+        m_next[i] = CACHE_BLOCK_INVALID_IDX;
+        m_prev[i] = REL_SLOT_UNLINKED;
+    }
+    m_slotsNum = slotsNum;
+    m_incomplete = false;
+}
+
+void CURelSlotIndex::Destroy()
+{
+    HeapMemResetHash(m_hash, "CU Cache Relation Slot Index");
+    pfree_ext(m_next);
+    pfree_ext(m_prev);
+    pfree_ext(m_owner);
+}
+
+/*
+ * @Description: link the slot into the slot list of relation. A slot still linked
+ *     to another relation is moved, the list must follow the tag of the slot.
+ * @IN rnode: relation file node
+ * @IN slotId: cache slot just reserved
+ * @See also: caller holds CUCacheRelIndexLock exclusively
+ */
+void CURelSlotIndex::Link(const RelFileNodeOld* rnode, CacheSlotId_t slotId)
+{
+    Assert(slotId >= 0 && slotId < m_slotsNum);
+    if (m_prev[slotId] != REL_SLOT_UNLINKED) {
+        if (RelFileNodeRelEquals(m_owner[slotId], *rnode)) {
+            return;
+        }
+        Unlink(slotId);
+    }
+
+    bool found = false;
+    CURelSlotEnt* ent = (CURelSlotEnt*)hash_search(m_hash, (const void*)rnode, HASH_ENTER_NULL, &found);
+    if (ent == NULL) {
+        /* never happens in practice, DropRelationCUCache() scans the cache then */
+        m_incomplete = true;
+        return;
+    }
+    if (!found) {
+        ent->head = CACHE_BLOCK_INVALID_IDX;
+        ent->count = 0;
+    }
+
+    m_next[slotId] = ent->head;
+    m_prev[slotId] = CACHE_BLOCK_INVALID_IDX;
+    if (IsValidCacheSlotID(ent->head)) {
+        m_prev[ent->head] = slotId;
+    }
+    ent->head = slotId;
+    ent->count++;
+    m_owner[slotId] = *rnode;
+}
+
+/*
+ * @Description: unlink the slot from the slot list of the relation it is linked to
+ * @IN slotId: cache slot removed from cache
+ * @See also: caller holds CUCacheRelIndexLock exclusively
+ */
+void CURelSlotIndex::Unlink(CacheSlotId_t slotId)
+{
+    Assert(slotId >= 0 && slotId < m_slotsNum);
+    if (m_prev[slotId] == REL_SLOT_UNLINKED) {
+        return;
+    }
+
+    const RelFileNodeOld* rnode = &m_owner[slotId];
+    CURelSlotEnt* ent = (CURelSlotEnt*)hash_search(m_hash, (const void*)rnode, HASH_FIND, NULL);
+    if (ent == NULL) {
+        ereport(PANIC, (errmodule(MOD_CACHE), errmsg("CU cache relation slot index is corrupted, slot(%d)", slotId)));
+    }
+
+    if (IsValidCacheSlotID(m_prev[slotId])) {
+        m_next[m_prev[slotId]] = m_next[slotId];
+    } else {
+        ent->head = m_next[slotId];
+    }
+    if (IsValidCacheSlotID(m_next[slotId])) {
+        m_prev[m_next[slotId]] = m_prev[slotId];
+    }
+    m_next[slotId] = CACHE_BLOCK_INVALID_IDX;
+    m_prev[slotId] = REL_SLOT_UNLINKED;
+
+    if (--ent->count == 0) {
+        (void)hash_search(m_hash, (const void*)rnode, HASH_REMOVE, NULL);
+    }
+}
+
+/*
+ * @Description: get all slots linked to relation
+ * @IN rnode: relation file node
+ * @OUT slots: palloc'd slot array
+ * @Return: number of slots
+ * @See also: caller holds CUCacheRelIndexLock
+ */
+int CURelSlotIndex::GetRelSlots(const RelFileNode& rnode, CacheSlotId_t** slots)
+{
+    RelFileNodeOld key;
+    int nslots = 0;
+
+    RelFileNodeRelCopy(key, rnode);
+    *slots = NULL;
+    CURelSlotEnt* ent = (CURelSlotEnt*)hash_search(m_hash, (const void*)&key, HASH_FIND, NULL);
+    if (ent == NULL) {
+        return 0;
+    }
+
+    *slots = (CacheSlotId_t*)palloc(ent->count * sizeof(CacheSlotId_t));
+    for (CacheSlotId_t slot = ent->head; IsValidCacheSlotID(slot); slot = m_next[slot]) {
+        Assert(nslots < ent->count);
+        (*slots)[nslots++] = slot;
+    }
+    return nslots;
 }
 
 /*
@@ -77,21 +345,57 @@ void DataCacheMgr::NewSingletonInstance(void)
     int condition = sizeof(DataSlotTagKey) != MAX_CACHE_TAG_LEN ? 1 : 0;
     BUILD_BUG_ON_CONDITION(condition);
 
+    int64 compressed_size = DataCacheTierSize(CU_CACHE_TIER_COMPRESSED);
     if (m_data_cache == NULL) {
         /* create this instance at the first time */
         m_data_cache = New(CurrentMemoryContext) DataCacheMgr;
         m_data_cache->m_cache_mgr = New(CurrentMemoryContext) CacheMgr;
+        m_data_cache->m_compressed_cache_mgr = NULL;
+        if (compressed_size > 0) {
+            m_data_cache->m_compressed_cache_mgr = New(CurrentMemoryContext) CacheMgr;
+        }
+        for (int i = 0; i < CU_CACHE_TIER_NUM; i++) {
+            m_data_cache->m_rel_index[i] = New(CurrentMemoryContext) CURelSlotIndex;
+        }
+        m_data_cache->m_sketch = New(CurrentMemoryContext) CUAccessSketch;
     } else {
         /* destroy all resources of its members */
         m_data_cache->m_cache_mgr->Destroy();
+        m_data_cache->m_rel_index[CU_CACHE_TIER_UNCOMPRESSED]->Destroy();
+        if (m_data_cache->m_compressed_cache_mgr != NULL) {
+            m_data_cache->m_compressed_cache_mgr->Destroy();
+            m_data_cache->m_rel_index[CU_CACHE_TIER_COMPRESSED]->Destroy();
+        }
+        m_data_cache->m_sketch->Destroy();
         SpinLockFree(&m_data_cache->m_adio_write_cache_lock);
     }
-    cache_size = CacheMgrCalcSizeByType(MGR_CACHE_TYPE_DATA);
+    cache_size = DataCacheTierSize(CU_CACHE_TIER_UNCOMPRESSED);
     m_data_cache->m_cstoreMaxSize = cache_size;
     SpinLockInit(&m_data_cache->m_adio_write_cache_lock);
     /* init or reset this instance */
     m_data_cache->m_cache_mgr->Init(cache_size, BLCKSZ, MGR_CACHE_TYPE_DATA, Max(sizeof(CU), sizeof(OrcDataValue)));
-    ereport(LOG, (errmodule(MOD_CACHE), errmsg("set data cache  size(%ld)", cache_size)));
+    m_data_cache->m_cache_mgr->SetReserveCallback(DataCacheMgr::ReserveCallback);
+    m_data_cache->m_cache_mgr->SetDropCallback(DataCacheMgr::DropCallback);
+    m_data_cache->m_rel_index[CU_CACHE_TIER_UNCOMPRESSED]->Init(
+        "CU Cache Relation Slot Index", m_data_cache->m_cache_mgr->GetCacheSlotsNum());
+    int sketch_slots = m_data_cache->m_cache_mgr->GetCacheSlotsNum();
+    if (m_data_cache->m_compressed_cache_mgr != NULL) {
+        m_data_cache->m_compressed_cache_mgr->Init(
+            compressed_size, BLCKSZ, MGR_CACHE_TYPE_COMPRESSED_DATA, sizeof(OrcDataValue));
+        m_data_cache->m_compressed_cache_mgr->SetReserveCallback(DataCacheMgr::ReserveCallback);
+        m_data_cache->m_compressed_cache_mgr->SetDropCallback(DataCacheMgr::DropCallback);
+        m_data_cache->m_rel_index[CU_CACHE_TIER_COMPRESSED]->Init(
+            "Compressed CU Cache Relation Slot Index", m_data_cache->m_compressed_cache_mgr->GetCacheSlotsNum());
+        sketch_slots += m_data_cache->m_compressed_cache_mgr->GetCacheSlotsNum();
+    }
+    m_data_cache->m_sketch->Init(sketch_slots);
+    for (int i = 0; i < CU_CACHE_TIER_NUM; i++) {
+        pg_atomic_init_u64(&m_data_cache->m_counter[i].hits, 0);
+        pg_atomic_init_u64(&m_data_cache->m_counter[i].misses, 0);
+        pg_atomic_init_u64(&m_data_cache->m_counter[i].probations, 0);
+    }
+    ereport(LOG, (errmodule(MOD_CACHE),
+        errmsg("set data cache  size(%ld), compressed data cache size(%ld)", cache_size, compressed_size)));
 }
 
 /*
@@ -163,6 +467,10 @@ CacheSlotId_t DataCacheMgr::FindDataBlock(DataSlotTag* dataSlotTag, bool first_e
 
     m_cache_mgr->InitCacheBlockTag(&cacheTag, dataSlotTag->slotType, &dataSlotTag->slotTag, sizeof(DataSlotTagKey));
     slot = m_cache_mgr->FindCacheBlock(&cacheTag, first_enter_block);
+    if (IsValidCacheSlotID(slot) && first_enter_block && cacheTag.type == CACHE_COlUMN_DATA) {
+        (void)pg_atomic_fetch_add_u64(&m_counter[CU_CACHE_TIER_UNCOMPRESSED].hits, 1);
+        (void)m_sketch->Increment(&dataSlotTag->slotTag.cuSlotTag);
+    }
 
     return slot;
 }
@@ -184,26 +492,149 @@ void DataCacheMgr::InvalidateCU(RelFileNodeOld* rnode, int colId, uint32 cuId, C
     m_cache_mgr->InitCacheBlockTag(&cacheTag, dataSlotTag.slotType, &dataSlotTag.slotTag, sizeof(DataSlotTagKey));
     m_cache_mgr->InvalidateCacheBlock(&cacheTag);
 
+    if (m_compressed_cache_mgr != NULL) {
+        m_compressed_cache_mgr->InitCacheBlockTag(
+            &cacheTag, CACHE_COLUMN_COMPRESSED_DATA, &dataSlotTag.slotTag, sizeof(DataSlotTagKey));
+        m_compressed_cache_mgr->InvalidateCacheBlock(&cacheTag);
+    }
+
     return;
 }
 
 /* invalid all CUs from data cache which belongs to this column relation */
 void DataCacheMgr::DropRelationCUCache(const RelFileNode& rnode)
+{
+    CacheMgr* tierMgr[CU_CACHE_TIER_NUM] = {m_cache_mgr, m_compressed_cache_mgr};
+
+    for (int tier = 0; tier < CU_CACHE_TIER_NUM; tier++) {
+        CacheMgr* cacheMgr = tierMgr[tier];
+        CacheSlotId_t* slots = NULL;
+        int nslots = 0;
+
+        if (cacheMgr == NULL) {
+            continue;
+        }
+
+        (void)LWLockAcquire(CUCacheRelIndexLock, LW_SHARED);
+        if (m_rel_index[tier]->m_incomplete) {
+            LWLockRelease(CUCacheRelIndexLock);
+            DropRelationCUCacheByScan(cacheMgr, rnode);
+            continue;
+        }
+
+        /*
+         * Copy the tags out, the blocks must be invalidated without holding the
+         * index lock, which is taken under the hash partition lock on removal.
+         */
+        nslots = m_rel_index[tier]->GetRelSlots(rnode, &slots);
+        CacheTag* tags = (nslots > 0) ? (CacheTag*)palloc(nslots * sizeof(CacheTag)) : NULL;
+        for (int i = 0; i < nslots; i++) {
+            cacheMgr->CopyCacheBlockTag(slots[i], &tags[i]);
+        }
+        LWLockRelease(CUCacheRelIndexLock);
+
+        for (int i = 0; i < nslots; i++) {
+            cacheMgr->InvalidateCacheBlock(&tags[i]);
+        }
+        if (slots != NULL) {
+            pfree_ext(slots);
+            pfree_ext(tags);
+        }
+    }
+}
+
+/*
+ * @Description: invalid all CUs of relation by scanning all slots of the tier
+ * @IN cacheMgr: cache manager of CU cache tier
+ * @IN rnode: relation file node
+ * @See also:
+ */
+void DataCacheMgr::DropRelationCUCacheByScan(CacheMgr* cacheMgr, const RelFileNode& rnode)
 {
     CacheTag tag = {0};
     CUSlotTag cuTag = {{InvalidOid, InvalidOid, InvalidOid}, 0, 0, 0, 0};
-    const int maxSlot = m_cache_mgr->GetUsedCacheSlotNum();
+    const int maxSlot = cacheMgr->GetUsedCacheSlotNum();
 
     for (CacheSlotId_t slot = 0; slot <= maxSlot; slot++) {
-        m_cache_mgr->CopyCacheBlockTag(slot, &tag);
+        cacheMgr->CopyCacheBlockTag(slot, &tag);
         cuTag = *(CUSlotTag*)tag.key;
-        if (CACHE_COlUMN_DATA == tag.type && RelFileNodeRelEquals(rnode, cuTag.m_rnode)) {
+        if ((CACHE_COlUMN_DATA == tag.type || CACHE_COLUMN_COMPRESSED_DATA == tag.type) &&
+            RelFileNodeRelEquals(rnode, cuTag.m_rnode)) {
             /* try to invalid this CU */
-            InvalidateCU(&cuTag.m_rnode, cuTag.m_colId, cuTag.m_CUId, cuTag.m_cuPtr);
+            cacheMgr->InvalidateCacheBlock(&tag);
         }
     }
 }
 
+/*
+ * @Description: get relation slot index of the cache tier holding blocks of the tag type
+ * @IN type: cache tag type
+ * @Return: NULL if blocks of the type are not indexed
+ * @See also:
+ */
+CURelSlotIndex* DataCacheMgr::GetRelSlotIndex(int type)
+{
+    if (type == CACHE_COlUMN_DATA) {
+        return m_data_cache->m_rel_index[CU_CACHE_TIER_UNCOMPRESSED];
+    } else if (type == CACHE_COLUMN_COMPRESSED_DATA) {
+        return m_data_cache->m_rel_index[CU_CACHE_TIER_COMPRESSED];
+    }
+    return NULL;
+}
+
+/*
+ * @Description: link the CU slot into relation slot index when it gets a new tag.
+ *     Called by CacheMgr with the hash partition lock of the new tag held, so the
+ *     index never lags behind the tag of the slot.
+ * @IN slotId: slot id
+ * @IN cacheTag: new cache tag of the slot
+ * @See also:
+ */
+void DataCacheMgr::ReserveCallback(CacheSlotId_t slotId, const CacheTag* cacheTag)
+{
+    CURelSlotIndex* relIndex = GetRelSlotIndex(cacheTag->type);
+    if (relIndex == NULL) {
+        return;
+    }
+
+    (void)LWLockAcquire(CUCacheRelIndexLock, LW_EXCLUSIVE);
+    relIndex->Link(&((const CUSlotTag*)cacheTag->key)->m_rnode, slotId);
+    LWLockRelease(CUCacheRelIndexLock);
+}
+
+/*
+ * @Description: unlink the CU slot from relation slot index when it leaves the cache.
+ *     Called by CacheMgr with the hash partition lock held.
+ * @IN slotId: slot id
+ * @IN cacheTag: cache tag of the slot
+ * @See also:
+ */
+void DataCacheMgr::DropCallback(CacheSlotId_t slotId, const CacheTag* cacheTag)
+{
+    CURelSlotIndex* relIndex = GetRelSlotIndex(cacheTag->type);
+    if (relIndex == NULL) {
+        return;
+    }
+
+    (void)LWLockAcquire(CUCacheRelIndexLock, LW_EXCLUSIVE);
+    relIndex->Unlink(slotId);
+    LWLockRelease(CUCacheRelIndexLock);
+}
+
+/*
+ * @Description: record the access of a CU missing in cache, and decide whether it
+ *     is admitted on probation. A CU not seen recently is most likely read by a one
+ *     pass scan, it must not push the frequently read CUs out.
+ * @IN tag: CU slot tag
+ * @Return: true if admitted on probation
+ * @See also:
+ */
+bool DataCacheMgr::AdmitOnProbation(const CUSlotTag* tag)
+{
+    uint32 freq = m_sketch->Increment(tag);
+    return u_sess->attr.attr_storage.enable_cu_cache_admission && freq == 0;
+}
+
 /*
  * @Description:  get cu cached buffer
  * @IN cuSlotId: slot id
@@ -281,6 +712,16 @@ CacheSlotId_t DataCacheMgr::ReserveDataBlock(DataSlotTag* dataSlotTag, int size,
         /* remember block slot in process */
         Assert(!IsValidCacheSlotID(t_thrd.storage_cxt.CacheBlockInProgressIO));
         t_thrd.storage_cxt.CacheBlockInProgressIO = slot;
+
+        if (cacheTag.type == CACHE_COlUMN_DATA) {
+            CUSlotTag* cuslotTag = &dataSlotTag->slotTag.cuSlotTag;
+            (void)pg_atomic_fetch_add_u64(&m_counter[CU_CACHE_TIER_UNCOMPRESSED].misses, 1);
+
+            if (AdmitOnProbation(cuslotTag)) {
+                m_cache_mgr->SetCacheBlockProbation(slot);
+                (void)pg_atomic_fetch_add_u64(&m_counter[CU_CACHE_TIER_UNCOMPRESSED].probations, 1);
+            }
+        }
     }
     if (cacheTag.type == CACHE_COlUMN_DATA) {
         CUSlotTag* cuslotTag = &dataSlotTag->slotTag.cuSlotTag;
@@ -339,6 +780,17 @@ void DataCacheMgr::UnPinDataBlock(int CUSlotId)
     m_cache_mgr->UnPinCacheBlock(CUSlotId);
 }
 
+/*
+ * @Description: remove pin of compressed tier block
+ * @IN slotId: slot id
+ * @See also:
+ */
+void DataCacheMgr::UnPinCompressedBlock(CacheSlotId_t slotId)
+{
+    Assert(m_compressed_cache_mgr != NULL);
+    m_compressed_cache_mgr->UnPinCacheBlock(slotId);
+}
+
 /*
  * @Description: do resource clean(set block state and release lock if needed) if reserver data block failed
  * @Param[IN] slot: slot id
@@ -453,11 +905,13 @@ CUUncompressedRetCode DataCacheMgr::StartUncompressCU(
 
     if (cuPtr->CheckCrc() == false) {
         /* CRC check failed */
+        InvalidateCompressedCU(slotId);
         m_cache_mgr->RealeseCompressLock(slotId);
         return CU_ERR_CRC;
     }
 
     if (cuPtr->CheckMagic(cuDescPtr->magic) == false) {
+        InvalidateCompressedCU(slotId);
         m_cache_mgr->RealeseCompressLock(slotId);
         return CU_ERR_MAGIC;
     }
@@ -475,16 +929,18 @@ CUUncompressedRetCode DataCacheMgr::StartUncompressCU(
     cuPtr->UnCompress(cuDescPtr->row_count, cuDescPtr->magic);
     UNCOMPRESS_TRACE(TRACK_END(planNodeId, UNCOMPRESS_CU));
 
-    /* Do not put the compressedBuf in the cache
-     * In the future we may have compressed data in the cache or let the
-     * caller choose, but for now we just keep the uncompressed data.
+    /* Keep a copy of the compressed data in the compressed tier if it saves
+     * memory, the uncompressed tier keeps only the uncompressed data.
      */
+    int cu_uncompress_size = cuPtr->GetUncompressBufSize();
+    if (m_compressed_cache_mgr != NULL && cuPtr->GetCompressBufSize() < cu_uncompress_size) {
+        AdmitCompressedCU(slotId, cuPtr);
+    }
     cuPtr->FreeCompressBuf();
 
     /* Adjust the allocation reservation to take into account
      * compression or expansion.
      */
-    int cu_uncompress_size = cuPtr->GetUncompressBufSize();
     m_cache_mgr->AdjustCacheMem(slotId, cuDescPtr->cu_size, cu_uncompress_size);
     m_cache_mgr->RealeseCompressLock(slotId);
 
@@ -492,6 +948,151 @@ CUUncompressedRetCode DataCacheMgr::StartUncompressCU(
     return CU_OK;
 }
 
+/*
+ * @Description: copy the compressed data of CU into compressed tier
+ * @Param[IN] slotId: slot id of CU in uncompressed tier, compress lock held
+ * @Param[IN] cuPtr: CU with valid compressed data
+ * @See also:
+ */
+void DataCacheMgr::AdmitCompressedCU(CacheSlotId_t slotId, CU* cuPtr)
+{
+    CacheTag cacheTag = {0};
+    bool hasFound = false;
+    int size = cuPtr->GetCompressBufSize();
+
+    m_cache_mgr->CopyCacheBlockTag(slotId, &cacheTag);
+    Assert(cacheTag.type == CACHE_COlUMN_DATA);
+    cacheTag.type = CACHE_COLUMN_COMPRESSED_DATA;
+
+    CacheSlotId_t slot = m_compressed_cache_mgr->FindCacheBlock(&cacheTag, false);
+    if (IsValidCacheSlotID(slot)) {
+        m_compressed_cache_mgr->UnPinCacheBlock(slot);
+        return;
+    }
+
+    slot = m_compressed_cache_mgr->ReserveCacheBlock(&cacheTag, size, hasFound);
+    if (hasFound) {
+        m_compressed_cache_mgr->UnPinCacheBlock(slot);
+        return;
+    }
+
+    const CUSlotTag* cuslotTag = (const CUSlotTag*)cacheTag.key;
+    OrcDataValue* compressedData = (OrcDataValue*)m_compressed_cache_mgr->GetCacheBlock(slot);
+    compressedData->value = malloc(size);
+    if (compressedData->value == NULL) {
+        /* not worth an error, leave the block for eviction */
+        m_compressed_cache_mgr->CompleteIO(slot);
+        m_compressed_cache_mgr->SetCacheBlockErrorState(slot);
+        m_compressed_cache_mgr->UnPinCacheBlock(slot);
+        return;
+    }
+    errno_t rc = memcpy_s(compressedData->value, size, cuPtr->m_compressedBuf, size);
+    securec_check(rc, "\0", "\0");
+    compressedData->size = size;
+
+    /* the CU was read once only, its compressed copy goes first too */
+    if (u_sess->attr.attr_storage.enable_cu_cache_admission && m_sketch->Estimate(cuslotTag) <= 1) {
+        m_compressed_cache_mgr->SetCacheBlockProbation(slot);
+        (void)pg_atomic_fetch_add_u64(&m_counter[CU_CACHE_TIER_COMPRESSED].probations, 1);
+    }
+    m_compressed_cache_mgr->CompleteIO(slot);
+    m_compressed_cache_mgr->UnPinCacheBlock(slot);
+}
+
+/*
+ * @Description: remove the compressed copy of a CU which failed check.
+ * @Param[IN] slotId: slot id of CU in uncompressed tier
+ * @See also:
+ */
+void DataCacheMgr::InvalidateCompressedCU(CacheSlotId_t slotId)
+{
+    CacheTag cacheTag = {0};
+
+    if (m_compressed_cache_mgr == NULL) {
+        return;
+    }
+
+    m_cache_mgr->CopyCacheBlockTag(slotId, &cacheTag);
+    cacheTag.type = CACHE_COLUMN_COMPRESSED_DATA;
+    m_compressed_cache_mgr->InvalidateCacheBlock(&cacheTag);
+}
+
+/*
+ * @Description: fill CU with the compressed data kept in compressed tier,
+ *     instead of reading it from disk.
+ * @Param[IN] dataSlotTag: CU slot tag
+ * @Param[IN] cuPtr: CU reserved in uncompressed tier
+ * @Param[IN] size: compressed CU size
+ * @Return: true if CU is loaded
+ * @See also:
+ */
+bool DataCacheMgr::LoadCUFromCompressedCache(DataSlotTag* dataSlotTag, CU* cuPtr, int size)
+{
+    CacheTag cacheTag = {0};
+
+    if (m_compressed_cache_mgr == NULL) {
+        return false;
+    }
+
+    m_compressed_cache_mgr->InitCacheBlockTag(
+        &cacheTag, CACHE_COLUMN_COMPRESSED_DATA, &dataSlotTag->slotTag, sizeof(DataSlotTagKey));
+    CacheSlotId_t slot = m_compressed_cache_mgr->FindCacheBlock(&cacheTag, true);
+    if (!IsValidCacheSlotID(slot)) {
+        (void)pg_atomic_fetch_add_u64(&m_counter[CU_CACHE_TIER_COMPRESSED].misses, 1);
+        return false;
+    }
+
+    /* being filled by another thread, or failed */
+    OrcDataValue* compressedData = (OrcDataValue*)m_compressed_cache_mgr->GetCacheBlock(slot);
+    if (m_compressed_cache_mgr->WaitIO(slot) || compressedData->value == NULL ||
+        compressedData->size != (uint64)size) {
+        m_compressed_cache_mgr->UnPinCacheBlock(slot);
+        (void)pg_atomic_fetch_add_u64(&m_counter[CU_CACHE_TIER_COMPRESSED].misses, 1);
+        return false;
+    }
+
+    /* the same over-boundary padding as CUStorage::LoadCU() */
+    char* buf = (char*)malloc(size + 8);
+    if (buf == NULL) {
+        m_compressed_cache_mgr->UnPinCacheBlock(slot);
+        return false;
+    }
+    errno_t rc = memcpy_s(buf, size + 8, compressedData->value, size);
+    securec_check(rc, "\0", "\0");
+    m_compressed_cache_mgr->UnPinCacheBlock(slot);
+
+    cuPtr->m_head_padding_size = 0;
+    cuPtr->m_compressedLoadBuf = buf;
+    cuPtr->m_compressedBuf = buf;
+    cuPtr->SetCUSize(size);
+    cuPtr->m_compressedBufSize = size;
+    cuPtr->m_cache_compressed = true;
+
+    (void)pg_atomic_fetch_add_u64(&m_counter[CU_CACHE_TIER_COMPRESSED].hits, 1);
+    return true;
+}
+
+/*
+ * @Description: get statistics of all CU cache tiers
+ * @OUT tierInfo: array of CU_CACHE_TIER_NUM elements
+ * @See also:
+ */
+void DataCacheMgr::GetTierInfo(CUCacheTierInfo* tierInfo)
+{
+    CacheMgr* tierMgr[CU_CACHE_TIER_NUM] = {m_cache_mgr, m_compressed_cache_mgr};
+
+    for (int tier = 0; tier < CU_CACHE_TIER_NUM; tier++) {
+        CUCacheTierInfo* info = &tierInfo[tier];
+        info->tierName = CUCacheTierName[tier];
+        info->maxBytes = (tierMgr[tier] != NULL) ? tierMgr[tier]->GetMaxMemSize() : 0;
+        info->usedBytes = (tierMgr[tier] != NULL) ? tierMgr[tier]->GetCurrentMemSize() : 0;
+        info->evictions = (tierMgr[tier] != NULL) ? tierMgr[tier]->GetEvictCount() : 0;
+        info->hits = pg_atomic_read_u64(&m_counter[tier].hits);
+        info->misses = pg_atomic_read_u64(&m_counter[tier].misses);
+        info->probations = pg_atomic_read_u64(&m_counter[tier].probations);
+    }
+}
+
 /*
  * @Description: get data cache manage current memory cache used size
  * @Return: cache used size
@@ -645,6 +1246,33 @@ void DataCacheMgr::PrintDataCacheSlotLeakWarning(CacheSlotId_t slotId)
     return;
 }
 
+/*
+ * @Description: print compressed tier block info if resource leak found
+ * @IN slotId: slot id
+ * @See also:
+ */
+void DataCacheMgr::PrintCompressedCacheSlotLeakWarning(CacheSlotId_t slotId)
+{
+    uint32 refcount = 0;
+
+    Assert(IsValidCacheSlotID(slotId));
+
+    const CacheTag* cacheTag = m_compressed_cache_mgr->GetCacheBlockTag(slotId, &refcount);
+    const CUSlotTag* cuslotTag = (const CUSlotTag*)cacheTag->key;
+    ereport(WARNING,
+        (errmsg("CUCache compressed tier refcount leak: type:%d, spaceNode: %u, dbNode: %u, relNode: %u, colId: %d, "
+                "cuId: %d, cuPoint: %lu, refcount: %u, slotId:%d",
+            cacheTag->type,
+            cuslotTag->m_rnode.spcNode,
+            cuslotTag->m_rnode.dbNode,
+            cuslotTag->m_rnode.relNode,
+            cuslotTag->m_colId,
+            cuslotTag->m_CUId,
+            cuslotTag->m_cuPtr,
+            refcount,
+            slotId)));
+}
+
 /*
  * @Description:  set data block value, used for orc data cache
  * @IN buffer: buffer pointer
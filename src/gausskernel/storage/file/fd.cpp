@@ -91,6 +91,7 @@
 #include "storage/vfd.h"
 #include "storage/ipc.h"
 #include "storage/shmem.h"
+#include "storage/uring.h"
 #include "threadpool/threadpool.h"
 #include "utils/guc.h"
 #include "utils/plog.h"
@@ -2124,6 +2125,95 @@ retry:
     return returnCode;
 }
 
+// FilePIOBatch
+// 		Perform a batch of positional reads and writes, handing them to io_uring
+// 		with one system call when enable_io_uring is on. The result of every
+// 		request is set, and the caller reports failures as it would for
+// 		FilePRead/FilePWrite. Temporary files are not supported, as the size
+// 		accounting of temp_file_limit is done by FilePWrite only.
+// 		NOTE: The file offset is not changed.
+void FilePIOBatch(FileIORequest* reqs, int nreqs, uint32 wait_event_info)
+{
+    UringIORequest ureqs[URING_QUEUE_DEPTH];
+
+    for (int start = 0; start < nreqs; start += URING_QUEUE_DEPTH) {
+        int n = Min(nreqs - start, URING_QUEUE_DEPTH);
+        bool sync = false;
+
+        for (int i = 0; i < n; i++) {
+            FileIORequest* req = &reqs[start + i];
+
+            Assert(FileIsValid(req->file));
+            Assert(!(u_sess->storage_cxt.VfdCache[req->file].fdstate & FD_TEMP_FILE_LIMIT));
+
+            if (FileAccess(req->file) < 0) {
+                sync = true;
+                break;
+            }
+            ureqs[i].fd = u_sess->storage_cxt.VfdCache[req->file].fd;
+            ureqs[i].is_write = req->is_write;
+            ureqs[i].buf = req->buffer;
+            ureqs[i].len = (size_t)req->amount;
+            ureqs[i].offset = req->offset;
+
+            /* collect io info for statistics */
+            if (u_sess->attr.attr_resource.use_workload_manager &&
+                u_sess->attr.attr_resource.enable_logical_io_statistics) {
+                IOStatistics(req->is_write ? IO_TYPE_WRITE : IO_TYPE_READ, 1, req->amount);
+            }
+        }
+
+        /*
+         * Opening a file of the batch may have closed another one to stay
+         * within max_files_per_process. Should that happen, or should a file
+         * fail to open, do this part of the batch one by one, which reports
+         * the failure as usual.
+         */
+        for (int i = 0; i < n && !sync; i++) {
+            if (ureqs[i].fd != u_sess->storage_cxt.VfdCache[reqs[start + i].file].fd) {
+                sync = true;
+            }
+        }
+        if (sync) {
+            for (int i = 0; i < n; i++) {
+                FileIORequest* req = &reqs[start + i];
+
+                errno = 0;
+                if (req->is_write) {
+                    req->result = FilePWrite(req->file, req->buffer, req->amount, req->offset, wait_event_info);
+                } else {
+                    req->result = FilePRead(req->file, req->buffer, req->amount, req->offset, wait_event_info);
+                }
+                req->err = errno;
+            }
+            continue;
+        }
+
+        pgstat_report_waitevent(wait_event_info);
+        PGSTAT_INIT_TIME_RECORD();
+        PGSTAT_START_TIME_RECORD();
+        UringPIOBatch(ureqs, n);
+        PGSTAT_END_TIME_RECORD(DATA_IO_TIME);
+        pgstat_report_waitevent(WAIT_EVENT_END);
+
+        for (int i = 0; i < n; i++) {
+            FileIORequest* req = &reqs[start + i];
+
+            req->result = (int)ureqs[i].result;
+            req->err = ureqs[i].err;
+            /* as in FilePWrite, if the write didn't set errno assume no disk space */
+            if (req->is_write && req->result >= 0 && req->result != req->amount) {
+                req->err = ENOSPC;
+            }
+            if (req->result >= 0) {
+                u_sess->storage_cxt.VfdCache[req->file].seekPos += req->result;
+            } else {
+                u_sess->storage_cxt.VfdCache[req->file].seekPos = FileUnknownPos;
+            }
+        }
+    }
+}
+
 template <typename dlistType>
 static int FileAsyncSubmitIO(io_context_t aio_context, dlistType dList, int dListCount)
 {
@@ -0,0 +1,487 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * uring.cpp
+ *        batched file I/O through a per-thread io_uring
+ *
+ * A thread which issues many independent reads or writes at once (the
+ * pagewriter flushing dirty pages, for example) hands them to the kernel
+ * with a single io_uring_enter() instead of one pread/pwrite each. Every
+ * thread has its own ring, created on first use when enable_io_uring is on,
+ * and the calls wait for all the requests of the batch, so the callers see
+ * synchronous I/O.
+ *
+ * Buffers the thread writes from over and over (the WAL buffers of the
+ * walwriter, the batch pages of the pagewriter) may be registered with the
+ * ring, which saves the kernel mapping them for every request.
+ *
+ * The system calls are made directly, so that we don't depend on liburing.
+ * When the kernel has no io_uring, or the ring cannot be created, the
+ * requests are done one by one with pread/pwrite.
+ *
+ * IDENTIFICATION
+ *        src/gausskernel/storage/file/uring.cpp
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+#include "knl/knl_variable.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define USE_IO_URING
+#endif
+#endif
+
+#include "storage/ipc.h"
+#include "storage/uring.h"
+
+/*
+ * Do the rest of a request with pread/pwrite, starting done bytes into it.
+ * Unlike a plain pwrite, a short transfer is continued, so only the end of
+ * the file or an error stops before len.
+ */
+static void UringSyncIO(UringIORequest* req, size_t done)
+{
+    while (done < req->len) {
+        ssize_t rc;
+
+        if (req->is_write) {
+            rc = pwrite(req->fd, req->buf + done, req->len - done, req->offset + (off_t)done);
+        } else {
+            rc = pread(req->fd, req->buf + done, req->len - done, req->offset + (off_t)done);
+        }
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            req->result = -1;
+            req->err = errno;
+            return;
+        }
+        if (rc == 0) {
+            break;
+        }
+        done += (size_t)rc;
+    }
+    req->result = (ssize_t)done;
+    req->err = 0;
+}
+
+#ifdef USE_IO_URING
+
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#ifndef __NR_io_uring_register
+#define __NR_io_uring_register 427
+#endif
+
+/* io_uring takes registered buffers of at most 1GB */
+#define URING_MAX_FIXED_SIZE ((Size)1 << 30)
+#define URING_MAX_FIXED 64
+
+typedef struct UringRing {
+    int fd;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    struct io_uring_sqe* sqes;
+    struct io_uring_cqe* cqes;
+    void* sq_ring;
+    size_t sq_ring_size;
+    void* cq_ring;
+    size_t cq_ring_size;
+    size_t sqes_size;
+    /* the vector of a READV/WRITEV request, one per request in flight */
+    struct iovec iovs[URING_QUEUE_DEPTH];
+    /* buffers registered with the ring */
+    int nfixed;
+    struct iovec fixed[URING_MAX_FIXED];
+} UringRing;
+
+static THR_LOCAL UringRing* t_uring = NULL;
+/* the ring of this thread could not be set up, don't try again */
+static THR_LOCAL bool t_uring_unavailable = false;
+
+static void UringUnmap(UringRing* ring)
+{
+    if (ring->sqes != NULL) {
+        (void)munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ring != NULL && ring->cq_ring != ring->sq_ring) {
+        (void)munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring != NULL) {
+        (void)munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    if (ring->fd >= 0) {
+        (void)close(ring->fd);
+    }
+}
+
+/* the ring holds a file descriptor of the process, release it when the thread exits */
+static void UringAtExit(int code, Datum arg)
+{
+    if (t_uring != NULL) {
+        UringUnmap(t_uring);
+        t_uring = NULL;
+    }
+}
+
+static void* UringMap(int fd, size_t size, off_t offset)
+{
+    void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+
+    return (ptr == MAP_FAILED) ? NULL : ptr;
+}
+
+static UringRing* UringGetRing(void)
+{
+    struct io_uring_params params;
+    UringRing* ring = NULL;
+    int fd;
+
+    if (t_uring != NULL || t_uring_unavailable) {
+        return t_uring;
+    }
+
+    errno_t rc = memset_s(&params, sizeof(params), 0, sizeof(params));
+    securec_check(rc, "\0", "\0");
+    fd = (int)syscall(__NR_io_uring_setup, URING_QUEUE_DEPTH, &params);
+    if (fd < 0) {
+        t_uring_unavailable = true;
+        ereport(LOG, (errmsg("io_uring is not available, using synchronous I/O: %m")));
+        return NULL;
+    }
+
+    ring = (UringRing*)MemoryContextAllocZero(t_thrd.top_mem_cxt, sizeof(UringRing));
+    ring->fd = fd;
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+#ifdef IORING_FEAT_SINGLE_MMAP
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->sq_ring_size = Max(ring->sq_ring_size, ring->cq_ring_size);
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+#endif
+    ring->sq_ring = UringMap(fd, ring->sq_ring_size, IORING_OFF_SQ_RING);
+#ifdef IORING_FEAT_SINGLE_MMAP
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ring = ring->sq_ring;
+    } else
+#endif
+        ring->cq_ring = UringMap(fd, ring->cq_ring_size, IORING_OFF_CQ_RING);
+    ring->sqes = (struct io_uring_sqe*)UringMap(fd, ring->sqes_size, IORING_OFF_SQES);
+    if (ring->sq_ring == NULL || ring->cq_ring == NULL || ring->sqes == NULL) {
+        int save_errno = errno;
+
+        UringUnmap(ring);
+        pfree(ring);
+        t_uring_unavailable = true;
+        errno = save_errno;
+        ereport(LOG, (errmsg("could not map io_uring queues, using synchronous I/O: %m")));
+        return NULL;
+    }
+
+    char* sq = (char*)ring->sq_ring;
+    char* cq = (char*)ring->cq_ring;
+    ring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned*)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    on_proc_exit(UringAtExit, 0);
+    t_uring = ring;
+    return ring;
+}
+
+/* index of the registered buffer holding [buf, buf + len), or -1 */
+static int UringFindFixed(const UringRing* ring, const char* buf, size_t len)
+{
+    for (int i = 0; i < ring->nfixed; i++) {
+        const char* base = (const char*)ring->fixed[i].iov_base;
+
+        if (buf >= base && buf + len <= base + ring->fixed[i].iov_len) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* queue a request, it is submitted by the next io_uring_enter() */
+static void UringPrep(UringRing* ring, const UringIORequest* req, int index, int slot)
+{
+    unsigned tail = *ring->sq_tail;
+    unsigned idx = tail & *ring->sq_mask;
+    struct io_uring_sqe* sqe = &ring->sqes[idx];
+    int fixed = UringFindFixed(ring, req->buf, req->len);
+
+    Assert(req->len <= (size_t)PG_INT32_MAX);
+
+    errno_t rc = memset_s(sqe, sizeof(*sqe), 0, sizeof(*sqe));
+    securec_check(rc, "\0", "\0");
+    sqe->fd = req->fd;
+    sqe->off = (uint64)req->offset;
+    if (fixed >= 0) {
+        sqe->opcode = req->is_write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+        sqe->addr = (uint64)(uintptr_t)req->buf;
+        sqe->len = (uint32)req->len;
+        sqe->buf_index = (uint16)fixed;
+    } else {
+        ring->iovs[slot].iov_base = req->buf;
+        ring->iovs[slot].iov_len = req->len;
+        sqe->opcode = req->is_write ? IORING_OP_WRITEV : IORING_OP_READV;
+        sqe->addr = (uint64)(uintptr_t)&ring->iovs[slot];
+        sqe->len = 1;
+    }
+    sqe->user_data = ((uint64)(uint32)index << 32) | (uint32)slot;
+    ring->sq_array[idx] = idx;
+
+    /* the kernel must see the entry before the new tail */
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+static void UringComplete(UringIORequest* req, int res)
+{
+    if (res >= 0 && (size_t)res == req->len) {
+        req->result = res;
+        req->err = 0;
+    } else if (res >= 0) {
+        /* short read or write, do the rest by hand */
+        UringSyncIO(req, (size_t)res);
+    } else if (res == -EINTR || res == -EAGAIN) {
+        UringSyncIO(req, 0);
+    } else {
+        req->result = -1;
+        req->err = -res;
+    }
+}
+
+/* collect the completed requests, returns their number */
+static int UringReap(UringRing* ring, UringIORequest* reqs, int* free_slots, int* nfree)
+{
+    unsigned head = *ring->cq_head;
+    unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    int nreaped = 0;
+
+    while (head != tail) {
+        struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+
+        UringComplete(&reqs[cqe->user_data >> 32], cqe->res);
+        free_slots[(*nfree)++] = (int)(cqe->user_data & 0xFFFFFFFF);
+        head++;
+        nreaped++;
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    return nreaped;
+}
+
+/*
+ * io_uring_enter() failed for another reason than an interrupt. Nothing of
+ * the batch may be left in the kernel when we give up the ring, as the
+ * buffers of the requests belong to the caller once we return.
+ */
+static void UringFail(UringRing* ring, UringIORequest* reqs, int nreqs, int inflight, unsigned to_submit)
+{
+    if ((unsigned)inflight != to_submit) {
+        ereport(PANIC, (errmsg("io_uring_enter failed with %d requests in flight: %m", inflight - (int)to_submit)));
+    }
+    ereport(LOG, (errmsg("io_uring_enter failed, using synchronous I/O: %m")));
+
+    UringUnmap(ring);
+    pfree(ring);
+    t_uring = NULL;
+    t_uring_unavailable = true;
+
+    for (int i = 0; i < nreqs; i++) {
+        if (reqs[i].err == EINPROGRESS) {
+            UringSyncIO(&reqs[i], 0);
+        }
+    }
+}
+
+#endif /* USE_IO_URING */
+
+/*
+ * @Description: whether the I/O of this thread goes through io_uring. The
+ *     ring of the thread is created by the first call with enable_io_uring
+ *     on, and it is not if the kernel does not support io_uring.
+ */
+bool UringEnabled(void)
+{
+#ifdef USE_IO_URING
+    return u_sess->attr.attr_storage.enable_io_uring && UringGetRing() != NULL;
+#else
+    return false;
+#endif
+}
+
+/*
+ * @Description: perform a batch of positional reads and writes, submitting
+ *     them with as few system calls as possible, and wait for all of them.
+ *     The result of every request is set, failures are not reported here.
+ * @in reqs: the requests
+ * @in nreqs: number of requests
+ */
+void UringPIOBatch(UringIORequest* reqs, int nreqs)
+{
+#ifdef USE_IO_URING
+    UringRing* ring = NULL;
+    int free_slots[URING_QUEUE_DEPTH];
+    int nfree = 0;
+    int next = 0;
+    int inflight = 0;
+    unsigned to_submit = 0;
+
+    /* a ring saves nothing for a single request */
+    if (nreqs > 1 && UringEnabled()) {
+        ring = t_uring;
+    } else if (nreqs == 1 && t_uring != NULL && u_sess->attr.attr_storage.enable_io_uring &&
+               UringFindFixed(t_uring, reqs[0].buf, reqs[0].len) >= 0) {
+        ring = t_uring;
+    }
+
+    if (ring != NULL) {
+        for (int i = 0; i < nreqs; i++) {
+            reqs[i].result = -1;
+            reqs[i].err = EINPROGRESS;
+        }
+        for (int i = URING_QUEUE_DEPTH - 1; i >= 0; i--) {
+            free_slots[nfree++] = i;
+        }
+
+        while (next < nreqs || inflight > 0) {
+            while (next < nreqs && nfree > 0) {
+                UringPrep(ring, &reqs[next], next, free_slots[--nfree]);
+                next++;
+                inflight++;
+                to_submit++;
+            }
+
+            int ret = (int)syscall(__NR_io_uring_enter, ring->fd, to_submit, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+            if (ret < 0) {
+                if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                    UringFail(ring, reqs, nreqs, inflight, to_submit);
+                    return;
+                }
+            } else {
+                to_submit -= (unsigned)ret;
+            }
+            inflight -= UringReap(ring, reqs, free_slots, &nfree);
+        }
+        return;
+    }
+#endif
+
+    for (int i = 0; i < nreqs; i++) {
+        UringSyncIO(&reqs[i], 0);
+    }
+}
+
+/*
+ * @Description: pwrite() going through the ring of the thread when buf is a
+ *     registered buffer. Returns like pwrite(), except that a short write is
+ *     continued.
+ */
+ssize_t UringPWrite(int fd, const char* buf, size_t len, off_t offset)
+{
+    UringIORequest req;
+
+    req.fd = fd;
+    req.is_write = true;
+    req.buf = (char*)buf;
+    req.len = len;
+    req.offset = offset;
+    UringPIOBatch(&req, 1);
+    errno = (req.result < 0) ? req.err : 0;
+    return req.result;
+}
+
+/*
+ * @Description: register memory the thread does I/O from with its ring,
+ *     replacing the buffers registered before. Failure, which is reported
+ *     to the log, only means that the requests don't use fixed buffers.
+ * @in bases: start of each memory region
+ * @in lens: length of each memory region
+ * @in nregions: number of memory regions
+ * @return: whether the buffers are registered
+ */
+bool UringRegisterBuffers(char** bases, const Size* lens, int nregions)
+{
+#ifdef USE_IO_URING
+    struct iovec fixed[URING_MAX_FIXED];
+    int nfixed = 0;
+
+    if (!UringEnabled()) {
+        return false;
+    }
+    UringUnregisterBuffers();
+
+    for (int i = 0; i < nregions; i++) {
+        for (Size off = 0; off < lens[i]; off += URING_MAX_FIXED_SIZE) {
+            if (nfixed == URING_MAX_FIXED) {
+                ereport(LOG, (errmsg("too many buffers to register with io_uring")));
+                return false;
+            }
+            fixed[nfixed].iov_base = bases[i] + off;
+            fixed[nfixed].iov_len = Min(lens[i] - off, URING_MAX_FIXED_SIZE);
+            nfixed++;
+        }
+    }
+
+    if (syscall(__NR_io_uring_register, t_uring->fd, IORING_REGISTER_BUFFERS, fixed, nfixed) < 0) {
+        ereport(LOG, (errmsg("could not register buffers with io_uring: %m")));
+        return false;
+    }
+    errno_t rc = memcpy_s(t_uring->fixed, sizeof(t_uring->fixed), fixed, sizeof(struct iovec) * nfixed);
+    securec_check(rc, "\0", "\0");
+    t_uring->nfixed = nfixed;
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*
+ * @Description: unregister the buffers registered by UringRegisterBuffers,
+ *     to be called before they are freed.
+ */
+void UringUnregisterBuffers(void)
+{
+#ifdef USE_IO_URING
+    if (t_uring == NULL || t_uring->nfixed == 0) {
+        return;
+    }
+    (void)syscall(__NR_io_uring_register, t_uring->fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+    t_uring->nfixed = 0;
+#endif
+}
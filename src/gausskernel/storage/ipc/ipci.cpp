@@ -62,6 +62,7 @@
 #include "storage/cstorealloc.h"
 #include "storage/cucache_mgr.h"
 #include "storage/dfs/dfs_connector.h"
+#include "utils/globalcatcache.h"
 #include "utils/memprot.h"
 
 /* we use semaphore not LWLOCK, because when thread InitGucConfig, it does not get a t_thrd.proc */
@@ -285,6 +286,13 @@ void CreateSharedMemoryAndSemaphores(bool makePrivate, int port)
      */
     CreateSharedInvalidationState();
 
+    /*
+     * Set up the global catalog cache, emptied after a crash of the backends
+     */
+    if (!IsUnderPostmaster) {
+        GlobalCatCacheInit();
+    }
+
     /*
      * Set up interprocess signaling mechanisms
      */
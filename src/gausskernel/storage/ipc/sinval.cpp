@@ -21,6 +21,7 @@
 #include "miscadmin.h"
 #include "storage/ipc.h"
 #include "storage/sinvaladt.h"
+#include "utils/globalcatcache.h"
 #include "utils/globalplancache.h"
 #include "utils/inval.h"
 #include "utils/plancache.h"
@@ -48,6 +49,10 @@ void SendSharedInvalidMessages(const SharedInvalidationMessage* msgs, int n)
 {
     SIInsertDataEntries(msgs, n);
 
+    if (ENABLE_GLOBAL_CATCACHE) {
+        GlobalCatCacheInvalidate(msgs, n);
+    }
+
     if (ENABLE_DN_GPC) {
         GPC->InvalMsg(msgs, n);
     }
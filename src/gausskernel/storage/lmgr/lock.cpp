@@ -132,21 +132,37 @@ typedef struct TwoPhaseLockRecord {
     LOCKMODE lockmode;
 } TwoPhaseLockRecord;
 
-/* Macros for manipulating proc->fpLockBits */
+/*
+ * Macros for manipulating proc->fpLockBits.  Slot n lives in group
+ * n / FP_LOCK_SLOTS_PER_GROUP, whose lock modes are packed in one word.
+ */
 #define FAST_PATH_BITS_PER_SLOT 3
 #define FAST_PATH_LOCKNUMBER_OFFSET 1
 #define FAST_PATH_MASK ((1 << FAST_PATH_BITS_PER_SLOT) - 1)
-#define FAST_PATH_GET_BITS(proc, n) (((proc)->fpLockBits >> (FAST_PATH_BITS_PER_SLOT * (n))) & FAST_PATH_MASK)
+#define FAST_PATH_GROUP(n) ((n) / FP_LOCK_SLOTS_PER_GROUP)
+#define FAST_PATH_INDEX(n) ((n) % FP_LOCK_SLOTS_PER_GROUP)
+#define FAST_PATH_SLOT(group, index) ((group) * FP_LOCK_SLOTS_PER_GROUP + (index))
+#define FAST_PATH_BITS(proc, n) ((proc)->fpLockBits[FAST_PATH_GROUP(n)])
+#define FAST_PATH_GET_BITS(proc, n) \
+    ((FAST_PATH_BITS(proc, n) >> (FAST_PATH_BITS_PER_SLOT * FAST_PATH_INDEX(n))) & FAST_PATH_MASK)
 #define FAST_PATH_BIT_POSITION(n, l)                                           \
     (AssertMacro((l) >= FAST_PATH_LOCKNUMBER_OFFSET),                          \
      AssertMacro((l) < FAST_PATH_BITS_PER_SLOT + FAST_PATH_LOCKNUMBER_OFFSET), \
-     AssertMacro((n) < FP_LOCK_SLOTS_PER_BACKEND), ((l)-FAST_PATH_LOCKNUMBER_OFFSET + FAST_PATH_BITS_PER_SLOT * (n)))
+     AssertMacro((n) < FP_LOCK_SLOTS_PER_BACKEND),                             \
+     ((l)-FAST_PATH_LOCKNUMBER_OFFSET + FAST_PATH_BITS_PER_SLOT * FAST_PATH_INDEX(n)))
 #define FAST_PATH_SET_LOCKMODE(proc, n, l) \
-    (proc)->fpLockBits |= UINT64CONST(UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l))
+    FAST_PATH_BITS(proc, n) |= UINT64CONST(UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l))
 #define FAST_PATH_CLEAR_LOCKMODE(proc, n, l) \
-    (proc)->fpLockBits &= ~(UINT64CONST(UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l)))
+    FAST_PATH_BITS(proc, n) &= ~(UINT64CONST(UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l)))
 #define FAST_PATH_CHECK_LOCKMODE(proc, n, l) \
-    ((proc)->fpLockBits & (UINT64CONST(UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l))))
+    (FAST_PATH_BITS(proc, n) & (UINT64CONST(UINT64CONST(1) << FAST_PATH_BIT_POSITION(n, l))))
+
+/*
+ * The group a relation's fast-path lock goes to.  Partitions hash with their
+ * own OID, so the partitions of one table spread over all the groups.
+ */
+#define FAST_PATH_REL_GROUP(relid, partitionid) \
+    ((uint32)((((uint64)(relid) ^ (partitionid)) * UINT64CONST(49157)) % FP_LOCK_GROUPS_PER_BACKEND))
 
 #define PRINT_WAIT_LENTH (8 + 1)
 
@@ -205,6 +221,10 @@ static PROCLOCK *FastPathGetRelationLockEntry(LOCALLOCK *locallock);
 typedef struct FastPathStrongRelationLockData {
     slock_t mutex;
     uint32 count[FAST_PATH_STRONG_LOCK_HASH_PARTITIONS];
+    /* kept off the cache lines read by every fast-path acquisition */
+    char pad[PG_CACHE_LINE_SIZE];
+    /* weak relation locks that found their fast-path group full */
+    pg_atomic_uint64 overflowCount;
 } FastPathStrongRelationLockData;
 
 static LockAcquireResult LockAcquireExtendedXC(const LOCKTAG *locktag, LOCKMODE lockmode, bool sessionLock,
@@ -348,8 +368,10 @@ void InitLocks(void)
     t_thrd.storage_cxt.FastPathStrongRelationLocks =
         (FastPathStrongRelationLockData *)ShmemInitStruct("Fast Path Strong Relation Lock Data",
                                                           sizeof(FastPathStrongRelationLockData), &found);
-    if (!found)
+    if (!found) {
         SpinLockInit(&t_thrd.storage_cxt.FastPathStrongRelationLocks->mutex);
+        pg_atomic_init_u64(&t_thrd.storage_cxt.FastPathStrongRelationLocks->overflowCount, 0);
+    }
 
     /*
      * Allocate non-shared hash table for LOCALLOCK structs.  This stores lock
@@ -751,16 +773,19 @@ static LockAcquireResult LockAcquireExtendedXC(const LOCKTAG *locktag, LOCKMODE
 
     /*
      * Attempt to take lock via fast path, if eligible.  But if we remember
-     * having filled up the fast path array, we don't attempt to make any
-     * further use of it until we release some locks.  It's possible that some
-     * other backend has transferred some of those locks to the shared hash
-     * table, leaving space free, but it's not worth acquiring the LWLock just
-     * to check.  It's also possible that we're acquiring a second or third
-     * lock type on a relation we have already locked using the fast-path, but
-     * for now we don't worry about that case either.
+     * having filled up the relation's fast path group, we don't attempt to
+     * make any further use of it until we release some locks.  It's possible
+     * that some other backend has transferred some of those locks to the
+     * shared hash table, leaving space free, but it's not worth acquiring the
+     * LWLock just to check.  It's also possible that we're acquiring a second
+     * or third lock type on a relation we have already locked using the
+     * fast-path, but for now we don't worry about that case either.
      */
     if (EligibleForRelationFastPath(locktag, lockmode) &&
-        t_thrd.storage_cxt.FastPathLocalUseCount < FP_LOCK_SLOTS_PER_BACKEND) {
+        t_thrd.storage_cxt.FastPathLocalUseCounts[FAST_PATH_REL_GROUP(locktag->locktag_field2,
+        locktag->locktag_field3)] >= FP_LOCK_SLOTS_PER_GROUP) {
+        pg_atomic_fetch_add_u64(&t_thrd.storage_cxt.FastPathStrongRelationLocks->overflowCount, 1);
+    } else if (EligibleForRelationFastPath(locktag, lockmode)) {
         uint32 fasthashcode = FastPathStrongLockHashPartition(hashcode);
         bool acquired = false;
 
@@ -1845,7 +1870,9 @@ bool LockRelease(const LOCKTAG *locktag, LOCKMODE lockmode, bool sessionLock)
         return TRUE;
 
     /* Attempt fast release of any lock eligible for the fast path. */
-    if (EligibleForRelationFastPath(locktag, lockmode) && t_thrd.storage_cxt.FastPathLocalUseCount > 0) {
+    if (EligibleForRelationFastPath(locktag, lockmode) &&
+        t_thrd.storage_cxt.FastPathLocalUseCounts[FAST_PATH_REL_GROUP(locktag->locktag_field2,
+        locktag->locktag_field3)] > 0) {
         bool released = false;
         FastPathTag tag = { locktag->locktag_field1, locktag->locktag_field2, locktag->locktag_field3 };
 
@@ -2172,9 +2199,11 @@ void Check_FastpathBit()
             leaked = true;
         }
     }
-    /* reset fastpath bit num and use count, also report leak */
-    t_thrd.storage_cxt.FastPathLocalUseCount = 0;
-    t_thrd.proc->fpLockBits = 0;
+    /* reset fastpath bit num and use counts, also report leak */
+    for (f = 0; f < FP_LOCK_GROUPS_PER_BACKEND; f++) {
+        t_thrd.storage_cxt.FastPathLocalUseCounts[f] = 0;
+        t_thrd.proc->fpLockBits[f] = 0;
+    }
     if (leaked == true)
         ereport(WARNING, (errmsg("Fast path bit num leak.")));
 }
@@ -2322,15 +2351,19 @@ void LockReassignCurrentOwner(void)
 
 /*
  * FastPathGrantRelationLock
- *		Grant lock using per-backend fast-path array, if there is space.
+ *		Grant lock using the relation's group of the per-backend fast-path
+ *		array, if there is space.
  */
 static bool FastPathGrantRelationLock(const FastPathTag &tag, LOCKMODE lockmode)
 {
-    uint32 f;
+    uint32 i;
+    uint32 group = FAST_PATH_REL_GROUP(tag.relid, tag.partitionid);
     uint32 unused_slot = FP_LOCK_SLOTS_PER_BACKEND;
 
     /* Scan for existing entry for this relid, remembering empty slot. */
-    for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; f++) {
+    for (i = 0; i < FP_LOCK_SLOTS_PER_GROUP; i++) {
+        uint32 f = FAST_PATH_SLOT(group, i);
+
         if (FAST_PATH_GET_BITS(t_thrd.proc, f) == 0)
             unused_slot = f;
         else if (FAST_PATH_TAG_EQUALS(t_thrd.proc->fpRelId[f], tag)) {
@@ -2344,11 +2377,12 @@ static bool FastPathGrantRelationLock(const FastPathTag &tag, LOCKMODE lockmode)
     if (unused_slot < FP_LOCK_SLOTS_PER_BACKEND) {
         t_thrd.proc->fpRelId[unused_slot] = tag;
         FAST_PATH_SET_LOCKMODE(t_thrd.proc, unused_slot, lockmode);
-        ++t_thrd.storage_cxt.FastPathLocalUseCount;
+        ++t_thrd.storage_cxt.FastPathLocalUseCounts[group];
         return true;
     }
 
-    /* No existing entry, and no empty slot. */
+    /* No existing entry, and no empty slot in the group. */
+    pg_atomic_fetch_add_u64(&t_thrd.storage_cxt.FastPathStrongRelationLocks->overflowCount, 1);
     return false;
 }
 
@@ -2359,19 +2393,22 @@ static bool FastPathGrantRelationLock(const FastPathTag &tag, LOCKMODE lockmode)
  */
 static bool FastPathUnGrantRelationLock(const FastPathTag &tag, LOCKMODE lockmode)
 {
-    uint32 f;
+    uint32 i;
+    uint32 group = FAST_PATH_REL_GROUP(tag.relid, tag.partitionid);
     bool result = false;
 
-    t_thrd.storage_cxt.FastPathLocalUseCount = 0;
-    for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; f++) {
+    t_thrd.storage_cxt.FastPathLocalUseCounts[group] = 0;
+    for (i = 0; i < FP_LOCK_SLOTS_PER_GROUP; i++) {
+        uint32 f = FAST_PATH_SLOT(group, i);
+
         if (FAST_PATH_TAG_EQUALS(t_thrd.proc->fpRelId[f], tag) && FAST_PATH_CHECK_LOCKMODE(t_thrd.proc, f, lockmode)) {
             Assert(!result);
             FAST_PATH_CLEAR_LOCKMODE(t_thrd.proc, f, lockmode);
             result = true;
-            /* we continue iterating so as to update FastPathLocalUseCount */
+            /* we continue iterating so as to update FastPathLocalUseCounts */
         }
         if (FAST_PATH_GET_BITS(t_thrd.proc, f) != 0)
-            ++t_thrd.storage_cxt.FastPathLocalUseCount;
+            ++t_thrd.storage_cxt.FastPathLocalUseCounts[group];
     }
     return result;
 }
@@ -2387,6 +2424,7 @@ static bool FastPathTransferRelationLocks(LockMethod lockMethodTable, const LOCK
 {
     LWLock *partitionLock = LockHashPartitionLock(hashcode);
     FastPathTag tag = { locktag->locktag_field1, locktag->locktag_field2, locktag->locktag_field3 };
+    uint32 group = FAST_PATH_REL_GROUP(tag.relid, tag.partitionid);
     uint32 i;
 
     /*
@@ -2397,11 +2435,13 @@ static bool FastPathTransferRelationLocks(LockMethod lockMethodTable, const LOCK
      */
     for (i = 0; i < g_instance.proc_base->allNonPreparedProcCount; i++) {
         PGPROC *proc = g_instance.proc_base_all_procs[i];
-        uint32 f;
+        uint32 j;
 
         LWLockAcquire(proc->backendLock, LW_EXCLUSIVE);
 
-        for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; f++) {
+        /* The relation can only be in its own group of each backend. */
+        for (j = 0; j < FP_LOCK_SLOTS_PER_GROUP; j++) {
+            uint32 f = FAST_PATH_SLOT(group, j);
             uint32 lockmode;
 
             /* Look for an allocated slot matching the given relid. */
@@ -2446,11 +2486,13 @@ static PROCLOCK *FastPathGetRelationLockEntry(LOCALLOCK *locallock)
     PROCLOCK *proclock = NULL;
     LWLock *partitionLock = LockHashPartitionLock(locallock->hashcode);
     FastPathTag tag = { locktag->locktag_field1, locktag->locktag_field2, locktag->locktag_field3 };
-    uint32 f;
+    uint32 group = FAST_PATH_REL_GROUP(tag.relid, tag.partitionid);
+    uint32 i;
 
     LWLockAcquire(t_thrd.proc->backendLock, LW_EXCLUSIVE);
 
-    for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; f++) {
+    for (i = 0; i < FP_LOCK_SLOTS_PER_GROUP; i++) {
+        uint32 f = FAST_PATH_SLOT(group, i);
         uint32 lockmode;
 
         /* Look for an allocated slot matching the given relid. */
@@ -2568,6 +2610,7 @@ VirtualTransactionId *GetLockConflicts(const LOCKTAG *locktag, LOCKMODE lockmode
     if (ConflictsWithRelationFastPath(locktag, lockmode)) {
         int i;
         FastPathTag tag = { locktag->locktag_field1, locktag->locktag_field2, locktag->locktag_field3 };
+        uint32 group = FAST_PATH_REL_GROUP(tag.relid, tag.partitionid);
         VirtualTransactionId vxid;
 
         /*
@@ -2582,7 +2625,7 @@ VirtualTransactionId *GetLockConflicts(const LOCKTAG *locktag, LOCKMODE lockmode
          */
         for (i = 0; (unsigned int)(i) < g_instance.proc_base->allNonPreparedProcCount; i++) {
             PGPROC *proc = g_instance.proc_base_all_procs[i];
-            uint32 f;
+            uint32 j;
 
             /* A backend never blocks itself */
             if (proc == t_thrd.proc)
@@ -2590,7 +2633,8 @@ VirtualTransactionId *GetLockConflicts(const LOCKTAG *locktag, LOCKMODE lockmode
 
             LWLockAcquire(proc->backendLock, LW_SHARED);
 
-            for (f = 0; f < FP_LOCK_SLOTS_PER_BACKEND; f++) {
+            for (j = 0; j < FP_LOCK_SLOTS_PER_GROUP; j++) {
+                uint32 f = FAST_PATH_SLOT(group, j);
                 uint32 lockmask;
 
                 /* Look for an allocated slot matching the given relid. */
@@ -3115,6 +3159,16 @@ Size LockShmemSize(void)
     return size;
 }
 
+/*
+ * GetFastPathLockOverflowCount
+ *		Number of weak relation locks that had to use the main lock table
+ *		because their fast-path group was full.
+ */
+uint64 GetFastPathLockOverflowCount(void)
+{
+    return pg_atomic_read_u64(&t_thrd.storage_cxt.FastPathStrongRelationLocks->overflowCount);
+}
+
 /*
  * GetLockStatusData - Return a summary of the lock manager's internal
  * status, for use in a user-level reporting function.
@@ -90,6 +90,8 @@
 #include "storage/spin.h"
 #include "storage/cucache_mgr.h"
 #include "utils/atomic.h"
+#include "utils/builtins.h"
+#include "utils/timestamp.h"
 #include "instruments/instr_event.h"
 #include "tsan_annotation.h"
 
@@ -108,6 +110,16 @@
 
 #define LWLOCK_TRANCHE_SIZE 128
 
+/*
+ * Adaptive spinning.  Each lock keeps its own budget of polls between the
+ * first failed attempt and queueing: it grows by LWLOCK_SPINS_STEP each time
+ * spinning wins the lock and halves when the budget runs out, so locks held
+ * across I/O or long scans soon go straight to sleeping.
+ */
+#define LWLOCK_SPINS_INIT 32
+#define LWLOCK_SPINS_MIN 4
+#define LWLOCK_SPINS_STEP 16
+
 const char **LWLockTrancheArray = NULL;
 int LWLockTranchesAllocated = 0;
 
@@ -137,6 +149,7 @@ static const char *BuiltinTrancheNames[] = {
     "InstrUserLockId",
     "GPCMappingLock",
     "GPCPrepareMappingLock",
+    "GlobalCatCacheLock",
     "BufferIOLock",
     "BufferContentLock",
     "DataCacheLock",
@@ -164,6 +177,7 @@ static const char *BuiltinTrancheNames[] = {
 
 static void RegisterLWLockTranches(void);
 static void InitializeLWLocks(int numLocks);
+static void InitializeLWLockTrancheStats(void);
 extern void LWLockReportWaitStart(LWLock *);
 extern void LWLockReportWaitEnd(void);
 
@@ -362,8 +376,8 @@ int NumLWLocks(void)
         numLocks += 1;
     }
 
-    /* double write.c needs flush lock */
-    numLocks += 1;
+    /* double write.c needs one flush lock for each dw file, residual files of a larger dw_file_num included */
+    numLocks += DW_MAX_FILE_NUM;
 
     /*
      * Add any requested by loadable modules; for backwards-compatibility
@@ -409,6 +423,9 @@ Size LWLockShmemSize(void)
     /* Space for dynamic allocation counter, plus room for alignment. */
     size = add_size(size, 3 * sizeof(int) + LWLOCK_PADDED_SIZE);
 
+    /* Per-tranche statistics follow the LWLock array. */
+    size = add_size(size, mul_size(NUM_LWLOCK_STATS_SLOTS, sizeof(LWLockTrancheStatsPadded)));
+
     return size;
 }
 
@@ -443,6 +460,88 @@ void CreateLWLocks(void)
 
     InitializeLWLocks(numLocks);
     RegisterLWLockTranches();
+    InitializeLWLockTrancheStats();
+}
+
+/*
+ * Statistics slot of a tranche.  The slots sit right behind the last LWLock,
+ * whose position is given by the second dynamic-allocation counter.
+ */
+static inline LWLockTrancheStats *LWLockStatsSlot(int slot)
+{
+    int *LWLockCounter = (int *)((char *)t_thrd.shemem_ptr_cxt.mainLWLockArray - 2 * sizeof(int));
+    LWLockTrancheStatsPadded *slots =
+        (LWLockTrancheStatsPadded *)(t_thrd.shemem_ptr_cxt.mainLWLockArray + LWLockCounter[1]);
+
+    return &slots[slot].stats;
+}
+
+static inline LWLockTrancheStats *LWLockGetStats(const LWLock *lock)
+{
+    return LWLockStatsSlot((lock->tranche < LWTRANCHE_NATIVE_TRANCHE_NUM) ? lock->tranche
+                                                                           : NUM_LWLOCK_STATS_SLOTS - 1);
+}
+
+/*
+ * Zero the tranche statistics and mark the tranches named in
+ * lwlock_queue_tranches.  The list syntax was checked by the GUC hook, only
+ * the names are checked here, against the tranches registered above.
+ */
+static void InitializeLWLockTrancheStats(void)
+{
+    char *rawstring = NULL;
+    List *elemlist = NIL;
+    ListCell *l = NULL;
+    errno_t rc;
+
+    rc = memset_s(LWLockStatsSlot(0), NUM_LWLOCK_STATS_SLOTS * sizeof(LWLockTrancheStatsPadded), 0,
+                  NUM_LWLOCK_STATS_SLOTS * sizeof(LWLockTrancheStatsPadded));
+    securec_check(rc, "\0", "\0");
+
+    if (g_instance.attr.attr_storage.lwlock_queue_tranches == NULL) {
+        return;
+    }
+
+    rawstring = pstrdup(g_instance.attr.attr_storage.lwlock_queue_tranches);
+    (void)SplitIdentifierString(rawstring, ',', &elemlist);
+    foreach (l, elemlist) {
+        char *name = (char *)lfirst(l);
+        bool found = false;
+
+        for (int i = 0; i < LWTRANCHE_NATIVE_TRANCHE_NUM; i++) {
+            if (LWLockTrancheArray[i] != NULL && pg_strcasecmp(name, LWLockTrancheArray[i]) == 0) {
+                LWLockStatsSlot(i)->queueMode = true;
+                found = true;
+            }
+        }
+        if (!found) {
+            ereport(WARNING, (errmsg("unrecognized LWLock tranche \"%s\" in \"lwlock_queue_tranches\"", name)));
+        }
+    }
+
+    pfree(rawstring);
+    list_free(elemlist);
+}
+
+/*
+ * Return the statistics of one slot for reporting, with the name of its
+ * tranche, or NULL past the last slot or for unused tranche IDs.
+ */
+LWLockTrancheStats *GetLWLockTrancheStats(int slot, const char **name)
+{
+    if (slot < 0 || slot >= NUM_LWLOCK_STATS_SLOTS) {
+        return NULL;
+    }
+
+    if (slot == NUM_LWLOCK_STATS_SLOTS - 1) {
+        *name = "extension";
+    } else if (LWLockTrancheArray[slot] != NULL) {
+        *name = LWLockTrancheArray[slot];
+    } else {
+        return NULL;
+    }
+
+    return LWLockStatsSlot(slot);
 }
 
 /*
@@ -520,6 +619,10 @@ static void InitializeLWLocks(int numLocks)
         LWLockInitialize(&lock->lock, LWTRANCHE_GPC_PREPARE_MAPPING);
     }
 
+    for (id = 0; id < NUM_GLOBAL_CATCACHE_PARTITIONS; id++, lock++) {
+        LWLockInitialize(&lock->lock, LWTRANCHE_GLOBAL_CATCACHE);
+    }
+
     Assert((lock - t_thrd.shemem_ptr_cxt.mainLWLockArray) == NumFixedLWLocks);
 
     for (id = NumFixedLWLocks; id < numLocks; id++, lock++) {
@@ -669,9 +772,47 @@ void LWLockInitialize(LWLock *lock, int tranche_id)
     pg_atomic_init_u32(&lock->nwaiters, 0);
 #endif
     lock->tranche = tranche_id;
+    lock->spin_budget = LWLOCK_SPINS_INIT;
     dlist_init(&lock->waiters);
 }
 
+/*
+ * Sessions can be detached from pool workers, so lock code running without
+ * one falls back to plain queueing and no timing.
+ */
+static inline int LWLockSpinLimit(void)
+{
+    return (u_sess != NULL) ? u_sess->attr.attr_storage.lwlock_spin_limit : 0;
+}
+
+static inline bool LWLockTimingEnabled(void)
+{
+    return u_sess != NULL && u_sess->attr.attr_common.track_lwlock_timing;
+}
+
+/* Count a wait or hold time that started at 'start' in a histogram. */
+static void LWLockCountTime(pg_atomic_uint64 *hist, int64 start)
+{
+    int64 usecs = GetCurrentTimestamp() - start;
+    int bucket = 0;
+
+    while (usecs > 0 && bucket < LWLOCK_TIME_BUCKETS - 1) {
+        usecs >>= 1;
+        bucket++;
+    }
+    (void)pg_atomic_fetch_add_u64(&hist[bucket], 1);
+}
+
+/* Add a lock we just got to the list of locks held by this backend. */
+static inline void LWLockRememberHeld(LWLock *lock, LWLockMode mode)
+{
+    LWLockHandle *handle = &t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks++];
+
+    handle->lock = lock;
+    handle->mode = mode;
+    handle->acquireTime = LWLockTimingEnabled() ? GetCurrentTimestamp() : 0;
+}
+
 static void LWThreadSuicide(PGPROC *proc, int extraWaits, LWLock *lock, LWLockMode mode)
 {
     if (!proc->lwIsVictim) {
@@ -695,10 +836,11 @@ static void LWThreadSuicide(PGPROC *proc, int extraWaits, LWLock *lock, LWLockMo
 /*
  * Internal function that tries to atomically acquire the lwlock in the passed
  * in mode. This function will not block waiting for a lock to become free - that's the
- * callers job.
+ * callers job.  With queueOrder, the lock counts as busy as long as anybody
+ * is queued on it, see LWLockReleaseInQueueOrder().
  * Returns true if the lock isn't free and we need to wait.
  */
-static bool LWLockAttemptLock(LWLock *lock, LWLockMode mode)
+static bool LWLockAttemptLock(LWLock *lock, LWLockMode mode, bool queueOrder = false)
 {
     uint32 old_state;
 
@@ -729,6 +871,11 @@ static bool LWLockAttemptLock(LWLock *lock, LWLockMode mode)
             }
         }
 
+        if (queueOrder && (old_state & LW_FLAG_HAS_WAITERS)) {
+            lock_free = false;
+            desired_state = old_state;
+        }
+
         /*
          * Attempt to swap in the state we are expecting. If we didn't see
          * lock to be free, that's just the old value. If we saw it as free,
@@ -763,6 +910,35 @@ static bool LWLockAttemptLock(LWLock *lock, LWLockMode mode)
     }
 }
 
+/*
+ * Poll a lock that was just found busy for up to its spin budget before the
+ * caller queues and sleeps on its semaphore.  Only the cheap state read is
+ * repeated until the lock looks free, so spinners don't keep the cache line
+ * bouncing.  The budget is updated without locking; it is just a hint.
+ * Returns true if the lock was acquired.
+ */
+static bool LWLockSpinAcquire(LWLock *lock, LWLockMode mode, int limit, LWLockTrancheStats *stats)
+{
+    int budget = Min((int)lock->spin_budget, limit);
+    uint32 busy = (mode == LW_EXCLUSIVE) ? LW_LOCK_MASK : LW_VAL_EXCLUSIVE;
+
+    for (int spins = 0; spins < budget; spins++) {
+        SPIN_DELAY();
+        if ((pg_atomic_read_u32(&lock->state) & busy) != 0) {
+            continue;
+        }
+        if (!LWLockAttemptLock(lock, mode)) {
+            lock->spin_budget = (uint16)Min(budget + LWLOCK_SPINS_STEP, limit);
+            (void)pg_atomic_fetch_add_u64(&stats->spinAcquired, 1);
+            return true;
+        }
+    }
+
+    lock->spin_budget = (uint16)Max(budget / 2, LWLOCK_SPINS_MIN);
+    (void)pg_atomic_fetch_add_u64(&stats->spinFailed, 1);
+    return false;
+}
+
 /*
  * Lock the LWLock's wait list against concurrent activity.
  *
@@ -1078,6 +1254,193 @@ static void LWLockDequeueSelf(LWLock *lock, LWLockMode mode)
 #endif
 }
 
+/*
+ * Queue-mode counterpart of LWLockQueueSelf() and the recheck following it.
+ *
+ * Under the wait list lock, either take the lock if it is free and nobody
+ * else is queued for it, or set LW_FLAG_HAS_WAITERS and join the end of the
+ * queue.  Both are decided by one atomic update of the state, so a concurrent
+ * release either sees us queued and hands the lock over to the queue, or
+ * leaves it free for us to take here.  Unlike the recheck after queueing,
+ * this never overtakes backends already asleep on the lock.
+ *
+ * Returns true if we are queued and must wait.
+ */
+static bool LWLockQueueSelfOrLock(LWLock *lock, LWLockMode mode)
+{
+    uint32 old_state;
+    bool lockWaiters = false;
+    bool mustwait = false;
+    dlist_iter iter;
+
+    if (t_thrd.proc == NULL) {
+        ereport(PANIC, (errcode(ERRCODE_DATA_CORRUPTED), errmsg("cannot wait without a PGPROC structure")));
+    }
+
+    if (t_thrd.proc->lwWaiting) {
+        ereport(PANIC, (errcode(ERRCODE_DATA_CORRUPTED), errmsg("queueing for lock while waiting on another one")));
+    }
+
+    LWLockWaitListLock(lock);
+
+    /* backends only waiting for the lock to become free don't hold us back */
+    dlist_foreach(iter, &lock->waiters)
+    {
+        PGPROC *waiter = dlist_container(PGPROC, lwWaitLink, iter.cur);
+        if (waiter->lwWaitMode != LW_WAIT_UNTIL_FREE) {
+            lockWaiters = true;
+            break;
+        }
+    }
+
+    old_state = pg_atomic_read_u32(&lock->state);
+    while (true) {
+        uint32 desired_state = old_state;
+
+        if (mode == LW_EXCLUSIVE) {
+            mustwait = lockWaiters || ((old_state & LW_LOCK_MASK) != 0);
+        } else {
+            mustwait = lockWaiters || ((old_state & LW_VAL_EXCLUSIVE) != 0);
+        }
+
+        if (mustwait) {
+            desired_state |= LW_FLAG_HAS_WAITERS;
+        } else {
+            desired_state += (mode == LW_EXCLUSIVE) ? LW_VAL_EXCLUSIVE : LW_VAL_SHARED;
+        }
+
+        if (pg_atomic_compare_exchange_u32(&lock->state, &old_state, desired_state)) {
+            break;
+        }
+    }
+
+    if (mustwait) {
+        t_thrd.proc->lwWaiting = true;
+        t_thrd.proc->lwWaitMode = mode;
+        t_thrd.proc->lwGranted = false;
+        dlist_push_tail(&lock->waiters, &t_thrd.proc->lwWaitLink);
+    }
+
+    LWLockWaitListUnlock(lock);
+
+    if (mustwait) {
+#ifdef LOCK_DEBUG
+        pg_atomic_fetch_add_u32(&lock->nwaiters, 1);
+#endif
+    } else {
+        TsAnnotateRWLockAcquired(&lock->rwlock, (mode == LW_EXCLUSIVE) ? 1 : 0);
+#ifdef LOCK_DEBUG
+        if (mode == LW_EXCLUSIVE) {
+            lock->owner = t_thrd.proc;
+        }
+#endif
+    }
+
+    return mustwait;
+}
+
+/*
+ * Release a lock of a tranche listed in lwlock_queue_tranches.
+ *
+ * As long as backends are queued on such a lock it never becomes free: its
+ * last holder hands it over to the head of the queue, either the first
+ * exclusive waiter or the shared waiters up to the next exclusive one, and
+ * their releases do the same in turn.  Newcomers see LW_FLAG_HAS_WAITERS and
+ * queue behind them, so nobody cuts in while the woken waiters get to run.
+ * Backends only waiting for the lock to become free (LW_WAIT_UNTIL_FREE) are
+ * woken too, they recheck and queue again if they must.
+ *
+ * The caller has removed the lock from the locks held by this backend.
+ */
+static void LWLockReleaseInQueueOrder(LWLock *lock, LWLockMode mode)
+{
+    uint32 lockval = (mode == LW_EXCLUSIVE) ? LW_VAL_EXCLUSIVE : LW_VAL_SHARED;
+    uint32 grant = 0;
+    uint32 old_state;
+    dlist_head wakeup;
+    dlist_mutable_iter iter;
+
+    /* let go right away if nobody is queued, or other holders are left to hand over */
+    old_state = pg_atomic_read_u32(&lock->state);
+    while (!((old_state & LW_FLAG_HAS_WAITERS) && (old_state & LW_LOCK_MASK) == lockval)) {
+        if (pg_atomic_compare_exchange_u32(&lock->state, &old_state, old_state - lockval)) {
+            return;
+        }
+    }
+
+    dlist_init(&wakeup);
+
+    LWLockWaitListLock(lock);
+
+    /*
+     * Queued waiters keep LW_FLAG_HAS_WAITERS set, and nobody takes the lock
+     * past it, so as long as we are the last holder with that flag set, only
+     * the other flags can change under the wait list lock.  If a dequeue
+     * cleared it meanwhile, another shared holder may have come and hands the
+     * lock over in turn.
+     */
+    old_state = pg_atomic_read_u32(&lock->state);
+    if ((old_state & LW_FLAG_HAS_WAITERS) && (old_state & LW_LOCK_MASK) == lockval) {
+        dlist_foreach_modify(iter, &lock->waiters)
+        {
+            PGPROC *waiter = dlist_container(PGPROC, lwWaitLink, iter.cur);
+
+            if (waiter->lwWaitMode == LW_EXCLUSIVE) {
+                if (grant != 0) {
+                    break;
+                }
+                grant = LW_VAL_EXCLUSIVE;
+            } else if (waiter->lwWaitMode == LW_SHARED) {
+                grant += LW_VAL_SHARED;
+            }
+
+            waiter->lwGranted = (waiter->lwWaitMode != LW_WAIT_UNTIL_FREE);
+            dlist_delete(&waiter->lwWaitLink);
+            dlist_push_tail(&wakeup, &waiter->lwWaitLink);
+
+            if (grant == LW_VAL_EXCLUSIVE) {
+                break;
+            }
+        }
+    }
+
+    /* hand the lock over and unlock the wait list in one go */
+    TsAnnotateRWLockReleased(&lock->listlock, 1);
+    while (true) {
+        uint32 desired_state = old_state - lockval + grant;
+
+        if (dlist_is_empty(&lock->waiters)) {
+            desired_state &= ~LW_FLAG_HAS_WAITERS;
+        }
+        desired_state &= ~LW_FLAG_LOCKED;
+
+        if (pg_atomic_compare_exchange_u32(&lock->state, &old_state, desired_state)) {
+            break;
+        }
+    }
+
+    /* Awaken the waiters I removed from the queue, see LWLockWakeup(). */
+    dlist_foreach_modify(iter, &wakeup)
+    {
+        PGPROC *waiter = dlist_container(PGPROC, lwWaitLink, iter.cur);
+
+        LOG_LWDEBUG("LWLockRelease", lock, "hand over to waiter");
+        dlist_delete(&waiter->lwWaitLink);
+#ifdef LOCK_DEBUG
+        if (waiter->lwWaitMode == LW_EXCLUSIVE) {
+            lock->owner = waiter;
+        }
+#endif
+        pg_write_barrier();
+
+        /* ENABLE_THREAD_CHECK only, waiter->lwWaiting should not be reported race  */
+        TsAnnotateBenignRaceSized(&waiter->lwWaiting, sizeof(waiter->lwWaiting));
+
+        waiter->lwWaiting = false;
+        PGSemaphoreUnlock(&waiter->sem);
+    }
+}
+
 /*
  * Does the lwlock in its current state need to wait for the variable value to
  * change?
@@ -1140,6 +1503,10 @@ bool LWLockAcquire(LWLock *lock, LWLockMode mode, bool need_update_lockid)
     PGPROC *proc = t_thrd.proc;
     bool result = true;
     int extraWaits = 0;
+    LWLockTrancheStats *stats = LWLockGetStats(lock);
+    bool queueMode = stats->queueMode;
+    int spinLimit = -1;
+    int64 waitStart = 0;
 #ifdef LWLOCK_STATS
     lwlock_stats *lwstats = NULL;
 
@@ -1195,15 +1562,19 @@ bool LWLockAcquire(LWLock *lock, LWLockMode mode, bool need_update_lockid)
      * outweighs the inefficiency of sometimes wasting a process dispatch
      * cycle because the lock is not free when a released waiter finally gets
      * to run.	See pgsql-hackers archives for 29-Dec-01.
+     *
+     * Tranches listed in lwlock_queue_tranches trade that for fairness: their
+     * releasers do grant the lock to the head of the queue, see
+     * LWLockReleaseInQueueOrder().
      */
     for (;;) {
         bool mustwait = false;
 
         /*
          * Try to grab the lock the first time, we're not in the waitqueue
-         * yet/anymore.
+         * yet/anymore.  In queue mode, not while others are queued for it.
          */
-        mustwait = LWLockAttemptLock(lock, mode);
+        mustwait = LWLockAttemptLock(lock, mode, queueMode);
 
         if (!mustwait) {
             /* XXX: remove before commit? */
@@ -1211,6 +1582,23 @@ bool LWLockAcquire(LWLock *lock, LWLockMode mode, bool need_update_lockid)
             break; /* got the lock */
         }
 
+        /* Uncontended acquisitions never get here, nor touch the statistics. */
+        if (spinLimit < 0) {
+            spinLimit = queueMode ? 0 : LWLockSpinLimit();
+            if (LWLockTimingEnabled()) {
+                waitStart = GetCurrentTimestamp();
+            }
+        }
+
+        /*
+         * The holder is probably running on another core and about to let
+         * go, so poll for a while before paying for a sleep and wakeup.
+         */
+        if (spinLimit > 0 && LWLockSpinAcquire(lock, mode, spinLimit, stats)) {
+            LOG_LWDEBUG("LWLockAcquire", lock, "acquired by spinning");
+            break;
+        }
+
         /*
          * Ok, at this point we couldn't grab the lock on the first try. We
          * cannot simply queue ourselves to the end of the list and wait to be
@@ -1220,18 +1608,27 @@ bool LWLockAcquire(LWLock *lock, LWLockMode mode, bool need_update_lockid)
          * recheck the lock. If we still couldn't grab it, we know that the
          * other lock will see our queue entries when releasing since they
          * existed before we checked for the lock.
+         *
+         * In queue mode, both happen at once under the wait list lock.
          */
-        /* add to the queue */
-        LWLockQueueSelf(lock, mode);
+        if (queueMode) {
+            if (!LWLockQueueSelfOrLock(lock, mode)) {
+                LOG_LWDEBUG("LWLockAcquire", lock, "acquired, not queued");
+                break;
+            }
+        } else {
+            /* add to the queue */
+            LWLockQueueSelf(lock, mode);
 
-        mustwait = LWLockAttemptLock(lock, mode);
+            mustwait = LWLockAttemptLock(lock, mode);
 
-        /* ok, grabbed the lock the second time round, need to undo queueing */
-        if (!mustwait) {
-            LOG_LWDEBUG("LWLockAcquire", lock, "acquired, undoing queue");
+            /* ok, grabbed the lock the second time round, need to undo queueing */
+            if (!mustwait) {
+                LOG_LWDEBUG("LWLockAcquire", lock, "acquired, undoing queue");
 
-            LWLockDequeueSelf(lock, mode);
-            break;
+                LWLockDequeueSelf(lock, mode);
+                break;
+            }
         }
 
         if (need_update_lockid &&
@@ -1255,6 +1652,7 @@ bool LWLockAcquire(LWLock *lock, LWLockMode mode, bool need_update_lockid)
 #ifdef LWLOCK_STATS
         lwstats->block_count++;
 #endif
+        (void)pg_atomic_fetch_add_u64(&stats->blocked, 1);
 
         LWLockReportWaitStart(lock);
         TRACE_POSTGRESQL_LWLOCK_WAIT_START(T_NAME(lock), mode);
@@ -1290,15 +1688,25 @@ bool LWLockAcquire(LWLock *lock, LWLockMode mode, bool need_update_lockid)
 
         /* Now loop back and try to acquire lock again. */
         result = false;
+
+        /* unless the releaser handed the lock over to us */
+        pg_read_barrier();
+        if (queueMode && proc->lwGranted) {
+            TsAnnotateRWLockAcquired(&lock->rwlock, (mode == LW_EXCLUSIVE) ? 1 : 0);
+            LOG_LWDEBUG("LWLockAcquire", lock, "handed over");
+            break;
+        }
     }
 
     TRACE_POSTGRESQL_LWLOCK_ACQUIRE(T_NAME(lock), mode);
 
     forget_lwlock_acquire();
 
-    /* Add lock to list of locks held by this backend */
-    t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks].lock = lock;
-    t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks++].mode = mode;
+    if (waitStart != 0) {
+        LWLockCountTime(stats->waitTime, waitStart);
+    }
+
+    LWLockRememberHeld(lock, mode);
 
     /*
      * Fix the process wait semaphore's count for any absorbed wakeups.
@@ -1338,7 +1746,7 @@ bool LWLockConditionalAcquire(LWLock *lock, LWLockMode mode)
     HOLD_INTERRUPTS();
 
     /* Check for the lock */
-    mustwait = LWLockAttemptLock(lock, mode);
+    mustwait = LWLockAttemptLock(lock, mode, LWLockGetStats(lock)->queueMode);
 
     if (mustwait) {
         /* Failed to get lock, so release interrupt holdoff */
@@ -1346,9 +1754,7 @@ bool LWLockConditionalAcquire(LWLock *lock, LWLockMode mode)
         LOG_LWDEBUG("LWLockConditionalAcquire", lock, "failed");
         TRACE_POSTGRESQL_LWLOCK_CONDACQUIRE_FAIL(T_NAME(lock), mode);
     } else {
-        /* Add lock to list of locks held by this backend */
-        t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks].lock = lock;
-        t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks++].mode = mode;
+        LWLockRememberHeld(lock, mode);
         TRACE_POSTGRESQL_LWLOCK_CONDACQUIRE(T_NAME(lock), mode);
     }
     return !mustwait;
@@ -1382,6 +1788,15 @@ bool LWLockAcquireOrWait(LWLock *lock, LWLockMode mode)
 
     PRINT_LWDEBUG("LWLockAcquireOrWait", lock, mode);
 
+    /*
+     * In queue mode the lock is handed over from holder to waiter and need not
+     * become free in between, so just wait for our turn.
+     */
+    if (LWLockGetStats(lock)->queueMode) {
+        (void)LWLockAcquire(lock, mode);
+        return true;
+    }
+
     /* Ensure we will have room to remember the lock */
     if (t_thrd.storage_cxt.num_held_lwlocks >= MAX_SIMUL_LWLOCKS) {
         ereport(ERROR, (errcode(ERRCODE_LOCK_NOT_AVAILABLE), errmsg("too many LWLocks taken")));
@@ -1467,9 +1882,7 @@ bool LWLockAcquireOrWait(LWLock *lock, LWLockMode mode)
         TRACE_POSTGRESQL_LWLOCK_WAIT_UNTIL_FREE_FAIL(T_NAME(lock), mode);
     } else {
         LOG_LWDEBUG("LWLockAcquireOrWait", lock, "succeeded");
-        /* Add lock to list of locks held by this backend */
-        t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks].lock = lock;
-        t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks++].mode = mode;
+        LWLockRememberHeld(lock, mode);
         TRACE_POSTGRESQL_LWLOCK_WAIT_UNTIL_FREE(T_NAME(lock), mode);
     }
 
@@ -1693,6 +2106,9 @@ void LWLockRelease(LWLock *lock)
     if (i < 0) {
         ereport(ERROR, (errcode(ERRCODE_LOCK_NOT_AVAILABLE), errmsg("lock %s is not held", T_NAME(lock))));
     }
+    if (t_thrd.storage_cxt.held_lwlocks[i].acquireTime != 0) {
+        LWLockCountTime(LWLockGetStats(lock)->holdTime, t_thrd.storage_cxt.held_lwlocks[i].acquireTime);
+    }
     t_thrd.storage_cxt.num_held_lwlocks--;
     for (; i < t_thrd.storage_cxt.num_held_lwlocks; i++) {
         t_thrd.storage_cxt.held_lwlocks[i] = t_thrd.storage_cxt.held_lwlocks[i + 1];
@@ -1700,6 +2116,16 @@ void LWLockRelease(LWLock *lock)
 
     PRINT_LWDEBUG("LWLockRelease", lock, mode);
 
+    if (LWLockGetStats(lock)->queueMode) {
+        /* ENABLE_THREAD_CHECK only, Must release vector clock info to other
+         * threads before unlock */
+        TsAnnotateRWLockReleased(&lock->rwlock, (mode == LW_EXCLUSIVE) ? 1 : 0);
+        LWLockReleaseInQueueOrder(lock, mode);
+        TRACE_POSTGRESQL_LWLOCK_RELEASE(T_NAME(lock));
+        RESUME_INTERRUPTS();
+        return;
+    }
+
     /*
      * Release my hold on lock, after that it can immediately be acquired by
      * others, even if we still have to wakeup other waiters. */
@@ -1843,6 +2269,7 @@ void LWLockOwn(LWLock *lock)
         ereport(ERROR, (errcode(ERRCODE_LOCK_NOT_AVAILABLE), errmsg("lock %s is not held", T_NAME(lock))));
     }
 
+    t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks].acquireTime = 0;
     t_thrd.storage_cxt.held_lwlocks[t_thrd.storage_cxt.num_held_lwlocks++].lock = lock;
 
     HOLD_INTERRUPTS();
@@ -312,6 +312,18 @@ void InitProcGlobal(void)
     g_instance.proc_base->allPgXact =
         (PGXACT *)CACHELINEALIGN(palloc0(TotalProcs * sizeof(PGXACT) + PG_CACHE_LINE_SIZE));
 
+    /*
+     * The fast-path lock arrays are sized by fast_path_lock_groups, so they
+     * are carved out of one separate chunk: a word of lock bits per group,
+     * then the relation tags of all the slots.
+     */
+    Size fpLockBitsSize = MAXALIGN(FP_LOCK_GROUPS_PER_BACKEND * sizeof(uint64));
+    Size fpRelIdSize = MAXALIGN(FP_LOCK_SLOTS_PER_BACKEND * sizeof(FastPathTag));
+    char *fpPtr = (char *)palloc_huge(g_instance.instance_context, TotalProcs * (fpLockBitsSize + fpRelIdSize));
+    errno_t rc = memset_s(fpPtr, TotalProcs * (fpLockBitsSize + fpRelIdSize), 0,
+        TotalProcs * (fpLockBitsSize + fpRelIdSize));
+    securec_check(rc, "\0", "\0");
+
     for (i = 0; (unsigned int)(i) < TotalProcs; i++) {
         /* Common initialization for all PGPROCs, regardless of type.
          *
@@ -332,6 +344,10 @@ void InitProcGlobal(void)
         (void)syscalllockInit(&procs[i]->deleMemContextMutex);
         procs[i]->pgprocno = i;
         procs[i]->nodeno = i % nNumaNodes;
+        procs[i]->fpLockBits = (uint64 *)fpPtr;
+        fpPtr += fpLockBitsSize;
+        procs[i]->fpRelId = (FastPathTag *)fpPtr;
+        fpPtr += fpRelIdSize;
 
         /*
          * Newly created PGPROCs for normal backends, autovacuum and bgworkers must be
@@ -442,6 +458,7 @@ void InitProcess(void)
 {
     /* use volatile pointer to prevent code rearrangement */
     volatile PROC_HDR *procglobal = g_instance.proc_base;
+    errno_t rc = EOK;
 
     /*
      * ProcGlobal should be set up already (if we are a backend, we inherit
@@ -575,7 +592,9 @@ void InitProcess(void)
     t_thrd.proc->lxid = InvalidLocalTransactionId;
     t_thrd.proc->fpVXIDLock = false;
     t_thrd.proc->fpLocalTransactionId = InvalidLocalTransactionId;
-    t_thrd.proc->fpLockBits = 0;
+    rc = memset_s(t_thrd.proc->fpLockBits, FP_LOCK_GROUPS_PER_BACKEND * sizeof(uint64), 0,
+        FP_LOCK_GROUPS_PER_BACKEND * sizeof(uint64));
+    securec_check(rc, "\0", "\0");
     t_thrd.proc->commitCSN = 0;
     t_thrd.pgxact->handle = InvalidTransactionHandle;
     t_thrd.pgxact->xid = InvalidTransactionId;
@@ -604,6 +623,7 @@ void InitProcess(void)
     t_thrd.proc->lwWaiting = false;
     t_thrd.proc->lwWaitMode = 0;
     t_thrd.proc->lwIsVictim = false;
+    t_thrd.proc->lwGranted = false;
     t_thrd.proc->waitLock = NULL;
     t_thrd.proc->waitProcLock = NULL;
 #ifdef USE_ASSERT_CHECKING
@@ -623,6 +643,11 @@ void InitProcess(void)
     t_thrd.proc->syncRepInCompleteQueue = false;
     SHMQueueElemInit(&(t_thrd.proc->syncRepLinks));
 
+    /* Initialize fields for the commit flush wait queue */
+    t_thrd.proc->flushWaitLSN = InvalidXLogRecPtr;
+    t_thrd.proc->flushWaitDone = false;
+    SHMQueueElemInit(&(t_thrd.proc->flushWaitLinks));
+
     /* Initialize fields for data sync rep */
     t_thrd.proc->waitDataSyncPoint.queueid = 0;
     t_thrd.proc->waitDataSyncPoint.queueoff = 0;
@@ -810,6 +835,7 @@ void InitAuxiliaryProcess(void)
     t_thrd.proc->lwWaiting = false;
     t_thrd.proc->lwWaitMode = 0;
     t_thrd.proc->lwIsVictim = false;
+    t_thrd.proc->lwGranted = false;
     t_thrd.proc->waitLock = NULL;
     t_thrd.proc->waitProcLock = NULL;
     t_thrd.proc->workingVersionNum = pg_atomic_read_u32(&WorkingGrandVersionNum);
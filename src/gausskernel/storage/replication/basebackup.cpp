@@ -18,15 +18,20 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <time.h>
+#include <pthread.h>
+#include <signal.h>
 
+#include "access/cbmparsexlog.h"
 #include "access/xlog_internal.h" /* for pg_start/stop_backup */
 #include "catalog/catalog.h"
+#include "catalog/pg_tablespace.h"
 #include "catalog/pg_type.h"
 #include "lib/stringinfo.h"
 #include "libpq/libpq.h"
 #include "libpq/pqformat.h"
 #include "nodes/pg_list.h"
 #include "replication/basebackup.h"
+#include "replication/walprotocol.h"
 #include "replication/walsender.h"
 #include "replication/walsender_private.h"
 #include "replication/slot.h"
@@ -41,8 +46,10 @@
 #include "utils/memutils.h"
 #include "utils/ps_status.h"
 #include "utils/timestamp.h"
+#include "postmaster/postmaster.h"
 #include "postmaster/syslogger.h"
 #include "pgxc/pgxc.h"
+#include "lz4.h"
 
 /* t_thrd.proc_cxt.DataDir */
 #include "miscadmin.h"
@@ -54,6 +61,9 @@ typedef struct {
     bool nowait;
     bool includewal;
     bool sendtblspcmapfile;
+    int compression;        /* BaseBackupCompression of the tar streams */
+    int parallel;           /* number of threads reading the data files */
+    XLogRecPtr incremental; /* send only the blocks changed since, if valid */
 } basebackup_options;
 
 #define BUILD_PATH_LEN 2560 /* (MAXPGPATH*2 + 512) */
@@ -68,6 +78,96 @@ const int MATCH_SIX = 6;
  * Size of each block sent into the tar stream for larger files.
  */
 #define TAR_SEND_SIZE (32 * 1024) /* data send unit 32KB */
+
+/*
+ * Parallel base backup, option PARALLEL n.
+ *
+ * The members of the tar streams are still sent one after the other over
+ * the single replication connection, but the content of the data files is
+ * read, checksum-verified and compressed ahead by n reader threads, each of
+ * them working on a different chunk. The reader threads are plain threads
+ * which only read and compress: they never allocate memory nor report
+ * errors. The walsender collects the chunks in the order it queued them and
+ * reports the errors found by the readers.
+ *
+ * Without PARALLEL, the same code runs with no reader thread and a single
+ * chunk, read by the walsender itself.
+ */
+#define BASEBACKUP_MAX_PARALLEL 64
+#define BACKUP_CHUNKS_PER_READER 4
+#define BACKUP_PARALLEL_CHUNK_SIZE (TAR_SEND_SIZE * 8)
+#define BACKUP_CHECKSUM_MAX_RETRY 60
+
+/* how long an incremental backup waits for CBM to track its start lsn, in ms */
+#define BACKUP_CBM_TRACK_TIMEOUT 600000
+
+typedef enum {
+    BACKUP_CHUNK_FREE = 0,
+    BACKUP_CHUNK_QUEUED,
+    BACKUP_CHUNK_READING,
+    BACKUP_CHUNK_DONE
+} BackupChunkState;
+
+typedef struct BackupChunk {
+    BackupChunkState state;
+
+    /* set by the walsender when queueing the chunk */
+    int fd;
+    off_t offset;
+    size_t len;
+    bool verify;       /* verify the checksums of the pages */
+    BlockNumber blkno; /* block number of the first page, for the checksums */
+
+    /* set by the reader */
+    size_t nread;
+    int read_errno;
+    int bad_page; /* index of the page failing checksum verification, or -1 */
+    uint16 computed_checksum;
+    uint16 recorded_checksum;
+    size_t outlen; /* length of the framed data in out, when compressing */
+
+    char* buf; /* raw data */
+    char* out; /* BaseBackupDataHeader and payload, when compressing */
+} BackupChunk;
+
+typedef struct BackupReaderPool {
+    pthread_mutex_t lock;
+    pthread_cond_t queued; /* a chunk was queued, or the pool is stopping */
+    pthread_cond_t done;   /* a chunk was read */
+    bool stopping;
+
+    int compression;
+    size_t chunk_size;
+    int nthreads;
+    pthread_t* threads;
+    int nchunks;
+    BackupChunk* chunks;
+    uint64 head; /* next chunk to queue, advanced by the walsender */
+    uint64 next; /* next chunk to read, advanced by the readers */
+    uint64 tail; /* next chunk to send, advanced by the walsender */
+} BackupReaderPool;
+
+/* the data of the main fork of a relation is sent in pieces */
+typedef struct BackupRangeCursor {
+    size_t chunk_size;
+    pgoff_t size; /* whole file when blocks is NULL */
+    pgoff_t offset;
+    const BlockNumber* blocks; /* blocks changed since the incremental lsn */
+    uint32 nblocks;
+    uint32 next;
+} BackupRangeCursor;
+
+/* relations changed since the lsn of an incremental backup, hashed by relfilenode */
+typedef struct BackupChangedRelKey {
+    Oid spcNode;
+    Oid dbNode;
+    Oid relNode;
+} BackupChangedRelKey;
+
+typedef struct BackupChangedRel {
+    BackupChangedRelKey key;
+    CBMArrayEntry* changed;
+} BackupChangedRel;
 #define EREPORT_WAL_NOT_FOUND(segno)                                              \
     do {                                                                          \
         char walErrorName[MAXFNAMELEN];                                           \
@@ -80,6 +180,17 @@ XLogRecPtr XlogCopyStartPtr = InvalidXLogRecPtr;
 static int64 sendDir(
     const char* path, int basepathlen, bool sizeonly, List* tablespaces, bool sendtblspclinks, bool skipmot = true);
 static bool sendFile(char* readfilename, char* tarfilename, struct stat* statbuf, bool missing_ok);
+static void sendIncrementalFile(FILE* fp, const char* readfilename, const char* tarfilename, struct stat* statbuf,
+    int segNo, const CBMArrayEntry* changed);
+static pgoff_t BackupSendFileData(int fd, const char* readfilename, pgoff_t size, bool verify, int segNo,
+    const BlockNumber* blocks, uint32 nblocks);
+static void BaseBackupPutData(const char* data, size_t len);
+static void BackupSendZeros(size_t len);
+static BackupReaderPool* BackupReaderStart(int nthreads, int compression);
+static void BackupReaderStop(BackupReaderPool* pool);
+static void BackupResetState(void);
+static void BackupLoadChangedBlocks(XLogRecPtr incremental, XLogRecPtr startptr);
+static bool BackupGetChangedBlocks(const char* tarfilename, CBMArrayEntry** changed);
 static void sendFileWithContent(const char* filename, const char* content);
 static void _tarWriteHeader(const char* filename, const char* linktarget, struct stat* statbuf);
 static void send_int8_string(StringInfoData* buf, int64 intval);
@@ -211,6 +322,7 @@ static void send_xlog_location()
  */
 static void base_backup_cleanup(int code, Datum arg)
 {
+    BackupResetState();
     do_pg_abort_backup();
 }
 
@@ -223,6 +335,7 @@ static void base_backup_cleanup(int code, Datum arg)
 static void perform_base_backup(basebackup_options* opt, DIR* tblspcdir)
 {
     XLogRecPtr startptr;
+    XLogRecPtr backupstart;
     XLogRecPtr endptr;
     XLogRecPtr minlsn;
     char* labelfile = NULL;
@@ -240,6 +353,7 @@ static void perform_base_backup(basebackup_options* opt, DIR* tblspcdir)
         &tablespaces,
         opt->progress,
         opt->sendtblspcmapfile);
+    backupstart = startptr;
     /* Get the slot minimum LSN */
     ReplicationSlotsComputeRequiredXmin(false);
     ReplicationSlotsComputeRequiredLSN(NULL);
@@ -267,6 +381,15 @@ static void perform_base_backup(basebackup_options* opt, DIR* tblspcdir)
         ListCell* lc = NULL;
         tablespaceinfo* ti = NULL;
 
+        if (!XLogRecPtrIsInvalid(opt->incremental))
+            BackupLoadChangedBlocks(opt->incremental, backupstart);
+        if (opt->compression != BASEBACKUP_COMPRESS_OFF) {
+            t_thrd.basebackup_cxt.compress_buf =
+                (char*)palloc(sizeof(BaseBackupDataHeader) + LZ4_compressBound(BACKUP_PARALLEL_CHUNK_SIZE));
+        }
+        t_thrd.basebackup_cxt.compression = opt->compression;
+        t_thrd.basebackup_cxt.reader_pool = BackupReaderStart(opt->parallel > 1 ? opt->parallel : 0, opt->compression);
+
         /* Add a node for the base directory at the end */
         ti = (tablespaceinfo*)palloc0(sizeof(tablespaceinfo));
         ti->size = opt->progress ? sendDir(".", 1, true, tablespaces, true) : -1;
@@ -290,6 +413,10 @@ static void perform_base_backup(basebackup_options* opt, DIR* tblspcdir)
             if (iterti->path == NULL)
                 sendFileWithContent(BACKUP_LABEL_FILE, labelfile);
 
+            /* the relation files of an incremental backup are looked up by tablespace */
+            t_thrd.basebackup_cxt.tablespace_oid =
+                (iterti->path != NULL) ? (Oid)strtoul(iterti->oid, NULL, 10) : InvalidOid;
+
             /*
              * if the tblspc created in datadir , the files under tblspc do not send,
              * and send them as normal under datadir,
@@ -345,6 +472,10 @@ static void perform_base_backup(basebackup_options* opt, DIR* tblspcdir)
             } else
                 pq_putemptymessage_noblock('c'); /* CopyDone */
         }
+
+        /* the WAL files appended below are read by the walsender itself */
+        BackupReaderStop(t_thrd.basebackup_cxt.reader_pool);
+        t_thrd.basebackup_cxt.reader_pool = NULL;
     }
     PG_END_ENSURE_ERROR_CLEANUP(base_backup_cleanup, (Datum)0);
 
@@ -491,9 +622,7 @@ static void perform_base_backup(basebackup_options* opt, DIR* tblspcdir)
             while ((cnt = fread(buf, 1, Min((uint32)sizeof(buf), XLogSegSize - len), fp)) > 0) {
                 CheckXLogRemoved(segno, tli);
                 /* Send the chunk as a CopyData message */
-                if (pq_putmessage('d', buf, cnt)) {
-                    ereport(ERROR, (errmsg("base backup could not send data, aborting backup")));
-                }
+                BaseBackupPutData(buf, cnt);
 
                 len += cnt;
 
@@ -550,6 +679,7 @@ static void perform_base_backup(basebackup_options* opt, DIR* tblspcdir)
     LWLockAcquire(FullBuildXlogCopyStartPtrLock, LW_EXCLUSIVE);
     XlogCopyStartPtr = InvalidXLogRecPtr;
     LWLockRelease(FullBuildXlogCopyStartPtrLock);
+    BackupResetState();
 }
 
 /*
@@ -631,10 +761,14 @@ static void parse_basebackup_options(List* options, basebackup_options* opt)
     bool o_nowait = false;
     bool o_wal = false;
     bool o_tablespace_map = false;
+    bool o_compression = false;
+    bool o_parallel = false;
+    bool o_incremental = false;
     errno_t rc = 0;
 
     rc = memset_s(opt, sizeof(*opt), 0, sizeof(*opt));
     securec_check(rc, "", "");
+    opt->parallel = 1;
     foreach (lopt, options) {
         DefElem* defel = (DefElem*)lfirst(lopt);
 
@@ -669,6 +803,48 @@ static void parse_basebackup_options(List* options, basebackup_options* opt)
             }
             opt->sendtblspcmapfile = true;
             o_tablespace_map = true;
+        } else if (strcmp(defel->defname, "compression") == 0) {
+            char* method = strVal(defel->arg);
+
+            if (o_compression) {
+                ereport(ERROR, (errcode(ERRCODE_SYNTAX_ERROR), errmsg("duplicate option \"%s\"", defel->defname)));
+            }
+            if (pg_strcasecmp(method, "lz4") == 0) {
+                opt->compression = BASEBACKUP_COMPRESS_LZ4;
+            } else if (pg_strcasecmp(method, "none") == 0) {
+                opt->compression = BASEBACKUP_COMPRESS_OFF;
+            } else {
+                ereport(ERROR,
+                    (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                        errmsg("unsupported base backup compression \"%s\"", method)));
+            }
+            o_compression = true;
+        } else if (strcmp(defel->defname, "parallel") == 0) {
+            if (o_parallel) {
+                ereport(ERROR, (errcode(ERRCODE_SYNTAX_ERROR), errmsg("duplicate option \"%s\"", defel->defname)));
+            }
+            opt->parallel = intVal(defel->arg);
+            if (opt->parallel < 1 || opt->parallel > BASEBACKUP_MAX_PARALLEL) {
+                ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                        errmsg("parallel degree of base backup must be between 1 and %d", BASEBACKUP_MAX_PARALLEL)));
+            }
+            o_parallel = true;
+        } else if (strcmp(defel->defname, "incremental") == 0) {
+            char* location = strVal(defel->arg);
+            uint32 hi = 0;
+            uint32 lo = 0;
+
+            if (o_incremental) {
+                ereport(ERROR, (errcode(ERRCODE_SYNTAX_ERROR), errmsg("duplicate option \"%s\"", defel->defname)));
+            }
+            if (sscanf_s(location, "%X/%X", &hi, &lo) != 2 || (hi == 0 && lo == 0)) {
+                ereport(ERROR,
+                    (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                        errmsg("invalid incremental base backup location \"%s\"", location)));
+            }
+            opt->incremental = (((uint64)hi) << 32) | lo;
+            o_incremental = true;
         } else
             ereport(ERROR, (errcode(ERRCODE_SYNTAX_ERROR), errmsg("option \"%s\" not recognized", defel->defname)));
     }
@@ -691,6 +867,7 @@ void SendBaseBackup(BaseBackupCmd* cmd)
     basebackup_options opt;
 
     parse_basebackup_options(cmd->options, &opt);
+    BackupResetState();
 
     backup_context = AllocSetContextCreate(CurrentMemoryContext,
         "Streaming base backup context",
@@ -924,7 +1101,7 @@ static void sendFileWithContent(const char* filename, const char* content)
 
     _tarWriteHeader(filename, NULL, &statbuf);
     /* Send the contents as a CopyData message */
-    (void)pq_putmessage_noblock('d', content, len);
+    BaseBackupPutData(content, len);
 
     /* Pad to 512 byte boundary, per tar format requirements */
     pad = ((len + 511) & ~511) - len;
@@ -934,7 +1111,7 @@ static void sendFileWithContent(const char* filename, const char* content)
 
         rc = memset_s(buf, sizeof(buf), 0, pad);
         securec_check(rc, "", "");
-        (void)pq_putmessage_noblock('d', buf, pad);
+        BaseBackupPutData(buf, pad);
     }
 }
 
@@ -1084,6 +1261,8 @@ static int64 sendDir(
             continue;
         if (strcmp(pathbuf, "./global/pg_dw.build") == 0)
             continue;
+        if (strncmp(pathbuf, "./global/pg_dw_", strlen("./global/pg_dw_")) == 0)
+            continue;
         if (strcmp(pathbuf, "./global/config_exec_params") == 0)
             continue;
 
@@ -1610,17 +1789,12 @@ bool is_row_data_file(const char* path, int* segNo)
 static bool sendFile(char* readfilename, char* tarfilename, struct stat* statbuf, bool missing_ok)
 {
     FILE* fp = NULL;
-    size_t cnt;
-    pgoff_t len = 0;
+    pgoff_t len;
     size_t pad;
     errno_t rc = 0;
-    int check_loc = 0;
-    BlockNumber blkno = 0;
-    uint16 checksum = 0;
     bool isNeedCheck = false;
     int segNo = 0;
-    const int MAX_RETRY_LIMIT = 60;
-    int retryCnt = 0;
+    CBMArrayEntry* changed = NULL;
 
     if (t_thrd.basebackup_cxt.buf_block == NULL) {
         MemoryContext oldcxt = NULL;
@@ -1664,100 +1838,670 @@ static bool sendFile(char* readfilename, char* tarfilename, struct stat* statbuf
         statbuf->st_size = statbuf->st_size - (statbuf->st_size % BLCKSZ);
     }
 
+    /* an incremental backup sends only the changed blocks of the main fork of relations */
+    if (isNeedCheck && t_thrd.basebackup_cxt.changed_blocks != NULL &&
+        BackupGetChangedBlocks(tarfilename, &changed)) {
+        sendIncrementalFile(fp, readfilename, tarfilename, statbuf, segNo, changed);
+        (void)FreeFile(fp);
+        return true;
+    }
+
     /* send the pkg header containing msg like file size */
     _tarWriteHeader(tarfilename, NULL, statbuf);
 
-    while ((cnt = fread(t_thrd.basebackup_cxt.buf_block, 1, Min(TAR_SEND_SIZE, statbuf->st_size - len), fp)) > 0) {
-        if (t_thrd.walsender_cxt.walsender_ready_to_stop)
-            ereport(ERROR, (errcode_for_file_access(), errmsg("base backup receive stop message, aborting backup")));
-    recheck:
-        if (cnt != (size_t)Min(TAR_SEND_SIZE, statbuf->st_size - len)) {
-            if (ferror(fp)) {
-                ereport(ERROR, (errcode_for_file_access(), errmsg("could not read file \"%s\": %m", readfilename)));
-            }
+    /*
+     * If the file is extended while we are sending it, we ignore the extended
+     * data, and if it is truncated, we pad it with zeros. It will be restored
+     * from WAL either way.
+     */
+    len = BackupSendFileData(fileno(fp),
+        readfilename,
+        statbuf->st_size,
+        g_instance.attr.attr_storage.enableIncrementalCheckpoint && isNeedCheck,
+        segNo,
+        NULL,
+        0);
+
+    /* Pad to 512 byte boundary, per tar format requirements */
+    pad = ((len + 511) & ~511) - len;
+    if (pad > 0) {
+        rc = memset_s(t_thrd.basebackup_cxt.buf_block, pad, 0, pad);
+        securec_check(rc, "", "");
+        BaseBackupPutData(t_thrd.basebackup_cxt.buf_block, pad);
+    }
+
+    (void)FreeFile(fp);
+    return true;
+}
+
+/*
+ * Send the blocks of the relation segment open as 'fp' which changed since
+ * the lsn of an incremental backup, as a member named after the segment
+ * file plus BASEBACKUP_INCREMENTAL_SUFFIX. 'changed' is NULL if none did.
+ */
+static void sendIncrementalFile(FILE* fp, const char* readfilename, const char* tarfilename, struct stat* statbuf,
+    int segNo, const CBMArrayEntry* changed)
+{
+    BaseBackupIncrementalHeader hdr;
+    BlockNumber segstart = (BlockNumber)segNo * ((BlockNumber)RELSEG_SIZE);
+    BlockNumber segblocks = (BlockNumber)(statbuf->st_size / BLCKSZ);
+    BlockNumber* blocks = NULL;
+    uint32 nblocks = 0;
+    char membername[MAXPGPATH];
+    struct stat memberstat = *statbuf;
+    pgoff_t len;
+    size_t pad;
+    errno_t rc;
+
+    if (changed != NULL && changed->totalBlockNum > 0) {
+        /* the changed blocks are in ascending order, find the first one of this segment */
+        uint32 lo = 0;
+        uint32 hi = changed->totalBlockNum;
+
+        while (lo < hi) {
+            uint32 mid = lo + (hi - lo) / 2;
+
+            if (changed->changedBlock[mid] < segstart)
+                lo = mid + 1;
+            else
+                hi = mid;
         }
-        if (g_instance.attr.attr_storage.enableIncrementalCheckpoint && isNeedCheck) {
-            /* len and cnt must be integer multiple of BLCKSZ. */
-            if (len % BLCKSZ != 0 || cnt % BLCKSZ != 0) {
-                ereport(ERROR,
-                    (errcode_for_file_access(),
-                        errmsg("base backup file length cannot be divisibed by 8k: file %s, len %ld, cnt %ld, aborting "
-                               "backup",
-                            readfilename,
-                            len,
-                            cnt)));
-            }
-            for (check_loc = 0; (unsigned int)(check_loc) < cnt; check_loc += BLCKSZ) {
-                blkno = len / BLCKSZ + check_loc / BLCKSZ + (segNo * ((BlockNumber)RELSEG_SIZE));
-                PageHeader phdr = PageHeader(t_thrd.basebackup_cxt.buf_block + check_loc);
-                if (PageIsNew(phdr)) {
-                    continue;
-                }
-                checksum = pg_checksum_page(t_thrd.basebackup_cxt.buf_block + check_loc, blkno);
 
-                if (phdr->pd_checksum != checksum) {
-                    if (fseeko(fp, (off_t)len, SEEK_SET) != 0) {
-                        ereport(ERROR,
-                            (errcode_for_file_access(), errmsg("could not seek in file \"%s\": %m", readfilename)));
-                    }
-                    cnt = fread(t_thrd.basebackup_cxt.buf_block, 1, Min(TAR_SEND_SIZE, statbuf->st_size - len), fp);
-                    if (cnt > 0 && retryCnt < MAX_RETRY_LIMIT) {
-                        retryCnt++;
-                        pg_usleep(100000);
-                        goto recheck;
-                    } else if (cnt > 0 && retryCnt == MAX_RETRY_LIMIT) {
-                        ereport(ERROR,
-                            (errcode_for_file_access(),
-                                errmsg("base backup cheksum failed in file \"%s\"(computed: %d, recorded: %d), "
-                                       "aborting backup",
-                                    readfilename,
-                                    checksum,
-                                    phdr->pd_checksum)));
-                    } else {
-                        retryCnt = 0;
-                        break;
-                    }
+        blocks = (BlockNumber*)palloc(sizeof(BlockNumber) * (changed->totalBlockNum - lo));
+        for (; lo < changed->totalBlockNum && changed->changedBlock[lo] - segstart < segblocks; lo++) {
+            blocks[nblocks++] = changed->changedBlock[lo] - segstart;
+        }
+    }
+
+    hdr.magic = BASEBACKUP_INCREMENTAL_MAGIC;
+    hdr.nblocks = nblocks;
+    hdr.file_size = (uint64)statbuf->st_size;
+
+    rc = snprintf_s(membername, sizeof(membername), sizeof(membername) - 1, "%s%s", tarfilename,
+        BASEBACKUP_INCREMENTAL_SUFFIX);
+    securec_check_ss(rc, "", "");
+    memberstat.st_size = sizeof(hdr) + (pgoff_t)nblocks * (sizeof(BlockNumber) + BLCKSZ);
+
+    _tarWriteHeader(membername, NULL, &memberstat);
+    BaseBackupPutData((const char*)&hdr, sizeof(hdr));
+    BaseBackupPutData((const char*)blocks, nblocks * sizeof(BlockNumber));
+    len = sizeof(hdr) + nblocks * sizeof(BlockNumber);
+    if (nblocks > 0) {
+        len += BackupSendFileData(fileno(fp),
+            readfilename,
+            statbuf->st_size,
+            g_instance.attr.attr_storage.enableIncrementalCheckpoint,
+            segNo,
+            blocks,
+            nblocks);
+    }
+
+    /* Pad to 512 byte boundary, per tar format requirements */
+    pad = ((len + 511) & ~511) - len;
+    if (pad > 0) {
+        rc = memset_s(t_thrd.basebackup_cxt.buf_block, pad, 0, pad);
+        securec_check(rc, "", "");
+        BaseBackupPutData(t_thrd.basebackup_cxt.buf_block, pad);
+    }
+
+    if (blocks != NULL)
+        pfree(blocks);
+}
+
+/*
+ * Give the next piece of data to read: the next chunk of the file, or the
+ * next run of consecutive changed blocks.
+ */
+static bool BackupNextRange(BackupRangeCursor* cursor, off_t* offset, size_t* len)
+{
+    if (cursor->blocks == NULL) {
+        if (cursor->offset >= cursor->size)
+            return false;
+        *offset = (off_t)cursor->offset;
+        *len = (size_t)Min((pgoff_t)cursor->chunk_size, cursor->size - cursor->offset);
+        cursor->offset += (pgoff_t)*len;
+        return true;
+    }
+
+    if (cursor->next >= cursor->nblocks)
+        return false;
+
+    BlockNumber first = cursor->blocks[cursor->next];
+    uint32 maxblocks = (uint32)(cursor->chunk_size / BLCKSZ);
+    uint32 n = 1;
+
+    while (cursor->next + n < cursor->nblocks && n < maxblocks && cursor->blocks[cursor->next + n] == first + n)
+        n++;
+    cursor->next += n;
+    *offset = (off_t)first * BLCKSZ;
+    *len = (size_t)n * BLCKSZ;
+    return true;
+}
+
+/*
+ * Frame 'len' bytes of the tar stream for COMPRESSION: the header, then the
+ * LZ4 data or the raw bytes if they don't shrink. 'out' must have room for
+ * the header and LZ4_compressBound(len) bytes. Called by the reader threads.
+ */
+static size_t BackupFrameData(const char* data, size_t len, char* out)
+{
+    BaseBackupDataHeader hdr;
+    int clen;
+    errno_t rc;
+
+    clen = LZ4_compress_default(data, out + sizeof(hdr), (int)len, LZ4_compressBound((int)len));
+    hdr.raw_len = (uint32)len;
+    if (clen > 0 && (size_t)clen < len) {
+        hdr.data_len = (uint32)clen;
+    } else {
+        rc = memcpy_s(out + sizeof(hdr), len, data, len);
+        securec_check(rc, "\0", "\0");
+        hdr.data_len = (uint32)len;
+    }
+    rc = memcpy_s(out, sizeof(hdr), &hdr, sizeof(hdr));
+    securec_check(rc, "\0", "\0");
+    return sizeof(hdr) + hdr.data_len;
+}
+
+/*
+ * Read a chunk, verify the checksums of its pages and compress it. This
+ * runs in the reader threads, so the results are left in the chunk for the
+ * walsender to report.
+ */
+static void BackupReadChunk(BackupChunk* chunk, int compression)
+{
+    int retry = 0;
+
+    chunk->read_errno = 0;
+    chunk->bad_page = -1;
+    chunk->outlen = 0;
+
+reread:
+    chunk->nread = 0;
+    while (chunk->nread < chunk->len) {
+        ssize_t rc = pread(chunk->fd, chunk->buf + chunk->nread, chunk->len - chunk->nread,
+            chunk->offset + (off_t)chunk->nread);
+        if (rc < 0) {
+            if (errno == EINTR)
+                continue;
+            chunk->read_errno = errno;
+            return;
+        }
+        /* the file was truncated while we were sending it */
+        if (rc == 0)
+            break;
+        chunk->nread += (size_t)rc;
+    }
+
+    if (chunk->verify && chunk->nread % BLCKSZ == 0) {
+        for (size_t off = 0; off < chunk->nread; off += BLCKSZ) {
+            PageHeader phdr = (PageHeader)(chunk->buf + off);
+
+            if (PageIsNew(phdr))
+                continue;
+
+            uint16 checksum = pg_checksum_page(chunk->buf + off, chunk->blkno + (BlockNumber)(off / BLCKSZ));
+            if (phdr->pd_checksum != checksum) {
+                /* the page may be torn by a concurrent write, read it again a bit later */
+                if (retry++ < BACKUP_CHECKSUM_MAX_RETRY) {
+                    pg_usleep(100000L);
+                    goto reread;
                 }
-                retryCnt = 0;
+                chunk->bad_page = (int)(off / BLCKSZ);
+                chunk->computed_checksum = checksum;
+                chunk->recorded_checksum = phdr->pd_checksum;
+                return;
             }
         }
+    }
 
-        /* Send the chunk as a CopyData message */
-        if (pq_putmessage_noblock('d', t_thrd.basebackup_cxt.buf_block, cnt))
-            ereport(ERROR, (errcode_for_file_access(), errmsg("base backup could not send data, aborting backup")));
+    if (compression != BASEBACKUP_COMPRESS_OFF && chunk->nread > 0)
+        chunk->outlen = BackupFrameData(chunk->buf, chunk->nread, chunk->out);
+}
 
-        len += cnt;
+static void* BackupReaderMain(void* arg)
+{
+    BackupReaderPool* pool = (BackupReaderPool*)arg;
 
-        if (len >= statbuf->st_size) {
-            /*
-             * Reached end of file. The file could be longer, if it was
-             * extended while we were sending it, but for a base backup we can
-             * ignore such extended data. It will be restored from WAL.
-             */
+    (void)pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stopping && pool->next == pool->head)
+            (void)pthread_cond_wait(&pool->queued, &pool->lock);
+        if (pool->stopping)
             break;
+
+        BackupChunk* chunk = &pool->chunks[pool->next % pool->nchunks];
+        pool->next++;
+        chunk->state = BACKUP_CHUNK_READING;
+        (void)pthread_mutex_unlock(&pool->lock);
+
+        BackupReadChunk(chunk, pool->compression);
+
+        (void)pthread_mutex_lock(&pool->lock);
+        chunk->state = BACKUP_CHUNK_DONE;
+        (void)pthread_cond_broadcast(&pool->done);
+    }
+    (void)pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+/*
+ * Start 'nthreads' reader threads, none means the walsender reads the chunks
+ * itself when it queues them.
+ */
+static BackupReaderPool* BackupReaderStart(int nthreads, int compression)
+{
+    BackupReaderPool* pool = (BackupReaderPool*)palloc0(sizeof(BackupReaderPool));
+
+    pool->compression = compression;
+    pool->chunk_size = (nthreads > 0) ? BACKUP_PARALLEL_CHUNK_SIZE : TAR_SEND_SIZE;
+    pool->nchunks = (nthreads > 0) ? nthreads * BACKUP_CHUNKS_PER_READER : 1;
+    pool->chunks = (BackupChunk*)palloc0(sizeof(BackupChunk) * pool->nchunks);
+    for (int i = 0; i < pool->nchunks; i++) {
+        pool->chunks[i].buf = (char*)palloc(pool->chunk_size);
+        if (compression != BASEBACKUP_COMPRESS_OFF) {
+            pool->chunks[i].out =
+                (char*)palloc(sizeof(BaseBackupDataHeader) + LZ4_compressBound((int)pool->chunk_size));
         }
     }
+    (void)pthread_mutex_init(&pool->lock, NULL);
+    (void)pthread_cond_init(&pool->queued, NULL);
+    (void)pthread_cond_init(&pool->done, NULL);
 
-    /* If the file was truncated while we were sending it, pad it with zeros */
-    if (len < statbuf->st_size) {
-        rc = memset_s(t_thrd.basebackup_cxt.buf_block, TAR_SEND_SIZE, 0, TAR_SEND_SIZE);
-        securec_check(rc, "", "");
-        while (len < statbuf->st_size) {
-            cnt = Min(TAR_SEND_SIZE, statbuf->st_size - len);
-            (void)pq_putmessage_noblock('d', t_thrd.basebackup_cxt.buf_block, cnt);
-            len += cnt;
+    if (nthreads == 0)
+        return pool;
+
+    /* the readers must not take the signals of the walsender */
+    sigset_t allsignals;
+    sigset_t oldsignals;
+    int rc = 0;
+
+    (void)sigfillset(&allsignals);
+    (void)pthread_sigmask(SIG_SETMASK, &allsignals, &oldsignals);
+    pool->threads = (pthread_t*)palloc0(sizeof(pthread_t) * nthreads);
+    for (pool->nthreads = 0; pool->nthreads < nthreads; pool->nthreads++) {
+        rc = pthread_create(&pool->threads[pool->nthreads], NULL, BackupReaderMain, pool);
+        if (rc != 0)
+            break;
+    }
+    (void)pthread_sigmask(SIG_SETMASK, &oldsignals, NULL);
+
+    if (rc != 0) {
+        BackupReaderStop(pool);
+        errno = rc;
+        ereport(ERROR,
+            (errcode(ERRCODE_INSUFFICIENT_RESOURCES), errmsg("could not create base backup reader thread: %m")));
+    }
+
+    ereport(DEBUG1, (errmsg("base backup started %d reader threads", nthreads)));
+    return pool;
+}
+
+/* Stop the reader threads, the chunks still queued are dropped */
+static void BackupReaderStop(BackupReaderPool* pool)
+{
+    if (pool == NULL)
+        return;
+
+    (void)pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    (void)pthread_cond_broadcast(&pool->queued);
+    (void)pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->nthreads; i++)
+        (void)pthread_join(pool->threads[i], NULL);
+
+    (void)pthread_cond_destroy(&pool->done);
+    (void)pthread_cond_destroy(&pool->queued);
+    (void)pthread_mutex_destroy(&pool->lock);
+    for (int i = 0; i < pool->nchunks; i++) {
+        pfree_ext(pool->chunks[i].buf);
+        pfree_ext(pool->chunks[i].out);
+    }
+    pfree_ext(pool->threads);
+    pfree(pool->chunks);
+    pfree(pool);
+}
+
+static void BackupReaderQueue(BackupReaderPool* pool, int fd, off_t offset, size_t len, bool verify, BlockNumber blkno)
+{
+    BackupChunk* chunk = &pool->chunks[pool->head % pool->nchunks];
+
+    Assert(chunk->state == BACKUP_CHUNK_FREE);
+    chunk->fd = fd;
+    chunk->offset = offset;
+    chunk->len = len;
+    chunk->verify = verify;
+    chunk->blkno = blkno;
+
+    if (pool->nthreads == 0) {
+        BackupReadChunk(chunk, pool->compression);
+        chunk->state = BACKUP_CHUNK_DONE;
+        pool->head++;
+        return;
+    }
+
+    (void)pthread_mutex_lock(&pool->lock);
+    chunk->state = BACKUP_CHUNK_QUEUED;
+    pool->head++;
+    (void)pthread_cond_signal(&pool->queued);
+    (void)pthread_mutex_unlock(&pool->lock);
+}
+
+/* Wait for the oldest queued chunk to be read */
+static BackupChunk* BackupReaderWait(BackupReaderPool* pool)
+{
+    BackupChunk* chunk = &pool->chunks[pool->tail % pool->nchunks];
+
+    Assert(pool->tail < pool->head);
+    if (pool->nthreads > 0) {
+        (void)pthread_mutex_lock(&pool->lock);
+        while (chunk->state != BACKUP_CHUNK_DONE)
+            (void)pthread_cond_wait(&pool->done, &pool->lock);
+        (void)pthread_mutex_unlock(&pool->lock);
+    }
+    return chunk;
+}
+
+static void BackupReaderRelease(BackupReaderPool* pool)
+{
+    pool->chunks[pool->tail % pool->nchunks].state = BACKUP_CHUNK_FREE;
+    pool->tail++;
+}
+
+/*
+ * Send the data of a relation segment or another file open as 'fd', of
+ * 'size' bytes: all of it, or only the 'nblocks' blocks in 'blocks' (block
+ * numbers relative to the segment, in ascending order). Data missing
+ * because the file was truncated meanwhile is replaced by zeros, so the
+ * number of bytes returned is always what was asked for.
+ */
+static pgoff_t BackupSendFileData(int fd, const char* readfilename, pgoff_t size, bool verify, int segNo,
+    const BlockNumber* blocks, uint32 nblocks)
+{
+    BackupReaderPool* pool = t_thrd.basebackup_cxt.reader_pool;
+    bool localpool = (pool == NULL);
+    BackupRangeCursor cursor;
+    bool more = true;
+    pgoff_t sent = 0;
+
+    /* files not sent by BASE_BACKUP, e.g. of the MOT checkpoint, are read directly */
+    if (localpool)
+        pool = BackupReaderStart(0, t_thrd.basebackup_cxt.compression);
+
+    cursor.chunk_size = pool->chunk_size;
+    cursor.size = size;
+    cursor.offset = 0;
+    cursor.blocks = blocks;
+    cursor.nblocks = nblocks;
+    cursor.next = 0;
+
+    for (;;) {
+        off_t offset;
+        size_t len;
+
+        while (more && pool->head - pool->tail < (uint64)pool->nchunks) {
+            if (!BackupNextRange(&cursor, &offset, &len)) {
+                more = false;
+                break;
+            }
+            BackupReaderQueue(pool,
+                fd,
+                offset,
+                len,
+                verify,
+                (BlockNumber)(offset / BLCKSZ) + (BlockNumber)segNo * ((BlockNumber)RELSEG_SIZE));
+        }
+        if (pool->tail == pool->head)
+            break;
+
+        BackupChunk* chunk = BackupReaderWait(pool);
+
+        if (t_thrd.walsender_cxt.walsender_ready_to_stop)
+            ereport(ERROR, (errcode_for_file_access(), errmsg("base backup receive stop message, aborting backup")));
+        if (chunk->read_errno != 0) {
+            errno = chunk->read_errno;
+            ereport(ERROR, (errcode_for_file_access(), errmsg("could not read file \"%s\": %m", readfilename)));
+        }
+        if (chunk->verify && chunk->nread % BLCKSZ != 0) {
+            ereport(ERROR,
+                (errcode_for_file_access(),
+                    errmsg("base backup file length cannot be divisibed by 8k: file %s, len %ld, cnt %ld, aborting "
+                           "backup",
+                        readfilename,
+                        (long)chunk->offset,
+                        (long)chunk->nread)));
         }
+        if (chunk->bad_page >= 0) {
+            ereport(ERROR,
+                (errcode_for_file_access(),
+                    errmsg("base backup cheksum failed in file \"%s\"(computed: %d, recorded: %d), "
+                           "aborting backup",
+                        readfilename,
+                        chunk->computed_checksum,
+                        chunk->recorded_checksum)));
+        }
+
+        /* Send the chunk as a CopyData message */
+        if (chunk->outlen > 0) {
+            if (pq_putmessage_noblock('d', chunk->out, chunk->outlen))
+                ereport(ERROR, (errcode_for_file_access(), errmsg("base backup could not send data, aborting backup")));
+        } else {
+            BaseBackupPutData(chunk->buf, chunk->nread);
+        }
+        if (chunk->nread < chunk->len)
+            BackupSendZeros(chunk->len - chunk->nread);
+        sent += (pgoff_t)chunk->len;
+
+        BackupReaderRelease(pool);
     }
 
-    /* Pad to 512 byte boundary, per tar format requirements */
-    pad = ((len + 511) & ~511) - len;
-    if (pad > 0) {
-        rc = memset_s(t_thrd.basebackup_cxt.buf_block, pad, 0, pad);
-        securec_check(rc, "", "");
-        (void)pq_putmessage_noblock('d', t_thrd.basebackup_cxt.buf_block, pad);
+    if (localpool)
+        BackupReaderStop(pool);
+    return sent;
+}
+
+/*
+ * Send a piece of the tar stream as CopyData messages, compressed if the
+ * backup asked for it.
+ */
+static void BaseBackupPutData(const char* data, size_t len)
+{
+    /* libpq drops empty CopyData messages, don't bother sending them */
+    while (len > 0) {
+        size_t n = len;
+
+        if (t_thrd.basebackup_cxt.compression == BASEBACKUP_COMPRESS_OFF) {
+            if (pq_putmessage_noblock('d', data, n))
+                ereport(ERROR, (errcode_for_file_access(), errmsg("base backup could not send data, aborting backup")));
+        } else {
+            n = Min(len, (size_t)BACKUP_PARALLEL_CHUNK_SIZE);
+            size_t outlen = BackupFrameData(data, n, t_thrd.basebackup_cxt.compress_buf);
+            if (pq_putmessage_noblock('d', t_thrd.basebackup_cxt.compress_buf, outlen))
+                ereport(ERROR, (errcode_for_file_access(), errmsg("base backup could not send data, aborting backup")));
+        }
+        data += n;
+        len -= n;
     }
+}
 
-    (void)FreeFile(fp);
+static void BackupSendZeros(size_t len)
+{
+    errno_t rc = memset_s(t_thrd.basebackup_cxt.buf_block, TAR_SEND_SIZE, 0, TAR_SEND_SIZE);
+    securec_check(rc, "", "");
+
+    while (len > 0) {
+        size_t n = Min(len, (size_t)TAR_SEND_SIZE);
+
+        BaseBackupPutData(t_thrd.basebackup_cxt.buf_block, n);
+        len -= n;
+    }
+}
+
+/*
+ * Stop the reader threads and forget the state of the options of the
+ * backup, whose memory goes away with the backup context.
+ */
+static void BackupResetState(void)
+{
+    BackupReaderStop(t_thrd.basebackup_cxt.reader_pool);
+    t_thrd.basebackup_cxt.reader_pool = NULL;
+    t_thrd.basebackup_cxt.compression = BASEBACKUP_COMPRESS_OFF;
+    t_thrd.basebackup_cxt.compress_buf = NULL;
+    t_thrd.basebackup_cxt.changed_blocks = NULL;
+    t_thrd.basebackup_cxt.tablespace_oid = InvalidOid;
+}
+
+/*
+ * Load the blocks changed between the lsn of an incremental backup and the
+ * start of the backup from the CBM files. Blocks changed after the start
+ * are restored from WAL like in any base backup.
+ */
+static void BackupLoadChangedBlocks(XLogRecPtr incremental, XLogRecPtr startptr)
+{
+    XLogRecPtr trackedlsn;
+    CBMArray* cbmArray = NULL;
+    HASHCTL ctl;
+    HTAB* changedRels = NULL;
+    long nrels = 0;
+    errno_t rc;
+
+    if (RecoveryInProgress()) {
+        ereport(ERROR,
+            (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+                errmsg("recovery is in progress"),
+                errhint("An incremental base backup cannot be taken from a standby.")));
+    }
+    if (!u_sess->attr.attr_storage.enable_cbm_tracking || !IsCBMWriterRunning()) {
+        ereport(ERROR,
+            (errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+                errmsg("incremental base backup requires enable_cbm_tracking to be on")));
+    }
+    if (XLByteLE(startptr, incremental)) {
+        ereport(ERROR,
+            (errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+                errmsg("incremental base backup location %X/%X is not before the backup start %X/%X",
+                    (uint32)(incremental >> 32),
+                    (uint32)incremental,
+                    (uint32)(startptr >> 32),
+                    (uint32)startptr)));
+    }
+
+    trackedlsn = ForceTrackCBMOnce(startptr, BACKUP_CBM_TRACK_TIMEOUT, true, false);
+    if (XLogRecPtrIsInvalid(trackedlsn)) {
+        ereport(ERROR,
+            (errcode(ERRCODE_CONNECTION_TIMED_OUT), errmsg("timeout happened during force track cbm for base backup")));
+    }
+
+    (void)LWLockAcquire(CBMParseXlogLock, LW_SHARED);
+    cbmArray = CBMGetMergedArray(incremental, trackedlsn);
+    LWLockRelease(CBMParseXlogLock);
+
+    rc = memset_s(&ctl, sizeof(ctl), 0, sizeof(ctl));
+    securec_check(rc, "\0", "\0");
+    ctl.keysize = sizeof(BackupChangedRelKey);
+    ctl.entrysize = sizeof(BackupChangedRel);
+    ctl.hash = tag_hash;
+    ctl.hcxt = CurrentMemoryContext;
+    changedRels = hash_create("base backup changed relations",
+        Max(cbmArray->arrayLength, 256),
+        &ctl,
+        HASH_ELEM | HASH_FUNCTION | HASH_CONTEXT);
+
+    for (long i = 0; i < cbmArray->arrayLength; i++) {
+        CBMArrayEntry* entry = &cbmArray->arrayEntry[i];
+        BackupChangedRelKey key;
+
+        /* only the main fork of plain relations is sent incrementally */
+        if (entry->cbmTag.forkNum != MAIN_FORKNUM || entry->cbmTag.rNode.bucketNode != InvalidBktId)
+            continue;
+
+        key.spcNode = entry->cbmTag.rNode.spcNode;
+        key.dbNode = entry->cbmTag.rNode.dbNode;
+        key.relNode = entry->cbmTag.rNode.relNode;
+        BackupChangedRel* rel = (BackupChangedRel*)hash_search(changedRels, &key, HASH_ENTER, NULL);
+        rel->changed = entry;
+        nrels++;
+    }
+    t_thrd.basebackup_cxt.changed_blocks = changedRels;
+
+    ereport(LOG,
+        (errmsg("incremental base backup sends the blocks of %ld relations changed between %X/%X and %X/%X",
+            nrels,
+            (uint32)(incremental >> 32),
+            (uint32)incremental,
+            (uint32)(trackedlsn >> 32),
+            (uint32)trackedlsn)));
+}
+
+static bool BackupParseOid(const char** name, Oid* oid)
+{
+    char* end = NULL;
+    unsigned long val;
+
+    if (!isdigit((unsigned char)**name))
+        return false;
+    errno = 0;
+    val = strtoul(*name, &end, 10);
+    if (errno != 0 || val > PG_UINT32_MAX)
+        return false;
+    *oid = (Oid)val;
+    *name = end;
+    return true;
+}
+
+/*
+ * Check whether a data file can be sent incrementally, that is it is a
+ * segment of the main fork of a permanent, non-bucket relation which was
+ * neither created, dropped nor truncated since the lsn of the incremental
+ * backup. Set 'changed' to its changed blocks, NULL if none changed.
+ */
+static bool BackupGetChangedBlocks(const char* tarfilename, CBMArrayEntry** changed)
+{
+    BackupChangedRelKey key;
+    const char* name = tarfilename;
+
+    key.dbNode = InvalidOid;
+    if (t_thrd.basebackup_cxt.tablespace_oid != InvalidOid) {
+        /* TABLESPACE_VERSION_DIRECTORY_node/dbNode/relNode[.segNo] */
+        name = strchr(tarfilename, '/');
+        if (name == NULL)
+            return false;
+        name++;
+        key.spcNode = t_thrd.basebackup_cxt.tablespace_oid;
+    } else if (strncmp(tarfilename, "base/", strlen("base/")) == 0) {
+        name = tarfilename + strlen("base/");
+        key.spcNode = DEFAULTTABLESPACE_OID;
+    } else if (strncmp(tarfilename, "global/", strlen("global/")) == 0) {
+        name = tarfilename + strlen("global/");
+        key.spcNode = GLOBALTABLESPACE_OID;
+    } else {
+        return false;
+    }
+
+    if (key.spcNode != GLOBALTABLESPACE_OID && (!BackupParseOid(&name, &key.dbNode) || *name++ != '/'))
+        return false;
+    if (!BackupParseOid(&name, &key.relNode))
+        return false;
+    if (*name == '.') {
+        Oid segno;
+
+        name++;
+        if (!BackupParseOid(&name, &segno))
+            return false;
+    }
+    if (*name != '\0')
+        return false;
+
+    BackupChangedRel* rel =
+        (BackupChangedRel*)hash_search(t_thrd.basebackup_cxt.changed_blocks, &key, HASH_FIND, NULL);
+    if (rel == NULL) {
+        *changed = NULL;
+        return true;
+    }
+    if (rel->changed->changeType != PAGETYPE_MODIFY)
+        return false;
+    *changed = rel->changed;
     return true;
 }
 
@@ -1829,7 +2573,7 @@ static void _tarWriteHeader(const char* filename, const char* linktarget, struct
 
     /* Link tag 100 (NULL) */
     /* Now send the completed header. */
-    (void)pq_putmessage_noblock('d', h, BUILD_PATH_LEN);
+    BaseBackupPutData(h, BUILD_PATH_LEN);
 }
 
 void ut_save_xlogloc(const char* xloglocation)
@@ -26,6 +26,7 @@
 #include "miscadmin.h"
 #include "replication/walreceiver.h"
 #include "replication/libpqwalreceiver.h"
+#include "replication/walprotocol.h"
 #include "storage/pmsignal.h"
 #include "storage/proc.h"
 #include "utils/guc.h"
@@ -885,6 +886,12 @@ retry:
             (uint32)(*startpoint));
     securec_check_ss(nRet, "", "");
 
+    /* ask the sender to compress the WAL stream, it must know the option */
+    if (u_sess->attr.attr_storage.wal_stream_compression == WAL_STREAM_COMPRESS_LZ4) {
+        nRet = strcat_s(cmd, sizeof(cmd), " (compression 'lz4')");
+        securec_check(nRet, "", "");
+    }
+
     res = libpqrcv_PQexec(cmd);
     if (PQresultStatus(res) != PGRES_COPY_BOTH) {
         PQclear(res);
@@ -45,6 +45,9 @@
 
 #include "utils/memutils.h"
 
+/* records decoded between two reports of the decoding statistics to the slot */
+#define DECODING_STATS_REPORT_RECORDS 1024
+
 typedef struct XLogRecordBuffer {
     XLogRecPtr origptr;
     XLogRecPtr endptr;
@@ -103,6 +106,15 @@ void LogicalDecodingProcessRecord(LogicalDecodingContext* ctx, XLogReaderState*
     buf.record = record;
     buf.record_data = GetXlrec(record);
 
+    /*
+     * The first record of a subtransaction carries the toplevel xid, assign
+     * the subtransaction before any of its changes is queued. This applies to
+     * every kind of record, hence it is done before the switch.
+     */
+    if (TransactionIdIsValid(XLogRecGetTopXid(record))) {
+        ReorderBufferAssignChild(ctx->reorder, XLogRecGetTopXid(record), XLogRecGetXid(record), buf.origptr);
+    }
+
     /* cast so we get a warning when new rmgrs are added */
     switch ((RmgrIds)XLogRecGetRmid(record)) {
         /*
@@ -171,6 +183,18 @@ void LogicalDecodingProcessRecord(LogicalDecodingContext* ctx, XLogReaderState*
                 (errcode(ERRCODE_UNRECOGNIZED_NODE_TYPE),
                     errmsg("unexpected rmgr_id: %d", (RmgrIds)XLogRecGetRmid(buf.record))));
     }
+
+    /*
+     * Report the statistics to the slot when a transaction has been sent,
+     * spilled or streamed, and once in a while otherwise.
+     */
+    ReorderBuffer* rb = ctx->reorder;
+    rb->stats.decoded_records++;
+    rb->stats.decoded_bytes += buf.endptr - buf.origptr;
+    if (rb->stats.total_txns > 0 || rb->stats.spill_count > 0 || rb->stats.stream_count > 0 ||
+        rb->stats.decoded_records >= DECODING_STATS_REPORT_RECORDS) {
+        UpdateDecodingStats(ctx);
+    }
 }
 
 /*
@@ -35,7 +35,9 @@
  *	big as the available memory - this module supports spooling the contents
  *	of a large transactions to disk. When the transaction is replayed the
  *	contents of individual (sub-)transactions will be read from disk in
- *	chunks.
+ *	chunks. If the output plugin supports it, a large transaction without
+ *	subtransactions and catalog changes is instead streamed to the plugin in
+ *	blocks while it is still in progress (c.f. ReorderBufferStreamTXN()).
  *
  *	This module also has to deal with reassembling toast records from the
  *	individual chunks stored in WAL. When a new (or initial) version of a
@@ -66,7 +68,7 @@
 #include "replication/logical.h"
 #include "replication/reorderbuffer.h"
 #include "replication/slot.h"
-#include "replication/snapbuild.h" /* just for SnapBuildSnapDecRefcount */
+#include "replication/snapbuild.h"
 #include "access/xlog_internal.h"
 
 #include "storage/bufmgr.h"
@@ -237,6 +239,9 @@ ReorderBuffer* ReorderBufferAllocate(void)
 
     buffer->current_restart_decoding_lsn = InvalidXLogRecPtr;
 
+    rc = memset_s(&buffer->stats, sizeof(ReplicationSlotDecodingStats), 0, sizeof(ReplicationSlotDecodingStats));
+    securec_check(rc, "", "");
+
     dlist_init(&buffer->toplevel_by_lsn);
     dlist_init(&buffer->txns_by_base_snapshot_lsn);
     dlist_init(&buffer->cached_transactions);
@@ -1056,6 +1061,12 @@ static void ReorderBufferCleanupTXN(ReorderBuffer* rb, ReorderBufferTXN* txn, XL
         Assert(change->action == REORDER_BUFFER_CHANGE_INTERNAL_TUPLECID);
         ReorderBufferReturnChange(rb, change);
     }
+    /* cleanup the snapshot saved by the last streamed block */
+    if (txn->snapshot_now != NULL && txn->snapshot_now->copied) {
+        ReorderBufferFreeSnap(rb, txn->snapshot_now);
+        txn->snapshot_now = NULL;
+    }
+
     /*
      * Cleanup the base snapshot, if set.
      */
@@ -1225,6 +1236,186 @@ static void ReorderBufferFreeSnap(ReorderBuffer* rb, Snapshot snap)
         SnapBuildSnapDecRefcount(snap);
 }
 
+/*
+ * Size of a change as accounted in the decoding statistics.
+ */
+static Size ReorderBufferChangeSize(ReorderBufferChange* change)
+{
+    Size sz = sizeof(ReorderBufferChange);
+
+    switch (change->action) {
+        case REORDER_BUFFER_CHANGE_INSERT:
+        case REORDER_BUFFER_CHANGE_UPDATE:
+        case REORDER_BUFFER_CHANGE_DELETE:
+            if (change->data.tp.oldtuple != NULL)
+                sz += change->data.tp.oldtuple->tuple.t_len;
+            if (change->data.tp.newtuple != NULL)
+                sz += change->data.tp.newtuple->tuple.t_len;
+            break;
+        default:
+            break;
+    }
+    return sz;
+}
+
+/*
+ * Replay a single change of a transaction, at its commit or while streaming
+ * it. *snapshot_now and *command_id are the decoding state of the
+ * transaction, advanced by the internal changes.
+ *
+ * Returns false if the change has been unlinked from the transaction to be
+ * kept for toast reassembly, the caller must not free it then.
+ */
+static bool ReorderBufferApplyChange(ReorderBuffer* rb, ReorderBufferTXN* txn, ReorderBufferChange* change,
+    Snapshot* snapshot_now, CommandId* command_id, bool streaming)
+{
+    Relation relation = NULL;
+    Oid reloid;
+    Oid partitionReltoastrelid = InvalidOid;
+    bool kept = true;
+
+    switch (change->action) {
+        case REORDER_BUFFER_CHANGE_INSERT:
+        case REORDER_BUFFER_CHANGE_UPDATE:
+        case REORDER_BUFFER_CHANGE_DELETE:
+            Assert(*snapshot_now);
+
+            reloid = RelidByRelfilenode(change->data.tp.relnode.spcNode, change->data.tp.relnode.relNode);
+            if (reloid == InvalidOid) {
+                reloid = PartitionRelidByRelfilenode(
+                    change->data.tp.relnode.spcNode, change->data.tp.relnode.relNode, partitionReltoastrelid);
+            }
+            /*
+             * Catalog tuple without data, emitted while catalog was
+             * in the process of being rewritten.
+             */
+            if (reloid == InvalidOid && change->data.tp.newtuple == NULL && change->data.tp.oldtuple == NULL)
+                return true;
+            else if (reloid == InvalidOid) {
+                /*
+                 * description:
+                 * When we try to decode a table who is already dropped.
+                 * Maybe we could not find it relnode.In this time, we will undecode this log.
+                 * It will be solve when we use MVCC.
+                 */
+                ereport(DEBUG1,
+                    (errmsg("could not lookup relation %s", relpathperm(change->data.tp.relnode, MAIN_FORKNUM))));
+                return true;
+            }
+
+            relation = RelationIdGetRelation(reloid);
+            if (relation == NULL) {
+                ereport(DEBUG1,
+                    (errmsg("could open relation descriptor %s", relpathperm(change->data.tp.relnode, MAIN_FORKNUM))));
+                return true;
+            }
+
+            if (CSTORE_NAMESPACE == get_rel_namespace(RelationGetRelid(relation))) {
+                RelationClose(relation);
+                return true;
+            }
+
+            if (RelationIsLogicallyLogged(relation)) {
+                /*
+                 * For now ignore sequence changes entirely. Most of
+                 * the time they don't log changes using records we
+                 * understand, so it doesn't make sense to handle the
+                 * few cases we do.
+                 */
+                if (relation->rd_rel->relkind == RELKIND_SEQUENCE) {
+                } else if (!IsToastRelation(relation)) { /* user-triggered change */
+                    Size size = ReorderBufferChangeSize(change);
+
+                    ReorderBufferToastReplace(rb, txn, relation, change, partitionReltoastrelid);
+                    rb->stats.total_bytes += size;
+                    if (streaming) {
+                        rb->stats.stream_bytes += size;
+                        rb->stream_change(rb, txn, relation, change);
+                    } else {
+                        rb->apply_change(rb, txn, relation, change);
+                    }
+                    /*
+                     * Only clear reassembled toast chunks if we're
+                     * sure they're not required anymore. The creator
+                     * of the tuple tells us.
+                     */
+                    if (change->data.tp.clear_toast_afterwards)
+                        ReorderBufferToastReset(rb, txn);
+                } else if (change->action == REORDER_BUFFER_CHANGE_INSERT) {
+                    /* we're not interested in toast deletions
+                     *
+                     * Need to reassemble the full toasted Datum in
+                     * memory, to ensure the chunks don't get reused
+                     * till we're done remove it from the list of this
+                     * transaction's changes. Otherwise it will get
+                     * freed/reused while restoring spooled data from
+                     * disk.
+                     */
+                    dlist_delete(&change->node);
+                    ReorderBufferToastAppendChunk(rb, txn, relation, change);
+                    kept = false;
+                }
+            }
+            RelationClose(relation);
+            break;
+        case REORDER_BUFFER_CHANGE_INTERNAL_SNAPSHOT:
+            /* get rid of the old */
+            TeardownHistoricSnapshot(false);
+
+            if ((*snapshot_now)->copied) {
+                ReorderBufferFreeSnap(rb, *snapshot_now);
+                *snapshot_now = NULL;
+                *snapshot_now = ReorderBufferCopySnap(rb, change->data.snapshot, txn, *command_id);
+            } else if (change->data.snapshot->copied || streaming) {
+                /*
+                 * Restored from disk, need to be careful not to double
+                 * free. We could introduce refcounting for that, but for
+                 * now this seems infrequent enough not to care. A streamed
+                 * change is freed right after it is sent, so copy the
+                 * snapshot then too.
+                 */
+                *snapshot_now = ReorderBufferCopySnap(rb, change->data.snapshot, txn, *command_id);
+            } else {
+                *snapshot_now = change->data.snapshot;
+            }
+
+            /* and continue with the new one */
+            SetupHistoricSnapshot(*snapshot_now, txn->tuplecid_hash);
+            break;
+
+        case REORDER_BUFFER_CHANGE_INTERNAL_COMMAND_ID:
+            Assert(change->data.command_id != InvalidCommandId);
+
+            if (*command_id < change->data.command_id) {
+                *command_id = change->data.command_id;
+
+                if (!(*snapshot_now)->copied) {
+                    /* we don't use the global one anymore */
+                    *snapshot_now = ReorderBufferCopySnap(rb, *snapshot_now, txn, *command_id);
+                }
+
+                (*snapshot_now)->curcid = *command_id;
+
+                TeardownHistoricSnapshot(false);
+                SetupHistoricSnapshot(*snapshot_now, txn->tuplecid_hash);
+
+                /*
+                 * Every time the CommandId is incremented, we could
+                 * see new catalog contents, so execute all
+                 * invalidations.
+                 */
+                ReorderBufferExecuteInvalidations(rb, txn);
+            }
+
+            break;
+
+        case REORDER_BUFFER_CHANGE_INTERNAL_TUPLECID:
+            ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED), errmsg("tuplecid value in changequeue")));
+            break;
+    }
+    return kept;
+}
+
 /*
  * Perform the replay of a transaction and its non-aborted subtransactions.
  *
@@ -1236,7 +1427,9 @@ static void ReorderBufferFreeSnap(ReorderBuffer* rb, Snapshot snap)
  * record is read because that's the only place where we know about cache
  * invalidations. Thus, once a toplevel commit is read, we iterate over the top
  * and subtransactions (using a k-way merge) and replay the changes in lsn
- * order.
+ * order. Large transactions without catalog changes may have been streamed
+ * already (c.f. ReorderBufferStreamTXN()), the remaining changes are then
+ * sent as the last streamed block.
  */
 void ReorderBufferCommit(ReorderBuffer* rb, TransactionId xid, XLogRecPtr commit_lsn, XLogRecPtr end_lsn,
     RepOriginId origin_id, CommitSeqNo csn, TimestampTz commit_time)
@@ -1273,7 +1466,24 @@ void ReorderBufferCommit(ReorderBuffer* rb, TransactionId xid, XLogRecPtr commit
         return;
     }
 
-    snapshot_now = txn->base_snapshot;
+    if (txn->streamed) {
+        /*
+         * Continue where the last streamed block stopped. Subtransactions
+         * may have been assigned since then, copy the snapshot again so
+         * that it knows about them.
+         */
+        snapshot_now = txn->snapshot_now;
+        command_id = txn->command_id;
+        txn->snapshot_now = NULL;
+        if (snapshot_now->copied) {
+            Snapshot snap = ReorderBufferCopySnap(rb, snapshot_now, txn, command_id);
+
+            ReorderBufferFreeSnap(rb, snapshot_now);
+            snapshot_now = snap;
+        }
+    } else {
+        snapshot_now = txn->base_snapshot;
+    }
 
     /* build data to be able to lookup the CommandIds of catalog tuples */
     ReorderBufferBuildTupleCidHash(rb, txn);
@@ -1303,150 +1513,29 @@ void ReorderBufferCommit(ReorderBuffer* rb, TransactionId xid, XLogRecPtr commit
             txn_started = true;
         }
 
-        rb->begin(rb, txn);
+        if (txn->streamed)
+            rb->stream_start(rb, txn);
+        else
+            rb->begin(rb, txn);
 
         iterstate = ReorderBufferIterTXNInit(rb, txn);
         while ((change = ReorderBufferIterTXNNext(rb, iterstate))) {
-            Relation relation = NULL;
-            Oid reloid;
-            Oid partitionReltoastrelid = InvalidOid;
-
-            switch (change->action) {
-                case REORDER_BUFFER_CHANGE_INSERT:
-                case REORDER_BUFFER_CHANGE_UPDATE:
-                case REORDER_BUFFER_CHANGE_DELETE:
-                    Assert(snapshot_now);
-
-                    reloid = RelidByRelfilenode(change->data.tp.relnode.spcNode, change->data.tp.relnode.relNode);
-                    if (reloid == InvalidOid) {
-                        reloid = PartitionRelidByRelfilenode(
-                            change->data.tp.relnode.spcNode, change->data.tp.relnode.relNode, partitionReltoastrelid);
-                    }
-                    /*
-                     * Catalog tuple without data, emitted while catalog was
-                     * in the process of being rewritten.
-                     */
-                    if (reloid == InvalidOid && change->data.tp.newtuple == NULL && change->data.tp.oldtuple == NULL)
-                        continue;
-                    else if (reloid == InvalidOid) {
-                        /*
-                         * description:
-                         * When we try to decode a table who is already dropped.
-                         * Maybe we could not find it relnode.In this time, we will undecode this log.
-                         * It will be solve when we use MVCC.
-                         */
-                        ereport(DEBUG1,
-                            (errmsg(
-                                "could not lookup relation %s", relpathperm(change->data.tp.relnode, MAIN_FORKNUM))));
-                        continue;
-                    }
-
-                    relation = RelationIdGetRelation(reloid);
-                    if (relation == NULL) {
-                        ereport(DEBUG1,
-                            (errmsg("could open relation descriptor %s",
-                                relpathperm(change->data.tp.relnode, MAIN_FORKNUM))));
-                        continue;
-                    }
-
-                    if (CSTORE_NAMESPACE == get_rel_namespace(RelationGetRelid(relation))) {
-                        continue;
-                    }
-
-                    if (RelationIsLogicallyLogged(relation)) {
-                        /*
-                         * For now ignore sequence changes entirely. Most of
-                         * the time they don't log changes using records we
-                         * understand, so it doesn't make sense to handle the
-                         * few cases we do.
-                         */
-                        if (relation->rd_rel->relkind == RELKIND_SEQUENCE) {
-                        } else if (!IsToastRelation(relation)) { /* user-triggered change */
-                            ReorderBufferToastReplace(rb, txn, relation, change, partitionReltoastrelid);
-                            rb->apply_change(rb, txn, relation, change);
-                            /*
-                             * Only clear reassembled toast chunks if we're
-                             * sure they're not required anymore. The creator
-                             * of the tuple tells us.
-                             */
-                            if (change->data.tp.clear_toast_afterwards)
-                                ReorderBufferToastReset(rb, txn);
-                        } else if (change->action == REORDER_BUFFER_CHANGE_INSERT) {
-                            /* we're not interested in toast deletions
-                             *
-                             * Need to reassemble the full toasted Datum in
-                             * memory, to ensure the chunks don't get reused
-                             * till we're done remove it from the list of this
-                             * transaction's changes. Otherwise it will get
-                             * freed/reused while restoring spooled data from
-                             * disk.
-                             */
-                            dlist_delete(&change->node);
-                            ReorderBufferToastAppendChunk(rb, txn, relation, change);
-                        }
-                    }
-                    RelationClose(relation);
-                    break;
-                case REORDER_BUFFER_CHANGE_INTERNAL_SNAPSHOT:
-                    /* get rid of the old */
-                    TeardownHistoricSnapshot(false);
-
-                    if (snapshot_now->copied) {
-                        ReorderBufferFreeSnap(rb, snapshot_now);
-                        snapshot_now = NULL;
-                        snapshot_now = ReorderBufferCopySnap(rb, change->data.snapshot, txn, command_id);
-                    } else if (change->data.snapshot->copied) {
-                        /*
-                         * Restored from disk, need to be careful not to double
-                         * free. We could introduce refcounting for that, but for
-                         * now this seems infrequent enough not to care.
-                         */
-                        snapshot_now = ReorderBufferCopySnap(rb, change->data.snapshot, txn, command_id);
-                    } else {
-                        snapshot_now = change->data.snapshot;
-                    }
-
-                    /* and continue with the new one */
-                    SetupHistoricSnapshot(snapshot_now, txn->tuplecid_hash);
-                    break;
-
-                case REORDER_BUFFER_CHANGE_INTERNAL_COMMAND_ID:
-                    Assert(change->data.command_id != InvalidCommandId);
-
-                    if (command_id < change->data.command_id) {
-                        command_id = change->data.command_id;
-
-                        if (!snapshot_now->copied) {
-                            /* we don't use the global one anymore */
-                            snapshot_now = ReorderBufferCopySnap(rb, snapshot_now, txn, command_id);
-                        }
-
-                        snapshot_now->curcid = command_id;
-
-                        TeardownHistoricSnapshot(false);
-                        SetupHistoricSnapshot(snapshot_now, txn->tuplecid_hash);
-
-                        /*
-                         * Every time the CommandId is incremented, we could
-                         * see new catalog contents, so execute all
-                         * invalidations.
-                         */
-                        ReorderBufferExecuteInvalidations(rb, txn);
-                    }
-
-                    break;
-
-                case REORDER_BUFFER_CHANGE_INTERNAL_TUPLECID:
-                    ereport(ERROR, (errcode(ERRCODE_FEATURE_NOT_SUPPORTED), errmsg("tuplecid value in changequeue")));
-                    break;
-            }
+            (void)ReorderBufferApplyChange(
+                rb, txn, change, (Snapshot*)&snapshot_now, (CommandId*)&command_id, txn->streamed);
         }
 
         ReorderBufferIterTXNFinish(rb, iterstate);
         iterstate = NULL;
 
         /* call commit callback */
-        rb->commit(rb, txn, commit_lsn);
+        if (txn->streamed) {
+            rb->stream_stop(rb, txn);
+            rb->stream_commit(rb, txn, commit_lsn);
+            rb->stats.stream_count++;
+        } else {
+            rb->commit(rb, txn, commit_lsn);
+        }
+        rb->stats.total_txns++;
 
         /* this is just a sanity check against bad output plugin behaviour */
         if (GetCurrentTransactionIdIfAny() != InvalidTransactionId)
@@ -1507,6 +1596,124 @@ void ReorderBufferCommit(ReorderBuffer* rb, TransactionId xid, XLogRecPtr commit
     PG_END_TRY();
 }
 
+/*
+ * Can the changes of this transaction be streamed to the output plugin before
+ * it commits?
+ *
+ * Only toplevel transactions without subtransactions and without catalog
+ * changes are streamed. Their changes can be decoded with the snapshot of the
+ * transaction alone, and the changes of a subtransaction never have to be
+ * sent before changes streamed already: with wal_level logical the first
+ * record of a subtransaction assigns it to its parent (see
+ * IsSubTransactionAssignmentPending()), and no more blocks are streamed
+ * after that.
+ */
+static bool ReorderBufferCanStream(ReorderBuffer* rb, ReorderBufferTXN* txn)
+{
+    LogicalDecodingContext* ctx = (LogicalDecodingContext*)rb->private_data;
+
+    if (!ctx->streaming || txn->is_known_as_subxact || txn->nsubtxns > 0 || txn->has_catalog_changes ||
+        txn->serialized || txn->base_snapshot == NULL) {
+        return false;
+    }
+
+    /* the transaction must be one we are going to decode when it commits */
+    return SnapBuildCurrentState(ctx->snapshot_builder) == SNAPBUILD_CONSISTENT &&
+           !SnapBuildXactNeedsSkip(ctx->snapshot_builder, ctx->reader->EndRecPtr);
+}
+
+/*
+ * Stream the changes of a large in-progress transaction to the output plugin
+ * as one block, instead of spilling them to disk. The consumer has to keep
+ * them until the stream commit callback or drop them on stream abort.
+ */
+static void ReorderBufferStreamTXN(ReorderBuffer* rb, ReorderBufferTXN* txn)
+{
+    dlist_mutable_iter iter;
+    volatile CommandId command_id = FirstCommandId;
+    volatile Snapshot snapshot_now = NULL;
+    volatile bool txn_started = false;
+    volatile bool subtxn_started = false;
+
+    if (txn->streamed) {
+        snapshot_now = txn->snapshot_now;
+        command_id = txn->command_id;
+        txn->snapshot_now = NULL;
+    } else {
+        snapshot_now = txn->base_snapshot;
+    }
+
+    if (!RecoveryInProgress()) {
+        ereport(DEBUG2, (errmsg("stream %u changes in tx %lu", (uint32)txn->nentries_mem, txn->xid)));
+    }
+
+    SetupHistoricSnapshot(snapshot_now, txn->tuplecid_hash);
+
+    PG_TRY();
+    {
+        /* see ReorderBufferCommit() */
+        if (IsTransactionOrTransactionBlock()) {
+            BeginInternalSubTransaction("stream");
+            subtxn_started = true;
+        } else {
+            StartTransactionCommand();
+            txn_started = true;
+        }
+
+        rb->stream_start(rb, txn);
+        dlist_foreach_modify(iter, &txn->changes)
+        {
+            ReorderBufferChange* change = dlist_container(ReorderBufferChange, node, iter.cur);
+
+            if (ReorderBufferApplyChange(rb, txn, change, (Snapshot*)&snapshot_now, (CommandId*)&command_id, true)) {
+                dlist_delete(&change->node);
+                ReorderBufferReturnChange(rb, change);
+            }
+        }
+        rb->stream_stop(rb, txn);
+
+        /* this is just a sanity check against bad output plugin behaviour */
+        if (GetCurrentTransactionIdIfAny() != InvalidTransactionId)
+            ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                    errmsg("output plugin used xid %lu", GetCurrentTransactionId())));
+
+        TeardownHistoricSnapshot(false);
+
+        if (subtxn_started)
+            RollbackAndReleaseCurrentSubTransaction();
+        else if (txn_started)
+            AbortCurrentTransaction();
+    }
+    PG_CATCH();
+    {
+        TeardownHistoricSnapshot(true);
+
+        if (snapshot_now->copied)
+            ReorderBufferFreeSnap(rb, snapshot_now);
+
+        if (subtxn_started)
+            RollbackAndReleaseCurrentSubTransaction();
+        else if (txn_started)
+            AbortCurrentTransaction();
+
+        PG_RE_THROW();
+    }
+    PG_END_TRY();
+
+    Assert(dlist_is_empty(&txn->changes));
+    txn->nentries_mem = 0;
+
+    if (!txn->streamed)
+        rb->stats.stream_txns++;
+    rb->stats.stream_count++;
+
+    /* keep the decoding state for the next block */
+    txn->streamed = true;
+    txn->snapshot_now = snapshot_now;
+    txn->command_id = command_id;
+}
+
 /*
  * Abort a transaction that possibly has previous changes. Needs to be first
  * called for subtransactions and then for the toplevel xid.
@@ -1531,6 +1738,10 @@ void ReorderBufferAbort(ReorderBuffer* rb, TransactionId xid, XLogRecPtr lsn)
     /* cosmetic... */
     txn->final_lsn = lsn;
 
+    /* the consumer has to drop what it got of the transaction */
+    if (txn->streamed)
+        rb->stream_abort(rb, txn, lsn);
+
     /* remove potential on-disk data, and deallocate */
     ReorderBufferCleanupTXN(rb, txn);
 }
@@ -1562,6 +1773,9 @@ void ReorderBufferAbortOld(ReorderBuffer* rb, TransactionId oldestRunningXid, XL
             if (!RecoveryInProgress())
                 ereport(DEBUG2, (errmsg("aborting old transaction %lu", txn->xid)));
 
+            if (txn->streamed)
+                rb->stream_abort(rb, txn, lsn);
+
             /* remove potential on-disk data, and deallocate this tx */
             ReorderBufferCleanupTXN(rb, txn, lsn);
         } else
@@ -1617,6 +1831,13 @@ void ReorderBufferForget(ReorderBuffer* rb, TransactionId xid, XLogRecPtr lsn)
     } else
         Assert(txn->ninvalidations == 0);
 
+    /*
+     * The transaction is skipped at its commit, e.g. because of its origin,
+     * so the consumer has to drop what it got of it.
+     */
+    if (txn->streamed)
+        rb->stream_abort(rb, txn, lsn);
+
     /* remove potential on-disk data, and deallocate */
     ReorderBufferCleanupTXN(rb, txn);
 }
@@ -1843,7 +2064,11 @@ static void ReorderBufferCheckSerializeTXN(ReorderBuffer* rb, ReorderBufferTXN*
      * account here.
      */
     if (txn->nentries_mem >= (unsigned)g_instance.attr.attr_common.max_changes_in_memory) {
-        ReorderBufferSerializeTXN(rb, txn);
+        if (ReorderBufferCanStream(rb, txn)) {
+            ReorderBufferStreamTXN(rb, txn);
+        } else {
+            ReorderBufferSerializeTXN(rb, txn);
+        }
         Assert(txn->nentries_mem == 0);
     }
 }
@@ -1926,6 +2151,11 @@ static void ReorderBufferSerializeTXN(ReorderBuffer* rb, ReorderBufferTXN* txn)
 
     Assert(spilled == txn->nentries_mem);
     Assert(dlist_is_empty(&txn->changes));
+    if (spilled > 0) {
+        if (!txn->serialized)
+            rb->stats.spill_txns++;
+        rb->stats.spill_count++;
+    }
     txn->nentries_mem = 0;
     txn->serialized = true;
 
@@ -2048,6 +2278,7 @@ static void ReorderBufferSerializeChange(ReorderBuffer* rb, ReorderBufferTXN* tx
         (void)CloseTransientFile(fd);
         ereport(ERROR, (errcode_for_file_access(), errmsg("could not write to xid %lu's data file: %m", txn->xid)));
     }
+    rb->stats.spill_bytes += sz;
 
     Assert(ondisk->change.action == change->action);
 }
@@ -2579,7 +2810,7 @@ static void ReorderBufferToastReplace(ReorderBuffer* rb, ReorderBufferTXN* txn,
             securec_check(rc, "", "");
             data_done += VARSIZE(chunk) - VARHDRSZ;
         }
-        Assert(data_done == (Size)toast_pointer.va_extsize);
+        Assert(data_done == (Size)VARATT_EXTERNAL_GET_EXTSIZE(toast_pointer));
 
         /* make sure its marked as compressed or not */
         if (VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer))
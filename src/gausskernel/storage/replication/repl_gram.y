@@ -88,6 +88,9 @@
 %token K_NOWAIT
 %token K_WAL
 %token K_TABLESPACE_MAP
+%token K_COMPRESSION
+%token K_PARALLEL
+%token K_INCREMENTAL
 %token K_DATA
 %token K_START_REPLICATION
 %token K_FETCH_MOT_CHECKPOINT
@@ -216,6 +219,7 @@ identify_az:
 
 /*
  * BASE_BACKUP [LABEL '<label>'] [PROGRESS] [FAST] [WAL] [NOWAIT] [TABLESPACE_MAP]
+ *             [COMPRESSION '<method>'] [PARALLEL <n>] [INCREMENTAL '<lsn>']
  */
 base_backup:
 			K_BASE_BACKUP base_backup_opt_list
@@ -260,14 +264,29 @@ base_backup_opt:
 					$$ = makeDefElem("tablespace_map",
 							(Node *)makeInteger(TRUE));
 				}
+			| K_COMPRESSION SCONST
+				{
+					$$ = makeDefElem("compression",
+							(Node *)makeString($2));
+				}
+			| K_PARALLEL ICONST
+				{
+					$$ = makeDefElem("parallel",
+							(Node *)makeInteger($2));
+				}
+			| K_INCREMENTAL SCONST
+				{
+					$$ = makeDefElem("incremental",
+							(Node *)makeString($2));
+				}
 			;
 
 /*
  * START_REPLICATION %X/%X
- * START_REPLICATION [SLOT slot] [PHYSICAL] %X/%X
+ * START_REPLICATION [SLOT slot] [PHYSICAL] %X/%X [options]
  */
 start_replication:
-			K_START_REPLICATION opt_slot opt_physical RECPTR
+			K_START_REPLICATION opt_slot opt_physical RECPTR plugin_options
 				{
 					StartReplicationCmd *cmd;
 
@@ -275,6 +294,7 @@ start_replication:
 					cmd->kind = REPLICATION_KIND_PHYSICAL;
  					cmd->slotname = $2;
  					cmd->startpoint = $4;
+					cmd->options = $5;
 
 					$$ = (Node *) cmd;
 				}
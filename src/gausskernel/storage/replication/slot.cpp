@@ -270,6 +270,8 @@ void ReplicationSlotCreate(const char* name, ReplicationSlotPersistency persiste
     slot->data.database = databaseId;
     slot->data.restart_lsn = restart_lsn;
     slot->data.isDummyStandby = isDummyStandby;
+    rc = memset_s(&slot->decoding_stats, sizeof(ReplicationSlotDecodingStats), 0, sizeof(ReplicationSlotDecodingStats));
+    securec_check(rc, "\0", "\0");
 
     /*
      * Create the slot on disk.  We haven't actually marked the slot allocated
@@ -1414,6 +1416,9 @@ loop:
         slot->candidate_xmin_lsn = InvalidXLogRecPtr;
         slot->candidate_restart_lsn = InvalidXLogRecPtr;
         slot->candidate_restart_valid = InvalidXLogRecPtr;
+        rc = memset_s(
+            &slot->decoding_stats, sizeof(ReplicationSlotDecodingStats), 0, sizeof(ReplicationSlotDecodingStats));
+        securec_check(rc, "\0", "\0");
         slot->in_use = true;
         slot->active = false;
 
@@ -487,6 +487,87 @@ Datum pg_get_replication_slots(PG_FUNCTION_ARGS)
     return (Datum)0;
 }
 
+/*
+ * pg_stat_get_replication_slots - SQL SRF showing the decoding statistics of
+ * the logical replication slots.
+ */
+Datum pg_stat_get_replication_slots(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_REPLICATION_SLOTS_COLS 11
+    ReturnSetInfo* rsinfo = (ReturnSetInfo*)fcinfo->resultinfo;
+    TupleDesc tupdesc;
+    Tuplestorestate* tupstore = NULL;
+    MemoryContext per_query_ctx;
+    MemoryContext oldcontext;
+    int slotno;
+    errno_t rc = EOK;
+
+    /* check to see if caller supports us returning a tuplestore */
+    if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+        ereport(ERROR,
+            (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                errmsg("set-valued function called in context that cannot accept a set")));
+    if (!(rsinfo->allowedModes & SFRM_Materialize))
+        ereport(ERROR,
+            (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                errmsg("materialize mode required, but it is not "
+                       "allowed in this context")));
+
+    /* Build a tuple descriptor for our result type */
+    if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+        ereport(ERROR, (errcode(ERRCODE_DATATYPE_MISMATCH), errmsg("return type must be a row type")));
+
+    per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+    oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+    tupstore = tuplestore_begin_heap(true, false, u_sess->attr.attr_memory.work_mem);
+    rsinfo->returnMode = SFRM_Materialize;
+    rsinfo->setResult = tupstore;
+    rsinfo->setDesc = tupdesc;
+
+    (void)MemoryContextSwitchTo(oldcontext);
+
+    for (slotno = 0; slotno < g_instance.attr.attr_storage.max_replication_slots; slotno++) {
+        ReplicationSlot* slot = &t_thrd.slot_cxt.ReplicationSlotCtl->replication_slots[slotno];
+        Datum values[PG_STAT_GET_REPLICATION_SLOTS_COLS];
+        bool nulls[PG_STAT_GET_REPLICATION_SLOTS_COLS];
+        ReplicationSlotDecodingStats stats;
+        NameData slot_name;
+        int i = 0;
+
+        SpinLockAcquire(&slot->mutex);
+        /* physical slots don't decode anything */
+        if (!slot->in_use || slot->data.database == InvalidOid) {
+            SpinLockRelease(&slot->mutex);
+            continue;
+        }
+        slot_name = slot->data.name;
+        stats = slot->decoding_stats;
+        SpinLockRelease(&slot->mutex);
+
+        rc = memset_s(nulls, sizeof(nulls), 0, sizeof(nulls));
+        securec_check(rc, "\0", "\0");
+
+        values[i++] = CStringGetTextDatum(NameStr(slot_name));
+        values[i++] = Int64GetDatum(stats.spill_txns);
+        values[i++] = Int64GetDatum(stats.spill_count);
+        values[i++] = Int64GetDatum(stats.spill_bytes);
+        values[i++] = Int64GetDatum(stats.stream_txns);
+        values[i++] = Int64GetDatum(stats.stream_count);
+        values[i++] = Int64GetDatum(stats.stream_bytes);
+        values[i++] = Int64GetDatum(stats.total_txns);
+        values[i++] = Int64GetDatum(stats.total_bytes);
+        values[i++] = Int64GetDatum(stats.decoded_records);
+        values[i++] = Int64GetDatum(stats.decoded_bytes);
+
+        tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+    }
+
+    tuplestore_donestoring(tupstore);
+
+    return (Datum)0;
+}
+
 /*
  * pg_get_cur_replication_slot_name - SQL SRF showing replication slot name.
  */
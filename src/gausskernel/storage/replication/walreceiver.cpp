@@ -76,6 +76,7 @@
 #include "postmaster/postmaster.h"
 #include "hotpatch/hotpatch.h"
 #include "utils/distribute_test.h"
+#include "lz4.h"
 
 bool wal_catchup = false;
 
@@ -128,6 +129,7 @@ static void XLogWalRcvDataPageReplication(char* buf, Size len);
 static void XLogWalRcvProcessMsg(unsigned char type, char* buf, Size len);
 static void XLogWalRcvReceive(char* buf, Size nbytes, XLogRecPtr recptr);
 static void XLogWalRcvReceiveInBuf(char* buf, Size nbytes, XLogRecPtr recptr);
+static char* XLogWalRcvDecompress(const char* buf, Size len, uint32 raw_len);
 static void XLogWalRcvSendHSFeedback(void);
 static void XLogWalRcvSendSwitchRequest(void);
 static void WalDataRcvReceive(char* buf, Size nbytes, XLogRecPtr recptr);
@@ -899,6 +901,35 @@ static void XLogWalRcvProcessMsg(unsigned char type, char* buf, Size len)
             }
             break;
         }
+        case 'z': /* compressed WAL records */
+        {
+            WalDataMessageHeader msghdr;
+            WalCompressedDataHeader chdr;
+
+            if (len < sizeof(WalDataMessageHeader) + sizeof(WalCompressedDataHeader))
+                ereport(ERROR,
+                    (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                        errmsg_internal("invalid compressed WAL message received from primary")));
+            /* memcpy is required here for alignment reasons */
+            errorno = memcpy_s(&msghdr, sizeof(WalDataMessageHeader), buf, sizeof(WalDataMessageHeader));
+            securec_check(errorno, "\0", "\0");
+            buf += sizeof(WalDataMessageHeader);
+            len -= sizeof(WalDataMessageHeader);
+            errorno = memcpy_s(&chdr, sizeof(WalCompressedDataHeader), buf, sizeof(WalCompressedDataHeader));
+            securec_check(errorno, "\0", "\0");
+            buf += sizeof(WalCompressedDataHeader);
+            len -= sizeof(WalCompressedDataHeader);
+
+            ProcessWalHeaderMessage(&msghdr);
+
+            char* raw = XLogWalRcvDecompress(buf, len, chdr.raw_len);
+            if (IsExtremeRedo()) {
+                XLogWalRcvReceiveInBuf(raw, chdr.raw_len, msghdr.dataStart);
+            } else {
+                XLogWalRcvReceive(raw, chdr.raw_len, msghdr.dataStart);
+            }
+            break;
+        }
         case 'd': /* Data page replication for the logical xlog */
         {
             XLogWalRcvDataPageReplication(buf, len);
@@ -981,6 +1012,37 @@ static void XLogWalRcvProcessMsg(unsigned char type, char* buf, Size len)
     }
 }
 
+/*
+ * Decompress the WAL data of a compressed message (type 'z') into the
+ * decompression buffer of walreceiver, which is grown on demand.
+ */
+static char* XLogWalRcvDecompress(const char* buf, Size len, uint32 raw_len)
+{
+    if (raw_len == 0 || raw_len > (uint32)LZ4_MAX_INPUT_SIZE) {
+        ereport(ERROR,
+            (errcode(ERRCODE_PROTOCOL_VIOLATION),
+                errmsg_internal("invalid raw length %u of compressed WAL message", raw_len)));
+    }
+
+    if (t_thrd.walreceiver_cxt.decompress_buf_size < raw_len) {
+        if (t_thrd.walreceiver_cxt.decompress_buf != NULL) {
+            pfree(t_thrd.walreceiver_cxt.decompress_buf);
+        }
+        t_thrd.walreceiver_cxt.decompress_buf = (char*)MemoryContextAlloc(t_thrd.top_mem_cxt, raw_len);
+        t_thrd.walreceiver_cxt.decompress_buf_size = raw_len;
+    }
+
+    int rawsize = LZ4_decompress_safe(buf, t_thrd.walreceiver_cxt.decompress_buf, (int)len, (int)raw_len);
+    if (rawsize != (int)raw_len) {
+        ereport(ERROR,
+            (errcode(ERRCODE_DATA_CORRUPTED),
+                errmsg("could not decompress WAL message received from primary, expected %u bytes, got %d",
+                    raw_len,
+                    rawsize)));
+    }
+    return t_thrd.walreceiver_cxt.decompress_buf;
+}
+
 void WSDataRcvCheck(char* data_buf, Size nbytes)
 {
     errno_t errorno = EOK;
@@ -97,6 +97,7 @@
 #include "postmaster/postmaster.h"
 #include "alarm/alarm.h"
 #include "utils/distribute_test.h"
+#include "lz4.h"
 
 #define CRC_LEN 11
 
@@ -157,6 +158,8 @@ static void IdentifyChannel(IdentifyChannelCmd* cmd);
 static void CreateReplicationSlot(const CreateReplicationSlotCmd* cmd);
 static void DropReplicationSlot(DropReplicationSlotCmd* cmd);
 static void StartReplication(StartReplicationCmd* cmd);
+static void WalSndParseStreamOptions(List* options);
+static Size WalSndCompressXLogMessage(Size nbytes);
 static void StartLogicalReplication(StartReplicationCmd* cmd);
 static void ProcessStandbyMessage(void);
 static void ProcessStandbyReplyMessage(void);
@@ -188,6 +191,7 @@ static void WalSndWriteData(LogicalDecodingContext* ctx, XLogRecPtr lsn, Transac
 static XLogRecPtr WalSndWaitForWal(XLogRecPtr loc);
 
 static void XLogRead(char* buf, XLogRecPtr startptr, Size count);
+static void WalSndCountXLogRead(Size buffer_bytes, Size file_bytes);
 
 static void SetWalSndPeerMode(ServerMode mode);
 static void SetWalSndPeerDbstate(DbState state);
@@ -1048,6 +1052,8 @@ static void StartReplication(StartReplicationCmd* cmd)
      */
     WalSndSetState(WALSNDSTATE_CATCHUP);
 
+    WalSndParseStreamOptions(cmd->options);
+
     /* Send a CopyBothResponse message, and start streaming */
     pq_beginmessage(&buf, 'W');
     pq_sendbyte(&buf, 0);
@@ -1067,6 +1073,51 @@ static void StartReplication(StartReplicationCmd* cmd)
     }
 }
 
+/*
+ * Process the options of physical START_REPLICATION. The only one known is
+ * "compression", the compression of the WAL stream asked by walreceiver.
+ */
+static void WalSndParseStreamOptions(List* options)
+{
+    ListCell* lc = NULL;
+    int compression = WAL_STREAM_COMPRESS_OFF;
+
+    foreach (lc, options) {
+        DefElem* defel = (DefElem*)lfirst(lc);
+
+        if (strcmp(defel->defname, "compression") != 0) {
+            ereport(ERROR,
+                (errcode(ERRCODE_SYNTAX_ERROR),
+                    errmsg("unrecognized START_REPLICATION option \"%s\"", defel->defname)));
+        }
+
+        char* method = (defel->arg != NULL) ? strVal(defel->arg) : NULL;
+        if (method != NULL && pg_strcasecmp(method, "lz4") == 0) {
+            compression = WAL_STREAM_COMPRESS_LZ4;
+        } else if (method != NULL && pg_strcasecmp(method, "off") == 0) {
+            compression = WAL_STREAM_COMPRESS_OFF;
+        } else {
+            ereport(ERROR,
+                (errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+                    errmsg("unsupported WAL stream compression \"%s\"", method != NULL ? method : "")));
+        }
+    }
+
+    /* the messages of mixed replication carry data pages, keep them as they are */
+    if (compression != WAL_STREAM_COMPRESS_OFF && g_instance.attr.attr_storage.enable_mix_replication) {
+        ereport(LOG, (errmsg("WAL stream compression is not supported with enable_mix_replication, ignored")));
+        compression = WAL_STREAM_COMPRESS_OFF;
+    }
+
+    t_thrd.walsender_cxt.wal_stream_compression = compression;
+
+    /* use volatile pointer to prevent code rearrangement */
+    volatile WalSnd* walsnd = t_thrd.walsender_cxt.MyWalSnd;
+    SpinLockAcquire(&walsnd->mutex);
+    walsnd->compression = compression;
+    SpinLockRelease(&walsnd->mutex);
+}
+
 /*
  * read_page callback for logical decoding contexts, as a walsender process.
  *
@@ -2711,10 +2762,14 @@ static void WSDataSendInit()
      * just once to reduce palloc overhead.  The buffer must be made large
      * enough for maximum-sized messages.
      */
-    if (!g_instance.attr.attr_storage.enable_mix_replication)
+    if (!g_instance.attr.attr_storage.enable_mix_replication) {
         t_thrd.walsender_cxt.output_xlog_message =
             (char*)palloc(1 + sizeof(WalDataMessageHeader) + (int)WS_MAX_SEND_SIZE);
-    else {
+        if (t_thrd.walsender_cxt.wal_stream_compression == WAL_STREAM_COMPRESS_LZ4) {
+            t_thrd.walsender_cxt.output_compressed_message = (char*)palloc(1 + sizeof(WalDataMessageHeader) +
+                sizeof(WalCompressedDataHeader) + LZ4_compressBound((int)WS_MAX_SEND_SIZE));
+        }
+    } else {
         t_thrd.walsender_cxt.output_xlog_msg_prefix_len =
             1 + sizeof(WalDataMessageHeader) + sizeof(uint32) + 1 + sizeof(XLogRecPtr);
         t_thrd.walsender_cxt.output_xlog_message =
@@ -3344,6 +3399,12 @@ static void InitWalSnd(void)
             walsnd->log_ctrl.prev_reply_time = 0;
             walsnd->log_ctrl.pre_rate1 = 0;
             walsnd->log_ctrl.pre_rate2 = 0;
+            walsnd->compression = WAL_STREAM_COMPRESS_OFF;
+            walsnd->sent_raw_bytes = 0;
+            walsnd->sent_compressed_bytes = 0;
+            walsnd->compress_time = 0;
+            walsnd->buffer_read_bytes = 0;
+            walsnd->file_read_bytes = 0;
             SpinLockRelease(&walsnd->mutex);
             /* don't need the lock anymore */
             OwnLatch((Latch*)&walsnd->latch);
@@ -3462,11 +3523,11 @@ static void WalSndShutdown(void)
 
 /*
  * Read 'count' bytes from WAL into 'buf', starting at location 'startptr'.
- * XXX probably this should be improved to suck data directly from the
- * WAL buffers when possible. Will open, and keep open, one WAL segment 
- * stored in the global file descriptor sendFile. This means if XLogRead is used
- * once, there will always be one descriptor left open until the process ends, but never
- * more than one.
+ * On a primary, the WAL still resident in the WAL buffers is copied from
+ * there. The rest is read from the segment files. Will open, and keep open,
+ * one WAL segment stored in the global file descriptor sendFile. This means
+ * if XLogRead is used once, there will always be one descriptor left open
+ * until the process ends, but never more than one.
  */
 static void XLogRead(char* buf, XLogRecPtr startptr, Size count)
 {
@@ -3474,6 +3535,18 @@ static void XLogRead(char* buf, XLogRecPtr startptr, Size count)
     XLogRecPtr recptr;
     Size nbytes;
     XLogSegNo segno;
+    Size buffer_bytes = 0;
+
+    if (!AM_WAL_STANDBY_SENDER && !dummyStandbyMode) {
+        buffer_bytes = XLogReadFromBuffers(buf, startptr, count);
+    }
+    WalSndCountXLogRead(buffer_bytes, count - buffer_bytes);
+    if (buffer_bytes == count) {
+        return;
+    }
+    buf += buffer_bytes;
+    XLByteAdvance(startptr, buffer_bytes);
+    count -= buffer_bytes;
 
 retry:
     p = buf;
@@ -3604,6 +3677,23 @@ retry:
     WalSegmemtRemovedhappened = false;
 }
 
+/*
+ * Account the WAL read by XLogRead from the WAL buffers and from the files.
+ */
+static void WalSndCountXLogRead(Size buffer_bytes, Size file_bytes)
+{
+    /* use volatile pointer to prevent code rearrangement */
+    volatile WalSnd* walsnd = t_thrd.walsender_cxt.MyWalSnd;
+
+    if (walsnd == NULL) {
+        return;
+    }
+    SpinLockAcquire(&walsnd->mutex);
+    walsnd->buffer_read_bytes += buffer_bytes;
+    walsnd->file_read_bytes += file_bytes;
+    SpinLockRelease(&walsnd->mutex);
+}
+
 /*
  * Stream out logically decoded data.
  */
@@ -3805,8 +3895,25 @@ static void XLogSendPhysical(void)
         &msghdr,
         sizeof(WalDataMessageHeader));
     securec_check(errorno, "\0", "\0");
-    (void)pq_putmessage_noblock(
-        'd', t_thrd.walsender_cxt.output_xlog_message, 1 + sizeof(WalDataMessageHeader) + nbytes);
+
+    Size msglen = 0;
+    uint64 compress_time = 0;
+    if (t_thrd.walsender_cxt.wal_stream_compression != WAL_STREAM_COMPRESS_OFF && nbytes > 0) {
+        instr_time start_time;
+        instr_time duration;
+
+        INSTR_TIME_SET_CURRENT(start_time);
+        msglen = WalSndCompressXLogMessage(nbytes);
+        INSTR_TIME_SET_CURRENT(duration);
+        INSTR_TIME_SUBTRACT(duration, start_time);
+        compress_time = INSTR_TIME_GET_MICROSEC(duration);
+    }
+    if (msglen > 0) {
+        (void)pq_putmessage_noblock('d', t_thrd.walsender_cxt.output_compressed_message, msglen);
+    } else {
+        msglen = 1 + sizeof(WalDataMessageHeader) + nbytes;
+        (void)pq_putmessage_noblock('d', t_thrd.walsender_cxt.output_xlog_message, msglen);
+    }
 
     t_thrd.walsender_cxt.sentPtr = endptr;
 
@@ -3817,6 +3924,9 @@ static void XLogSendPhysical(void)
 
         SpinLockAcquire(&walsnd->mutex);
         walsnd->sentPtr = t_thrd.walsender_cxt.sentPtr;
+        walsnd->sent_raw_bytes += nbytes;
+        walsnd->sent_compressed_bytes += msglen - (1 + sizeof(WalDataMessageHeader));
+        walsnd->compress_time += compress_time;
         SpinLockRelease(&walsnd->mutex);
     }
 
@@ -3839,6 +3949,36 @@ static void XLogSendPhysical(void)
     return;
 }
 
+/*
+ * Build the compressed counterpart (message type 'z') of the WAL message just
+ * filled in output_xlog_message, carrying nbytes of WAL. Returns the length
+ * of the compressed message, or 0 if compression does not pay off and the
+ * plain message is to be sent.
+ */
+static Size WalSndCompressXLogMessage(Size nbytes)
+{
+    const Size hdrlen = 1 + sizeof(WalDataMessageHeader);
+    char* src = t_thrd.walsender_cxt.output_xlog_message;
+    char* dst = t_thrd.walsender_cxt.output_compressed_message;
+    WalCompressedDataHeader chdr;
+    errno_t errorno = EOK;
+
+    int bound = LZ4_compressBound((int)WS_MAX_SEND_SIZE);
+    int clen = LZ4_compress_default(src + hdrlen, dst + hdrlen + sizeof(WalCompressedDataHeader), (int)nbytes, bound);
+    if (clen <= 0 || (Size)clen + sizeof(WalCompressedDataHeader) >= nbytes) {
+        return 0;
+    }
+
+    dst[0] = 'z';
+    errorno = memcpy_s(dst + 1, sizeof(WalDataMessageHeader), src + 1, sizeof(WalDataMessageHeader));
+    securec_check(errorno, "\0", "\0");
+    chdr.raw_len = (uint32)nbytes;
+    errorno = memcpy_s(dst + hdrlen, sizeof(WalCompressedDataHeader), &chdr, sizeof(WalCompressedDataHeader));
+    securec_check(errorno, "\0", "\0");
+
+    return hdrlen + sizeof(WalCompressedDataHeader) + (Size)clen;
+}
+
 /*
  * Request walsenders to reload the currently-open WAL file
  */
@@ -4254,7 +4394,7 @@ Tuplestorestate* BuildTupleResult(FunctionCallInfo fcinfo, TupleDesc* tupdesc)
  */
 Datum pg_stat_get_wal_senders(PG_FUNCTION_ARGS)
 {
-#define PG_STAT_GET_WAL_SENDERS_COLS 21
+#define PG_STAT_GET_WAL_SENDERS_COLS 27
 
     TupleDesc tupdesc;
     Tuplestorestate* tupstore = NULL;
@@ -4308,6 +4448,12 @@ Datum pg_stat_get_wal_senders(PG_FUNCTION_ARGS)
         XLogRecPtr sndReplay;
         XLogRecPtr RcvReceived;
         XLogRecPtr syncStart;
+        int compression;
+        uint64 sent_raw_bytes;
+        uint64 sent_compressed_bytes;
+        uint64 compress_time;
+        uint64 buffer_read_bytes;
+        uint64 file_read_bytes;
 
         int sync_percent = 0;
         ServerMode peer_role;
@@ -4356,6 +4502,12 @@ Datum pg_stat_get_wal_senders(PG_FUNCTION_ARGS)
         syncStart = walsnd->syncPercentCountStart;
         catchup_time[0] = walsnd->catchupTime[0];
         catchup_time[1] = walsnd->catchupTime[1];
+        compression = walsnd->compression;
+        sent_raw_bytes = walsnd->sent_raw_bytes;
+        sent_compressed_bytes = walsnd->sent_compressed_bytes;
+        compress_time = walsnd->compress_time;
+        buffer_read_bytes = walsnd->buffer_read_bytes;
+        file_read_bytes = walsnd->file_read_bytes;
         if (IS_DN_MULTI_STANDYS_MODE())
             priority = walsnd->sync_standby_priority;
         SpinLockRelease(&walsnd->mutex);
@@ -4551,6 +4703,16 @@ Datum pg_stat_get_wal_senders(PG_FUNCTION_ARGS)
                 remoteport);
             securec_check_ss(ret, "\0", "\0");
             values[j++] = CStringGetTextDatum(location);
+
+            /* WAL stream compression */
+            values[j++] = CStringGetTextDatum(compression == WAL_STREAM_COMPRESS_LZ4 ? "lz4" : "off");
+            values[j++] = UInt64GetDatum(sent_raw_bytes);
+            values[j++] = UInt64GetDatum(sent_compressed_bytes);
+            values[j++] = UInt64GetDatum(compress_time);
+
+            /* WAL read from the WAL buffers and from the segment files */
+            values[j++] = UInt64GetDatum(buffer_read_bytes);
+            values[j++] = UInt64GetDatum(file_read_bytes);
         }
 
         tuplestore_putvalues(tupstore, tupdesc, values, nulls);
@@ -626,7 +626,11 @@ void mdprefetch(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum)
     off_t seekpos;
     MdfdVec* v = NULL;
 
-    v = _mdfd_getseg(reln, forknum, blocknum, false, EXTENSION_FAIL);
+    /* prefetch is only a hint, the redo dispatcher may ask for blocks of files not existing (yet) */
+    v = _mdfd_getseg(reln, forknum, blocknum, false, EXTENSION_RETURN_NULL);
+    if (v == NULL) {
+        return;
+    }
 
     seekpos = (off_t)BLCKSZ * (blocknum % ((BlockNumber)RELSEG_SIZE));
 
@@ -1215,6 +1219,83 @@ void mdwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, const
     }
 }
 
+/*
+ *  mdwritebatch() -- Write a batch of blocks, see mdwrite().
+ *
+ *      Adjacent blocks of a segment whose buffers are contiguous in memory
+ *      are written with a single write, and all the writes are handed to
+ *      FilePIOBatch() at once. The segments written successfully are
+ *      registered for fsync before a failure of another block is reported.
+ */
+void mdwritebatch(SMgrWriteBlock* blocks, int nblocks, bool skipFsync)
+{
+    FileIORequest* reqs = (FileIORequest*)palloc(sizeof(FileIORequest) * nblocks);
+    MdfdVec** segs = (MdfdVec**)palloc(sizeof(MdfdVec*) * nblocks);
+    int* firsts = (int*)palloc(sizeof(int) * nblocks);
+    int nreqs = 0;
+    int failed = -1;
+
+    for (int i = 0; i < nblocks; i++) {
+        SMgrWriteBlock* block = &blocks[i];
+
+        if (nreqs > 0) {
+            SMgrWriteBlock* prev = &blocks[i - 1];
+            FileIORequest* last = &reqs[nreqs - 1];
+
+            if (block->reln == prev->reln && block->forknum == prev->forknum &&
+                block->blocknum == prev->blocknum + 1 && block->blocknum % ((BlockNumber)RELSEG_SIZE) != 0 &&
+                block->buffer == prev->buffer + BLCKSZ) {
+                last->amount += BLCKSZ;
+                continue;
+            }
+        }
+
+        segs[nreqs] = _mdfd_getseg(block->reln, block->forknum, block->blocknum, skipFsync, EXTENSION_FAIL);
+        firsts[nreqs] = i;
+        reqs[nreqs].file = segs[nreqs]->mdfd_vfd;
+        reqs[nreqs].is_write = true;
+        reqs[nreqs].buffer = (char*)block->buffer;
+        reqs[nreqs].amount = BLCKSZ;
+        reqs[nreqs].offset = (off_t)BLCKSZ * (block->blocknum % ((BlockNumber)RELSEG_SIZE));
+        nreqs++;
+    }
+
+    FilePIOBatch(reqs, nreqs, WAIT_EVENT_DATA_FILE_WRITE);
+
+    for (int r = 0; r < nreqs; r++) {
+        SMgrWriteBlock* block = &blocks[firsts[r]];
+
+        if (reqs[r].result != reqs[r].amount && failed < 0) {
+            failed = r;
+        }
+        if (reqs[r].result > 0 && !skipFsync && !SmgrIsTemp(block->reln)) {
+            register_dirty_segment(block->reln, block->forknum, segs[r]);
+        }
+    }
+
+    if (failed >= 0) {
+        FileIORequest* req = &reqs[failed];
+        int written = (req->result > 0) ? req->result : 0;
+        BlockNumber blocknum = blocks[firsts[failed]].blocknum + (BlockNumber)(written / BLCKSZ);
+
+        errno = req->err;
+        if (req->result < 0) {
+            ereport(ERROR,
+                (errcode_for_file_access(),
+                    errmsg("could not write block %u in file \"%s\": %m", blocknum, FilePathName(req->file))));
+        }
+        ereport(ERROR,
+            (errcode(ERRCODE_DISK_FULL),
+                errmsg("could not write block %u in file \"%s\": wrote only %d of %d bytes",
+                    blocknum, FilePathName(req->file), written % BLCKSZ, BLCKSZ),
+                errhint("Check free disk space.")));
+    }
+
+    pfree(reqs);
+    pfree(segs);
+    pfree(firsts);
+}
+
 /*
  *  mdnblocks() -- Get the number of blocks stored in a relation.
  *
@@ -1398,6 +1479,45 @@ void mdimmedsync(SMgrRelation reln, ForkNumber forknum)
     }
 }
 
+/* fsync time of the files of a tablespace, reported by mdsync() */
+typedef struct MdSyncTablespaceStats {
+    Oid spcNode;
+    int files;
+    uint64 longest;
+    uint64 total_elapsed;
+} MdSyncTablespaceStats;
+
+static void mdsync_count_tablespace(
+    MdSyncTablespaceStats** stats, int* nstats, int* maxstats, Oid spcNode, uint64 elapsed)
+{
+    MdSyncTablespaceStats* stat = NULL;
+
+    for (int i = 0; i < *nstats; i++) {
+        if ((*stats)[i].spcNode == spcNode) {
+            stat = &(*stats)[i];
+            break;
+        }
+    }
+    if (stat == NULL) {
+        if (*nstats == *maxstats) {
+            *maxstats = (*maxstats == 0) ? 8 : *maxstats * 2;
+            if (*stats == NULL) {
+                *stats = (MdSyncTablespaceStats*)palloc(sizeof(MdSyncTablespaceStats) * (*maxstats));
+            } else {
+                *stats = (MdSyncTablespaceStats*)repalloc(*stats, sizeof(MdSyncTablespaceStats) * (*maxstats));
+            }
+        }
+        stat = &(*stats)[(*nstats)++];
+        stat->spcNode = spcNode;
+        stat->files = 0;
+        stat->longest = 0;
+        stat->total_elapsed = 0;
+    }
+    stat->files++;
+    stat->longest = Max(stat->longest, elapsed);
+    stat->total_elapsed += elapsed;
+}
+
 /*
  *  mdsync() -- Sync previous writes to stable storage.
  */
@@ -1413,6 +1533,9 @@ void mdsync(void)
     uint64 elapsed;
     uint64 longest = 0;
     uint64 total_elapsed = 0;
+    MdSyncTablespaceStats* ts_stats = NULL;
+    int ts_nstats = 0;
+    int ts_maxstats = 0;
 
     /*
      * This is only called during checkpoints, and checkpoints should only
@@ -1586,6 +1709,8 @@ void mdsync(void)
                         total_elapsed += elapsed;
                         processed++;
                         if (u_sess->attr.attr_common.log_checkpoints) {
+                            mdsync_count_tablespace(
+                                &ts_stats, &ts_nstats, &ts_maxstats, entry->rnode.spcNode, elapsed);
                             ereport(DEBUG1,
                                 (errmsg("checkpoint sync: number=%d file=%s time=%.3f msec",
                                     processed,
@@ -1668,6 +1793,18 @@ void mdsync(void)
     t_thrd.xlog_cxt.CheckpointStats->ckpt_longest_sync = longest;
     t_thrd.xlog_cxt.CheckpointStats->ckpt_agg_sync_time = total_elapsed;
 
+    for (int i = 0; i < ts_nstats; i++) {
+        ereport(LOG,
+            (errmsg("checkpoint sync of tablespace %u: files=%d, longest=%.3f s, total=%.3f s",
+                ts_stats[i].spcNode,
+                ts_stats[i].files,
+                (double)ts_stats[i].longest / 1000000,
+                (double)ts_stats[i].total_elapsed / 1000000)));
+    }
+    if (ts_stats != NULL) {
+        pfree(ts_stats);
+    }
+
     /* Flag successful completion of mdsync */
     u_sess->storage_cxt.mdsync_in_progress = false;
 }
@@ -2166,8 +2303,11 @@ static MdfdVec* _mdfd_getseg(
              * with zeroes if needed.  (This only matters if caller is
              * extending the relation discontiguously, but that can happen in
              * hash indexes.)
+             *
+             * EXTENSION_RETURN_NULL callers only probe the segment, e.g. the redo
+             * dispatcher prefetching blocks, so never create segments for them.
              */
-            if (behavior == EXTENSION_CREATE || t_thrd.xlog_cxt.InRecovery) {
+            if (behavior == EXTENSION_CREATE || (t_thrd.xlog_cxt.InRecovery && behavior != EXTENSION_RETURN_NULL)) {
                 if (_mdnblocks(reln, forknum, v) < RELSEG_SIZE) {
                     char* zerobuf = NULL;
                     ADIO_RUN()
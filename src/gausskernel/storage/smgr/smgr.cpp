@@ -61,6 +61,7 @@ typedef struct f_smgr {
     void (*smgr_post_ckpt)(void); /* may be NULL */
     void (*smgr_async_read)(SMgrRelation reln, ForkNumber forknum, AioDispatchDesc_t** dList, int32 dn);
     void (*smgr_async_write)(SMgrRelation reln, ForkNumber forknum, AioDispatchDesc_t** dList, int32 dn);
+    void (*smgr_write_batch)(SMgrWriteBlock* blocks, int nblocks, bool skipFsync);
 } f_smgr;
 
 static const f_smgr g_smgrsw[] = {
@@ -83,7 +84,8 @@ static const f_smgr g_smgrsw[] = {
         mdsync,
         mdpostckpt,
         mdasyncread,
-        mdasyncwrite}};
+        mdasyncwrite,
+        mdwritebatch}};
 
 static const int SMGRSW_LENGTH = lengthof(g_smgrsw);
 
@@ -585,6 +587,20 @@ void smgrwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, cons
     (*(g_smgrsw[reln->smgr_which].smgr_write))(reln, forknum, blocknum, buffer, skipFsync);
 }
 
+/*
+ * smgrwritebatch() -- Write a batch of blocks, see smgrwrite().
+ *
+ * The blocks are handed to the kernel together, so that they can be
+ * submitted with a single system call when io_uring is enabled.
+ */
+void smgrwritebatch(SMgrWriteBlock* blocks, int nblocks, bool skipFsync)
+{
+    if (nblocks == 0) {
+        return;
+    }
+    (*(g_smgrsw[blocks[0].reln->smgr_which].smgr_write_batch))(blocks, nblocks, skipFsync);
+}
+
 /*
  *  smgrwriteback() -- Trigger kernel writeback for the supplied range of
  *                 blocks.
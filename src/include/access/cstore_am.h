@@ -273,6 +273,8 @@ private:  // private methods.
     bool NeedLoadCUDesc(int32 &cudesc_idx);
     void IncLoadCuDescIdx(int &idx) const;
     bool RoughCheck(CStoreScanKey scanKey, int nkeys, int cuDescIdx);
+    bool RoughCheckValue(int keyIdx, CUDesc *cudesc, Datum arg);
+    bool RoughCheckInList(CStoreScanKey scanKey, int keyIdx, CUDesc *cudesc);
 
     void FillColMinMax(CUDesc *cuDescPtr, ScalarVector *vec, int pos);
 
@@ -330,6 +332,13 @@ private:
     // 
     RoughCheckFunc *m_RCFuncs;
 
+    // Column type of each scan key which can consult CU bloom filters,
+    // otherwise InvalidOid. m_RCBloomCols marks the columns whose bloom
+    // filters should be loaded together with CUDesc.
+    //
+    Oid *m_RCBloomTypes;
+    bool *m_RCBloomCols;
+
     typedef int (CStore::*m_colFillFun)(int seq, CUDesc *cuDescPtr, ScalarVector *vec);
 
     typedef struct {
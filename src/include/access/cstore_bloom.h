@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * cstore_bloom.h
+ *        per-CU bloom filters used by ColStore rough check
+ *
+ * A bloom filter is built for every normal CU of a column whose attribute
+ * option "bloom_filter" is on. It is stored in the "extra" field of the
+ * CUDesc tuple, and it lets the rough check skip CUs for '=' and IN
+ * predicates even if the min/max range of the CU covers the key.
+ *
+ * IDENTIFICATION
+ *        src/include/access/cstore_bloom.h
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+
+#ifndef CSTORE_BLOOM_H
+#define CSTORE_BLOOM_H
+
+#include "utils/relcache.h"
+#include "catalog/pg_attribute.h"
+
+#define CU_BLOOM_VERSION 1
+
+/* number of probes per value, fixed when the filter is built */
+#define CU_BLOOM_NUM_HASHES 3
+
+/* the filter size is 2^N bits, bounded by the following two */
+#define CU_BLOOM_MIN_BITS_LOG2 9
+#define CU_BLOOM_MAX_BITS_LOG2 19
+
+/* bits reserved for each distinct value of the CU */
+#define CU_BLOOM_BITS_PER_VALUE 8
+
+/*
+ * Serialized layout, stored as the content of the CUDesc "extra" field:
+ *   CUBloomHeader | bitmap of (1 << log2bits) bits
+ */
+typedef struct CUBloomHeader {
+    uint8 version;
+    uint8 nhashes;
+    uint8 log2bits;
+    uint8 reserved;
+    uint32 ndistinct; /* distinct-value estimate of this CU */
+} CUBloomHeader;
+
+extern bool CUBloomSupportType(Oid typeOid);
+extern bool CUBloomEnabled(Relation rel, Form_pg_attribute attr);
+
+extern uint32 CUBloomHashValue(Oid typeOid, Datum value);
+extern bool CUBloomHashScanKey(Oid typeOid, Datum arg, uint32* hash);
+
+extern char* CUBloomBuild(const uint32* hashes, int nhashes);
+extern Size CUBloomSize(const char* bloom);
+extern char* CUBloomLoad(Datum extra);
+extern bool CUBloomMayContain(const char* bloom, uint32 hash);
+
+#endif /* CSTORE_BLOOM_H */
@@ -32,6 +32,7 @@
 #include "access/cstore_minmax_func.h"
 #include "storage/cstore_compress.h"
 #include "storage/spin.h"
+#include "portability/instr_time.h"
 
 struct InsertArg {
     /* map to CStoreInsert::m_tmpBatchRows.
@@ -138,6 +139,10 @@ private:
     // Get min/max of CU
     // 
     CU *FormCU(int col, bulkload_rows *batchRowPtr, CUDesc *cuDescPtr);
+    bool NeedParallelCompress(bulkload_rows *batchRowPtr) const;
+    void CompressCUsInParallel(bulkload_rows *batchRowPtr);
+    void ReportLoadTiming();
+    char *FormCUBloom(int col, bulkload_rows *batchRowPtr);
     Size FormCUTInitMem(CU *cuPtr, bulkload_rows *batchRowPtr, int col, bool hasNull);
     void FormCUTCopyMem(CU *cuPtr, bulkload_rows *batchRowPtr, CUDesc *cuDescPtr, Size dtSize, int col, bool hasNull);
     template <bool hasNull>
@@ -186,6 +191,7 @@ private:
     /* Function Pointer Array Area */
     FuncSetMinMax *m_setMinMaxFuncs;    /* min/max value function */
     FormCUFuncArray *m_formCUFuncArray; /* Form CU function pointer */
+    bool *m_cuBloomCols;                /* whether to build CU bloom filter */
 
     /* If relation has cluster key, it will work for partial sort */
     CStorePSort *m_sorter;
@@ -195,6 +201,8 @@ private:
     CUStorage **m_cuStorage;               /* CU storage */
     compression_options *m_cuCmprsOptions; /* compression filter */
     cu_tmp_compress_info m_cuTempInfo;     /* temp info for CU compression */
+    cu_tmp_compress_info *m_cuTempInfos;   /* temp info of each column if compression is deferred */
+    bool m_deferCompress;                  /* FormCU() leaves compression to CompressCUsInParallel() */
 
     /* buffered batchrows for many VectorBatch values */
     bulkload_rows *m_bufferedBatchRows;
@@ -241,8 +249,18 @@ private:
 
     /* indicate the end of insert or not */
     bool m_insert_end_flag;
+
+    /* elapsed time of each load stage, reported by ReportLoadTiming() */
+    instr_time m_formTime;
+    instr_time m_compressTime;
+    instr_time m_writeTime;
+    instr_time m_indexTime;
+    int m_loadBatches;
+    int m_parallelBatches;
 };
 
+extern void CStoreCompressWorkerMain(void *seg);
+
 enum PartitionCacheStrategy {
     CACHE_EACH_PARTITION_AS_POSSIBLE = 0,  // cache every partition as much as possible,  default strategy
     FLASH_WHEN_SWICH_PARTITION             // flash cached data when switch partition
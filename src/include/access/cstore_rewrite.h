@@ -214,6 +214,7 @@ private:
 
     void FetchCudescFrozenXid(Relation oldCudescHeap);
 
+    char *FormCuBloom(_in_ Oid typeOid, _in_ int rowsCntInCu);
     void InsertNewCudescTup(_in_ CUDesc *pCudesc, _in_ TupleDesc pCudescTupDesc, _in_ Form_pg_attribute pColNewAttr);
 
     void HandleWholeDeletedCu(_in_ uint32 cuId, _in_ int rowsCntInCu, _in_ int nRewriteCols,
@@ -252,6 +253,7 @@ private:
     CStoreRewriteColumn **m_SDTColsInfo;
     CUStorage **m_SDTColsReader;
     FuncSetMinMax *m_SDTColsMinMaxFunc;
+    bool *m_SDTColsBloom;
     CUStorage **m_SDTColsWriter;
     Datum *m_SDTColValues;
     bool *m_SDTColIsNull;
@@ -54,6 +54,8 @@ typedef struct CStoreScanKeyData {
     FmgrInfo cs_func;                  // op func
     Datum cs_argument;                 // op args.
     Oid cs_left_type;                  // op left type
+    int cs_nelems;                     // number of not-null values in IN list
+    Datum *cs_elems;                   // values of IN list, NULL if not an IN key
 } CStoreScanKeyData;
 
 typedef CStoreScanKeyData *CStoreScanKey;
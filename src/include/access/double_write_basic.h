@@ -38,6 +38,12 @@ static const char DW_FILE_NAME[] = "global/pg_dw";
 
 static const char DW_BUILD_FILE_NAME[] = "global/pg_dw.build";
 
+/* double write files other than the first one are named "global/pg_dw_<file_id>" */
+static const char DW_FILE_NAME_PREFIX[] = "global/pg_dw_";
+
+/* upper limit of dw_file_num, one file for each of pagewriter and 8 bgwriters at most */
+#define DW_MAX_FILE_NUM 16
+
 static const uint32 DW_TRY_WRITE_TIMES = 8;
 
 static const int DW_FILE_FLAG = (O_RDWR | O_SYNC | O_DIRECT | PG_BINARY);
@@ -94,6 +100,8 @@ const static uint16 DW_WRITE_STAT_LOWER_LIMIT = 16;
 
 const static int DW_VIEW_COL_NUM = 11;
 
+const static int DW_FILE_VIEW_COL_NUM = 12;
+
 const static uint32 DW_VIEW_COL_NAME_LEN = 32;
 
 #define DW_PAGE_TAIL(page) ((dw_page_tail_t*)((char*)(page) + (BLCKSZ - sizeof(dw_page_tail_t))))
@@ -114,6 +122,14 @@ typedef struct st_dw_view_col {
     dw_view_get_data_func get_data;
 } dw_view_col_t;
 
+typedef Datum (*dw_file_view_get_data_func)(int file_id);
+
+typedef struct st_dw_file_view_col {
+    char name[DW_VIEW_COL_NAME_LEN];
+    Oid data_type;
+    dw_file_view_get_data_func get_data;
+} dw_file_view_col_t;
+
 typedef struct st_dw_read_asst {
     int fd;
     uint16 file_start;    /* reading start page id in file */
@@ -135,8 +151,14 @@ typedef struct st_dw_stat_info {
     volatile uint64 high_threshold_pages;  /* more than one full batch (409 pages) total */
 } dw_stat_info;
 
+/*
+ * One context for each double write file. Every flusher thread is bound to one file
+ * (see ThrdDwCxt.dw_file_id), so flushers bound to different files never contend on
+ * the same flush lock. The module state (initialized, closed) lives in the first one.
+ */
 typedef struct knl_g_dw_context {
     int fd;
+    int file_id; /* index in g_instance.dw_cxt */
     struct LWLock* flush_lock;
 
     volatile uint16 write_pos; /* the copied pages in buffer, updated when mark page */
@@ -160,5 +182,6 @@ typedef struct knl_g_dw_context {
 } dw_context_t;
 
 extern const dw_view_col_t g_dw_view_col_arr[DW_VIEW_COL_NUM];
+extern const dw_file_view_col_t g_dw_file_view_col_arr[DW_FILE_VIEW_COL_NUM];
 
 #endif /* DOUBLE_WRITE_BASIC_H */
@@ -312,6 +312,12 @@ typedef struct GinOptions {
             ? ((GinOptions *)(relation)->rd_options)->pendingListCleanupSize                           \
             : u_sess->attr.attr_storage.gin_pending_list_limit)
 
+/*
+ * Cleanup of a pending list longer than its cleanup size is left to
+ * autovacuum, until the list grows past this many times that size.
+ */
+#define GIN_PENDING_LIST_BACKPRESSURE_FACTOR 4
+
 /* Macros for buffer lock/unlock operations */
 #define GIN_UNLOCK BUFFER_LOCK_UNLOCK
 #define GIN_SHARE BUFFER_LOCK_SHARE
@@ -599,6 +605,7 @@ extern Datum gininsert(PG_FUNCTION_ARGS);
 extern void ginEntryInsert(GinState *ginstate, OffsetNumber attnum, Datum key, GinNullCategory category,
                            ItemPointerData *items, uint32 nitem, GinStatsData *buildStats);
 extern Datum cginbuild(PG_FUNCTION_ARGS);
+extern void _gin_parallel_build_main(void *seg);
 
 /* ginbtree.c */
 typedef struct GinBtreeStack {
@@ -894,6 +901,7 @@ extern void ginHeapTupleFastInsert(GinState *ginstate, GinTupleCollector *collec
 extern void ginHeapTupleFastCollect(GinState *ginstate, GinTupleCollector *collector, OffsetNumber attnum, Datum value,
                                     bool isNull, ItemPointer ht_ctid);
 extern void ginInsertCleanup(GinState *ginstate, bool full_clean, bool fill_fsm, IndexBulkDeleteResult *stats);
+extern void ginAutovacuumInsertCleanup(Oid indexoid);
 
 /* ginpostinglist.c */
 extern GinPostingList *ginCompressPostingList(const ItemPointer ptrs, int nptrs, int maxsize, int *nwritten,
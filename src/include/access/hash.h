@@ -319,11 +319,15 @@ extern bool _hash_step(IndexScanDesc scan, Buffer* bufP, ScanDirection dir);
 
 /* hashsort.c */
 typedef struct HSpool HSpool; /* opaque struct in hashsort.c */
+struct IndexInfo;
 
-extern HSpool* _h_spoolinit(Relation index, uint32 num_buckets, void* meminfo);
+extern HSpool* _h_spoolinit(Relation heap, Relation index, uint32 num_buckets, IndexInfo* indexInfo);
 extern void _h_spooldestroy(HSpool* hspool);
 extern void _h_spool(HSpool* hspool, ItemPointer self, Datum* values, const bool* isnull);
+extern bool _h_spool_is_parallel(const HSpool* hspool);
+extern double _h_parallel_heapscan(HSpool* hspool, double* indtuples, bool* brokenhotchain);
 extern void _h_indexbuild(HSpool* hspool);
+extern void _h_parallel_build_main(void* seg);
 
 /* hashutil.c */
 extern bool _hash_checkqual(IndexScanDesc scan, IndexTuple itup);
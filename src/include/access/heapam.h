@@ -190,6 +190,8 @@ extern XLogRecPtr log_logical_newcu(
 extern XLogRecPtr log_newpage_buffer(Buffer buffer, bool page_std);
 /* in heap/pruneheap.c */
 extern void heap_page_prune_opt(Relation relation, Buffer buffer);
+extern void heap_page_note_hot_chain(Relation relation, Buffer buffer);
+extern void heap_page_prune_requested(Oid relid, BlockNumber blkno);
 extern int heap_page_prune(Relation relation, Buffer buffer, TransactionId OldestXmin, bool report_stats,
     TransactionId* latestRemovedXid, bool repairFragmentation);
 extern void heap_page_prune_execute(Page page, OffsetNumber* redirected, int nredirected, OffsetNumber* nowdead,
@@ -123,6 +123,15 @@ typedef struct BTMetaPageData {
                       MAXALIGN(sizeof(BTPageOpaqueData))) /                                          \
                   3)
 
+/*
+ * MaxTIDsPerBTreePage is an upper bound on the number of heap TIDs that may
+ * be stored on a btree leaf page.  Posting list tuples (see below) let a
+ * leaf page reference more heap tuples than MaxIndexTuplesPerPage, so scans
+ * size their per-page arrays with this instead.
+ */
+#define MaxTIDsPerBTreePage \
+    (int)((BLCKSZ - SizeOfPageHeaderData - sizeof(BTPageOpaqueData)) / sizeof(ItemPointerData))
+
 /*
  * The leaf-page fillfactor defaults to 90% but is user-adjustable.
  * For pages above the leaf level, we use a fixed 70% fillfactor.
@@ -206,6 +215,7 @@ typedef struct BTMetaPageData {
 #define XLOG_BTREE_REUSE_PAGE                   \
     0xD0 /* old page is about to be reused from \
           * FSM */
+#define XLOG_BTREE_DEDUP 0xE0 /* merge equal leaf tuples into posting lists */
 
 /*
  * All that we need to regenerate the meta-data page
@@ -320,6 +330,11 @@ typedef struct xl_btree_reuse_page {
  *
  * Note that the *last* WAL record in any vacuum of an index is allowed to
  * have a zero length array of offsets. Earlier records must have at least one.
+ *
+ * When VACUUM removes only some of the heap TIDs of posting list tuples, the
+ * main data is followed by xl_btree_vacuum_posting, and the block data holds
+ * the deleted offsets followed by one xl_btree_update entry per updated
+ * posting list tuple.  Records without updates keep the old layout.
  */
 typedef struct xl_btree_vacuum {
     BlockNumber lastBlockVacuumed;
@@ -329,6 +344,47 @@ typedef struct xl_btree_vacuum {
 
 #define SizeOfBtreeVacuum (offsetof(xl_btree_vacuum, lastBlockVacuumed) + sizeof(BlockNumber))
 
+typedef struct xl_btree_vacuum_posting {
+    uint16 ndeleted; /* number of deleted offsets in the block data */
+    uint16 nupdated; /* number of xl_btree_update entries after them */
+} xl_btree_vacuum_posting;
+
+#define SizeOfBtreeVacuumPosting (offsetof(xl_btree_vacuum_posting, nupdated) + sizeof(uint16))
+
+/*
+ * Removal of some heap TIDs from one posting list tuple: the positions of the
+ * removed TIDs within the posting list follow.
+ */
+typedef struct xl_btree_update {
+    OffsetNumber offnum;
+    uint16 ndeletedtids;
+
+    /* POSTING LIST POSITIONS FOLLOW */
+} xl_btree_update;
+
+#define SizeOfBtreeUpdate (offsetof(xl_btree_update, ndeletedtids) + sizeof(uint16))
+
+/*
+ * Deduplication of a leaf page.  Each interval is a run of nitems
+ * consecutive items starting at baseoff that was merged into one posting
+ * list tuple, replacing the item at baseoff.  Replay rebuilds the page from
+ * the intervals, so the resulting tuples are not logged.
+ *
+ * Backup Blk 0: leaf page (data contains the intervals)
+ */
+typedef struct xl_btree_dedup {
+    uint16 nintervals;
+
+    /* DEDUPLICATION INTERVALS FOLLOW */
+} xl_btree_dedup;
+
+#define SizeOfBtreeDedup (offsetof(xl_btree_dedup, nintervals) + sizeof(uint16))
+
+typedef struct BTDedupInterval {
+    OffsetNumber baseoff;
+    uint16 nitems;
+} BTDedupInterval;
+
 /*
  * This is what we need to know about deletion of a btree page.  The target
  * identifies the tuple removed from the parent page (note that we remove
@@ -390,19 +446,27 @@ typedef struct xl_btree_newroot {
  * bit is set (we never assume that pivot tuples must explicitly store the
  * number of attributes, and currently do not bother storing the number of
  * attributes unless indnkeyatts actually differs from indnatts).
- * INDEX_ALT_TID_MASK is only used for pivot tuples at present, though it's
- * possible that it will be used within non-pivot tuples in the future.  Do
- * not assume that a tuple with INDEX_ALT_TID_MASK set must be a pivot
- * tuple.
+ * INDEX_ALT_TID_MASK is also used by posting list tuples, which are
+ * non-pivot tuples, so do not assume that a tuple with INDEX_ALT_TID_MASK
+ * set must be a pivot tuple.
  *
  * The 12 least significant offset bits are used to represent the number of
  * attributes in INDEX_ALT_TID_MASK tuples, leaving 4 bits that are reserved
  * for future use (BT_RESERVED_OFFSET_MASK bits). BT_N_KEYS_OFFSET_MASK should
  * be large enough to store any number <= INDEX_MAX_KEYS.
+ *
+ * A posting list tuple is a leaf tuple that stands for several leaf tuples
+ * with equal keys.  It sets BT_IS_POSTING in the offset field, whose low 12
+ * bits then hold the number of heap TIDs instead of the number of attributes,
+ * and the block number field holds the offset of the sorted heap TID array
+ * that follows the key attributes.  Posting list tuples always carry every
+ * index attribute.  Only indexes built or inserted into while deduplication
+ * was enabled contain them, see _bt_dedup_enabled().
  */
 #define INDEX_ALT_TID_MASK INDEX_AM_RESERVED_BIT
 #define BT_RESERVED_OFFSET_MASK 0xF000
 #define BT_N_KEYS_OFFSET_MASK 0x0FFF
+#define BT_IS_POSTING 0x1000
 
 /* Get/set downlink block number */
 #define BTreeInnerTupleGetDownLink(itup) ItemPointerGetBlockNumberNoCheck(&((itup)->t_tid))
@@ -426,7 +490,7 @@ typedef struct xl_btree_newroot {
  * removed when BT_RESERVED_OFFSET_MASK bits will be used.
  */
 #define BTreeTupleGetNAtts(itup, rel)                                                                           \
-    ((itup)->t_info & INDEX_ALT_TID_MASK                                                                        \
+    (((itup)->t_info & INDEX_ALT_TID_MASK) && !BTreeTupleIsPosting(itup)                                        \
             ? (AssertMacro((ItemPointerGetOffsetNumberNoCheck(&(itup)->t_tid) & BT_RESERVED_OFFSET_MASK) == 0), \
                   ItemPointerGetOffsetNumberNoCheck(&(itup)->t_tid) & BT_N_KEYS_OFFSET_MASK)                    \
             : IndexRelationGetNumberOfAttributes(rel))
@@ -438,6 +502,22 @@ typedef struct xl_btree_newroot {
         ItemPointerSetOffsetNumber(&(itup)->t_tid, (n) & BT_N_KEYS_OFFSET_MASK);    \
     } while (0)
 
+/* Posting list tuple accessors, see above */
+#define BTreeTupleIsPosting(itup) \
+    (((itup)->t_info & INDEX_ALT_TID_MASK) && (ItemPointerGetOffsetNumberNoCheck(&(itup)->t_tid) & BT_IS_POSTING))
+#define BTreeTupleGetNPosting(itup) \
+    (AssertMacro(BTreeTupleIsPosting(itup)), ItemPointerGetOffsetNumberNoCheck(&(itup)->t_tid) & BT_N_KEYS_OFFSET_MASK)
+#define BTreeTupleGetPostingOffset(itup) ItemPointerGetBlockNumberNoCheck(&(itup)->t_tid)
+#define BTreeTupleGetPosting(itup) ((ItemPointer)((char*)(itup) + BTreeTupleGetPostingOffset(itup)))
+#define BTreeTupleGetPostingN(itup, n) (BTreeTupleGetPosting(itup) + (n))
+#define BTreeTupleSetPosting(itup, nhtids, off)                                            \
+    do {                                                                                   \
+        (itup)->t_info |= INDEX_ALT_TID_MASK;                                              \
+        Assert((nhtids) > 1 && ((nhtids) & BT_RESERVED_OFFSET_MASK) == 0);                 \
+        ItemPointerSetOffsetNumber(&(itup)->t_tid, (uint16)((nhtids) | BT_IS_POSTING));    \
+        ItemPointerSetBlockNumber(&(itup)->t_tid, (off));                                  \
+    } while (0)
+
 /*
  *	Operator strategy numbers for B-tree have been moved to access/skey.h,
  *	because many places need to use them in ScanKeyInit() calls.
@@ -512,7 +592,8 @@ typedef BTStackData* BTStack;
  * If we are doing an index-only scan, we save the entire IndexTuple for each
  * matched item, otherwise only its heap TID and offset.  The IndexTuples go
  * into a separate workspace array; each BTScanPosItem stores its tuple's
- * offset within that array.
+ * offset within that array.  All the heap TIDs of a posting list tuple share
+ * one key-only copy of it there.
  */
 
 typedef struct BTScanPosItem { /* what we remember about each match */
@@ -554,11 +635,25 @@ typedef struct BTScanPosData {
     int lastItem;  /* last valid index in items[] */
     int itemIndex; /* current index in items[] */
 
-    BTScanPosItem items[MaxIndexTuplesPerPage]; /* MUST BE LAST */
+    BTScanPosItem items[MaxTIDsPerBTreePage]; /* MUST BE LAST */
 } BTScanPosData;
 
 typedef BTScanPosData* BTScanPos;
 
+/*
+ * Heap TIDs that VACUUM removes from one posting list tuple.  itup points to
+ * the tuple on the page until _bt_update_posting() replaces it with a palloc'd
+ * tuple holding only the remaining TIDs.
+ */
+typedef struct BTVacuumPostingData {
+    IndexTuple itup;
+    OffsetNumber updatedoffset;
+    uint16 ndeletedtids;
+    uint16 deletetids[FLEXIBLE_ARRAY_MEMBER]; /* positions within the posting list */
+} BTVacuumPostingData;
+
+typedef BTVacuumPostingData* BTVacuumPosting;
+
 #define BTScanPosIsValid(scanpos) BufferIsValid((scanpos).buf)
 
 /* We need one of these for each equality-type SK_SEARCHARRAY scan key */
@@ -708,6 +803,18 @@ extern Datum btmerge(PG_FUNCTION_ARGS);
 extern bool _bt_doinsert(Relation rel, IndexTuple itup, IndexUniqueCheck checkUnique, Relation heapRel);
 extern Buffer _bt_getstackbuf(Relation rel, BTStack stack, int access);
 
+/*
+ * prototypes for functions in nbtdedup.c
+ */
+extern bool _bt_dedup_enabled(Relation rel);
+extern bool _bt_dedup_one_page(Relation rel, Buffer buf, Size newitemsz);
+extern Page _bt_dedup_build_page(Page page, const BTDedupInterval* intervals, int nintervals);
+extern bool _bt_keys_image_equal(IndexTuple itup1, IndexTuple itup2);
+extern IndexTuple _bt_form_posting(IndexTuple base, const ItemPointerData* htids, int nhtids);
+extern IndexTuple _bt_strip_posting(IndexTuple itup);
+extern void _bt_update_posting(BTVacuumPosting vacposting);
+extern int _bt_tid_cmp(const void* a, const void* b);
+
 /*
  * prototypes for functions in nbtpage.c
  */
@@ -721,8 +828,8 @@ extern void _bt_relbuf(Relation rel, Buffer buf);
 extern void _bt_pageinit(Page page, Size size);
 extern bool _bt_page_recyclable(Page page);
 extern void _bt_delitems_delete(Relation rel, Buffer buf, OffsetNumber* itemnos, int nitems, Relation heapRel);
-extern void _bt_delitems_vacuum(
-    Relation rel, Buffer buf, OffsetNumber* itemnos, int nitems, BlockNumber lastBlockVacuumed);
+extern void _bt_delitems_vacuum(Relation rel, Buffer buf, OffsetNumber* itemnos, int nitems,
+    BTVacuumPosting* updatable, int nupdatable, BlockNumber lastBlockVacuumed);
 extern int _bt_pagedel(Relation rel, Buffer buf, BTStack stack);
 extern void _bt_page_localupgrade(Page page);
 /*
@@ -60,6 +60,7 @@ typedef struct RedoWorkerStatsData {
 } RedoWorkerStatsData;
 
 extern const RedoStatsViewObj g_redoViewArr[REDO_VIEW_COL_SIZE];
+extern const RedoStatsViewObj g_redoPrefetchViewArr[REDO_PREFETCH_VIEW_COL_SIZE];
 
 extern void redo_fill_redo_event();
 extern void redo_refresh_stats(uint64 speed);
@@ -30,6 +30,7 @@
 const static uint32 REDO_WORKER_INFO_BUFFER_SIZE = 64 * (1 + MAX_RECOVERY_THREAD_NUM);
 const static uint32 VIEW_NAME_SIZE = 32;
 const static uint32 REDO_VIEW_COL_SIZE = 23;
+const static uint32 REDO_PREFETCH_VIEW_COL_SIZE = 7;
 
 typedef struct RedoWaitInfo {
     int64 total_duration;
@@ -254,6 +254,7 @@ extern bytea* attribute_reloptions(Datum reloptions, bool validate);
 extern bytea* tablespace_reloptions(Datum reloptions, bool validate);
 extern bytea* tsearch_config_reloptions(Datum tsoptions, bool validate, Oid prsoid, bool missing_ok);
 extern void heaprel_set_compressing_modes(Relation rel, int16* modes);
+extern int16 heaprel_make_compressing_modes(int8 compression, int8 compresslevel);
 extern int8 heaprel_get_compresslevel_from_modes(int16 modes);
 extern int8 heaprel_get_compression_from_modes(int16 modes);
 
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * tidstore.h
+ *        compact set of heap TIDs, filled in block order
+ *
+ *
+ * IDENTIFICATION
+ *        src/include/access/tidstore.h
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+
+#ifndef TIDSTORE_H
+#define TIDSTORE_H
+
+#include "storage/itemptr.h"
+#include "storage/off.h"
+
+typedef struct TidStore TidStore;
+typedef struct TidStoreIter TidStoreIter;
+
+/* one block returned by TidStoreIterateNext() */
+typedef struct TidStoreIterResult {
+    BlockNumber blkno;
+    int num_offsets;
+    OffsetNumber offsets[MaxOffsetNumber];
+} TidStoreIterResult;
+
+extern TidStore* TidStoreCreate(Size maxBytes);
+extern void TidStoreDestroy(TidStore* ts);
+extern void TidStoreReset(TidStore* ts);
+extern void TidStoreSetBlockOffsets(TidStore* ts, BlockNumber blkno, const OffsetNumber* offsets, int numOffsets);
+extern bool TidStoreIsMember(const TidStore* ts, ItemPointer tid);
+extern bool TidStoreIsFull(const TidStore* ts);
+extern int64 TidStoreNumTids(const TidStore* ts);
+extern Size TidStoreMemoryUsage(const TidStore* ts);
+
+extern TidStoreIter* TidStoreBeginIterate(const TidStore* ts);
+extern TidStoreIterResult* TidStoreIterateNext(TidStoreIter* iter);
+extern void TidStoreEndIterate(TidStoreIter* iter);
+
+#endif /* TIDSTORE_H */
@@ -22,6 +22,17 @@
  */
 #define TOAST_INDEX_HACK
 
+/*
+ * Compression methods for TOASTed values.  The id is stored in two bits of
+ * the compressed datum header, so there can be at most four of them, and
+ * pglz must stay zero for on-disk compatibility.
+ */
+typedef enum ToastCompressionId {
+    TOAST_PGLZ_COMPRESSION_ID = 0,
+    TOAST_LZ4_COMPRESSION_ID = 1,
+    TOAST_INVALID_COMPRESSION_ID = 2
+} ToastCompressionId;
+
 /*
  * Find the maximum size of a tuple if there are to be N tuples per page.
  */
@@ -100,7 +111,17 @@
  * saves space, so we expect either equality or less-than.
  */
 #define VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer) \
-    ((toast_pointer).va_extsize < (toast_pointer).va_rawsize - VARHDRSZ)
+    ((int32)VARATT_EXTERNAL_GET_EXTSIZE(toast_pointer) < (toast_pointer).va_rawsize - VARHDRSZ)
+
+/*
+ * va_extsize shares its top two bits with the compression method of the
+ * stored data, the same way va_rawsize does for in-line compressed datums.
+ */
+#define VARATT_EXTERNAL_GET_EXTSIZE(toast_pointer) ((uint32)(toast_pointer).va_extsize & VARLENA_RAWSIZE_MASK)
+#define VARATT_EXTERNAL_GET_COMPRESS_METHOD(toast_pointer) \
+    ((uint32)(toast_pointer).va_extsize >> VARLENA_RAWSIZE_BITS)
+#define VARATT_EXTERNAL_SET_SIZE_AND_COMPRESS_METHOD(toast_pointer, len, cm) \
+    ((toast_pointer).va_extsize = (int32)((uint32)(len) | ((uint32)(cm) << VARLENA_RAWSIZE_BITS)))
 
 /*
  * Macro to fetch the possibly-unaligned contents of an EXTERNAL datum
@@ -221,7 +242,19 @@ extern Datum toast_flatten_tuple_attribute(Datum value, Oid typeId, int32 typeMo
  *	Create a compressed version of a varlena datum, if possible
  * ----------
  */
-extern Datum toast_compress_datum(Datum value);
+extern Datum toast_compress_datum(Datum value, ToastCompressionId cmid = TOAST_PGLZ_COMPRESSION_ID);
+
+/* ----------
+ * toast_get_compression_id -
+ *
+ *	Return the compression method of a varlena datum, or
+ *	TOAST_INVALID_COMPRESSION_ID if it is not compressed
+ * ----------
+ */
+extern ToastCompressionId toast_get_compression_id(struct varlena* attr);
+
+extern ToastCompressionId CompressionNameToId(const char* name);
+extern const char* GetCompressionMethodName(ToastCompressionId cmid);
 
 /* ----------
  * toast_raw_datum_size -
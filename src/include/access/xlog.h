@@ -251,6 +251,11 @@ typedef struct XLogwrtResult {
 
 extern XLogRecPtr XLogInsertRecord(struct XLogRecData* rdata, XLogRecPtr fpw_lsn, bool isupgrade = false);
 extern void XLogFlush(XLogRecPtr record, bool LogicalPage = false);
+extern void XLogWaitFlush(XLogRecPtr record);
+extern bool XLogFlushWaitPending(void);
+extern uint64 XLogFlushWaitArrivals(void);
+extern int XLogReleaseFlushWaiters(void);
+extern void XLogRegisterBuffersForIO(void);
 extern void UpdateMinRecoveryPoint(XLogRecPtr lsn, bool force);
 extern bool XLogBackgroundFlush(void);
 extern bool XLogNeedsFlush(XLogRecPtr RecPtr);
@@ -286,6 +291,7 @@ extern XLogRecPtr GetStandbyFlushRecPtr(TimeLineID* targetTLI);
 extern XLogRecPtr GetXLogInsertRecPtr(void);
 extern XLogRecPtr GetXLogInsertEndRecPtr(void);
 extern XLogRecPtr GetXLogWriteRecPtr(void);
+extern Size XLogReadFromBuffers(char* buf, XLogRecPtr startptr, Size count);
 extern bool RecoveryIsPaused(void);
 extern void SetRecoveryPause(bool recoveryPause);
 extern TimestampTz GetLatestXTime(void);
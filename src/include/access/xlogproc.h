@@ -726,7 +726,9 @@ void btree_xlog_split_operator_nextpage(RedoBufferInfo* buffer, BlockNumber righ
 void btree_xlog_split_operator_leftpage(
     RedoBufferInfo* lbuf, void* recorddata, BlockNumber rightsib, bool onleft, void* blkdata, Size datalen, Item left_hikey,
     Size left_hikeysz);
-void btree_xlog_vacuum_operator_page(RedoBufferInfo* redobuffer, void* recorddata, void* blkdata, Size len);
+void btree_xlog_vacuum_operator_page(
+    RedoBufferInfo* redobuffer, void* recorddata, Size recorddatalen, void* blkdata, Size len);
+void btree_xlog_dedup_operator_page(RedoBufferInfo* buffer, void* recorddata, void* blkdata, Size len);
 void btree_xlog_delete_operator_page(RedoBufferInfo* buffer, void* recorddata, Size recorddatalen);
 
 void btree_xlog_delete_page_operator_parentpage(RedoBufferInfo* buffer, void* recorddata, uint8 info);
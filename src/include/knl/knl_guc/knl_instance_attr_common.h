@@ -50,6 +50,7 @@ typedef struct knl_instance_attr_common {
     bool allowSystemTableMods;
     bool enable_thread_pool;
 	bool enable_global_plancache;
+    bool enable_global_catcache;
     int max_files_per_process;
     int pgstat_track_activity_query_size;
     int GtmHostPortArray[MAX_GTM_HOST_NUM];
@@ -58,9 +58,11 @@ typedef struct knl_instance_attr_storage {
     int DataQueueBufSize;
     int NBuffers;
     int cstore_buffers;
+    int cstore_compressed_cache_ratio;
     int MaxSendSize;
     int max_prepared_xacts;
     int max_locks_per_xact;
+    int fast_path_lock_groups;
     int max_predicate_locks_per_xact;
     int num_xloginsert_locks;
     int XLOGbuffers;
@@ -77,6 +79,7 @@ typedef struct knl_instance_attr_storage {
     int recovery_redo_workers_per_paser_worker;
     int pagewriter_thread_num;
     int bgwriter_thread_num;
+    int dw_file_num;
     int real_recovery_parallelism;
     int batch_redo_num;
     int remote_read_mode;
@@ -90,6 +93,7 @@ typedef struct knl_instance_attr_storage {
     int extreme_rto_ab_count;
 #endif
     char* available_zone;
+    char* lwlock_queue_tranches;
 } knl_instance_attr_storage;
 
 #endif /* SRC_INCLUDE_KNL_KNL_INSTANCE_ATTR_STORAGE_H_ */
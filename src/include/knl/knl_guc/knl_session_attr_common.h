@@ -56,6 +56,7 @@ typedef struct knl_session_attr_common {
     bool pgstat_track_counts;
     bool pgstat_track_sql_count;
     bool track_io_timing;
+    bool track_lwlock_timing;
     bool update_process_title;
     bool pooler_cache_connection;
     bool Trace_notify;
@@ -54,6 +54,7 @@ typedef struct knl_session_attr_storage {
     /* belong to #ifdef LOCK_DEBUG, but if #ifdef, compile error */
     bool Debug_deadlocks;
     bool log_lock_waits;
+    bool log_cstore_load_timing;
     bool phony_autocommit;
     bool DefaultXactReadOnly;
     bool DefaultXactDeferrable;
@@ -73,6 +74,7 @@ typedef struct knl_session_attr_storage {
     bool gds_debug_mod;
     bool log_pagewriter;
     bool enable_incremental_catchup;
+    bool enable_cu_cache_admission;
     int wait_dummy_time;
     int DeadlockTimeout;
     int LockWaitTimeout;
@@ -112,6 +114,7 @@ typedef struct knl_session_attr_storage {
     int incrCheckPointTimeout;
     int CheckPointWarning;
     int checkpoint_flush_after;
+    int pagewriter_flush_after;
     int CheckPointWaitTimeOut;
     int WalWriterDelay;
     int wal_sender_timeout;
@@ -133,13 +136,18 @@ typedef struct knl_session_attr_storage {
     int autoanalyze_timeout;
     int autovacuum_vac_thresh;
     int autovacuum_anl_thresh;
+    int autovacuum_deltamerge_thresh;
+    int autovacuum_deltamerge_max_lag;
     int prefetch_quantity;
     int backwrite_quantity;
     int cstore_prefetch_quantity;
     int cstore_backwrite_max_threshold;
     int cstore_backwrite_quantity;
+    int cstore_compress_workers;
     int fast_extend_file_size;
     int gin_pending_list_limit;
+    int hot_chain_prune_threshold;
+    int lwlock_spin_limit;
     int gtm_connect_retries;
     int gtm_conn_check_interval;
     int dfs_max_parsig_length;
@@ -175,6 +183,11 @@ typedef struct knl_session_attr_storage {
     bool enable_cbm_tracking;
     bool enable_copy_server_files;
     int target_rto;
+    int recovery_prefetch_distance;
+    int wal_stream_compression;
+    bool wal_flush_wait_queue;
+    int wal_flush_group_delay;
+    bool enable_io_uring;
     bool enable_twophase_commit;
     /*
      * xlog keep for all standbys even through they are not connect and donnot created replslot.
@@ -92,6 +92,8 @@ typedef struct knl_instance_attr {
 
 typedef struct knl_g_cache_context{
     MemoryContext global_cache_mem;
+    /* catalog tuples shared by the session catcaches, NULL unless enable_global_catcache */
+    struct GlobalCatCache* global_catcache;
 } knl_g_cache_context;
 
 typedef struct knl_g_cost_context {
@@ -396,6 +398,12 @@ typedef struct {
     RedoWaitInfo wait_info[WAIT_REDO_NUM];
     uint32 speed_according_seg;
     XLogRecPtr local_max_lsn;
+    /* block prefetch done by the redo dispatcher, see redo_prefetch.cpp */
+    uint64 prefetch_issued;       /* prefetch requests sent to the kernel */
+    uint64 prefetch_buffer_hits;  /* blocks found in shared buffers, no prefetch needed */
+    uint64 prefetch_recent_hits;  /* blocks prefetched a short while ago */
+    uint64 prefetch_skip_init;    /* full page image or page re-init, no read needed */
+    uint64 prefetch_throttled;    /* skipped since prefetch distance was used up */
 } RedoPerf;
 
 
@@ -606,7 +614,7 @@ typedef struct knl_instance_context {
     knl_g_ckpt_context ckpt_cxt;
     knl_g_ckpt_context* ckpt_cxt_ctl;
     knl_g_bgwriter_context bgwriter_cxt;
-    struct knl_g_dw_context dw_cxt;
+    struct knl_g_dw_context dw_cxt[DW_MAX_FILE_NUM];
     knl_g_shmem_context shmem_cxt;
     knl_g_executor_context exec_cxt;
     knl_g_heartbeat_context heartbeat_cxt;
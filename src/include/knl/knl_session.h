@@ -196,9 +196,22 @@ typedef struct knl_u_SPI_context {
     int portal_stp_exception_counter;
 } knl_u_SPI_context;
 
+#define GIN_CLEANUP_REQUEST_MEMO_SIZE 8
+
+/* a GIN pending list cleanup this session handed to autovacuum */
+typedef struct GinCleanupRequest {
+    Oid indexOid;
+    uint32 head; /* head page of the pending list when it was asked for */
+} GinCleanupRequest;
+
 typedef struct knl_u_index_context {
     typedef uint64 XLogRecPtr;
     XLogRecPtr counter;
+
+    /* see ginRequestPendingListCleanup; replaced in turn when full */
+    GinCleanupRequest gin_cleanup_requests[GIN_CLEANUP_REQUEST_MEMO_SIZE];
+    int gin_cleanup_nrequests;
+    int gin_cleanup_next;
 } knl_u_index_context;
 
 typedef struct knl_u_instrument_context {
@@ -2094,6 +2107,32 @@ typedef struct ParallelBtreeInfo {
     void *meminfo;
 } ParallelBtreeInfo;
 
+struct HashShared;
+typedef struct ParallelHashInfo {
+    char *queryText;
+    HashShared *hashShared;
+    SharedSort *sharedSort;
+    void *meminfo;
+} ParallelHashInfo;
+
+struct GinShared;
+typedef struct ParallelGinInfo {
+    char *queryText;
+    GinShared *ginShared;
+    SharedSort *sharedSort;
+    void *meminfo;
+} ParallelGinInfo;
+
+struct CUCompressShared;
+typedef struct ParallelCUCompressInfo {
+    CUCompressShared *shared;
+} ParallelCUCompressInfo;
+
+struct LVParallelShared;
+typedef struct ParallelVacuumInfo {
+    LVParallelShared *shared;
+} ParallelVacuumInfo;
+
 typedef struct ParallelInfoContext {
     Oid database_id;
     Oid authenticated_user_id;
@@ -2147,6 +2186,10 @@ typedef struct ParallelInfoContext {
     union {
         ParallelQueryInfo queryInfo; /* parameters for parallel query only */
         ParallelBtreeInfo btreeInfo; /* parameters for parallel create index(btree) only */
+        ParallelHashInfo hashInfo; /* parameters for parallel create index(hash) only */
+        ParallelGinInfo ginInfo; /* parameters for parallel create index(gin) only */
+        ParallelCUCompressInfo cuCompressInfo; /* parameters for parallel CU compression of cstore load only */
+        ParallelVacuumInfo vacuumInfo; /* parameters for parallel index vacuum only */
     };
 
     /* Mutex protects remaining fields. */
@@ -1413,7 +1413,6 @@ typedef struct knl_t_bgwriter_context {
 typedef struct knl_t_pagewriter_context {
     volatile sig_atomic_t got_SIGHUP;
     volatile sig_atomic_t shutdown_requested;
-    int page_writer_after;
     int pagewriter_id;
 } knl_t_pagewriter_context;
 
@@ -1782,6 +1781,11 @@ typedef struct knl_t_remoteservice_context {
 typedef struct knl_t_walwriter_context {
     volatile sig_atomic_t got_SIGHUP;
     volatile sig_atomic_t shutdown_requested;
+
+    /* commit rate seen through the flush wait queue, see WalWriterGroupDelay */
+    uint64 flush_wait_arrivals;     /* XLogFlushWaitArrivals() at the last arrival seen */
+    TimestampTz flush_wait_time;    /* when that arrival was seen */
+    double flush_wait_interval;     /* average usecs between two arrivals, 0 if unknown */
 } knl_t_walwriter_context;
 
 typedef struct knl_t_poolcleaner_context {
@@ -1925,6 +1929,13 @@ typedef struct knl_t_basebackup_context {
     char g_xlog_location[MAXPGPATH];
 
     char* buf_block;
+
+    /* state of the options of the running BASE_BACKUP */
+    int compression;                        /* BaseBackupCompression of the tar streams */
+    char* compress_buf;                     /* framed data sent by BaseBackupPutData */
+    struct BackupReaderPool* reader_pool;   /* threads reading the data files */
+    HTAB* changed_blocks;                   /* CBM changed blocks of INCREMENTAL, by relation */
+    Oid tablespace_oid;                     /* tablespace of the tar stream, InvalidOid for the base one */
 } knl_t_basebackup_context;
 
 typedef struct knl_t_datarcvwriter_context {
@@ -2076,6 +2087,9 @@ typedef struct knl_t_walreceiver_context {
     bool AmWalReceiverForFailover;
     bool AmWalReceiverForStandby;
     int control_file_writed;
+    /* buffer to decompress the WAL of compressed messages into */
+    char* decompress_buf;
+    Size decompress_buf_size;
 } knl_t_walreceiver_context;
 
 typedef struct knl_t_walsender_context {
@@ -2129,6 +2143,12 @@ typedef struct knl_t_walsender_context {
      */
     char* output_xlog_message;
     Size output_xlog_msg_prefix_len;
+    /*
+     * WAL stream compression asked by walreceiver, and the buffer for the
+     * compressed messages (message type 'z'), see XLogSendPhysical.
+     */
+    int wal_stream_compression;
+    char* output_compressed_message;
     /*
      * Buffer for constructing outgoing messages
      * (sizeof(DataElementHeaderData) + MAX_SEND_SIZE bytes)
@@ -2378,12 +2398,14 @@ typedef struct knl_t_storage_context {
     ThreadId conflicting_lock_thread_id;
     bool conflicting_lock_by_holdlock;
     /*
-     * Count of the number of fast path lock slots we believe to be used.  This
-     * might be higher than the real number if another backend has transferred
-     * our locks to the primary lock table, but it can never be lower than the
-     * real value, since only we can acquire locks on our own behalf.
+     * Count of the number of fast path lock slots we believe to be used in
+     * each group.  This might be higher than the real number if another
+     * backend has transferred our locks to the primary lock table, but it can
+     * never be lower than the real value, since only we can acquire locks on
+     * our own behalf.
      */
-    int FastPathLocalUseCount;
+#define FP_LOCK_GROUPS_MAX 256
+    int FastPathLocalUseCounts[FP_LOCK_GROUPS_MAX];
     volatile struct FastPathStrongRelationLockData* FastPathStrongRelationLocks;
     /*
      * Pointers to hash tables containing lock state
@@ -1785,6 +1785,8 @@ typedef struct BitmapHeapScanState {
     TBMIterator* prefetch_iterator;
     int prefetch_pages;
     int prefetch_target;
+    long exact_pages;      /* pages fetched with exact TIDs, for EXPLAIN ANALYZE */
+    long lossy_pages;      /* pages fetched from lossy bitmap entries */
     GPIScanDesc gpi_scan;  /* global partition index scan use information */
     Size pscan_len;
     bool initialized;
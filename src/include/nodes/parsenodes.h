@@ -2972,6 +2972,7 @@ typedef enum VacuumOption {
     VACOPT_FAST = 1 << 9,          /* verify fast option */
     VACOPT_COMPLETE = 1 << 10,     /* verify complete option */
     VACOPT_AUTOVAC = 1 << 11,      /* mark automatic vacuum initiation */
+    VACOPT_DELTA_FULLCU = 1 << 12, /* delta merge only moves the rows filling whole CUs */
     VACOPT_COMPACT = 1 << 30,      /* compact hdfs file with invalid data just for DFS table */
     VACOPT_HDFSDIRECTORY = 1 << 31 /* just clean empty hdfs directory */
 } VacuumOption;
@@ -94,6 +94,7 @@ extern Node* estimate_expression_value(PlannerInfo* root, Node* node);
 extern Query* inline_set_returning_function(PlannerInfo* root, RangeTblEntry* rte);
 extern Query* search_cte_by_parse_tree(Query* parse, RangeTblEntry* rte, bool under_recursive_tree);
 extern bool filter_cstore_clause(PlannerInfo* root, Expr* clause);
+extern bool filter_cstore_inlist_clause(Expr* clause);
 /* evaluate_expr used to be a  static function */
 extern Expr* evaluate_expr(Expr* expr, Oid result_type, int32 result_typmod, Oid result_collation);
 extern bool contain_var_unsubstitutable_functions(Node* clause);
@@ -108,6 +108,7 @@ PG_KEYWORD("compact", COMPACT, TYPE_FUNC_NAME_KEYWORD)
 PG_KEYWORD("compatible_illegal_chars", COMPATIBLE_ILLEGAL_CHARS, UNRESERVED_KEYWORD)
 PG_KEYWORD("complete", COMPLETE, UNRESERVED_KEYWORD)
 PG_KEYWORD("compress", COMPRESS, UNRESERVED_KEYWORD)
+PG_KEYWORD("compression", COMPRESSION, UNRESERVED_KEYWORD)
 PG_KEYWORD("concurrently", CONCURRENTLY, TYPE_FUNC_NAME_KEYWORD)
 PG_KEYWORD("configuration", CONFIGURATION, UNRESERVED_KEYWORD)
 PG_KEYWORD("connection", CONNECTION, UNRESERVED_KEYWORD)
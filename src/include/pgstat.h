@@ -93,8 +93,14 @@ typedef int64 PgStat_Counter;
  * regardless of whether the transaction committed.  delta_live_tuples,
  * delta_dead_tuples, and changed_tuples are set depending on commit or abort.
  * Note that delta_live_tuples and delta_dead_tuples can be negative!
+ *
+ * hot_chain_len counts the HOT chains walked by index and bitmap heap
+ * fetches, by the number of chain members examined: bucket i counts the
+ * chains of 2^i up to 2^(i+1)-1 members, and the last bucket all longer ones.
  * ----------
  */
+#define PGSTAT_HOT_CHAIN_BUCKETS 8
+
 typedef struct PgStat_TableCounts {
     PgStat_Counter t_numscans;
 
@@ -116,6 +122,8 @@ typedef struct PgStat_TableCounts {
     PgStat_Counter t_cu_mem_hit;
     PgStat_Counter t_cu_hdd_sync;
     PgStat_Counter t_cu_hdd_asyn;
+
+    PgStat_Counter t_hot_chain_len[PGSTAT_HOT_CHAIN_BUCKETS];
 } PgStat_TableCounts;
 
 /* Possible targets for resetting cluster-wide shared values */
@@ -613,7 +621,7 @@ typedef union PgStat_Msg {
  * data structures change.
  * ------------------------------------------------------------
  */
-#define PGSTAT_FILE_FORMAT_ID 0x01A5BC9B
+#define PGSTAT_FILE_FORMAT_ID 0x01A5BC9C
 
 /* ----------
  * PgStat_StatDBEntry			The collector's data per database
@@ -725,6 +733,8 @@ typedef struct PgStat_StatTabEntry {
     PgStat_Counter cu_hdd_sync;
     PgStat_Counter cu_hdd_asyn;
 
+    PgStat_Counter hot_chain_len[PGSTAT_HOT_CHAIN_BUCKETS];
+
     TimestampTz vacuum_timestamp; /* user initiated vacuum */
     PgStat_Counter vacuum_count;
     TimestampTz autovac_vacuum_timestamp; /* autovacuum initiated */
@@ -1732,6 +1742,23 @@ static inline void pgstat_reset_waitStatePhase(WaitState waitstatus, WaitStatePh
             (rel)->pgstat_info->t_counts.t_cu_hdd_asyn += (n); \
     } while (0)
 
+static inline int pgstat_hot_chain_bucket(int len)
+{
+    int bucket = 0;
+
+    while (len > 1 && bucket < PGSTAT_HOT_CHAIN_BUCKETS - 1) {
+        len >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+#define pgstat_count_hot_chain(rel, len)                                                   \
+    do {                                                                                   \
+        if ((rel)->pgstat_info != NULL)                                                    \
+            (rel)->pgstat_info->t_counts.t_hot_chain_len[pgstat_hot_chain_bucket(len)]++; \
+    } while (0)
+
 extern void pgstat_count_heap_insert(Relation rel, PgStat_Counter n);
 extern void pgstat_count_heap_update(Relation rel, bool hot);
 extern void pgstat_count_heap_delete(Relation rel);
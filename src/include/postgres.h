@@ -147,8 +147,10 @@ extern bool CheckCompArgs(const char *cmptFmt);
 /*
  * struct varatt_external is a "TOAST pointer", that is, the information
  * needed to fetch a stored-out-of-line Datum.	The data is compressed
- * if and only if va_extsize < va_rawsize - VARHDRSZ.  This struct must not
- * contain any padding, because we sometimes compare pointers using memcmp.
+ * if and only if va_extsize < va_rawsize - VARHDRSZ.  The top two bits of
+ * va_extsize carry the compression method of compressed data, so read it
+ * with VARATT_EXTERNAL_GET_EXTSIZE().  This struct must not contain any
+ * padding, because we sometimes compare pointers using memcmp.
  *
  * Note that this information is stored unaligned within actual tuples, so
  * you need to memcpy from the tuple into a local struct variable before
@@ -157,7 +159,7 @@ extern bool CheckCompArgs(const char *cmptFmt);
  */
 typedef struct varatt_external {
     int32 va_rawsize;  /* Original data size (includes header) */
-    int32 va_extsize;  /* External saved size (doesn't) */
+    int32 va_extsize;  /* External saved size (doesn't) and method */
     Oid va_valueid;    /* Unique ID of value within TOAST table */
     Oid va_toastrelid; /* RelID of TOAST table containing it */
 } varatt_external;
@@ -202,7 +204,7 @@ typedef union {
     } va_4byte;
     struct { /* Compressed-in-line format */
         uint32 va_header;
-        uint32 va_rawsize;                   /* Original data size (excludes header) */
+        uint32 va_rawsize;                   /* Original data size (excludes header) and method */
         char va_data[FLEXIBLE_ARRAY_MEMBER]; /* Compressed data */
     } va_compressed;
 } varattrib_4b;
@@ -340,7 +342,16 @@ typedef enum {
 #define VARDATA_1B(PTR) (((varattrib_1b*)(PTR))->va_data)
 #define VARDATA_1B_E(PTR) (((varattrib_1b_e*)(PTR))->va_data)
 
-#define VARRAWSIZE_4B_C(PTR) (((varattrib_4b*)(PTR))->va_compressed.va_rawsize)
+/*
+ * The top two bits of va_rawsize hold the compression method of an in-line
+ * compressed datum (see ToastCompressionId).  Raw sizes stay below 1GB, so
+ * those bits are zero in every value compressed with pglz.
+ */
+#define VARLENA_RAWSIZE_BITS 30
+#define VARLENA_RAWSIZE_MASK ((1U << VARLENA_RAWSIZE_BITS) - 1)
+
+#define VARRAWSIZE_4B_C(PTR) (((varattrib_4b*)(PTR))->va_compressed.va_rawsize & VARLENA_RAWSIZE_MASK)
+#define VARCOMPRESS_METHOD_4B_C(PTR) (((varattrib_4b*)(PTR))->va_compressed.va_rawsize >> VARLENA_RAWSIZE_BITS)
 
 /* Externally visible macros */
 
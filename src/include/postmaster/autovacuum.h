@@ -17,6 +17,7 @@
 #ifndef AUTOVACUUM_H
 #define AUTOVACUUM_H
 
+#include "storage/block.h"
 #include "utils/guc.h"
 
 #ifdef PGXC /* PGXC_DATANODE */
@@ -41,6 +42,15 @@ typedef enum {
 
 #endif
 
+/*
+ * Other processes can request specific work from autovacuum, identified by
+ * AutoVacuumWorkItem elements.
+ */
+typedef enum {
+    AVW_GINCleanPendingList, /* move a GIN index's pending list into its main structure */
+    AVW_HeapPruneHotChains   /* prune a heap page on which scans found long HOT chains */
+} AutoVacuumWorkItemType;
+
 /* Status inquiry functions */
 extern bool AutoVacuumingActive(void);
 extern bool IsAutoVacuumLauncherProcess(void);
@@ -58,6 +68,8 @@ extern void AutoVacWorkerFailed(void);
 /* autovacuum cost-delay balancer */
 extern void AutoVacuumUpdateDelay(void);
 
+extern bool AutoVacuumRequestWork(AutoVacuumWorkItemType type, Oid relationId, BlockNumber blkno);
+
 #ifdef EXEC_BACKEND
 extern void AutoVacLauncherMain();
 extern void AutoVacWorkerMain();
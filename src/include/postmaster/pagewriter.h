@@ -34,6 +34,7 @@ typedef struct ThrdDwCxt {
     uint16 write_pos;
     volatile int dw_page_idx;      /* -1 means data files have been flushed. */
     bool contain_hashbucket;
+    int dw_file_id;                /* the double write file this thread writes into */
 } ThrdDwCxt;
 
 typedef struct PageWriterProc {
@@ -46,6 +46,12 @@ typedef struct LogicalDecodingContext {
     OutputPluginCallbacks callbacks;
     OutputPluginOptions options;
 
+    /*
+     * Stream large transactions before they commit? Set if the output plugin
+     * registered the stream callbacks, it may clear it at startup.
+     */
+    bool streaming;
+
     /*
      * User specified options
      */
@@ -102,5 +108,6 @@ extern void LogicalIncreaseXminForSlot(XLogRecPtr lsn, TransactionId xmin);
 extern void LogicalIncreaseRestartDecodingForSlot(XLogRecPtr current_lsn, XLogRecPtr restart_lsn);
 extern void LogicalConfirmReceivedLocation(XLogRecPtr lsn);
 extern bool filter_by_origin_cb_wrapper(LogicalDecodingContext* ctx, RepOriginId origin_id);
+extern void UpdateDecodingStats(LogicalDecodingContext* ctx);
 #endif
 
@@ -73,8 +73,39 @@ typedef void (*LogicalDecodeShutdownCB)(struct LogicalDecodingContext* ctx);
  */
 typedef bool (*LogicalDecodeFilterByOriginCB)(struct LogicalDecodingContext* ctx, RepOriginId origin_id);
 
+/*
+ * Called before and after each block of changes streamed for a transaction
+ * which is still in progress. A transaction can be streamed in any number of
+ * blocks, the changes of each block are passed to the stream change callback.
+ */
+typedef void (*LogicalDecodeStreamStartCB)(struct LogicalDecodingContext* ctx, ReorderBufferTXN* txn);
+typedef void (*LogicalDecodeStreamStopCB)(struct LogicalDecodingContext* ctx, ReorderBufferTXN* txn);
+
+/*
+ * Callback for every individual change of a streamed block.
+ */
+typedef void (*LogicalDecodeStreamChangeCB)(
+    struct LogicalDecodingContext* ctx, ReorderBufferTXN* txn, Relation relation, ReorderBufferChange* change);
+
+/*
+ * Called when a streamed transaction commits, after its last block.
+ */
+typedef void (*LogicalDecodeStreamCommitCB)(
+    struct LogicalDecodingContext* ctx, ReorderBufferTXN* txn, XLogRecPtr commit_lsn);
+
+/*
+ * Called when a streamed transaction aborts, or is not going to be decoded
+ * at its commit. The changes streamed for it have to be discarded.
+ */
+typedef void (*LogicalDecodeStreamAbortCB)(
+    struct LogicalDecodingContext* ctx, ReorderBufferTXN* txn, XLogRecPtr abort_lsn);
+
 /*
  * Output plugin callbacks
+ *
+ * The stream callbacks are optional. Large transactions are streamed only if
+ * all of them are registered, and the startup callback can turn streaming
+ * off by clearing ctx->streaming.
  */
 typedef struct OutputPluginCallbacks {
     LogicalDecodeStartupCB startup_cb;
@@ -83,6 +114,11 @@ typedef struct OutputPluginCallbacks {
     LogicalDecodeCommitCB commit_cb;
     LogicalDecodeShutdownCB shutdown_cb;
     LogicalDecodeFilterByOriginCB filter_by_origin_cb;
+    LogicalDecodeStreamStartCB stream_start_cb;
+    LogicalDecodeStreamStopCB stream_stop_cb;
+    LogicalDecodeStreamChangeCB stream_change_cb;
+    LogicalDecodeStreamCommitCB stream_commit_cb;
+    LogicalDecodeStreamAbortCB stream_abort_cb;
 } OutputPluginCallbacks;
 
 extern void OutputPluginPrepareWrite(struct LogicalDecodingContext* ctx, bool last_write);
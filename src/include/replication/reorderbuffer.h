@@ -15,6 +15,7 @@
 
 #include "lib/ilist.h"
 
+#include "replication/slot.h"
 #include "storage/sinval.h"
 
 #include "utils/hsearch.h"
@@ -205,6 +206,16 @@ typedef struct ReorderBufferTXN {
      */
     bool serialized;
 
+    /*
+     * Have changes of this transaction been streamed to the output plugin
+     * before its commit? Decoding of the following changes continues with
+     * snapshot_now and command_id, saved at the end of the last streamed
+     * block.
+     */
+    bool streamed;
+    Snapshot snapshot_now;
+    CommandId command_id;
+
     /*
      * List of ReorderBufferChange structs, including new Snapshots and new
      * CommandIds
@@ -267,6 +278,12 @@ typedef void (*ReorderBufferBeginCB)(ReorderBuffer* rb, ReorderBufferTXN* txn);
 /* commit callback signature */
 typedef void (*ReorderBufferCommitCB)(ReorderBuffer* rb, ReorderBufferTXN* txn, XLogRecPtr commit_lsn);
 
+/* stream start/stop callback signature */
+typedef void (*ReorderBufferStreamBlockCB)(ReorderBuffer* rb, ReorderBufferTXN* txn);
+
+/* stream abort callback signature */
+typedef void (*ReorderBufferStreamAbortCB)(ReorderBuffer* rb, ReorderBufferTXN* txn, XLogRecPtr abort_lsn);
+
 struct ReorderBuffer {
     /*
      * xid => ReorderBufferTXN lookup table
@@ -302,6 +319,16 @@ struct ReorderBuffer {
     ReorderBufferApplyChangeCB apply_change;
     ReorderBufferCommitCB commit;
 
+    /*
+     * Callbacks to stream the changes of large transactions before they
+     * commit, used only if the output plugin supports streaming.
+     */
+    ReorderBufferStreamBlockCB stream_start;
+    ReorderBufferStreamBlockCB stream_stop;
+    ReorderBufferApplyChangeCB stream_change;
+    ReorderBufferCommitCB stream_commit;
+    ReorderBufferStreamAbortCB stream_abort;
+
     /*
      * Pointer that will be passed untouched to the callbacks.
      */
@@ -339,6 +366,9 @@ struct ReorderBuffer {
     /* buffer for disk<->memory conversions */
     char* outbuf;
     Size outbufsize;
+
+    /* statistics not yet reported to the slot, see UpdateDecodingStats() */
+    ReplicationSlotDecodingStats stats;
 };
 
 ReorderBuffer* ReorderBufferAllocate(void);
@@ -87,6 +87,23 @@ typedef struct ReplicationSlotOnDisk {
     ReplicationSlotPersistentData slotdata;
 } ReplicationSlotOnDisk;
 
+/*
+ * Statistics of logical decoding done on a slot, kept in shared memory only.
+ * They are reset when the slot is created and when the server restarts.
+ */
+typedef struct ReplicationSlotDecodingStats {
+    int64 spill_txns;      /* transactions spilled to disk */
+    int64 spill_count;     /* times transactions were spilled to disk */
+    int64 spill_bytes;     /* bytes written to the spill files */
+    int64 stream_txns;     /* transactions streamed before their commit */
+    int64 stream_count;    /* blocks of changes streamed */
+    int64 stream_bytes;    /* bytes of changes streamed */
+    int64 total_txns;      /* transactions sent to the output plugin */
+    int64 total_bytes;     /* bytes of changes sent to the output plugin */
+    int64 decoded_records; /* WAL records decoded */
+    int64 decoded_bytes;   /* bytes of WAL decoded */
+} ReplicationSlotDecodingStats;
+
 /*
  * Shared memory state of a single replication slot.
  */
@@ -136,6 +153,9 @@ typedef struct ReplicationSlot {
     XLogRecPtr candidate_xmin_lsn;
     XLogRecPtr candidate_restart_valid;
     XLogRecPtr candidate_restart_lsn;
+
+    /* decoding statistics, protected by mutex */
+    ReplicationSlotDecodingStats decoding_stats;
 } ReplicationSlot;
 
 /* size of the part of the slot that is version independent */
@@ -207,6 +227,7 @@ extern void CheckSlotRequirements(void);
 
 /* SQL callable functions */
 extern Datum pg_get_replication_slots(PG_FUNCTION_ARGS);
+extern Datum pg_stat_get_replication_slots(PG_FUNCTION_ARGS);
 extern void create_logical_replication_slot(
     Name name, Name plugin, bool isDummyStandby, NameData* databaseName, char* str_tmp_lsn);
 extern XLogRecPtr ReplicationSlotsComputeLogicalRestartLSN(void);
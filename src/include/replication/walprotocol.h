@@ -109,6 +109,63 @@ typedef struct {
     bool catchup;
 } WalDataMessageHeader;
 
+/*
+ * Compression of the physical WAL stream, requested by walreceiver with the
+ * "compression" option of START_REPLICATION. Keep in sync with
+ * wal_stream_compression_options in guc.cpp.
+ */
+typedef enum {
+    WAL_STREAM_COMPRESS_OFF = 0,
+    WAL_STREAM_COMPRESS_LZ4
+} WalStreamCompression;
+
+/*
+ * Header for a compressed WAL data message (message type 'z'). It follows
+ * the WalDataMessageHeader of the batch and precedes the compressed data,
+ * which decompresses to raw_len bytes of WAL starting at dataStart.
+ * Walsender falls back to a plain 'w' message whenever compression does
+ * not shrink the batch.
+ */
+typedef struct {
+    uint32 raw_len;
+} WalCompressedDataHeader;
+
+/*
+ * Compression of the tar streams of BASE_BACKUP, requested with its option
+ * COMPRESSION. When it is on, every CopyData message of the tar streams
+ * starts with a BaseBackupDataHeader. The payload following it is LZ4 data
+ * decompressing to raw_len bytes when data_len is less than raw_len, and
+ * the raw bytes otherwise. Decompressed messages keep the boundaries of an
+ * uncompressed stream, so a tar header is always a message of its own.
+ */
+typedef enum {
+    BASEBACKUP_COMPRESS_OFF = 0,
+    BASEBACKUP_COMPRESS_LZ4
+} BaseBackupCompression;
+
+typedef struct {
+    uint32 raw_len;
+    uint32 data_len;
+} BaseBackupDataHeader;
+
+/*
+ * Tar member of an incremental BASE_BACKUP (option INCREMENTAL 'lsn')
+ * carrying only the blocks of a relation segment changed since the lsn.
+ * It is named after the segment file plus BASEBACKUP_INCREMENTAL_SUFFIX and
+ * holds the header, nblocks block numbers relative to the segment in
+ * ascending order and the nblocks blocks themselves. The receiver writes
+ * the blocks into its copy of the segment, then truncates or extends that
+ * to file_size.
+ */
+#define BASEBACKUP_INCREMENTAL_SUFFIX ".incremental"
+#define BASEBACKUP_INCREMENTAL_MAGIC 0x4742494E
+
+typedef struct {
+    uint32 magic;
+    uint32 nblocks;
+    uint64 file_size;
+} BaseBackupIncrementalHeader;
+
 /*
  * Header for a data replication message (message type 'd').  This is wrapped within
  * a CopyData message at the FE/BE protocol level.
@@ -113,6 +113,20 @@ typedef struct WalSnd {
     int index;
 
     LogCtrlData log_ctrl;
+
+    /*
+     * WAL stream compression of this walsender and its counters. Raw bytes
+     * are the WAL sent, compressed bytes what it took on the wire (equal to
+     * the raw bytes for batches sent uncompressed). Protected by mutex.
+     */
+    int compression;
+    uint64 sent_raw_bytes;
+    uint64 sent_compressed_bytes;
+    uint64 compress_time; /* in microseconds */
+
+    /* WAL read by XLogRead from the WAL buffers and from the files. Protected by mutex. */
+    uint64 buffer_read_bytes;
+    uint64 file_read_bytes;
 } WalSnd;
 
 extern THR_LOCAL WalSnd* MyWalSnd;
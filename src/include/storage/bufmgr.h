@@ -198,6 +198,7 @@ struct WritebackContext;
  * prototypes for functions in bufmgr.c
  */
 extern void PrefetchBuffer(Relation reln, ForkNumber forkNum, BlockNumber blockNum);
+extern bool PrefetchSharedBuffer(struct SMgrRelationData* smgr_reln, ForkNumber fork_num, BlockNumber block_num);
 extern void PageRangePrefetch(
     Relation reln, ForkNumber forkNum, BlockNumber blockNum, int32 n, uint32 flags, uint32 col);
 extern void PageListPrefetch(
@@ -285,7 +286,7 @@ extern void FreeAccessStrategy(BufferAccessStrategy strategy);
 /* dirty page manager */
 extern int ckpt_buforder_comparator(const void* pa, const void* pb);
 extern void clean_buf_need_flush_flag(BufferDesc *buf_desc);
-extern void ckpt_flush_dirty_page(int thread_id, WritebackContext wb_context);
+extern void ckpt_flush_dirty_page(int thread_id, WritebackContext* wb_context);
 
 extern uint32 SyncOneBuffer(
     int buf_id, bool skip_recently_used, WritebackContext* flush_context, bool get_candition_lock = false);
@@ -66,6 +66,7 @@ typedef enum CacheType {
     CACHE_COlUMN_DATA,
     CACHE_ORC_DATA,
     CACHE_OBS_DATA,
+    CACHE_COLUMN_COMPRESSED_DATA,
 
     /* index block */
     CACHE_ORC_INDEX
@@ -74,7 +75,8 @@ typedef enum CacheType {
 typedef enum MgrCacheType {
     /* cache manager type */
     MGR_CACHE_TYPE_DATA,
-    MGR_CACHE_TYPE_INDEX
+    MGR_CACHE_TYPE_INDEX,
+    MGR_CACHE_TYPE_COMPRESSED_DATA
 } MgrCacheType;
 
 typedef struct CacheTag {
@@ -121,6 +123,13 @@ typedef struct CacheDesc {
      */
     bool m_refreshing;
 
+    /*
+     * The block was admitted on probation and is queued on the probation
+     * ring. It is evicted from there before the clock sweep runs, unless it
+     * is referenced again and so promoted into the clock.
+     */
+    bool m_probation;
+
     slock_t m_slot_hdr_lock;
 
     CacheFlags m_flag;
@@ -129,6 +138,12 @@ typedef struct CacheDesc {
 int CacheMgrNumLocks(int64 cache_size, uint32 each_block_size);
 int64 CacheMgrCalcSizeByType(MgrCacheType type);
 
+/* called with the hash partition lock held when a block enters the hash table with a new tag */
+typedef void (*CacheBlockReserveCallback)(CacheSlotId_t slotId, const CacheTag *cacheTag);
+
+/* called with the hash partition lock held when a block leaves the hash table */
+typedef void (*CacheBlockDropCallback)(CacheSlotId_t slotId, const CacheTag *cacheTag);
+
 /*
  * This class is to manage Common Cache.
  */
@@ -185,6 +200,23 @@ public:
     void AbortCacheBlock(CacheSlotId_t slotId);
     void SetCacheBlockErrorState(CacheSlotId_t slotId);
 
+    /* admission policy and statistics */
+    void SetCacheBlockProbation(CacheSlotId_t slotId);
+    void SetReserveCallback(CacheBlockReserveCallback callback);
+    void SetDropCallback(CacheBlockDropCallback callback);
+    int64 GetMaxMemSize() const
+    {
+        return m_cstoreMaxSize;
+    }
+    uint64 GetEvictCount() const
+    {
+        return m_evict_count;
+    }
+    int GetCacheSlotsNum() const
+    {
+        return m_CacheSlotsNum;
+    }
+
     /*
      * get the number of cache slot now used.
      * notice the number will be bigger and bigger, not smaller.
@@ -205,6 +237,9 @@ private:
 
     /* internal block operate */
     CacheSlotId_t EvictCacheBlock(int size, int retryNum);
+    CacheSlotId_t EvictProbationBlock();
+    bool PushProbationRing(CacheSlotId_t slotId);
+    CacheSlotId_t PopProbationRing();
     CacheSlotId_t GetFreeCacheBlock(int size);
 
     /* memory operate */
@@ -227,6 +262,9 @@ private:
 
     bool CacheBlockIsPinned(CacheSlotId_t slotId) const;
     void PinCacheBlock_Locked(CacheSlotId_t slotId);
+    bool CacheTypeMatched(int32 type) const;
+    void RememberPinnedBlock(CacheSlotId_t slotId);
+    void ForgetPinnedBlock(CacheSlotId_t slotId);
 
     CacheSlotId_t AllocateBlockFromCache(CacheTag *cacheTag, uint32 hashCode, int size, bool &hasFound);
     void AllocateBlockFromCacheWithSlotId(CacheSlotId_t slotId);
@@ -254,6 +292,21 @@ private:
 
     /* protect memory size counter */
     slock_t m_memsize_lock;
+
+    /*
+     * Probation ring, FIFO of blocks admitted on probation. Protected by
+     * m_probation_lock. Blocks evicted from it never disturb the clock.
+     */
+    CacheSlotId_t *m_probation_ring;
+    int m_probation_head;
+    int m_probation_count;
+    slock_t m_probation_lock;
+
+    /* number of blocks evicted, protected by m_csweep_lock */
+    uint64 m_evict_count;
+
+    CacheBlockReserveCallback m_reserve_callback;
+    CacheBlockDropCallback m_drop_callback;
 };
 
 #endif  // define
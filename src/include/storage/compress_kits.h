@@ -264,6 +264,57 @@ private:
     short m_outValSize;
 };
 
+/*
+ * Frame-Of-Reference plus bit packing (SIMD-BP128 layout)
+ *
+ * values are cut into blocks of BITPACK_BLOCK_SIZE. each block remembers its own frame
+ * (the min residual) and bit width, and the residuals are packed vertically: value i
+ * goes to lane (i % BITPACK_LANES) of a 4 x 32bit vector, so one block is packed or
+ * unpacked by 32 vector shift/or steps without any branch.
+ * for DELTA mode the residual is v[i] - v[i - BITPACK_LANES], so that the prefix sum
+ * during decompressing is just one vector add per row.
+ *
+ * disk layout:
+ *   uint8  flags, BITPACK_FLAG_DELTA or 0
+ *   uint32 number of values
+ *   int64  seed value, only for DELTA mode
+ *   blocks: int64 frame | uint8 bit width | uint32 words[bit width * BITPACK_LANES]
+ */
+#define BITPACK_BLOCK_SIZE 128
+#define BITPACK_LANES 4
+#define BITPACK_FLAG_DELTA 0x01
+#define BITPACK_HEADER_SIZE (sizeof(uint8) + sizeof(uint32))
+#define BITPACK_BLOCK_HEADER_SIZE (sizeof(int64) + sizeof(uint8))
+
+class BitpackCoder : public BaseObject {
+public:
+    BitpackCoder(short eachValSize) : m_eachValSize(eachValSize)
+    {}
+    virtual ~BitpackCoder()
+    {}
+
+    /* only 2/4/8 bytes integer is packed, which covers int2/int4/int8/date/timestamp */
+    static FORCE_INLINE bool SupportValSize(short eachValSize)
+    {
+        return (eachValSize == sizeof(int16) || eachValSize == sizeof(int32) || eachValSize == sizeof(int64));
+    }
+
+    // 0 returned means that bit packing doesn't make benefits, or the residual of
+    // some block is out of 32 bits, or outbuf is not big enough.
+    //
+    int Compress(_in_ char* inbuf, _out_ char* outbuf, _in_ int insize, _in_ int outsize);
+    int Decompress(_in_ char* inbuf, _out_ char* outbuf, _in_ int insize, _in_ int outsize);
+
+private:
+    template <short valSize>
+    int CompressInner(char* inbuf, char* outbuf, int insize, int outsize);
+
+    template <short valSize>
+    int DecompressInner(char* inbuf, char* outbuf, int insize, int outsize);
+
+    short m_eachValSize;
+};
+
 typedef uint16 DicCodeType;
 
 /* Dictionary Data In Disk
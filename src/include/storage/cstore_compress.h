@@ -114,9 +114,11 @@ public:
 
     /* optimizing flags */
     bool m_adopt_rle;
+    bool m_adopt_bitpack;
 
 private:
     void InsertMinMaxVal(char* buf, int* usedSize);
+    int TryBitpack(const CompressionArg1& in, BufferHelper* bitpackBuf);
 
     /* inner implement for compress API */
     template <bool adopt_rle>
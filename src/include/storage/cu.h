@@ -148,6 +148,13 @@ struct CUDesc : public BaseObject {
      */
     uint32 magic;
 
+    /*
+     * Serialized bloom filter of CU, see cstore_bloom.h. It's NULL unless
+     * the column enables bloom filter. During scan it's loaded only when
+     * some scan key can use it, and lives until the next batch of CUDesc.
+     */
+    char* cu_bloom;
+
 public:
     CUDesc();
     ~CUDesc();
@@ -325,6 +332,8 @@ public:
     //
     int16 GetCUHeaderSize(void) const;
     void Compress(int valCount, int16 compress_modes);
+    void AllocCompressBuf(void);
+    void CompressIntoBuf(int valCount, int16 compress_modes);
     void FillCompressBufHeader(void);
     char* CompressNullBitmapIfNeed(_in_ char* buf);
     bool CompressData(_out_ char* outBuf, _in_ int nVals, _in_ int16 compressOption);
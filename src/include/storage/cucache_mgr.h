@@ -92,6 +92,80 @@ typedef struct OrcDataValue {
     uint64 size;
 } OrcDataValue;
 
+/*
+ * CU cache is made of two tiers. The uncompressed tier keeps CUs ready for scan,
+ * the compressed tier keeps the on-disk bytes of CUs evicted from or never admitted
+ * to the uncompressed tier, so that they can be decompressed again without IO.
+ */
+typedef enum CUCacheTier { CU_CACHE_TIER_UNCOMPRESSED = 0, CU_CACHE_TIER_COMPRESSED, CU_CACHE_TIER_NUM } CUCacheTier;
+
+/* statistics of one CU cache tier, returned by DataCacheMgr::GetTierInfo() */
+typedef struct CUCacheTierInfo {
+    const char* tierName;
+    int64 maxBytes;
+    int64 usedBytes;
+    uint64 hits;
+    uint64 misses;
+    uint64 evictions;
+    uint64 probations;
+} CUCacheTierInfo;
+
+typedef struct CUCacheTierCounter {
+    pg_atomic_uint64 hits;
+    pg_atomic_uint64 misses;
+    pg_atomic_uint64 probations;
+} CUCacheTierCounter;
+
+/*
+ * Count-min sketch of CU access frequency, the frequency filter of TinyLFU.
+ * Counters saturate at 15 and are halved every m_sampleSize increments, so
+ * the sketch forgets CUs which are not read any more.
+ */
+class CUAccessSketch : public BaseObject {
+public:
+    void Init(int slotsNum);
+    void Destroy();
+    uint32 Increment(const CUSlotTag* tag);
+    uint32 Estimate(const CUSlotTag* tag) const;
+
+#ifndef ENABLE_UT
+private:
+#endif  // ENABLE_UT
+    uint32 Position(uint32 hash, uint32 step, int row) const;
+    void Reset();
+
+    uint8* m_counters;
+    uint32 m_widthMask;
+    uint32 m_sampleSize;
+    pg_atomic_uint32 m_additions;
+};
+
+/*
+ * Slots of CU cache linked by relation, so that dropping the CUs of one relation
+ * does not need to scan the whole cache. Protected by CUCacheRelIndexLock.
+ */
+class CURelSlotIndex : public BaseObject {
+public:
+    void Init(const char* name, int slotsNum);
+    void Destroy();
+    void Link(const RelFileNodeOld* rnode, CacheSlotId_t slotId);
+    void Unlink(CacheSlotId_t slotId);
+    int GetRelSlots(const RelFileNode& rnode, CacheSlotId_t** slots);
+
+    /* some slot could not be linked, callers must scan the whole cache */
+    bool m_incomplete;
+
+#ifndef ENABLE_UT
+private:
+#endif  // ENABLE_UT
+    HTAB* m_hash;
+    CacheSlotId_t* m_next;
+    CacheSlotId_t* m_prev;
+    /* relation each linked slot is listed under */
+    RelFileNodeOld* m_owner;
+    int m_slotsNum;
+};
+
 /* returned code about uncompressing CU data in CU cache */
 enum CUUncompressedRetCode { CU_OK = 0, CU_ERR_CRC, CU_ERR_MAGIC, CU_ERR_ADIO, CU_RELOADING, CU_ERR_MAX };
 
@@ -117,11 +191,13 @@ public:
     CU* GetCUBuf(int cuSlotId);
     OrcDataValue* GetORCDataBuf(int cuSlotId);
     void UnPinDataBlock(int cuSlotId);
+    void UnPinCompressedBlock(CacheSlotId_t slotId);
     /* Manage I/O busy CUs */
     bool DataBlockWaitIO(int cuSlotId);
     void DataBlockCompleteIO(int cuSlotId);
     int64 GetCurrentMemSize();
     void PrintDataCacheSlotLeakWarning(CacheSlotId_t slotId);
+    void PrintCompressedCacheSlotLeakWarning(CacheSlotId_t slotId);
 
     void AbortCU(CacheSlotId_t slot);
     void TerminateCU(bool abort);
@@ -145,6 +221,10 @@ public:
     void AcquireCompressLock(CacheSlotId_t slotId);
     void RealeseCompressLock(CacheSlotId_t slotId);
 
+    /* compressed CU tier */
+    bool LoadCUFromCompressedCache(DataSlotTag* dataSlotTag, CU* cuPtr, int size);
+    void GetTierInfo(CUCacheTierInfo* tierInfo);
+
     int64 m_cstoreMaxSize;
 
 #ifndef ENABLE_UT
@@ -156,8 +236,23 @@ private:
     ~DataCacheMgr()
     {}
 
+    void AdmitCompressedCU(CacheSlotId_t slotId, CU* cuPtr);
+    void InvalidateCompressedCU(CacheSlotId_t slotId);
+    void DropRelationCUCacheByScan(CacheMgr* cacheMgr, const RelFileNode& rnode);
+    bool AdmitOnProbation(const CUSlotTag* tag);
+    static CURelSlotIndex* GetRelSlotIndex(int type);
+    static void ReserveCallback(CacheSlotId_t slotId, const CacheTag* cacheTag);
+    static void DropCallback(CacheSlotId_t slotId, const CacheTag* cacheTag);
+
     static DataCacheMgr* m_data_cache;
     CacheMgr* m_cache_mgr;
+
+    /* NULL if cstore_compressed_cache_ratio is 0 */
+    CacheMgr* m_compressed_cache_mgr;
+    CURelSlotIndex* m_rel_index[CU_CACHE_TIER_NUM];
+    CUAccessSketch* m_sketch;
+    CUCacheTierCounter m_counter[CU_CACHE_TIER_NUM];
+
     slock_t m_adio_write_cache_lock;  // write private cache, not cucache. I add here because spinlock need init once
                                       // for cstore module
 };
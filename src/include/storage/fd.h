@@ -64,6 +64,21 @@ typedef struct DataFileIdCacheEntry {
 
 enum FileExistStatus { FILE_EXIST, FILE_NOT_EXIST, FILE_NOT_REG };
 
+/*
+ * One positional read or write of a batch done by FilePIOBatch(). result is
+ * set like the return value of FilePRead/FilePWrite, err to the errno of a
+ * failure.
+ */
+typedef struct FileIORequest {
+    File file;
+    bool is_write;
+    char* buffer;
+    int amount;
+    off_t offset;
+    int result;
+    int err;
+} FileIORequest;
+
 /*
  * prototypes for functions in fd.c
  */
@@ -102,6 +117,7 @@ extern int FileWrite(File file, const char* buffer, int amount, off_t offset);
 //
 extern int FilePRead(File file, char* buffer, int amount, off_t offset, uint32 wait_event_info = 0);
 extern int FilePWrite(File file, const char* buffer, int amount, off_t offset, uint32 wait_event_info = 0);
+extern void FilePIOBatch(FileIORequest* reqs, int nreqs, uint32 wait_event_info = 0);
 
 extern int AllocateSocket(const char* ipaddr, int port);
 extern int FreeSocket(int sockfd);
@@ -480,6 +480,7 @@ extern void GrantLock(LOCK *lock, PROCLOCK *proclock, LOCKMODE lockmode);
 extern void GrantAwaitedLock(void);
 extern void RemoveFromWaitQueue(PGPROC *proc, uint32 hashcode);
 extern Size LockShmemSize(void);
+extern uint64 GetFastPathLockOverflowCount(void);
 extern LockData *GetLockStatusData(void);
 
 extern void ReportLockTableError(bool report);
@@ -73,6 +73,9 @@ extern const char *const MainLWLockNames[];
 /* Number of partions the global plan cache hashtable */
 #define NUM_GPC_PARTITIONS 128
 
+/* Number of partitions of the global catalog cache hashtable */
+#define NUM_GLOBAL_CATCACHE_PARTITIONS 128
+
 /*
  * WARNING---Please keep the order of LWLockTrunkOffset and BuiltinTrancheIds consistent!!!
  */
@@ -96,9 +99,11 @@ enum LWLockTrunkOffset {
     /* global plan cache */
     FirstGPCMappingLock = FirstInstrUserLock + NUM_INSTR_USER_PARTITIONS,
     FirstGPCPrepareMappingLock = FirstGPCMappingLock + NUM_GPC_PARTITIONS,
+    /* global catalog cache */
+    FirstGlobalCatCacheLock = FirstGPCPrepareMappingLock + NUM_GPC_PARTITIONS,
 
     /* must be last: */
-    NumFixedLWLocks = FirstGPCPrepareMappingLock + NUM_GPC_PARTITIONS,
+    NumFixedLWLocks = FirstGlobalCatCacheLock + NUM_GLOBAL_CATCACHE_PARTITIONS,
 };
 
 /*
@@ -125,6 +130,7 @@ enum BuiltinTrancheIds {
     LWTRANCHE_INSTR_USER,
     LWTRANCHE_GPC_MAPPING,
     LWTRANCHE_GPC_PREPARE_MAPPING,
+    LWTRANCHE_GLOBAL_CATCACHE,
     LWTRANCHE_BUFFER_IO_IN_PROGRESS,
     LWTRANCHE_BUFFER_CONTENT,
     LWTRANCHE_DATA_CACHE,
@@ -186,6 +192,7 @@ struct PGPROC;
 
 typedef struct LWLock {
     uint16 tranche;         /* tranche ID */
+    uint16 spin_budget;     /* adaptive spins before queueing, only a hint */
     pg_atomic_uint32 state; /* state of exlusive/nonexclusive lockers */
     dlist_head waiters;     /* list of waiting PGPROCs */
 #ifdef LOCK_DEBUG
@@ -245,8 +252,33 @@ extern PGDLLIMPORT LWLockPadded *MainLWLockArray;
 typedef struct LWLockHandle {
     LWLock *lock;
     LWLockMode mode;
+    int64 acquireTime; /* GetCurrentTimestamp() if track_lwlock_timing was on, else 0 */
 } LWLockHandle;
 
+/*
+ * Per-tranche contention counters, kept in shared memory next to the main
+ * LWLock array.  Tranches registered at run time share the last slot.  Both
+ * histograms are in microseconds: bucket 0 counts times below 1us, bucket i
+ * counts [2^(i-1), 2^i) us, and the last bucket is open-ended.  They are only
+ * filled while track_lwlock_timing is on.
+ */
+#define LWLOCK_TIME_BUCKETS 16
+#define NUM_LWLOCK_STATS_SLOTS (LWTRANCHE_NATIVE_TRANCHE_NUM + 1)
+
+typedef struct LWLockTrancheStats {
+    pg_atomic_uint64 spinAcquired; /* contended acquisitions won by spinning */
+    pg_atomic_uint64 spinFailed;   /* spin budgets used up without the lock */
+    pg_atomic_uint64 blocked;      /* sleeps on the process semaphore */
+    pg_atomic_uint64 waitTime[LWLOCK_TIME_BUCKETS];
+    pg_atomic_uint64 holdTime[LWLOCK_TIME_BUCKETS];
+    bool queueMode; /* listed in lwlock_queue_tranches */
+} LWLockTrancheStats;
+
+typedef union LWLockTrancheStatsPadded {
+    LWLockTrancheStats stats;
+    char pad[TYPEALIGN(PG_CACHE_LINE_SIZE, sizeof(LWLockTrancheStats))];
+} LWLockTrancheStatsPadded;
+
 #define GetMainLWLockByIndex(i) (&t_thrd.shemem_ptr_cxt.mainLWLockArray[i].lock)
 
 extern void DumpLWLockInfo();
@@ -274,6 +306,7 @@ extern void CreateLWLocks(void);
 
 extern void RequestAddinLWLocks(int n);
 extern const char *GetBuiltInTrancheName(int trancheId);
+extern LWLockTrancheStats *GetLWLockTrancheStats(int slot, const char **name);
 
 /*
  * There is another, more flexible method of obtaining lwlocks. First, call
@@ -73,8 +73,15 @@ struct XidCache {
  * RowShareLock, RowExclusiveLock) to be recorded in the PGPROC structure
  * rather than the main lock table.  This eases contention on the lock
  * manager LWLocks.  See storage/lmgr/README for additional details.
+ *
+ * The slots are split into fast_path_lock_groups groups of
+ * FP_LOCK_SLOTS_PER_GROUP; a relation can only use the slots of the group
+ * its OID hashes to, so lookups never scan more than one group.  The lock
+ * modes of a group fit in one uint64 of fpLockBits.
  */
-#define FP_LOCK_SLOTS_PER_BACKEND 20
+#define FP_LOCK_SLOTS_PER_GROUP 16
+#define FP_LOCK_GROUPS_PER_BACKEND ((uint32)g_instance.attr.attr_storage.fast_path_lock_groups)
+#define FP_LOCK_SLOTS_PER_BACKEND (FP_LOCK_SLOTS_PER_GROUP * FP_LOCK_GROUPS_PER_BACKEND)
 
 typedef struct FastPathTag {
     uint32 dbid;
@@ -152,6 +159,7 @@ struct PGPROC {
     bool lwWaiting;        /* true if waiting for an LW lock */
     uint8 lwWaitMode;      /* lwlock mode being waited for */
     bool lwIsVictim;       /* force to give up LWLock acquire */
+    bool lwGranted;        /* queue-mode LW lock handed over by its releaser */
     dlist_node lwWaitLink; /* next waiter for same LW lock */
 
     /* Info about lock the process is currently waiting for, if any. */
@@ -173,6 +181,16 @@ struct PGPROC {
     bool syncRepInCompleteQueue;   /* waiting in complete queue */
     SHM_QUEUE syncRepLinks; /* list link if process is in syncrep queue */
 
+    /*
+     * Info to allow us to wait for the walwriter to flush our commit record,
+     * see XLogWaitFlush(). flushWaitLinks used only while holding
+     * WALFlushWaitLock. flushWaitDone is set by the walwriter once it has
+     * removed us from the queue.
+     */
+    XLogRecPtr flushWaitLSN;        /* waiting for this LSN or higher */
+    volatile bool flushWaitDone;    /* the LSN has been flushed */
+    SHM_QUEUE flushWaitLinks;       /* list link if process is in flush wait queue */
+
     DataQueuePtr waitDataSyncPoint; /* waiting for this data sync point */
     int dataSyncRepState;           /* wait state for data sync rep */
     SHM_QUEUE dataSyncRepLinks;     /* list link if process is in datasyncrep queue */
@@ -238,8 +256,8 @@ struct PGPROC {
     LWLock* backendLock; /* protects the fields below */
 
     /* Lock manager data, recording fast-path locks taken by this backend. */
-    uint64 fpLockBits;                              /* lock modes held for each fast-path slot */
-    FastPathTag fpRelId[FP_LOCK_SLOTS_PER_BACKEND]; /* slots for rel oids */
+    uint64* fpLockBits;                             /* lock modes held in each fast-path group */
+    FastPathTag* fpRelId;                           /* slots for rel oids */
     bool fpVXIDLock;                                /* are we holding a fast-path VXID lock? */
     LocalTransactionId fpLocalTransactionId;        /* lxid for fast-path VXID
                                                      * lock */
@@ -82,6 +82,17 @@ typedef SMgrRelationData* SMgrRelation;
 
 #define SmgrIsTemp(smgr) RelFileNodeBackendIsTemp((smgr)->smgr_rnode)
 
+/*
+ * One block of a batch written by smgrwritebatch(). The blocks of a batch
+ * may belong to different relations.
+ */
+typedef struct SMgrWriteBlock {
+    SMgrRelation reln;
+    ForkNumber forknum;
+    BlockNumber blocknum;
+    const char* buffer;
+} SMgrWriteBlock;
+
 extern void smgrinit(void);
 extern SMgrRelation smgropen(const RelFileNode& rnode, BackendId backend, int col = 0);
 extern bool smgrexists(SMgrRelation reln, ForkNumber forknum);
@@ -97,6 +108,7 @@ extern void smgrextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blockn
 extern void smgrprefetch(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum);
 extern bool smgrread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char* buffer);
 extern void smgrwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, const char* buffer, bool skipFsync);
+extern void smgrwritebatch(SMgrWriteBlock* blocks, int nblocks, bool skipFsync);
 extern void smgrwriteback(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, BlockNumber nblocks);
 extern BlockNumber smgrnblocks(SMgrRelation reln, ForkNumber forknum);
 extern void smgrtruncatefunc(SMgrRelation reln, ForkNumber forknum, BlockNumber nblocks);
@@ -119,6 +131,7 @@ extern void mdextend(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum
 extern void mdprefetch(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum);
 extern bool mdread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, char* buffer);
 extern void mdwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, const char* buffer, bool skipFsync);
+extern void mdwritebatch(SMgrWriteBlock* blocks, int nblocks, bool skipFsync);
 extern void mdwriteback(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum, BlockNumber nblocks);
 extern BlockNumber mdnblocks(SMgrRelation reln, ForkNumber forknum);
 extern void mdtruncate(SMgrRelation reln, ForkNumber forknum, BlockNumber nblocks);
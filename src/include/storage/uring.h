@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * uring.h
+ *        batched file I/O through a per-thread io_uring
+ *
+ *
+ * IDENTIFICATION
+ *        src/include/storage/uring.h
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+
+#ifndef URING_H
+#define URING_H
+
+/* number of requests a ring holds, and the largest batch worth building */
+#define URING_QUEUE_DEPTH 64
+
+/*
+ * One positional read or write of a batch. result is set to the number of
+ * bytes transferred, or to -1 with err set to the errno of the failure.
+ */
+typedef struct UringIORequest {
+    int fd;
+    bool is_write;
+    char* buf;
+    size_t len;
+    off_t offset;
+    ssize_t result;
+    int err;
+} UringIORequest;
+
+extern bool UringEnabled(void);
+extern void UringPIOBatch(UringIORequest* reqs, int nreqs);
+extern ssize_t UringPWrite(int fd, const char* buf, size_t len, off_t offset);
+extern bool UringRegisterBuffers(char** bases, const Size* lens, int nregions);
+extern void UringUnregisterBuffers(void);
+
+#endif /* URING_H */
@@ -20,6 +20,8 @@ typedef struct AttributeOpts {
     int32 vl_len_; /* varlena header (do not touch directly!) */
     float8 n_distinct;
     float8 n_distinct_inherited;
+    bool bloom_filter; /* build per-CU bloom filters for column store */
+    int compression;   /* offset of the TOAST compression method name, 0 if unset */
 } AttributeOpts;
 
 AttributeOpts* get_attribute_options(Oid spcid, int attnum);
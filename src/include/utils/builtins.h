@@ -948,6 +948,7 @@ extern Datum unknownrecv(PG_FUNCTION_ARGS);
 extern Datum unknownsend(PG_FUNCTION_ARGS);
 
 extern Datum pg_column_size(PG_FUNCTION_ARGS);
+extern Datum pg_column_compression(PG_FUNCTION_ARGS);
 extern Datum datalength(PG_FUNCTION_ARGS);
 
 extern Datum bytea_string_agg_transfn(PG_FUNCTION_ARGS);
@@ -1508,6 +1509,9 @@ extern void decryptBlockOrCUData(
     const char* cipherText, const size_t cipherLength, char* plainText, size_t* plainLength);
 extern bool isEncryptedCluster();
 
+/* cstore_compress.cpp */
+extern Datum gs_cu_compress_bench(PG_FUNCTION_ARGS);
+
 /* pg_lsn.cpp */
 extern Datum pg_lsn_in(PG_FUNCTION_ARGS);
 
@@ -120,6 +120,12 @@ typedef struct catctup {
      */
     struct catclist* c_list; /* containing CatCList, or NULL if none */
     CatCache* my_cache;      /* link to owning catcache */
+
+    /*
+     * Entry of the global catcache holding the tuple data, or NULL if the
+     * tuple was copied into the CatCTup. We hold a reference on it.
+     */
+    struct GlobalCatCTup* global;
 } CatCTup;
 
 /*
@@ -197,6 +203,7 @@ extern void ReleaseCatCacheList(CatCList* list);
 
 extern void ResetCatalogCaches(void);
 extern void CatalogCacheFlushCatalog(Oid catId);
+extern void ReleaseGlobalCatCacheRefs(void);
 extern void CatalogCacheIdInvalidate(int cacheId, uint32 hashValue);
 extern void PrepareToInvalidateCacheTuple(
     Relation relation, HeapTuple tuple, HeapTuple newtuple, void (*function)(int, uint32, Oid));
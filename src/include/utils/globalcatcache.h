@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2020 Huawei Technologies Co.,Ltd.
+ *
+ * openGauss is licensed under Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *
+ *          http://license.coscl.org.cn/MulanPSL2
+ *
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * ---------------------------------------------------------------------------------------
+ *
+ * globalcatcache.h
+ *        instance-wide cache of catalog tuples shared by the session catcaches
+ *
+ *
+ * IDENTIFICATION
+ *        src/include/utils/globalcatcache.h
+ *
+ * ---------------------------------------------------------------------------------------
+ */
+
+#ifndef GLOBALCATCACHE_H
+#define GLOBALCATCACHE_H
+
+#include "access/htup.h"
+#include "storage/sinval.h"
+#include "utils/catcache.h"
+
+/* number of hash buckets of the global catcache, power of 2 */
+#define GLOBAL_CATCACHE_NBUCKETS 65536
+
+#define ENABLE_GLOBAL_CATCACHE (g_instance.cache_cxt.global_catcache != NULL)
+
+/*
+ * A catalog tuple of the global catcache. Entries are immutable once they are
+ * in a bucket. The bucket holds one reference, every session catcache entry
+ * using the tuple holds another one, and the entry is freed when the last
+ * reference is released after it was invalidated.
+ */
+typedef struct GlobalCatCTup {
+    struct GlobalCatCTup* next; /* next entry of the bucket */
+    int cache_id;
+    Oid db_id;                  /* InvalidOid for shared catalogs */
+    uint32 hash_value;
+    volatile uint32 refcount;
+    Size size;                  /* bytes allocated for the entry */
+    Datum keys[CATCACHE_MAXKEYS];
+    HeapTupleData tuple;
+} GlobalCatCTup;
+
+/* counters of one cache ID, read by catcache_status() */
+typedef struct GlobalCatCacheStats {
+    Oid reloid;                 /* catalog of the cache */
+    volatile uint64 generation; /* bumped by every invalidation of the cache */
+    volatile uint64 ntup;
+    volatile uint64 bytes;
+    volatile uint64 searches;
+    volatile uint64 hits;
+    volatile uint64 loads;
+    volatile uint64 invals;
+} GlobalCatCacheStats;
+
+typedef struct GlobalCatCache {
+    MemoryContext context;
+    GlobalCatCTup** buckets;
+    int ncaches;
+    GlobalCatCacheStats* stats;
+} GlobalCatCache;
+
+typedef struct GlobalCatCacheStatus {
+    int cache_id;
+    Oid reloid;
+    uint64 ntup;
+    uint64 bytes;
+    uint64 searches;
+    uint64 hits;
+    uint64 loads;
+    uint64 invals;
+} GlobalCatCacheStatus;
+
+extern void GlobalCatCacheInit(void);
+extern uint64 GlobalCatCacheGeneration(int cacheId);
+extern GlobalCatCTup* GlobalCatCacheSearch(CatCache* cache, Oid dbId, uint32 hashValue, const Datum* arguments);
+extern GlobalCatCTup* GlobalCatCacheInsert(CatCache* cache, Oid dbId, uint32 hashValue, HeapTuple tuple,
+    uint64 generation);
+extern void GlobalCatCacheRelease(GlobalCatCTup* gct);
+extern void GlobalCatCacheInvalidate(const SharedInvalidationMessage* msgs, int n);
+extern void GlobalCatCacheDropDatabase(Oid dbId);
+extern GlobalCatCacheStatus* GlobalCatCacheGetStatus(uint32* num);
+
+#endif /* GLOBALCATCACHE_H */
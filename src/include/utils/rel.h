@@ -313,6 +313,7 @@ typedef struct StdRdOptions {
     bool on_commit_delete_rows; /* global temp table */
 
     int parallel_workers; /* max number of parallel workers */
+    bool deduplicate_items; /* btree: merge equal keys into posting lists */
 } StdRdOptions;
 
 #define HEAP_MIN_FILLFACTOR 10
@@ -337,6 +338,13 @@ typedef struct StdRdOptions {
     ((relation)->rd_options ? \
      ((StdRdOptions *) (relation)->rd_options)->parallel_workers : (defaultpw))
 
+/*
+ * RelationGetDeduplicateItems
+ *		Returns the btree index's deduplicate_items reloption setting.
+ */
+#define RelationGetDeduplicateItems(relation) \
+    ((relation)->rd_options ? ((StdRdOptions*)(relation)->rd_options)->deduplicate_items : false)
+
 #define RelationIsInternal(relation) (RelationGetInternalMask(relation) != INTERNAL_MASK_DISABLE)
 
 /*
@@ -137,6 +137,11 @@ extern void ResourceOwnerEnlargeMetaCacheSlot(ResourceOwner owner);
 extern void ResourceOwnerRememberMetaCacheSlot(ResourceOwner owner, CacheSlotId_t slotid);
 extern void ResourceOwnerForgetMetaCacheSlot(ResourceOwner owner, CacheSlotId_t slotid);
 
+/* support for compressed CU cache refcount management */
+extern void ResourceOwnerEnlargeCompressedCacheSlot(ResourceOwner owner);
+extern void ResourceOwnerRememberCompressedCacheSlot(ResourceOwner owner, CacheSlotId_t slotid);
+extern void ResourceOwnerForgetCompressedCacheSlot(ResourceOwner owner, CacheSlotId_t slotid);
+
 // support for pthread mutex
 //
 extern void ResourceOwnerForgetPthreadMutex(ResourceOwner owner, const pthread_mutex_t* pMutex);
@@ -126,6 +126,7 @@ extern int SysCacheSize;
 
 extern void InitCatalogCache(void);
 extern void InitCatalogCachePhase2(void);
+extern Oid SysCacheGetRelid(int cacheId);
 
 extern HeapTuple SearchSysCache(int cacheId, Datum key1, Datum key2, Datum key3, Datum key4, int level = DEBUG2);
 /*
@@ -36,6 +36,7 @@
  */
 typedef struct Tuplesortstate Tuplesortstate;
 typedef struct SharedSort SharedSort;
+struct GinState;
 
 /*
  * Tuplesort parallel coordination state, allocated by each participant in
@@ -170,6 +171,8 @@ extern Tuplesortstate* tuplesort_begin_index_btree(
     Relation indexRel, bool enforceUnique, int workMem, SortCoordinate coordinate, bool randomAccess, int maxMem);
 extern Tuplesortstate* tuplesort_begin_index_hash(
     Relation indexRel, uint32 hash_mask, int workMem, SortCoordinate coordinate, bool randomAccess, int maxMem);
+extern Tuplesortstate* tuplesort_begin_index_gin(
+    Relation indexRel, GinState* ginstate, int workMem, SortCoordinate coordinate, bool randomAccess, int maxMem);
 extern Tuplesortstate* tuplesort_begin_datum(Oid datumType, Oid sortOperator, Oid sortCollation,
     bool nullsFirstFlag, int workMem, SortCoordinate coordinate, bool randomAccess);
 #ifdef PGXC
@@ -183,6 +186,7 @@ extern void tuplesort_puttupleslot(Tuplesortstate* state, TupleTableSlot* slot);
 extern void tuplesort_putheaptuple(Tuplesortstate* state, HeapTuple tup);
 extern void tuplesort_putindextuplevalues(
     Tuplesortstate* state, Relation rel, ItemPointer self, Datum* values, const bool* isnull);
+extern void tuplesort_putgintuple(Tuplesortstate* state, IndexTuple tuple);
 extern void tuplesort_putdatum(Tuplesortstate* state, Datum val, bool isNull);
 
 extern void tuplesort_performsort(Tuplesortstate* state);
@@ -4,13 +4,14 @@ abs_port=$3
 dataNode=$4
 x_option=${5-}
 format=${6-}
+extra_options=${7-}
 # backup 
 if [ 'x'${x_option} == 'x' ]
 then
     # Compatible with old functions
     $abs_bindir/gs_basebackup -D $abs_bindir/../$dataNode -p $abs_port > $abs_bindir/../$dataNode.log 2>&1
 else
-    $abs_bindir/gs_basebackup -D $abs_bindir/../$dataNode -p $abs_port -X$x_option -F$format > $abs_bindir/../$dataNode.log 2>&1
+    $abs_bindir/gs_basebackup -D $abs_bindir/../$dataNode -p $abs_port -X$x_option -F$format $extra_options > $abs_bindir/../$dataNode.log 2>&1
 fi
 
 for gs_basebackup_port in {4000..60000}; 
@@ -0,0 +1,47 @@
+-- btree deduplication of equal keys into posting list tuples
+create schema btree_dedup;
+set current_schema = btree_dedup;
+
+create table bd_tab(a int4, b text);
+insert into bd_tab select i % 10, 'v' || (i % 3) from generate_series(1, 20000) i;
+
+create index bd_plain on bd_tab(a);
+create index bd_dedup on bd_tab(a) with (deduplicate_items = on);
+select pg_relation_size('bd_dedup') < pg_relation_size('bd_plain') as smaller;
+select reloptions from pg_class where relname = 'bd_dedup';
+drop index bd_plain;
+
+-- every TID of a posting list is returned by each scan type
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+select count(*) from bd_tab where a = 3;
+select a, count(*) from bd_tab where a between 2 and 4 group by a order by a;
+select a from bd_tab where a < 2 order by a desc limit 3;
+set enable_indexscan = off;
+set enable_bitmapscan = on;
+select count(*), count(distinct b) from bd_tab where a = 3;
+reset enable_indexscan;
+reset enable_bitmapscan;
+
+-- inserts into a full leaf page merge its duplicates instead of splitting
+insert into bd_tab select 3, 'v' || (i % 3) from generate_series(1, 5000) i;
+select count(*) from bd_tab where a = 3;
+
+-- vacuum removes whole posting lists and single TIDs from them
+delete from bd_tab where a = 5;
+delete from bd_tab where a = 7 and b = 'v0';
+vacuum bd_tab;
+select count(*) from bd_tab where a = 5;
+select count(*) from bd_tab where a = 7;
+select count(*) from bd_tab where a >= 0;
+reset enable_seqscan;
+
+-- unique indexes never deduplicate
+create table bd_uniq_tab(a int4);
+create unique index bd_uniq on bd_uniq_tab(a) with (deduplicate_items = on);
+insert into bd_uniq_tab values (1);
+insert into bd_uniq_tab values (1);
+create index bd_bad on bd_uniq_tab(a) with (deduplicate_items = 100);
+
+drop schema btree_dedup cascade;
+reset current_schema;
@@ -0,0 +1,30 @@
+-- FOR + bit packing for integer column data
+create schema cstore_bitpack;
+set current_schema = cstore_bitpack;
+
+create table bitpack_t1(a int2, b int4, c int8, e timestamp, f int4) with (orientation = column);
+insert into bitpack_t1 select i % 500, i, 1000000000000 + i * 3,
+    timestamp '2020-01-01 00:00:00' + i * interval '1 second', (i * 7919) % 100000 from generate_series(1, 10000) i;
+select count(*), sum(a), sum(b), sum(c), sum(f) from bitpack_t1;
+select count(*) from bitpack_t1 where e = timestamp '2020-01-01 00:00:00' + b * interval '1 second';
+select a, b, c, f from bitpack_t1 where b in (1, 127, 128, 129, 5000, 10000) order by b;
+
+-- the last block is not full
+create table bitpack_t2(a int4, b int8) with (orientation = column, compression = middle);
+insert into bitpack_t2 select i * 2, -i from generate_series(1, 1000) i;
+select count(*), sum(a), sum(b), min(b), max(b) from bitpack_t2;
+alter table bitpack_t2 set (compression = high);
+vacuum full bitpack_t2;
+select count(*), sum(a), sum(b), min(b), max(b) from bitpack_t2;
+
+-- micro benchmark, throughput depends on the machine so only compression is checked
+select codec, compressed_bytes < raw_bytes as shrunk, bitpacked from gs_cu_compress_bench(4, 60000, 'sequence', 1);
+select codec, compressed_bytes < raw_bytes as shrunk, bitpacked from gs_cu_compress_bench(8, 60000, 'random', 1);
+select a.compressed_bytes <= r.compressed_bytes as auto_not_worse, a.bitpacked, r.bitpacked
+    from gs_cu_compress_bench(2, 60000, 'narrow', 1) a, gs_cu_compress_bench(2, 60000, 'narrow', 1) r
+    where a.codec = 'auto' and r.codec = 'delta+rle';
+select * from gs_cu_compress_bench(3, 100, 'sequence', 1);
+select * from gs_cu_compress_bench(4, 100, 'zipf', 1);
+
+drop schema cstore_bitpack cascade;
+reset current_schema;
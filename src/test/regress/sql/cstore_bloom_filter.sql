@@ -0,0 +1,62 @@
+-- per-CU bloom filters used by the rough check of column store
+create schema cstore_bloom;
+set current_schema = cstore_bloom;
+
+create table bloom_t1(a int4, b text, c char(8), d int8) with (orientation = column);
+alter table bloom_t1 alter column a set (bloom_filter = on);
+alter table bloom_t1 alter column b set (bloom_filter = on);
+alter table bloom_t1 alter column c set (bloom_filter = on);
+alter table bloom_t1 alter column d set (bloom_filter = 100);
+insert into bloom_t1 select i, 'v' || i, 'k' || (i % 100), i * 10 from generate_series(1, 5000) i;
+
+select count(*) from bloom_t1 where a = 77;
+select count(*) from bloom_t1 where a = 6000;
+select count(*) from bloom_t1 where a in (5, 4000, 9999);
+select count(*) from bloom_t1 where a in (null, 10);
+select a, b from bloom_t1 where b = 'v123';
+select count(*) from bloom_t1 where b in ('v1', 'v4999', 'none');
+select count(*) from bloom_t1 where c = 'k7';
+select count(*) from bloom_t1 where c in ('k7', 'k8  ', 'zz');
+select count(*) from bloom_t1 where a = 77 and d = 770;
+
+-- the filter is rebuilt when the column is rewritten
+alter table bloom_t1 alter column d set (bloom_filter = on);
+alter table bloom_t1 alter column d type int4;
+select count(*) from bloom_t1 where d = 500;
+select count(*) from bloom_t1 where d in (10, 50000, 50010);
+
+-- turning the option off does not hide the filters already built
+alter table bloom_t1 alter column a reset (bloom_filter);
+insert into bloom_t1 select i, 'v' || i, 'k' || (i % 100), i * 10 from generate_series(5001, 6000) i;
+select count(*) from bloom_t1 where a in (77, 5500, 6001);
+
+-- CUs skipped by the rough check: a value absent from a CU but inside its
+-- min/max range is skipped only with a bloom filter
+create function bloom_rough_check(query text) returns setof text as $$
+declare
+    ln text;
+begin
+    for ln in execute 'explain (analyze on, costs off, timing off) ' || query loop
+        if ln like '%RoughCheck CU:%' then
+            return next btrim(ln);
+        end if;
+    end loop;
+end
+$$ language plpgsql;
+
+create table bloom_t2(a int4, b int4) with (orientation = column);
+alter table bloom_t2 alter column a set (bloom_filter = on);
+insert into bloom_t2 select i * 2, i * 2 from generate_series(1, 3000) i;
+insert into bloom_t2 select i * 2, i * 2 from generate_series(3001, 6000) i;
+
+select bloom_rough_check('select count(*) from bloom_t2 where a = 77');
+select bloom_rough_check('select count(*) from bloom_t2 where b = 77');
+select bloom_rough_check('select count(*) from bloom_t2 where a in (77, 6001)');
+select bloom_rough_check('select count(*) from bloom_t2 where a = 78');
+select count(*) from bloom_t2 where a = 77;
+select count(*) from bloom_t2 where a in (78, 6002, 6003);
+drop table bloom_t2;
+drop function bloom_rough_check(text);
+
+drop schema cstore_bloom cascade;
+reset current_schema;
@@ -0,0 +1,32 @@
+-- CU compression by parallel workers during bulk load
+create schema cstore_parallel_compress;
+set current_schema = cstore_parallel_compress;
+
+show cstore_compress_workers;
+show log_cstore_load_timing;
+
+create table cpc_serial(a int4, b int8, c text, d numeric(12,2), e varchar(20))
+    with (orientation = column, max_batchrow = 10000);
+create table cpc_parallel(a int4, b int8, c text, d numeric(12,2), e varchar(20))
+    with (orientation = column, max_batchrow = 10000);
+
+insert into cpc_serial select i, i * 1000, 'text' || (i % 97), i / 7.0, 'v' || (i % 13)
+    from generate_series(1, 25000) i;
+
+set cstore_compress_workers = 2;
+-- the stage timings of the load go to the server log
+set log_cstore_load_timing = on;
+insert into cpc_parallel select i, i * 1000, 'text' || (i % 97), i / 7.0, 'v' || (i % 13)
+    from generate_series(1, 25000) i;
+-- a null CU and a same-value CU are not compressed
+insert into cpc_parallel select i, null, 'same', null, null from generate_series(25001, 35000) i;
+reset cstore_compress_workers;
+reset log_cstore_load_timing;
+
+select count(*), sum(a), sum(b), count(distinct c), sum(d), count(distinct e) from cpc_parallel where a <= 25000;
+select count(*) from (select * from cpc_parallel where a <= 25000 except select * from cpc_serial) s;
+select count(*), count(b), count(distinct c), count(d) from cpc_parallel where a > 25000;
+select a, b, c, d, e from cpc_parallel where a in (1, 9999, 10000, 10001, 24999, 25000, 25001) order by a;
+
+drop schema cstore_parallel_compress cascade;
+reset current_schema;
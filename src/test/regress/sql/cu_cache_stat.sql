@@ -0,0 +1,52 @@
+-- statistics and probation admission of CU cache
+create schema cu_cache_stat;
+set current_schema = cu_cache_stat;
+
+select tier, max_bytes > 0 as enabled from gs_cu_cache_stat order by tier desc;
+
+-- counters are cumulative, measure each step against a saved copy
+create table cu_cache_base as select tier, hits, misses, probation_admissions from gs_cu_cache_stat;
+create view cu_cache_delta as
+    select s.tier, s.hits - b.hits as hits, s.misses - b.misses as misses,
+        s.probation_admissions - b.probation_admissions as probations
+    from gs_cu_cache_stat s join cu_cache_base b using (tier);
+
+create table cu_cache_t1(a int4, b int8) with (orientation = column);
+create table cu_cache_t2(a int4, b int8) with (orientation = column);
+insert into cu_cache_t1 select i, i * 10 from generate_series(1, 10000) i;
+insert into cu_cache_t2 select i, i * 10 from generate_series(1, 10000) i;
+
+-- first scan with admission: every CU read is new and goes on probation
+set enable_cu_cache_admission = on;
+truncate cu_cache_base;
+insert into cu_cache_base select tier, hits, misses, probation_admissions from gs_cu_cache_stat;
+select sum(a), sum(b) from cu_cache_t1;
+select misses > 0 as missed, probations > 0 as on_probation, probations <= misses as only_misses
+    from cu_cache_delta where tier = 'uncompressed';
+
+-- second scan hits the CUs read before, nothing more goes on probation
+truncate cu_cache_base;
+insert into cu_cache_base select tier, hits, misses, probation_admissions from gs_cu_cache_stat;
+select sum(a), sum(b) from cu_cache_t1;
+select hits > 0 as hit, misses = 0 as no_miss, probations = 0 as no_probation
+    from cu_cache_delta where tier = 'uncompressed';
+
+-- without admission the CUs read once are cached as usual
+set enable_cu_cache_admission = off;
+truncate cu_cache_base;
+insert into cu_cache_base select tier, hits, misses, probation_admissions from gs_cu_cache_stat;
+select sum(a), sum(b) from cu_cache_t2;
+select misses > 0 as missed, probations = 0 as no_probation
+    from cu_cache_delta where tier = 'uncompressed';
+
+truncate cu_cache_base;
+insert into cu_cache_base select tier, hits, misses, probation_admissions from gs_cu_cache_stat;
+select sum(a), sum(b) from cu_cache_t2;
+select hits > 0 as hit, misses = 0 as no_miss, probations = 0 as no_probation
+    from cu_cache_delta where tier = 'uncompressed';
+reset enable_cu_cache_admission;
+
+drop table cu_cache_t1;
+drop table cu_cache_t2;
+drop schema cu_cache_stat cascade;
+reset current_schema;
@@ -0,0 +1,7 @@
+-- double write files, one per group of page writer and background writer threads
+show dw_file_num;
+set dw_file_num = 2;
+
+checkpoint;
+select node_name is not null, file_id, total_pages >= total_writes from local_double_write_file_stat() order by file_id;
+select count(*) from dbe_perf.global_double_write_file_status;
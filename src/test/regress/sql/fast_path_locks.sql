@@ -0,0 +1,50 @@
+-- fast-path relation lock groups, and weak locks that overflow them
+create schema fast_path_locks;
+set current_schema = fast_path_locks;
+
+show fast_path_lock_groups;
+set fast_path_lock_groups = 8;
+
+-- more relations than all groups together hold, so that some group overflows
+do $$
+begin
+    for i in 1 .. 80 loop
+        execute 'create table fpl_t' || i || '(a int4)';
+    end loop;
+end
+$$;
+create table fpl_overflow as select pg_stat_get_fast_path_overflow() as n;
+start transaction;
+do $$
+begin
+    for i in 1 .. 80 loop
+        execute 'lock table fpl_t' || i || ' in access share mode';
+    end loop;
+end
+$$;
+select pg_stat_get_fast_path_overflow() > n from fpl_overflow;
+select count(*), bool_or(fastpath) from pg_locks
+    where relation in (select oid from pg_class where relname like 'fpl_t%');
+-- the locks, fast-path ones included, move to the prepared transaction
+prepare transaction 'fast_path_locks';
+select count(*), bool_or(fastpath) from pg_locks
+    where pid is null and relation in (select oid from pg_class where relname like 'fpl_t%');
+commit prepared 'fast_path_locks';
+select count(*) from pg_locks where relation in (select oid from pg_class where relname like 'fpl_t%');
+
+-- and are all released with it
+start transaction;
+lock table fpl_t1 in access share mode;
+select count(*) from pg_locks where relation = 'fpl_t1'::regclass and granted;
+commit;
+
+do $$
+begin
+    for i in 1 .. 80 loop
+        execute 'drop table fpl_t' || i;
+    end loop;
+end
+$$;
+drop table fpl_overflow;
+drop schema fast_path_locks;
+reset current_schema;
@@ -0,0 +1,64 @@
+-- pruning of heap pages with long HOT chains, and the HOT chain length histogram
+create schema hot_chain_prune;
+set current_schema = hot_chain_prune;
+
+show hot_chain_prune_threshold;
+
+-- wait until the histogram of a relation counts total chains
+create function hcp_wait_stats(rel regclass, total bigint) returns void as $$
+declare
+    start_time timestamptz := clock_timestamp();
+    n bigint;
+begin
+    -- we don't want to wait forever; loop will exit after 60 seconds
+    for i in 1 .. 600 loop
+        select sum(c) into n from unnest(pg_stat_get_hot_chain_histogram(rel)) c;
+        exit when n >= total;
+        perform pg_sleep(0.1);
+        perform pg_stat_clear_snapshot();
+    end loop;
+
+    -- report time waited in postmaster log (where it won't change test output)
+    raise log 'hcp_wait_stats delayed % seconds', extract(epoch from clock_timestamp() - start_time);
+end
+$$ language plpgsql;
+
+-- ten HOT updates of one row in a seqscan, which walks no chain, leave a
+-- chain of eleven members on a page that is far from full
+create table hcp_t(a int4 primary key, b int4);
+insert into hcp_t values (1, 0);
+set enable_indexscan = off;
+set enable_bitmapscan = off;
+do $$
+begin
+    for i in 1 .. 10 loop
+        update hcp_t set b = i where a = 1;
+    end loop;
+end
+$$;
+reset enable_indexscan;
+set enable_seqscan = off;
+
+select pg_stat_get_hot_chain_histogram('hcp_t'::regclass);
+
+-- with the threshold at 0 an index scan walks the whole chain and leaves the page alone
+set hot_chain_prune_threshold = 0;
+select b from hcp_t where a = 1;
+-- the next one notes the page, and the one after it prunes the page first and
+-- walks a chain of a single member
+reset hot_chain_prune_threshold;
+select b from hcp_t where a = 1;
+select b from hcp_t where a = 1;
+
+-- force the rate-limiting logic in pgstat_report_tabstat() to time out
+-- and send a message
+select pg_sleep(1.0);
+select hcp_wait_stats('hcp_t', 3);
+select pg_stat_get_hot_chain_histogram('hcp_t'::regclass);
+reset enable_seqscan;
+reset enable_bitmapscan;
+
+drop table hcp_t;
+drop function hcp_wait_stats(regclass, bigint);
+drop schema hot_chain_prune;
+reset current_schema;
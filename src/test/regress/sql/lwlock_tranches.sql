@@ -0,0 +1,22 @@
+-- adaptive spinning, queue mode and per-tranche statistics of lightweight locks
+show lwlock_spin_limit;
+show lwlock_queue_tranches;
+show track_lwlock_timing;
+-- lwlock_spin_limit is set in the configuration file, lwlock_queue_tranches at startup
+set lwlock_spin_limit = 0;
+set lwlock_queue_tranches = 'WALWriteLock';
+
+set track_lwlock_timing = on;
+show track_lwlock_timing;
+
+-- one row per tranche plus one for the tranches of extensions, no tranche in queue mode
+select count(*) > 1 from pg_stat_lwlock_tranches;
+select tranche, queue_mode from pg_stat_lwlock_tranches where tranche = 'extension';
+select count(*) from pg_stat_lwlock_tranches where queue_mode;
+select count(*) from pg_stat_lwlock_tranches
+    where spin_acquired < 0 or spin_failed < 0 or blocked < 0
+        or array_length(wait_time_hist, 1) <> 16 or array_length(hold_time_hist, 1) <> 16;
+
+-- the locks taken by this session since track_lwlock_timing was turned on have hold times
+select sum(h) > 0 from pg_stat_lwlock_tranches, unnest(hold_time_hist) h;
+reset track_lwlock_timing;
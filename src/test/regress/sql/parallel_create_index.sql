@@ -11,9 +11,18 @@ set min_parallel_table_scan_size=0;
 set maintenance_work_mem=262144;
 CREATE INDEX parallel_index ON parallel_sort_test (randint);
 
---clean up
+--hash and gin indexes are built in parallel too
+CREATE INDEX parallel_hash_index ON parallel_sort_test USING hash (padding1);
+CREATE INDEX parallel_gin_index ON parallel_sort_test USING gin ((string_to_array(substr(padding1, 1, 3), NULL)));
 reset trace_sort;
 reset client_min_messages;
+set enable_seqscan = off;
+SELECT count(*) FROM parallel_sort_test WHERE padding1 = md5('100');
+SELECT count(*) FROM parallel_sort_test WHERE string_to_array(substr(padding1, 1, 3), NULL) @> ARRAY['a', 'b'];
+SELECT count(*) FROM parallel_sort_test WHERE string_to_array(substr(padding1, 1, 3), NULL) && ARRAY['0'];
+reset enable_seqscan;
+
+--clean up
 reset max_parallel_maintenance_workers;
 reset min_parallel_index_scan_size;
 reset min_parallel_table_scan_size;
@@ -0,0 +1,44 @@
+-- vacuum of the indexes of a table by parallel workers
+create schema parallel_index_vacuum;
+set current_schema = parallel_index_vacuum;
+
+create table piv_t(a int4, b int4, c text) with (autovacuum_enabled = false);
+insert into piv_t select i, i % 1000, 'row' || i from generate_series(1, 20000) i;
+create index piv_t_a on piv_t(a);
+create index piv_t_b on piv_t(b);
+create index piv_t_c on piv_t(c);
+
+-- all three indexes are big enough to be handed to a worker
+set min_parallel_index_scan_size = '64kB';
+set max_parallel_maintenance_workers = 2;
+select relname from pg_class
+    where relname like 'piv\_t\_%' and pg_relation_size(oid) > 64 * 1024 order by relname;
+
+delete from piv_t where a % 2 = 0;
+vacuum piv_t;
+
+-- the index statistics gathered by the workers make it to pg_class
+select relname, reltuples from pg_class where relname like 'piv\_t\_%' order by relname;
+
+-- and scans of each index see the remaining rows only
+set enable_seqscan = off;
+set enable_bitmapscan = off;
+select count(*) from piv_t where a between 1 and 20000;
+select count(*) from piv_t where b = 1;
+select count(*) from piv_t where b = 2;
+select a from piv_t where c = 'row3';
+select a from piv_t where c = 'row4';
+
+-- rows inserted afterwards are found as well
+insert into piv_t select i, i % 1000, 'row' || i from generate_series(2, 20000, 2) i;
+select count(*) from piv_t where a between 1 and 20000;
+select count(*) from piv_t where b = 2;
+select a from piv_t where c = 'row4';
+reset enable_seqscan;
+reset enable_bitmapscan;
+reset max_parallel_maintenance_workers;
+reset min_parallel_index_scan_size;
+
+drop table piv_t;
+drop schema parallel_index_vacuum;
+reset current_schema;
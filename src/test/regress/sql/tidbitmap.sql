@@ -0,0 +1,67 @@
+-- TID bitmaps: array, run and bitmap containers of exact pages, lossy pages,
+-- and the set operations of BitmapAnd and BitmapOr
+create schema tidbitmap;
+set current_schema = tidbitmap;
+
+-- b = 0 leaves a few tuples on each page, a range of a fills whole pages,
+-- and c in (0, 2) matches two tuples of three all over each page
+create table tbm_t(a int4, b int4, c int4);
+insert into tbm_t select i, i % 50, i % 3 from generate_series(1, 300000) i;
+create index tbm_t_a_idx on tbm_t(a);
+create index tbm_t_b_idx on tbm_t(b);
+create index tbm_t_c_idx on tbm_t(c);
+analyze tbm_t;
+
+-- the Heap Blocks line of EXPLAIN ANALYZE, without the page counts
+create function tbm_heap_blocks(query text) returns setof text as $$
+declare
+    ln text;
+begin
+    for ln in execute 'explain (analyze on, costs off, timing off) ' || query loop
+        if ln like '%Heap Blocks:%' then
+            return next regexp_replace(btrim(ln), '[0-9]+', 'N', 'g');
+        end if;
+    end loop;
+end
+$$ language plpgsql;
+
+set enable_seqscan = off;
+set enable_indexscan = off;
+set enable_indexonlyscan = off;
+explain (costs off) select count(*), sum(a) from tbm_t where b = 0 or a between 10000 and 60000;
+select count(*), sum(a) from tbm_t where b = 0;
+select count(*), sum(a) from tbm_t where a between 10000 and 60000;
+select count(*), sum(a) from tbm_t where c in (0, 2);
+select count(*), sum(a) from tbm_t where b = 0 or a between 10000 and 60000;
+select count(*), sum(a) from tbm_t where c in (0, 2) and a between 10000 and 60000;
+select count(*), sum(a) from tbm_t where b = 0 and c = 0;
+select count(*), sum(a) from tbm_t where c in (0, 2) and b = 0;
+select tbm_heap_blocks('select count(*) from tbm_t where c in (0, 2)');
+
+-- a small work_mem turns pages lossy, the recheck keeps the results right
+set work_mem = '64kB';
+select tbm_heap_blocks('select count(*) from tbm_t where c in (0, 2)');
+select count(*), sum(a) from tbm_t where c in (0, 2);
+select count(*), sum(a) from tbm_t where b = 0 or a between 10000 and 60000;
+select count(*), sum(a) from tbm_t where c in (0, 2) and a between 10000 and 60000;
+select count(*), sum(a) from tbm_t where c in (0, 2) and b = 0;
+reset work_mem;
+
+-- the same results from a seqscan
+reset enable_seqscan;
+reset enable_indexscan;
+reset enable_indexonlyscan;
+set enable_bitmapscan = off;
+select count(*), sum(a) from tbm_t where b = 0;
+select count(*), sum(a) from tbm_t where a between 10000 and 60000;
+select count(*), sum(a) from tbm_t where c in (0, 2);
+select count(*), sum(a) from tbm_t where b = 0 or a between 10000 and 60000;
+select count(*), sum(a) from tbm_t where c in (0, 2) and a between 10000 and 60000;
+select count(*), sum(a) from tbm_t where b = 0 and c = 0;
+select count(*), sum(a) from tbm_t where c in (0, 2) and b = 0;
+reset enable_bitmapscan;
+
+drop function tbm_heap_blocks(text);
+drop table tbm_t;
+drop schema tidbitmap;
+reset current_schema;
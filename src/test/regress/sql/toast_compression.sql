@@ -0,0 +1,34 @@
+-- per-column compression method of TOASTed values
+create schema toast_compression;
+set current_schema = toast_compression;
+
+create table tc_tab(id int, a text, b text);
+alter table tc_tab alter column b set compression lz4;
+select attname, attoptions from pg_attribute where attrelid = 'tc_tab'::regclass and attnum > 0 order by attnum;
+
+-- compressed in line, compressed out of line, and too short to compress
+insert into tc_tab values (1, repeat('abcdefghij', 1000), repeat('abcdefghij', 1000));
+insert into tc_tab values (2, repeat('0123456789', 100000), repeat('0123456789', 100000));
+insert into tc_tab values (3, 'short', 'short');
+select id, pg_column_compression(id) as cid, pg_column_compression(a) as ca, pg_column_compression(b) as cb
+    from tc_tab order by id;
+select id, length(b), a = b as same, md5(a) = md5(b) as same_md5 from tc_tab order by id;
+
+-- slices of an lz4 value are decompressed only up to their end
+select substr(b, 11, 5), substr(b, 99995, 10) from tc_tab where id = 2;
+select id, pg_column_compression(b) as cb from tc_tab where substr(b, 1, 3) = 'abc' order by id;
+
+-- resetting the option goes back to pglz for new values only
+alter table tc_tab alter column b reset (compression);
+insert into tc_tab values (4, repeat('abcdefghij', 1000), repeat('abcdefghij', 1000));
+select id, pg_column_compression(b) as cb from tc_tab order by id;
+
+alter table tc_tab alter column b set (compression = 'lz4');
+update tc_tab set b = b || 'x' where id = 4;
+select id, pg_column_compression(b) as cb, length(b) from tc_tab where id = 4;
+
+alter table tc_tab alter column b set compression zstd;
+alter table tc_tab alter column id set compression pglz;
+
+drop schema toast_compression cascade;
+reset current_schema;